@@ -29,7 +29,9 @@
 #include "itkPoint.h"
 
 #include "OTBOSSIMAdaptersExport.h"
+#include <memory>
 #include <string>
+#include <vector>
 
 class ossimElevManager;
 
@@ -81,6 +83,18 @@ namespace otb
  * GetHeightAboveEllipsoid() method.
  *
  * DEM directory can either contain DTED or SRTM formats.
+ *
+ * Elevation queries can be served by an in-memory tile cache, which is
+ * enabled by setting its resolution (SetTileCacheResolution(), or the
+ * OTB_DEM_TILE_CACHE_RESOLUTION environment variable), in posts per degree.
+ * Heights are then sampled once through OSSIM on a regular grid of that
+ * resolution, by tiles, and bilinearly interpolated. Tiles are never
+ * modified once built, so that threads query them without any lock; only
+ * building a missing tile is serialized. With a resolution matching the
+ * DEM posts (1200 for SRTM 3 arc-second, 3600 for SRTM 1 arc-second), the
+ * interpolated values are the ones computed by OSSIM. Batch queries on
+ * arrays of points are available and amortize the tile lookups.
+ *
  * \ingroup Images
  *
  *
@@ -143,6 +157,12 @@ public:
   virtual double GetHeightAboveEllipsoid(double lon, double lat) const;
   virtual double GetHeightAboveEllipsoid(const PointType& geoPoint) const;
 
+  /** Compute the heights above MSL of an array of geographic points. */
+  void GetHeightAboveMSL(const std::vector<PointType>& geoPoints, std::vector<double>& heights) const;
+
+  /** Compute the heights above ellipsoid of an array of geographic points. */
+  void GetHeightAboveEllipsoid(const std::vector<PointType>& geoPoints, std::vector<double>& heights) const;
+
   /** Set the default height above ellipsoid in case no information is available*/
   virtual void SetDefaultHeightAboveEllipsoid(double h);
 
@@ -167,11 +187,34 @@ public:
    */
   void ClearDEMs();
 
+  /** Resolution of the tile cache, in posts per degree. 0 disables the
+   * cache. Changing it empties the cache. This method is not thread safe. */
+  void SetTileCacheResolution(unsigned int postsPerDegree);
+  unsigned int GetTileCacheResolution() const;
+
+  /** Maximum memory used by the tile cache, in MB (default is 64). Once
+   * reached, points outside the cached tiles are computed by OSSIM. */
+  void SetTileCacheMaximumSize(unsigned int sizeInMB);
+  unsigned int GetTileCacheMaximumSize() const;
+
+  /** Drop all the cached tiles. This method is not thread safe. */
+  void ClearTileCache();
+
+  /** Number of tiles held by the tile cache */
+  unsigned int GetTileCacheNumberOfTiles() const;
+
+  /** Number of heights interpolated from a cached tile */
+  unsigned long GetTileCacheHits() const;
+
+  /** Number of heights that required building a tile, or were computed
+   * by OSSIM because the cache could not serve them */
+  unsigned long GetTileCacheMisses() const;
+
+  void ResetTileCacheStatistics();
+
 protected:
   DEMHandler();
-  ~DEMHandler() override
-  {
-  }
+  ~DEMHandler() override;
 
   void PrintSelf(std::ostream& os, itk::Indent indent) const override;
 
@@ -184,6 +227,12 @@ protected:
   double m_DefaultHeightAboveEllipsoid;
 
   static Pointer m_Singleton;
+
+private:
+  class TileCache;
+
+  // Cache of elevation tiles, built lazily
+  std::unique_ptr<TileCache> m_TileCache;
 };
 
 } // namespace otb
@@ -21,7 +21,13 @@
 #include "otbDEMHandler.h"
 #include "otbMacro.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <mutex>
+
+#include "itksys/SystemTools.hxx"
 
 #include "otb_ossim.h"
 
@@ -51,6 +57,318 @@
 
 namespace otb
 {
+namespace
+{
+double ExactHeightAboveMSL(double lon, double lat)
+{
+  ossimGpt ossimWorldPoint;
+
+  ossimWorldPoint.lon = lon;
+  ossimWorldPoint.lat = lat;
+
+  assert(ossimElevManager::instance() != NULL);
+
+  return ossimElevManager::instance()->getHeightAboveMSL(ossimWorldPoint);
+}
+
+double ExactHeightAboveEllipsoid(double lon, double lat)
+{
+  ossimGpt ossimWorldPoint;
+
+  ossimWorldPoint.lon = lon;
+  ossimWorldPoint.lat = lat;
+
+  assert(ossimElevManager::instance() != NULL);
+
+  return ossimElevManager::instance()->getHeightAboveEllipsoid(ossimWorldPoint);
+}
+} // namespace
+
+/** \class DEMHandler::TileCache
+ *
+ * Heights sampled on a regular grid of Resolution posts per degree. The
+ * grid is split in 1x1 degree cells, and each cell in tiles of TileSize x
+ * TileSize intervals (i.e. TileSize + 1 posts per side, so that a tile is
+ * enough to interpolate any point it covers). Cells and tiles are
+ * published through atomic pointers and never modified afterwards:
+ * queries only need acquire loads. Building a tile is serialized by a
+ * mutex, which also guards the ownership of cells and tiles.
+ */
+class DEMHandler::TileCache
+{
+public:
+  static const unsigned int TileSize       = 64;
+  static const unsigned int NumberOfCellsX = 360;
+  static const unsigned int NumberOfCellsY = 180;
+
+  struct Tile
+  {
+    unsigned int        width;
+    std::vector<double> msl;
+    std::vector<double> ellipsoid;
+  };
+
+  struct Cell
+  {
+    std::unique_ptr<std::atomic<const Tile*>[]> tiles;
+  };
+
+  /** Last tile used by a sequence of queries */
+  struct Hint
+  {
+    Hint() : cell(-1), tileX(0), tileY(0), tile(nullptr)
+    {
+    }
+    long        cell;
+    unsigned    tileX;
+    unsigned    tileY;
+    const Tile* tile;
+  };
+
+  TileCache() : m_Resolution(0), m_TilesPerCell(0), m_MaximumSize(64), m_CurrentSize(0), m_Hits(0), m_Misses(0)
+  {
+    m_Cells.reset(new std::atomic<Cell*>[NumberOfCellsX * NumberOfCellsY]);
+    for (unsigned int i = 0; i < NumberOfCellsX * NumberOfCellsY; ++i)
+    {
+      m_Cells[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    std::string resolution;
+    if (itksys::SystemTools::GetEnv("OTB_DEM_TILE_CACHE_RESOLUTION", resolution))
+    {
+      try
+      {
+        SetResolution(static_cast<unsigned int>(std::stoul(resolution)));
+      }
+      catch (std::exception&)
+      {
+        SetResolution(0);
+      }
+    }
+  }
+
+  void SetResolution(unsigned int resolution)
+  {
+    Clear();
+    m_Resolution   = resolution;
+    m_TilesPerCell = (resolution + TileSize - 1) / TileSize;
+  }
+
+  unsigned int GetResolution() const
+  {
+    return m_Resolution;
+  }
+
+  bool IsEnabled() const
+  {
+    return m_Resolution > 0;
+  }
+
+  void SetMaximumSize(unsigned int sizeInMB)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_MaximumSize = sizeInMB;
+  }
+
+  unsigned int GetMaximumSize() const
+  {
+    return m_MaximumSize;
+  }
+
+  void Clear()
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (unsigned int i = 0; i < NumberOfCellsX * NumberOfCellsY; ++i)
+    {
+      m_Cells[i].store(nullptr, std::memory_order_relaxed);
+    }
+    m_OwnedTiles.clear();
+    m_OwnedCells.clear();
+    m_CurrentSize = 0;
+  }
+
+  unsigned int GetNumberOfTiles() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return static_cast<unsigned int>(m_OwnedTiles.size());
+  }
+
+  unsigned long GetHits() const
+  {
+    return m_Hits.load(std::memory_order_relaxed);
+  }
+
+  unsigned long GetMisses() const
+  {
+    return m_Misses.load(std::memory_order_relaxed);
+  }
+
+  void ResetStatistics()
+  {
+    m_Hits.store(0, std::memory_order_relaxed);
+    m_Misses.store(0, std::memory_order_relaxed);
+  }
+
+  void AddStatistics(unsigned long hits, unsigned long misses)
+  {
+    if (hits)
+      m_Hits.fetch_add(hits, std::memory_order_relaxed);
+    if (misses)
+      m_Misses.fetch_add(misses, std::memory_order_relaxed);
+  }
+
+  /** Interpolate the height of a point from the cached tiles, building
+   * the tile if needed. Returns false if the point can not be served by
+   * the cache (tile missing and cache full, or no data around the point). */
+  bool Interpolate(double lon, double lat, bool aboveMSL, Hint& hint, double& height, bool& built)
+  {
+    built = false;
+    if (!(lat >= -90. && lat <= 90.) || !std::isfinite(lon))
+    {
+      return false;
+    }
+
+    // Wrap longitude in [-180, 180[
+    lon -= 360. * std::floor((lon + 180.) / 360.);
+
+    const double cellX = std::floor(lon);
+    const double cellY = std::min(std::floor(lat), 89.);
+
+    const double       fx = (lon - cellX) * m_Resolution;
+    const double       fy = (lat - cellY) * m_Resolution;
+    const unsigned int ix = std::min(static_cast<unsigned int>(fx), m_Resolution - 1);
+    const unsigned int iy = std::min(static_cast<unsigned int>(fy), m_Resolution - 1);
+    const double       u  = fx - ix;
+    const double       v  = fy - iy;
+
+    const long         cell  = static_cast<long>(cellX + 180.) + NumberOfCellsX * static_cast<long>(cellY + 90.);
+    const unsigned int tileX = ix / TileSize;
+    const unsigned int tileY = iy / TileSize;
+
+    if (hint.tile == nullptr || hint.cell != cell || hint.tileX != tileX || hint.tileY != tileY)
+    {
+      hint.cell  = cell;
+      hint.tileX = tileX;
+      hint.tileY = tileY;
+      hint.tile  = GetTile(cell, cellX, cellY, tileX, tileY, built);
+      if (hint.tile == nullptr)
+      {
+        return false;
+      }
+    }
+
+    const Tile&                tile   = *hint.tile;
+    const std::vector<double>& values = aboveMSL ? tile.msl : tile.ellipsoid;
+    const std::size_t          offset = (iy - tileY * TileSize) * tile.width + (ix - tileX * TileSize);
+
+    const double v00 = values[offset];
+    const double v10 = values[offset + 1];
+    const double v01 = values[offset + tile.width];
+    const double v11 = values[offset + tile.width + 1];
+
+    // No data around the point: let OSSIM handle it
+    if (!std::isfinite(v00) || !std::isfinite(v10) || !std::isfinite(v01) || !std::isfinite(v11))
+    {
+      return false;
+    }
+
+    height = (1. - v) * ((1. - u) * v00 + u * v10) + v * ((1. - u) * v01 + u * v11);
+    return true;
+  }
+
+private:
+  const Tile* GetTile(long cellIndex, double cellX, double cellY, unsigned int tileX, unsigned int tileY, bool& built)
+  {
+    const std::size_t tileIndex = tileY * m_TilesPerCell + tileX;
+
+    // Lock-free path
+    Cell* cell = m_Cells[cellIndex].load(std::memory_order_acquire);
+    if (cell)
+    {
+      const Tile* tile = cell->tiles[tileIndex].load(std::memory_order_acquire);
+      if (tile)
+      {
+        return tile;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    // Another thread may have built the tile meanwhile
+    cell = m_Cells[cellIndex].load(std::memory_order_acquire);
+    if (cell)
+    {
+      const Tile* tile = cell->tiles[tileIndex].load(std::memory_order_acquire);
+      if (tile)
+      {
+        return tile;
+      }
+    }
+
+    const unsigned int width   = std::min(TileSize, m_Resolution - tileX * TileSize) + 1;
+    const unsigned int height  = std::min(TileSize, m_Resolution - tileY * TileSize) + 1;
+    const std::size_t  memSize = 2 * sizeof(double) * width * height;
+
+    if (m_CurrentSize + memSize > static_cast<std::size_t>(m_MaximumSize) * 1024 * 1024)
+    {
+      return nullptr;
+    }
+
+    if (!cell)
+    {
+      std::unique_ptr<Cell> newCell(new Cell);
+      newCell->tiles.reset(new std::atomic<const Tile*>[m_TilesPerCell * m_TilesPerCell]);
+      for (unsigned int i = 0; i < m_TilesPerCell * m_TilesPerCell; ++i)
+      {
+        newCell->tiles[i].store(nullptr, std::memory_order_relaxed);
+      }
+      cell = newCell.get();
+      m_OwnedCells.push_back(std::move(newCell));
+      m_Cells[cellIndex].store(cell, std::memory_order_release);
+    }
+
+    std::unique_ptr<Tile> tile(new Tile);
+    tile->width = width;
+    tile->msl.resize(width * height);
+    tile->ellipsoid.resize(width * height);
+
+    for (unsigned int y = 0; y < height; ++y)
+    {
+      const double lat = cellY + static_cast<double>(tileY * TileSize + y) / m_Resolution;
+      for (unsigned int x = 0; x < width; ++x)
+      {
+        const double lon               = cellX + static_cast<double>(tileX * TileSize + x) / m_Resolution;
+        tile->msl[y * width + x]       = ExactHeightAboveMSL(lon, lat);
+        tile->ellipsoid[y * width + x] = ExactHeightAboveEllipsoid(lon, lat);
+      }
+    }
+
+    const Tile* result = tile.get();
+    m_OwnedTiles.push_back(std::move(tile));
+    m_CurrentSize += memSize;
+    cell->tiles[tileIndex].store(result, std::memory_order_release);
+    built = true;
+    return result;
+  }
+
+  unsigned int m_Resolution;
+  unsigned int m_TilesPerCell;
+  unsigned int m_MaximumSize;
+  std::size_t  m_CurrentSize;
+
+  std::unique_ptr<std::atomic<Cell*>[]> m_Cells;
+  std::vector<std::unique_ptr<Cell>> m_OwnedCells;
+  std::vector<std::unique_ptr<Tile>> m_OwnedTiles;
+  mutable std::mutex                 m_Mutex;
+
+  std::atomic<unsigned long> m_Hits;
+  std::atomic<unsigned long> m_Misses;
+};
+
+const unsigned int DEMHandler::TileCache::TileSize;
+const unsigned int DEMHandler::TileCache::NumberOfCellsX;
+const unsigned int DEMHandler::TileCache::NumberOfCellsY;
+
 /** Initialize the singleton */
 DEMHandler::Pointer DEMHandler::m_Singleton = nullptr;
 
@@ -70,7 +388,7 @@ DEMHandler::Pointer DEMHandler::Instance()
   return m_Singleton;
 }
 
-DEMHandler::DEMHandler() : m_GeoidFile(""), m_DefaultHeightAboveEllipsoid(0)
+DEMHandler::DEMHandler() : m_GeoidFile(""), m_DefaultHeightAboveEllipsoid(0), m_TileCache(new TileCache)
 {
   assert(ossimElevManager::instance() != NULL);
 
@@ -79,10 +397,16 @@ DEMHandler::DEMHandler() : m_GeoidFile(""), m_DefaultHeightAboveEllipsoid(0)
   ossimElevManager::instance()->setUseGeoidIfNullFlag(true);
 }
 
+DEMHandler::~DEMHandler()
+{
+}
+
 void DEMHandler::OpenDEMDirectory(const char* DEMDirectory)
 {
   assert(ossimElevManager::instance() != NULL);
 
+  m_TileCache->Clear();
+
   ossimFilename ossimDEMDir(DEMDirectory);
 
   if (!ossimElevManager::instance()->loadElevationPath(ossimDEMDir))
@@ -113,6 +437,7 @@ void DEMHandler::ClearDEMs()
   assert(ossimElevManager::instance() != NULL);
 
   ossimElevManager::instance()->clear();
+  m_TileCache->Clear();
 }
 
 
@@ -159,6 +484,7 @@ bool DEMHandler::OpenGeoidFile(const char* geoidFile)
       assert(ossimElevManager::instance() != NULL);
 
       ossimElevManager::instance()->setDefaultHeightAboveEllipsoid(ossim::nan());
+      m_TileCache->Clear();
 
       return true;
     }
@@ -183,17 +509,20 @@ bool DEMHandler::OpenGeoidFile(const std::string& geoidFile)
 
 double DEMHandler::GetHeightAboveMSL(double lon, double lat) const
 {
-  double   height;
-  ossimGpt ossimWorldPoint;
-
-  ossimWorldPoint.lon = lon;
-  ossimWorldPoint.lat = lat;
-
-  assert(ossimElevManager::instance() != NULL);
-
-  height = ossimElevManager::instance()->getHeightAboveMSL(ossimWorldPoint);
+  if (m_TileCache->IsEnabled())
+  {
+    TileCache::Hint hint;
+    double          height;
+    bool            built;
+    if (m_TileCache->Interpolate(lon, lat, true, hint, height, built))
+    {
+      m_TileCache->AddStatistics(built ? 0 : 1, built ? 1 : 0);
+      return height;
+    }
+    m_TileCache->AddStatistics(0, 1);
+  }
 
-  return height;
+  return ExactHeightAboveMSL(lon, lat);
 }
 
 double DEMHandler::GetHeightAboveMSL(const PointType& geoPoint) const
@@ -203,22 +532,91 @@ double DEMHandler::GetHeightAboveMSL(const PointType& geoPoint) const
 
 double DEMHandler::GetHeightAboveEllipsoid(double lon, double lat) const
 {
-  double   height;
-  ossimGpt ossimWorldPoint;
+  if (m_TileCache->IsEnabled())
+  {
+    TileCache::Hint hint;
+    double          height;
+    bool            built;
+    if (m_TileCache->Interpolate(lon, lat, false, hint, height, built))
+    {
+      m_TileCache->AddStatistics(built ? 0 : 1, built ? 1 : 0);
+      return height;
+    }
+    m_TileCache->AddStatistics(0, 1);
+  }
 
-  ossimWorldPoint.lon = lon;
-  ossimWorldPoint.lat = lat;
+  return ExactHeightAboveEllipsoid(lon, lat);
+}
 
-  assert(ossimElevManager::instance() != NULL);
+double DEMHandler::GetHeightAboveEllipsoid(const PointType& geoPoint) const
+{
+  return GetHeightAboveEllipsoid(geoPoint[0], geoPoint[1]);
+}
+
+void DEMHandler::GetHeightAboveMSL(const std::vector<PointType>& geoPoints, std::vector<double>& heights) const
+{
+  heights.resize(geoPoints.size());
 
-  height = ossimElevManager::instance()->getHeightAboveEllipsoid(ossimWorldPoint);
+  if (!m_TileCache->IsEnabled())
+  {
+    for (std::size_t i = 0; i < geoPoints.size(); ++i)
+    {
+      heights[i] = ExactHeightAboveMSL(geoPoints[i][0], geoPoints[i][1]);
+    }
+    return;
+  }
 
-  return height;
+  TileCache::Hint hint;
+  unsigned long   hits = 0, misses = 0;
+  bool            built;
+  for (std::size_t i = 0; i < geoPoints.size(); ++i)
+  {
+    const bool found = m_TileCache->Interpolate(geoPoints[i][0], geoPoints[i][1], true, hint, heights[i], built);
+    if (found && !built)
+    {
+      ++hits;
+      continue;
+    }
+    ++misses;
+    if (!found)
+    {
+      heights[i] = ExactHeightAboveMSL(geoPoints[i][0], geoPoints[i][1]);
+    }
+  }
+  m_TileCache->AddStatistics(hits, misses);
 }
 
-double DEMHandler::GetHeightAboveEllipsoid(const PointType& geoPoint) const
+void DEMHandler::GetHeightAboveEllipsoid(const std::vector<PointType>& geoPoints, std::vector<double>& heights) const
 {
-  return GetHeightAboveEllipsoid(geoPoint[0], geoPoint[1]);
+  heights.resize(geoPoints.size());
+
+  if (!m_TileCache->IsEnabled())
+  {
+    for (std::size_t i = 0; i < geoPoints.size(); ++i)
+    {
+      heights[i] = ExactHeightAboveEllipsoid(geoPoints[i][0], geoPoints[i][1]);
+    }
+    return;
+  }
+
+  TileCache::Hint hint;
+  unsigned long   hits = 0, misses = 0;
+  bool            built;
+  for (std::size_t i = 0; i < geoPoints.size(); ++i)
+  {
+    const bool found = m_TileCache->Interpolate(geoPoints[i][0], geoPoints[i][1], false, hint, heights[i], built);
+    if (found && !built)
+    {
+      ++hits;
+      continue;
+    }
+    ++misses;
+    if (!found)
+    {
+      heights[i] = ExactHeightAboveEllipsoid(geoPoints[i][0], geoPoints[i][1]);
+    }
+  }
+  m_TileCache->AddStatistics(hits, misses);
 }
 
 void DEMHandler::SetDefaultHeightAboveEllipsoid(double h)
@@ -230,6 +628,7 @@ void DEMHandler::SetDefaultHeightAboveEllipsoid(double h)
   assert(ossimElevManager::instance() != NULL);
 
   ossimElevManager::instance()->setDefaultHeightAboveEllipsoid(h);
+  m_TileCache->Clear();
 }
 
 double DEMHandler::GetDefaultHeightAboveEllipsoid() const
@@ -266,10 +665,60 @@ std::string DEMHandler::GetGeoidFile() const
   return m_GeoidFile;
 }
 
+void DEMHandler::SetTileCacheResolution(unsigned int postsPerDegree)
+{
+  m_TileCache->SetResolution(postsPerDegree);
+  this->Modified();
+}
+
+unsigned int DEMHandler::GetTileCacheResolution() const
+{
+  return m_TileCache->GetResolution();
+}
+
+void DEMHandler::SetTileCacheMaximumSize(unsigned int sizeInMB)
+{
+  m_TileCache->SetMaximumSize(sizeInMB);
+}
+
+unsigned int DEMHandler::GetTileCacheMaximumSize() const
+{
+  return m_TileCache->GetMaximumSize();
+}
+
+void DEMHandler::ClearTileCache()
+{
+  m_TileCache->Clear();
+}
+
+unsigned int DEMHandler::GetTileCacheNumberOfTiles() const
+{
+  return m_TileCache->GetNumberOfTiles();
+}
+
+unsigned long DEMHandler::GetTileCacheHits() const
+{
+  return m_TileCache->GetHits();
+}
+
+unsigned long DEMHandler::GetTileCacheMisses() const
+{
+  return m_TileCache->GetMisses();
+}
+
+void DEMHandler::ResetTileCacheStatistics()
+{
+  m_TileCache->ResetStatistics();
+}
+
 void DEMHandler::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
   os << indent << "DEMHandler" << std::endl;
+  os << indent << "TileCacheResolution: " << m_TileCache->GetResolution() << std::endl;
+  os << indent << "TileCacheNumberOfTiles: " << m_TileCache->GetNumberOfTiles() << std::endl;
+  os << indent << "TileCacheHits: " << m_TileCache->GetHits() << std::endl;
+  os << indent << "TileCacheMisses: " << m_TileCache->GetMisses() << std::endl;
 }
 
 } // namespace otb
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "itkMacro.h"
+#include "otbDEMHandler.h"
+
+int otbDEMHandlerTileCacheTest(int argc, char* argv[])
+{
+  if (argc != 8)
+  {
+    std::cerr << "Usage: " << argv[0] << " demdir resolution lon lat step size tolerance" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const std::string  demdir     = argv[1];
+  const unsigned int resolution = atoi(argv[2]);
+  const double       lon        = atof(argv[3]);
+  const double       lat        = atof(argv[4]);
+  const double       step       = atof(argv[5]);
+  const unsigned int size       = atoi(argv[6]);
+  const double       tolerance  = atof(argv[7]);
+
+  otb::DEMHandler::Pointer demHandler = otb::DEMHandler::Instance();
+  demHandler->OpenDEMDirectory(demdir);
+
+  std::vector<otb::DEMHandler::PointType> points;
+  for (unsigned int j = 0; j < size; ++j)
+  {
+    for (unsigned int i = 0; i < size; ++i)
+    {
+      otb::DEMHandler::PointType point;
+      point[0] = lon + i * step;
+      point[1] = lat + j * step;
+      points.push_back(point);
+    }
+  }
+
+  // Reference values, computed by OSSIM
+  demHandler->SetTileCacheResolution(0);
+  std::vector<double> refMSL, refEllipsoid;
+  demHandler->GetHeightAboveMSL(points, refMSL);
+  demHandler->GetHeightAboveEllipsoid(points, refEllipsoid);
+
+  demHandler->SetTileCacheResolution(resolution);
+  demHandler->ResetTileCacheStatistics();
+
+  std::vector<double> cachedMSL, cachedEllipsoid;
+  demHandler->GetHeightAboveMSL(points, cachedMSL);
+  demHandler->GetHeightAboveEllipsoid(points, cachedEllipsoid);
+
+  double maxError = 0.;
+  for (unsigned int i = 0; i < points.size(); ++i)
+  {
+    maxError = std::max(maxError, std::abs(refMSL[i] - cachedMSL[i]));
+    maxError = std::max(maxError, std::abs(refEllipsoid[i] - cachedEllipsoid[i]));
+
+    // Single point queries use the same tiles
+    maxError = std::max(maxError, std::abs(refEllipsoid[i] - demHandler->GetHeightAboveEllipsoid(points[i])));
+  }
+
+  std::cout << "Tiles: " << demHandler->GetTileCacheNumberOfTiles() << ", hits: " << demHandler->GetTileCacheHits()
+            << ", misses: " << demHandler->GetTileCacheMisses() << ", maximum error: " << maxError << " meters" << std::endl;
+
+  demHandler->SetTileCacheResolution(0);
+
+  if (maxError > tolerance)
+  {
+    std::cerr << "Maximum error (" << maxError << " meters) > tolerance (" << tolerance << " meters)" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (demHandler->GetTileCacheHits() == 0)
+  {
+    std::cerr << "No query was served by the tile cache" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
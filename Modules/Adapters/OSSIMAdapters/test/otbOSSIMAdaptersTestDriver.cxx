@@ -27,6 +27,7 @@ void RegisterTests()
   REGISTER_TEST(otbOssimElevManagerTest2);
   REGISTER_TEST(otbOssimElevManagerTest4);
   REGISTER_TEST(otbDEMHandlerTest);
+  REGISTER_TEST(otbDEMHandlerTileCacheTest);
   REGISTER_TEST(otbRPCSolverAdapterTest);
   REGISTER_TEST(otbSarSensorModelAdapterTest);
 }
@@ -23,12 +23,9 @@
 #include "otbWrapperApplicationFactory.h"
 
 #include "otbOGRDataSourceToLabelImageFilter.h"
-#include "itkImageRegionConstIterator.h"
-
-#include "otbRAMDrivenAdaptativeStreamingManager.h"
+#include "otbStreamingContingencyMatrixImageFilter.h"
 
 #include "otbConfusionMatrixMeasurements.h"
-#include "otbContingencyTableCalculator.h"
 #include "otbContingencyTable.h"
 
 #include "otbMacro.h"
@@ -52,13 +49,11 @@ public:
 
   itkTypeMacro(ComputeConfusionMatrix, otb::Application);
 
-  typedef itk::ImageRegionConstIterator<Int32ImageType> ImageIteratorType;
-
   typedef otb::OGRDataSourceToLabelImageFilter<Int32ImageType> RasterizeFilterType;
 
-  typedef RAMDrivenAdaptativeStreamingManager<Int32ImageType> RAMDrivenAdaptativeStreamingManagerType;
-
-  typedef Int32ImageType::RegionType RegionType;
+  typedef otb::StreamingContingencyMatrixImageFilter<Int32ImageType> ContingencyFilterType;
+  typedef ContingencyFilterType::AccumulatorType                     ContingencyCountsType;
+  typedef ContingencyFilterType::ZoneAccumulatorMapType              ZoneContingencyCountsType;
 
   typedef int                                             ClassLabelType;
   typedef unsigned long                                   ConfusionMatrixEltType;
@@ -82,16 +77,6 @@ protected:
   }
 
 private:
-  struct StreamingInitializationData
-  {
-    bool          refhasnodata;
-    bool          prodhasnodata;
-    int           prodnodata;
-    int           refnodata;
-    unsigned long numberOfStreamDivisions;
-  };
-
-
   void DoInit() override
   {
     SetName("ComputeConfusionMatrix");
@@ -103,7 +88,9 @@ private:
         "The ground truth can be provided as either a raster or a vector data. Only reference and produced pixels with values different "
         "from NoData are handled in the calculation of the confusion matrix. The confusion matrix is organized the following way: "
         "rows = reference labels, columns = produced labels. In the header of the output file, the reference and produced class labels "
-        "are ordered according to the rows/columns of the confusion matrix.");
+        "are ordered according to the rows/columns of the confusion matrix. "
+        "Pixels are counted in parallel, and the memory used only depends on the number of labels. "
+        "Optionally, the counts can also be computed for each zone of a label image, in the same pass.");
     SetDocLimitations("None");
     SetDocAuthors("OTB-Team");
     SetDocSeeAlso(" ");
@@ -162,6 +149,18 @@ private:
     MandatoryOff("nodatalabel");
     DisableParameter("nodatalabel");
 
+    AddParameter(ParameterType_InputImage, "zones", "Zones image");
+    SetParameterDescription("zones",
+                            "Optional label image defining zones (for instance administrative areas or strata) on the grid of the input image. "
+                            "The counts of each zone are written to the file given by outzones.");
+    MandatoryOff("zones");
+
+    AddParameter(ParameterType_OutputFilename, "outzones", "Counts per zone output");
+    SetParameterDescription("outzones",
+                            "Filename to store the counts of each zone (csv format). Each line gives a zone label, a reference label, "
+                            "a produced label and the number of pixels with these labels.");
+    MandatoryOff("outzones");
+
     AddRAMParameter();
 
     // Doc example parameter settings
@@ -291,29 +290,31 @@ private:
   }
 
 
-  StreamingInitializationData InitStreamingData()
+  void ComputeContingencyCounts()
   {
-
-    StreamingInitializationData sid;
-
     m_Input = this->GetParameterInt32Image("in");
 
-    std::string field;
+    m_ContingencyFilter = ContingencyFilterType::New();
+    m_ContingencyFilter->SetInput(m_Input);
 
-    sid.prodnodata    = this->GetParameterInt("nodatalabel");
-    sid.prodhasnodata = this->IsParameterEnabled("nodatalabel");
+    if (this->IsParameterEnabled("nodatalabel"))
+    {
+      m_ContingencyFilter->SetProducedNoData(this->GetParameterInt("nodatalabel"));
+    }
 
     if (GetParameterString("ref") == "raster")
     {
-      sid.refnodata    = this->GetParameterInt("ref.raster.nodata");
-      sid.refhasnodata = this->IsParameterEnabled("ref.raster.nodata");
-      m_Reference      = this->GetParameterInt32Image("ref.raster.in");
+      if (this->IsParameterEnabled("ref.raster.nodata"))
+      {
+        m_ContingencyFilter->SetReferenceNoData(this->GetParameterInt("ref.raster.nodata"));
+      }
+      m_Reference = this->GetParameterInt32Image("ref.raster.in");
     }
     else
     {
-      // Force nodata to true since it will be generated during rasterization
-      sid.refhasnodata = true;
-      sid.refnodata    = this->GetParameterInt("ref.vector.nodata");
+      // Nodata is always used since it is generated during rasterization
+      const int refnodata = this->GetParameterInt("ref.vector.nodata");
+      m_ContingencyFilter->SetReferenceNoData(refnodata);
 
       otb::ogr::DataSource::Pointer ogrRef = otb::ogr::DataSource::New(GetParameterString("ref.vector.in"), otb::ogr::DataSource::Modes::Read);
 
@@ -326,134 +327,136 @@ private:
       }
 
       std::vector<std::string> cFieldNames = GetChoiceNames("ref.vector.field");
-      field                                = cFieldNames[selectedCFieldIdx.front()];
+      std::string              field       = cFieldNames[selectedCFieldIdx.front()];
 
       m_RasterizeReference = RasterizeFilterType::New();
       m_RasterizeReference->AddOGRDataSource(ogrRef);
       m_RasterizeReference->SetOutputParametersFromImage(m_Input);
-      m_RasterizeReference->SetBackgroundValue(sid.refnodata);
+      m_RasterizeReference->SetBackgroundValue(refnodata);
       m_RasterizeReference->SetBurnAttribute(field.c_str());
 
       m_Reference = m_RasterizeReference->GetOutput();
-      m_Reference->UpdateOutputInformation();
     }
+    m_ContingencyFilter->SetReferenceImage(m_Reference);
 
-    // Prepare local streaming
-
-
-    m_StreamingManager = RAMDrivenAdaptativeStreamingManagerType::New();
-    int availableRAM   = GetParameterInt("ram");
-    m_StreamingManager->SetAvailableRAMInMB(static_cast<unsigned int>(availableRAM));
-    float bias = 2.0; // empiric value;
-    m_StreamingManager->SetBias(bias);
-
-    m_StreamingManager->PrepareStreaming(m_Input, m_Input->GetLargestPossibleRegion());
-
-    sid.numberOfStreamDivisions = m_StreamingManager->GetNumberOfSplits();
-
-    otbAppLogINFO("Number of stream divisions : " << sid.numberOfStreamDivisions);
+    if (HasValue("zones"))
+    {
+      if (!HasValue("outzones"))
+      {
+        otbAppLogFATAL(<< "The outzones parameter is needed to write the counts of each zone");
+      }
+      m_ContingencyFilter->SetZoneImage(this->GetParameterInt32Image("zones"));
+    }
 
-    return sid;
+    // Each thread counts label pairs in its own matrix, merged at the end
+    m_ContingencyFilter->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"));
+    AddProcess(m_ContingencyFilter->GetStreamer(), "Counting labels");
+    m_ContingencyFilter->Update();
   }
 
   void DoExecute() override
   {
-    StreamingInitializationData sid = InitStreamingData();
+    ComputeContingencyCounts();
 
     if (GetParameterString("format") == "contingencytable")
     {
-      DoExecuteContingencyTable(sid);
+      DoExecuteContingencyTable(m_ContingencyFilter->GetContingencyMatrix());
     }
     else
     {
-      DoExecuteConfusionMatrix(sid);
+      DoExecuteConfusionMatrix(m_ContingencyFilter->GetContingencyMatrix());
+    }
+
+    if (HasValue("zones"))
+    {
+      WriteZoneCounts(m_ContingencyFilter->GetZoneContingencyMatrices());
     }
   }
 
-  void DoExecuteContingencyTable(const StreamingInitializationData& sid)
+  void DoExecuteContingencyTable(const ContingencyCountsType& counts)
   {
-    typedef ContingencyTableCalculator<ClassLabelType> ContingencyTableCalculatorType;
-    ContingencyTableCalculatorType::Pointer            calculator = ContingencyTableCalculatorType::New();
+    ContingencyTablePointerType contingencyTable = ContingencyTableType::New();
+    contingencyTable->SetLabels(counts.GetReferenceLabels(), counts.GetProducedLabels());
 
-    for (unsigned int index = 0; index < sid.numberOfStreamDivisions; index++)
+    const ContingencyCountsType::MatrixType matrix = counts.GetMatrix();
+    for (unsigned int i = 0; i < matrix.Rows(); ++i)
     {
-      RegionType streamRegion = m_StreamingManager->GetSplit(index);
+      for (unsigned int j = 0; j < matrix.Cols(); ++j)
+      {
+        contingencyTable->matrix(i, j) = matrix(i, j);
+      }
+    }
 
-      m_Input->SetRequestedRegion(streamRegion);
-      m_Input->PropagateRequestedRegion();
-      m_Input->UpdateOutputData();
+    LogContingencyTable(contingencyTable);
+    m_WriteContingencyTable(contingencyTable);
+  }
 
-      m_Reference->SetRequestedRegion(streamRegion);
-      m_Reference->PropagateRequestedRegion();
-      m_Reference->UpdateOutputData();
+  void WriteZoneCounts(const ZoneContingencyCountsType& zoneCounts)
+  {
+    std::ofstream outFile;
+    outFile.open(this->GetParameterString("outzones"));
+    outFile << "#zone,reference,produced,count" << std::endl;
 
-      ImageIteratorType itInput(m_Input, streamRegion);
-      itInput.GoToBegin();
+    for (auto const& zone : zoneCounts)
+    {
+      const ContingencyCountsType&              counts     = zone.second;
+      const ContingencyCountsType::LabelListType refLabels  = counts.GetReferenceLabels();
+      const ContingencyCountsType::LabelListType prodLabels = counts.GetProducedLabels();
 
-      ImageIteratorType itRef(m_Reference, streamRegion);
-      itRef.GoToBegin();
+      ConfusionMatrixEltType correct = 0;
+      for (auto labelRef : refLabels)
+      {
+        for (auto labelProd : prodLabels)
+        {
+          const ConfusionMatrixEltType count = counts.GetCount(labelRef, labelProd);
+          if (count > 0)
+          {
+            outFile << zone.first << "," << labelRef << "," << labelProd << "," << count << std::endl;
+          }
+          if (labelRef == labelProd)
+          {
+            correct += count;
+          }
+        }
+      }
 
-      calculator->Compute(itRef, itInput, sid.refhasnodata, sid.refnodata, sid.prodhasnodata, sid.prodnodata);
+      otbAppLogINFO("Zone " << zone.first << ": " << counts.GetNumberOfSamples() << " pixels, overall accuracy "
+                            << static_cast<double>(correct) / counts.GetNumberOfSamples());
     }
-
-    ContingencyTablePointerType contingencyTable = calculator->BuildContingencyTable();
-    LogContingencyTable(contingencyTable);
-    m_WriteContingencyTable(contingencyTable);
+    outFile.close();
   }
 
-  void DoExecuteConfusionMatrix(const StreamingInitializationData& sid)
+  void DoExecuteConfusionMatrix(const ContingencyCountsType& counts)
   {
 
     // Extraction of the Class Labels from the Reference image/rasterized vector data + filling of m_Matrix
     MapOfClassesType           mapOfClassesRef, mapOfClassesProd;
     MapOfClassesType::iterator itMapOfClassesRef, itMapOfClassesProd;
     ClassLabelType             labelRef = 0, labelProd = 0;
-    int                        itLabelRef = 0, itLabelProd = 0;
 
-    for (unsigned int index = 0; index < sid.numberOfStreamDivisions; index++)
+    const ContingencyCountsType::LabelListType refLabels  = counts.GetReferenceLabels();
+    const ContingencyCountsType::LabelListType prodLabels = counts.GetProducedLabels();
+    for (unsigned int i = 0; i < refLabels.size(); ++i)
     {
-      RegionType streamRegion = m_StreamingManager->GetSplit(index);
-
-      m_Input->SetRequestedRegion(streamRegion);
-      m_Input->PropagateRequestedRegion();
-      m_Input->UpdateOutputData();
-
-      m_Reference->SetRequestedRegion(streamRegion);
-      m_Reference->PropagateRequestedRegion();
-      m_Reference->UpdateOutputData();
-
-      ImageIteratorType itInput(m_Input, streamRegion);
-      itInput.GoToBegin();
-
-      ImageIteratorType itRef(m_Reference, streamRegion);
-      itRef.GoToBegin();
+      mapOfClassesRef[refLabels[i]] = i;
+    }
+    for (unsigned int j = 0; j < prodLabels.size(); ++j)
+    {
+      mapOfClassesProd[prodLabels[j]] = j;
+    }
 
-      while (!itRef.IsAtEnd())
+    // Filling of m_Matrix
+    for (auto ref : refLabels)
+    {
+      for (auto prod : prodLabels)
       {
-        labelRef  = static_cast<ClassLabelType>(itRef.Get());
-        labelProd = static_cast<ClassLabelType>(itInput.Get());
-
-        // Extraction of the reference/produced class labels
-        if ((!sid.refhasnodata || labelRef != sid.refnodata) && (!sid.prodhasnodata || labelProd != sid.prodnodata))
+        const ConfusionMatrixEltType count = counts.GetCount(ref, prod);
+        if (count > 0)
         {
-          // If the current labels have not been added to their respective mapOfClasses yet
-          if (mapOfClassesRef.insert(MapOfClassesType::value_type(labelRef, itLabelRef)).second)
-          {
-            ++itLabelRef;
-          }
-          if (mapOfClassesProd.insert(MapOfClassesType::value_type(labelProd, itLabelProd)).second)
-          {
-            ++itLabelProd;
-          }
-
-          // Filling of m_Matrix
-          m_Matrix[labelRef][labelProd]++;
-        } // END if ((labelRef != nodata) && (labelProd != nodata))
-        ++itRef;
-        ++itInput;
+          m_Matrix[ref][prod] = count;
+        }
       }
-    } // END of for (unsigned int index = 0; index < numberOfStreamDivisions; index++)
-
+    }
 
     /////////////////////////////////////////////
     // Filling the 2 headers for the output file
@@ -619,12 +622,12 @@ private:
 
   } // END Execute()
 
-  ConfusionMatrixType                              m_MatrixLOG;
-  OutputConfusionMatrixType                        m_Matrix;
-  Int32ImageType*                                  m_Input;
-  Int32ImageType::Pointer                          m_Reference;
-  RAMDrivenAdaptativeStreamingManagerType::Pointer m_StreamingManager;
-  RasterizeFilterType::Pointer                     m_RasterizeReference;
+  ConfusionMatrixType            m_MatrixLOG;
+  OutputConfusionMatrixType      m_Matrix;
+  Int32ImageType*                m_Input;
+  Int32ImageType::Pointer        m_Reference;
+  ContingencyFilterType::Pointer m_ContingencyFilter;
+  RasterizeFilterType::Pointer   m_RasterizeReference;
 };
 }
 }
@@ -78,6 +78,13 @@ private:
     SetParameterDescription("out", "XML filename where the statistics are saved for future reuse.");
     MandatoryOff("out");
 
+    AddParameter(ParameterType_Bool, "cache", "Cache the statistics of each image");
+    SetParameterDescription("cache",
+                            "Keep the partial statistics of each input image in a sidecar file next to it (image filename, without the "
+                            "extended filename options, followed by .stats). "
+                            "A later run on the same unmodified image, with the same background value and extended filename options, "
+                            "reads them back instead of processing the image again. Images which are not local files are not cached.");
+
     AddRAMParameter();
 
     // Doc example parameter settings
@@ -106,6 +113,7 @@ private:
 
     FloatVectorImageListType*                           imageList = GetParameterImageList("il");
     FloatVectorImageListType::InternalContainerSizeType nbImages  = imageList->Size();
+    const std::vector<std::string>                      fileNames = GetParameterStringList("il");
 
     // Initialization, all image have same size and number of band/component
     FloatVectorImageType* firstImage = imageList->GetNthElement(0);
@@ -145,8 +153,28 @@ private:
         statsEstimator->SetIgnoreUserDefinedValue(true);
         statsEstimator->SetUserIgnoredValue(GetParameterFloat("bv"));
       }
+      if (GetParameterInt("cache") && imageId < fileNames.size() && !fileNames[imageId].empty())
+      {
+        // Without fingerprint, a sidecar file could hold the statistics of
+        // other data: it is neither read nor written
+        const std::string key = otb::StatisticsSidecarFile::ComputeFileFingerprint(fileNames[imageId]);
+        if (key.empty())
+        {
+          otbAppLogWARNING("Image #" << imageId + 1 << " (" << fileNames[imageId] << ") is not a local file, its statistics are not cached");
+        }
+        else
+        {
+          statsEstimator->SetStatisticsFileName(otb::StatisticsSidecarFile::GetSidecarFileName(fileNames[imageId]));
+          statsEstimator->SetStatisticsFileKey(key);
+        }
+      }
       statsEstimator->Update();
 
+      if (statsEstimator->GetStatisticsReadFromFile())
+      {
+        otbAppLogINFO("Statistics of image #" << imageId + 1 << " read from " << statsEstimator->GetStatisticsFileName());
+      }
+
       MeasurementType nbRelevantPixels = statsEstimator->GetNbRelevantPixels();
       MeasurementType meanPerBand      = statsEstimator->GetMean();
 
@@ -29,6 +29,11 @@
 #include "otbMultiToMonoChannelExtractROI.h"
 #include "otbImageToVectorImageCastFilter.h"
 #include "otbMachineLearningModelFactory.h"
+#include "otbConfigure.h"
+
+#ifdef OTB_USE_OPENCV
+#include "otbRandomForestsMachineLearningModel.h"
+#endif
 
 namespace otb
 {
@@ -149,6 +154,12 @@ private:
     SetDefaultOutputPixelType("probamap", ImagePixelType_uint16);
     MandatoryOff("probamap");
 
+    AddParameter(ParameterType_Bool, "compiledforest", "Use compiled forest");
+    SetParameterDescription("compiledforest",
+                            "Predict with a flat, compiled copy of the forest instead of the OpenCV implementation. "
+                            "This speeds up the prediction of large images. "
+                            "Only available for random forests models trained with OpenCV (rf), ignored for other models.");
+
     AddRAMParameter();
 
     SetMultiWriting(true);
@@ -189,6 +200,29 @@ private:
     m_Model->Load(GetParameterString("model"));
     otbAppLogINFO("Model loaded");
 
+#ifdef OTB_USE_OPENCV
+    if (GetParameterInt("compiledforest"))
+    {
+      typedef otb::RandomForestsMachineLearningModel<ValueType, LabelType> RandomForestsModelType;
+      RandomForestsModelType* randomForests = dynamic_cast<RandomForestsModelType*>(m_Model.GetPointer());
+      if (randomForests == nullptr)
+      {
+        otbAppLogWARNING("Compiled forest is only available for OpenCV random forests models, option ignored.");
+      }
+      else
+      {
+        randomForests->SetUseCompiledForest(true);
+        if (randomForests->IsCompiledForestUsed())
+          otbAppLogINFO("Using compiled forest for prediction");
+      }
+    }
+#else
+    if (GetParameterInt("compiledforest"))
+    {
+      otbAppLogWARNING("Compiled forest is only available for OpenCV random forests models, option ignored.");
+    }
+#endif
+
     // Normalize input image (optional)
     StatisticsReader::Pointer statisticsReader = StatisticsReader::New();
     MeasurementType           meanMeasurementVector;
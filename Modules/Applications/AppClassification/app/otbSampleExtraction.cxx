@@ -22,6 +22,7 @@
 #include "otbWrapperApplicationFactory.h"
 
 #include "otbImageSampleExtractorFilter.h"
+#include "otbSampleStore.h"
 
 namespace otb
 {
@@ -57,7 +58,10 @@ private:
     // Documentation
     SetDocLongDescription(
         "The application extracts samples values from an"
-        "image using positions contained in a vector data file. ");
+        "image using positions contained in a vector data file. "
+        "When the samples are written to a new file, each streamed region "
+        "only reads the image block bounding its sample positions, and only "
+        "the samples of this region are kept in memory.");
     SetDocLimitations("None");
     SetDocAuthors("OTB-Team");
     SetDocSeeAlso(" ");
@@ -78,6 +82,15 @@ private:
                             "values (OGR format). If not given, the input vector data file is updated");
     MandatoryOff("out");
 
+    AddParameter(ParameterType_OutputFilename, "outstore", "Output sample store");
+    SetParameterDescription("outstore",
+                            "Also write the sample values and the class field "
+                            "to a columnar sample store, which training "
+                            "applications read faster than OGR files "
+                            "(see SampleStoreConversion). A class field stored "
+                            "as text must hold numbers.");
+    MandatoryOff("outstore");
+
     AddParameter(ParameterType_Choice, "outfield", "Output field names");
     SetParameterDescription("outfield", "Choice between naming method for output fields");
 
@@ -209,6 +222,17 @@ private:
     AddProcess(filter->GetStreamer(), "Extracting sample values...");
     filter->Update();
     output->SyncToDisk();
+
+    if (IsParameterEnabled("outstore") && HasValue("outstore"))
+    {
+      ogr::Layer               outLayer   = output == vectors ? output->GetLayer(this->GetParameterInt("layer")) : output->GetLayer(0);
+      std::vector<std::string> storeNames = filter->GetOutputFieldNames();
+      storeNames.push_back(fieldName);
+
+      otb::SampleStore store;
+      store.ImportLayer(outLayer, storeNames);
+      store.Save(this->GetParameterString("outstore"));
+    }
   }
 };
 
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbWrapperApplication.h"
+#include "otbWrapperApplicationFactory.h"
+#include "otbOGRDataSourceWrapper.h"
+#include "otbSampleStore.h"
+
+namespace otb
+{
+namespace Wrapper
+{
+
+class SampleStoreConversion : public Application
+{
+public:
+  /** Standard class typedefs. */
+  typedef SampleStoreConversion         Self;
+  typedef Application                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Standard macro */
+  itkNewMacro(Self);
+
+  itkTypeMacro(SampleStoreConversion, otb::Application);
+
+private:
+  SampleStoreConversion()
+  {
+  }
+
+  void DoInit() override
+  {
+    SetName("SampleStoreConversion");
+    SetDescription("Converts a sample data file into a columnar sample store.");
+
+    // Documentation
+    SetDocLongDescription(
+        "The application converts the fields of a sample data file, as "
+        "generated by the SampleExtraction application, into a sample store. "
+        "A sample store keeps each field in a contiguous binary column, so "
+        "that training applications (TrainVectorClassifier, "
+        "TrainVectorRegression, TrainDimensionalityReduction) read it much "
+        "faster than an OGR file. These applications accept sample stores "
+        "in place of vector files.\n\n"
+        "Integer and real fields keep their type. String fields (for instance "
+        "class labels stored as text) are converted to real values.");
+    SetDocLimitations("Geometries are not stored. Sample stores use the byte order of the machine which wrote them.");
+    SetDocAuthors("OTB-Team");
+    SetDocSeeAlso("SampleExtraction, TrainVectorClassifier");
+
+    AddDocTag(Tags::Learning);
+
+    AddParameter(ParameterType_InputFilename, "in", "Input samples");
+    SetParameterDescription("in", "Vector data file containing samples (OGR format)");
+
+    AddParameter(ParameterType_Int, "layer", "Layer Index");
+    SetParameterDescription("layer", "Layer index to read in the input vector file.");
+    MandatoryOff("layer");
+    SetDefaultParameterInt("layer", 0);
+
+    AddParameter(ParameterType_ListView, "field", "Field names");
+    SetParameterDescription("field", "Fields to store (features and label). If none is selected, all the integer and real fields are stored.");
+    MandatoryOff("field");
+
+    AddParameter(ParameterType_OutputFilename, "out", "Output sample store");
+    SetParameterDescription("out", "Output sample store file");
+
+    // Doc example parameter settings
+    SetDocExampleParameterValue("in", "samples.sqlite");
+    SetDocExampleParameterValue("field", "value_0 value_1 value_2 value_3 class");
+    SetDocExampleParameterValue("out", "samples.smp");
+
+    SetOfficialDocLink();
+  }
+
+  void DoUpdateParameters() override
+  {
+    if (HasValue("in"))
+    {
+      std::string              vectorFile = GetParameterString("in");
+      ogr::DataSource::Pointer ogrDS      = ogr::DataSource::New(vectorFile, ogr::DataSource::Modes::Read);
+      ogr::Layer               layer      = ogrDS->GetLayer(this->GetParameterInt("layer"));
+      OGRFeatureDefn&          layerDefn  = layer.GetLayerDefn();
+
+      ClearChoices("field");
+
+      for (int iField = 0; iField < layerDefn.GetFieldCount(); iField++)
+      {
+        std::string key, item = layerDefn.GetFieldDefn(iField)->GetNameRef();
+        key                       = item;
+        std::string::iterator end = std::remove_if(key.begin(), key.end(), [](char c) { return !std::isalnum(c); });
+        std::transform(key.begin(), end, key.begin(), tolower);
+
+        OGRFieldType fieldType = layerDefn.GetFieldDefn(iField)->GetType();
+
+        if (fieldType == OFTString || fieldType == OFTInteger || fieldType == OFTInteger64 || fieldType == OFTReal)
+        {
+          std::string tmpKey = "field." + key.substr(0, static_cast<unsigned long>(end - key.begin()));
+          AddChoice(tmpKey, item);
+        }
+      }
+    }
+  }
+
+  void DoExecute() override
+  {
+    ogr::DataSource::Pointer vectors = ogr::DataSource::New(this->GetParameterString("in"), ogr::DataSource::Modes::Read);
+    ogr::Layer               layer   = vectors->GetLayer(this->GetParameterInt("layer"));
+
+    std::vector<std::string> fieldNames;
+    std::vector<std::string> choiceNames = GetChoiceNames("field");
+    for (int idx : GetSelectedItems("field"))
+    {
+      fieldNames.push_back(choiceNames[idx]);
+    }
+    if (fieldNames.empty())
+    {
+      OGRFeatureDefn& layerDefn = layer.GetLayerDefn();
+      for (int iField = 0; iField < layerDefn.GetFieldCount(); iField++)
+      {
+        OGRFieldType fieldType = layerDefn.GetFieldDefn(iField)->GetType();
+        if (fieldType == OFTInteger || fieldType == OFTInteger64 || fieldType == OFTReal)
+        {
+          fieldNames.push_back(layerDefn.GetFieldDefn(iField)->GetNameRef());
+        }
+      }
+    }
+    if (fieldNames.empty())
+    {
+      otbAppLogFATAL(<< "No field to store in layer " << this->GetParameterInt("layer") << " of " << this->GetParameterString("in"));
+    }
+
+    otb::SampleStore store;
+    store.ImportLayer(layer, fieldNames);
+    store.Save(this->GetParameterString("out"));
+
+    otbAppLogINFO(<< store.GetNumberOfSamples() << " samples of " << fieldNames.size() << " fields written to " << this->GetParameterString("out"));
+  }
+};
+
+} // end of namespace Wrapper
+} // end of namespace otb
+
+OTB_APPLICATION_EXPORT(otb::Wrapper::SampleStoreConversion)
@@ -89,6 +89,12 @@ void VectorClassifier::DoInitSpecialization()
                           "majority classes) is not available for now.\n"
                           "* SVM: distance to margin (only works for 2-class models)\n");
 
+  AddParameter(ParameterType_Bool, "compiledforest", "Use compiled forest");
+  SetParameterDescription("compiledforest",
+                          "Predict with a flat, compiled copy of the forest instead of the OpenCV implementation. "
+                          "This speeds up the prediction of large images. "
+                          "Only available for random forests models trained with OpenCV (rf), ignored for other models.");
+
   AddParameter(ParameterType_OutputFilename, "out", "Output vector data file");
   MandatoryOff("out");
   SetParameterDescription("out",
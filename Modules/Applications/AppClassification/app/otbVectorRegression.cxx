@@ -74,6 +74,12 @@ void VectorRegression::DoInitSpecialization()
                           "List of field names in the input vector data used as features for training. "
                           "Put the same field names as the TrainVectorRegression application.");
 
+  AddParameter(ParameterType_Bool, "compiledforest", "Use compiled forest");
+  SetParameterDescription("compiledforest",
+                          "Predict with a flat, compiled copy of the forest instead of the OpenCV implementation. "
+                          "This speeds up the prediction of large images. "
+                          "Only available for random forests models trained with OpenCV (rf), ignored for other models.");
+
   AddParameter(ParameterType_OutputFilename, "out", "Output vector data file");
   MandatoryOff("out");
 
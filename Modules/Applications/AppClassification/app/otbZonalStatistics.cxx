@@ -40,6 +40,8 @@
 
 #include "otbFunctorImageFilter.h"
 
+#include <algorithm>
+
 namespace otb
 {
 
@@ -73,25 +75,31 @@ public:
   template <class TInput, class TOutput>
   struct EncoderFunctorType
   {
-    StatsFilterType::LabelPopulationMapType* m_CountMap;
-    StatsFilterType::PixelValueMapType*      m_MeanMap;
-    StatsFilterType::PixelValueMapType*      m_StdMap;
-    StatsFilterType::PixelValueMapType*      m_MinMap;
-    StatsFilterType::PixelValueMapType*      m_MaxMap;
-    size_t                                   m_NbInputComponents;
-    LabelValueType                           m_InNoData;
-    LabelValueType                           m_OutBvValue;
-    static constexpr size_t                  m_NbStatsPerBand{4};
-    static constexpr size_t                  m_NbGlobalStats{1};
+    StatsFilterType::LabelPopulationMapType*         m_CountMap;
+    StatsFilterType::PixelValueMapType*              m_MeanMap;
+    StatsFilterType::PixelValueMapType*              m_StdMap;
+    StatsFilterType::PixelValueMapType*              m_MinMap;
+    StatsFilterType::PixelValueMapType*              m_MaxMap;
+    std::vector<StatsFilterType::PixelValueMapType>* m_PercentileMaps = nullptr;
+    StatsFilterType::PixelValueMapType*              m_MajorityMap    = nullptr;
+    size_t                                           m_NbInputComponents;
+    size_t                                           m_NbCategoricalBands = 0;
+    LabelValueType                                   m_InNoData;
+    LabelValueType                                   m_OutBvValue;
+    static constexpr size_t                          m_NbStatsPerBand{4};
+    static constexpr size_t                          m_NbGlobalStats{1};
 
     size_t OutputSize(const std::array<size_t, 1>&) const
     {
-      return m_NbInputComponents * m_NbStatsPerBand + m_NbGlobalStats;
+      return OutputSize();
     }
 
+    // Percentiles of each band, then majority of each categorical band,
+    // follow the statistics of each band
     size_t OutputSize() const
     {
-      return m_NbInputComponents * m_NbStatsPerBand + m_NbGlobalStats;
+      const size_t nbPercentiles = m_PercentileMaps != nullptr ? m_PercentileMaps->size() : 0;
+      return m_NbInputComponents * (m_NbStatsPerBand + nbPercentiles) + m_NbGlobalStats + m_NbCategoricalBands;
     }
 
     TOutput operator()(TInput const& pix)
@@ -108,6 +116,18 @@ public:
           outPix[i * m_NbStatsPerBand + 3] = (*m_MinMap)[pix][i];
           outPix[i * m_NbStatsPerBand + 4] = (*m_MaxMap)[pix][i];
         }
+        size_t offset = m_NbInputComponents * m_NbStatsPerBand + m_NbGlobalStats;
+        for (size_t p = 0; m_PercentileMaps != nullptr && p < m_PercentileMaps->size(); ++p)
+        {
+          for (size_t i = 0; i < m_NbInputComponents; ++i)
+          {
+            outPix[offset++] = (*m_PercentileMaps)[p][pix][i];
+          }
+        }
+        for (size_t i = 0; i < m_NbCategoricalBands; ++i)
+        {
+          outPix[offset++] = (*m_MajorityMap)[pix][i];
+        }
       }
       return outPix;
     }
@@ -115,7 +135,8 @@ public:
     bool operator!=(const EncoderFunctorType& other)
     {
       if (m_CountMap != other.m_CountMap || m_MeanMap != other.m_MeanMap || m_StdMap != other.m_StdMap || m_MinMap != other.m_MinMap ||
-          m_MaxMap != other.m_MaxMap || m_NbInputComponents != other.m_NbInputComponents || m_InNoData != other.m_InNoData ||
+          m_MaxMap != other.m_MaxMap || m_PercentileMaps != other.m_PercentileMaps || m_MajorityMap != other.m_MajorityMap ||
+          m_NbInputComponents != other.m_NbInputComponents || m_NbCategoricalBands != other.m_NbCategoricalBands || m_InNoData != other.m_InNoData ||
           m_OutBvValue != other.m_OutBvValue)
         return true;
       else
@@ -140,7 +161,10 @@ public:
         "The application inputs one input multiband image, and another input for zones definition. "
         "Zones can be defined with a label image (inzone.labelimage.in) or a vector data layer "
         "(inzone.vector.in). The following statistics are computed over each zones: mean, min, max, "
-        "and standard deviation. Statistics can be exported in a vector layer (if the input zone "
+        "and standard deviation. Percentiles of each band (percentiles) and the majority value of "
+        "bands holding categories (catbands) can also be computed in the same pass. Percentiles are "
+        "estimated with a few hundreds of values per zone and band, they are exact for small zones. "
+        "Statistics can be exported in a vector layer (if the input zone "
         "definition is a label image, it will be vectorized) or in a XML file");
     SetDocLimitations(
         "1) The inzone.vector.in must fit in memory (if \"inzone\" is \"vector\"). 2) The vectorized label "
@@ -157,6 +181,14 @@ public:
     AddParameter(ParameterType_Float, "inbv", "Background value to ignore in statistics computation");
     MandatoryOff("inbv");
 
+    // Additional statistics
+    AddParameter(ParameterType_StringList, "percentiles", "Percentiles");
+    SetParameterDescription("percentiles", "Percentiles (in [0, 100]) to compute for each band, in fields or bands named p<percentile>_<band>.");
+    MandatoryOff("percentiles");
+    AddParameter(ParameterType_ListView, "catbands", "Categorical bands");
+    SetParameterDescription("catbands", "Bands holding categories, whose majority value is computed, in fields or bands named majority_<band>.");
+    MandatoryOff("catbands");
+
     // Input zone mode
     AddParameter(ParameterType_Choice, "inzone", "Type of input for the zone definitions");
     AddChoice("inzone.vector", "Input objects from vector data");
@@ -196,7 +228,23 @@ public:
 
   void DoUpdateParameters() override
   {
-    // Nothing to do here : all parameters are independent
+    if (HasValue("in"))
+    {
+      // Update the bands that can be selected as categorical bands
+      const unsigned int nbComponents  = GetParameterImage("in")->GetNumberOfComponentsPerPixel();
+      ListViewParameter* catBandsParam = dynamic_cast<ListViewParameter*>(GetParameterByKey("catbands"));
+      if (catBandsParam != nullptr && catBandsParam->GetNbChoices() != nbComponents)
+      {
+        ClearChoices("catbands");
+        for (unsigned int idx = 0; idx < nbComponents; ++idx)
+        {
+          std::ostringstream key, item;
+          key << "catbands.channel" << idx + 1;
+          item << "Channel" << idx + 1;
+          AddChoice(key.str(), item.str());
+        }
+      }
+    }
   }
 
   // Returns a string of the kind "prefix_i"
@@ -207,6 +255,16 @@ public:
     return ss.str();
   }
 
+  // Returns a string of the kind "p50" or "p2_5" for a percentile
+  const std::string CreatePercentileName(double percentile)
+  {
+    std::stringstream ss;
+    ss << "p" << percentile;
+    std::string name = ss.str();
+    std::replace(name.begin(), name.end(), '.', '_');
+    return name;
+  }
+
   // Returns a null pixel which has the same number of components per pixels as img
   FloatVectorImageType::PixelType NullPixel(FloatVectorImageType::Pointer& img)
   {
@@ -223,6 +281,39 @@ public:
     m_StdMap   = m_StatsFilter->GetStandardDeviationValueMap();
     m_MinMap   = m_StatsFilter->GetMinValueMap();
     m_MaxMap   = m_StatsFilter->GetMaxValueMap();
+    m_PercentileMaps.clear();
+    for (unsigned int p = 0; p < m_Percentiles.size(); p++)
+    {
+      m_PercentileMaps.push_back(m_StatsFilter->GetPercentileValueMap(p));
+    }
+    m_MajorityMap = m_StatsFilter->GetMajorityValueMap();
+  }
+
+  void SetAdditionalStatistics()
+  {
+    m_Percentiles.clear();
+    for (const auto& value : GetParameterStringList("percentiles"))
+    {
+      try
+      {
+        m_Percentiles.push_back(std::stod(value));
+      }
+      catch (std::exception&)
+      {
+        otbAppLogFATAL("Invalid percentile: " << value);
+      }
+      if (!(m_Percentiles.back() >= 0 && m_Percentiles.back() <= 100))
+      {
+        otbAppLogFATAL("Percentiles should be in range [0, 100]");
+      }
+    }
+    m_CategoricalBands.clear();
+    for (int band : GetSelectedItems("catbands"))
+    {
+      m_CategoricalBands.push_back(band);
+    }
+    m_StatsFilter->SetPercentiles(m_Percentiles);
+    m_StatsFilter->SetCategoricalBands(m_CategoricalBands);
   }
 
   void PrepareForLabelImageInput()
@@ -248,12 +339,28 @@ public:
       ReprojectVectorDataIntoInputImage();
     }
     RasterizeInputVectorData();
-    // Computing stats
+    // Computing stats. Features are burnt with labels 0 to N-1, and can be
+    // accumulated in arrays rather than in maps
+    const unsigned int nbFeatures = CountFeatures();
+    if (nbFeatures > 0)
+      m_StatsFilter->SetLabelRange(0, nbFeatures - 1);
     m_StatsFilter->SetInputLabelImage(m_RasterizeFilter->GetOutput());
     m_StatsFilter->Update();
     GetStats();
   }
 
+  unsigned int CountFeatures()
+  {
+    unsigned int     nbFeatures = 0;
+    TreeIteratorType itVector(m_VectorDataSrc->GetDataTree());
+    for (itVector.GoToBegin(); !itVector.IsAtEnd(); ++itVector)
+    {
+      if (!itVector.Get()->IsRoot() && !itVector.Get()->IsDocument() && !itVector.Get()->IsFolder())
+        nbFeatures++;
+    }
+    return nbFeatures;
+  }
+
   void ReprojectVectorDataIntoInputImage()
   {
     otbAppLogINFO("Vector data reprojection enabled");
@@ -292,6 +399,9 @@ public:
       m_StdMap.erase(m_IntNoData);
       m_MinMap.erase(m_IntNoData);
       m_MaxMap.erase(m_IntNoData);
+      for (auto& percentileMap : m_PercentileMaps)
+        percentileMap.erase(m_IntNoData);
+      m_MajorityMap.erase(m_IntNoData);
     }
   }
 
@@ -356,7 +466,11 @@ public:
             currentGeometry->SetFieldAsDouble(CreateFieldName("stdev", band), m_StdMap[internalFID][band]);
             currentGeometry->SetFieldAsDouble(CreateFieldName("min", band), m_MinMap[internalFID][band]);
             currentGeometry->SetFieldAsDouble(CreateFieldName("max", band), m_MaxMap[internalFID][band]);
+            for (unsigned int p = 0; p < m_Percentiles.size(); p++)
+              currentGeometry->SetFieldAsDouble(CreateFieldName(CreatePercentileName(m_Percentiles[p]), band), m_PercentileMaps[p][internalFID][band]);
           }
+          for (unsigned int i = 0; i < m_CategoricalBands.size(); i++)
+            currentGeometry->SetFieldAsDouble(CreateFieldName("majority", m_CategoricalBands[i]), m_MajorityMap[internalFID][i]);
           m_NewVectorData->GetDataTree()->Add(currentGeometry, folder);
         }
       }
@@ -398,14 +512,17 @@ public:
       m_EncoderFilter->SetInput(m_RasterizeFilter->GetOutput());
     }
 
-    m_EncoderFilter->GetModifiableFunctor().m_CountMap          = &m_CountMap;
-    m_EncoderFilter->GetModifiableFunctor().m_MeanMap           = &m_MeanMap;
-    m_EncoderFilter->GetModifiableFunctor().m_StdMap            = &m_StdMap;
-    m_EncoderFilter->GetModifiableFunctor().m_MinMap            = &m_MinMap;
-    m_EncoderFilter->GetModifiableFunctor().m_MaxMap            = &m_MaxMap;
-    m_EncoderFilter->GetModifiableFunctor().m_NbInputComponents = m_InputImage->GetNumberOfComponentsPerPixel();
-    m_EncoderFilter->GetModifiableFunctor().m_InNoData          = m_IntNoData;
-    m_EncoderFilter->GetModifiableFunctor().m_OutBvValue        = m_OutBvValue;
+    m_EncoderFilter->GetModifiableFunctor().m_CountMap           = &m_CountMap;
+    m_EncoderFilter->GetModifiableFunctor().m_MeanMap            = &m_MeanMap;
+    m_EncoderFilter->GetModifiableFunctor().m_StdMap             = &m_StdMap;
+    m_EncoderFilter->GetModifiableFunctor().m_MinMap             = &m_MinMap;
+    m_EncoderFilter->GetModifiableFunctor().m_MaxMap             = &m_MaxMap;
+    m_EncoderFilter->GetModifiableFunctor().m_PercentileMaps     = &m_PercentileMaps;
+    m_EncoderFilter->GetModifiableFunctor().m_MajorityMap        = &m_MajorityMap;
+    m_EncoderFilter->GetModifiableFunctor().m_NbInputComponents  = m_InputImage->GetNumberOfComponentsPerPixel();
+    m_EncoderFilter->GetModifiableFunctor().m_NbCategoricalBands = m_CategoricalBands.size();
+    m_EncoderFilter->GetModifiableFunctor().m_InNoData           = m_IntNoData;
+    m_EncoderFilter->GetModifiableFunctor().m_OutBvValue         = m_OutBvValue;
 
     otbAppLogINFO("Output raster image will have " << (m_EncoderFilter->GetFunctor()).OutputSize() << " bands\n");
     AddProcess(m_EncoderFilter, "Encode output raster image");
@@ -423,6 +540,10 @@ public:
     statWriter->AddInputMap<StatsFilterType::PixelValueMapType>("std", m_StdMap);
     statWriter->AddInputMap<StatsFilterType::PixelValueMapType>("min", m_MinMap);
     statWriter->AddInputMap<StatsFilterType::PixelValueMapType>("max", m_MaxMap);
+    for (unsigned int p = 0; p < m_Percentiles.size(); p++)
+      statWriter->AddInputMap<StatsFilterType::PixelValueMapType>(CreatePercentileName(m_Percentiles[p]).c_str(), m_PercentileMaps[p]);
+    if (!m_CategoricalBands.empty())
+      statWriter->AddInputMap<StatsFilterType::PixelValueMapType>("majority", m_MajorityMap);
     statWriter->Update();
   }
 
@@ -438,6 +559,7 @@ public:
       m_StatsFilter->SetUseNoDataValue(true);
       m_StatsFilter->SetNoDataValue(GetParameterFloat("inbv"));
     }
+    SetAdditionalStatistics();
     m_StatsFilter->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"));
     AddProcess(m_StatsFilter->GetStreamer(), "Computing statistics");
     // Select zone definition mode
@@ -481,24 +603,28 @@ public:
     }
   }
 
-  VectorDataType::Pointer                 m_VectorDataSrc;
-  VectorDataType::Pointer                 m_NewVectorData;
-  VectorDataReprojFilterType::Pointer     m_VectorDataReprojectionFilter;
-  RasterizeFilterType::Pointer            m_RasterizeFilter;
-  StatsFilterType::Pointer                m_StatsFilter;
-  LabelImageToVectorFilterType::Pointer   m_LabelImageToVectorFilter;
-  ThresholdFilterType::Pointer            m_InputThresholdFilter;
-  ThresholdFilterType::Pointer            m_OutputThresholdFilter;
-  FloatVectorImageType::Pointer           m_InputImage;
-  LabelValueType                          m_IntNoData      = itk::NumericTraits<LabelValueType>::max();
-  LabelValueType                          m_OutBvValue     = itk::NumericTraits<LabelValueType>::max();
-  bool                                    m_FromLabelImage = false;
-  StatsFilterType::LabelPopulationMapType m_CountMap;
-  StatsFilterType::PixelValueMapType      m_MeanMap;
-  StatsFilterType::PixelValueMapType      m_StdMap;
-  StatsFilterType::PixelValueMapType      m_MinMap;
-  StatsFilterType::PixelValueMapType      m_MaxMap;
-  EncoderFilterType::Pointer              m_EncoderFilter;
+  VectorDataType::Pointer                         m_VectorDataSrc;
+  VectorDataType::Pointer                         m_NewVectorData;
+  VectorDataReprojFilterType::Pointer             m_VectorDataReprojectionFilter;
+  RasterizeFilterType::Pointer                    m_RasterizeFilter;
+  StatsFilterType::Pointer                        m_StatsFilter;
+  LabelImageToVectorFilterType::Pointer           m_LabelImageToVectorFilter;
+  ThresholdFilterType::Pointer                    m_InputThresholdFilter;
+  ThresholdFilterType::Pointer                    m_OutputThresholdFilter;
+  FloatVectorImageType::Pointer                   m_InputImage;
+  LabelValueType                                  m_IntNoData      = itk::NumericTraits<LabelValueType>::max();
+  LabelValueType                                  m_OutBvValue     = itk::NumericTraits<LabelValueType>::max();
+  bool                                            m_FromLabelImage = false;
+  StatsFilterType::LabelPopulationMapType         m_CountMap;
+  StatsFilterType::PixelValueMapType              m_MeanMap;
+  StatsFilterType::PixelValueMapType              m_StdMap;
+  StatsFilterType::PixelValueMapType              m_MinMap;
+  StatsFilterType::PixelValueMapType              m_MaxMap;
+  std::vector<double>                             m_Percentiles;
+  std::vector<unsigned int>                       m_CategoricalBands;
+  std::vector<StatsFilterType::PixelValueMapType> m_PercentileMaps;
+  StatsFilterType::PixelValueMapType              m_MajorityMap;
+  EncoderFilterType::Pointer                      m_EncoderFilter;
 };
 }
 }
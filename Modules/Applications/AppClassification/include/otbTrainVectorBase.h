@@ -26,12 +26,14 @@
 
 #include "otbOGRDataSourceWrapper.h"
 #include "otbOGRFeatureWrapper.h"
+#include "otbSampleStore.h"
 #include "otbStatisticsXMLFileWriter.h"
 
 #include "itkVariableLengthVector.h"
 #include "otbStatisticsXMLFileReader.h"
 
 #include "itkListSample.h"
+#include "otbDenseListSample.h"
 #include "otbShiftScaleSampleListFilter.h"
 
 #include <algorithm>
@@ -65,7 +67,11 @@ public:
 
   typedef otb::StatisticsXMLFileReader<SampleType> StatisticsReader;
 
-  typedef otb::Statistics::ShiftScaleSampleListFilter<ListSampleType, ListSampleType> ShiftScaleFilterType;
+  /** Normalized samples are stored in a contiguous buffer, which some
+   * models can use without copying it */
+  typedef otb::DenseListSample<typename Superclass::InputValueType> DenseListSampleType;
+
+  typedef otb::Statistics::ShiftScaleSampleListFilter<ListSampleType, DenseListSampleType> ShiftScaleFilterType;
 
 protected:
   /** Class used to store statistics Measurment (mean/stddev) */
@@ -163,6 +169,16 @@ protected:
    */
   SamplesWithLabel ExtractSamplesWithLabel(std::string parameterName, std::string parameterLayer, const ShiftScaleParameters& measurement);
 
+  /**
+   * Append the selected features and labels of a sample store (see SampleStoreConversion)
+   * The features are copied once, from the columns of the store to the
+   * buffer of input. The whole store is in memory during this copy.
+   * \param fileName the sample store file.
+   * \param input the list of samples to fill.
+   * \param target the list of labels to fill.
+   */
+  void ReadSampleStore(const std::string& fileName, DenseListSampleType* input, TargetListSampleType* target);
+
 
   /**
    * Retrieve statistics mean and standard deviation if input statistics are provided.
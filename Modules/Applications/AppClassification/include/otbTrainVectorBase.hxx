@@ -35,7 +35,9 @@ void TrainVectorBase<TInputValue, TOutputValue>::DoInit()
   this->SetParameterDescription("io", "This group of parameters allows setting input and output data.");
 
   this->AddParameter(ParameterType_InputVectorDataList, "io.vd", "Input Vector Data");
-  this->SetParameterDescription("io.vd", "Input geometries used for training (note: all geometries from the layer will be used)");
+  this->SetParameterDescription("io.vd",
+                                "Input geometries used for training (note: all geometries from the layer will be used). "
+                                "Sample stores (see SampleStoreConversion) can be used instead of vector files.");
 
   this->AddParameter(ParameterType_InputFilename, "io.stats", "Input XML image statistics file");
   this->MandatoryOff("io.stats");
@@ -100,32 +102,51 @@ void TrainVectorBase<TInputValue, TOutputValue>::DoUpdateParameters()
   if (this->HasValue("io.vd"))
   {
     std::vector<std::string> vectorFileList = this->GetParameterStringList("io.vd");
-    ogr::DataSource::Pointer ogrDS          = ogr::DataSource::New(vectorFileList[0], ogr::DataSource::Modes::Read);
-    ogr::Layer               layer          = ogrDS->GetLayer(static_cast<size_t>(this->GetParameterInt("layer")));
-    ogr::Feature             feature        = layer.ogr().GetNextFeature();
+
+    // Numeric fields are candidates for features, numeric and string fields for labels
+    std::vector<std::pair<std::string, bool>> fields;
+    if (SampleStore::CanReadFile(vectorFileList[0]))
+    {
+      SampleStore store;
+      store.LoadInformation(vectorFileList[0]);
+      for (const auto& column : store.GetColumns())
+      {
+        fields.push_back(std::make_pair(column.Name, true));
+      }
+    }
+    else
+    {
+      ogr::DataSource::Pointer ogrDS   = ogr::DataSource::New(vectorFileList[0], ogr::DataSource::Modes::Read);
+      ogr::Layer               layer   = ogrDS->GetLayer(static_cast<size_t>(this->GetParameterInt("layer")));
+      ogr::Feature             feature = layer.ogr().GetNextFeature();
+
+      for (int iField = 0; iField < feature.ogr().GetFieldCount(); iField++)
+      {
+        OGRFieldType fieldType = feature.ogr().GetFieldDefnRef(iField)->GetType();
+        if (fieldType == OFTString || fieldType == OFTInteger || fieldType == OFTInteger64 || fieldType == OFTReal)
+        {
+          fields.push_back(std::make_pair(feature.ogr().GetFieldDefnRef(iField)->GetNameRef(), fieldType != OFTString));
+        }
+      }
+    }
 
     this->ClearChoices("feat");
     this->ClearChoices("cfield");
 
-    for (int iField = 0; iField < feature.ogr().GetFieldCount(); iField++)
+    for (const auto& field : fields)
     {
-      std::string key, item = feature.ogr().GetFieldDefnRef(iField)->GetNameRef();
+      std::string key, item = field.first;
       key                       = item;
       std::string::iterator end = std::remove_if(key.begin(), key.end(), [](char c) { return !std::isalnum(c); });
       std::transform(key.begin(), end, key.begin(), tolower);
 
-      OGRFieldType fieldType = feature.ogr().GetFieldDefnRef(iField)->GetType();
-
-      if (fieldType == OFTInteger || fieldType == OFTInteger64 || fieldType == OFTReal)
+      if (field.second)
       {
         std::string tmpKey = "feat." + key.substr(0, static_cast<unsigned long>(end - key.begin()));
         this->AddChoice(tmpKey, item);
       }
-      if (fieldType == OFTString || fieldType == OFTInteger || fieldType == OFTInteger64 || fieldType == OFTReal)
-      {
-        std::string tmpKey = "cfield." + key.substr(0, static_cast<unsigned long>(end - key.begin()));
-        this->AddChoice(tmpKey, item);
-      }
+      std::string tmpKey = "cfield." + key.substr(0, static_cast<unsigned long>(end - key.begin()));
+      this->AddChoice(tmpKey, item);
     }
   }
 }
@@ -222,13 +243,20 @@ TrainVectorBase<TInputValue, TOutputValue>::ExtractSamplesWithLabel(std::string
   SamplesWithLabel samplesWithLabel;
   if (this->HasValue(parameterName) && this->IsParameterEnabled(parameterName))
   {
-    typename ListSampleType::Pointer       input  = ListSampleType::New();
+    typename DenseListSampleType::Pointer  input  = DenseListSampleType::New();
     typename TargetListSampleType::Pointer target = TargetListSampleType::New();
     input->SetMeasurementVectorSize(m_FeaturesInfo.m_NbFeatures);
 
     std::vector<std::string> fileList = this->GetParameterStringList(parameterName);
     for (unsigned int k = 0; k < fileList.size(); k++)
     {
+      if (SampleStore::CanReadFile(fileList[k]))
+      {
+        otbAppLogINFO("Reading sample store " << k + 1 << "/" << fileList.size());
+        this->ReadSampleStore(fileList[k], input, target);
+        continue;
+      }
+
       otbAppLogINFO("Reading vector file " << k + 1 << "/" << fileList.size());
       ogr::DataSource::Pointer source  = ogr::DataSource::New(fileList[k], ogr::DataSource::Modes::Read);
       ogr::Layer               layer   = source->GetLayer(static_cast<size_t>(this->GetParameterInt(parameterLayer)));
@@ -325,6 +353,49 @@ TrainVectorBase<TInputValue, TOutputValue>::ExtractSamplesWithLabel(std::string
 
   return samplesWithLabel;
 }
+
+template <class TInputValue, class TOutputValue>
+void TrainVectorBase<TInputValue, TOutputValue>::ReadSampleStore(const std::string& fileName, DenseListSampleType* input, TargetListSampleType* target)
+{
+  SampleStore store;
+  store.Load(fileName);
+  const unsigned long nbSamples = store.GetNumberOfSamples();
+  if (nbSamples == 0)
+  {
+    otbAppLogWARNING("The sample store " << fileName << " is empty, input is skipped.");
+    return;
+  }
+
+  // Check all needed columns are present
+  int cColumn = store.GetColumnIndex(m_FeaturesInfo.m_SelectedCFieldName);
+  if (cColumn < 0 && !m_FeaturesInfo.m_SelectedCFieldName.empty())
+  {
+    otbAppLogFATAL("The field name for class label (" << m_FeaturesInfo.m_SelectedCFieldName << ") has not been found in the sample store " << fileName);
+  }
+
+  const unsigned int        nbFeatures = m_FeaturesInfo.m_NbFeatures;
+  std::vector<unsigned int> featureColumns(nbFeatures);
+  for (unsigned int i = 0; i < nbFeatures; i++)
+  {
+    int column = store.GetColumnIndex(m_FeaturesInfo.m_SelectedNames[i]);
+    if (column < 0)
+      otbAppLogFATAL("The field name for feature " << m_FeaturesInfo.m_SelectedNames[i] << " has not been found in the sample store " << fileName);
+    featureColumns[i] = static_cast<unsigned int>(column);
+  }
+
+  std::vector<ValueType> labels(nbSamples, 0.);
+  if (cColumn >= 0)
+  {
+    store.GetColumn(static_cast<unsigned int>(cColumn), labels.data());
+  }
+
+  // Features go straight from the columns to the buffer of the list
+  store.GetSamples(featureColumns, input->PushBackSamples(nbSamples));
+  for (unsigned long s = 0; s < nbSamples; ++s)
+  {
+    target->PushBack(labels[s]);
+  }
+}
 }
 }
 
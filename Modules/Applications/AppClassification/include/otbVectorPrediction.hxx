@@ -22,6 +22,11 @@
 #define otbVectorPrediction_hxx
 
 #include "otbVectorPrediction.h"
+#include "otbConfigure.h"
+
+#ifdef OTB_USE_OPENCV
+#include "otbRandomForestsMachineLearningModel.h"
+#endif
 
 namespace otb
 {
@@ -289,6 +294,29 @@ void           VectorPrediction<RegressionMode>::DoExecute()
   m_Model->Load(GetParameterString("model"));
   otbAppLogINFO("Model loaded");
 
+#ifdef OTB_USE_OPENCV
+  if (GetParameterInt("compiledforest"))
+  {
+    typedef otb::RandomForestsMachineLearningModel<ValueType, LabelType> RandomForestsModelType;
+    RandomForestsModelType* randomForests = dynamic_cast<RandomForestsModelType*>(m_Model.GetPointer());
+    if (randomForests == nullptr)
+    {
+      otbAppLogWARNING("Compiled forest is only available for OpenCV random forests models, option ignored.");
+    }
+    else
+    {
+      randomForests->SetUseCompiledForest(true);
+      if (randomForests->IsCompiledForestUsed())
+        otbAppLogINFO("Using compiled forest for prediction");
+    }
+  }
+#else
+  if (GetParameterInt("compiledforest"))
+  {
+    otbAppLogWARNING("Compiled forest is only available for OpenCV random forests models, option ignored.");
+  }
+#endif
+
   auto shapefileName = GetParameterString("in");
 
   ogr::DataSource::Pointer source  = ogr::DataSource::New(shapefileName, ogr::DataSource::Modes::Read);
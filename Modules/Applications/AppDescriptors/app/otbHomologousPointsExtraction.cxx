@@ -143,6 +143,14 @@ private:
     AddParameter(ParameterType_Bool, "backmatching", "Use back-matching to filter matches");
     SetParameterDescription("backmatching", "If set to true, matches should be consistent in both ways.");
 
+    AddParameter(ParameterType_Int, "maxchecks", "Maximum number of checks per keypoint");
+    SetParameterDescription("maxchecks",
+                            "Maximum number of descriptors compared to each keypoint when searching its nearest neighbors. "
+                            "A value of 0 gives an exact search. A positive value gives an approximate but faster search, "
+                            "useful when a lot of keypoints are found (a few hundreds is usually enough).");
+    SetMinimumParameterIntValue("maxchecks", 0);
+    SetDefaultParameterInt("maxchecks", 0);
+
     AddParameter(ParameterType_Choice, "mode", "Keypoints search mode");
 
     AddChoice("mode.full", "Extract and match all keypoints (no streaming)");
@@ -250,10 +258,12 @@ private:
 
       matchingFilter->SetInput1(surf1->GetOutput());
       matchingFilter->SetInput2(surf2->GetOutput());
-      matchingFilter->SetDistanceThreshold(GetParameterFloat("threshold"));
-      matchingFilter->SetUseBackMatching(GetParameterInt("backmatching"));
     }
 
+    matchingFilter->SetDistanceThreshold(GetParameterFloat("threshold"));
+    matchingFilter->SetUseBackMatching(GetParameterInt("backmatching"));
+    matchingFilter->SetMaximumNumberOfChecks(GetParameterInt("maxchecks"));
+
     try
     {
 
@@ -261,7 +271,8 @@ private:
 
       LandmarkListType::Pointer landmarks = matchingFilter->GetOutput();
 
-      otbAppLogINFO("Found " << landmarks->Size() << " homologous points.");
+      otbAppLogINFO("Found " << landmarks->Size() << " homologous points (" << matchingFilter->GetNumberOfCandidateMatches()
+                             << " before back-matching) in " << matchingFilter->GetElapsedMilliseconds() << " ms.");
 
       unsigned int discarded = 0;
 
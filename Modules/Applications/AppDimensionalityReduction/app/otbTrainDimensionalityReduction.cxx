@@ -22,6 +22,8 @@
 
 #include "otbOGRDataSourceWrapper.h"
 #include "otbOGRFeatureWrapper.h"
+#include "otbSampleStore.h"
+#include "otbDenseListSample.h"
 
 #include "itkVariableLengthVector.h"
 
@@ -63,6 +65,9 @@ public:
 
   typedef otb::StatisticsXMLFileReader<SampleType> StatisticsReader;
 
+  /** Input samples are read into a contiguous buffer */
+  typedef otb::DenseListSample<ValueType> DenseListSampleType;
+
   typedef otb::Statistics::ShiftScaleSampleListFilter<ListSampleType, ListSampleType> ShiftScaleFilterType;
 
   typedef otb::DimensionalityReductionModelFactory<ValueType, ValueType> ModelFactoryType;
@@ -88,7 +93,9 @@ private:
     SetParameterDescription("io", "This group of parameters allows setting input and output data.");
 
     AddParameter(ParameterType_InputVectorData, "io.vd", "Input Vector Data");
-    SetParameterDescription("io.vd", "Input geometries used for training (note: all geometries from the layer will be used)");
+    SetParameterDescription("io.vd",
+                            "Input geometries used for training (note: all geometries from the layer will be used). "
+                            "A sample store (see SampleStoreConversion) can be used instead of a vector file.");
 
     AddParameter(ParameterType_OutputFilename, "io.out", "Output model");
     SetParameterDescription("io.out", "Output file containing the estimated model (.txt format).");
@@ -127,38 +134,19 @@ private:
   {
     std::string shapefile = GetParameterString("io.vd");
 
-    otb::ogr::DataSource::Pointer source = otb::ogr::DataSource::New(shapefile, otb::ogr::DataSource::Modes::Read);
-    otb::ogr::Layer               layer  = source->GetLayer(0);
-    ListSampleType::Pointer       input  = ListSampleType::New();
+    DenseListSampleType::Pointer input = DenseListSampleType::New();
 
     const auto inputIndexes = GetParameterStringList("feat");
     const int  nbFeatures   = inputIndexes.size();
 
     input->SetMeasurementVectorSize(nbFeatures);
-    otb::ogr::Layer::const_iterator it    = layer.cbegin();
-    otb::ogr::Layer::const_iterator itEnd = layer.cend();
-    for (; it != itEnd; ++it)
+    if (otb::SampleStore::CanReadFile(shapefile))
     {
-      MeasurementType mv;
-      mv.SetSize(nbFeatures);
-      for (int idx = 0; idx < nbFeatures; ++idx)
-      {
-        switch ((*it)[inputIndexes[idx]].GetType())
-        {
-        case OFTInteger:
-          mv[idx] = static_cast<ValueType>((*it)[inputIndexes[idx]].GetValue<int>());
-          break;
-        case OFTInteger64:
-          mv[idx] = static_cast<ValueType>((*it)[inputIndexes[idx]].GetValue<int>());
-          break;
-        case OFTReal:
-          mv[idx] = static_cast<ValueType>((*it)[inputIndexes[idx]].GetValue<double>());
-          break;
-        default:
-          itkExceptionMacro(<< "incorrect field type: " << (*it)[inputIndexes[idx]].GetType() << ".");
-        }
-      }
-      input->PushBack(mv);
+      ReadSampleStore(shapefile, inputIndexes, input);
+    }
+    else
+    {
+      ReadVectorFile(shapefile, inputIndexes, input);
     }
 
     MeasurementType meanMeasurementVector;
@@ -190,6 +178,62 @@ private:
 
     this->Train(trainingListSample, GetParameterString("io.out"));
   }
+
+  void ReadVectorFile(const std::string& fileName, const std::vector<std::string>& inputIndexes, DenseListSampleType* input)
+  {
+    const int nbFeatures = inputIndexes.size();
+
+    otb::ogr::DataSource::Pointer source = otb::ogr::DataSource::New(fileName, otb::ogr::DataSource::Modes::Read);
+    otb::ogr::Layer               layer  = source->GetLayer(0);
+
+    otb::ogr::Layer::const_iterator it    = layer.cbegin();
+    otb::ogr::Layer::const_iterator itEnd = layer.cend();
+    for (; it != itEnd; ++it)
+    {
+      MeasurementType mv;
+      mv.SetSize(nbFeatures);
+      for (int idx = 0; idx < nbFeatures; ++idx)
+      {
+        switch ((*it)[inputIndexes[idx]].GetType())
+        {
+        case OFTInteger:
+          mv[idx] = static_cast<ValueType>((*it)[inputIndexes[idx]].GetValue<int>());
+          break;
+        case OFTInteger64:
+          mv[idx] = static_cast<ValueType>((*it)[inputIndexes[idx]].GetValue<int>());
+          break;
+        case OFTReal:
+          mv[idx] = static_cast<ValueType>((*it)[inputIndexes[idx]].GetValue<double>());
+          break;
+        default:
+          itkExceptionMacro(<< "incorrect field type: " << (*it)[inputIndexes[idx]].GetType() << ".");
+        }
+      }
+      input->PushBack(mv);
+    }
+  }
+
+  void ReadSampleStore(const std::string& fileName, const std::vector<std::string>& inputIndexes, DenseListSampleType* input)
+  {
+    const unsigned int nbFeatures = inputIndexes.size();
+
+    otb::SampleStore store;
+    store.Load(fileName);
+
+    std::vector<unsigned int> columns(nbFeatures);
+    for (unsigned int idx = 0; idx < nbFeatures; ++idx)
+    {
+      int column = store.GetColumnIndex(inputIndexes[idx]);
+      if (column < 0)
+      {
+        otbAppLogFATAL(<< "The field name for feature " << inputIndexes[idx] << " has not been found in the sample store " << fileName);
+      }
+      columns[idx] = static_cast<unsigned int>(column);
+    }
+
+    // Features go straight from the columns to the buffer of the list
+    store.GetSamples(columns, input->PushBackSamples(store.GetNumberOfSamples()));
+  }
 };
 
 } // end of namespace Wrapper
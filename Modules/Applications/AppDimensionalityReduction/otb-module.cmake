@@ -29,6 +29,7 @@ otb_module(OTBAppDimensionalityReduction
     OTBApplicationEngine
     OTBDimensionalityReduction
     OTBDimensionalityReductionLearning
+    OTBSampling
     TEST_DEPENDS
     OTBTestKernel
     OTBCommandLine
@@ -68,6 +68,9 @@
 // system tools
 #include <itksys/SystemTools.hxx>
 
+// Open files
+#include "otbGDALDatasetPool.h"
+
 using namespace std;
 
 namespace otb
@@ -157,7 +160,30 @@ public:
   /** UInt8 filters typedefs */
   typedef otb::StreamingResampleImageFilter<UInt8MaskImageType, UInt8MaskImageType> UInt8ResampleImageFilterType;
 
+protected:
+  Mosaic() : m_MaxOpenChanged(false), m_PreviousMaxOpen(0)
+  {
+  }
+
+  ~Mosaic() override
+  {
+    RestoreMaxOpen();
+  }
+
 private:
+  /*
+   * Give back to the process-wide pool of open files the size it had before
+   * DoExecute()
+   */
+  void RestoreMaxOpen()
+  {
+    if (m_MaxOpenChanged)
+    {
+      otb::GDALDatasetPool::GetInstance().SetMaximumNumberOfDatasets(m_PreviousMaxOpen);
+      m_MaxOpenChanged = false;
+    }
+  }
+
   /*
    * Create a reader and update its registry
    */
@@ -375,6 +401,16 @@ private:
     SetDefaultParameterFloat("nodata", 0.0);
     MandatoryOff("nodata");
 
+    // open files
+    AddParameter(ParameterType_Int, "maxopen", "Maximum number of open input files");
+    SetParameterDescription("maxopen",
+                            "Maximum number of input files kept open while they are not read. Input files are then only opened to read their "
+                            "information and the tiles which overlap the region being computed, which is useful with thousands of input "
+                            "images. 0 keeps all input files open. The limit only applies while the application runs.");
+    SetDefaultParameterInt("maxopen", 0);
+    SetMinimumParameterIntValue("maxopen", 0);
+    MandatoryOff("maxopen");
+
     AddRAMParameter();
 
     // Doc example
@@ -1031,6 +1067,22 @@ private:
   {
     GDALAllRegister();
     m_TemporaryFiles.clear();
+
+    // Bound the number of input files kept open, before the inputs are read.
+    // The pool is shared by the whole process: its size is restored once
+    // the outputs are written, or when the application is destroyed.
+    if (GetParameterInt("maxopen") > 0)
+    {
+      otbAppLogINFO(<< "At most " << GetParameterInt("maxopen") << " input files will be kept open");
+      otb::GDALDatasetPool& pool = otb::GDALDatasetPool::GetInstance();
+      if (!m_MaxOpenChanged)
+      {
+        m_PreviousMaxOpen = pool.GetMaximumNumberOfDatasets();
+        m_MaxOpenChanged  = true;
+      }
+      pool.SetMaximumNumberOfDatasets(GetParameterInt("maxopen"));
+    }
+
     CheckNbOfInputs();
 
     ResolveTemporaryDirectory();
@@ -1062,6 +1114,8 @@ private:
       for (const auto& file : m_TemporaryFiles)
         deleteFile(file);
     }
+
+    RestoreMaxOpen();
   }
 
   // Sources
@@ -1090,6 +1144,10 @@ private:
   // Parameters
   string         m_TempFilesPrefix; // Temp. directory
   vector<string> m_TemporaryFiles;  // Temp. filenames for distance images, masks, etc.
+
+  // Open files
+  bool         m_MaxOpenChanged;  // Pool size set by "maxopen"
+  unsigned int m_PreviousMaxOpen; // Pool size to restore
 };
 }
 }
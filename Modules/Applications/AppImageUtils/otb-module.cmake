@@ -30,6 +30,7 @@ otb_module(OTBAppImageUtils
     OTBCommon
     OTBCurlAdapters
     OTBITK
+    OTBIOGDAL
     OTBImageBase
     OTBImageManipulation
     OTBOSSIMAdapters
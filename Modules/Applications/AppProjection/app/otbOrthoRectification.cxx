@@ -242,6 +242,19 @@ private:
                             "but increasing this parameter will reduce processing time.");
     MandatoryOff("opt.gridspacing");
 
+    // Approximation of the sensor model on the resampling grid
+    AddParameter(ParameterType_Float, "opt.tolerance", "Resampling grid approximation tolerance");
+    SetDefaultParameterFloat("opt.tolerance", 0.125);
+    SetMinimumParameterFloatValue("opt.tolerance", 0.);
+    SetParameterDescription("opt.tolerance",
+                            "When enabled, the sensor model is evaluated exactly only on a sparse, adaptively "
+                            "refined subset of the resampling grid nodes, and bilinearly interpolated elsewhere. "
+                            "The grid is refined wherever the interpolation error exceeds this value, "
+                            "expressed in pixels of the input image. This can greatly reduce processing time "
+                            "with expensive sensor models. The achieved error is reported at the end of the processing.");
+    DisableParameter("opt.tolerance");
+    MandatoryOff("opt.tolerance");
+
     // Doc example parameter settings
     SetDocExampleParameterValue("io.in", "QB_TOULOUSE_MUL_Extract_500_500.tif");
     SetDocExampleParameterValue("io.out", "QB_Toulouse_ortho.tif");
@@ -684,10 +697,25 @@ private:
       m_ResampleFilter->SetDisplacementFieldSpacing(gridSpacing);
     }
 
+    // Approximation of the transform on the displacement grid
+    if (IsParameterEnabled("opt.tolerance"))
+    {
+      otbAppLogINFO("Approximating the transform on the deformation grid with a tolerance of " << GetParameterFloat("opt.tolerance") << " input pixels");
+      m_ResampleFilter->SetApproximationTolerance(GetParameterFloat("opt.tolerance"));
+    }
+
     // Output Image
     SetParameterOutputImage("io.out", m_ResampleFilter->GetOutput());
   }
 
+  void AfterExecuteAndWriteOutputs() override
+  {
+    if (IsParameterEnabled("opt.tolerance"))
+    {
+      otbAppLogINFO("Maximum measured deformation grid approximation error: " << m_ResampleFilter->GetMaximumApproximationError() << " input pixels");
+    }
+  }
+
   ResampleFilterType::Pointer m_ResampleFilter;
   std::string                 m_OutputProjectionRef;
 };
@@ -103,6 +103,15 @@ private:
     DisableParameter("lms");
     MandatoryOff("lms");
 
+    AddParameter(ParameterType_Float, "tolerance", "Deformation field approximation tolerance");
+    SetParameterDescription("tolerance",
+                            "Evaluate the transform exactly only on an adaptively refined subset of the deformation "
+                            "field, and interpolate it elsewhere, with a maximum error given in pixels of the moving image");
+    SetDefaultParameterFloat("tolerance", 0.125);
+    SetMinimumParameterFloatValue("tolerance", 0.);
+    DisableParameter("tolerance");
+    MandatoryOff("tolerance");
+
     AddParameter(ParameterType_Float, "fv", "Fill Value");
     SetParameterDescription("fv", "Fill value for area outside the reprojected image");
     SetDefaultParameterFloat("fv", 0.);
@@ -241,6 +250,12 @@ private:
       }
       m_Resampler->SetDisplacementFieldSpacing(defSpacing);
 
+      if (IsParameterEnabled("tolerance"))
+      {
+        otbAppLogINFO("Approximating the transform on the deformation field with a tolerance of " << GetParameterFloat("tolerance") << " pixels");
+        m_Resampler->SetApproximationTolerance(GetParameterFloat("tolerance"));
+      }
+
       // Setup transform through projRef and Keywordlist
       m_Resampler->SetInputKeywordList(movingImage->GetImageKeywordlist());
       m_Resampler->SetInputProjectionRef(movingImage->GetProjectionRef());
@@ -294,6 +309,14 @@ private:
     }
   }
 
+  void AfterExecuteAndWriteOutputs() override
+  {
+    if (GetParameterString("mode") == "default" && IsParameterEnabled("tolerance"))
+    {
+      otbAppLogINFO("Maximum measured deformation field approximation error: " << m_Resampler->GetMaximumApproximationError() << " pixels");
+    }
+  }
+
   ResamplerType::Pointer m_Resampler;
 
   BasicResamplerType::Pointer m_BasicResampler;
@@ -25,7 +25,7 @@
 #include "otbLeeImageFilter.h"
 #include "otbGammaMAPImageFilter.h"
 #include "otbKuanImageFilter.h"
-#include "otbMultiToMonoChannelExtractROI.h"
+#include "otbPerBandVectorImageFilter.h"
 
 namespace otb
 {
@@ -41,13 +41,19 @@ public:
   typedef itk::SmartPointer<Self>       Pointer;
   typedef itk::SmartPointer<const Self> ConstPointer;
 
-  typedef itk::ImageToImageFilter<FloatImageType, FloatImageType> SpeckleFilterType;
+  typedef itk::ImageToImageFilter<FloatVectorImageType, FloatVectorImageType> SpeckleFilterType;
 
   typedef LeeImageFilter<FloatImageType, FloatImageType>      LeeFilterType;
   typedef FrostImageFilter<FloatImageType, FloatImageType>    FrostFilterType;
   typedef GammaMAPImageFilter<FloatImageType, FloatImageType> GammaMAPFilterType;
   typedef KuanImageFilter<FloatImageType, FloatImageType>     KuanFilterType;
 
+  /** Each channel is filtered independently */
+  typedef PerBandVectorImageFilter<FloatVectorImageType, FloatVectorImageType, LeeFilterType>      PerBandLeeFilterType;
+  typedef PerBandVectorImageFilter<FloatVectorImageType, FloatVectorImageType, FrostFilterType>    PerBandFrostFilterType;
+  typedef PerBandVectorImageFilter<FloatVectorImageType, FloatVectorImageType, GammaMAPFilterType> PerBandGammaMAPFilterType;
+  typedef PerBandVectorImageFilter<FloatVectorImageType, FloatVectorImageType, KuanFilterType>     PerBandKuanFilterType;
+
   /** Standard macro */
   itkNewMacro(Self);
 
@@ -74,7 +80,13 @@ private:
         "* Frost: Also derived from the MMSE criteria with a weighted sum of the values within the window. The weighting factors decrease with distance from "
         "the pixel of interest.\n"
         "* GammaMAP: Derived under the assumption of the image follows a Gamma distribution.\n"
-        "* Kuan: Also derived from the MMSE criteria under the assumption of non stationary mean and variance. It is quite similar to Lee filter in form.");
+        "* Kuan: Also derived from the MMSE criteria under the assumption of non stationary mean and variance. It is quite similar to Lee filter in form.\n\n"
+        "The local mean and variance used by the filters are computed from summed-area tables, so the processing time of Lee, GammaMAP and Kuan "
+        "does not depend on the radius, and large windows can be used. The Frost filter still computes a weighted sum over the whole window.\n\n"
+        "All the channels of the input image (for instance the two polarisations of a dual-pol image) are filtered independently, in a single "
+        "pass over the input, and written to the corresponding channels of the output image. The output image thus has as many channels as "
+        "the input image. Previous versions only filtered the first channel and wrote a single channel image: the same output is obtained "
+        "by selecting the first channel with an extended filename (image.tif?&bands=1).");
 
     SetDocLimitations("The application does not handle complex image as input.");
 
@@ -157,6 +169,13 @@ private:
     SetDefaultParameterFloat("filter.frost.deramp", 0.1);
     SetDefaultParameterInt("filter.gammamap.rad", 1);
     SetDefaultParameterFloat("filter.gammamap.nblooks", 1.);
+    SetDefaultParameterInt("filter.kuan.rad", 1);
+    SetDefaultParameterFloat("filter.kuan.nblooks", 1.);
+
+    SetMinimumParameterIntValue("filter.lee.rad", 1);
+    SetMinimumParameterIntValue("filter.frost.rad", 1);
+    SetMinimumParameterIntValue("filter.gammamap.rad", 1);
+    SetMinimumParameterIntValue("filter.kuan.rad", 1);
 
     AddRAMParameter();
 
@@ -176,25 +195,15 @@ private:
 
   void DoExecute() override
   {
-    FloatVectorImageType* inVImage = GetParameterImage("in");
-
-    // Transform to otb::Image
-    typedef otb::Image<FloatVectorImageType::InternalPixelType> InternalFloatImageType;
-    typedef otb::MultiToMonoChannelExtractROI<float, float> ExtractFilterType;
+    FloatVectorImageType* inImage = GetParameterImage("in");
 
-    ExtractFilterType::Pointer channelSelect = ExtractFilterType::New();
-    m_Ref.push_back(channelSelect.GetPointer());
-    channelSelect->SetChannel(1);
-    channelSelect->SetInput(inVImage);
-    channelSelect->UpdateOutputInformation();
-    InternalFloatImageType::Pointer inImage = channelSelect->GetOutput();
-    inImage->UpdateOutputInformation();
+    otbAppLogINFO(<< "Filtering " << inImage->GetNumberOfComponentsPerPixel() << " channel(s)");
 
     switch (GetParameterInt("filter"))
     {
     case 0:
     {
-      LeeFilterType::Pointer filter = LeeFilterType::New();
+      PerBandLeeFilterType::Pointer filter = PerBandLeeFilterType::New();
       m_Ref.push_back(filter.GetPointer());
 
       filter->SetInput(inImage);
@@ -202,8 +211,8 @@ private:
       LeeFilterType::SizeType lradius;
       lradius.Fill(GetParameterInt("filter.lee.rad"));
 
-      filter->SetRadius(lradius);
-      filter->SetNbLooks(GetParameterFloat("filter.lee.nblooks"));
+      filter->GetFilter()->SetRadius(lradius);
+      filter->GetFilter()->SetNbLooks(GetParameterFloat("filter.lee.nblooks"));
 
       otbAppLogINFO(<< "Lee filter");
       m_SpeckleFilter = filter;
@@ -211,7 +220,7 @@ private:
     }
     case 1:
     {
-      FrostFilterType::Pointer filter = FrostFilterType::New();
+      PerBandFrostFilterType::Pointer filter = PerBandFrostFilterType::New();
       m_Ref.push_back(filter.GetPointer());
 
       filter->SetInput(inImage);
@@ -219,8 +228,8 @@ private:
       FrostFilterType::SizeType lradius;
       lradius.Fill(GetParameterInt("filter.frost.rad"));
 
-      filter->SetRadius(lradius);
-      filter->SetDeramp(GetParameterFloat("filter.frost.deramp"));
+      filter->GetFilter()->SetRadius(lradius);
+      filter->GetFilter()->SetDeramp(GetParameterFloat("filter.frost.deramp"));
 
       otbAppLogINFO(<< "Frost filter");
       m_SpeckleFilter = filter;
@@ -228,7 +237,7 @@ private:
     }
     case 2:
     {
-      GammaMAPFilterType::Pointer filter = GammaMAPFilterType::New();
+      PerBandGammaMAPFilterType::Pointer filter = PerBandGammaMAPFilterType::New();
       m_Ref.push_back(filter.GetPointer());
 
       filter->SetInput(inImage);
@@ -236,8 +245,8 @@ private:
       GammaMAPFilterType::SizeType lradius;
       lradius.Fill(GetParameterInt("filter.gammamap.rad"));
 
-      filter->SetRadius(lradius);
-      filter->SetNbLooks(GetParameterFloat("filter.gammamap.nblooks"));
+      filter->GetFilter()->SetRadius(lradius);
+      filter->GetFilter()->SetNbLooks(GetParameterFloat("filter.gammamap.nblooks"));
 
       otbAppLogINFO(<< "GammaMAP filter");
       m_SpeckleFilter = filter;
@@ -245,7 +254,7 @@ private:
     }
     case 3:
     {
-      KuanFilterType::Pointer filter = KuanFilterType::New();
+      PerBandKuanFilterType::Pointer filter = PerBandKuanFilterType::New();
       m_Ref.push_back(filter.GetPointer());
 
       filter->SetInput(inImage);
@@ -253,8 +262,8 @@ private:
       KuanFilterType::SizeType lradius;
       lradius.Fill(GetParameterInt("filter.kuan.rad"));
 
-      filter->SetRadius(lradius);
-      filter->SetNbLooks(GetParameterFloat("filter.kuan.nblooks"));
+      filter->GetFilter()->SetRadius(lradius);
+      filter->GetFilter()->SetNbLooks(GetParameterFloat("filter.kuan.nblooks"));
 
       otbAppLogINFO(<< "Kuan filter");
       m_SpeckleFilter = filter;
@@ -27,6 +27,8 @@
 #include "itkStatisticsImageFilter.h"
 #include "itkChangeLabelImageFilter.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreader.h"
 #include "itkScalarConnectedComponentImageFilter.h"
 #include "otbConcatenateVectorImageFilter.h"
 #include "otbAffineFunctor.h"
@@ -77,6 +79,7 @@ public:
   typedef itk::ChangeLabelImageFilter<LabelImageType, LabelImageType>     ChangeLabelImageFilterType;
   typedef otb::ImportGeoInformationImageFilter<LabelImageType, ImageType> ImportGeoInformationImageFilterType;
   typedef itk::ImageRegionConstIterator<LabelImageType> LabelImageIterator;
+  typedef itk::ImageRegionIterator<LabelImageType>      LabelImageOutputIterator;
 
   typedef otb::ConcatenateVectorImageFilter<ImageType, ImageType, ImageType>                         ConcatenateType;
   typedef otb::Functor::AffineFunctor<LabelImagePixelType, LabelImagePixelType, LabelImagePixelType> AffineFunctorType;
@@ -164,6 +167,393 @@ private:
     }
   }
 
+  std::string CreateExpression(unsigned int nbComp)
+  {
+    const float ranger   = GetParameterFloat("ranger");
+    const float spatialr = GetParameterFloat("spatialr");
+
+    // Expression 1 : radiometric distance < ranger
+    std::stringstream expr;
+    expr << "sqrt((p1b1-p2b1)*(p1b1-p2b1)";
+    for (unsigned int i = 1; i < nbComp; i++)
+      expr << "+(p1b" << i + 1 << "-p2b" << i + 1 << ")*(p1b" << i + 1 << "-p2b" << i + 1 << ")";
+    expr << ")"
+         << "<" << ranger;
+
+    if (HasValue("inpos"))
+    {
+      // Expression 2 : final positions < spatialr
+      expr << " and sqrt((p1b" << nbComp + 1 << "-p2b" << nbComp + 1 << ")*(p1b" << nbComp + 1 << "-p2b" << nbComp + 1 << ")+";
+      expr << "(p1b" << nbComp + 2 << "-p2b" << nbComp + 2 << ")*(p1b" << nbComp + 2 << "-p2b" << nbComp + 2 << "))"
+           << "<" << spatialr;
+    }
+
+    return expr.str();
+  }
+
+  /** Extract a tile of the filtered image, concatenated with the tile of
+   * the spatial image if available. The returned tile is disconnected from
+   * the input pipeline. */
+  ImageType::Pointer ExtractTile(ImageType* imageIn, ImageType* spatialIn, unsigned long startX, unsigned long startY, unsigned long sizeX,
+                                 unsigned long sizeY)
+  {
+    MultiChannelExtractROIFilterType::Pointer extractROIFilter = MultiChannelExtractROIFilterType::New();
+    extractROIFilter->SetInput(imageIn);
+    extractROIFilter->SetStartX(startX);
+    extractROIFilter->SetStartY(startY);
+    extractROIFilter->SetSizeX(sizeX);
+    extractROIFilter->SetSizeY(sizeY);
+    extractROIFilter->Update();
+
+    ImageType::Pointer tile = extractROIFilter->GetOutput();
+
+    if (spatialIn != nullptr)
+    {
+      MultiChannelExtractROIFilterType::Pointer extractROIFilter2 = MultiChannelExtractROIFilterType::New();
+      extractROIFilter2->SetInput(spatialIn);
+      extractROIFilter2->SetStartX(startX);
+      extractROIFilter2->SetStartY(startY);
+      extractROIFilter2->SetSizeX(sizeX);
+      extractROIFilter2->SetSizeY(sizeY);
+      extractROIFilter2->Update();
+
+      // Concatenation of the two input images
+      ConcatenateType::Pointer concat = ConcatenateType::New();
+      concat->SetInput1(extractROIFilter->GetOutput());
+      concat->SetInput2(extractROIFilter2->GetOutput());
+      concat->Update();
+
+      tile = concat->GetOutput();
+    }
+
+    tile->DisconnectPipeline();
+    return tile;
+  }
+
+  /** Connected component labelling of a tile. Labels start at 1, and the
+   * largest one is returned in maxLabel. */
+  static LabelImageType::Pointer SegmentTile(ImageType* tile, const std::string& expression, LabelImagePixelType& maxLabel, bool singleThreaded)
+  {
+    CCFilterType::Pointer ccFilter = CCFilterType::New();
+    ccFilter->SetInput(tile);
+    ccFilter->GetFunctor().SetExpression(expression);
+
+    StatisticsImageFilterType::Pointer stats = StatisticsImageFilterType::New();
+    stats->SetInput(ccFilter->GetOutput());
+
+    if (singleThreaded)
+    {
+      ccFilter->SetNumberOfThreads(1);
+      stats->SetNumberOfThreads(1);
+    }
+
+    // Maximum label calculation for the shifting
+    stats->Update();
+    maxLabel = stats->GetMaximum();
+
+    LabelImageType::Pointer labels = ccFilter->GetOutput();
+    labels->DisconnectPipeline();
+    return labels;
+  }
+
+  /** Canonical label of a region, i.e. the root of its tree in the
+   * union-find look-up table. Paths are compressed on the way. */
+  static LabelImagePixelType FindCanonicalLabel(std::vector<LabelImagePixelType>& LUT, LabelImagePixelType label)
+  {
+    LabelImagePixelType root = label;
+    while (LUT[root] != root)
+    {
+      root = LUT[root];
+    }
+    while (LUT[label] != root)
+    {
+      LabelImagePixelType next = LUT[label];
+      LUT[label]               = root;
+      label                    = next;
+    }
+    return root;
+  }
+
+  /** Merge the regions of two labels, the smallest canonical label is kept */
+  static void MergeLabels(std::vector<LabelImagePixelType>& LUT, LabelImagePixelType label1, LabelImagePixelType label2)
+  {
+    LabelImagePixelType can1 = FindCanonicalLabel(LUT, label1);
+    LabelImagePixelType can2 = FindCanonicalLabel(LUT, label2);
+    if (can1 < can2)
+    {
+      LUT[can2] = can1;
+    }
+    else
+    {
+      LUT[can1] = can2;
+    }
+  }
+
+  /** Merge the regions on both sides of the border between a tile and its
+   * upper (axis 1) or left (axis 0) neighbour. The first row (or column)
+   * of the tile is the extra margin of the neighbour, at the given
+   * position. Offsets are added to the labels of each tile. */
+  static void StitchTiles(const LabelImageType* tile, LabelImagePixelType tileOffset, const LabelImageType* adjacentTile,
+                          LabelImagePixelType adjacentOffset, unsigned int axis, long adjacentPosition, unsigned long length,
+                          std::vector<LabelImagePixelType>& LUT)
+  {
+    const unsigned int otherAxis = 1 - axis;
+
+    LabelImageType::IndexType pixelIndexIn;
+    LabelImageType::IndexType pixelIndexAdj;
+
+    pixelIndexIn[axis]  = 0;
+    pixelIndexAdj[axis] = adjacentPosition;
+
+    for (pixelIndexIn[otherAxis] = 0; pixelIndexIn[otherAxis] < static_cast<long>(length); ++pixelIndexIn[otherAxis])
+    {
+      pixelIndexAdj[otherAxis] = pixelIndexIn[otherAxis];
+      MergeLabels(LUT, tile->GetPixel(pixelIndexIn) + tileOffset, adjacentTile->GetPixel(pixelIndexAdj) + adjacentOffset);
+    }
+  }
+
+  /** Final labels: regions smaller than minRegionSize get label 0, the
+   * others are numbered consecutively from 1 */
+  std::vector<LabelImagePixelType> ComputeFinalLabels(const std::vector<unsigned long>& sizePerRegion, unsigned int minRegionSize)
+  {
+    unsigned int smallCount = 0;
+
+    LabelImagePixelType              newLab = 1;
+    std::vector<LabelImagePixelType> newLabels(sizePerRegion.size(), 0);
+    for (LabelImagePixelType curLabel = 1; curLabel < sizePerRegion.size(); ++curLabel)
+    {
+      if (sizePerRegion[curLabel] < minRegionSize)
+      {
+        newLabels[curLabel] = 0;
+        ++smallCount;
+      }
+      else
+      {
+        newLabels[curLabel] = newLab;
+        newLab += 1;
+      }
+    }
+
+    otbAppLogINFO(<< smallCount << " small regions will be removed");
+
+    return newLabels;
+  }
+
+  /** Data shared by the threads of the in-memory processing */
+  struct TileThreadStruct
+  {
+    std::string                            Expression;
+    std::vector<ImageType::Pointer>        InputTiles;
+    unsigned int                           FirstTile;
+    std::vector<LabelImageType::Pointer>   LabelTiles;
+    std::vector<LabelImagePixelType>       MaxLabels;
+    std::vector<LabelImagePixelType>       Offsets;
+    std::vector<LabelImagePixelType>       LUT;
+    std::vector<LabelImageType::IndexType> TileStarts;
+    std::vector<LabelImageType::SizeType>  TileSizes;
+    LabelImageType::Pointer                Output;
+    std::vector<std::string>               Errors;
+  };
+
+  /** Thread callback labelling the tiles of the current batch */
+  static ITK_THREAD_RETURN_TYPE SegmentTilesCallback(void* arg)
+  {
+    itk::MultiThreader::ThreadInfoStruct* info = static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+    TileThreadStruct*                     str  = static_cast<TileThreadStruct*>(info->UserData);
+
+    try
+    {
+      for (unsigned int i = info->ThreadID; i < str->InputTiles.size(); i += info->NumberOfThreads)
+      {
+        const unsigned int tileId = str->FirstTile + i;
+        str->LabelTiles[tileId]   = SegmentTile(str->InputTiles[i], str->Expression, str->MaxLabels[tileId], true);
+        str->InputTiles[i]        = nullptr;
+      }
+    }
+    catch (itk::ExceptionObject& err)
+    {
+      str->Errors[info->ThreadID] = err.GetDescription();
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  /** Thread callback relabelling the tiles and copying them to the output */
+  static ITK_THREAD_RETURN_TYPE RelabelTilesCallback(void* arg)
+  {
+    itk::MultiThreader::ThreadInfoStruct* info = static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+    TileThreadStruct*                     str  = static_cast<TileThreadStruct*>(info->UserData);
+
+    for (unsigned int tileId = info->ThreadID; tileId < str->LabelTiles.size(); tileId += info->NumberOfThreads)
+    {
+      // Remove extra margin now that lut is built
+      LabelImageType::RegionType tileRegion;
+      tileRegion.SetSize(str->TileSizes[tileId]);
+      LabelImageType::RegionType outputRegion(str->TileStarts[tileId], str->TileSizes[tileId]);
+
+      const LabelImagePixelType offset = str->Offsets[tileId];
+      LabelImageIterator        inIt(str->LabelTiles[tileId], tileRegion);
+      LabelImageOutputIterator  outIt(str->Output, outputRegion);
+      for (inIt.GoToBegin(), outIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt, ++outIt)
+      {
+        outIt.Set(str->LUT[inIt.Get() + offset]);
+      }
+
+      // Release the tile, it is not needed anymore
+      str->LabelTiles[tileId] = nullptr;
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  /** Tile-wise segmentation keeping all the tiles in memory. Tiles are
+   * labelled concurrently, then labels are stitched across tile borders
+   * with a union-find look-up table, and relabelled tiles are gathered in
+   * a single label image. The result is identical to the one of the file
+   * based processing. */
+  LabelImageType::Pointer SegmentInMemory(ImageType* imageIn, ImageType* spatialIn, const std::string& expression, unsigned int minRegionSize,
+                                          unsigned long sizeTilesX, unsigned long sizeTilesY, unsigned long sizeImageX, unsigned long sizeImageY)
+  {
+    const unsigned int nbTilesX = sizeImageX / sizeTilesX + (sizeImageX % sizeTilesX > 0 ? 1 : 0);
+    const unsigned int nbTilesY = sizeImageY / sizeTilesY + (sizeImageY % sizeTilesY > 0 ? 1 : 0);
+    const unsigned int nbTiles  = nbTilesX * nbTilesY;
+
+    itk::MultiThreader::Pointer threader  = itk::MultiThreader::New();
+    const unsigned int          nbThreads = std::max(1u, std::min(static_cast<unsigned int>(threader->GetNumberOfThreads()), nbTiles));
+
+    TileThreadStruct str;
+    str.Expression = expression;
+    str.LabelTiles.resize(nbTiles);
+    str.MaxLabels.resize(nbTiles, 0);
+    str.TileStarts.resize(nbTiles);
+    str.TileSizes.resize(nbTiles);
+    str.Errors.resize(nbThreads);
+
+    for (unsigned int tileId = 0; tileId < nbTiles; ++tileId)
+    {
+      const unsigned long startX = (tileId % nbTilesX) * sizeTilesX;
+      const unsigned long startY = (tileId / nbTilesX) * sizeTilesY;
+      str.TileStarts[tileId][0]  = startX;
+      str.TileStarts[tileId][1]  = startY;
+      str.TileSizes[tileId][0]   = std::min(sizeTilesX, sizeImageX - startX);
+      str.TileSizes[tileId][1]   = std::min(sizeTilesY, sizeImageY - startY);
+    }
+
+    // Tiles are extracted sequentially since they share the input
+    // pipeline, and labelled concurrently by batches of one tile per thread
+    otbAppLogINFO(<< "Tiles segmentation (" << nbThreads << " threads) ...");
+    for (unsigned int batchStart = 0; batchStart < nbTiles; batchStart += nbThreads)
+    {
+      const unsigned int batchEnd = std::min(batchStart + nbThreads, nbTiles);
+
+      str.FirstTile = batchStart;
+      str.InputTiles.clear();
+      for (unsigned int tileId = batchStart; tileId < batchEnd; ++tileId)
+      {
+        const unsigned long startX = str.TileStarts[tileId][0];
+        const unsigned long startY = str.TileStarts[tileId][1];
+        const unsigned long sizeX  = std::min(sizeTilesX + 1, sizeImageX - startX + 1);
+        const unsigned long sizeY  = std::min(sizeTilesY + 1, sizeImageY - startY + 1);
+        str.InputTiles.push_back(ExtractTile(imageIn, spatialIn, startX, startY, sizeX, sizeY));
+      }
+
+      threader->SetNumberOfThreads(batchEnd - batchStart);
+      threader->SetSingleMethod(SegmentTilesCallback, &str);
+      threader->SingleMethodExecute();
+
+      for (const auto& error : str.Errors)
+      {
+        if (!error.empty())
+        {
+          otbAppLogFATAL(<< "Tile segmentation failed: " << error);
+        }
+      }
+    }
+    str.InputTiles.clear();
+
+    // Labels of each tile are shifted by the number of labels of the
+    // previous tiles, in the same order as the file based processing
+    unsigned long regionCount = 0;
+    str.Offsets.resize(nbTiles);
+    for (unsigned int tileId = 0; tileId < nbTiles; ++tileId)
+    {
+      str.Offsets[tileId] = regionCount;
+      regionCount += str.MaxLabels[tileId];
+    }
+
+    otbAppLogINFO(<< "Tiles stitching ...");
+    std::vector<LabelImagePixelType> LUT(regionCount + 1);
+    for (LabelImagePixelType curLabel = 0; curLabel <= regionCount; ++curLabel)
+      LUT[curLabel] = curLabel;
+
+    for (unsigned int tileId = 0; tileId < nbTiles; ++tileId)
+    {
+      // Sizes of the tile with its extra margin
+      const unsigned long sizeX = str.LabelTiles[tileId]->GetLargestPossibleRegion().GetSize()[0];
+      const unsigned long sizeY = str.LabelTiles[tileId]->GetLargestPossibleRegion().GetSize()[1];
+
+      if (tileId >= nbTilesX)
+      {
+        const unsigned int upId = tileId - nbTilesX;
+        StitchTiles(str.LabelTiles[tileId], str.Offsets[tileId], str.LabelTiles[upId], str.Offsets[upId], 1, sizeTilesY, sizeX - 1, LUT);
+      }
+      if (tileId % nbTilesX > 0)
+      {
+        const unsigned int leftId = tileId - 1;
+        StitchTiles(str.LabelTiles[tileId], str.Offsets[tileId], str.LabelTiles[leftId], str.Offsets[leftId], 0, sizeTilesX, sizeY - 1, LUT);
+      }
+    }
+
+    // Reduce LUT to canonical labels
+    for (LabelImagePixelType label = 1; label < regionCount + 1; ++label)
+    {
+      LUT[label] = FindCanonicalLabel(LUT, label);
+    }
+    otbAppLogINFO(<< "LUT size: " << LUT.size() << " segments");
+
+    // Size of each region, margins excluded
+    std::vector<unsigned long> sizePerRegion(regionCount + 1, 0);
+    for (unsigned int tileId = 0; tileId < nbTiles; ++tileId)
+    {
+      LabelImageType::RegionType tileRegion;
+      tileRegion.SetSize(str.TileSizes[tileId]);
+
+      const LabelImagePixelType offset = str.Offsets[tileId];
+      LabelImageIterator        it(str.LabelTiles[tileId], tileRegion);
+      for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      {
+        sizePerRegion[LUT[it.Value() + offset]] += 1;
+      }
+    }
+
+    otbAppLogINFO(<< "Small regions pruning ...");
+    std::vector<LabelImagePixelType> newLabels = ComputeFinalLabels(sizePerRegion, minRegionSize);
+    sizePerRegion.clear();
+
+    // Compose both look-up tables so that tiles are relabelled in one pass
+    for (LabelImagePixelType label = 1; label < regionCount + 1; ++label)
+    {
+      LUT[label] = newLabels[LUT[label]];
+    }
+    newLabels.clear();
+    str.LUT.swap(LUT);
+
+    LabelImageType::RegionType outputRegion;
+    outputRegion.SetSize(0, sizeImageX);
+    outputRegion.SetSize(1, sizeImageY);
+
+    str.Output = LabelImageType::New();
+    str.Output->SetRegions(outputRegion);
+    str.Output->Allocate();
+
+    otbAppLogINFO(<< "Tiles relabelisation ...");
+    threader->SetNumberOfThreads(nbThreads);
+    threader->SetSingleMethod(RelabelTilesCallback, &str);
+    threader->SingleMethodExecute();
+
+    return str.Output;
+  }
+
   std::string WriteVRTFile(unsigned int nbTilesX, unsigned int nbTilesY, unsigned long tileSizeX, unsigned long tileSizeY, unsigned long imageSizeX,
                            unsigned long imageSizeY)
   {
@@ -237,7 +627,10 @@ private:
         " parameter will not be taken into account.\n\n"
         "Please note that this application will generate a lot of temporary"
         " files (as many as the number of tiles), and will therefore require"
-        " twice the size of the final result in term of disk space. The cleanup"
+        " twice the size of the final result in term of disk space. The memory"
+        " option avoids these temporary files: tiles are then segmented"
+        " concurrently and kept in memory until the final label image is"
+        " built, which requires holding the whole label image in memory. The cleanup"
         " option (activated by default) allows removing all temporary file as"
         " soon as they are not needed anymore (if cleanup is activated, tmpdir"
         " set and tmpdir does not exists before running the application, it will"
@@ -250,9 +643,9 @@ private:
         " complete the LSMS workflow.");
     SetDocLimitations(
         "This application is part of the Large-Scale Mean-Shift segmentation"
-        " workflow (LSMS) [1] and may not be suited for any other purpose. This"
-        " application is not compatible with in-memory connection since it does"
-        " its own internal streaming.");
+        " workflow (LSMS) [1] and may not be suited for any other purpose. Unless"
+        " the memory option is activated, this application is not compatible"
+        " with in-memory connection since it does its own internal streaming.");
     SetDocAuthors("David Youssefi");
     SetDocSeeAlso(
         "[1] Michel, J., Youssefi, D., & Grizonnet, M. (2015). Stable"
@@ -321,6 +714,11 @@ private:
     SetParameterDescription("cleanup", "If activated, the application will try to remove all temporary files it created.");
     SetParameterInt("cleanup", 1);
 
+    AddParameter(ParameterType_Bool, "memory", "In-memory processing");
+    SetParameterDescription("memory",
+                            "If activated, tiles are segmented concurrently and kept in memory instead of being written to temporary files. The "
+                            "whole output label image (4 bytes per pixel) is then held in memory, and the tmpdir and cleanup parameters are not used.");
+
     // Doc example parameter settings
     SetDocExampleParameterValue("in", "smooth.tif");
     SetDocExampleParameterValue("inpos", "position.tif");
@@ -344,17 +742,16 @@ private:
 
     clock_t tic = clock();
 
-    const float ranger   = GetParameterFloat("ranger");
-    const float spatialr = GetParameterFloat("spatialr");
-
     unsigned int minRegionSize = GetParameterInt("minsize");
 
     unsigned long sizeTilesX = GetParameterInt("tilesizex");
     unsigned long sizeTilesY = GetParameterInt("tilesizey");
 
 
+    const bool inMemory = GetParameterInt("memory");
+
     // Ensure that temporary directory exists if activated:
-    if (IsParameterEnabled("tmpdir"))
+    if (!inMemory && IsParameterEnabled("tmpdir"))
     {
       if (!itksys::SystemTools::FileExists(GetParameterString("tmpdir")))
       {
@@ -389,6 +786,26 @@ private:
 
     otbAppLogINFO(<< "Number of tiles: " << nbTilesX << " x " << nbTilesY);
 
+    const std::string expression = CreateExpression(nbComp);
+
+    if (inMemory)
+    {
+      LabelImageType::Pointer labelImage =
+          SegmentInMemory(imageIn, spatialIn, expression, minRegionSize, sizeTilesX, sizeTilesY, sizeImageX, sizeImageY);
+
+      clock_t toc = clock();
+
+      otbAppLogINFO(<< "Elapsed time: " << (double)(toc - tic) / CLOCKS_PER_SEC << " seconds");
+
+      ImportGeoInformationImageFilterType::Pointer importGeoInformationFilter = ImportGeoInformationImageFilterType::New();
+      importGeoInformationFilter->SetInput(labelImage);
+      importGeoInformationFilter->SetSource(imageIn);
+
+      SetParameterOutputImage("out", importGeoInformationFilter->GetOutput());
+      RegisterPipeline();
+      return;
+    }
+
     unsigned long regionCount = 0;
 
     // Segmentation by the connected component per tile and label
@@ -404,74 +821,19 @@ private:
         unsigned long sizeX  = std::min(sizeTilesX + 1, sizeImageX - startX + 1);
         unsigned long sizeY  = std::min(sizeTilesY + 1, sizeImageY - startY + 1);
 
-        // Tiles extraction of :
-        //- the input image (filtering image)
-        MultiChannelExtractROIFilterType::Pointer extractROIFilter = MultiChannelExtractROIFilterType::New();
-        extractROIFilter->SetInput(imageIn);
-        extractROIFilter->SetStartX(startX);
-        extractROIFilter->SetStartY(startY);
-        extractROIFilter->SetSizeX(sizeX);
-        extractROIFilter->SetSizeY(sizeY);
-        extractROIFilter->Update();
-
-        //- the spatial image (final positions) if available
-        MultiChannelExtractROIFilterType::Pointer extractROIFilter2 = MultiChannelExtractROIFilterType::New();
-        ConcatenateType::Pointer                  concat            = ConcatenateType::New();
-        CCFilterType::Pointer                     ccFilter          = CCFilterType::New();
-
-        if (HasValue("inpos"))
-        {
-          extractROIFilter2->SetInput(spatialIn);
-          extractROIFilter2->SetStartX(startX);
-          extractROIFilter2->SetStartY(startY);
-          extractROIFilter2->SetSizeX(sizeX);
-          extractROIFilter2->SetSizeY(sizeY);
-          extractROIFilter2->Update();
-
-          // Concatenation of the two input images
-          concat->SetInput1(extractROIFilter->GetOutput());
-          concat->SetInput2(extractROIFilter2->GetOutput());
-          concat->Update();
-
-          ccFilter->SetInput(concat->GetOutput());
-        }
-        else
-        {
-          ccFilter->SetInput(extractROIFilter->GetOutput());
-        }
-
-        // Expression 1 : radiometric distance < ranger
-        std::stringstream expr;
-        expr << "sqrt((p1b1-p2b1)*(p1b1-p2b1)";
-        for (unsigned int i = 1; i < nbComp; i++)
-          expr << "+(p1b" << i + 1 << "-p2b" << i + 1 << ")*(p1b" << i + 1 << "-p2b" << i + 1 << ")";
-        expr << ")"
-             << "<" << ranger;
-
-        if (HasValue("inpos"))
-        {
-          // Expression 2 : final positions < spatialr
-          expr << " and sqrt((p1b" << nbComp + 1 << "-p2b" << nbComp + 1 << ")*(p1b" << nbComp + 1 << "-p2b" << nbComp + 1 << ")+";
-          expr << "(p1b" << nbComp + 2 << "-p2b" << nbComp + 2 << ")*(p1b" << nbComp + 2 << "-p2b" << nbComp + 2 << "))"
-               << "<" << spatialr;
-        }
-
-        // Segmentation
-        ccFilter->GetFunctor().SetExpression(expr.str());
-        ccFilter->Update();
+        // Tiles extraction and segmentation
+        ImageType::Pointer      tile     = ExtractTile(imageIn, spatialIn, startX, startY, sizeX, sizeY);
+        LabelImagePixelType     maxLabel = 0;
+        LabelImageType::Pointer labels   = SegmentTile(tile, expression, maxLabel, false);
 
         // Shifting
         LabelShiftFilterType::Pointer labelShiftFilter = LabelShiftFilterType::New();
-        labelShiftFilter->SetInput(ccFilter->GetOutput());
+        labelShiftFilter->SetInput(labels);
         labelShiftFilter->GetFunctor().SetA(1);
         labelShiftFilter->GetFunctor().SetB(regionCount);
         labelShiftFilter->Update();
 
-        // Maximum label calculation for the shifting
-        StatisticsImageFilterType::Pointer stats = StatisticsImageFilterType::New();
-        stats->SetInput(ccFilter->GetOutput());
-        stats->Update();
-        regionCount += stats->GetMaximum();
+        regionCount += maxLabel;
 
         std::string filename = WriteTile(labelShiftFilter->GetOutput(), row, column, "SEG");
       }
@@ -509,37 +871,7 @@ private:
           tileUpReader->SetFileName(tileUp);
           tileUpReader->Update();
 
-          LabelImageType::IndexType pixelIndexIn;
-          LabelImageType::IndexType pixelIndexUp;
-
-          pixelIndexIn[1] = 0;
-          pixelIndexUp[1] = sizeTilesY;
-
-          for (pixelIndexIn[0] = 0; pixelIndexIn[0] < static_cast<long>(sizeX - 1); ++pixelIndexIn[0])
-          {
-            pixelIndexUp[0] = pixelIndexIn[0];
-
-            LabelImagePixelType curCanLabel = tileInReader->GetOutput()->GetPixel(pixelIndexIn);
-            while (LUT[curCanLabel] != curCanLabel)
-            {
-              curCanLabel = LUT[curCanLabel];
-            }
-            LabelImagePixelType adjCanLabel = tileUpReader->GetOutput()->GetPixel(pixelIndexUp);
-
-            while (LUT[adjCanLabel] != adjCanLabel)
-            {
-              adjCanLabel = LUT[adjCanLabel];
-            }
-            if (curCanLabel < adjCanLabel)
-            {
-              LUT[adjCanLabel] = curCanLabel;
-            }
-            else
-            {
-              LUT[LUT[curCanLabel]] = adjCanLabel;
-              LUT[curCanLabel]      = adjCanLabel;
-            }
-          }
+          StitchTiles(tileInReader->GetOutput(), 0, tileUpReader->GetOutput(), 0, 1, sizeTilesY, sizeX - 1, LUT);
         }
 
         // Analyse intersection between in and left tiles
@@ -550,36 +882,7 @@ private:
           tileLeftReader->SetFileName(tileLeft);
           tileLeftReader->Update();
 
-          LabelImageType::IndexType pixelIndexIn;
-          LabelImageType::IndexType pixelIndexUp;
-
-          pixelIndexIn[0] = 0;
-          pixelIndexUp[0] = sizeTilesX;
-
-          for (pixelIndexIn[1] = 0; pixelIndexIn[1] < static_cast<long>(sizeY - 1); ++pixelIndexIn[1])
-          {
-            pixelIndexUp[1] = pixelIndexIn[1];
-
-            LabelImagePixelType curCanLabel = tileInReader->GetOutput()->GetPixel(pixelIndexIn);
-            while (LUT[curCanLabel] != curCanLabel)
-            {
-              curCanLabel = LUT[curCanLabel];
-            }
-            LabelImagePixelType adjCanLabel = tileLeftReader->GetOutput()->GetPixel(pixelIndexUp);
-            while (LUT[adjCanLabel] != adjCanLabel)
-            {
-              adjCanLabel = LUT[adjCanLabel];
-            }
-            if (curCanLabel < adjCanLabel)
-            {
-              LUT[adjCanLabel] = curCanLabel;
-            }
-            else
-            {
-              LUT[LUT[curCanLabel]] = adjCanLabel;
-              LUT[curCanLabel]      = adjCanLabel;
-            }
-          }
+          StitchTiles(tileInReader->GetOutput(), 0, tileLeftReader->GetOutput(), 0, 0, sizeTilesX, sizeY - 1, LUT);
         }
       }
     }
@@ -587,12 +890,7 @@ private:
     // Reduce LUT to canonical labels
     for (LabelImagePixelType label = 1; label < regionCount + 1; ++label)
     {
-      LabelImagePixelType can = label;
-      while (LUT[can] != can)
-      {
-        can = LUT[can];
-      }
-      LUT[label] = can;
+      LUT[label] = FindCanonicalLabel(LUT, label);
     }
     otbAppLogINFO(<< "LUT size: " << LUT.size() << " segments");
 
@@ -659,27 +957,9 @@ private:
     // Clear lut, we do not need it anymore
     LUT.clear();
 
-    unsigned int smallCount = 0;
-
     // Create the LUT to filter small regions and assign min labels
     otbAppLogINFO(<< "Small regions pruning ...");
-    LabelImagePixelType              newLab = 1;
-    std::vector<LabelImagePixelType> newLabels(regionCount + 1, 0);
-    for (LabelImagePixelType curLabel = 1; curLabel <= regionCount; ++curLabel)
-    {
-      if (sizePerRegion[curLabel] < minRegionSize)
-      {
-        newLabels[curLabel] = 0;
-        ++smallCount;
-      }
-      else
-      {
-        newLabels[curLabel] = newLab;
-        newLab += 1;
-      }
-    }
-
-    otbAppLogINFO(<< smallCount << " small regions will be removed");
+    std::vector<LabelImagePixelType> newLabels = ComputeFinalLabels(sizePerRegion, minRegionSize);
 
     // Clear sizePerRegion, we do not need it anymore
     sizePerRegion.clear();
@@ -25,7 +25,7 @@
 #include "otbExtractROI.h"
 
 #include "otbStreamingStatisticsImageFilter.h"
-#include "otbLabelImageToOGRDataSourceFilter.h"
+#include "otbStreamingLabelImageVectorizationFilter.h"
 #include "otbOGRFeatureWrapper.h"
 
 #include <time.h>
@@ -58,7 +58,7 @@ public:
   typedef itk::ImageRegionConstIterator<LabelImageType> LabelImageIterator;
   typedef itk::ImageRegionConstIterator<ImageType>      ImageIterator;
 
-  typedef otb::LabelImageToOGRDataSourceFilter<LabelImageType> LabelImageToOGRDataSourceFilterType;
+  typedef otb::StreamingLabelImageVectorizationFilter<LabelImageType> VectorizationFilterType;
 
 
   itkNewMacro(Self);
@@ -79,9 +79,13 @@ private:
         " segment. Each polygon contains additional fields: mean and variance of"
         " each channels from input image (in parameter), segmentation image"
         " label, number of pixels in the polygon. For large images one can use"
-        " the tilesizex and tilesizey parameters for tile-wise processing, with"
-        " the guarantees of identical results.");
-    SetDocLimitations("This application is part of the Large-Scale Mean-Shift segmentation workflow (LSMS) and may not be suited for any other purpose.");
+        " the tilesizex and tilesizey parameters to compute the statistics"
+        " tile-wise. The vectorization itself is streamed according to the"
+        " available RAM (ram parameter). Both give identical results whatever"
+        " the tile sizes.");
+    SetDocLimitations(
+        "This application is part of the Large-Scale Mean-Shift segmentation workflow (LSMS) and may not be suited for any other purpose. "
+        "The boundaries of all the segments are kept in memory until the polygons are written, whatever the ram parameter.");
     SetDocAuthors("David Youssefi");
 
     SetDocSeeAlso(
@@ -106,12 +110,12 @@ private:
                             "radiometric means and variances.");
 
     AddParameter(ParameterType_Int, "tilesizex", "Size of tiles in pixel (X-axis)");
-    SetParameterDescription("tilesizex", "Size of tiles along the X-axis for tile-wise processing.");
+    SetParameterDescription("tilesizex", "Size of tiles along the X-axis for the tile-wise computation of the statistics.");
     SetDefaultParameterInt("tilesizex", 500);
     SetMinimumParameterIntValue("tilesizex", 1);
 
     AddParameter(ParameterType_Int, "tilesizey", "Size of tiles in pixel (Y-axis)");
-    SetParameterDescription("tilesizey", "Size of tiles along the Y-axis for tile-wise processing.");
+    SetParameterDescription("tilesizey", "Size of tiles along the Y-axis for the tile-wise computation of the statistics.");
     SetDefaultParameterInt("tilesizey", 500);
     SetMinimumParameterIntValue("tilesizey", 1);
 
@@ -213,8 +217,8 @@ private:
       layer.CreateField(field, true);
     }
 
-    // Vectorization per tile
-    otbAppLogINFO(<< "Vectorization ...");
+    // Statistics per tile
+    otbAppLogINFO(<< "Statistics ...");
     for (unsigned int row = 0; row < nbTilesY; row++)
     {
       for (unsigned int column = 0; column < nbTilesX; column++)
@@ -254,95 +258,28 @@ private:
             sum2[itLabel.Value()][comp] += itImage.Get()[comp] * itImage.Get()[comp];
           }
         }
-
-        labelImageROI = ExtractROIFilterType::New();
-        labelImageROI->SetInput(labelIn);
-        labelImageROI->SetStartX(startX);
-        labelImageROI->SetStartY(startY);
-        labelImageROI->SetSizeX(sizeX + 1);
-        labelImageROI->SetSizeY(sizeY + 1);
-        labelImageROI->Update();
-
-        // Raster->Vecteur conversion
-        LabelImageToOGRDataSourceFilterType::Pointer labelToOGR = LabelImageToOGRDataSourceFilterType::New();
-        labelToOGR->SetInput(labelImageROI->GetOutput());
-        labelToOGR->SetInputMask(labelImageROI->GetOutput());
-        labelToOGR->SetFieldName("label");
-        labelToOGR->Update();
-
-        otb::ogr::DataSource::ConstPointer ogrDSTmp = labelToOGR->GetOutput();
-        otb::ogr::Layer                    layerTmp = ogrDSTmp->GetLayerChecked(0);
-
-        otb::ogr::Layer::const_iterator featIt = layerTmp.begin();
-        for (; featIt != layerTmp.end(); ++featIt)
-        {
-          otb::ogr::Feature dstFeature(layer.GetLayerDefn());
-          dstFeature.SetFrom(*featIt, TRUE);
-          layer.CreateFeature(dstFeature);
-        }
       }
     }
 
-    // Sorting by increasing label of the features
-    std::ostringstream sqloss;
-    sqloss.str("");
-    sqloss << "SELECT * FROM \"" << layername << "\" ORDER BY label";
-    otb::ogr::Layer   layerTmp     = ogrDS->ExecuteSQL(sqloss.str(), nullptr, nullptr);
-    otb::ogr::Feature firstFeature = layerTmp.ogr().GetNextFeature();
-
-    // Geometry fusion
-    otbAppLogINFO("Merging polygons across tiles ...");
-    while (firstFeature.addr())
-    {
-      LabelImagePixelType curLabel = firstFeature.ogr().GetFieldAsInteger("label");
-
-      // Creation of a multipolygon where are stored the geometries to be merged
-      OGRMultiPolygon geomToMerge;
-      AddValidGeometry(geomToMerge, firstFeature.GetGeometry());
-      bool              merging = true;
-      otb::ogr::Feature nextFeature(nullptr);
-      bool              haveMerged = false;
-
-      while (merging)
-      {
-        nextFeature = layerTmp.ogr().GetNextFeature();
-
-        if (nextFeature.addr())
-        {
-          LabelImagePixelType newLabel = nextFeature.ogr().GetFieldAsInteger("label");
-          merging                      = (newLabel == curLabel);
-
-          // Storing of the new geometry if labels are identical
-          if (merging)
-          {
-            AddValidGeometry(geomToMerge, nextFeature.GetGeometry());
-            layer.DeleteFeature(nextFeature.GetFID());
-            haveMerged = true;
-          }
-          // If storing made and new label -> polygons fusion
-          else if (haveMerged)
-          {
-            otb::ogr::UniqueGeometryPtr fusionPolygon = otb::ogr::UnionCascaded(geomToMerge);
-            firstFeature.SetGeometry(fusionPolygon.get());
-          }
-        }
-        // If end of list : end of loop
-        else
-        {
-          merging = false;
-        }
-      }
-
-      // Features calculation
+    // Raster to vector conversion: the boundaries of the segments are traced
+    // by streaming and joined across the streaming tiles, so that each label
+    // gives a single feature without merging polygons afterwards
+    otbAppLogINFO(<< "Vectorization ...");
+    VectorizationFilterType::Pointer vectorization = VectorizationFilterType::New();
+    vectorization->SetInput(labelIn);
+    vectorization->SetInputMask(labelIn);
+    vectorization->SetOGRLayer(layer);
+    vectorization->SetFieldName("label");
+    vectorization->SetFeatureFieldsFunction([&](otb::ogr::Feature& feature, LabelImagePixelType curLabel) {
       // Number of pixels per label
-      firstFeature.ogr().SetField("nbPixels", nbPixels[curLabel]);
+      feature.ogr().SetField("nbPixels", nbPixels[curLabel]);
 
       // Radiometric means per label
       for (unsigned int comp = 0; comp < numberOfComponentsPerPixel; ++comp)
       {
         std::ostringstream fieldoss;
         fieldoss << "meanB" << comp;
-        firstFeature.ogr().SetField(fieldoss.str().c_str(), sum[curLabel][comp] / nbPixels[curLabel]);
+        feature.ogr().SetField(fieldoss.str().c_str(), sum[curLabel][comp] / nbPixels[curLabel]);
       }
 
       // Variances per label
@@ -353,32 +290,14 @@ private:
         float var = 0;
         if (nbPixels[curLabel] != 1)
           var = (sum2[curLabel][comp] - sum[curLabel][comp] * sum[curLabel][comp] / nbPixels[curLabel]) / (nbPixels[curLabel] - 1);
-        firstFeature.ogr().SetField(fieldoss.str().c_str(), var);
+        feature.ogr().SetField(fieldoss.str().c_str(), var);
       }
+    });
+    vectorization->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"));
+    AddProcess(vectorization->GetStreamer(), "Vectorization...");
+    vectorization->Update();
 
-      // Geometries simplification
-      otb::ogr::UniqueGeometryPtr geom = otb::ogr::Simplify(*firstFeature.GetGeometry(), 0);
-      firstFeature.SetGeometryDirectly(otb::ogr::Simplify(*geom, 0));
-
-      layer.SetFeature(firstFeature);
-
-      // Next geometry
-      firstFeature = nextFeature;
-    }
-
-    const OGRErr err = layer.ogr().CommitTransaction();
-
-    if (err != OGRERR_NONE)
-    {
-      itkExceptionMacro(<< "Unable to commit transaction for OGR layer " << layer.ogr().GetName() << ".");
-    }
-
-    if (extension == ".shp")
-    {
-      sqloss.str("");
-      sqloss << "REPACK " << layername;
-      ogrDS->ogr().ExecuteSQL(sqloss.str().c_str(), nullptr, nullptr);
-    }
+    otbAppLogINFO(<< "Number of polygons: " << vectorization->GetNumberOfFeatures());
 
     ogrDS->SyncToDisk();
 
@@ -386,18 +305,6 @@ private:
 
     otbAppLogINFO(<< "Elapsed time: " << (double)(toc - tic) / CLOCKS_PER_SEC << " seconds");
   }
-
-  void AddValidGeometry(OGRMultiPolygon& multi, OGRGeometry const* g)
-  {
-    if (g->IsValid())
-    {
-      multi.addGeometry(g);
-    }
-    else
-    {
-      multi.addGeometryDirectly(g->Simplify(0.0));
-    }
-  }
 };
 }
 }
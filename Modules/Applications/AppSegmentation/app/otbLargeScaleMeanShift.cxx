@@ -71,7 +71,12 @@ private:
         "are additional fields to describe each region. In particular the mean "
         "and standard deviation (for each band) is computed for each region "
         "using the input image as support. If an optional 'imfield' image is "
-        "given, it will be used as support image instead.");
+        "given, it will be used as support image instead.\n\n"
+        "By default, intermediate label images are written to temporary files. "
+        "With the 'memory' parameter, tiles are segmented concurrently and "
+        "stitched in memory, and the label images are passed in memory from one "
+        "step to the next, so that only the final output is written. The whole "
+        "label image must then fit in memory.");
     SetDocLimitations("None");
     SetDocAuthors("OTB-Team");
     SetDocSeeAlso(
@@ -96,6 +101,7 @@ private:
 
     ShareParameter("tilesizex", "segmentation.tilesizex");
     ShareParameter("tilesizey", "segmentation.tilesizey");
+    ShareParameter("memory", "segmentation.memory");
 
     AddParameter(ParameterType_Choice, "mode", "Output mode");
     SetParameterDescription("mode", "Type of segmented output");
@@ -156,29 +162,48 @@ private:
   void DoExecute() override
   {
     bool                     isVector(GetParameterString("mode") == "vector");
+    bool                     inMemory(GetParameterInt("memory"));
     std::string              outPath(isVector ? GetParameterString("mode.vector.out") : GetParameterString("mode.raster.out"));
     std::vector<std::string> tmpFilenames;
-    tmpFilenames.push_back(outPath + std::string("_labelmap.tif"));
-    tmpFilenames.push_back(outPath + std::string("_labelmap.geom"));
     ExecuteInternal("smoothing");
     // in-memory connexion here (saves 1 additional update for foutpos)
     GetInternalApplication("segmentation")->SetParameterInputImage("in", GetInternalApplication("smoothing")->GetParameterOutputImage("fout"));
     GetInternalApplication("segmentation")->SetParameterInputImage("inpos", GetInternalApplication("smoothing")->GetParameterOutputImage("foutpos"));
-    // temporary file output here
-    GetInternalApplication("segmentation")->SetParameterString("out", tmpFilenames[0]);
     // take half of previous radii
     GetInternalApplication("segmentation")->SetParameterFloat("spatialr", 0.5 * (double)GetInternalApplication("smoothing")->GetParameterInt("spatialr"));
     GetInternalApplication("segmentation")->SetParameterFloat("ranger", 0.5 * GetInternalApplication("smoothing")->GetParameterFloat("ranger"));
-    GetInternalApplication("segmentation")->ExecuteAndWriteOutput();
+    if (inMemory)
+    {
+      // the segmented image is kept in memory
+      ExecuteInternal("segmentation");
+      GetInternalApplication("merging")->SetParameterInputImage("inseg", GetInternalApplication("segmentation")->GetParameterOutputImage("out"));
+    }
+    else
+    {
+      // temporary file output here
+      tmpFilenames.push_back(outPath + std::string("_labelmap.tif"));
+      tmpFilenames.push_back(outPath + std::string("_labelmap.geom"));
+      GetInternalApplication("segmentation")->SetParameterString("out", tmpFilenames[0]);
+      GetInternalApplication("segmentation")->ExecuteAndWriteOutput();
+      GetInternalApplication("merging")->SetParameterString("inseg", tmpFilenames[0]);
+    }
 
-    GetInternalApplication("merging")->SetParameterString("inseg", tmpFilenames[0]);
     EnableParameter("mode.raster.out");
     if (isVector)
     {
-      tmpFilenames.push_back(outPath + std::string("_labelmap_merged.tif"));
-      tmpFilenames.push_back(outPath + std::string("_labelmap_merged.geom"));
-      GetInternalApplication("merging")->SetParameterString("out", tmpFilenames[2]);
-      GetInternalApplication("merging")->ExecuteAndWriteOutput();
+      if (inMemory)
+      {
+        ExecuteInternal("merging");
+        GetInternalApplication("vectorization")->SetParameterInputImage("inseg", GetInternalApplication("merging")->GetParameterOutputImage("out"));
+      }
+      else
+      {
+        tmpFilenames.push_back(outPath + std::string("_labelmap_merged.tif"));
+        tmpFilenames.push_back(outPath + std::string("_labelmap_merged.geom"));
+        GetInternalApplication("merging")->SetParameterString("out", tmpFilenames[2]);
+        GetInternalApplication("merging")->ExecuteAndWriteOutput();
+        GetInternalApplication("vectorization")->SetParameterString("inseg", tmpFilenames[2]);
+      }
       if (IsParameterEnabled("mode.vector.imfield") && HasValue("mode.vector.imfield"))
       {
         GetInternalApplication("vectorization")->SetParameterInputImage("in", GetParameterImageBase("mode.vector.imfield"));
@@ -187,7 +212,6 @@ private:
       {
         GetInternalApplication("vectorization")->SetParameterInputImage("in", GetParameterImageBase("in"));
       }
-      GetInternalApplication("vectorization")->SetParameterString("inseg", tmpFilenames[2]);
       ExecuteInternal("vectorization");
     }
     else
@@ -46,6 +46,7 @@ otb_module(OTBAppSegmentation
   TEST_DEPENDS
     OTBTestKernel
     OTBCommandLine
+    OTBAppVectorDataTranslation
 
   DESCRIPTION
     "${DOCUMENTATION}"
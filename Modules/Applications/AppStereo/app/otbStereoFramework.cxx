@@ -24,6 +24,7 @@
 #include "otbStreamingWarpImageFilter.h"
 #include "otbBandMathImageFilter.h"
 #include "otbSubPixelDisparityImageFilter.h"
+#include "otbSemiGlobalMatchingImageFilter.h"
 #include "otbDisparityMapMedianFilter.h"
 #include "otbDisparityMapToDEMFilter.h"
 #include "otbDisparityMapTo3DFilter.h"
@@ -127,6 +128,8 @@ public:
 
   typedef otb::SubPixelDisparityImageFilter<FloatImageType, FloatImageType, FloatImageType, FloatImageType, NCCBlockMatchingFunctorType> NCCSubPixelFilterType;
 
+  typedef otb::SemiGlobalMatchingImageFilter<FloatImageType, FloatImageType, FloatImageType, FloatImageType> SGMFilterType;
+
   typedef otb::DisparityMapMedianFilter<FloatImageType, FloatImageType, FloatImageType> MedianFilterType;
 
 
@@ -269,8 +272,8 @@ private:
         "* compute the epipolar displacement grids from the stereo pair (direct and inverse)\n"
         "* resample the stereo pair into epipolar geometry using BCO interpolation\n"
         "* create masks for each epipolar image: remove black borders and resample input masks\n"
-        "* compute horizontal disparities with a block matching algorithm\n"
-        "* refine disparities to sub-pixel precision with a dichotomy algorithm\n"
+        "* compute horizontal disparities with a block matching algorithm, or with semi-global matching\n"
+        "* refine disparities to sub-pixel precision with a dichotomy algorithm (block matching only)\n"
         "* apply an optional median filter\n"
         "* filter disparities based on the correlation score and exploration bounds\n"
         "* translate disparities in sensor geometry\n"
@@ -431,6 +434,38 @@ private:
                             "This group of parameters allow tuning the "
                             "block-matching behavior");
 
+    AddParameter(ParameterType_Choice, "bm.method", "Disparity estimation method");
+    SetParameterDescription("bm.method", "Method used to estimate the disparities between epipolar images");
+
+    AddChoice("bm.method.blocks", "Block matching");
+    SetParameterDescription("bm.method.blocks",
+                            "Local block matching with the chosen metric, followed by "
+                            "a sub-pixel refinement");
+
+    AddChoice("bm.method.sgm", "Semi-global matching");
+    SetParameterDescription("bm.method.sgm",
+                            "Census transform of radius bm.radius (at most 3), with costs "
+                            "aggregated along 8 paths. The metric is not used. Slower than "
+                            "block matching with small windows, but gives better results over "
+                            "low-texture areas.");
+
+    AddParameter(ParameterType_Int, "bm.method.sgm.p1", "Small disparity change penalty");
+    SetParameterDescription("bm.method.sgm.p1", "Penalty of disparity changes of one pixel along a path (in census bits)");
+    SetDefaultParameterInt("bm.method.sgm.p1", 8);
+    SetMinimumParameterIntValue("bm.method.sgm.p1", 0);
+
+    AddParameter(ParameterType_Int, "bm.method.sgm.p2", "Large disparity change penalty");
+    SetParameterDescription("bm.method.sgm.p2", "Penalty of disparity changes of more than one pixel along a path (in census bits)");
+    SetDefaultParameterInt("bm.method.sgm.p2", 32);
+    SetMinimumParameterIntValue("bm.method.sgm.p2", 0);
+
+    AddParameter(ParameterType_Int, "bm.method.sgm.overlap", "Overlap of the processed blocks");
+    SetParameterDescription("bm.method.sgm.overlap",
+                            "Number of pixels the aggregation paths run beyond each "
+                            "processed block of the epipolar images");
+    SetDefaultParameterInt("bm.method.sgm.overlap", 32);
+    SetMinimumParameterIntValue("bm.method.sgm.overlap", 0);
+
     AddParameter(ParameterType_Choice, "bm.metric", "Block-matching metric");
     SetParameterDescription("bm.metric", "Metric used to compute matching score");
     // SetDefaultParameterInt("bm.metric",3);
@@ -502,7 +537,9 @@ private:
     SetParameterDescription("postproc.metrict",
                             "Use block matching metric "
                             "output to discard pixels with low correlation value (disabled by "
-                            "default, float value)");
+                            "default, float value). With semi-global matching, the metric is the "
+                            "aggregated cost of the disparity (in census bits), and pixels with a "
+                            "cost above the threshold are discarded.");
     MandatoryOff("postproc.metrict");
     SetDefaultParameterFloat("postproc.metrict", 0.6);
     DisableParameter("postproc.metrict");
@@ -614,6 +651,30 @@ private:
     subPixelFilter->UpdateOutputInformation();
   }
 
+  void SetSemiGlobalMatchingParameters(SGMFilterType* sgmFilter, FloatImageType* leftImage, FloatImageType* rightImage, FloatImageType* leftMask,
+                                       FloatImageType* rightMask, double minDisp, double maxDisp)
+  {
+    // The census transform is stored on 64 bits
+    unsigned int radius = this->GetParameterInt("bm.radius");
+    if (radius > 3)
+    {
+      otbAppLogWARNING(<< "Radius " << radius << " is too large for the census transform of semi-global matching, using 3.");
+      radius = 3;
+    }
+
+    sgmFilter->SetLeftInput(leftImage);
+    sgmFilter->SetRightInput(rightImage);
+    sgmFilter->SetLeftMaskInput(leftMask);
+    sgmFilter->SetRightMaskInput(rightMask);
+    sgmFilter->SetRadius(radius);
+    sgmFilter->SetMinimumHorizontalDisparity(minDisp);
+    sgmFilter->SetMaximumHorizontalDisparity(maxDisp);
+    sgmFilter->SetP1(this->GetParameterInt("bm.method.sgm.p1"));
+    sgmFilter->SetP2(this->GetParameterInt("bm.method.sgm.p2"));
+    sgmFilter->SetOverlap(this->GetParameterInt("bm.method.sgm.overlap"));
+    sgmFilter->UpdateOutputInformation();
+  }
+
 
   void DoExecute() override
   {
@@ -944,112 +1005,152 @@ private:
       LPBlockMatchingFilterType::Pointer invLPBlockMatcherFilter;
       LPSubPixelFilterType::Pointer      LPSubPixelFilter;
 
-      switch (GetParameterInt("bm.metric"))
-      {
-      case 0: // SSDDivMean
-        otbAppLogINFO(<< "Using robust SSD Metric for BlockMatching.");
+      FloatImageType::Pointer hDispEstimate;
+      FloatImageType::Pointer vDispEstimate;
+      FloatImageType::Pointer metricEstimate;
+      SGMFilterType::Pointer  sgmFilter;
+      SGMFilterType::Pointer  invSgmFilter;
 
-        SSDDivMeanBlockMatcherFilter = SSDDivMeanBlockMatchingFilterType::New();
-        blockMatcherFilterPointer    = SSDDivMeanBlockMatcherFilter.GetPointer();
-        m_Filters.push_back(blockMatcherFilterPointer);
-
-        if (GetParameterInt("postproc.bij"))
-        {
-          // Reverse correlation
-          invSSDDivMeanBlockMatcherFilter = SSDDivMeanBlockMatchingFilterType::New();
-          invBlockMatcherFilterPointer    = invSSDDivMeanBlockMatcherFilter.GetPointer();
-          m_Filters.push_back(invBlockMatcherFilterPointer);
-        }
-        SSDDivMeanSubPixelFilter = SSDDivMeanSubPixelFilterType::New();
-        subPixelFilterPointer    = SSDDivMeanSubPixelFilter.GetPointer();
-        m_Filters.push_back(SSDDivMeanSubPixelFilter.GetPointer());
-
-        minimize = true;
-        this->SetBlockMatchingParameters<FloatImageType, SSDDivMeanBlockMatchingFunctorType>(
-            SSDDivMeanBlockMatcherFilter, invSSDDivMeanBlockMatcherFilter, SSDDivMeanSubPixelFilter, leftResampleFilter->GetOutput(),
-            rightResampleFilter->GetOutput(), lBandMathFilter->GetOutput(), rBandMathFilter->GetOutput(), finalMaskFilter->GetOutput(), minimize, minDisp,
-            maxDisp);
-
-        break;
-
-      case 1: // SSD
-        otbAppLogINFO(<< "Using SSD Metric for BlockMatching.");
+      if (GetParameterString("bm.method") == "sgm")
+      {
+        otbAppLogINFO(<< "Using semi-global matching.");
 
-        SSDBlockMatcherFilter     = SSDBlockMatchingFilterType::New();
-        blockMatcherFilterPointer = SSDBlockMatcherFilter.GetPointer();
+        sgmFilter                 = SGMFilterType::New();
+        blockMatcherFilterPointer = sgmFilter.GetPointer();
         m_Filters.push_back(blockMatcherFilterPointer);
+        this->SetSemiGlobalMatchingParameters(sgmFilter, leftResampleFilter->GetOutput(), rightResampleFilter->GetOutput(), lBandMathFilter->GetOutput(),
+                                              rBandMathFilter->GetOutput(), minDisp, maxDisp);
 
         if (GetParameterInt("postproc.bij"))
         {
-          // Reverse correlation
-          invSSDBlockMatcherFilter     = SSDBlockMatchingFilterType::New();
-          invBlockMatcherFilterPointer = invSSDBlockMatcherFilter.GetPointer();
+          // Reverse matching
+          invSgmFilter                 = SGMFilterType::New();
+          invBlockMatcherFilterPointer = invSgmFilter.GetPointer();
           m_Filters.push_back(invBlockMatcherFilterPointer);
+          this->SetSemiGlobalMatchingParameters(invSgmFilter, rightResampleFilter->GetOutput(), leftResampleFilter->GetOutput(), rBandMathFilter->GetOutput(),
+                                                lBandMathFilter->GetOutput(), -maxDisp, -minDisp);
         }
-        SSDSubPixelFilter     = SSDSubPixelFilterType::New();
-        subPixelFilterPointer = SSDSubPixelFilter.GetPointer();
-        m_Filters.push_back(SSDSubPixelFilter.GetPointer());
 
-        minimize = true;
-        this->SetBlockMatchingParameters<FloatImageType, SSDBlockMatchingFunctorType>(
-            SSDBlockMatcherFilter, invSSDBlockMatcherFilter, SSDSubPixelFilter, leftResampleFilter->GetOutput(), rightResampleFilter->GetOutput(),
-            lBandMathFilter->GetOutput(), rBandMathFilter->GetOutput(), finalMaskFilter->GetOutput(), minimize, minDisp, maxDisp);
-
-        break;
-      case 2: // NCC
-        otbAppLogINFO(<< "Using NCC Metric for BlockMatching.");
-
-        NCCBlockMatcherFilter     = NCCBlockMatchingFilterType::New();
-        blockMatcherFilterPointer = NCCBlockMatcherFilter.GetPointer();
-        m_Filters.push_back(blockMatcherFilterPointer);
-
-        if (GetParameterInt("postproc.bij"))
+        // Disparities are refined by the filter itself. The metric is the
+        // aggregated cost of the kept disparity: the lower, the better.
+        hDispEstimate  = sgmFilter->GetHorizontalDisparityOutput();
+        vDispEstimate  = sgmFilter->GetVerticalDisparityOutput();
+        metricEstimate = sgmFilter->GetMetricOutput();
+        minimize       = true;
+      }
+      else
+      {
+        switch (GetParameterInt("bm.metric"))
         {
-          // Reverse correlation
-          invNCCBlockMatcherFilter     = NCCBlockMatchingFilterType::New();
-          invBlockMatcherFilterPointer = invNCCBlockMatcherFilter.GetPointer();
-          m_Filters.push_back(invBlockMatcherFilterPointer);
+        case 0: // SSDDivMean
+          otbAppLogINFO(<< "Using robust SSD Metric for BlockMatching.");
+
+          SSDDivMeanBlockMatcherFilter = SSDDivMeanBlockMatchingFilterType::New();
+          blockMatcherFilterPointer    = SSDDivMeanBlockMatcherFilter.GetPointer();
+          m_Filters.push_back(blockMatcherFilterPointer);
+
+          if (GetParameterInt("postproc.bij"))
+          {
+            // Reverse correlation
+            invSSDDivMeanBlockMatcherFilter = SSDDivMeanBlockMatchingFilterType::New();
+            invBlockMatcherFilterPointer    = invSSDDivMeanBlockMatcherFilter.GetPointer();
+            m_Filters.push_back(invBlockMatcherFilterPointer);
+          }
+          SSDDivMeanSubPixelFilter = SSDDivMeanSubPixelFilterType::New();
+          subPixelFilterPointer    = SSDDivMeanSubPixelFilter.GetPointer();
+          m_Filters.push_back(SSDDivMeanSubPixelFilter.GetPointer());
+
+          minimize = true;
+          this->SetBlockMatchingParameters<FloatImageType, SSDDivMeanBlockMatchingFunctorType>(
+              SSDDivMeanBlockMatcherFilter, invSSDDivMeanBlockMatcherFilter, SSDDivMeanSubPixelFilter, leftResampleFilter->GetOutput(),
+              rightResampleFilter->GetOutput(), lBandMathFilter->GetOutput(), rBandMathFilter->GetOutput(), finalMaskFilter->GetOutput(), minimize, minDisp,
+              maxDisp);
+
+          break;
+
+        case 1: // SSD
+          otbAppLogINFO(<< "Using SSD Metric for BlockMatching.");
+
+          SSDBlockMatcherFilter     = SSDBlockMatchingFilterType::New();
+          blockMatcherFilterPointer = SSDBlockMatcherFilter.GetPointer();
+          m_Filters.push_back(blockMatcherFilterPointer);
+
+          if (GetParameterInt("postproc.bij"))
+          {
+            // Reverse correlation
+            invSSDBlockMatcherFilter     = SSDBlockMatchingFilterType::New();
+            invBlockMatcherFilterPointer = invSSDBlockMatcherFilter.GetPointer();
+            m_Filters.push_back(invBlockMatcherFilterPointer);
+          }
+          SSDSubPixelFilter     = SSDSubPixelFilterType::New();
+          subPixelFilterPointer = SSDSubPixelFilter.GetPointer();
+          m_Filters.push_back(SSDSubPixelFilter.GetPointer());
+
+          minimize = true;
+          this->SetBlockMatchingParameters<FloatImageType, SSDBlockMatchingFunctorType>(
+              SSDBlockMatcherFilter, invSSDBlockMatcherFilter, SSDSubPixelFilter, leftResampleFilter->GetOutput(), rightResampleFilter->GetOutput(),
+              lBandMathFilter->GetOutput(), rBandMathFilter->GetOutput(), finalMaskFilter->GetOutput(), minimize, minDisp, maxDisp);
+
+          break;
+        case 2: // NCC
+          otbAppLogINFO(<< "Using NCC Metric for BlockMatching.");
+
+          NCCBlockMatcherFilter     = NCCBlockMatchingFilterType::New();
+          blockMatcherFilterPointer = NCCBlockMatcherFilter.GetPointer();
+          m_Filters.push_back(blockMatcherFilterPointer);
+
+          if (GetParameterInt("postproc.bij"))
+          {
+            // Reverse correlation
+            invNCCBlockMatcherFilter     = NCCBlockMatchingFilterType::New();
+            invBlockMatcherFilterPointer = invNCCBlockMatcherFilter.GetPointer();
+            m_Filters.push_back(invBlockMatcherFilterPointer);
+          }
+          NCCSubPixelFilter     = NCCSubPixelFilterType::New();
+          subPixelFilterPointer = NCCSubPixelFilter.GetPointer();
+          m_Filters.push_back(NCCSubPixelFilter.GetPointer());
+
+          minimize = false;
+          this->SetBlockMatchingParameters<FloatImageType, NCCBlockMatchingFunctorType>(
+              NCCBlockMatcherFilter, invNCCBlockMatcherFilter, NCCSubPixelFilter, leftResampleFilter->GetOutput(), rightResampleFilter->GetOutput(),
+              lBandMathFilter->GetOutput(), rBandMathFilter->GetOutput(), finalMaskFilter->GetOutput(), minimize, minDisp, maxDisp);
+          break;
+
+
+        case 3: // LP
+          otbAppLogINFO(<< "Using Lp Metric for BlockMatching.");
+
+          LPBlockMatcherFilter = LPBlockMatchingFilterType::New();
+          LPBlockMatcherFilter->GetFunctor().SetP(static_cast<double>(GetParameterFloat("bm.metric.lp.p")));
+
+          blockMatcherFilterPointer = LPBlockMatcherFilter.GetPointer();
+          m_Filters.push_back(blockMatcherFilterPointer);
+
+          if (GetParameterInt("postproc.bij"))
+          {
+            // Reverse correlation
+            invLPBlockMatcherFilter = LPBlockMatchingFilterType::New();
+            invLPBlockMatcherFilter->GetFunctor().SetP(static_cast<double>(GetParameterFloat("bm.metric.lp.p")));
+            invBlockMatcherFilterPointer = invLPBlockMatcherFilter.GetPointer();
+            m_Filters.push_back(invBlockMatcherFilterPointer);
+          }
+          LPSubPixelFilter      = LPSubPixelFilterType::New();
+          subPixelFilterPointer = LPSubPixelFilter.GetPointer();
+          m_Filters.push_back(LPSubPixelFilter.GetPointer());
+
+          minimize = false;
+          this->SetBlockMatchingParameters<FloatImageType, LPBlockMatchingFunctorType>(
+              LPBlockMatcherFilter, invLPBlockMatcherFilter, LPSubPixelFilter, leftResampleFilter->GetOutput(), rightResampleFilter->GetOutput(),
+              lBandMathFilter->GetOutput(), rBandMathFilter->GetOutput(), finalMaskFilter->GetOutput(), minimize, minDisp, maxDisp);
+
+          break;
+        default:
+          break;
         }
-        NCCSubPixelFilter     = NCCSubPixelFilterType::New();
-        subPixelFilterPointer = NCCSubPixelFilter.GetPointer();
-        m_Filters.push_back(NCCSubPixelFilter.GetPointer());
-
-        minimize = false;
-        this->SetBlockMatchingParameters<FloatImageType, NCCBlockMatchingFunctorType>(
-            NCCBlockMatcherFilter, invNCCBlockMatcherFilter, NCCSubPixelFilter, leftResampleFilter->GetOutput(), rightResampleFilter->GetOutput(),
-            lBandMathFilter->GetOutput(), rBandMathFilter->GetOutput(), finalMaskFilter->GetOutput(), minimize, minDisp, maxDisp);
-        break;
 
-
-      case 3: // LP
-        otbAppLogINFO(<< "Using Lp Metric for BlockMatching.");
-
-        LPBlockMatcherFilter = LPBlockMatchingFilterType::New();
-        LPBlockMatcherFilter->GetFunctor().SetP(static_cast<double>(GetParameterFloat("bm.metric.lp.p")));
-
-        blockMatcherFilterPointer = LPBlockMatcherFilter.GetPointer();
-        m_Filters.push_back(blockMatcherFilterPointer);
-
-        if (GetParameterInt("postproc.bij"))
-        {
-          // Reverse correlation
-          invLPBlockMatcherFilter = LPBlockMatchingFilterType::New();
-          invLPBlockMatcherFilter->GetFunctor().SetP(static_cast<double>(GetParameterFloat("bm.metric.lp.p")));
-          invBlockMatcherFilterPointer = invLPBlockMatcherFilter.GetPointer();
-          m_Filters.push_back(invBlockMatcherFilterPointer);
-        }
-        LPSubPixelFilter      = LPSubPixelFilterType::New();
-        subPixelFilterPointer = LPSubPixelFilter.GetPointer();
-        m_Filters.push_back(LPSubPixelFilter.GetPointer());
-
-        minimize = false;
-        this->SetBlockMatchingParameters<FloatImageType, LPBlockMatchingFunctorType>(
-            LPBlockMatcherFilter, invLPBlockMatcherFilter, LPSubPixelFilter, leftResampleFilter->GetOutput(), rightResampleFilter->GetOutput(),
-            lBandMathFilter->GetOutput(), rBandMathFilter->GetOutput(), finalMaskFilter->GetOutput(), minimize, minDisp, maxDisp);
-
-        break;
-      default:
-        break;
+        hDispEstimate  = subPixelFilterPointer->GetOutput(0);
+        vDispEstimate  = subPixelFilterPointer->GetOutput(1);
+        metricEstimate = subPixelFilterPointer->GetOutput(2);
       }
 
       if (GetParameterInt("postproc.bij"))
@@ -1080,12 +1181,12 @@ private:
       }
 
 
-      FloatImageType::Pointer hDispOutput    = subPixelFilterPointer->GetOutput(0);
+      FloatImageType::Pointer hDispOutput    = hDispEstimate;
       FloatImageType::Pointer finalMaskImage = finalMaskFilter->GetOutput();
       if (GetParameterInt("postproc.med"))
       {
         MedianFilterType::Pointer hMedianFilter = MedianFilterType::New();
-        hMedianFilter->SetInput(subPixelFilterPointer->GetOutput(0));
+        hMedianFilter->SetInput(hDispEstimate);
         hMedianFilter->SetRadius(2);
         hMedianFilter->SetIncoherenceThreshold(2.0);
         hMedianFilter->SetMaskInput(finalMaskFilter->GetOutput());
@@ -1097,7 +1198,7 @@ private:
 
       DisparityTranslateFilter::Pointer disparityTranslateFilter = DisparityTranslateFilter::New();
       disparityTranslateFilter->SetHorizontalDisparityMapInput(hDispOutput);
-      disparityTranslateFilter->SetVerticalDisparityMapInput(subPixelFilterPointer->GetOutput(1));
+      disparityTranslateFilter->SetVerticalDisparityMapInput(vDispEstimate);
       disparityTranslateFilter->SetInverseEpipolarLeftGrid(leftInverseDisplacement);
       disparityTranslateFilter->SetDirectEpipolarRightGrid(rightDisplacement);
       // disparityTranslateFilter->SetDisparityMaskInput()
@@ -1213,7 +1314,7 @@ private:
       maskCondition << "(hdisp > " << minDisp << ") and (hdisp < " << maxDisp << ") and (mask>0)";
       if (IsParameterEnabled("postproc.metrict"))
       {
-        dispMaskFilter->SetNthInput(2, subPixelFilterPointer->GetOutput(2), "metric");
+        dispMaskFilter->SetNthInput(2, metricEstimate, "metric");
         maskCondition << " and (metric ";
         if (minimize == true)
         {
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbExpressionKernel_h
+#define otbExpressionKernel_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "OTBCommonExport.h"
+
+namespace otb
+{
+
+/** \class ExpressionKernel
+ * \brief Compiles a scalar math expression into a kernel evaluated on arrays.
+ *
+ * The expression is parsed once and lowered to a small register program where
+ * each instruction processes a whole chunk of values (for instance a scanline
+ * of an image) in a tight loop that the compiler can vectorize. This removes
+ * the per-pixel interpretation overhead of muParser / muParserX for simple
+ * band math expressions (indices, thresholds, ...).
+ *
+ * Only a conservative subset of the muParser and muParserX syntaxes is
+ * supported: numbers, variables, + - * / ^, unary + and -, comparisons,
+ * && and ||, the ternary operator and a few functions whose semantics are
+ * identical in the interpreters. Ambiguous constructs (chained powers or
+ * comparisons, unary minus applied to a power, ...) are rejected as well.
+ * Compile() returns false whenever the expression falls outside this subset,
+ * in which case the caller must fall back to the interpreter.
+ *
+ * A compiled kernel is read-only and may be shared by several threads, each
+ * thread providing its own Workspace.
+ *
+ * \ingroup OTBCommon
+ */
+class OTBCommon_EXPORT ExpressionKernel
+{
+public:
+  typedef double ValueType;
+
+  /** Syntax and set of functions to accept */
+  enum Dialect
+  {
+    MuParser,
+    MuParserX
+  };
+
+  /** Number of values processed by each instruction at once */
+  static const std::size_t ChunkSize = 256;
+
+  /** \class Workspace
+   * \brief Per-thread scratch memory used by Evaluate()
+   *
+   * \ingroup OTBCommon
+   */
+  class OTBCommon_EXPORT Workspace
+  {
+  public:
+    Workspace() : m_Owner(nullptr), m_CompileId(0)
+    {
+    }
+
+  private:
+    friend class ExpressionKernel;
+    std::vector<ValueType>  m_Registers;
+    const ExpressionKernel* m_Owner;
+    unsigned long           m_CompileId;
+  };
+
+  ExpressionKernel();
+
+  /** Compile the expression. variableNames gives the name of each variable,
+   *  in the order of the arrays given to Evaluate(). Returns false if the
+   *  expression can not be compiled (the kernel is then left empty). */
+  bool Compile(const std::string& expression, const std::vector<std::string>& variableNames, Dialect dialect = MuParser);
+
+  /** Remove the compiled program */
+  void Clear();
+
+  bool IsCompiled() const
+  {
+    return m_Compiled;
+  }
+
+  /** Number of instructions of the compiled program (folded constants and
+   *  plain variables do not generate any instruction) */
+  std::size_t GetNumberOfInstructions() const
+  {
+    return m_Program.size();
+  }
+
+  /** Evaluate the kernel on count elements. variables[i] points to count
+   *  contiguous values of the i-th variable. The results are written in
+   *  result, which must hold count values. */
+  void Evaluate(const ValueType* const* variables, std::size_t count, ValueType* result, Workspace& workspace) const;
+
+  /** Identifiers of the instructions */
+  enum OpCode
+  {
+    Neg, Add, Sub, Mul, Div, Pow,
+    Lt, Gt, Le, Ge, Eq, Ne, And, Or, Select,
+    Sin, Cos, Tan, Asin, Acos, Atan, Sinh, Cosh, Tanh,
+    Exp, Ln, Log2, Log10, Sqrt, Abs, Sign, Rint,
+    Min, Max, Ndvi, Atan2
+  };
+
+private:
+  /** Operand of an instruction: an input variable or a register */
+  struct Operand
+  {
+    bool         isVariable;
+    unsigned int index;
+  };
+
+  struct Instruction
+  {
+    OpCode       op;
+    unsigned int arity;
+    unsigned int destination;
+    Operand      args[3];
+  };
+
+  class Compiler;
+  friend class Compiler;
+
+  /** Scalar version of each instruction, used for constant folding */
+  static ValueType Apply(OpCode op, ValueType a, ValueType b, ValueType c);
+
+  void InitializeWorkspace(Workspace& workspace) const;
+
+  std::vector<Instruction> m_Program;
+
+  /** Values of the constant registers (registers [0, m_Constants.size()[) */
+  std::vector<ValueType> m_Constants;
+
+  unsigned int  m_NumberOfRegisters;
+  Operand       m_Result;
+  bool          m_Compiled;
+  unsigned long m_CompileId;
+};
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,971 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbExpressionKernel.h"
+#include "otbMath.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <locale>
+#include <map>
+#include <sstream>
+
+namespace otb
+{
+
+const std::size_t ExpressionKernel::ChunkSize;
+
+namespace
+{
+typedef ExpressionKernel::ValueType ValueType;
+
+// Scalar semantics shared by the constant folding and the array loops. They
+// follow the muParser / OTB parser implementations.
+inline ValueType MinOf(ValueType a, ValueType b)
+{
+  return b < a ? b : a;
+}
+
+inline ValueType MaxOf(ValueType a, ValueType b)
+{
+  return a < b ? b : a;
+}
+
+inline ValueType SignOf(ValueType v)
+{
+  return (v < 0) ? -1 : ((v > 0) ? 1 : 0);
+}
+
+inline ValueType RintOf(ValueType v)
+{
+  return std::floor(v + 0.5);
+}
+
+inline ValueType NdviOf(ValueType r, ValueType niri)
+{
+  if (std::abs(r + niri) < 1E-6)
+  {
+    return 0.;
+  }
+  return (niri - r) / (niri + r);
+}
+
+template <class TFunction>
+inline void Map1(ValueType* d, const ValueType* a, std::size_t n, TFunction f)
+{
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    d[i] = f(a[i]);
+  }
+}
+
+template <class TFunction>
+inline void Map2(ValueType* d, const ValueType* a, const ValueType* b, std::size_t n, TFunction f)
+{
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    d[i] = f(a[i], b[i]);
+  }
+}
+
+unsigned long NextCompileId()
+{
+  static unsigned long id = 0;
+  return ++id;
+}
+
+} // end anonymous namespace
+
+
+/** Recursive descent parser building an expression tree, then lowering it to
+ *  the register program of the kernel */
+class ExpressionKernel::Compiler
+{
+public:
+  Compiler(const std::string& expression, const std::vector<std::string>& variableNames, Dialect dialect)
+    : m_Expression(expression), m_Pos(0), m_Failed(false), m_Dialect(dialect)
+  {
+    for (unsigned int i = 0; i < variableNames.size(); ++i)
+    {
+      m_Variables.insert(std::make_pair(variableNames[i], i));
+    }
+  }
+
+  bool Run(ExpressionKernel& kernel)
+  {
+    const int root = ParseTernary();
+    SkipSpaces();
+    if (m_Failed || root < 0 || m_Pos != m_Expression.size())
+    {
+      return false;
+    }
+
+    // A boolean result is not converted to a number by muParserX
+    if (m_Dialect == MuParserX && m_Nodes[root].kind == Node::Operation && IsLogical(m_Nodes[root].op))
+    {
+      return false;
+    }
+
+    const TmpOperand result = Lower(root);
+    AllocateRegisters(kernel, result);
+    return true;
+  }
+
+private:
+  struct Node
+  {
+    enum Kind
+    {
+      Constant,
+      Variable,
+      Operation
+    };
+    Kind             kind;
+    ValueType        value;
+    unsigned int     variable;
+    OpCode           op;
+    std::vector<int> children;
+    bool             parenthesized;
+  };
+
+  /** Operand before register allocation */
+  struct TmpOperand
+  {
+    enum Kind
+    {
+      Variable,
+      Constant,
+      Instruction
+    };
+    Kind         kind;
+    unsigned int index;
+  };
+
+  struct TmpInstruction
+  {
+    OpCode                  op;
+    std::vector<TmpOperand> args;
+  };
+
+  static bool IsLogical(OpCode op)
+  {
+    return op == Lt || op == Gt || op == Le || op == Ge || op == Eq || op == Ne || op == And || op == Or;
+  }
+
+  int Fail()
+  {
+    m_Failed = true;
+    return -1;
+  }
+
+  int NewConstant(ValueType value)
+  {
+    Node n;
+    n.kind          = Node::Constant;
+    n.value         = value;
+    n.variable      = 0;
+    n.op            = Add;
+    n.parenthesized = false;
+    m_Nodes.push_back(n);
+    return static_cast<int>(m_Nodes.size()) - 1;
+  }
+
+  int NewVariable(unsigned int index)
+  {
+    const int id               = NewConstant(0.);
+    m_Nodes[id].kind     = Node::Variable;
+    m_Nodes[id].variable = index;
+    return id;
+  }
+
+  int NewOperation(OpCode op, int a, int b = -1, int c = -1)
+  {
+    if (a < 0 || (b < 0 && c >= 0))
+    {
+      return Fail();
+    }
+    const int id         = NewConstant(0.);
+    m_Nodes[id].kind = Node::Operation;
+    m_Nodes[id].op   = op;
+    m_Nodes[id].children.push_back(a);
+    if (b >= 0)
+      m_Nodes[id].children.push_back(b);
+    if (c >= 0)
+      m_Nodes[id].children.push_back(c);
+    return id;
+  }
+
+  void SkipSpaces()
+  {
+    while (m_Pos < m_Expression.size() && std::isspace(static_cast<unsigned char>(m_Expression[m_Pos])))
+    {
+      ++m_Pos;
+    }
+  }
+
+  /** Consume token if it is next in the expression */
+  bool Accept(const char* token)
+  {
+    SkipSpaces();
+    const std::size_t len = std::strlen(token);
+    if (m_Expression.compare(m_Pos, len, token) == 0)
+    {
+      m_Pos += len;
+      return true;
+    }
+    return false;
+  }
+
+  bool Peek(const char* token)
+  {
+    SkipSpaces();
+    return m_Expression.compare(m_Pos, std::strlen(token), token) == 0;
+  }
+
+  // ternary := lor [ '?' ternary ':' ternary ]
+  int ParseTernary()
+  {
+    const int condition = ParseOr();
+    if (m_Failed || !Accept("?"))
+    {
+      return condition;
+    }
+    const int ifTrue = ParseTernary();
+    if (m_Failed || !Accept(":"))
+    {
+      return Fail();
+    }
+    const int ifFalse = ParseTernary();
+    return NewOperation(Select, condition, ifTrue, ifFalse);
+  }
+
+  // lor := land ( '||' land )*
+  int ParseOr()
+  {
+    int left = ParseAnd();
+    while (!m_Failed && Accept("||"))
+    {
+      left = NewOperation(Or, left, ParseAnd());
+    }
+    return left;
+  }
+
+  // land := cmp ( '&&' cmp )*
+  int ParseAnd()
+  {
+    int left = ParseComparison();
+    while (!m_Failed && Accept("&&"))
+    {
+      left = NewOperation(And, left, ParseComparison());
+    }
+    return left;
+  }
+
+  // cmp := add [ cmpop add ], chained comparisons are rejected since their
+  // precedence differs between the interpreters and C
+  int ParseComparison()
+  {
+    const int left = ParseAdditive();
+    if (m_Failed)
+    {
+      return -1;
+    }
+    OpCode op;
+    if (Accept("<="))
+      op = Le;
+    else if (Accept(">="))
+      op = Ge;
+    else if (Accept("=="))
+      op = Eq;
+    else if (Accept("!="))
+      op = Ne;
+    else if (Accept("<"))
+      op = Lt;
+    else if (Accept(">"))
+      op = Gt;
+    else
+      return left;
+
+    const int right = ParseAdditive();
+    if (Peek("<") || Peek(">") || Peek("==") || Peek("!="))
+    {
+      return Fail();
+    }
+    return NewOperation(op, left, right);
+  }
+
+  // add := mul ( ('+'|'-') mul )*
+  int ParseAdditive()
+  {
+    int left = ParseMultiplicative();
+    while (!m_Failed)
+    {
+      if (Accept("+"))
+        left = NewOperation(Add, left, ParseMultiplicative());
+      else if (Accept("-"))
+        left = NewOperation(Sub, left, ParseMultiplicative());
+      else
+        break;
+    }
+    return left;
+  }
+
+  // mul := unary ( ('*'|'/') unary )*
+  int ParseMultiplicative()
+  {
+    int left = ParseUnary();
+    while (!m_Failed)
+    {
+      // element-wise operators of muParserX (.*, ./, .^) are not supported
+      if (Peek("*") && !Peek("**"))
+      {
+        Accept("*");
+        left = NewOperation(Mul, left, ParseUnary());
+      }
+      else if (Accept("/"))
+        left = NewOperation(Div, left, ParseUnary());
+      else
+        break;
+    }
+    return left;
+  }
+
+  // unary := ('-'|'+') unary | pow
+  int ParseUnary()
+  {
+    if (Accept("-"))
+    {
+      const int operand = ParseUnary();
+      // -a^b: the precedence of the sign and of the power is ambiguous
+      if (operand >= 0 && m_Nodes[operand].kind == Node::Operation && m_Nodes[operand].op == Pow && !m_Nodes[operand].parenthesized)
+      {
+        return Fail();
+      }
+      return NewOperation(Neg, operand);
+    }
+    if (Accept("+"))
+    {
+      return ParseUnary();
+    }
+    return ParsePower();
+  }
+
+  // pow := primary [ '^' ['-'|'+'] primary ], chains are rejected since the
+  // associativity differs between the interpreters
+  int ParsePower()
+  {
+    const int base = ParsePrimary();
+    if (m_Failed || !Accept("^"))
+    {
+      return base;
+    }
+    int exponent;
+    if (Accept("-"))
+      exponent = NewOperation(Neg, ParsePrimary());
+    else
+    {
+      Accept("+");
+      exponent = ParsePrimary();
+    }
+    if (Peek("^"))
+    {
+      return Fail();
+    }
+    return NewOperation(Pow, base, exponent);
+  }
+
+  int ParsePrimary()
+  {
+    SkipSpaces();
+    if (m_Pos >= m_Expression.size())
+    {
+      return Fail();
+    }
+
+    const char c = m_Expression[m_Pos];
+    if (c == '(')
+    {
+      ++m_Pos;
+      const int inner = ParseTernary();
+      if (m_Failed || !Accept(")"))
+      {
+        return Fail();
+      }
+      m_Nodes[inner].parenthesized = true;
+      return inner;
+    }
+    if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+    {
+      return ParseNumber();
+    }
+    if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+    {
+      return ParseIdentifier();
+    }
+    return Fail();
+  }
+
+  int ParseNumber()
+  {
+    const std::size_t start = m_Pos;
+    bool              digit = false;
+    while (m_Pos < m_Expression.size() && std::isdigit(static_cast<unsigned char>(m_Expression[m_Pos])))
+    {
+      ++m_Pos;
+      digit = true;
+    }
+    if (m_Pos < m_Expression.size() && m_Expression[m_Pos] == '.')
+    {
+      ++m_Pos;
+      while (m_Pos < m_Expression.size() && std::isdigit(static_cast<unsigned char>(m_Expression[m_Pos])))
+      {
+        ++m_Pos;
+        digit = true;
+      }
+    }
+    if (!digit)
+    {
+      return Fail();
+    }
+    if (m_Pos < m_Expression.size() && (m_Expression[m_Pos] == 'e' || m_Expression[m_Pos] == 'E'))
+    {
+      std::size_t expPos = m_Pos + 1;
+      if (expPos < m_Expression.size() && (m_Expression[expPos] == '+' || m_Expression[expPos] == '-'))
+      {
+        ++expPos;
+      }
+      if (expPos < m_Expression.size() && std::isdigit(static_cast<unsigned char>(m_Expression[expPos])))
+      {
+        m_Pos = expPos;
+        while (m_Pos < m_Expression.size() && std::isdigit(static_cast<unsigned char>(m_Expression[m_Pos])))
+        {
+          ++m_Pos;
+        }
+      }
+    }
+    // identifiers can not directly follow a number
+    if (m_Pos < m_Expression.size() && (std::isalpha(static_cast<unsigned char>(m_Expression[m_Pos])) || m_Expression[m_Pos] == '_'))
+    {
+      return Fail();
+    }
+
+    std::istringstream iss(m_Expression.substr(start, m_Pos - start));
+    iss.imbue(std::locale::classic());
+    ValueType value = 0.;
+    iss >> value;
+    if (iss.fail())
+    {
+      return Fail();
+    }
+    return NewConstant(value);
+  }
+
+  static bool IsNameChar(char c)
+  {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+  }
+
+  int ParseIdentifier()
+  {
+    const std::size_t start = m_Pos;
+    while (m_Pos < m_Expression.size() && IsNameChar(m_Expression[m_Pos]))
+    {
+      ++m_Pos;
+    }
+    const std::string name = m_Expression.substr(start, m_Pos - start);
+
+    if (Peek("("))
+    {
+      return ParseFunction(name);
+    }
+
+    std::map<std::string, unsigned int>::const_iterator var = m_Variables.find(name);
+    if (var != m_Variables.end())
+    {
+      return NewVariable(var->second);
+    }
+
+    ValueType value;
+    if (GetConstant(name, value))
+    {
+      return NewConstant(value);
+    }
+    return Fail();
+  }
+
+  bool GetConstant(const std::string& name, ValueType& value) const
+  {
+    // Constants defined by otb::Parser, otb::ParserX and the parser libraries
+    if (name == "log2e")
+      value = CONST_LOG2E;
+    else if (name == "log10e")
+      value = CONST_LOG10E;
+    else if (name == "ln2")
+      value = CONST_LN2;
+    else if (name == "ln10")
+      value = CONST_LN10;
+    else if (name == "euler")
+      value = CONST_EULER;
+    else if (name == "e" || (m_Dialect == MuParser && name == "_e"))
+      value = CONST_E;
+    else if (name == "pi" || (m_Dialect == MuParser && name == "_pi"))
+      value = CONST_PI;
+    else
+      return false;
+    return true;
+  }
+
+  int ParseFunction(const std::string& name)
+  {
+    Accept("(");
+    std::vector<int> args;
+    if (!Accept(")"))
+    {
+      do
+      {
+        args.push_back(ParseTernary());
+        if (m_Failed)
+        {
+          return -1;
+        }
+      } while (Accept(","));
+      if (!Accept(")"))
+      {
+        return Fail();
+      }
+    }
+
+    static const struct
+    {
+      const char* name;
+      OpCode      op;
+    } unaryFunctions[] = {{"sin", Sin},   {"cos", Cos},   {"tan", Tan}, {"asin", Asin}, {"acos", Acos},   {"atan", Atan}, {"sinh", Sinh},
+                          {"cosh", Cosh}, {"tanh", Tanh}, {"exp", Exp}, {"ln", Ln},     {"log10", Log10}, {"sqrt", Sqrt}, {"abs", Abs}};
+
+    for (const auto& f : unaryFunctions)
+    {
+      if (name == f.name)
+      {
+        return args.size() == 1 ? NewOperation(f.op, args[0]) : Fail();
+      }
+    }
+
+    if (name == "ndvi" || (m_Dialect == MuParser && name == "NDVI"))
+    {
+      return args.size() == 2 ? NewOperation(Ndvi, args[0], args[1]) : Fail();
+    }
+
+    if (m_Dialect != MuParser || args.empty())
+    {
+      return Fail();
+    }
+
+    // Functions of muParser and otb::Parser
+    if (name == "log2" || name == "sign" || name == "rint")
+    {
+      if (args.size() != 1)
+        return Fail();
+      return NewOperation(name == "log2" ? Log2 : (name == "sign" ? Sign : Rint), args[0]);
+    }
+    if (name == "atan2")
+    {
+      return args.size() == 2 ? NewOperation(Atan2, args[0], args[1]) : Fail();
+    }
+    if (name == "min" || name == "max" || name == "sum" || name == "avg")
+    {
+      // Variadic functions are evaluated from left to right, as in muParser
+      const OpCode op     = name == "min" ? Min : (name == "max" ? Max : Add);
+      int          result = args[0];
+      for (std::size_t i = 1; i < args.size(); ++i)
+      {
+        result = NewOperation(op, result, args[i]);
+      }
+      if (name == "avg")
+      {
+        result = NewOperation(Div, result, NewConstant(static_cast<ValueType>(args.size())));
+      }
+      return result;
+    }
+    return Fail();
+  }
+
+  TmpOperand Lower(int nodeId)
+  {
+    const Node& node = m_Nodes[nodeId];
+    TmpOperand  operand;
+    if (node.kind == Node::Variable)
+    {
+      operand.kind  = TmpOperand::Variable;
+      operand.index = node.variable;
+      return operand;
+    }
+    if (node.kind == Node::Constant)
+    {
+      return ConstantOperand(node.value);
+    }
+
+    std::vector<TmpOperand> args;
+    bool                    allConstants = true;
+    for (int child : node.children)
+    {
+      args.push_back(Lower(child));
+      allConstants = allConstants && args.back().kind == TmpOperand::Constant;
+    }
+
+    if (allConstants)
+    {
+      ValueType values[3] = {0., 0., 0.};
+      for (std::size_t i = 0; i < args.size(); ++i)
+      {
+        values[i] = m_Constants[args[i].index];
+      }
+      return ConstantOperand(ExpressionKernel::Apply(node.op, values[0], values[1], values[2]));
+    }
+
+    TmpInstruction instruction;
+    instruction.op   = node.op;
+    instruction.args = args;
+    m_Program.push_back(instruction);
+
+    operand.kind  = TmpOperand::Instruction;
+    operand.index = static_cast<unsigned int>(m_Program.size()) - 1;
+    return operand;
+  }
+
+  TmpOperand ConstantOperand(ValueType value)
+  {
+    TmpOperand operand;
+    operand.kind = TmpOperand::Constant;
+    for (std::size_t i = 0; i < m_Constants.size(); ++i)
+    {
+      if (std::memcmp(&m_Constants[i], &value, sizeof(ValueType)) == 0)
+      {
+        operand.index = static_cast<unsigned int>(i);
+        return operand;
+      }
+    }
+    m_Constants.push_back(value);
+    operand.index = static_cast<unsigned int>(m_Constants.size()) - 1;
+    return operand;
+  }
+
+  /** Map constants to the first registers, and instruction results to the
+   *  following ones, reusing the register of a result after its last use */
+  void AllocateRegisters(ExpressionKernel& kernel, const TmpOperand& result)
+  {
+    const unsigned int nbConstants = static_cast<unsigned int>(m_Constants.size());
+    const unsigned int nbInstr     = static_cast<unsigned int>(m_Program.size());
+
+    // last instruction reading each instruction result
+    std::vector<unsigned int> lastUse(nbInstr, 0);
+    for (unsigned int i = 0; i < nbInstr; ++i)
+    {
+      for (const TmpOperand& arg : m_Program[i].args)
+      {
+        if (arg.kind == TmpOperand::Instruction)
+          lastUse[arg.index] = i;
+      }
+    }
+
+    std::vector<unsigned int> registerOf(nbInstr, 0);
+    std::vector<unsigned int> freeRegisters;
+    unsigned int              nbRegisters = nbConstants;
+
+    kernel.m_Program.clear();
+    for (unsigned int i = 0; i < nbInstr; ++i)
+    {
+      Instruction instruction;
+      instruction.op    = m_Program[i].op;
+      instruction.arity = static_cast<unsigned int>(m_Program[i].args.size());
+
+      for (unsigned int a = 0; a < instruction.arity; ++a)
+      {
+        const TmpOperand& arg = m_Program[i].args[a];
+        instruction.args[a]   = ToOperand(arg, registerOf);
+      }
+      // Release the registers read for the last time (element-wise
+      // instructions may write in one of their inputs)
+      for (unsigned int a = 0; a < instruction.arity; ++a)
+      {
+        const TmpOperand& arg = m_Program[i].args[a];
+        if (arg.kind == TmpOperand::Instruction && lastUse[arg.index] == i &&
+            std::find(freeRegisters.begin(), freeRegisters.end(), registerOf[arg.index]) == freeRegisters.end())
+        {
+          freeRegisters.push_back(registerOf[arg.index]);
+        }
+      }
+
+      if (!freeRegisters.empty())
+      {
+        registerOf[i] = freeRegisters.back();
+        freeRegisters.pop_back();
+      }
+      else
+      {
+        registerOf[i] = nbRegisters++;
+      }
+      instruction.destination = registerOf[i];
+      kernel.m_Program.push_back(instruction);
+    }
+
+    kernel.m_Constants         = m_Constants;
+    kernel.m_NumberOfRegisters = nbRegisters;
+    kernel.m_Result            = ToOperand(result, registerOf);
+  }
+
+  static Operand ToOperand(const TmpOperand& tmp, const std::vector<unsigned int>& registerOf)
+  {
+    // Constants already have their register index
+    Operand operand;
+    operand.isVariable = tmp.kind == TmpOperand::Variable;
+    operand.index      = tmp.kind == TmpOperand::Instruction ? registerOf[tmp.index] : tmp.index;
+    return operand;
+  }
+
+  const std::string&                  m_Expression;
+  std::size_t                         m_Pos;
+  bool                                m_Failed;
+  Dialect                             m_Dialect;
+  std::map<std::string, unsigned int> m_Variables;
+  std::vector<Node>                   m_Nodes;
+  std::vector<TmpInstruction>         m_Program;
+  std::vector<ValueType>              m_Constants;
+};
+
+
+ExpressionKernel::ExpressionKernel() : m_NumberOfRegisters(0), m_Compiled(false), m_CompileId(0)
+{
+  m_Result.isVariable = false;
+  m_Result.index      = 0;
+}
+
+void ExpressionKernel::Clear()
+{
+  m_Program.clear();
+  m_Constants.clear();
+  m_NumberOfRegisters = 0;
+  m_Result.isVariable = false;
+  m_Result.index      = 0;
+  m_Compiled          = false;
+  m_CompileId         = 0;
+}
+
+bool ExpressionKernel::Compile(const std::string& expression, const std::vector<std::string>& variableNames, Dialect dialect)
+{
+  Clear();
+
+  Compiler compiler(expression, variableNames, dialect);
+  if (!compiler.Run(*this))
+  {
+    Clear();
+    return false;
+  }
+  m_Compiled  = true;
+  m_CompileId = NextCompileId();
+  return true;
+}
+
+ExpressionKernel::ValueType ExpressionKernel::Apply(OpCode op, ValueType a, ValueType b, ValueType c)
+{
+  switch (op)
+  {
+  case Neg:
+    return -a;
+  case Add:
+    return a + b;
+  case Sub:
+    return a - b;
+  case Mul:
+    return a * b;
+  case Div:
+    return a / b;
+  case Pow:
+    return std::pow(a, b);
+  case Lt:
+    return a < b;
+  case Gt:
+    return a > b;
+  case Le:
+    return a <= b;
+  case Ge:
+    return a >= b;
+  case Eq:
+    return a == b;
+  case Ne:
+    return a != b;
+  case And:
+    return (a != 0) && (b != 0);
+  case Or:
+    return (a != 0) || (b != 0);
+  case Select:
+    return (a != 0) ? b : c;
+  case Sin:
+    return std::sin(a);
+  case Cos:
+    return std::cos(a);
+  case Tan:
+    return std::tan(a);
+  case Asin:
+    return std::asin(a);
+  case Acos:
+    return std::acos(a);
+  case Atan:
+    return std::atan(a);
+  case Sinh:
+    return std::sinh(a);
+  case Cosh:
+    return std::cosh(a);
+  case Tanh:
+    return std::tanh(a);
+  case Exp:
+    return std::exp(a);
+  case Ln:
+    return std::log(a);
+  case Log2:
+    return std::log(a) / std::log(2.);
+  case Log10:
+    return std::log10(a);
+  case Sqrt:
+    return std::sqrt(a);
+  case Abs:
+    return std::abs(a);
+  case Sign:
+    return SignOf(a);
+  case Rint:
+    return RintOf(a);
+  case Min:
+    return MinOf(a, b);
+  case Max:
+    return MaxOf(a, b);
+  case Ndvi:
+    return NdviOf(a, b);
+  case Atan2:
+    return std::atan2(a, b);
+  }
+  return 0.;
+}
+
+void ExpressionKernel::InitializeWorkspace(Workspace& workspace) const
+{
+  workspace.m_Registers.assign(m_NumberOfRegisters * ChunkSize, 0.);
+  for (std::size_t c = 0; c < m_Constants.size(); ++c)
+  {
+    std::fill(workspace.m_Registers.begin() + c * ChunkSize, workspace.m_Registers.begin() + (c + 1) * ChunkSize, m_Constants[c]);
+  }
+  workspace.m_Owner     = this;
+  workspace.m_CompileId = m_CompileId;
+}
+
+void ExpressionKernel::Evaluate(const ValueType* const* variables, std::size_t count, ValueType* result, Workspace& workspace) const
+{
+  if (workspace.m_Owner != this || workspace.m_CompileId != m_CompileId)
+  {
+    InitializeWorkspace(workspace);
+  }
+  ValueType* registers = workspace.m_Registers.data();
+
+  for (std::size_t start = 0; start < count; start += ChunkSize)
+  {
+    const std::size_t n = std::min(ChunkSize, count - start);
+
+    auto pointer = [&](const Operand& operand) -> const ValueType* {
+      return operand.isVariable ? variables[operand.index] + start : registers + operand.index * ChunkSize;
+    };
+
+    for (const Instruction& instruction : m_Program)
+    {
+      ValueType*       d = registers + instruction.destination * ChunkSize;
+      const ValueType* a = pointer(instruction.args[0]);
+      const ValueType* b = instruction.arity > 1 ? pointer(instruction.args[1]) : nullptr;
+
+      switch (instruction.op)
+      {
+      case Neg:
+        Map1(d, a, n, [](ValueType x) { return -x; });
+        break;
+      case Add:
+        Map2(d, a, b, n, [](ValueType x, ValueType y) { return x + y; });
+        break;
+      case Sub:
+        Map2(d, a, b, n, [](ValueType x, ValueType y) { return x - y; });
+        break;
+      case Mul:
+        Map2(d, a, b, n, [](ValueType x, ValueType y) { return x * y; });
+        break;
+      case Div:
+        Map2(d, a, b, n, [](ValueType x, ValueType y) { return x / y; });
+        break;
+      case Min:
+        Map2(d, a, b, n, MinOf);
+        break;
+      case Max:
+        Map2(d, a, b, n, MaxOf);
+        break;
+      case Ndvi:
+        Map2(d, a, b, n, NdviOf);
+        break;
+      case Pow:
+        Map2(d, a, b, n, [](ValueType x, ValueType y) { return std::pow(x, y); });
+        break;
+      case Lt:
+        Map2(d, a, b, n, [](ValueType x, ValueType y) -> ValueType { return x < y; });
+        break;
+      case Gt:
+        Map2(d, a, b, n, [](ValueType x, ValueType y) -> ValueType { return x > y; });
+        break;
+      case Le:
+        Map2(d, a, b, n, [](ValueType x, ValueType y) -> ValueType { return x <= y; });
+        break;
+      case Ge:
+        Map2(d, a, b, n, [](ValueType x, ValueType y) -> ValueType { return x >= y; });
+        break;
+      case Sqrt:
+        Map1(d, a, n, [](ValueType x) { return std::sqrt(x); });
+        break;
+      case Abs:
+        Map1(d, a, n, [](ValueType x) { return std::abs(x); });
+        break;
+      case Select:
+      {
+        const ValueType* c = pointer(instruction.args[2]);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          d[i] = (a[i] != 0) ? b[i] : c[i];
+        }
+        break;
+      }
+      default:
+        // Other instructions use the scalar implementation
+        if (instruction.arity == 1)
+          Map1(d, a, n, [&instruction](ValueType x) { return Apply(instruction.op, x, 0., 0.); });
+        else
+          Map2(d, a, b, n, [&instruction](ValueType x, ValueType y) { return Apply(instruction.op, x, y, 0.); });
+        break;
+      }
+    }
+
+    const ValueType* r = pointer(m_Result);
+    std::copy(r, r + n, result + start);
+  }
+}
+
+} // end namespace otb
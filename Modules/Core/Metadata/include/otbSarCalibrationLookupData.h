@@ -20,6 +20,7 @@
 
 #ifndef SarCalibrationLookupData_H
 #define SarCalibrationLookupData_H 1
+#include <cstddef>
 #include <string>
 #include <itkLightObject.h>
 #include <itkNumericTraits.h>
@@ -69,6 +70,18 @@ public:
     return 1.0;
   }
 
+  /** Fill values with the lookup values of the pixels (x, y) to
+   * (x + length - 1, y) of a line. The values are exactly the ones of
+   * GetValue(). Sub-classes can override this method to share the lookup
+   * work between the pixels of the line. */
+  virtual void GetLineValues(const IndexValueType x, const IndexValueType y, const std::size_t length, double* values) const
+  {
+    for (std::size_t i = 0; i < length; ++i)
+    {
+      values[i] = this->GetValue(x + static_cast<IndexValueType>(i), y);
+    }
+  }
+
   void SetType(short t)
   {
     m_Type = t;
@@ -22,6 +22,7 @@
 #define otbSentinel1ImageMetadataInterface_h
 
 #include "otbSarImageMetadataInterface.h"
+#include <algorithm>
 
 
 namespace otb
@@ -181,16 +182,56 @@ public:
     return lutVal;
   }
 
-  int GetVectorIndex(int y) const
+  /** Same values as GetValue(), but the calibration vectors and the row
+   * interpolation weight are looked up once for the whole line, and the
+   * pixel knots are walked incrementally instead of being searched for each
+   * pixel. */
+  void GetLineValues(const IndexValueType x, const IndexValueType y, const std::size_t length, double* values) const override
   {
-    for (int i = 1; i < count; i++)
+    if (length == 0)
+    {
+      return;
+    }
+
+    const int calVecIdx = GetVectorIndex(y);
+    assert(calVecIdx >= 0 && calVecIdx < count - 1);
+    const Sentinel1CalibrationStruct& vec0   = calibrationVectorList[calVecIdx];
+    const Sentinel1CalibrationStruct& vec1   = calibrationVectorList[calVecIdx + 1];
+    const double                      azTime = firstLineTime + y * lineTimeInterval;
+    const double                      muY    = (azTime - vec0.timeMJD) / vec1.deltaMJD;
+
+    // Position of the first knot after the current pixel, as returned by
+    // std::upper_bound in GetPixelIndex()
+    const int size       = vec0.pixels.size();
+    int       upperBound = std::distance(vec0.pixels.begin(), std::upper_bound(vec0.pixels.begin(), vec0.pixels.end(), x));
+
+    for (std::size_t i = 0; i < length; ++i)
     {
-      if (y < calibrationVectorList[i].line)
+      const IndexValueType currentX = x + static_cast<IndexValueType>(i);
+      while (upperBound < size && vec0.pixels[upperBound] <= currentX)
       {
-        return i - 1;
+        ++upperBound;
       }
+      const int    pixelIdx = upperBound == size ? size - 2 : upperBound - 1;
+      const double muX      = (currentX - vec0.pixels[pixelIdx]) / vec0.deltaPixels[pixelIdx + 1];
+      values[i] =
+          (1 - muY) * ((1 - muX) * vec0.vect[pixelIdx] + muX * vec0.vect[pixelIdx + 1]) + muY * ((1 - muX) * vec1.vect[pixelIdx] + muX * vec1.vect[pixelIdx + 1]);
+    }
+  }
+
+  /** Index of the calibration vector preceding line y, -1 if there is none */
+  int GetVectorIndex(int y) const
+  {
+    if (count < 2)
+    {
+      return -1;
     }
-    return -1;
+    // Calibration vectors are sorted by line
+    std::vector<Sentinel1CalibrationStruct>::const_iterator first = calibrationVectorList.begin() + 1;
+    std::vector<Sentinel1CalibrationStruct>::const_iterator last  = calibrationVectorList.begin() + count;
+    std::vector<Sentinel1CalibrationStruct>::const_iterator wh =
+        std::upper_bound(first, last, y, [](int line, const Sentinel1CalibrationStruct& v) { return line < v.line; });
+    return wh == last ? -1 : std::distance(calibrationVectorList.begin(), wh) - 1;
   }
 
   int GetPixelIndex(int x, const Sentinel1CalibrationStruct& calVec) const
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbCompensatedAccumulators_h
+#define otbCompensatedAccumulators_h
+
+#include <cmath>
+
+namespace otb
+{
+
+/** \class KahanSum
+ *  \brief Compensated summation of floating point values.
+ *
+ *  This accumulator keeps track of the rounding error of each addition
+ *  (Kahan-Babuska-Neumaier algorithm), so that the error of the sum does not
+ *  grow with the number of values. Partial sums computed by different threads
+ *  or on different streamed regions can be combined with Merge().
+ *
+ * \ingroup OTBStreaming
+ */
+template <class TReal>
+class KahanSum
+{
+public:
+  typedef TReal RealType;
+
+  KahanSum() : m_Sum(0), m_Compensation(0)
+  {
+  }
+
+  void Add(RealType value)
+  {
+    const RealType t = m_Sum + value;
+    if (std::abs(m_Sum) >= std::abs(value))
+    {
+      m_Compensation += (m_Sum - t) + value;
+    }
+    else
+    {
+      m_Compensation += (value - t) + m_Sum;
+    }
+    m_Sum = t;
+  }
+
+  void Merge(const KahanSum& other)
+  {
+    Add(other.m_Sum);
+    m_Compensation += other.m_Compensation;
+  }
+
+  RealType GetSum() const
+  {
+    return m_Sum + m_Compensation;
+  }
+
+private:
+  RealType m_Sum;
+  RealType m_Compensation;
+};
+
+/** \class MomentsAccumulator
+ *  \brief Numerically stable accumulation of the first moments of a set of values.
+ *
+ *  The values are accumulated as sums of their deviations from a shift, the
+ *  first value added (shifted data algorithm). As long as the shift is close
+ *  to the mean, the sum of squared deviations keeps its precision, whereas
+ *  the difference between the sum of squares and the squared sum loses it
+ *  when the variance is small compared to the mean. Unlike Welford's
+ *  algorithm, no division is needed per value. Partial accumulators are
+ *  combined with the parallel formula of Chan et al. in Merge(), the result
+ *  being shifted by the merged mean. The sum of the values is kept with a
+ *  compensated summation (see KahanSum).
+ *
+ * \ingroup OTBStreaming
+ */
+template <class TReal>
+class MomentsAccumulator
+{
+public:
+  typedef TReal RealType;
+
+  MomentsAccumulator() : m_Count(0), m_Shift(0), m_ShiftedSum(0), m_ShiftedSquaredSum(0)
+  {
+  }
+
+  void Add(RealType value)
+  {
+    if (m_Count == 0)
+    {
+      m_Shift = value;
+    }
+    ++m_Count;
+    const RealType deviation = value - m_Shift;
+    m_ShiftedSum += deviation;
+    m_ShiftedSquaredSum += deviation * deviation;
+    m_Sum.Add(value);
+  }
+
+  void Merge(const MomentsAccumulator& other)
+  {
+    if (other.m_Count == 0)
+    {
+      return;
+    }
+    if (m_Count == 0)
+    {
+      *this = other;
+      return;
+    }
+
+    const RealType n1    = static_cast<RealType>(m_Count);
+    const RealType n2    = static_cast<RealType>(other.m_Count);
+    const RealType n     = n1 + n2;
+    const RealType mean1 = m_Shift + m_ShiftedSum / n1;
+    const RealType delta = other.m_Shift + other.m_ShiftedSum / n2 - mean1;
+
+    m_ShiftedSquaredSum = GetSquaredDeviationSum() + other.GetSquaredDeviationSum() + delta * delta * n1 * n2 / n;
+    m_Shift             = mean1 + delta * n2 / n;
+    m_ShiftedSum        = 0;
+    m_Count += other.m_Count;
+    m_Sum.Merge(other.m_Sum);
+  }
+
+  unsigned long GetCount() const
+  {
+    return m_Count;
+  }
+
+  RealType GetSum() const
+  {
+    return m_Sum.GetSum();
+  }
+
+  /** Mean of the values, from the compensated sum */
+  RealType GetMean() const
+  {
+    return m_Count > 0 ? GetSum() / static_cast<RealType>(m_Count) : RealType(0);
+  }
+
+  /** Unbiased estimate of the variance (0 with less than 2 values) */
+  RealType GetVariance() const
+  {
+    return m_Count > 1 ? GetSquaredDeviationSum() / static_cast<RealType>(m_Count - 1) : RealType(0);
+  }
+
+  /** Variance of the accumulated values (0 without values) */
+  RealType GetPopulationVariance() const
+  {
+    return m_Count > 0 ? GetSquaredDeviationSum() / static_cast<RealType>(m_Count) : RealType(0);
+  }
+
+private:
+  /** Sum of the squared deviations from the mean */
+  RealType GetSquaredDeviationSum() const
+  {
+    if (m_Count == 0)
+    {
+      return RealType(0);
+    }
+    const RealType m2 = m_ShiftedSquaredSum - m_ShiftedSum * m_ShiftedSum / static_cast<RealType>(m_Count);
+    return m2 > 0 ? m2 : RealType(0);
+  }
+
+  unsigned long   m_Count;
+  RealType        m_Shift;
+  RealType        m_ShiftedSum;
+  RealType        m_ShiftedSquaredSum;
+  KahanSum<TReal> m_Sum;
+};
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbPerThreadAccumulator_h
+#define otbPerThreadAccumulator_h
+
+#include "itkIntTypes.h"
+#include <vector>
+
+namespace otb
+{
+
+/** \class PerThreadAccumulator
+ *  \brief Storage of one accumulator per thread for persistent filters.
+ *
+ *  Persistent filters accumulate partial results in ThreadedGenerateData(),
+ *  one accumulator per thread, and merge them in Synthetize(). When these
+ *  accumulators are stored side by side (e.g. in an itk::Array), threads
+ *  writing their own accumulator keep invalidating the cache line of their
+ *  neighbours (false sharing), which prevents scaling with many threads.
+ *
+ *  This class stores each accumulator in its own cache line(s), and merges
+ *  them with a pairwise (tree) reduction: accumulator i is merged with
+ *  accumulator i + 1, i + 2 with i + 3 and so on, then the results are
+ *  merged two by two again. For sums, this bounds the rounding error growth
+ *  to O(log(n)) instead of O(n) for a sequential merge.
+ *
+ *  The accumulator type must be copyable. The merge operation is given to
+ *  Reduce() as a functor called as merge(TValue& into, const TValue& other).
+ *
+ *  Typical use in a persistent filter:
+ *  \code
+ *  void Reset()       { m_Accumulators.Reset(this->GetNumberOfThreads(), AccumulatorType()); }
+ *  void ThreadedGenerateData(...) { AccumulatorType& acc = m_Accumulators[threadId]; ... }
+ *  void Synthetize()  { AccumulatorType total = m_Accumulators.Reduce(MergeFunctor()); ... }
+ *  \endcode
+ *
+ *  \sa PersistentImageFilter
+ *
+ * \ingroup OTBStreaming
+ */
+template <class TValue>
+class PerThreadAccumulator
+{
+public:
+  typedef TValue ValueType;
+
+  /** Size of the cache lines the accumulators are separated by */
+  static const unsigned int CacheLineSize = 64;
+
+  PerThreadAccumulator()
+  {
+  }
+
+  /** Allocate one accumulator per thread, initialized to the given value */
+  void Reset(itk::ThreadIdType numberOfThreads, const ValueType& initialValue)
+  {
+    m_Slots.assign(numberOfThreads, Slot(initialValue));
+  }
+
+  /** Set all the accumulators to the given value */
+  void Fill(const ValueType& value)
+  {
+    for (auto& slot : m_Slots)
+    {
+      slot.value = value;
+    }
+  }
+
+  itk::ThreadIdType Size() const
+  {
+    return static_cast<itk::ThreadIdType>(m_Slots.size());
+  }
+
+  ValueType& operator[](itk::ThreadIdType threadId)
+  {
+    return m_Slots[threadId].value;
+  }
+
+  const ValueType& operator[](itk::ThreadIdType threadId) const
+  {
+    return m_Slots[threadId].value;
+  }
+
+  /** Merge all the accumulators with a pairwise reduction. The stored
+   * accumulators are not modified. Returns the initial value if there are
+   * no accumulators. */
+  template <class TMerge>
+  ValueType Reduce(TMerge merge, const ValueType& initialValue = ValueType()) const
+  {
+    const std::size_t n = m_Slots.size();
+    if (n == 0)
+    {
+      return initialValue;
+    }
+
+    std::vector<ValueType> values;
+    values.reserve(n);
+    for (const auto& slot : m_Slots)
+    {
+      values.push_back(slot.value);
+    }
+
+    for (std::size_t stride = 1; stride < n; stride *= 2)
+    {
+      for (std::size_t i = 0; i + stride < n; i += 2 * stride)
+      {
+        merge(values[i], values[i + stride]);
+      }
+    }
+    return values[0];
+  }
+
+private:
+  /** An accumulator followed by a full cache line of padding, so that the
+   * data of two accumulators never share a cache line, whatever the
+   * alignment provided by the allocator. */
+  struct Slot
+  {
+    explicit Slot(const ValueType& v) : value(v)
+    {
+    }
+
+    ValueType value;
+    char      padding[CacheLineSize];
+  };
+
+  std::vector<Slot> m_Slots;
+};
+
+} // end namespace otb
+
+#endif
@@ -68,6 +68,12 @@ void RAMDrivenAdaptativeStreamingManager<TImage>::PrepareStreaming(itk::DataObje
   this->m_Region = region;
 }
 
+template <class TImage>
+typename RAMDrivenAdaptativeStreamingManager<TImage>::Superclass::MemoryPrintType RAMDrivenAdaptativeStreamingManager<TImage>::GetAvailableRAMInBytes()
+{
+  return this->GetActualAvailableRAMInBytes(m_AvailableRAMInMB);
+}
+
 } // End namespace otb
 
 #endif
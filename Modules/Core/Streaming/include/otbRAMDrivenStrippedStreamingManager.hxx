@@ -47,6 +47,12 @@ void RAMDrivenStrippedStreamingManager<TImage>::PrepareStreaming(itk::DataObject
   this->m_Region                 = region;
 }
 
+template <class TImage>
+typename RAMDrivenStrippedStreamingManager<TImage>::Superclass::MemoryPrintType RAMDrivenStrippedStreamingManager<TImage>::GetAvailableRAMInBytes()
+{
+  return this->GetActualAvailableRAMInBytes(m_AvailableRAMInMB);
+}
+
 } // End namespace otb
 
 #endif
@@ -79,6 +79,9 @@ public:
    * eventually using the input parameter to estimate memory consumption */
   void PrepareStreaming(itk::DataObject* input, const RegionType& region) override;
 
+  /** Returns the RAM budget in Bytes, resolved from AvailableRAMInMB */
+  typename Superclass::MemoryPrintType GetAvailableRAMInBytes() override;
+
 protected:
   RAMDrivenTiledStreamingManager();
   ~RAMDrivenTiledStreamingManager() override;
@@ -48,6 +48,12 @@ void RAMDrivenTiledStreamingManager<TImage>::PrepareStreaming(itk::DataObject* i
   otbMsgDevMacro(<< "Number of split : " << this->m_ComputedNumberOfSplits) this->m_Region = region;
 }
 
+template <class TImage>
+typename RAMDrivenTiledStreamingManager<TImage>::Superclass::MemoryPrintType RAMDrivenTiledStreamingManager<TImage>::GetAvailableRAMInBytes()
+{
+  return this->GetActualAvailableRAMInBytes(m_AvailableRAMInMB);
+}
+
 } // End namespace otb
 
 #endif
@@ -94,6 +94,11 @@ public:
   itkSetMacro(DefaultRAM, MemoryPrintType);
   itkGetMacro(DefaultRAM, MemoryPrintType);
 
+  /** Returns the RAM budget in Bytes used by this streaming manager.
+   * Streaming managers which are not RAM driven report the default
+   * value (m_DefaultRAM or the configuration settings) */
+  virtual MemoryPrintType GetAvailableRAMInBytes();
+
 protected:
   StreamingManager();
   ~StreamingManager() override;
@@ -110,15 +115,15 @@ protected:
   typedef typename AbstractSplitterType::Pointer AbstractSplitterPointerType;
   AbstractSplitterPointerType                    m_Splitter;
 
-private:
-  StreamingManager(const StreamingManager&) = delete;
-  void operator=(const StreamingManager&) = delete;
-
   /** Compute the available RAM in Bytes from an input value in MByte.
    *  If the input value is 0, it uses the m_DefaultRAM value.
    *  If m_DefaultRAM is also 0, it uses the configuration settings */
   MemoryPrintType GetActualAvailableRAMInBytes(MemoryPrintType availableRAMInMB);
 
+private:
+  StreamingManager(const StreamingManager&) = delete;
+  void operator=(const StreamingManager&) = delete;
+
   /** Default available RAM in MB */
   MemoryPrintType m_DefaultRAM;
 };
@@ -64,6 +64,12 @@ typename StreamingManager<TImage>::MemoryPrintType StreamingManager<TImage>::Get
   return availableRAMInBytes;
 }
 
+template <class TImage>
+typename StreamingManager<TImage>::MemoryPrintType StreamingManager<TImage>::GetAvailableRAMInBytes()
+{
+  return GetActualAvailableRAMInBytes(0);
+}
+
 template <class TImage>
 unsigned int StreamingManager<TImage>::EstimateOptimalNumberOfDivisions(itk::DataObject* input, const RegionType& region, MemoryPrintType availableRAM,
                                                                         double bias)
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbPerThreadAccumulator.h"
+#include "otbCompensatedAccumulators.h"
+#include <iostream>
+#include <cstdlib>
+
+int otbPerThreadAccumulatorTest(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  typedef otb::MomentsAccumulator<double> MomentsType;
+
+  // Values with a large offset: the naive sum of squares loses all the
+  // precision on the variance
+  const double       offset   = 1e9;
+  const unsigned int nbValues = 100000;
+
+  // Distribute the values over an odd number of accumulators
+  otb::PerThreadAccumulator<MomentsType> accumulators;
+  accumulators.Reset(7, MomentsType());
+
+  MomentsType sequential;
+  double      naiveSum = 0., naiveSumOfSquares = 0.;
+  for (unsigned int i = 0; i < nbValues; ++i)
+  {
+    const double value = offset + (i % 10);
+    accumulators[i % accumulators.Size()].Add(value);
+    sequential.Add(value);
+    naiveSum += value;
+    naiveSumOfSquares += value * value;
+  }
+
+  const MomentsType total = accumulators.Reduce([](MomentsType& a, const MomentsType& b) { a.Merge(b); });
+
+  // Values are 0..9 repeated, plus the offset
+  const double expectedMean     = offset + 4.5;
+  const double expectedVariance = 8.25 * nbValues / (nbValues - 1);
+  const double naiveVariance    = (naiveSumOfSquares - naiveSum * naiveSum / nbValues) / (nbValues - 1);
+
+  std::cout << "Count: " << total.GetCount() << std::endl;
+  std::cout.precision(17);
+  std::cout << "Mean: " << total.GetMean() << " (expected " << expectedMean << ")" << std::endl;
+  std::cout << "Variance: " << total.GetVariance() << " (expected " << expectedVariance << ", naive " << naiveVariance << ")" << std::endl;
+  std::cout << "Sum: " << total.GetSum() << std::endl;
+
+  if (total.GetCount() != nbValues)
+  {
+    std::cerr << "Wrong number of values" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (std::abs(total.GetMean() - expectedMean) > 1e-6 || std::abs(total.GetVariance() - expectedVariance) > 1e-6)
+  {
+    std::cerr << "Merged moments are not accurate" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (std::abs(total.GetVariance() - sequential.GetVariance()) > 1e-6)
+  {
+    std::cerr << "Merged moments differ from the sequential ones" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (total.GetSum() != offset * nbValues + 4.5 * nbValues)
+  {
+    std::cerr << "Compensated sum is not exact" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Compensated summation of values that a naive sum drops
+  otb::KahanSum<double> kahan;
+  double                naive = 1.;
+  kahan.Add(1.);
+  for (unsigned int i = 0; i < 1000; ++i)
+  {
+    kahan.Add(1e-16);
+    naive += 1e-16;
+  }
+  std::cout << "Compensated sum: " << kahan.GetSum() << " (naive " << naive << ")" << std::endl;
+  if (std::abs(kahan.GetSum() - (1. + 1e-13)) > 1e-16)
+  {
+    std::cerr << "Compensated sum is not accurate" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Pairwise reduction of an empty and of a single accumulator
+  otb::PerThreadAccumulator<int> counts;
+  auto                           add = [](int& a, const int& b) { a += b; };
+  if (counts.Reduce(add, -1) != -1)
+  {
+    std::cerr << "Reduction of no accumulator should return the initial value" << std::endl;
+    return EXIT_FAILURE;
+  }
+  counts.Reset(1, 3);
+  if (counts.Reduce(add) != 3)
+  {
+    std::cerr << "Reduction of a single accumulator should return it" << std::endl;
+    return EXIT_FAILURE;
+  }
+  counts.Reset(13, 0);
+  for (itk::ThreadIdType t = 0; t < counts.Size(); ++t)
+  {
+    counts[t] = t;
+  }
+  if (counts.Reduce(add) != 78)
+  {
+    std::cerr << "Reduction should merge all the accumulators" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
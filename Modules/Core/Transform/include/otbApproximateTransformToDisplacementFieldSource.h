@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbApproximateTransformToDisplacementFieldSource_h
+#define otbApproximateTransformToDisplacementFieldSource_h
+
+#include "itkTransformToDisplacementFieldSource.h"
+#include <vector>
+
+namespace otb
+{
+
+/** \class ApproximateTransformToDisplacementFieldSource
+ * \brief Generate a displacement field from a transform, evaluating the
+ * transform exactly only where it is needed to honour an error bound.
+ *
+ * This filter acts like the itk::TransformToDisplacementFieldSource, but
+ * when a positive maximum error is set with SetMaximumError(), the output
+ * region of each thread is cut into blocks of at most BlockSize pixels per
+ * dimension. For each block, the transform is evaluated at the four corners
+ * and at five check points (the middle of each edge and the center). If the
+ * bilinear interpolation of the corners predicts the check points within
+ * the maximum error, the whole block is filled by bilinear interpolation.
+ * Otherwise, the block is split in four and the process is repeated, down
+ * to blocks of 2x2 pixels which are evaluated exactly.
+ *
+ * This is the same strategy as the approximate transformer of GDAL. It is
+ * very effective with sensor models, whose TransformPoint() is expensive
+ * but smooth at the scale of a few displacement field pixels.
+ *
+ * The maximum error is expressed in the physical units of the transformed
+ * points (i.e. of the displacement vectors). The largest deviation actually
+ * measured at the check points of the interpolated blocks is available
+ * through GetMaximumApproximationError() after the filter has run. Since
+ * the deviation is only measured at check points, this is an estimate of
+ * the achieved error.
+ *
+ * With a maximum error of 0 (the default), the behaviour is exactly the one
+ * of the itk::TransformToDisplacementFieldSource. Linear transforms and non
+ * 2D fields also use the exact code path.
+ *
+ * \sa itk::TransformToDisplacementFieldSource
+ *
+ * \ingroup Threaded
+ *
+ * \ingroup OTBTransform
+ */
+template <class TOutputImage, class TTransformPrecisionType = double>
+class ITK_EXPORT ApproximateTransformToDisplacementFieldSource : public itk::TransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ApproximateTransformToDisplacementFieldSource Self;
+  typedef itk::TransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType> Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ApproximateTransformToDisplacementFieldSource, itk::TransformToDisplacementFieldSource);
+
+  /** Number of dimensions. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  /** Superclass typedefs */
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename Superclass::TransformType         TransformType;
+  typedef typename Superclass::PixelType             PixelType;
+  typedef typename Superclass::PixelValueType        PixelValueType;
+  typedef typename Superclass::RegionType            RegionType;
+  typedef typename Superclass::SizeType              SizeType;
+  typedef typename Superclass::IndexType             IndexType;
+  typedef typename Superclass::PointType             PointType;
+  typedef typename Superclass::SpacingType           SpacingType;
+  typedef typename Superclass::OriginType            OriginType;
+  typedef typename Superclass::DirectionType         DirectionType;
+
+  /** Maximum error allowed when interpolating the transform, in physical
+   * units of the transformed points. 0 means exact evaluation everywhere. */
+  itkSetMacro(MaximumError, double);
+  itkGetConstMacro(MaximumError, double);
+
+  /** Size (in pixels per dimension) of the blocks the adaptive subdivision
+   * starts from. Default is 32. */
+  itkSetMacro(BlockSize, unsigned int);
+  itkGetConstMacro(BlockSize, unsigned int);
+
+  /** Largest deviation between the interpolated and the exact transform
+   * measured during the last executions (see ResetApproximationStatistics()) */
+  itkGetConstMacro(MaximumApproximationError, double);
+
+  /** Number of exact transform evaluations during the last executions */
+  itkGetConstMacro(NumberOfTransformEvaluations, unsigned long);
+
+  /** Number of displacement field pixels generated during the last executions */
+  itkGetConstMacro(NumberOfGeneratedPixels, unsigned long);
+
+  /** Reset the statistics above. This is done automatically in
+   * GenerateOutputInformation(), so that the statistics cover all the
+   * streaming passes of a pipeline update. */
+  void ResetApproximationStatistics();
+
+  void GenerateOutputInformation(void) override;
+
+  void BeforeThreadedGenerateData(void) override;
+
+protected:
+  ApproximateTransformToDisplacementFieldSource();
+  ~ApproximateTransformToDisplacementFieldSource() override
+  {
+  }
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
+
+  void AfterThreadedGenerateData(void) override;
+
+private:
+  ApproximateTransformToDisplacementFieldSource(const Self&) = delete;
+  void operator=(const Self&) = delete;
+
+  /** Per thread statistics of the approximation */
+  struct ThreadStatistics
+  {
+    double        maximumError;
+    unsigned long evaluations;
+    unsigned long pixels;
+  };
+
+  /** Exact displacement at a given index */
+  PixelType EvaluateDisplacement(OutputImageType* output, const IndexType& index, ThreadStatistics& stats) const;
+
+  /** Adaptive filling of the block [x0,x1]x[y0,y1], whose corner
+   * displacements are known (order: (x0,y0), (x1,y0), (x0,y1), (x1,y1)) */
+  void ProcessBlock(OutputImageType* output, const IndexType& start, const IndexType& end, const PixelType corners[4], ThreadStatistics& stats) const;
+
+  /** Bilinear interpolation of the corner displacements */
+  static PixelType Interpolate(const PixelType corners[4], double u, double v);
+
+  double       m_MaximumError;
+  unsigned int m_BlockSize;
+
+  double        m_MaximumApproximationError;
+  unsigned long m_NumberOfTransformEvaluations;
+  unsigned long m_NumberOfGeneratedPixels;
+
+  std::vector<ThreadStatistics> m_ThreadStatistics;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbApproximateTransformToDisplacementFieldSource.hxx"
+#endif
+
+#endif
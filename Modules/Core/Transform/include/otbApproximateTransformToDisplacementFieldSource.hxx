@@ -0,0 +1,367 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbApproximateTransformToDisplacementFieldSource_hxx
+#define otbApproximateTransformToDisplacementFieldSource_hxx
+
+#include "otbApproximateTransformToDisplacementFieldSource.h"
+#include "itkProgressReporter.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace otb
+{
+
+template <class TOutputImage, class TTransformPrecisionType>
+ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::ApproximateTransformToDisplacementFieldSource()
+  : m_MaximumError(0.), m_BlockSize(32), m_MaximumApproximationError(0.), m_NumberOfTransformEvaluations(0), m_NumberOfGeneratedPixels(0)
+{
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::ResetApproximationStatistics()
+{
+  m_MaximumApproximationError    = 0.;
+  m_NumberOfTransformEvaluations = 0;
+  m_NumberOfGeneratedPixels      = 0;
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+  this->ResetApproximationStatistics();
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  if (m_BlockSize < 2)
+  {
+    itkExceptionMacro(<< "BlockSize must be at least 2, got " << m_BlockSize);
+  }
+
+  ThreadStatistics init;
+  init.maximumError = 0.;
+  init.evaluations  = 0;
+  init.pixels       = 0;
+  m_ThreadStatistics.assign(this->GetNumberOfThreads(), init);
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::AfterThreadedGenerateData()
+{
+  for (typename std::vector<ThreadStatistics>::const_iterator it = m_ThreadStatistics.begin(); it != m_ThreadStatistics.end(); ++it)
+  {
+    m_MaximumApproximationError = std::max(m_MaximumApproximationError, it->maximumError);
+    m_NumberOfTransformEvaluations += it->evaluations;
+    m_NumberOfGeneratedPixels += it->pixels;
+  }
+  m_ThreadStatistics.clear();
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::ThreadedGenerateData(
+    const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  ThreadStatistics& stats = m_ThreadStatistics[threadId];
+  stats.pixels += outputRegionForThread.GetNumberOfPixels();
+
+  if (m_MaximumError <= 0. || ImageDimension != 2 || this->GetTransform()->IsLinear())
+  {
+    // Exact evaluation: the superclass calls the transform for every
+    // pixel (or twice per line for linear transforms)
+    stats.evaluations += outputRegionForThread.GetNumberOfPixels();
+    Superclass::ThreadedGenerateData(outputRegionForThread, threadId);
+    return;
+  }
+
+  OutputImageType* outputPtr = this->GetOutput();
+
+  const IndexType regionStart = outputRegionForThread.GetIndex();
+  const SizeType  regionSize  = outputRegionForThread.GetSize();
+
+  if (regionSize[0] == 0 || regionSize[1] == 0)
+  {
+    return;
+  }
+
+  const unsigned long nbBlocksX = (regionSize[0] + m_BlockSize - 1) / m_BlockSize;
+  const unsigned long nbBlocksY = (regionSize[1] + m_BlockSize - 1) / m_BlockSize;
+
+  // Support for progress methods/callbacks, one step per block
+  itk::ProgressReporter progress(this, threadId, nbBlocksX * nbBlocksY);
+
+  for (unsigned long by = 0; by < nbBlocksY; ++by)
+  {
+    for (unsigned long bx = 0; bx < nbBlocksX; ++bx)
+    {
+      IndexType start = regionStart;
+      IndexType end   = regionStart;
+      start[0] += bx * m_BlockSize;
+      start[1] += by * m_BlockSize;
+      end[0] = std::min<typename IndexType::IndexValueType>(start[0] + m_BlockSize, regionStart[0] + regionSize[0]) - 1;
+      end[1] = std::min<typename IndexType::IndexValueType>(start[1] + m_BlockSize, regionStart[1] + regionSize[1]) - 1;
+
+      IndexType idx;
+      PixelType corners[4];
+      for (unsigned int c = 0; c < 4; ++c)
+      {
+        idx[0]     = (c & 1) ? end[0] : start[0];
+        idx[1]     = (c & 2) ? end[1] : start[1];
+        corners[c] = this->EvaluateDisplacement(outputPtr, idx, stats);
+      }
+
+      this->ProcessBlock(outputPtr, start, end, corners, stats);
+      progress.CompletedPixel();
+    }
+  }
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+typename ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::PixelType
+ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::EvaluateDisplacement(OutputImageType* output, const IndexType& index,
+                                                                                                          ThreadStatistics& stats) const
+{
+  PointType outputPoint;
+  output->TransformIndexToPhysicalPoint(index, outputPoint);
+
+  const PointType transformedPoint = this->GetTransform()->TransformPoint(outputPoint);
+  ++stats.evaluations;
+
+  PixelType deformation;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    deformation[i] = static_cast<PixelValueType>(transformedPoint[i] - outputPoint[i]);
+  }
+  return deformation;
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+typename ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::PixelType
+ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::Interpolate(const PixelType corners[4], double u, double v)
+{
+  PixelType out;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    const double top    = (1. - u) * corners[0][i] + u * corners[1][i];
+    const double bottom = (1. - u) * corners[2][i] + u * corners[3][i];
+    out[i]              = static_cast<PixelValueType>((1. - v) * top + v * bottom);
+  }
+  return out;
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::ProcessBlock(OutputImageType* output, const IndexType& start,
+                                                                                                       const IndexType& end, const PixelType corners[4],
+                                                                                                       ThreadStatistics& stats) const
+{
+  const long nx = end[0] - start[0] + 1;
+  const long ny = end[1] - start[1] + 1;
+
+  IndexType idx;
+
+  // Blocks of at most 2x2 pixels only hold corners, which are exact
+  if (nx <= 2 && ny <= 2)
+  {
+    for (unsigned int c = 0; c < 4; ++c)
+    {
+      idx[0] = (c & 1) ? end[0] : start[0];
+      idx[1] = (c & 2) ? end[1] : start[1];
+      output->SetPixel(idx, corners[c]);
+    }
+    return;
+  }
+
+  const bool splitX = nx > 2;
+  const bool splitY = ny > 2;
+
+  const typename IndexType::IndexValueType xm = (start[0] + end[0]) / 2;
+  const typename IndexType::IndexValueType ym = (start[1] + end[1]) / 2;
+
+  const double um = nx > 1 ? static_cast<double>(xm - start[0]) / (nx - 1) : 0.;
+  const double vm = ny > 1 ? static_cast<double>(ym - start[1]) / (ny - 1) : 0.;
+
+  // Exact values at the check points: edge middles and center
+  PixelType top, bottom, left, right, center;
+  double    error = 0.;
+
+  // Euclidean deviation between the exact and the interpolated displacement
+  auto deviation = [&corners](const PixelType& exact, double u, double v) {
+    const PixelType approx = Interpolate(corners, u, v);
+    double          d2     = 0.;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      const double d = static_cast<double>(exact[i]) - static_cast<double>(approx[i]);
+      d2 += d * d;
+    }
+    // Invalid transformed points (NaN) force the refinement
+    return std::isfinite(d2) ? std::sqrt(d2) : std::numeric_limits<double>::max();
+  };
+
+  if (splitX)
+  {
+    idx[0] = xm;
+    idx[1] = start[1];
+    top    = this->EvaluateDisplacement(output, idx, stats);
+    idx[1] = end[1];
+    bottom = this->EvaluateDisplacement(output, idx, stats);
+    error  = std::max(error, std::max(deviation(top, um, 0.), deviation(bottom, um, 1.)));
+  }
+  if (splitY)
+  {
+    idx[0] = start[0];
+    idx[1] = ym;
+    left   = this->EvaluateDisplacement(output, idx, stats);
+    idx[0] = end[0];
+    right  = this->EvaluateDisplacement(output, idx, stats);
+    error  = std::max(error, std::max(deviation(left, 0., vm), deviation(right, 1., vm)));
+  }
+  if (splitX && splitY)
+  {
+    idx[0] = xm;
+    idx[1] = ym;
+    center = this->EvaluateDisplacement(output, idx, stats);
+    error  = std::max(error, deviation(center, um, vm));
+  }
+
+  if (error <= m_MaximumError)
+  {
+    stats.maximumError = std::max(stats.maximumError, error);
+
+    // Fill the block by bilinear interpolation of the corners
+    for (long y = 0; y < ny; ++y)
+    {
+      const double v = ny > 1 ? static_cast<double>(y) / (ny - 1) : 0.;
+      idx[1]         = start[1] + y;
+      for (long x = 0; x < nx; ++x)
+      {
+        idx[0] = start[0] + x;
+        output->SetPixel(idx, Interpolate(corners, nx > 1 ? static_cast<double>(x) / (nx - 1) : 0., v));
+      }
+    }
+    return;
+  }
+
+  // Refine: split the block at the check points and reuse their exact values
+  IndexType subStart, subEnd;
+  PixelType sub[4];
+
+  if (splitX && splitY)
+  {
+    // Upper left
+    subStart = start;
+    subEnd[0] = xm;
+    subEnd[1] = ym;
+    sub[0] = corners[0];
+    sub[1] = top;
+    sub[2] = left;
+    sub[3] = center;
+    this->ProcessBlock(output, subStart, subEnd, sub, stats);
+
+    // Upper right
+    subStart[0] = xm;
+    subStart[1] = start[1];
+    subEnd[0]   = end[0];
+    subEnd[1]   = ym;
+    sub[0]      = top;
+    sub[1]      = corners[1];
+    sub[2]      = center;
+    sub[3]      = right;
+    this->ProcessBlock(output, subStart, subEnd, sub, stats);
+
+    // Lower left
+    subStart[0] = start[0];
+    subStart[1] = ym;
+    subEnd[0]   = xm;
+    subEnd[1]   = end[1];
+    sub[0]      = left;
+    sub[1]      = center;
+    sub[2]      = corners[2];
+    sub[3]      = bottom;
+    this->ProcessBlock(output, subStart, subEnd, sub, stats);
+
+    // Lower right
+    subStart[0] = xm;
+    subStart[1] = ym;
+    subEnd      = end;
+    sub[0]      = center;
+    sub[1]      = right;
+    sub[2]      = bottom;
+    sub[3]      = corners[3];
+    this->ProcessBlock(output, subStart, subEnd, sub, stats);
+  }
+  else if (splitX)
+  {
+    subStart  = start;
+    subEnd[0] = xm;
+    subEnd[1] = end[1];
+    sub[0]    = corners[0];
+    sub[1]    = top;
+    sub[2]    = corners[2];
+    sub[3]    = bottom;
+    this->ProcessBlock(output, subStart, subEnd, sub, stats);
+
+    subStart[0] = xm;
+    subEnd      = end;
+    sub[0]      = top;
+    sub[1]      = corners[1];
+    sub[2]      = bottom;
+    sub[3]      = corners[3];
+    this->ProcessBlock(output, subStart, subEnd, sub, stats);
+  }
+  else
+  {
+    subStart  = start;
+    subEnd[0] = end[0];
+    subEnd[1] = ym;
+    sub[0]    = corners[0];
+    sub[1]    = corners[1];
+    sub[2]    = left;
+    sub[3]    = right;
+    this->ProcessBlock(output, subStart, subEnd, sub, stats);
+
+    subStart[1] = ym;
+    subEnd      = end;
+    sub[0]      = left;
+    sub[1]      = right;
+    sub[2]      = corners[2];
+    sub[3]      = corners[3];
+    this->ProcessBlock(output, subStart, subEnd, sub, stats);
+  }
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void ApproximateTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "MaximumError: " << m_MaximumError << std::endl;
+  os << indent << "BlockSize: " << m_BlockSize << std::endl;
+  os << indent << "MaximumApproximationError: " << m_MaximumApproximationError << std::endl;
+  os << indent << "NumberOfTransformEvaluations: " << m_NumberOfTransformEvaluations << std::endl;
+  os << indent << "NumberOfGeneratedPixels: " << m_NumberOfGeneratedPixels << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "itkVector.h"
+#include "itkImageRegionConstIterator.h"
+#include "otbImage.h"
+#include "otbLogPolarTransform.h"
+#include "otbApproximateTransformToDisplacementFieldSource.h"
+
+int otbApproximateTransformToDisplacementFieldSource(int argc, char* argv[])
+{
+  typedef itk::Vector<double, 2> DisplacementType;
+  typedef otb::Image<DisplacementType, 2> DisplacementFieldType;
+  typedef otb::ApproximateTransformToDisplacementFieldSource<DisplacementFieldType, double> GeneratorType;
+  typedef otb::LogPolarTransform<double> TransformType;
+  typedef itk::ImageRegionConstIterator<DisplacementFieldType> IteratorType;
+
+  const double tolerance = argc > 1 ? atof(argv[1]) : 0.1;
+
+  DisplacementFieldType::SizeType size;
+  size.Fill(300);
+
+  // Smooth, non linear transform
+  TransformType::Pointer        transform = TransformType::New();
+  TransformType::ParametersType params(4);
+  params[0] = 150.;
+  params[1] = 150.;
+  params[2] = 360. / size[0];
+  params[3] = std::log(150.) / size[1];
+  transform->SetParameters(params);
+
+  GeneratorType::Pointer exact = GeneratorType::New();
+  exact->SetTransform(transform);
+  exact->SetOutputSize(size);
+  exact->Update();
+
+  GeneratorType::Pointer approx = GeneratorType::New();
+  approx->SetTransform(transform);
+  approx->SetOutputSize(size);
+  approx->SetMaximumError(tolerance);
+  approx->Update();
+
+  std::cout << "Transform evaluations: exact " << exact->GetNumberOfTransformEvaluations() << ", approximate " << approx->GetNumberOfTransformEvaluations()
+            << " for " << approx->GetNumberOfGeneratedPixels() << " pixels" << std::endl;
+  std::cout << "Reported maximum error: " << approx->GetMaximumApproximationError() << std::endl;
+
+  // Measure the actual error
+  double       maxError = 0.;
+  IteratorType itExact(exact->GetOutput(), exact->GetOutput()->GetLargestPossibleRegion());
+  IteratorType itApprox(approx->GetOutput(), approx->GetOutput()->GetLargestPossibleRegion());
+  for (itExact.GoToBegin(), itApprox.GoToBegin(); !itExact.IsAtEnd(); ++itExact, ++itApprox)
+  {
+    maxError = std::max(maxError, (itExact.Get() - itApprox.Get()).GetNorm());
+  }
+  std::cout << "Measured maximum error: " << maxError << std::endl;
+
+  if (exact->GetMaximumApproximationError() != 0.)
+  {
+    std::cerr << "Exact generation should not report any approximation error" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (approx->GetMaximumApproximationError() > tolerance)
+  {
+    std::cerr << "Reported error is above the tolerance" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The error is only checked at a few points per block: allow some margin
+  if (maxError > 2 * tolerance)
+  {
+    std::cerr << "Measured error is above twice the tolerance" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (approx->GetNumberOfTransformEvaluations() >= approx->GetNumberOfGeneratedPixels())
+  {
+    std::cerr << "Approximation did not save any transform evaluation" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
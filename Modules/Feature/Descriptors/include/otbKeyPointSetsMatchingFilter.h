@@ -23,7 +23,10 @@
 
 #include "otbObjectListSource.h"
 #include "otbLandmark.h"
+#include "otbStopwatch.h"
 #include "itkEuclideanDistanceMetric.h"
+#include "itkMultiThreader.h"
+#include <vector>
 
 namespace otb
 {
@@ -38,6 +41,12 @@ namespace otb
  *   it will also try to match points from pointset 2 to points from pointset 2, and discard matches that do not appear both in
  *   forward and backward matching.
  *
+ *   With the Euclidean distance, neighbors are searched in a k-d tree built on the point data. The search is exact
+ *   by default, and gives the same matches as the brute force search. Setting MaximumNumberOfChecks bounds the number
+ *   of point data compared for each query (best bin first search): the search is then approximate, but much faster on
+ *   large pointsets with high dimension descriptors such as SIFT or SURF. Other distances use the brute force search.
+ *   In both cases, queries are processed in parallel.
+ *
  *   Matches are stored in a landmark object containing both matched points and point data. The landmark data will hold the distance value
  *   between the data.
  *
@@ -63,6 +72,7 @@ public:
   typedef typename PointSetType::Pointer                 PointSetPointerType;
   typedef typename PointSetType::PointType               PointType;
   typedef typename PointSetType::PixelType               PointDataType;
+  typedef typename PointSetType::PointIdentifier         PointIdentifierType;
   typedef typename PointSetType::PointsContainer         PointsContainerType;
   typedef typename PointsContainerType::ConstIterator    PointsIteratorType;
   typedef typename PointSetType::PointDataContainer      PointDataContainerType;
@@ -74,6 +84,7 @@ public:
   typedef ObjectList<LandmarkType>           LandmarkListType;
   typedef typename LandmarkListType::Pointer LandmarkListPointerType;
   typedef std::pair<unsigned int, double> NeighborSearchResultType;
+  typedef Stopwatch::DurationType         DurationType;
 
   /// standard macros
   itkNewMacro(Self);
@@ -86,6 +97,22 @@ public:
   itkSetMacro(DistanceThreshold, double);
   itkGetMacro(DistanceThreshold, double);
 
+  /// Use a k-d tree to search neighbors (only with the Euclidean distance, default is true)
+  itkBooleanMacro(UseKdTree);
+  itkSetMacro(UseKdTree, bool);
+  itkGetMacro(UseKdTree, bool);
+
+  /// Maximum number of point data compared for each k-d tree query (0, the default, gives an exact search)
+  itkSetMacro(MaximumNumberOfChecks, unsigned int);
+  itkGetMacro(MaximumNumberOfChecks, unsigned int);
+
+  /// Number of points of pointset 1 passing the distance threshold, before back matching
+  itkGetMacro(NumberOfCandidateMatches, unsigned long);
+  /// Number of matches in the output
+  itkGetMacro(NumberOfMatches, unsigned long);
+  /// Time spent in the last update, in milliseconds
+  itkGetMacro(ElapsedMilliseconds, DurationType);
+
   /// Set the first pointset
   void SetInput1(const PointSetType* pointset);
   /// Get the first pointset
@@ -108,11 +135,81 @@ protected:
   /// Generate Data
   void GenerateData() override;
 
+  typedef typename itk::NumericTraits<PointDataType>::ValueType DescriptorValueType;
+
+  /** Points and point data of a pointset, in iteration order. When the
+   *  k-d tree is used, the point data are also copied contiguously in
+   *  Values (Dimension values per point). */
+  struct DescriptorSetType
+  {
+    std::vector<PointIdentifierType> Ids;
+    std::vector<PointType>           Points;
+    std::vector<PointDataType>       Data;
+    std::vector<DescriptorValueType> Values;
+    unsigned int                     Dimension;
+  };
+
+  /** Node of a k-d tree. Leaves hold the range [Begin, End) of the tree
+   *  permutation, other nodes split the data at SplitValue along
+   *  SplitDimension (Begin and End are then the children nodes). */
+  struct KdTreeNodeType
+  {
+    bool         IsLeaf;
+    unsigned int SplitDimension;
+    double       SplitValue;
+    unsigned int Begin;
+    unsigned int End;
+  };
+
+  struct KdTreeType
+  {
+    std::vector<KdTreeNodeType> Nodes;
+    std::vector<unsigned int>   Permutation;
+  };
+
+  /** Search the neighbors of some points of a descriptor set (the queries)
+   *  in another one (the targets) */
+  struct SearchThreadStruct
+  {
+    Self*                                  Filter;
+    const DescriptorSetType*               Queries;
+    const std::vector<unsigned int>*       QueryRows;
+    const DescriptorSetType*               Targets;
+    const KdTreeType*                      Tree;
+    std::vector<NeighborSearchResultType>* Results;
+  };
+
+  /// Copy points and point data of a pointset
+  void FillDescriptorSet(const PointSetType* pointset, DescriptorSetType& descriptors, bool copyValues) const;
+
+  /// Build a k-d tree on the values of a descriptor set
+  void BuildKdTree(const DescriptorSetType& descriptors, KdTreeType& tree) const;
+
+  /// Build the subtree of the permutation range [begin, end) and return its node index
+  unsigned int BuildKdTreeNode(const DescriptorSetType& descriptors, KdTreeType& tree, unsigned int begin, unsigned int end) const;
+
+  /// Search neighbors of all queries in parallel
+  void Search(const DescriptorSetType& queries, const std::vector<unsigned int>& queryRows, const DescriptorSetType& targets, const KdTreeType* tree,
+              std::vector<NeighborSearchResultType>& results);
+
+  /// Search neighbors of the queries handled by one thread
+  void ThreadedSearch(const SearchThreadStruct& str, itk::ThreadIdType threadId, itk::ThreadIdType numberOfThreads) const;
+
+  /// Callback function to launch ThreadedSearch in each thread
+  static ITK_THREAD_RETURN_TYPE SearchThreaderCallback(void* arg);
+
   /**
-   * Find the nearest neighbor of data1 in pointset.
-   * \return a pair of (index, distance).
+   * Find the nearest neighbor of data1 in a descriptor set, with the brute force search.
+   * \return a pair of (row, distance ratio).
    */
-  NeighborSearchResultType NearestNeighbor(const PointDataType& data1, const PointSetType* pointset);
+  NeighborSearchResultType NearestNeighbor(const PointDataType& data1, const DescriptorSetType& descriptors) const;
+
+  /**
+   * Find the nearest neighbor of query (Dimension values) in a descriptor set, with its k-d tree.
+   * \return a pair of (row, distance ratio).
+   */
+  NeighborSearchResultType KdTreeNearestNeighbor(const DescriptorValueType* query, const DescriptorSetType& descriptors, const KdTreeType& tree,
+                                                 std::vector<std::pair<double, unsigned int>>& branches) const;
 
 private:
   KeyPointSetsMatchingFilter(const Self&) = delete;
@@ -124,6 +221,17 @@ private:
   // Distance threshold to decide matching
   double m_DistanceThreshold;
 
+  // Search neighbors in a k-d tree
+  bool m_UseKdTree;
+
+  // Bound on the number of point data compared per query (0 for exact search)
+  unsigned int m_MaximumNumberOfChecks;
+
+  // Statistics of the last update
+  unsigned long m_NumberOfCandidateMatches;
+  unsigned long m_NumberOfMatches;
+  DurationType  m_ElapsedMilliseconds;
+
   // Distance calculator
   DistancePointerType m_DistanceCalculator;
 };
@@ -22,6 +22,12 @@
 #define otbKeyPointSetsMatchingFilter_hxx
 
 #include "otbKeyPointSetsMatchingFilter.h"
+#include "otbMacro.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <type_traits>
 
 namespace otb
 {
@@ -30,8 +36,13 @@ template <class TPointSet, class TDistance>
 KeyPointSetsMatchingFilter<TPointSet, TDistance>::KeyPointSetsMatchingFilter()
 {
   this->SetNumberOfRequiredInputs(2);
-  m_UseBackMatching   = false;
-  m_DistanceThreshold = 0.6;
+  m_UseBackMatching          = false;
+  m_DistanceThreshold        = 0.6;
+  m_UseKdTree                = true;
+  m_MaximumNumberOfChecks    = 0;
+  m_NumberOfCandidateMatches = 0;
+  m_NumberOfMatches          = 0;
+  m_ElapsedMilliseconds      = 0;
   // Object used to measure distance
   m_DistanceCalculator = DistanceType::New();
 }
@@ -63,7 +74,7 @@ void KeyPointSetsMatchingFilter<TPointSet, TDistance>::SetInput2(const PointSetT
 template <class TPointSet, class TDistance>
 void KeyPointSetsMatchingFilter<TPointSet, TDistance>::GenerateData()
 {
-  //   std::cout<<"GenerateData()"<<std::endl;
+  Stopwatch chrono = Stopwatch::StartNew();
 
   // Get the input pointers
   const PointSetType* ps1 = this->GetInput1();
@@ -75,89 +86,311 @@ void KeyPointSetsMatchingFilter<TPointSet, TDistance>::GenerateData()
     itkExceptionMacro(<< "Empty input pointset !");
   }
 
-  // Get the output pointer
-  LandmarkListPointerType landmarks = this->GetOutput();
+  // The k-d tree prunes its search with the coordinates of the point
+  // data, which is only valid for the Euclidean distance
+  const bool useKdTree = m_UseKdTree && std::is_same<DistanceType, itk::Statistics::EuclideanDistanceMetric<PointDataType>>::value;
 
-  // Define iterators on points and point data.
-  PointsIteratorType    pIt  = ps1->GetPoints()->Begin();
-  PointDataIteratorType pdIt = ps1->GetPointData()->Begin();
+  DescriptorSetType descriptors1, descriptors2;
+  FillDescriptorSet(ps1, descriptors1, useKdTree);
+  FillDescriptorSet(ps2, descriptors2, useKdTree);
 
-  // iterate on pointset 1
-  while (pdIt != ps1->GetPointData()->End() && pIt != ps1->GetPoints()->End())
+  // A second nearest neighbor is needed to compute the distance ratio
+  if (descriptors2.Data.size() < 2 || (m_UseBackMatching && descriptors1.Data.size() < 2))
   {
-    // Get point and point data at current location
-    bool          matchFound   = false;
-    unsigned int  currentIndex = pIt.Index();
-    PointDataType data         = pdIt.Value();
-    PointType     point        = pIt.Value();
-
-    // These variables will hold the matched point and point data
-    PointDataType dataMatch;
-    PointType     pointMatch;
+    itkExceptionMacro(<< "Matching needs at least two points in each pointset.");
+  }
+  if (descriptors1.Dimension != descriptors2.Dimension)
+  {
+    itkExceptionMacro(<< "Point data of both pointsets have different sizes (" << descriptors1.Dimension << " and " << descriptors2.Dimension << ").");
+  }
 
-    // call to the matching routine
-    NeighborSearchResultType searchResult1 = NearestNeighbor(data, ps2);
+  KdTreeType tree1, tree2;
+  if (useKdTree)
+  {
+    BuildKdTree(descriptors2, tree2);
+    if (m_UseBackMatching)
+    {
+      BuildKdTree(descriptors1, tree1);
+    }
+  }
 
+  // Forward search of all the points of pointset 1
+  std::vector<unsigned int> rows1(descriptors1.Data.size());
+  for (unsigned int row = 0; row < rows1.size(); ++row)
+  {
+    rows1[row] = row;
+  }
+  std::vector<NeighborSearchResultType> searchResults1;
+  Search(descriptors1, rows1, descriptors2, useKdTree ? &tree2 : nullptr, searchResults1);
+
+  // Back search only concerns the points of pointset 2 matched by the
+  // forward search, each of them being searched once
+  std::vector<unsigned int> backRows;
+  std::vector<unsigned int> backResultIndex(descriptors2.Data.size(), 0);
+  std::vector<bool>         isBackQuery(descriptors2.Data.size(), false);
+  m_NumberOfCandidateMatches = 0;
+  for (const auto& searchResult1 : searchResults1)
+  {
     // Check if the neighbor distance is lower than the threshold
     if (searchResult1.second < m_DistanceThreshold)
     {
-      // Get the matched point and point data
-      dataMatch  = ps2->GetPointData()->GetElement(searchResult1.first);
-      pointMatch = ps2->GetPoints()->GetElement(searchResult1.first);
-
-      // If the back matching option is on
-      if (m_UseBackMatching)
-      {
-        // Peform the back search
-        NeighborSearchResultType searchResult2 = NearestNeighbor(dataMatch, ps1);
-
-        // Test if back search finds the same match
-        if (currentIndex == searchResult2.first)
-        {
-          matchFound = true;
-        }
-      }
-      else // else back matching
+      ++m_NumberOfCandidateMatches;
+      if (m_UseBackMatching && !isBackQuery[searchResult1.first])
       {
-        matchFound = true;
+        isBackQuery[searchResult1.first]     = true;
+        backResultIndex[searchResult1.first] = backRows.size();
+        backRows.push_back(searchResult1.first);
       }
     }
+  }
+
+  std::vector<NeighborSearchResultType> searchResults2;
+  if (m_UseBackMatching && !backRows.empty())
+  {
+    Search(descriptors2, backRows, descriptors1, useKdTree ? &tree1 : nullptr, searchResults2);
+  }
+
+  // Get the output pointer
+  LandmarkListPointerType landmarks = this->GetOutput();
 
-    // If we found a match, add the proper landmark
-    if (matchFound)
+  m_NumberOfMatches = 0;
+  for (unsigned int row1 = 0; row1 < searchResults1.size(); ++row1)
+  {
+    const NeighborSearchResultType& searchResult1 = searchResults1[row1];
+    if (!(searchResult1.second < m_DistanceThreshold))
     {
-      LandmarkPointerType landmark = LandmarkType::New();
-      landmark->SetPoint1(point);
-      landmark->SetPointData1(data);
-      landmark->SetPoint2(pointMatch);
-      landmark->SetPointData2(dataMatch);
-      landmark->SetLandmarkData(searchResult1.second);
-
-      // Add the new landmark to the landmark list
-      landmarks->PushBack(landmark);
+      continue;
     }
+
+    // Test if back search finds the same match
+    if (m_UseBackMatching && searchResults2[backResultIndex[searchResult1.first]].first != row1)
+    {
+      continue;
+    }
+
+    LandmarkPointerType landmark = LandmarkType::New();
+    landmark->SetPoint1(descriptors1.Points[row1]);
+    landmark->SetPointData1(descriptors1.Data[row1]);
+    landmark->SetPoint2(descriptors2.Points[searchResult1.first]);
+    landmark->SetPointData2(descriptors2.Data[searchResult1.first]);
+    landmark->SetLandmarkData(searchResult1.second);
+
+    // Add the new landmark to the landmark list
+    landmarks->PushBack(landmark);
+    ++m_NumberOfMatches;
+  }
+
+  chrono.Stop();
+  m_ElapsedMilliseconds = chrono.GetElapsedMilliseconds();
+  otbMsgDevMacro(<< "KeyPointSetsMatchingFilter: " << m_NumberOfMatches << " matches (" << m_NumberOfCandidateMatches << " before back matching) found in "
+                 << m_ElapsedMilliseconds << " ms.");
+}
+
+template <class TPointSet, class TDistance>
+void KeyPointSetsMatchingFilter<TPointSet, TDistance>::FillDescriptorSet(const PointSetType* pointset, DescriptorSetType& descriptors, bool copyValues) const
+{
+  const unsigned int nbPoints = pointset->GetNumberOfPoints();
+  descriptors.Ids.reserve(nbPoints);
+  descriptors.Points.reserve(nbPoints);
+  descriptors.Data.reserve(nbPoints);
+  descriptors.Dimension = 0;
+
+  // Define iterators on points and point data.
+  PointsIteratorType    pIt  = pointset->GetPoints()->Begin();
+  PointDataIteratorType pdIt = pointset->GetPointData()->Begin();
+
+  while (pdIt != pointset->GetPointData()->End() && pIt != pointset->GetPoints()->End())
+  {
+    descriptors.Ids.push_back(pIt.Index());
+    descriptors.Points.push_back(pIt.Value());
+    descriptors.Data.push_back(pdIt.Value());
     ++pdIt;
     ++pIt;
   }
+
+  if (descriptors.Data.empty())
+  {
+    return;
+  }
+
+  // All point data must have the same size to be compared
+  descriptors.Dimension = itk::NumericTraits<PointDataType>::GetLength(descriptors.Data.front());
+  for (const auto& data : descriptors.Data)
+  {
+    if (itk::NumericTraits<PointDataType>::GetLength(data) != descriptors.Dimension)
+    {
+      itkExceptionMacro(<< "Point data of a pointset have different sizes.");
+    }
+  }
+
+  if (copyValues)
+  {
+    descriptors.Values.resize(descriptors.Data.size() * descriptors.Dimension);
+    for (unsigned int row = 0; row < descriptors.Data.size(); ++row)
+    {
+      DescriptorValueType* values = &descriptors.Values[row * descriptors.Dimension];
+      for (unsigned int i = 0; i < descriptors.Dimension; ++i)
+      {
+        values[i] = descriptors.Data[row][i];
+      }
+    }
+  }
+}
+
+template <class TPointSet, class TDistance>
+void KeyPointSetsMatchingFilter<TPointSet, TDistance>::BuildKdTree(const DescriptorSetType& descriptors, KdTreeType& tree) const
+{
+  const unsigned int nbPoints = descriptors.Data.size();
+  tree.Nodes.clear();
+  tree.Nodes.reserve(2 * (nbPoints / 8 + 1));
+  tree.Permutation.resize(nbPoints);
+  for (unsigned int row = 0; row < nbPoints; ++row)
+  {
+    tree.Permutation[row] = row;
+  }
+  BuildKdTreeNode(descriptors, tree, 0, nbPoints);
+}
+
+template <class TPointSet, class TDistance>
+unsigned int KeyPointSetsMatchingFilter<TPointSet, TDistance>::BuildKdTreeNode(const DescriptorSetType& descriptors, KdTreeType& tree, unsigned int begin,
+                                                                                unsigned int end) const
+{
+  // Maximum number of points in a leaf
+  const unsigned int leafSize = 8;
+  // Maximum number of points used to choose the split dimension
+  const unsigned int maxSamples = 128;
+
+  const unsigned int nodeIndex = tree.Nodes.size();
+  tree.Nodes.push_back(KdTreeNodeType());
+
+  if (end - begin <= leafSize)
+  {
+    KdTreeNodeType& node = tree.Nodes[nodeIndex];
+    node.IsLeaf          = true;
+    node.SplitDimension  = 0;
+    node.SplitValue      = 0.;
+    node.Begin           = begin;
+    node.End             = end;
+    return nodeIndex;
+  }
+
+  // Split along the dimension of highest variance, estimated on a
+  // subsample of the points
+  const unsigned int  dimension = descriptors.Dimension;
+  const unsigned int  step      = std::max(1u, (end - begin) / maxSamples);
+  std::vector<double> sum(dimension, 0.), sumOfSquares(dimension, 0.);
+  unsigned int        nbSamples = 0;
+  for (unsigned int p = begin; p < end; p += step)
+  {
+    const DescriptorValueType* values = &descriptors.Values[tree.Permutation[p] * dimension];
+    for (unsigned int i = 0; i < dimension; ++i)
+    {
+      sum[i] += values[i];
+      sumOfSquares[i] += static_cast<double>(values[i]) * values[i];
+    }
+    ++nbSamples;
+  }
+  unsigned int splitDimension = 0;
+  double       maxVariance    = -1.;
+  for (unsigned int i = 0; i < dimension; ++i)
+  {
+    const double variance = sumOfSquares[i] - sum[i] * sum[i] / nbSamples;
+    if (variance > maxVariance)
+    {
+      maxVariance    = variance;
+      splitDimension = i;
+    }
+  }
+
+  // Split at the median: points before middle have a value lower or
+  // equal to the split value, points after have a greater or equal one
+  const unsigned int middle = begin + (end - begin) / 2;
+  std::nth_element(tree.Permutation.begin() + begin, tree.Permutation.begin() + middle, tree.Permutation.begin() + end,
+                   [&descriptors, dimension, splitDimension](unsigned int a, unsigned int b) {
+                     return descriptors.Values[a * dimension + splitDimension] < descriptors.Values[b * dimension + splitDimension];
+                   });
+  const double splitValue = descriptors.Values[tree.Permutation[middle] * dimension + splitDimension];
+
+  const unsigned int left  = BuildKdTreeNode(descriptors, tree, begin, middle);
+  const unsigned int right = BuildKdTreeNode(descriptors, tree, middle, end);
+
+  KdTreeNodeType& node = tree.Nodes[nodeIndex];
+  node.IsLeaf          = false;
+  node.SplitDimension  = splitDimension;
+  node.SplitValue      = splitValue;
+  node.Begin           = left;
+  node.End             = right;
+  return nodeIndex;
+}
+
+template <class TPointSet, class TDistance>
+void KeyPointSetsMatchingFilter<TPointSet, TDistance>::Search(const DescriptorSetType& queries, const std::vector<unsigned int>& queryRows,
+                                                              const DescriptorSetType& targets, const KdTreeType* tree,
+                                                              std::vector<NeighborSearchResultType>& results)
+{
+  results.resize(queryRows.size());
+
+  SearchThreadStruct str;
+  str.Filter    = this;
+  str.Queries   = &queries;
+  str.QueryRows = &queryRows;
+  str.Targets   = &targets;
+  str.Tree      = tree;
+  str.Results   = &results;
+
+  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+  this->GetMultiThreader()->SetSingleMethod(this->SearchThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template <class TPointSet, class TDistance>
+ITK_THREAD_RETURN_TYPE KeyPointSetsMatchingFilter<TPointSet, TDistance>::SearchThreaderCallback(void* arg)
+{
+  SearchThreadStruct* str = (SearchThreadStruct*)(((itk::MultiThreader::ThreadInfoStruct*)(arg))->UserData);
+
+  itk::ThreadIdType threadId    = ((itk::MultiThreader::ThreadInfoStruct*)(arg))->ThreadID;
+  itk::ThreadIdType threadCount = ((itk::MultiThreader::ThreadInfoStruct*)(arg))->NumberOfThreads;
+
+  str->Filter->ThreadedSearch(*str, threadId, threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TPointSet, class TDistance>
+void KeyPointSetsMatchingFilter<TPointSet, TDistance>::ThreadedSearch(const SearchThreadStruct& str, itk::ThreadIdType threadId,
+                                                                      itk::ThreadIdType numberOfThreads) const
+{
+  // Each thread handles a contiguous range of queries
+  const unsigned long nbQueries = str.QueryRows->size();
+  const unsigned long first     = nbQueries * threadId / numberOfThreads;
+  const unsigned long last      = nbQueries * (threadId + 1) / numberOfThreads;
+
+  std::vector<std::pair<double, unsigned int>> branches;
+  for (unsigned long q = first; q < last; ++q)
+  {
+    const unsigned int row = (*str.QueryRows)[q];
+    if (str.Tree)
+    {
+      (*str.Results)[q] = KdTreeNearestNeighbor(&str.Queries->Values[row * str.Queries->Dimension], *str.Targets, *str.Tree, branches);
+    }
+    else
+    {
+      (*str.Results)[q] = NearestNeighbor(str.Queries->Data[row], *str.Targets);
+    }
+  }
 }
 
 template <class TPointSet, class TDistance>
 typename KeyPointSetsMatchingFilter<TPointSet, TDistance>::NeighborSearchResultType
-KeyPointSetsMatchingFilter<TPointSet, TDistance>::NearestNeighbor(const PointDataType& data1, const PointSetType* pointset)
+KeyPointSetsMatchingFilter<TPointSet, TDistance>::NearestNeighbor(const PointDataType& data1, const DescriptorSetType& descriptors) const
 {
-  //   std::cout<<"Call to NearestNeighbor()"<<std::endl;
   // Declare the result
   NeighborSearchResultType result;
 
-  // Define iterators on points and point data.
-  PointDataIteratorType pdIt = pointset->GetPointData()->Begin();
-
   // local variables
   unsigned int nearestIndex = 0;
-  double       d1           = m_DistanceCalculator->Evaluate(data1, pdIt.Value());
-  ++pdIt;
-  double d2 = m_DistanceCalculator->Evaluate(data1, pdIt.Value());
-  ++pdIt;
+  double       d1           = m_DistanceCalculator->Evaluate(data1, descriptors.Data[0]);
+  double       d2           = m_DistanceCalculator->Evaluate(data1, descriptors.Data[1]);
 
   if (d1 > d2)
   {
@@ -168,27 +401,24 @@ KeyPointSetsMatchingFilter<TPointSet, TDistance>::NearestNeighbor(const PointDat
   double secondNearestDistance = std::max(d1, d2);
   double distanceValue;
 
-  // iterate on the pointset
-  while (pdIt != pointset->GetPointData()->End())
+  // iterate on the descriptors
+  for (unsigned int row = 2; row < descriptors.Data.size(); ++row)
   {
     // Evaluate the distance
-    distanceValue = m_DistanceCalculator->Evaluate(data1, pdIt.Value());
-
-    //       std::cout<<nearestIndex<<" "<<nearestDistance<<" "<<secondNearestDistance<<std::endl;
+    distanceValue = m_DistanceCalculator->Evaluate(data1, descriptors.Data[row]);
 
     // Check if this point is the nearest neighbor
     if (distanceValue < nearestDistance)
     {
       secondNearestDistance = nearestDistance;
       nearestDistance       = distanceValue;
-      nearestIndex          = pdIt.Index();
+      nearestIndex          = row;
     }
     // Else check if it is the second nearest neighbor
     else if (distanceValue < secondNearestDistance)
     {
       secondNearestDistance = distanceValue;
     }
-    ++pdIt;
   }
 
   // Fill results
@@ -206,10 +436,115 @@ KeyPointSetsMatchingFilter<TPointSet, TDistance>::NearestNeighbor(const PointDat
   return result;
 }
 
+template <class TPointSet, class TDistance>
+typename KeyPointSetsMatchingFilter<TPointSet, TDistance>::NeighborSearchResultType
+KeyPointSetsMatchingFilter<TPointSet, TDistance>::KdTreeNearestNeighbor(const DescriptorValueType* query, const DescriptorSetType& descriptors,
+                                                                        const KdTreeType& tree, std::vector<std::pair<double, unsigned int>>& branches) const
+{
+  typedef std::pair<double, unsigned int> BranchType;
+
+  const unsigned int dimension = descriptors.Dimension;
+
+  // Squared distances to the nearest and second nearest neighbors. When
+  // two points are at the same distance, the first one in iteration
+  // order is the nearest, as in the brute force search.
+  double       nearest       = std::numeric_limits<double>::infinity();
+  double       secondNearest = std::numeric_limits<double>::infinity();
+  unsigned int nearestRow    = 0;
+  unsigned int nbChecks      = 0;
+
+  // Branches not explored yet, with a lower bound of the squared distance
+  // to their points, in a min-heap (best bin first)
+  branches.clear();
+  branches.push_back(BranchType(0., 0));
+
+  while (!branches.empty())
+  {
+    std::pop_heap(branches.begin(), branches.end(), std::greater<BranchType>());
+    const BranchType branch = branches.back();
+    branches.pop_back();
+
+    if (branch.first > secondNearest || (m_MaximumNumberOfChecks > 0 && nbChecks >= m_MaximumNumberOfChecks))
+    {
+      break;
+    }
+
+    // Go down to the closest leaf, keeping the other branches for later
+    const KdTreeNodeType* node = &tree.Nodes[branch.second];
+    while (!node->IsLeaf)
+    {
+      const double       diff     = query[node->SplitDimension] - node->SplitValue;
+      const unsigned int closest  = diff < 0 ? node->Begin : node->End;
+      const unsigned int farthest = diff < 0 ? node->End : node->Begin;
+      const double       farBound = std::max(branch.first, diff * diff);
+      if (farBound <= secondNearest)
+      {
+        branches.push_back(BranchType(farBound, farthest));
+        std::push_heap(branches.begin(), branches.end(), std::greater<BranchType>());
+      }
+      node = &tree.Nodes[closest];
+    }
+
+    for (unsigned int p = node->Begin; p < node->End; ++p)
+    {
+      const unsigned int         row    = tree.Permutation[p];
+      const DescriptorValueType* values = &descriptors.Values[row * dimension];
+
+      // Same operations as EuclideanDistanceMetric::Evaluate(), stopped
+      // early when the point can not be one of the neighbors
+      double       distance = 0.;
+      unsigned int i        = 0;
+      while (i < dimension && distance <= secondNearest)
+      {
+        const unsigned int blockEnd = std::min(dimension, i + 8);
+        for (; i < blockEnd; ++i)
+        {
+          const double temp = query[i] - values[i];
+          distance += temp * temp;
+        }
+      }
+      ++nbChecks;
+
+      if (distance < nearest || (distance == nearest && row < nearestRow))
+      {
+        secondNearest = nearest;
+        nearest       = distance;
+        nearestRow    = row;
+      }
+      else if (distance < secondNearest)
+      {
+        secondNearest = distance;
+      }
+    }
+  }
+
+  NeighborSearchResultType result;
+  result.first = nearestRow;
+
+  const double nearestDistance       = std::sqrt(nearest);
+  const double secondNearestDistance = std::sqrt(secondNearest);
+  if (secondNearestDistance == 0)
+  {
+    result.second = 1;
+  }
+  else
+  {
+    result.second = nearestDistance / secondNearestDistance;
+  }
+  return result;
+}
+
 template <class TPointSet, class TDistance>
 void KeyPointSetsMatchingFilter<TPointSet, TDistance>::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "UseBackMatching: " << m_UseBackMatching << std::endl;
+  os << indent << "DistanceThreshold: " << m_DistanceThreshold << std::endl;
+  os << indent << "UseKdTree: " << m_UseKdTree << std::endl;
+  os << indent << "MaximumNumberOfChecks: " << m_MaximumNumberOfChecks << std::endl;
+  os << indent << "NumberOfCandidateMatches: " << m_NumberOfCandidateMatches << std::endl;
+  os << indent << "NumberOfMatches: " << m_NumberOfMatches << std::endl;
+  os << indent << "ElapsedMilliseconds: " << m_ElapsedMilliseconds << std::endl;
 }
 
 } // end namespace otb
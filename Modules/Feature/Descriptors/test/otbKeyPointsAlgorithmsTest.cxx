@@ -30,6 +30,7 @@
 #include "otbImageToSURFKeyPointSetFilter.h"
 #include "itkPointSet.h"
 
+#include <random>
 #include <tuple>
 
 using ImageType          = otb::Image<double>;
@@ -159,6 +160,84 @@ bool testMatchingFilter()
 }
 
 
+/** Check that the k-d tree search gives the same matches as the brute
+ * force search, and that the approximate search finds most of them */
+bool testKdTreeMatching()
+{
+  const unsigned int nbPoints  = 2000;
+  const unsigned int dimension = 32;
+
+  // Pointset 2 holds random descriptors, pointset 1 noisy copies of a
+  // part of them
+  std::mt19937                     generator(1234);
+  std::normal_distribution<double> distribution(0., 1.);
+
+  auto ps1 = PointSetType::New();
+  auto ps2 = PointSetType::New();
+  for (unsigned int i = 0; i < nbPoints; ++i)
+  {
+    PointSetType::PointType p;
+    p[0] = i;
+    p[1] = 0.;
+    VectorType d(dimension);
+    for (unsigned int j = 0; j < dimension; ++j)
+    {
+      d[j] = distribution(generator);
+    }
+    ps2->SetPoint(i, p);
+    ps2->SetPointData(i, d);
+  }
+  for (unsigned int i = 0; i < nbPoints / 2; ++i)
+  {
+    PointSetType::PointType p;
+    p[0] = i;
+    p[1] = 1.;
+    VectorType d = ps2->GetPointData()->GetElement((7 * i) % nbPoints);
+    for (unsigned int j = 0; j < dimension; ++j)
+    {
+      d[j] += 0.3 * distribution(generator);
+    }
+    ps1->SetPoint(i, p);
+    ps1->SetPointData(i, d);
+  }
+
+  auto match = [&ps1, &ps2](bool useKdTree, unsigned int maxChecks) {
+    auto filter = MatchingFilterType::New();
+    filter->SetDistanceThreshold(0.8);
+    filter->SetUseBackMatching(true);
+    filter->SetUseKdTree(useKdTree);
+    filter->SetMaximumNumberOfChecks(maxChecks);
+    filter->SetInput1(ps1);
+    filter->SetInput2(ps2);
+    filter->Update();
+    std::cout << "Found " << filter->GetNumberOfMatches() << " matches (" << filter->GetNumberOfCandidateMatches() << " before back matching) in "
+              << filter->GetElapsedMilliseconds() << " ms" << std::endl;
+    return MatchingFilterType::LandmarkListPointerType(filter->GetOutput());
+  };
+
+  std::cout << "Brute force search: ";
+  auto bruteForce = match(false, 0);
+  std::cout << "Exact k-d tree search: ";
+  auto exact = match(true, 0);
+  std::cout << "Approximate k-d tree search: ";
+  auto approximate = match(true, 100);
+
+  bool success = bruteForce->Size() > 0 && exact->Size() == bruteForce->Size();
+  for (unsigned int i = 0; success && i < exact->Size(); ++i)
+  {
+    success = exact->GetNthElement(i)->GetPoint1() == bruteForce->GetNthElement(i)->GetPoint1() &&
+              exact->GetNthElement(i)->GetPoint2() == bruteForce->GetNthElement(i)->GetPoint2() &&
+              exact->GetNthElement(i)->GetLandmarkData() == bruteForce->GetNthElement(i)->GetLandmarkData();
+  }
+  std::cout << "Exact k-d tree search gives the brute force matches:\t" << printResult(success) << std::endl;
+
+  bool test = approximate->Size() >= 0.9 * bruteForce->Size();
+  std::cout << "Approximate k-d tree search finds 90% of the matches:\t" << printResult(test) << std::endl;
+
+  return success && test;
+}
+
+
 /** Generate a pair of images, one being slightly warped wrt the
  * other */
 auto generateImagePair(const std::string& infname, double rotation, double scaling)
@@ -333,6 +412,10 @@ int otbKeyPointsAlgorithmsTest(int argc, char* argv[])
   std::cout << "=========================" << std::endl;
   bool status = testMatchingFilter();
 
+  std::cout << "Checking k-d tree matching:" << std::endl;
+  std::cout << "===========================" << std::endl;
+  status = testKdTreeMatching() && status;
+
   std::tie(reference, secondary, transform) = generateImagePair(infname, rotation, scaling);
 
   std::cout << "Secondary image generated by applying a rotation of " << rotation << " degrees and scaling of " << scaling << "." << std::endl;
@@ -110,6 +110,10 @@ public:
     * cooccurrence is stored is saved in the LookupArrayType.*/
   typedef std::vector<CooccurrencePairType> VectorType;
 
+  /** std::vector holding the frequency of each bin of the first axis, summed
+    * over the second axis. */
+  typedef std::vector<FrequencyType> MarginalVectorType;
+
   /** Get the total frequency of Co-occurrence pairs. */
   itkGetMacro(TotalFrequency, TotalFrequencyType);
 
@@ -119,6 +123,11 @@ public:
   /** Get std::vector containing non-zero co-occurrence pairs */
   VectorType GetVector();
 
+  /** Get the marginal frequencies along the first axis. They are kept up to
+    * date by AddPixelPair and RemovePixelPair, so that they do not have to be
+    * summed again from the co-occurrence pairs. */
+  const MarginalVectorType& GetMarginalFrequencies() const;
+
   /** Initialize the lowerbound and upper bound vecotor, Fill m_LookupArray with
     * -1 and set m_TotalFrequency to zero */
   void Initialize(const unsigned int nbins, const PixelValueType min, const PixelValueType max, const bool symmetry = true);
@@ -127,6 +136,11 @@ public:
   // m_InputImageMaximum. If so add to m_Vector via AddPairToVector method */
   void AddPixelPair(const PixelValueType& pixelvalue1, const PixelValueType& pixelvalue2);
 
+  /** Remove a pixel pair previously added with AddPixelPair. This allows
+   * updating the list when the neighborhood window slides instead of
+   * rebuilding it. Pairs which were rejected by AddPixelPair are ignored. */
+  void RemovePixelPair(const PixelValueType& pixelvalue1, const PixelValueType& pixelvalue2);
+
   /* Get the frequency value from Vector with index =[j,i] */
   RelativeFrequencyType GetFrequency(IndexValueType i, IndexValueType j);
 
@@ -144,6 +158,12 @@ protected:
     * co-occurrence pair is added again with index values swapped */
   void AddPairToVector(IndexType index);
 
+  /** Decrement the frequency of the cooccurrence pair with given index. The
+    * pair is removed from the vector when its frequency reaches zero, the
+    * last element of the vector taking its place. If m_Symmetry is true the
+    * swapped index is removed again */
+  void RemovePairFromVector(IndexType index);
+
   void SetBinMin(const unsigned int dimension, const InstanceIdentifier nbin, PixelValueType min);
 
   void SetBinMax(const unsigned int dimension, const InstanceIdentifier nbin, PixelValueType max);
@@ -163,6 +183,9 @@ private:
   /* std::vector holding actual co-occurrence pairs */
   VectorType m_Vector;
 
+  /* Running marginal frequencies along the first axis */
+  MarginalVectorType m_MarginalFrequencies;
+
   /* Size instance */
   SizeType m_Size;
 
@@ -47,6 +47,8 @@ void GreyLevelCooccurrenceIndexedList<TPixel>::Initialize(const unsigned int nbi
   m_Symmetry    = symmetry;
   m_LookupArray = LookupArrayType(m_Size[0] * m_Size[1]);
   m_LookupArray.Fill(-1);
+  m_Vector.clear();
+  m_MarginalFrequencies.assign(m_Size[0], 0);
   m_TotalFrequency = 0;
 
   // adjust the sizes of min max value containers
@@ -217,6 +219,37 @@ void GreyLevelCooccurrenceIndexedList<TPixel>::AddPixelPair(const PixelValueType
   }
 }
 
+template <class TPixel>
+void GreyLevelCooccurrenceIndexedList<TPixel>::RemovePixelPair(const PixelValueType& pixelvalue1, const PixelValueType& pixelvalue2)
+{
+  // Same rejection rules as in AddPixelPair
+  if (pixelvalue1 < m_InputImageMinimum || pixelvalue1 > m_InputImageMaximum)
+  {
+    return;
+  }
+
+  if (pixelvalue2 < m_InputImageMinimum || pixelvalue2 > m_InputImageMaximum)
+  {
+    return;
+  }
+
+  IndexType     index;
+  PixelPairType ppair(PixelPairSize);
+  ppair[0] = pixelvalue1;
+  ppair[1] = pixelvalue2;
+
+  this->GetIndex(ppair, index);
+  this->RemovePairFromVector(index);
+  if (m_Symmetry)
+  {
+    IndexValueType temp;
+    temp     = index[0];
+    index[0] = index[1];
+    index[1] = temp;
+    this->RemovePairFromVector(index);
+  }
+}
+
 template <class TPixel>
 typename GreyLevelCooccurrenceIndexedList<TPixel>::RelativeFrequencyType GreyLevelCooccurrenceIndexedList<TPixel>::GetFrequency(IndexValueType i,
                                                                                                                                 IndexValueType j)
@@ -253,6 +286,12 @@ typename GreyLevelCooccurrenceIndexedList<TPixel>::VectorType GreyLevelCooccurre
   return m_Vector;
 }
 
+template <class TPixel>
+const typename GreyLevelCooccurrenceIndexedList<TPixel>::MarginalVectorType& GreyLevelCooccurrenceIndexedList<TPixel>::GetMarginalFrequencies() const
+{
+  return m_MarginalFrequencies;
+}
+
 template <class TPixel>
 void GreyLevelCooccurrenceIndexedList<TPixel>::AddPairToVector(IndexType index)
 {
@@ -271,9 +310,38 @@ void GreyLevelCooccurrenceIndexedList<TPixel>::AddPairToVector(IndexType index)
   {
     m_Vector[vindex].second++;
   }
+  m_MarginalFrequencies[index[0]]++;
   m_TotalFrequency = m_TotalFrequency + 1;
 }
 
+template <class TPixel>
+void GreyLevelCooccurrenceIndexedList<TPixel>::RemovePairFromVector(IndexType index)
+{
+  InstanceIdentifier instanceId = index[1] * m_Size[0] + index[0];
+  int                vindex     = m_LookupArray[instanceId];
+  if (vindex < 0)
+  {
+    // This pair was never added
+    return;
+  }
+
+  if (--m_Vector[vindex].second == 0)
+  {
+    // Move the last pair in place of the removed one to keep the vector compact
+    const int lastIndex = static_cast<int>(m_Vector.size()) - 1;
+    if (vindex != lastIndex)
+    {
+      const IndexType lastPairIndex = m_Vector[lastIndex].first;
+      m_LookupArray[lastPairIndex[1] * m_Size[0] + lastPairIndex[0]] = vindex;
+      m_Vector[vindex] = m_Vector[lastIndex];
+    }
+    m_Vector.pop_back();
+    m_LookupArray[instanceId] = -1;
+  }
+  m_MarginalFrequencies[index[0]]--;
+  m_TotalFrequency = m_TotalFrequency - 1;
+}
+
 template <class TPixel>
 void GreyLevelCooccurrenceIndexedList<TPixel>::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
@@ -23,6 +23,7 @@
 
 #include "otbScalarImageToAdvancedTexturesFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkConstNeighborhoodIterator.h"
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
@@ -40,7 +41,8 @@ ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>::ScalarImageToAdv
     m_InputImageMinimum(0),
     m_InputImageMaximum(255),
     m_SubsampleFactor(),
-    m_SubsampleOffset()
+    m_SubsampleOffset(),
+    m_IncrementalCooccurrence(false)
 {
   // There are 10 outputs corresponding to the 9 textures indices
   this->SetNumberOfRequiredOutputs(10);
@@ -283,6 +285,32 @@ void ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>::BeforeThrea
   m_NeighborhoodRadius.Fill(minRadius);
 }
 
+template <class TInputImage, class TOutputImage>
+void ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>::UpdateCooccurrenceList(CooccurrenceIndexedListType* list, const InputRegionType& region, bool remove) const
+{
+  const InputImageType*  inputPtr       = this->GetInput();
+  const InputRegionType& bufferedRegion = inputPtr->GetBufferedRegion();
+
+  itk::ImageRegionConstIteratorWithIndex<InputImageType> it(inputPtr, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const typename InputImageType::IndexType neighborIndex = it.GetIndex() + m_Offset;
+    if (!bufferedRegion.IsInside(neighborIndex))
+    {
+      continue; // don't put a pixel in the co-occurrence list if the value is
+                // out of bounds
+    }
+    if (remove)
+    {
+      list->RemovePixelPair(it.Get(), inputPtr->GetPixel(neighborIndex));
+    }
+    else
+    {
+      list->AddPixelPair(it.Get(), inputPtr->GetPixel(neighborIndex));
+    }
+  }
+}
+
 template <class TInputImage, class TOutputImage>
 void ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const OutputRegionType& outputRegionForThread,
                                                                                           itk::ThreadIdType threadId)
@@ -333,6 +361,11 @@ void ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>::ThreadedGen
   // Set-up progress reporting
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
+  // Co-occurrence list updated along each line in incremental mode
+  CooccurrenceIndexedListPointerType slidingGLCIList = CooccurrenceIndexedListType::New();
+  InputRegionType                    previousRegion;
+  bool                               hasPreviousRegion = false;
+
   // Iterate on outputs to compute textures
   while (!varianceIt.IsAtEnd() && !meanIt.IsAtEnd() && !dissimilarityIt.IsAtEnd() && !sumAverageIt.IsAtEnd() && !sumVarianceIt.IsAtEnd() &&
          !sumEntropytIt.IsAtEnd() && !differenceEntropyIt.IsAtEnd() && !differenceVarianceIt.IsAtEnd() && !ic1It.IsAtEnd() && !ic2It.IsAtEnd())
@@ -359,23 +392,67 @@ void ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>::ThreadedGen
     inputRegion.SetSize(inputSize);
     inputRegion.Crop(inputPtr->GetRequestedRegion());
 
-    CooccurrenceIndexedListPointerType GLCIList = CooccurrenceIndexedListType::New();
-    GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+    CooccurrenceIndexedListPointerType GLCIList;
 
-    typedef itk::ConstNeighborhoodIterator<InputImageType> NeighborhoodIteratorType;
-    NeighborhoodIteratorType                               neighborIt;
-    neighborIt = NeighborhoodIteratorType(m_NeighborhoodRadius, inputPtr, inputRegion);
-    for (neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt)
+    if (m_IncrementalCooccurrence)
     {
-      const InputPixelType centerPixelIntensity = neighborIt.GetCenterPixel();
-      bool                 pixelInBounds;
-      const InputPixelType pixelIntensity = neighborIt.GetPixel(m_Offset, pixelInBounds);
-      if (!pixelInBounds)
+      GLCIList = slidingGLCIList;
+
+      const bool sameRows = hasPreviousRegion && previousRegion.GetIndex(1) == inputRegion.GetIndex(1) &&
+                            previousRegion.GetSize(1) == inputRegion.GetSize(1) && previousRegion.GetIndex(0) <= inputRegion.GetIndex(0);
+
+      if (!sameRows)
+      {
+        // New line: rebuild the co-occurrence list from scratch
+        GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+        this->UpdateCooccurrenceList(GLCIList, inputRegion, false);
+      }
+      else
+      {
+        // The window slid along the line: remove the leaving columns and
+        // add the entering ones
+        const itk::IndexValueType previousFirst = previousRegion.GetIndex(0);
+        const itk::IndexValueType previousLast  = previousFirst + static_cast<itk::IndexValueType>(previousRegion.GetSize(0)) - 1;
+        const itk::IndexValueType first         = inputRegion.GetIndex(0);
+        const itk::IndexValueType last          = first + static_cast<itk::IndexValueType>(inputRegion.GetSize(0)) - 1;
+
+        InputRegionType columns = inputRegion;
+        if (first > previousFirst)
+        {
+          columns.SetIndex(0, previousFirst);
+          columns.SetSize(0, std::min(previousLast, first - 1) - previousFirst + 1);
+          this->UpdateCooccurrenceList(GLCIList, columns, true);
+        }
+        if (last > previousLast)
+        {
+          columns.SetIndex(0, std::max(first, previousLast + 1));
+          columns.SetSize(0, last - columns.GetIndex(0) + 1);
+          this->UpdateCooccurrenceList(GLCIList, columns, false);
+        }
+      }
+      previousRegion    = inputRegion;
+      hasPreviousRegion = true;
+    }
+    else
+    {
+      GLCIList = CooccurrenceIndexedListType::New();
+      GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+
+      typedef itk::ConstNeighborhoodIterator<InputImageType> NeighborhoodIteratorType;
+      NeighborhoodIteratorType                               neighborIt;
+      neighborIt = NeighborhoodIteratorType(m_NeighborhoodRadius, inputPtr, inputRegion);
+      for (neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt)
       {
-        continue; // don't put a pixel in the co-occurrence list if the value is
-                  // out of bounds
+        const InputPixelType centerPixelIntensity = neighborIt.GetCenterPixel();
+        bool                 pixelInBounds;
+        const InputPixelType pixelIntensity = neighborIt.GetPixel(m_Offset, pixelInBounds);
+        if (!pixelInBounds)
+        {
+          continue; // don't put a pixel in the co-occurrence list if the value is
+                    // out of bounds
+        }
+        GLCIList->AddPixelPair(centerPixelIntensity, pixelIntensity);
       }
-      GLCIList->AddPixelPair(centerPixelIntensity, pixelIntensity);
     }
 
     PixelValueType m_Mean               = itk::NumericTraits<PixelValueType>::Zero;
@@ -262,6 +262,18 @@ void ScalarImageToHigherOrderTexturesFilter<TInputImage, TOutputImage>::Threaded
   // Set-up progress reporting
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
+  // Run-length matrices can not be updated when the window slides, but the
+  // local image and the feature calculator are reused from one output pixel
+  // to the next instead of being created for each of them
+  InputImagePointerType localInputImage = InputImageType::New();
+
+  typename ScalarImageToRunLengthFeaturesFilterType::Pointer runLengthFeatureCalculator = ScalarImageToRunLengthFeaturesFilterType::New();
+  runLengthFeatureCalculator->SetInput(localInputImage);
+  runLengthFeatureCalculator->SetOffsets(m_Offsets);
+  runLengthFeatureCalculator->SetNumberOfBinsPerAxis(m_NumberOfBinsPerAxis);
+  runLengthFeatureCalculator->SetPixelValueMinMax(m_InputImageMinimum, m_InputImageMaximum);
+  runLengthFeatureCalculator->SetDistanceValueMinMax(0, maxDistance);
+
   // Iterate on outputs to compute textures
   while (!outputImagesIterators[0].IsAtEnd())
   {
@@ -286,10 +298,13 @@ void ScalarImageToHigherOrderTexturesFilter<TInputImage, TOutputImage>::Threaded
 
     inputRegion.Crop(inputPtr->GetBufferedRegion());
 
-    // Create a local image corresponding to the input region
-    InputImagePointerType localInputImage = InputImageType::New();
-    localInputImage->SetRegions(inputRegion);
-    localInputImage->Allocate();
+    // Fill the local image corresponding to the input region. It is only
+    // reallocated when the window is cropped differently (image borders)
+    if (localInputImage->GetBufferedRegion() != inputRegion)
+    {
+      localInputImage->SetRegions(inputRegion);
+      localInputImage->Allocate();
+    }
     typedef itk::ImageRegionIteratorWithIndex<InputImageType>      ImageRegionIteratorType;
     typedef itk::ImageRegionConstIteratorWithIndex<InputImageType> ImageRegionConstIteratorType;
     ImageRegionConstIteratorType                                   itInputPtr(inputPtr, inputRegion);
@@ -298,13 +313,7 @@ void ScalarImageToHigherOrderTexturesFilter<TInputImage, TOutputImage>::Threaded
     {
       itLocalInputImage.Set(itInputPtr.Get());
     }
-
-    typename ScalarImageToRunLengthFeaturesFilterType::Pointer runLengthFeatureCalculator = ScalarImageToRunLengthFeaturesFilterType::New();
-    runLengthFeatureCalculator->SetInput(localInputImage);
-    runLengthFeatureCalculator->SetOffsets(m_Offsets);
-    runLengthFeatureCalculator->SetNumberOfBinsPerAxis(m_NumberOfBinsPerAxis);
-    runLengthFeatureCalculator->SetPixelValueMinMax(m_InputImageMinimum, m_InputImageMaximum);
-    runLengthFeatureCalculator->SetDistanceValueMinMax(0, maxDistance);
+    localInputImage->Modified();
 
     runLengthFeatureCalculator->Update();
 
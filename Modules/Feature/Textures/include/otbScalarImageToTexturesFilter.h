@@ -135,6 +135,7 @@ public:
   typedef typename CooccurrenceIndexedListType::PixelValueType        PixelValueType;
   typedef typename CooccurrenceIndexedListType::RelativeFrequencyType RelativeFrequencyType;
   typedef typename CooccurrenceIndexedListType::VectorType            VectorType;
+  typedef typename CooccurrenceIndexedListType::MarginalVectorType    MarginalVectorType;
 
   typedef typename VectorType::iterator       VectorIteratorType;
   typedef typename VectorType::const_iterator VectorConstIteratorType;
@@ -180,6 +181,20 @@ public:
   /** Get the sub-sampling offset */
   itkGetMacro(SubsampleOffset, OffsetType);
 
+  /** Set the incremental co-occurrence computation On or Off (Off by
+   *  default). When On, the co-occurrence list is updated when the window
+   *  slides along a line, by removing the leaving columns and adding the
+   *  entering ones, instead of being rebuilt for each output pixel. The
+   *  pairs are then summed in another order: results may differ from the
+   *  default mode by a few ulps */
+  itkSetMacro(IncrementalCooccurrence, bool);
+
+  /** Get the incremental co-occurrence computation flag */
+  itkGetMacro(IncrementalCooccurrence, bool);
+
+  /** Toggle the incremental co-occurrence computation */
+  itkBooleanMacro(IncrementalCooccurrence);
+
   /** Get the energy output image */
   OutputImageType* GetEnergyOutput();
 
@@ -225,6 +240,10 @@ private:
   /** Convenient method to compute union of 2 regions */
   static OutputRegionType RegionUnion(const OutputRegionType& region1, const OutputRegionType& region2);
 
+  /** Add (or remove) the pixel pairs whose first pixel lies in the given
+   *  region to the co-occurrence list */
+  void UpdateCooccurrenceList(CooccurrenceIndexedListType* list, const InputRegionType& region, bool remove) const;
+
   /** Radius of the window on which to compute textures */
   SizeType m_Radius;
 
@@ -254,6 +273,9 @@ private:
 
   /** Sub-sampling offset */
   OffsetType m_SubsampleOffset;
+
+  /** Incremental co-occurrence computation flag */
+  bool m_IncrementalCooccurrence;
 };
 } // End namespace otb
 
@@ -24,10 +24,12 @@
 
 #include "otbScalarImageToTexturesFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkConstNeighborhoodIterator.h"
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
 #include "itkNumericTraits.h"
+#include <algorithm>
 #include <vector>
 #include <cmath>
 
@@ -42,7 +44,8 @@ ScalarImageToTexturesFilter<TInputImage, TOutputImage>::ScalarImageToTexturesFil
     m_InputImageMinimum(0),
     m_InputImageMaximum(255),
     m_SubsampleFactor(),
-    m_SubsampleOffset()
+    m_SubsampleOffset(),
+    m_IncrementalCooccurrence(false)
 {
   // There are 8 outputs corresponding to the 8 textures indices
   this->SetNumberOfRequiredOutputs(8);
@@ -258,6 +261,32 @@ void ScalarImageToTexturesFilter<TInputImage, TOutputImage>::BeforeThreadedGener
   m_NeighborhoodRadius.Fill(minRadius);
 }
 
+template <class TInputImage, class TOutputImage>
+void ScalarImageToTexturesFilter<TInputImage, TOutputImage>::UpdateCooccurrenceList(CooccurrenceIndexedListType* list, const InputRegionType& region, bool remove) const
+{
+  const InputImageType*  inputPtr       = this->GetInput();
+  const InputRegionType& bufferedRegion = inputPtr->GetBufferedRegion();
+
+  itk::ImageRegionConstIteratorWithIndex<InputImageType> it(inputPtr, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const typename InputImageType::IndexType neighborIndex = it.GetIndex() + m_Offset;
+    if (!bufferedRegion.IsInside(neighborIndex))
+    {
+      continue; // don't put a pixel in the co-occurrence list if the value is
+                // out of bounds
+    }
+    if (remove)
+    {
+      list->RemovePixelPair(it.Get(), inputPtr->GetPixel(neighborIndex));
+    }
+    else
+    {
+      list->AddPixelPair(it.Get(), inputPtr->GetPixel(neighborIndex));
+    }
+  }
+}
+
 template <class TInputImage, class TOutputImage>
 void ScalarImageToTexturesFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const OutputRegionType& outputRegionForThread, itk::ThreadIdType threadId)
 {
@@ -299,6 +328,11 @@ void ScalarImageToTexturesFilter<TInputImage, TOutputImage>::ThreadedGenerateDat
   // Set-up progress reporting
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
+  // Co-occurrence list updated along each line in incremental mode
+  CooccurrenceIndexedListPointerType slidingGLCIList = CooccurrenceIndexedListType::New();
+  InputRegionType                    previousRegion;
+  bool                               hasPreviousRegion = false;
+
   // Iterate on outputs to compute textures
   while (!energyIt.IsAtEnd() && !entropyIt.IsAtEnd() && !correlationIt.IsAtEnd() && !invDiffMomentIt.IsAtEnd() && !inertiaIt.IsAtEnd() &&
          !clusterShadeIt.IsAtEnd() && !clusterProminenceIt.IsAtEnd() && !haralickCorIt.IsAtEnd())
@@ -325,23 +359,67 @@ void ScalarImageToTexturesFilter<TInputImage, TOutputImage>::ThreadedGenerateDat
     inputRegion.SetSize(inputSize);
     inputRegion.Crop(inputPtr->GetRequestedRegion());
 
-    CooccurrenceIndexedListPointerType GLCIList = CooccurrenceIndexedListType::New();
-    GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+    CooccurrenceIndexedListPointerType GLCIList;
 
-    typedef itk::ConstNeighborhoodIterator<InputImageType> NeighborhoodIteratorType;
-    NeighborhoodIteratorType                               neighborIt;
-    neighborIt = NeighborhoodIteratorType(m_NeighborhoodRadius, inputPtr, inputRegion);
-    for (neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt)
+    if (m_IncrementalCooccurrence)
     {
-      const InputPixelType centerPixelIntensity = neighborIt.GetCenterPixel();
-      bool                 pixelInBounds;
-      const InputPixelType pixelIntensity = neighborIt.GetPixel(m_Offset, pixelInBounds);
-      if (!pixelInBounds)
+      GLCIList = slidingGLCIList;
+
+      const bool sameRows = hasPreviousRegion && previousRegion.GetIndex(1) == inputRegion.GetIndex(1) &&
+                            previousRegion.GetSize(1) == inputRegion.GetSize(1) && previousRegion.GetIndex(0) <= inputRegion.GetIndex(0);
+
+      if (!sameRows)
+      {
+        // New line: rebuild the co-occurrence list from scratch
+        GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+        this->UpdateCooccurrenceList(GLCIList, inputRegion, false);
+      }
+      else
+      {
+        // The window slid along the line: remove the leaving columns and
+        // add the entering ones
+        const itk::IndexValueType previousFirst = previousRegion.GetIndex(0);
+        const itk::IndexValueType previousLast  = previousFirst + static_cast<itk::IndexValueType>(previousRegion.GetSize(0)) - 1;
+        const itk::IndexValueType first         = inputRegion.GetIndex(0);
+        const itk::IndexValueType last          = first + static_cast<itk::IndexValueType>(inputRegion.GetSize(0)) - 1;
+
+        InputRegionType columns = inputRegion;
+        if (first > previousFirst)
+        {
+          columns.SetIndex(0, previousFirst);
+          columns.SetSize(0, std::min(previousLast, first - 1) - previousFirst + 1);
+          this->UpdateCooccurrenceList(GLCIList, columns, true);
+        }
+        if (last > previousLast)
+        {
+          columns.SetIndex(0, std::max(first, previousLast + 1));
+          columns.SetSize(0, last - columns.GetIndex(0) + 1);
+          this->UpdateCooccurrenceList(GLCIList, columns, false);
+        }
+      }
+      previousRegion    = inputRegion;
+      hasPreviousRegion = true;
+    }
+    else
+    {
+      GLCIList = CooccurrenceIndexedListType::New();
+      GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+
+      typedef itk::ConstNeighborhoodIterator<InputImageType> NeighborhoodIteratorType;
+      NeighborhoodIteratorType                               neighborIt;
+      neighborIt = NeighborhoodIteratorType(m_NeighborhoodRadius, inputPtr, inputRegion);
+      for (neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt)
       {
-        continue; // don't put a pixel in the co-occurrence list if the value is
-                  // out of bounds
+        const InputPixelType centerPixelIntensity = neighborIt.GetCenterPixel();
+        bool                 pixelInBounds;
+        const InputPixelType pixelIntensity = neighborIt.GetPixel(m_Offset, pixelInBounds);
+        if (!pixelInBounds)
+        {
+          continue; // don't put a pixel in the co-occurrence list if the value is
+                    // out of bounds
+        }
+        GLCIList->AddPixelPair(centerPixelIntensity, pixelIntensity);
       }
-      GLCIList->AddPixelPair(centerPixelIntensity, pixelIntensity);
     }
 
     double pixelMean = 0.;
@@ -349,22 +427,18 @@ void ScalarImageToTexturesFilter<TInputImage, TOutputImage>::ThreadedGenerateDat
     double marginalDevSquared = 0.;
     double pixelVariance      = 0.;
 
-    // Create and Initialize marginalSums
-    std::vector<double> marginalSums(m_NumberOfBinsPerAxis, 0);
-
     // get co-occurrence vector and totalfrequency
     VectorType glcVector      = GLCIList->GetVector();
     double     totalFrequency = static_cast<double>(GLCIList->GetTotalFrequency());
 
-    // Normalize the co-occurrence indexed list and compute mean, marginalSum
-    typename VectorType::iterator it = glcVector.begin();
-    while (it != glcVector.end())
+    // The marginal sums are maintained by the co-occurrence list while pairs
+    // are added and removed, normalize them and compute the mean
+    const MarginalVectorType& marginalFrequencies = GLCIList->GetMarginalFrequencies();
+    std::vector<double>       marginalSums(m_NumberOfBinsPerAxis, 0);
+    for (unsigned int bin = 0; bin < m_NumberOfBinsPerAxis; ++bin)
     {
-      double                frequency = (*it).second / totalFrequency;
-      CooccurrenceIndexType index     = (*it).first;
-      pixelMean += index[0] * frequency;
-      marginalSums[index[0]] += frequency;
-      ++it;
+      marginalSums[bin] = marginalFrequencies[bin] / totalFrequency;
+      pixelMean += bin * marginalSums[bin];
     }
 
     /* Now get the mean and deviaton of the marginal sums.
@@ -393,14 +467,9 @@ void ScalarImageToTexturesFilter<TInputImage, TOutputImage>::ThreadedGenerateDat
     }
     marginalDevSquared = marginalDevSquared / m_NumberOfBinsPerAxis;
 
-    VectorConstIteratorType constVectorIt;
-    constVectorIt = glcVector.begin();
-    while (constVectorIt != glcVector.end())
+    for (unsigned int bin = 0; bin < m_NumberOfBinsPerAxis; ++bin)
     {
-      RelativeFrequencyType frequency = (*constVectorIt).second / totalFrequency;
-      CooccurrenceIndexType index     = (*constVectorIt).first;
-      pixelVariance += (index[0] - pixelMean) * (index[0] - pixelMean) * frequency;
-      ++constVectorIt;
+      pixelVariance += (bin - pixelMean) * (bin - pixelMean) * marginalSums[bin];
     }
 
     double pixelVarianceSquared = pixelVariance * pixelVariance;
@@ -423,7 +492,7 @@ void ScalarImageToTexturesFilter<TInputImage, TOutputImage>::ThreadedGenerateDat
     PixelValueType haralickCorrelation     = itk::NumericTraits<PixelValueType>::Zero;
 
     // Compute textures
-    constVectorIt = glcVector.begin();
+    VectorConstIteratorType constVectorIt = glcVector.begin();
     while (constVectorIt != glcVector.end())
     {
       CooccurrenceIndexType index     = (*constVectorIt).first;
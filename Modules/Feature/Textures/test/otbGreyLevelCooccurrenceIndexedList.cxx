@@ -184,6 +184,18 @@ int otbGreyLevelCooccurrenceIndexedList(int, char* [])
     {
       fvector.push_back((*it).second);
     }
+
+    // the running marginal frequencies must match the ones summed from the list
+    std::vector<FrequencyType> marginals(8, 0);
+    for (it = vector.begin(); it != vector.end(); ++it)
+    {
+      marginals[(*it).first[0]] += (*it).second;
+    }
+    if (marginals != cooccurrenceObj2->GetMarginalFrequencies())
+    {
+      std::cerr << "Running marginal frequencies differ from the co-occurrence list at index " << imageItWithIndex.GetIndex() << std::endl;
+      passed = false;
+    }
     ++imageItWithIndex;
   }
 
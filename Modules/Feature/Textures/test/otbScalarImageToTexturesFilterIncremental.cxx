@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "itkMacro.h"
+
+#include "otbScalarImageToTexturesFilter.h"
+#include "otbScalarImageToAdvancedTexturesFilter.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbImageFileWriter.h"
+#include "otbStopwatch.h"
+
+namespace
+{
+const unsigned int Dimension = 2;
+typedef float      PixelType;
+typedef otb::Image<PixelType, Dimension> ImageType;
+typedef otb::ImageFileReader<ImageType> ReaderType;
+typedef otb::ImageFileWriter<ImageType> WriterType;
+
+// Compute the textures with the given co-occurrence mode, write each output
+// as <outprefix><i>.tif and return the elapsed time
+template <class TFilter>
+otb::Stopwatch::DurationType ComputeTextures(ImageType* input, const std::string& outprefix, unsigned int nbBins, unsigned int radius, int offsetx,
+                                             int offsety, bool incremental)
+{
+  typename TFilter::Pointer filter = TFilter::New();
+
+  typename TFilter::SizeType sradius;
+  sradius.Fill(radius);
+
+  typename TFilter::OffsetType offset;
+  offset[0] = offsetx;
+  offset[1] = offsety;
+
+  filter->SetInput(input);
+  filter->SetRadius(sradius);
+  filter->SetOffset(offset);
+  filter->SetNumberOfBinsPerAxis(nbBins);
+  filter->SetInputImageMinimum(0);
+  filter->SetInputImageMaximum(255);
+  filter->SetIncrementalCooccurrence(incremental);
+
+  otb::Stopwatch chrono = otb::Stopwatch::StartNew();
+  filter->Update();
+  chrono.Stop();
+
+  WriterType::Pointer writer = WriterType::New();
+  for (unsigned int i = 0; i < filter->GetNumberOfOutputs(); ++i)
+  {
+    std::ostringstream oss;
+    oss << outprefix << i << ".tif";
+    writer->SetInput(filter->GetOutput(i));
+    writer->SetFileName(oss.str());
+    writer->Update();
+  }
+
+  return chrono.GetElapsedMilliseconds();
+}
+
+template <class TFilter>
+int CompareIncrementalAndPerPixelTextures(int argc, char* argv[])
+{
+  if (argc != 8)
+  {
+    std::cerr << "Usage: " << argv[0] << " infname outprefix1 outprefix2 nbBins radius offsetx offsety" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char*        infname    = argv[1];
+  const char*        outprefix1 = argv[2];
+  const char*        outprefix2 = argv[3];
+  const unsigned int nbBins     = atoi(argv[4]);
+  const unsigned int radius     = atoi(argv[5]);
+  const int          offsetx    = atoi(argv[6]);
+  const int          offsety    = atoi(argv[7]);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(infname);
+  reader->Update();
+
+  std::cout << "Per-pixel co-occurrence computation took "
+            << ComputeTextures<TFilter>(reader->GetOutput(), outprefix1, nbBins, radius, offsetx, offsety, false) << " ms." << std::endl;
+
+  std::cout << "Incremental co-occurrence computation took "
+            << ComputeTextures<TFilter>(reader->GetOutput(), outprefix2, nbBins, radius, offsetx, offsety, true) << " ms." << std::endl;
+
+  return EXIT_SUCCESS;
+}
+}
+
+int otbScalarImageToTexturesFilterIncremental(int argc, char* argv[])
+{
+  return CompareIncrementalAndPerPixelTextures<otb::ScalarImageToTexturesFilter<ImageType, ImageType>>(argc, argv);
+}
+
+int otbScalarImageToAdvancedTexturesFilterIncremental(int argc, char* argv[])
+{
+  return CompareIncrementalAndPerPixelTextures<otb::ScalarImageToAdvancedTexturesFilter<ImageType, ImageType>>(argc, argv);
+}
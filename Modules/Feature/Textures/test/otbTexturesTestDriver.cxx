@@ -29,4 +29,6 @@ void RegisterTests()
   REGISTER_TEST(otbSFSTexturesImageFilterTest);
   REGISTER_TEST(otbScalarImageToAdvancedTexturesFilter);
   REGISTER_TEST(otbScalarImageToPanTexTextureFilter);
+  REGISTER_TEST(otbScalarImageToTexturesFilterIncremental);
+  REGISTER_TEST(otbScalarImageToAdvancedTexturesFilterIncremental);
 }
@@ -23,7 +23,7 @@
 
 #include "itkImageToImageFilter.h"
 #include "otbStreamingWarpImageFilter.h"
-#include "itkTransformToDisplacementFieldSource.h"
+#include "otbApproximateTransformToDisplacementFieldSource.h"
 #include "itkLinearInterpolateImageFunction.h"
 #include "otbImage.h"
 #include "itkVector.h"
@@ -47,6 +47,14 @@ namespace otb
  * the  interpolator (SetInterpolator()) and the origin (SetOrigin())
  * can be set using the method between brackets.
  *
+ * When an approximation tolerance is set (SetApproximationTolerance()),
+ * the displacement grid is generated with an
+ * otb::ApproximateTransformToDisplacementFieldSource: the transform is
+ * evaluated exactly on a sparse, adaptively refined set of grid nodes and
+ * interpolated elsewhere, as long as the interpolation error stays below
+ * the tolerance. This saves most of the transform evaluations when the
+ * transform is expensive, as sensor models are.
+ *
  *
  *
  * \ingroup Projection
@@ -83,7 +91,7 @@ public:
   typedef StreamingWarpImageFilter<InputImageType, OutputImageType, DisplacementFieldType> WarpImageFilterType;
 
   /** Internal filters typedefs*/
-  typedef itk::TransformToDisplacementFieldSource<DisplacementFieldType, double> DisplacementFieldGeneratorType;
+  typedef ApproximateTransformToDisplacementFieldSource<DisplacementFieldType, double> DisplacementFieldGeneratorType;
   typedef typename DisplacementFieldGeneratorType::TransformType TransformType;
   typedef typename DisplacementFieldGeneratorType::SizeType      SizeType;
   typedef typename DisplacementFieldGeneratorType::SpacingType   SpacingType;
@@ -159,6 +167,22 @@ public:
     m_DisplacementFilter->SetNumberOfThreads(nbThread);
   }
 
+  /** Maximum error allowed when approximating the transform on the
+   * displacement grid, in pixels of the input image. 0 (the default)
+   * means that the transform is evaluated at every grid node. */
+  itkSetMacro(ApproximationTolerance, double);
+  itkGetConstMacro(ApproximationTolerance, double);
+
+  /** Largest approximation error measured while generating the
+   * displacement grid during the last update, in pixels of the input image */
+  double GetMaximumApproximationError() const;
+
+  /** Number of exact transform evaluations during the last update */
+  unsigned long GetNumberOfTransformEvaluations() const
+  {
+    return m_DisplacementFilter->GetNumberOfTransformEvaluations();
+  }
+
   /** Override itk::ProcessObject method to let the internal filter do the propagation */
   void PropagateRequestedRegion(itk::DataObject* output) override;
 
@@ -182,6 +206,9 @@ private:
   // spacing
   SpacingType m_SignedOutputSpacing;
 
+  // Approximation tolerance, in input pixels
+  double m_ApproximationTolerance;
+
   typename DisplacementFieldGeneratorType::Pointer m_DisplacementFilter;
   typename WarpImageFilterType::Pointer            m_WarpFilter;
 };
@@ -24,12 +24,14 @@
 #include "otbStreamingResampleImageFilter.h"
 #include "itkProgressAccumulator.h"
 #include "otbImage.h"
+#include <algorithm>
+#include <cmath>
 
 namespace otb
 {
 
 template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
-StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::StreamingResampleImageFilter()
+StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::StreamingResampleImageFilter() : m_ApproximationTolerance(0.)
 {
   // internal filters instantiation
   m_DisplacementFilter  = DisplacementFieldGeneratorType::New();
@@ -88,6 +90,14 @@ void StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecis
   m_DisplacementFilter->SetOutputSize(displacementFieldLargestSize);
   m_DisplacementFilter->SetOutputIndex(this->GetOutputStartIndex());
 
+  // Convert the approximation tolerance from input pixels to physical units
+  double inputPixelSize = 1.;
+  if (this->GetInput())
+  {
+    inputPixelSize = std::min(std::abs(this->GetInput()->GetSpacing()[0]), std::abs(this->GetInput()->GetSpacing()[1]));
+  }
+  m_DisplacementFilter->SetMaximumError(m_ApproximationTolerance > 0. ? m_ApproximationTolerance * inputPixelSize : 0.);
+
   m_WarpFilter->SetInput(this->GetInput());
   m_WarpFilter->GraftOutput(this->GetOutput());
   m_WarpFilter->UpdateOutputInformation();
@@ -141,6 +151,17 @@ void StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecis
   this->Modified();
 }
 
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+double StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::GetMaximumApproximationError() const
+{
+  if (m_DisplacementFilter->GetMaximumError() <= 0. || m_ApproximationTolerance <= 0.)
+  {
+    return 0.;
+  }
+  // The displacement filter tolerance is the input tolerance scaled by the input pixel size
+  return m_DisplacementFilter->GetMaximumApproximationError() * m_ApproximationTolerance / m_DisplacementFilter->GetMaximumError();
+}
+
 template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
 void StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
@@ -149,6 +170,7 @@ void StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecis
   os << indent << "OutputSpacing: " << this->GetOutputSpacing() << std::endl;
   os << indent << "OutputStartIndex: " << this->GetOutputStartIndex() << std::endl;
   os << indent << "OutputSize: " << this->GetOutputSize() << std::endl;
+  os << indent << "ApproximationTolerance: " << m_ApproximationTolerance << std::endl;
 }
 }
 #endif
@@ -40,6 +40,9 @@ namespace otb
  *
  * (http://www.isprs.org/proceedings/XXXV/congress/comm2/papers/110.pdf)
  *
+ * The local mean and variance are computed by a LocalMomentsCalculator.
+ * The weighted sum is still computed over the whole window.
+ *
  * \ingroup OTBImageNoise
  */
 
@@ -23,6 +23,8 @@
 
 #include "otbFrostImageFilter.h"
 
+#include "otbLocalMomentsCalculator.h"
+
 #include "itkDataObject.h"
 #include "itkConstNeighborhoodIterator.h"
 #include "itkNeighborhoodInnerProduct.h"
@@ -31,6 +33,8 @@
 #include "itkOffset.h"
 #include "itkProgressReporter.h"
 
+#include <vector>
+
 namespace otb
 {
 
@@ -95,7 +99,6 @@ void FrostImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
 template <class TInputImage, class TOutputImage>
 void FrostImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId)
 {
-  unsigned int                                                        i;
   itk::ZeroFluxNeumannBoundaryCondition<InputImageType>               nbc;
   itk::ConstNeighborhoodIterator<InputImageType>                      bit;
   typename itk::ConstNeighborhoodIterator<InputImageType>::OffsetType off;
@@ -105,6 +108,10 @@ void FrostImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const Out
   typename OutputImageType::Pointer     output = this->GetOutput();
   typename InputImageType::ConstPointer input  = this->GetInput();
 
+  // Local mean and variance of all the windows centered in the region
+  LocalMomentsCalculator<InputImageType> moments;
+  moments.Compute(input, outputRegionForThread, m_Radius);
+
   // Find the data-set boundary "faces"
   typename itk::NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<InputImageType>::FaceListType           faceList;
   typename itk::NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<InputImageType>::FaceListType::iterator fit;
@@ -115,9 +122,6 @@ void FrostImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const Out
   // support progress methods/callbacks
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
-  InputRealType sum;
-  InputRealType sum2;
-
   double Mean, Variance;
   double Alpha;
   double NormFilter;
@@ -125,36 +129,46 @@ void FrostImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const Out
   double CoefFilter;
   double dPixel;
 
+  const int rad_x = m_Radius[0];
+  const int rad_y = m_Radius[1];
+
+  // Distance to the center of each pixel of the neighborhood, in the order
+  // of the weighted sum
+  std::vector<double> distances;
+  for (int x = -rad_x; x <= rad_x; ++x)
+  {
+    for (int y = -rad_y; y <= rad_y; ++y)
+    {
+      distances.push_back(std::sqrt(static_cast<double>(x * x + y * y)));
+    }
+  }
+  std::vector<unsigned int> neighbors;
+
   // Process each of the boundary faces.  These are N-d regions which border
   // the edge of the buffer.
   for (fit = faceList.begin(); fit != faceList.end(); ++fit)
   {
-    bit                           = itk::ConstNeighborhoodIterator<InputImageType>(m_Radius, input, *fit);
-    unsigned int neighborhoodSize = bit.Size();
-    it                            = itk::ImageRegionIterator<OutputImageType>(output, *fit);
+    bit = itk::ConstNeighborhoodIterator<InputImageType>(m_Radius, input, *fit);
+    it  = itk::ImageRegionIterator<OutputImageType>(output, *fit);
     bit.OverrideBoundaryCondition(&nbc);
 
+    neighbors.clear();
+    for (int x = -rad_x; x <= rad_x; ++x)
+    {
+      for (int y = -rad_y; y <= rad_y; ++y)
+      {
+        off[0] = x;
+        off[1] = y;
+        neighbors.push_back(bit.GetNeighborhoodIndex(off));
+      }
+    }
+
     bit.GoToBegin();
     it.GoToBegin();
 
     while (!bit.IsAtEnd())
     {
-      sum  = itk::NumericTraits<InputRealType>::Zero;
-      sum2 = itk::NumericTraits<InputRealType>::Zero;
-
-      for (i = 0; i < neighborhoodSize; ++i)
-      {
-        dPixel = static_cast<double>(bit.GetPixel(i));
-        sum += dPixel;
-      }
-      Mean = sum / static_cast<double>(neighborhoodSize);
-
-      for (i = 0; i < neighborhoodSize; ++i)
-      {
-        dPixel = static_cast<double>(bit.GetPixel(i));
-        sum2 += (dPixel - Mean) * (dPixel - Mean);
-      }
-      Variance = sum2 / double(neighborhoodSize - 1);
+      moments.Evaluate(bit.GetIndex(), Mean, Variance);
 
       const double epsilon = 0.0000000001;
       if (std::abs(Mean) < epsilon)
@@ -172,23 +186,13 @@ void FrostImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const Out
         NormFilter  = 0.0;
         FrostFilter = 0.0;
 
-        const int rad_x = m_Radius[0];
-        const int rad_y = m_Radius[1];
-
-        for (int x = -rad_x; x <= rad_x; ++x)
+        for (unsigned int i = 0; i < neighbors.size(); ++i)
         {
-          for (int y = -rad_y; y <= rad_y; ++y)
-          {
-            double Dist = std::sqrt(static_cast<double>(x * x + y * y));
-            off[0]      = x;
-            off[1]      = y;
-
-            dPixel = static_cast<double>(bit.GetPixel(off));
-
-            CoefFilter = std::exp(-Alpha * Dist);
-            NormFilter += CoefFilter;
-            FrostFilter += (CoefFilter * dPixel);
-          }
+          dPixel = static_cast<double>(bit.GetPixel(neighbors[i]));
+
+          CoefFilter = std::exp(-Alpha * distances[i]);
+          NormFilter += CoefFilter;
+          FrostFilter += (CoefFilter * dPixel);
         }
 
         dPixel = FrostFilter / NormFilter;
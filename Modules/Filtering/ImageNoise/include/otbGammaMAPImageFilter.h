@@ -36,6 +36,9 @@ namespace otb
  *
  * (http://www.isprs.org/proceedings/XXXV/congress/comm2/papers/110.pdf)
  *
+ * The local mean and variance are computed by a LocalMomentsCalculator,
+ * so the cost of the filter does not depend on the radius.
+ *
  * \ingroup OTBImageNoise
  */
 
@@ -23,12 +23,11 @@
 
 #include "otbGammaMAPImageFilter.h"
 
+#include "otbLocalMomentsCalculator.h"
+
 #include "itkDataObject.h"
-#include "itkConstNeighborhoodIterator.h"
-#include "itkNeighborhoodInnerProduct.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIterator.h"
-#include "itkNeighborhoodAlgorithm.h"
-#include "itkOffset.h"
 #include "itkProgressReporter.h"
 
 namespace otb
@@ -95,109 +94,66 @@ void GammaMAPImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegio
 template <class TInputImage, class TOutputImage>
 void GammaMAPImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId)
 {
-  unsigned int                                          i;
-  itk::ZeroFluxNeumannBoundaryCondition<InputImageType> nbc;
-
-  itk::ConstNeighborhoodIterator<InputImageType> bit;
-  itk::ImageRegionIterator<OutputImageType>      it;
-
   typename OutputImageType::Pointer     output = this->GetOutput();
   typename InputImageType::ConstPointer input  = this->GetInput();
 
-  // Find the data-set boundary "faces"
-  typename itk::NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<InputImageType>::FaceListType           faceList;
-  typename itk::NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<InputImageType>::FaceListType::iterator fit;
+  // Local mean and variance of all the windows centered in the region
+  LocalMomentsCalculator<InputImageType> moments;
+  moments.Compute(input, outputRegionForThread, m_Radius);
 
-  itk::NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<InputImageType> bC;
-  faceList = bC(input, outputRegionForThread, m_Radius);
+  itk::ImageRegionConstIteratorWithIndex<InputImageType> bit(input, outputRegionForThread);
+  itk::ImageRegionIterator<OutputImageType>              it(output, outputRegionForThread);
 
   // support progress methods/callbacks
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
-  //  InputRealType pixel;
-  InputRealType sum;
-  InputRealType sum2;
-
   double Ci, Ci2, Cu, Cu2, E_I, I, Var_I, dPixel, alpha, b, d, Cmax;
 
   // Compute the ratio using the number of looks
   Cu2 = 1.0 / m_NbLooks;
   Cu  = std::sqrt(Cu2);
 
-  // Process each of the boundary faces.  These are N-d regions which border
-  // the edge of the buffer.
-  for (fit = faceList.begin(); fit != faceList.end(); ++fit)
+  for (bit.GoToBegin(), it.GoToBegin(); !bit.IsAtEnd(); ++bit, ++it)
   {
-    bit                                 = itk::ConstNeighborhoodIterator<InputImageType>(m_Radius, input, *fit);
-    const unsigned int neighborhoodSize = bit.Size();
-    it                                  = itk::ImageRegionIterator<OutputImageType>(output, *fit);
-    bit.OverrideBoundaryCondition(&nbc);
+    moments.Evaluate(bit.GetIndex(), E_I, Var_I);
 
-    bit.GoToBegin();
-    it.GoToBegin();
+    I = static_cast<double>(bit.Get());
 
+    Ci2 = Var_I / (E_I * E_I);
+    Ci  = std::sqrt(Ci2);
 
-    while (!bit.IsAtEnd())
+    const double epsilon = 0.0000000001;
+    if (std::abs(E_I) < epsilon)
     {
-      sum  = itk::NumericTraits<InputRealType>::Zero;
-      sum2 = itk::NumericTraits<InputRealType>::Zero;
-
-      // Parcours du voisinage
-      for (i = 0; i < neighborhoodSize; ++i)
-      {
-        dPixel = static_cast<double>(bit.GetPixel(i));
-        sum += dPixel;
-      }
-      E_I = sum / static_cast<double>(neighborhoodSize);
-
-      for (i = 0; i < neighborhoodSize; ++i)
-      {
-        dPixel = static_cast<double>(bit.GetPixel(i));
-        sum2 += (dPixel - E_I) * (dPixel - E_I);
-      }
-      Var_I = sum2 / static_cast<double>(neighborhoodSize - 1);
-
-      I = static_cast<double>(bit.GetCenterPixel());
-
-      Ci2 = Var_I / (E_I * E_I);
-      Ci  = std::sqrt(Ci2);
+      dPixel = itk::NumericTraits<OutputPixelType>::Zero;
+    }
+    else if (std::abs(Var_I) < epsilon)
+    {
+      dPixel = E_I;
+    }
+    else if (Ci2 < Cu2)
+    {
+      dPixel = E_I;
+    }
+    else
+    {
+      Cmax = std::sqrt(2.0) * Cu;
 
-      const double epsilon = 0.0000000001;
-      if (std::abs(E_I) < epsilon)
+      if (Ci < Cmax)
       {
-        dPixel = itk::NumericTraits<OutputPixelType>::Zero;
-      }
-      else if (std::abs(Var_I) < epsilon)
-      {
-        dPixel = E_I;
-      }
-      else if (Ci2 < Cu2)
-      {
-        dPixel = E_I;
+        alpha  = (1 + Cu2) / (Ci2 - Cu2);
+        b      = alpha - m_NbLooks - 1;
+        d      = E_I * E_I * b * b + 4 * alpha * m_NbLooks * E_I * I;
+        dPixel = (b * E_I + std::sqrt(d)) / (2 * alpha);
       }
       else
-      {
-        Cmax = std::sqrt(2.0) * Cu;
-
-        if (Ci < Cmax)
-        {
-          alpha  = (1 + Cu2) / (Ci2 - Cu2);
-          b      = alpha - m_NbLooks - 1;
-          d      = E_I * E_I * b * b + 4 * alpha * m_NbLooks * E_I * I;
-          dPixel = (b * E_I + std::sqrt(d)) / (2 * alpha);
-        }
-        else
-          dPixel = I;
-      }
-
-      // set the weighted value
-      it.Set(static_cast<OutputPixelType>(dPixel));
+        dPixel = I;
+    }
 
-      ++bit;
-      ++it;
+    // set the weighted value
+    it.Set(static_cast<OutputPixelType>(dPixel));
 
-      progress.CompletedPixel();
-    }
+    progress.CompletedPixel();
   }
 }
 
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbLocalMomentsCalculator_h
+#define otbLocalMomentsCalculator_h
+
+#include <vector>
+
+namespace otb
+{
+
+/** \class LocalMomentsCalculator
+ * \brief Local mean and variance over sliding windows, from summed-area tables
+ *
+ * Compute() builds summed-area tables of the pixel values and of their
+ * squares over a region padded by the window radius. The mean and variance
+ * of any window centered in the region are then obtained in constant time,
+ * whatever the window size.
+ *
+ * Pixels outside the buffered region of the image are replaced by the
+ * nearest buffered pixel, as done by the itk::ZeroFluxNeumannBoundaryCondition
+ * used with neighborhood iterators.
+ *
+ * Sums are accumulated in double, after subtracting the value of a pixel of
+ * the region from every pixel. This keeps the sums small and avoids the
+ * cancellation of the E[I^2] - E[I]^2 formula, and keeps the sums exact
+ * for integer valued images.
+ *
+ * This class is not thread safe: each thread must use its own instance.
+ * Only 2D images are supported.
+ *
+ * \ingroup OTBImageNoise
+ */
+template <class TInputImage>
+class LocalMomentsCalculator
+{
+public:
+  typedef TInputImage                         InputImageType;
+  typedef typename InputImageType::RegionType RegionType;
+  typedef typename InputImageType::SizeType   SizeType;
+  typedef typename InputImageType::IndexType  IndexType;
+
+  static_assert(InputImageType::ImageDimension == 2, "LocalMomentsCalculator only supports 2D images");
+
+  LocalMomentsCalculator();
+
+  /** Build the tables for windows of the given radius centered on the
+   * pixels of region. Region must be inside the largest possible region of
+   * the image. */
+  void Compute(const InputImageType* image, const RegionType& region, const SizeType& radius);
+
+  /** Number of pixels of a window */
+  unsigned long GetWindowSize() const
+  {
+    return m_WindowSize;
+  }
+
+  /** Mean and unbiased variance of the window centered on index, which
+   * must be inside the region given to Compute() */
+  void Evaluate(const IndexType& index, double& mean, double& variance) const;
+
+private:
+  /** First pixel of the padded region */
+  IndexType m_Origin;
+  SizeType  m_Radius;
+
+  /** Row length of the tables (padded region width + 1) */
+  unsigned long m_Stride;
+  unsigned long m_WindowSize;
+
+  /** Value subtracted from all pixels before summation */
+  double m_Offset;
+
+  std::vector<double> m_Sum;
+  std::vector<double> m_SumOfSquares;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbLocalMomentsCalculator.hxx"
+#endif
+
+#endif
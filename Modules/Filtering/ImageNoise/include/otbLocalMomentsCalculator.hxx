@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbLocalMomentsCalculator_hxx
+#define otbLocalMomentsCalculator_hxx
+
+#include "otbLocalMomentsCalculator.h"
+#include <algorithm>
+
+namespace otb
+{
+
+template <class TInputImage>
+LocalMomentsCalculator<TInputImage>::LocalMomentsCalculator() : m_Stride(0), m_WindowSize(0), m_Offset(0.)
+{
+  m_Origin.Fill(0);
+  m_Radius.Fill(0);
+}
+
+template <class TInputImage>
+void LocalMomentsCalculator<TInputImage>::Compute(const InputImageType* image, const RegionType& region, const SizeType& radius)
+{
+  const RegionType& buffered   = image->GetBufferedRegion();
+  const IndexType   bufIndex   = buffered.GetIndex();
+  const SizeType    bufSize    = buffered.GetSize();
+  const auto*       buffer     = image->GetBufferPointer();
+  const long        lastColumn = bufSize[0] - 1;
+  const long        lastRow    = bufSize[1] - 1;
+
+  m_Radius = radius;
+  for (unsigned int d = 0; d < 2; ++d)
+  {
+    m_Origin[d] = region.GetIndex()[d] - static_cast<long>(radius[d]);
+  }
+  m_WindowSize = (2 * radius[0] + 1) * (2 * radius[1] + 1);
+
+  const unsigned long width  = region.GetSize()[0] + 2 * radius[0];
+  const unsigned long height = region.GetSize()[1] + 2 * radius[1];
+  m_Stride                   = width + 1;
+
+  // Buffer column of each column of the padded region (zero flux Neumann)
+  std::vector<long> columns(width);
+  for (unsigned long i = 0; i < width; ++i)
+  {
+    columns[i] = std::min(std::max(m_Origin[0] + static_cast<long>(i) - bufIndex[0], 0L), lastColumn);
+  }
+
+  // Subtract the value of the center pixel of the region
+  long centerColumn = std::min(std::max(region.GetIndex()[0] + static_cast<long>(region.GetSize()[0] / 2) - bufIndex[0], 0L), lastColumn);
+  long centerRow    = std::min(std::max(region.GetIndex()[1] + static_cast<long>(region.GetSize()[1] / 2) - bufIndex[1], 0L), lastRow);
+  m_Offset          = static_cast<double>(buffer[centerRow * bufSize[0] + centerColumn]);
+
+  m_Sum.assign(m_Stride * (height + 1), 0.);
+  m_SumOfSquares.assign(m_Stride * (height + 1), 0.);
+
+  for (unsigned long j = 0; j < height; ++j)
+  {
+    const long  row    = std::min(std::max(m_Origin[1] + static_cast<long>(j) - bufIndex[1], 0L), lastRow);
+    const auto* rowPtr = buffer + row * bufSize[0];
+
+    const double* prevSum  = &m_Sum[j * m_Stride];
+    const double* prevSum2 = &m_SumOfSquares[j * m_Stride];
+    double*       sum      = &m_Sum[(j + 1) * m_Stride];
+    double*       sum2     = &m_SumOfSquares[(j + 1) * m_Stride];
+    double        rowSum   = 0.;
+    double        rowSum2  = 0.;
+
+    for (unsigned long i = 0; i < width; ++i)
+    {
+      const double value = static_cast<double>(rowPtr[columns[i]]) - m_Offset;
+      rowSum += value;
+      rowSum2 += value * value;
+      sum[i + 1]  = prevSum[i + 1] + rowSum;
+      sum2[i + 1] = prevSum2[i + 1] + rowSum2;
+    }
+  }
+}
+
+template <class TInputImage>
+void LocalMomentsCalculator<TInputImage>::Evaluate(const IndexType& index, double& mean, double& variance) const
+{
+  // Window corners in the tables
+  const unsigned long x0 = static_cast<unsigned long>(index[0] - m_Origin[0]) - m_Radius[0];
+  const unsigned long y0 = static_cast<unsigned long>(index[1] - m_Origin[1]) - m_Radius[1];
+  const unsigned long x1 = x0 + 2 * m_Radius[0] + 1;
+  const unsigned long y1 = y0 + 2 * m_Radius[1] + 1;
+
+  const unsigned long a = y0 * m_Stride + x0;
+  const unsigned long b = y0 * m_Stride + x1;
+  const unsigned long c = y1 * m_Stride + x0;
+  const unsigned long d = y1 * m_Stride + x1;
+
+  const double n    = static_cast<double>(m_WindowSize);
+  const double sum  = m_Sum[d] - m_Sum[b] - m_Sum[c] + m_Sum[a];
+  const double sum2 = m_SumOfSquares[d] - m_SumOfSquares[b] - m_SumOfSquares[c] + m_SumOfSquares[a];
+
+  mean = sum / n + m_Offset;
+
+  if (m_WindowSize > 1)
+  {
+    variance = std::max((sum2 - sum * sum / n) / (n - 1.), 0.);
+  }
+  else
+  {
+    variance = 0.;
+  }
+}
+
+} // end namespace otb
+
+#endif
@@ -26,4 +26,5 @@ void RegisterTests()
   REGISTER_TEST(otbLeeFilter);
   REGISTER_TEST(otbGammaMAPFilter);
   REGISTER_TEST(otbKuanFilter);
+  REGISTER_TEST(otbLocalMomentsCalculatorTest);
 }
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbImage.h"
+#include "otbLocalMomentsCalculator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+typedef otb::Image<float, 2> ImageType;
+
+/** Two-pass moments of a window, with zero flux Neumann boundary */
+void BruteForceMoments(const ImageType* image, const ImageType::IndexType& center, const ImageType::SizeType& radius, double& mean, double& variance)
+{
+  const ImageType::RegionType& buffered = image->GetBufferedRegion();
+  std::vector<double>          values;
+  for (long y = center[1] - static_cast<long>(radius[1]); y <= center[1] + static_cast<long>(radius[1]); ++y)
+  {
+    for (long x = center[0] - static_cast<long>(radius[0]); x <= center[0] + static_cast<long>(radius[0]); ++x)
+    {
+      ImageType::IndexType index;
+      index[0] = std::min(std::max(x, buffered.GetIndex()[0]), buffered.GetUpperIndex()[0]);
+      index[1] = std::min(std::max(y, buffered.GetIndex()[1]), buffered.GetUpperIndex()[1]);
+      values.push_back(image->GetPixel(index));
+    }
+  }
+
+  mean = 0.;
+  for (auto v : values)
+  {
+    mean += v;
+  }
+  mean /= values.size();
+
+  variance = 0.;
+  for (auto v : values)
+  {
+    variance += (v - mean) * (v - mean);
+  }
+  variance /= values.size() - 1;
+}
+
+bool CheckRegion(const ImageType* image, const ImageType::RegionType& region, const ImageType::SizeType& radius)
+{
+  otb::LocalMomentsCalculator<ImageType> moments;
+  moments.Compute(image, region, radius);
+
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    double mean, variance, refMean, refVariance;
+    moments.Evaluate(it.GetIndex(), mean, variance);
+    BruteForceMoments(image, it.GetIndex(), radius, refMean, refVariance);
+
+    if (std::abs(mean - refMean) > 1e-9 * std::abs(refMean) || std::abs(variance - refVariance) > 1e-9 * refVariance + 1e-9)
+    {
+      std::cerr << "Radius " << radius << ", pixel " << it.GetIndex() << ": got mean " << mean << " and variance " << variance << ", expected "
+                << refMean << " and " << refVariance << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int otbLocalMomentsCalculatorTest(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  ImageType::IndexType index;
+  index[0] = 5;
+  index[1] = 3;
+  ImageType::SizeType size;
+  size[0] = 40;
+  size[1] = 30;
+  ImageType::RegionType largest(index, size);
+
+  // Speckle-like values over a large mean, to exercise cancellation
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(largest);
+  image->Allocate();
+  unsigned int                                  seed = 12345;
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, largest);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    seed = seed * 1103515245 + 12345;
+    it.Set(10000.f + it.GetIndex()[0] + static_cast<float>((seed >> 16) % 1000) / 100.f);
+  }
+
+  ImageType::IndexType subIndex;
+  subIndex[0] = 12;
+  subIndex[1] = 8;
+  ImageType::SizeType subSize;
+  subSize[0] = 17;
+  subSize[1] = 9;
+  ImageType::RegionType subRegion(subIndex, subSize);
+
+  ImageType::SizeType radii[3];
+  radii[0].Fill(1);
+  radii[1][0] = 3;
+  radii[1][1] = 5;
+  radii[2].Fill(25);
+
+  for (const auto& radius : radii)
+  {
+    if (!CheckRegion(image, largest, radius) || !CheckRegion(image, subRegion, radius))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -28,6 +28,7 @@
 #include "itkArray.h"
 
 #include "otbParser.h"
+#include "otbExpressionKernel.h"
 #include <string>
 
 namespace otb
@@ -126,6 +127,19 @@ public:
   /** Return a pointer on the nth filter input */
   ImageType* GetNthInput(DataObjectPointerArraySizeType idx);
 
+  /** Evaluate the expression with a compiled kernel processing whole
+   *  scanlines when it falls in the subset supported by ExpressionKernel
+   *  (default is on). Other expressions always use the parser. */
+  itkSetMacro(UseCompiledKernel, bool);
+  itkGetConstMacro(UseCompiledKernel, bool);
+  itkBooleanMacro(UseCompiledKernel);
+
+  /** Return true if the last update used the compiled kernel */
+  bool IsCompiledKernelUsed() const
+  {
+    return m_Kernel.IsCompiled();
+  }
+
 protected:
   BandMathImageFilter();
   ~BandMathImageFilter() override;
@@ -135,6 +149,9 @@ protected:
   void ThreadedGenerateData(const ImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
   void AfterThreadedGenerateData() override;
 
+  /** Evaluate the compiled kernel line by line */
+  void CompiledThreadedGenerateData(const ImageRegionType& outputRegionForThread, itk::ThreadIdType threadId);
+
 private:
   BandMathImageFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
@@ -152,6 +169,10 @@ private:
   long             m_OverflowCount;
   itk::Array<long> m_ThreadUnderflow;
   itk::Array<long> m_ThreadOverflow;
+
+  bool                                     m_UseCompiledKernel;
+  ExpressionKernel                         m_Kernel;
+  std::vector<ExpressionKernel::Workspace> m_KernelWorkspaces;
 };
 
 } // end namespace otb
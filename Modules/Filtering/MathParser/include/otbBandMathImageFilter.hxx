@@ -24,6 +24,7 @@
 #include "otbBandMathImageFilter.h"
 
 #include "itkImageRegionIterator.h"
+#include "itkImageScanlineIterator.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
 #include "otbMacro.h"
@@ -48,6 +49,8 @@ BandMathImageFilter<TImage>::BandMathImageFilter()
   m_OverflowCount  = 0;
   m_ThreadUnderflow.SetSize(1);
   m_ThreadOverflow.SetSize(1);
+
+  m_UseCompiledKernel = true;
 }
 
 /** Destructor */
@@ -65,6 +68,7 @@ void BandMathImageFilter<TImage>::PrintSelf(std::ostream& os, itk::Indent indent
   os << indent << "Computed values follow:" << std::endl;
   os << indent << "UnderflowCount: " << m_UnderflowCount << std::endl;
   os << indent << "OverflowCount: " << m_OverflowCount << std::endl;
+  os << indent << "UseCompiledKernel: " << m_UseCompiledKernel << std::endl;
   os << indent << "itk::NumericTraits<PixelType>::NonpositiveMin()  :  " << itk::NumericTraits<PixelType>::NonpositiveMin() << std::endl;
   os << indent << "itk::NumericTraits<PixelType>::max()  :             " << itk::NumericTraits<PixelType>::max() << std::endl;
 }
@@ -200,6 +204,26 @@ void BandMathImageFilter<TImage>::BeforeThreadedGenerateData()
       m_VParser[i]->DefineVar(m_VVarName[j], &(m_AImage[i][j]));
     }
   }
+
+  // Compile the expression into a kernel, the variables are ordered as in
+  // m_VVarName: one per input image, then the image and physical indexes
+  m_Kernel.Clear();
+  if (m_UseCompiledKernel && m_Kernel.Compile(m_Expression, m_VVarName, ExpressionKernel::MuParser))
+  {
+    // Evaluate the parser once, so that errors detected by muParser are
+    // still reported
+    try
+    {
+      m_VParser[0]->Eval();
+    }
+    catch (itk::ExceptionObject& err)
+    {
+      m_Kernel.Clear();
+      itkExceptionMacro(<< err);
+    }
+    m_KernelWorkspaces.resize(nbThreads);
+    otbMsgDevMacro(<< "Expression " << m_Expression << " compiled into " << m_Kernel.GetNumberOfInstructions() << " instructions");
+  }
 }
 
 template <typename TImage>
@@ -230,6 +254,12 @@ void BandMathImageFilter<TImage>::AfterThreadedGenerateData()
 template <typename TImage>
 void BandMathImageFilter<TImage>::ThreadedGenerateData(const ImageRegionType& outputRegionForThread, itk::ThreadIdType threadId)
 {
+  if (m_Kernel.IsCompiled())
+  {
+    CompiledThreadedGenerateData(outputRegionForThread, threadId);
+    return;
+  }
+
   double       value;
   unsigned int j;
   unsigned int nbInputImages = this->GetNumberOfInputs();
@@ -312,6 +342,101 @@ void BandMathImageFilter<TImage>::ThreadedGenerateData(const ImageRegionType& ou
   }
 }
 
+template <typename TImage>
+void BandMathImageFilter<TImage>::CompiledThreadedGenerateData(const ImageRegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  const unsigned int nbInputImages = this->GetNumberOfInputs();
+  const std::size_t  lineSize      = outputRegionForThread.GetSize(0);
+
+  typedef itk::ImageScanlineConstIterator<TImage> ScanlineConstIteratorType;
+
+  assert(nbInputImages);
+  std::vector<ScanlineConstIteratorType> Vit(nbInputImages);
+  for (unsigned int j = 0; j < nbInputImages; ++j)
+  {
+    Vit[j] = ScanlineConstIteratorType(this->GetNthInput(j), outputRegionForThread);
+  }
+  itk::ImageScanlineIterator<TImage> ot(this->GetOutput(), outputRegionForThread);
+
+  if (lineSize == 0)
+  {
+    return;
+  }
+  // Progress is reported once per line
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels() / lineSize);
+
+  // One line buffer per variable
+  std::vector<std::vector<double>> lines(m_NbVar, std::vector<double>(lineSize));
+  std::vector<const double*>       variables(m_NbVar);
+  for (unsigned int j = 0; j < m_NbVar; ++j)
+  {
+    variables[j] = lines[j].data();
+  }
+  std::vector<double> result(lineSize);
+
+  // The column indexes are the same for every line
+  const double startX = static_cast<double>(outputRegionForThread.GetIndex(0));
+  for (std::size_t x = 0; x < lineSize; ++x)
+  {
+    lines[nbInputImages][x]     = startX + x;
+    lines[nbInputImages + 2][x] = static_cast<double>(m_Origin[0]) + (startX + x) * static_cast<double>(m_Spacing[0]);
+  }
+
+  ExpressionKernel::Workspace& workspace       = m_KernelWorkspaces[threadId];
+  long&                        threadUnderflow = m_ThreadUnderflow[threadId];
+  long&                        threadOverflow  = m_ThreadOverflow[threadId];
+  const double                 minValue        = double(itk::NumericTraits<PixelType>::NonpositiveMin());
+  const double                 maxValue        = double(itk::NumericTraits<PixelType>::max());
+
+  while (!ot.IsAtEnd())
+  {
+    for (unsigned int j = 0; j < nbInputImages; ++j)
+    {
+      double* line = lines[j].data();
+      for (std::size_t x = 0; !Vit[j].IsAtEndOfLine(); ++Vit[j], ++x)
+      {
+        line[x] = static_cast<double>(Vit[j].Get());
+      }
+    }
+
+    const double y = static_cast<double>(ot.GetIndex()[1]);
+    std::fill(lines[nbInputImages + 1].begin(), lines[nbInputImages + 1].end(), y);
+    std::fill(lines[nbInputImages + 3].begin(), lines[nbInputImages + 3].end(), static_cast<double>(m_Origin[1]) + y * static_cast<double>(m_Spacing[1]));
+
+    m_Kernel.Evaluate(variables.data(), lineSize, result.data(), workspace);
+
+    for (std::size_t x = 0; !ot.IsAtEndOfLine(); ++ot, ++x)
+    {
+      const double value = result[x];
+
+      // Same handling of the values out of the pixel type range as the
+      // parser based evaluation
+      if (value < minValue)
+      {
+        ot.Set(itk::NumericTraits<PixelType>::NonpositiveMin());
+        threadUnderflow++;
+      }
+      else if (value > maxValue)
+      {
+        ot.Set(itk::NumericTraits<PixelType>::max());
+        threadOverflow++;
+      }
+      else
+      {
+        ot.Set(static_cast<PixelType>(value));
+      }
+    }
+
+    for (unsigned int j = 0; j < nbInputImages; ++j)
+    {
+      Vit[j].NextLine();
+    }
+    ot.NextLine();
+
+    progress.CompletedPixel();
+  }
+}
+
 } // end namespace otb
 
 #endif
@@ -21,12 +21,14 @@
 
 #include "itkMacro.h"
 #include <iostream>
+#include <algorithm>
 #include <complex> //only for the isnan() test line 148
 
 #include "otbMath.h"
 #include "otbImage.h"
 #include "otbBandMathImageFilter.h"
 #include "otbImageFileWriter.h"
+#include "otbStopwatch.h"
 
 
 int otbBandMathImageFilter(int itkNotUsed(argc), char* itkNotUsed(argv)[])
@@ -272,3 +274,165 @@ int otbBandMathImageFilterWithIdx(int itkNotUsed(argc), char* argv[])
 
   return EXIT_SUCCESS;
 }
+
+
+namespace
+{
+typedef otb::Image<double, 2> KernelTestImageType;
+
+KernelTestImageType::Pointer CreateKernelTestImage(const KernelTestImageType::RegionType& region, unsigned int seed)
+{
+  KernelTestImageType::Pointer image = KernelTestImageType::New();
+  image->SetRegions(region);
+  KernelTestImageType::PointType origin;
+  origin[0] = 12.5;
+  origin[1] = -3.;
+  KernelTestImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = -2.;
+  image->SetOrigin(origin);
+  image->SetSignedSpacing(spacing);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<KernelTestImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const KernelTestImageType::IndexType idx = it.GetIndex();
+    // reflectance like values, with some zeros
+    it.Set(((idx[0] * (7 + seed) + idx[1] * (13 + 3 * seed)) % 101) / 100.);
+  }
+  return image;
+}
+}
+
+/** Check that the compiled kernel gives the same results as muParser */
+int otbBandMathImageFilterCompiledKernel(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  typedef otb::BandMathImageFilter<KernelTestImageType> FilterType;
+
+  // The line width is not a multiple of the kernel chunk size
+  KernelTestImageType::RegionType region;
+  region.SetSize(0, 300);
+  region.SetSize(1, 37);
+  region.SetIndex(0, 0);
+  region.SetIndex(1, 0);
+
+  KernelTestImageType::Pointer image1 = CreateKernelTestImage(region, 0);
+  KernelTestImageType::Pointer image2 = CreateKernelTestImage(region, 1);
+  KernelTestImageType::Pointer image3 = CreateKernelTestImage(region, 2);
+
+  const char* expressions[] = {"ndvi(b1, b2)",
+                               "(b2 - b1) / (b2 + b1)",
+                               "b1 / b2",
+#ifdef OTB_MUPARSER_HAS_CXX_LOGICAL_OPERATORS
+                               "b1 > 0.5 ? b2 * 2 : -b3",
+                               "(b1 > 0.2) && (b2 <= 0.7) || b3 == 0",
+#endif
+                               "min(b1, b2, b3) + max(b1, 0.5) - avg(b1, b2, b3) + sum(b1, b2)",
+                               "sqrt(abs(b1 - b2)) * exp(-b3) + ln(b1 + 1) + b2^2 + 1e-3 * b3^-1",
+                               "cos(2 * pi * b1) / (2 * pi * b2 + 1E-3) * sin(pi * b3)",
+                               "rint(b1 * 10) + sign(b2 - 0.5) + atan2(b1, b2) + log10(b3 + 1)",
+                               "idxX + 1000 * idxY + idxPhyX * idxPhyY",
+                               "b1 * 1000 - 500"};
+
+  int status = EXIT_SUCCESS;
+  for (const char* expression : expressions)
+  {
+    FilterType::Pointer compiled = FilterType::New();
+    FilterType::Pointer parsed   = FilterType::New();
+    for (FilterType* filter : {compiled.GetPointer(), parsed.GetPointer()})
+    {
+      filter->SetNthInput(0, image1);
+      filter->SetNthInput(1, image2);
+      filter->SetNthInput(2, image3);
+      filter->SetExpression(expression);
+    }
+    compiled->UseCompiledKernelOn();
+    parsed->UseCompiledKernelOff();
+    compiled->Update();
+    parsed->Update();
+
+    if (!compiled->IsCompiledKernelUsed() || parsed->IsCompiledKernelUsed())
+    {
+      std::cout << "Expression " << expression << " was expected to be compiled" << std::endl;
+      status = EXIT_FAILURE;
+      continue;
+    }
+
+    itk::ImageRegionConstIteratorWithIndex<KernelTestImageType> itc(compiled->GetOutput(), region);
+    itk::ImageRegionConstIterator<KernelTestImageType>          itp(parsed->GetOutput(), region);
+    for (; !itc.IsAtEnd(); ++itc, ++itp)
+    {
+      const double c = itc.Get();
+      const double p = itp.Get();
+      if (vnl_math_isnan(c) && vnl_math_isnan(p))
+        continue;
+      if (c != p && std::abs(c - p) > 1e-12 * std::max(std::abs(c), std::abs(p)))
+      {
+        std::cout << "Expression " << expression << ": compiled value " << c << " differs from parsed value " << p << " at " << itc.GetIndex()
+                  << std::endl;
+        status = EXIT_FAILURE;
+        break;
+      }
+    }
+  }
+
+  // Expressions outside of the compiled subset must still be evaluated
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetNthInput(0, image1);
+  filter->SetNthInput(1, image2);
+  filter->SetExpression("-b1^2");
+  filter->Update();
+  if (filter->IsCompiledKernelUsed())
+  {
+    std::cout << "Expression -b1^2 should not be compiled" << std::endl;
+    status = EXIT_FAILURE;
+  }
+  return status;
+}
+
+/** Compare the speed of the parser and of the compiled kernel on typical
+ *  expressions */
+int otbBandMathImageFilterKernelBenchmark(int argc, char* argv[])
+{
+  typedef otb::BandMathImageFilter<KernelTestImageType> FilterType;
+
+  const unsigned int size = argc > 1 ? atoi(argv[1]) : 1000;
+
+  KernelTestImageType::RegionType region;
+  region.SetSize(0, size);
+  region.SetSize(1, size);
+  region.SetIndex(0, 0);
+  region.SetIndex(1, 0);
+
+  KernelTestImageType::Pointer image1 = CreateKernelTestImage(region, 0);
+  KernelTestImageType::Pointer image2 = CreateKernelTestImage(region, 1);
+  KernelTestImageType::Pointer image3 = CreateKernelTestImage(region, 2);
+
+  const char* expressions[] = {"ndvi(b1, b2)", "(b2 - b1) / (b2 + b1)", "b1 / (b2 + b3)",
+#ifdef OTB_MUPARSER_HAS_CXX_LOGICAL_OPERATORS
+                               "b1 > 0.3 && b2 < 0.6 ? 1 : 0",
+#endif
+                               "(b1 > 0.5) * 255"};
+
+  for (const char* expression : expressions)
+  {
+    std::cout << expression;
+    for (bool useKernel : {false, true})
+    {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetNthInput(0, image1);
+      filter->SetNthInput(1, image2);
+      filter->SetNthInput(2, image3);
+      filter->SetExpression(expression);
+      filter->SetUseCompiledKernel(useKernel);
+
+      otb::Stopwatch chrono = otb::Stopwatch::StartNew();
+      filter->Update();
+      chrono.Stop();
+      std::cout << (useKernel ? "  compiled: " : "  parser: ") << chrono.GetElapsedMilliseconds() << " ms";
+    }
+    std::cout << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -27,4 +27,6 @@ void RegisterTests()
   REGISTER_TEST(otbImageListToSingleImageFilter);
   REGISTER_TEST(otbBandMathImageFilter);
   REGISTER_TEST(otbBandMathImageFilterWithIdx);
+  REGISTER_TEST(otbBandMathImageFilterCompiledKernel);
+  REGISTER_TEST(otbBandMathImageFilterKernelBenchmark);
 }
@@ -29,6 +29,7 @@
 
 #include "otbStreamingStatisticsVectorImageFilter.h"
 #include "otbParserX.h"
+#include "otbExpressionKernel.h"
 
 #include <vector>
 #include <string>
@@ -136,6 +137,20 @@ public:
     return !m_StatsVarDetected.empty();
   }
 
+  /** Evaluate the expressions with compiled kernels processing whole
+   *  scanlines when all of them produce a scalar from scalar variables and
+   *  fall in the subset supported by ExpressionKernel (default is on).
+   *  Other cases always use muParserX. */
+  itkSetMacro(UseCompiledKernel, bool);
+  itkGetConstMacro(UseCompiledKernel, bool);
+  itkBooleanMacro(UseCompiledKernel);
+
+  /** Return true if the last update used the compiled kernels */
+  bool IsCompiledKernelUsed() const
+  {
+    return !m_Kernels.empty();
+  }
+
 protected:
   BandMathXImageFilter();
   ~BandMathXImageFilter() override;
@@ -166,6 +181,8 @@ private:
   void PrepareParsers();
   void PrepareParsersGlobStats();
   void OutputsDimensions();
+  void PrepareKernels();
+  void CompiledThreadedGenerateData(const ImageRegionType& outputRegionForThread, itk::ThreadIdType threadId);
 
   std::vector<std::string>                      m_Expression;
   std::vector<std::vector<ParserType::Pointer>> m_VParser;
@@ -190,6 +207,10 @@ private:
   itk::Array<long> m_ThreadOverflow;
 
   bool m_ManyExpressions;
+
+  bool                                                  m_UseCompiledKernel;
+  std::vector<ExpressionKernel>                         m_Kernels;          // one per expression
+  std::vector<std::vector<ExpressionKernel::Workspace>> m_KernelWorkspaces; // per thread and per expression
 };
 
 } // end namespace otb
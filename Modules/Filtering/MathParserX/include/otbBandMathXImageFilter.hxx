@@ -68,6 +68,8 @@ BandMathXImageFilter<TImage>::BandMathXImageFilter()
   m_SizeNeighbourhood = 10;
 
   m_ManyExpressions = true;
+
+  m_UseCompiledKernel = true;
 }
 
 /** Destructor */
@@ -101,6 +103,7 @@ void BandMathXImageFilter<TImage>::PrintSelf(std::ostream& os, itk::Indent inden
   os << indent << "Computed values follow:" << std::endl;
   os << indent << "UnderflowCount: " << m_UnderflowCount << std::endl;
   os << indent << "OverflowCount: " << m_OverflowCount << std::endl;
+  os << indent << "UseCompiledKernel: " << m_UseCompiledKernel << std::endl;
   os << indent << "itk::NumericTraits<typename PixelValueType>::NonpositiveMin()  :  " << itk::NumericTraits<PixelValueType>::NonpositiveMin() << std::endl;
   os << indent << "itk::NumericTraits<typename PixelValueType>::max()  :             " << itk::NumericTraits<PixelValueType>::max() << std::endl;
 }
@@ -856,6 +859,45 @@ void BandMathXImageFilter<TImage>::OutputsDimensions()
   }
 }
 
+template <typename TImage>
+void BandMathXImageFilter<TImage>::PrepareKernels()
+{
+  m_Kernels.clear();
+  m_KernelWorkspaces.clear();
+
+  if (!m_UseCompiledKernel || m_AImage.empty())
+    return;
+
+  // Kernels only handle scalar outputs computed from scalar variables
+  for (unsigned int i = 0; i < m_outputsDimensions.size(); ++i)
+    if (m_outputsDimensions[i] != 1)
+      return;
+
+  std::vector<std::string> names;
+  for (unsigned int j = 0; j < m_AImage[0].size(); ++j)
+  {
+    const adhocStruct& var = m_AImage[0][j];
+    if (var.type == 4 || var.type == 6)
+      return;
+    if ((var.type == 7 || var.type == 8) && var.value.GetType() != 'i' && var.value.GetType() != 'f')
+      return;
+    names.push_back(var.name);
+  }
+
+  std::vector<ExpressionKernel> kernels(m_Expression.size());
+  for (unsigned int i = 0; i < m_Expression.size(); ++i)
+  {
+    if (!kernels[i].Compile(m_Expression[i], names, ExpressionKernel::MuParserX))
+    {
+      otbMsgDevMacro(<< "Expression " << m_Expression[i] << " can not be compiled, muParserX is used");
+      return;
+    }
+  }
+
+  m_Kernels.swap(kernels);
+  m_KernelWorkspaces.resize(this->GetNumberOfThreads(), std::vector<ExpressionKernel::Workspace>(m_Expression.size()));
+}
+
 template <typename TImage>
 void BandMathXImageFilter<TImage>::CheckImageDimensions(void)
 {
@@ -969,6 +1011,8 @@ void BandMathXImageFilter<TImage>::BeforeThreadedGenerateData()
   m_ThreadUnderflow.Fill(0);
   m_ThreadOverflow.SetSize(nbThreads);
   m_ThreadOverflow.Fill(0);
+
+  PrepareKernels();
 }
 
 
@@ -1006,6 +1050,11 @@ void BandMathXImageFilter<TImage>::AfterThreadedGenerateData()
 template <typename TImage>
 void BandMathXImageFilter<TImage>::ThreadedGenerateData(const ImageRegionType& outputRegionForThread, itk::ThreadIdType threadId)
 {
+  if (!m_Kernels.empty())
+  {
+    CompiledThreadedGenerateData(outputRegionForThread, threadId);
+    return;
+  }
 
   ValueType    value;
   unsigned int nbInputImages = this->GetNumberOfInputs();
@@ -1229,6 +1278,118 @@ void BandMathXImageFilter<TImage>::ThreadedGenerateData(const ImageRegionType& o
   }
 }
 
+template <typename TImage>
+void BandMathXImageFilter<TImage>::CompiledThreadedGenerateData(const ImageRegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  const unsigned int nbInputImages = this->GetNumberOfInputs();
+  const unsigned int nbExpr        = m_Expression.size();
+  const std::size_t  lineSize      = outputRegionForThread.GetSize(0);
+
+  if (lineSize == 0)
+    return;
+
+  typedef itk::ImageScanlineConstIterator<TImage> ImageScanlineConstIteratorType;
+  typedef itk::ImageScanlineIterator<TImage>      ImageScanlineIteratorType;
+  std::vector<ImageScanlineConstIteratorType>     Vit(nbInputImages);
+  for (unsigned int j = 0; j < nbInputImages; ++j)
+    Vit[j] = ImageScanlineConstIteratorType(this->GetNthInput(j), outputRegionForThread);
+
+  std::vector<ImageScanlineIteratorType> VoutIt(nbExpr);
+  for (unsigned int j = 0; j < nbExpr; ++j)
+    VoutIt[j] = ImageScanlineIteratorType(this->GetOutput(j), outputRegionForThread);
+
+  // Progress is reported once per line
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels() / lineSize);
+
+  // One line buffer per variable. Constants (spacings, user constants and
+  // global statistics) and the column index are filled once.
+  const std::vector<adhocStruct>&  vars  = m_AImage[threadId];
+  const unsigned int               nbVar = vars.size();
+  std::vector<std::vector<double>> lines(nbVar, std::vector<double>(lineSize));
+  std::vector<const double*>       variables(nbVar);
+  std::vector<unsigned int>        rowVars;
+  std::vector<std::vector<std::pair<unsigned int, int>>> bandVars(nbInputImages); // (variable, band) for each input
+  for (unsigned int j = 0; j < nbVar; ++j)
+  {
+    variables[j] = lines[j].data();
+    switch (vars[j].type)
+    {
+    case 0: // idxX
+      for (std::size_t x = 0; x < lineSize; ++x)
+        lines[j][x] = static_cast<double>(outputRegionForThread.GetIndex(0)) + x;
+      break;
+    case 1: // idxY
+      rowVars.push_back(j);
+      break;
+    case 5: // pixel
+      bandVars[vars[j].info[0]].push_back(std::make_pair(j, vars[j].info[1]));
+      break;
+    default: // scalar constants
+      std::fill(lines[j].begin(), lines[j].end(), static_cast<double>(vars[j].value.GetFloat()));
+      break;
+    }
+  }
+
+  std::vector<ExpressionKernel::Workspace>& workspaces = m_KernelWorkspaces[threadId];
+  std::vector<double>                       result(lineSize);
+  PixelType                                 outPixel(1);
+  const double                              minValue = double(itk::NumericTraits<PixelValueType>::NonpositiveMin());
+  const double                              maxValue = double(itk::NumericTraits<PixelValueType>::max());
+
+  while (!Vit[0].IsAtEnd())
+  {
+    for (unsigned int j = 0; j < nbInputImages; ++j)
+    {
+      const std::vector<std::pair<unsigned int, int>>& bands = bandVars[j];
+      if (bands.empty())
+        continue;
+      for (std::size_t x = 0; !Vit[j].IsAtEndOfLine(); ++Vit[j], ++x)
+      {
+        const PixelType& pixel = Vit[j].Get();
+        for (unsigned int b = 0; b < bands.size(); ++b)
+          lines[bands[b].first][x] = static_cast<double>(pixel[bands[b].second]);
+      }
+    }
+
+    const double y = static_cast<double>(VoutIt[0].GetIndex()[1]);
+    for (unsigned int r = 0; r < rowVars.size(); ++r)
+      std::fill(lines[rowVars[r]].begin(), lines[rowVars[r]].end(), y);
+
+    for (unsigned int IDExpression = 0; IDExpression < nbExpr; ++IDExpression)
+    {
+      m_Kernels[IDExpression].Evaluate(variables.data(), lineSize, result.data(), workspaces[IDExpression]);
+
+      ImageScanlineIteratorType& outIt = VoutIt[IDExpression];
+      for (std::size_t x = 0; !outIt.IsAtEndOfLine(); ++outIt, ++x)
+      {
+        // Same handling of the values out of the pixel type range as the
+        // muParserX based evaluation
+        if (result[x] < minValue)
+        {
+          outPixel[0] = itk::NumericTraits<PixelValueType>::NonpositiveMin();
+          m_ThreadUnderflow[threadId]++;
+        }
+        else if (result[x] > maxValue)
+        {
+          outPixel[0] = itk::NumericTraits<PixelValueType>::max();
+          m_ThreadOverflow[threadId]++;
+        }
+        else
+        {
+          outPixel[0] = result[x];
+        }
+        outIt.Set(outPixel);
+      }
+      outIt.NextLine();
+    }
+
+    for (unsigned int j = 0; j < nbInputImages; ++j)
+      Vit[j].NextLine();
+
+    progress.CompletedPixel();
+  }
+}
+
 } // end namespace otb
 
 #endif
@@ -21,6 +21,7 @@
 
 #include "itkMacro.h"
 #include <iostream>
+#include <algorithm>
 #include <complex> //only for the isnan() test line 148
 
 #include "otbMath.h"
@@ -684,3 +685,111 @@ int otbBandMathXImageFilterBandsFailures(int itkNotUsed(argc), char* itkNotUsed(
   }
   return EXIT_SUCCESS;
 }
+
+/** Check that the compiled kernels give the same results as muParserX */
+int otbBandMathXImageFilterCompiledKernel(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  typedef otb::VectorImage<double, 2> ImageType;
+  typedef otb::BandMathXImageFilter<ImageType> FilterType;
+
+  // The line width is not a multiple of the kernel chunk size
+  ImageType::RegionType region;
+  region.SetSize(0, 300);
+  region.SetSize(1, 37);
+  region.SetIndex(0, 0);
+  region.SetIndex(1, 0);
+
+  ImageType::Pointer image1 = createTestImage<ImageType>(region, 3);
+  ImageType::Pointer image2 = createTestImage<ImageType>(region, 2);
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = -2.;
+  image1->SetSignedSpacing(spacing);
+  image2->SetSignedSpacing(spacing);
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it1(image1, region);
+  itk::ImageRegionIteratorWithIndex<ImageType> it2(image2, region);
+  for (it1.GoToBegin(), it2.GoToBegin(); !it1.IsAtEnd(); ++it1, ++it2)
+  {
+    const ImageType::IndexType idx = it1.GetIndex();
+    ImageType::PixelType val1(3), val2(2);
+    for (unsigned int b = 0; b < 3; ++b)
+      val1[b] = ((idx[0] * (7 + b) + idx[1] * (13 + 3 * b)) % 101) / 100.;
+    for (unsigned int b = 0; b < 2; ++b)
+      val2[b] = ((idx[0] * (11 + b) + idx[1] * (5 + 2 * b)) % 97) / 96.;
+    it1.Set(val1);
+    it2.Set(val2);
+  }
+
+  const char* expressions[] = {"ndvi(im1b1, im2b1)",
+                               "(im1b2 - im1b1) / (im1b2 + im1b1)",
+                               "im1b1 / im2b2",
+                               "im1b1 > 0.5 ? im2b2 * 2 : -im1b3",
+                               "(im1b1 > 0.2) && (im2b1 <= 0.7) || im1b3 == 0 ? 1 : 0",
+                               "sqrt(abs(im1b1 - im2b2)) * exp(-im1b3) + ln(im1b1 + 1) + im2b1^2",
+                               "cos(2 * pi * im1b1) / (2 * pi * im2b1 + 1E-3) * sin(pi * im1b2)",
+                               "idxX + 1000 * idxY + im1PhyX * im2PhyY",
+                               "cst * im1b1 + log10e",
+                               "im1b1 - im1b1Mean + im2b2Maxi"};
+
+  FilterType::Pointer compiled = FilterType::New();
+  FilterType::Pointer parsed   = FilterType::New();
+  for (FilterType* filter : {compiled.GetPointer(), parsed.GetPointer()})
+  {
+    filter->SetNthInput(0, image1);
+    filter->SetNthInput(1, image2);
+    filter->SetConstant("cst", 2.5);
+    for (const char* expression : expressions)
+      filter->SetExpression(expression);
+  }
+  compiled->UseCompiledKernelOn();
+  parsed->UseCompiledKernelOff();
+  compiled->UpdateOutputInformation();
+  parsed->UpdateOutputInformation();
+  for (unsigned int e = 0; e < compiled->GetNumberOfOutputs(); ++e)
+  {
+    compiled->GetOutput(e)->SetRequestedRegionToLargestPossibleRegion();
+    compiled->GetOutput(e)->Update();
+    parsed->GetOutput(e)->SetRequestedRegionToLargestPossibleRegion();
+    parsed->GetOutput(e)->Update();
+  }
+
+  if (!compiled->IsCompiledKernelUsed() || parsed->IsCompiledKernelUsed())
+  {
+    std::cout << "Expressions were expected to be compiled" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int status = EXIT_SUCCESS;
+  for (unsigned int e = 0; e < compiled->GetNumberOfOutputs(); ++e)
+  {
+    itk::ImageRegionConstIteratorWithIndex<ImageType> itc(compiled->GetOutput(e), region);
+    itk::ImageRegionConstIterator<ImageType>          itp(parsed->GetOutput(e), region);
+    for (; !itc.IsAtEnd(); ++itc, ++itp)
+    {
+      const double c = itc.Get()[0];
+      const double p = itp.Get()[0];
+      if (vnl_math_isnan(c) && vnl_math_isnan(p))
+        continue;
+      if (c != p && std::abs(c - p) > 1e-12 * std::max(std::abs(c), std::abs(p)))
+      {
+        std::cout << "Expression " << compiled->GetExpression(e) << ": compiled value " << c << " differs from parsed value " << p << " at "
+                  << itc.GetIndex() << std::endl;
+        status = EXIT_FAILURE;
+        break;
+      }
+    }
+  }
+
+  // Vector expressions must still be evaluated by muParserX
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetNthInput(0, image1);
+  filter->SetExpression("vcos(im1)");
+  filter->Update();
+  if (filter->IsCompiledKernelUsed())
+  {
+    std::cout << "Expression vcos(im1) should not be compiled" << std::endl;
+    status = EXIT_FAILURE;
+  }
+  return status;
+}
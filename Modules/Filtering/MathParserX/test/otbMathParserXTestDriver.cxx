@@ -28,4 +28,5 @@ void RegisterTests()
   REGISTER_TEST(otbBandMathXImageFilterTxt);
   REGISTER_TEST(otbBandMathXImageFilterWithIdx);
   REGISTER_TEST(otbBandMathXImageFilterBandsFailures);
+  REGISTER_TEST(otbBandMathXImageFilterCompiledKernel);
 }
@@ -25,6 +25,7 @@
 #include "itkImageToImageFilter.h"
 #include "itkNearestNeighborInterpolateImageFunction.h"
 #include "otbStreamingTraits.h"
+#include <vector>
 
 // No data
 #include "otbNoDataHelper.h"
@@ -45,6 +46,19 @@ namespace otb
  * the  interpolator (SetInterpolator()) and the origin (SetOrigin())
  * can be set using the method between brackets.
  *
+ * The footprints of the input images in the output grid are computed in
+ * GenerateOutputInformation(), and indexed in a grid of bins covering the
+ * output image. For each requested region, only the inputs whose footprint
+ * intersects the region are considered, so the cost of the requested
+ * region computation does not grow with the total number of inputs.
+ * Subclasses can use GetInputFootprint() to skip inputs which cannot
+ * contribute to a thread region or to an output pixel.
+ *
+ * When the default nearest neighbor interpolator is used, inputs whose grid
+ * is aligned with the output grid (same spacing, origin shifted by a whole
+ * number of pixels) are detected, see IsInputGridAligned(). Their pixels
+ * can be read directly instead of being interpolated.
+ *
  *
  * \ingroup OTBMosaic
  *
@@ -72,6 +86,7 @@ public:
   typedef typename InputImageType::IndexType         InputImageIndexType;
   typedef typename InputImageType::SizeType          InputImageSizeType;
   typedef typename InputImageType::SpacingType       InputImageSpacingType;
+  typedef typename InputImageType::OffsetType        InputImageOffsetType;
   typedef typename InputImageType::InternalPixelType InputImageInternalPixelType;
 
   /** Output image typedefs typedefs.  */
@@ -132,6 +147,14 @@ public:
   itkSetMacro(AutomaticOutputParametersComputation, bool);
   itkGetMacro(AutomaticOutputParametersComputation, bool);
 
+  /** Set/Get the use of the input footprints index (on by default). When
+   * off, every input is processed for every region and interpolated, as if
+   * all the inputs covered the whole output image. The output is the same,
+   * this is meant for validation and debugging. */
+  itkSetMacro(UseInputFootprints, bool);
+  itkGetMacro(UseInputFootprints, bool);
+  itkBooleanMacro(UseInputFootprints);
+
   /** Set shift-scale mode */
   itkSetMacro(ShiftScaleInputImages, bool);
   itkGetMacro(ShiftScaleInputImages, bool);
@@ -234,6 +257,35 @@ protected:
   /** Prepare interpolators, valid regions, and input images pointers */
   virtual void PrepareImageAccessors(typename std::vector<InputImageType*>& image, typename std::vector<InterpolatorPointerType>& interpolator);
 
+  /** Compute the footprints of the inputs in the output grid, index them,
+   * and detect the inputs aligned with the output grid */
+  virtual void ComputeInputFootprints();
+
+  /** Output region where the input #inputIndex can be used, including the
+   * interpolator radius (empty if the input is outside the output image) */
+  const OutputImageRegionType& GetInputFootprint(unsigned int inputIndex) const
+  {
+    return m_InputFootprints[inputIndex];
+  }
+
+  /** Get the inputs whose footprint intersects the given output region,
+   * in increasing order */
+  virtual void FindInputsOverlappingRegion(const OutputImageRegionType& region, IndicesListType& indices) const;
+
+  /** True if the input #inputIndex is aligned with the output grid and the
+   * nearest neighbor interpolator is used. The interpolated value at an
+   * output index is then the input pixel at the output index plus
+   * GetAlignedInputOffset(). */
+  bool IsInputGridAligned(unsigned int inputIndex) const
+  {
+    return m_AlignedInputs[inputIndex];
+  }
+
+  const InputImageOffsetType& GetAlignedInputOffset(unsigned int inputIndex) const
+  {
+    return m_AlignedInputOffsets[inputIndex];
+  }
+
 private:
   StreamingMosaicFilterBase(const Self&); // purposely not implemented
   void operator=(const Self&);            // purposely not implemented
@@ -259,6 +311,15 @@ private:
   InternalValueType minOutputPixelValue;
   InternalValueType maxOutputPixelValue;
 
+  /** Footprints index */
+  bool                               m_UseInputFootprints;    // index enabled
+  std::vector<OutputImageRegionType> m_InputFootprints;       // footprint of each input
+  std::vector<IndicesListType>       m_FootprintBins;         // inputs intersecting each bin
+  OutputImageSizeType                m_FootprintBinSize;      // size of a bin (output pixels)
+  OutputImageSizeType                m_NumberOfFootprintBins; // number of bins per dimension
+  std::vector<bool>                  m_AlignedInputs;         // input grid aligned with output
+  std::vector<InputImageOffsetType>  m_AlignedInputOffsets;   // input index - output index
+
 }; // end of class
 
 } // end namespace itk
@@ -23,6 +23,8 @@
 #define __StreamingMosaicFilterBase_hxx
 
 #include "otbStreamingMosaicFilterBase.h"
+#include <algorithm>
+#include <cmath>
 
 namespace otb
 {
@@ -40,6 +42,9 @@ StreamingMosaicFilterBase<TInputImage, TOutputImage, TInternalValueType>::Stream
   Superclass::SetDirectionTolerance(itk::NumericTraits<double>::max());
   interpolatorRadius = 0;
   nbOfBands          = 0;
+  m_UseInputFootprints = true;
+  m_FootprintBinSize.Fill(1);
+  m_NumberOfFootprintBins.Fill(0);
 }
 
 /**
@@ -155,13 +160,232 @@ void StreamingMosaicFilterBase<TInputImage, TOutputImage, TInternalValueType>::G
 {
   usedInputIndices.clear();
 
+  // Only the images whose footprint intersects the requested region can
+  // be used
+  IndicesListType candidates;
+  FindInputsOverlappingRegion(this->GetOutput()->GetRequestedRegion(), candidates);
+
   // For each image, get the requested region
+  typename IndicesListType::const_iterator candidate = candidates.begin();
   for (unsigned int i = 0; i < this->GetNumberOfInputs(); ++i)
   {
-    ComputeRequestedRegionOfInputImage(i);
+    if (candidate != candidates.end() && *candidate == i)
+    {
+      ComputeRequestedRegionOfInputImage(i);
+      ++candidate;
+    }
+    else
+    {
+      itkDebugMacro(<< "Image #" << i << " footprint is outside the requested region");
+      InputImageRegionType inRegion;
+      inRegion.GetModifiableSize().Fill(0);
+      inRegion.GetModifiableIndex().Fill(0);
+      static_cast<InputImageType*>(Superclass::ProcessObject::GetInput(i))->SetRequestedRegion(inRegion);
+    }
   }
 }
 
+/**
+ * Compute the footprint of each input image in the output grid, and build
+ * the bins index
+ */
+template <class TInputImage, class TOutputImage, class TInternalValueType>
+void StreamingMosaicFilterBase<TInputImage, TOutputImage, TInternalValueType>::ComputeInputFootprints()
+{
+  const unsigned int           nbInputs     = this->GetNumberOfInputs();
+  OutputImageType*             outputPtr    = this->GetOutput();
+  const OutputImageRegionType& outputRegion = outputPtr->GetLargestPossibleRegion();
+
+  OutputImageRegionType emptyRegion;
+  emptyRegion.GetModifiableSize().Fill(0);
+  emptyRegion.GetModifiableIndex().Fill(0);
+  InputImageOffsetType nullOffset;
+  nullOffset.Fill(0);
+
+  m_AlignedInputs.assign(nbInputs, false);
+  m_AlignedInputOffsets.assign(nbInputs, nullOffset);
+
+  if (!m_UseInputFootprints)
+  {
+    // Every input may cover every pixel, and no bins: all the inputs are
+    // candidates for any region
+    m_InputFootprints.assign(nbInputs, outputRegion);
+    m_FootprintBins.clear();
+    m_NumberOfFootprintBins.Fill(0);
+    return;
+  }
+
+  m_InputFootprints.assign(nbInputs, emptyRegion);
+
+  // Reading pixels directly is only equivalent to the nearest neighbor
+  // interpolation
+  const bool nearestNeighbor = dynamic_cast<DefaultInterpolatorType*>(m_Interpolator.GetPointer()) != nullptr;
+
+  for (unsigned int imageIndex = 0; imageIndex < nbInputs; ++imageIndex)
+  {
+    InputImageType*             currentImage = static_cast<InputImageType*>(Superclass::ProcessObject::GetInput(imageIndex));
+    const InputImageRegionType& inputRegion  = currentImage->GetLargestPossibleRegion();
+
+    // Pixels edges, padded like in OutputRegionToInputRegion()
+    const double        pad = 0.5 + 1 + interpolatorRadius;
+    ContinuousIndexType lower, upper;
+    for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+      lower[dim] = inputRegion.GetIndex()[dim] - pad;
+      upper[dim] = inputRegion.GetIndex()[dim] + static_cast<double>(inputRegion.GetSize()[dim]) - 1 + pad;
+    }
+
+    // Bounding box of the corners in the output grid
+    double outputMin[2] = {itk::NumericTraits<double>::max(), itk::NumericTraits<double>::max()};
+    double outputMax[2] = {itk::NumericTraits<double>::NonpositiveMin(), itk::NumericTraits<double>::NonpositiveMin()};
+    for (unsigned int corner = 0; corner < 4; ++corner)
+    {
+      ContinuousIndexType inputCorner, outputCorner;
+      inputCorner[0] = (corner & 1) ? upper[0] : lower[0];
+      inputCorner[1] = (corner & 2) ? upper[1] : lower[1];
+      InputImagePointType point;
+      currentImage->TransformContinuousIndexToPhysicalPoint(inputCorner, point);
+      outputPtr->TransformPhysicalPointToContinuousIndex(point, outputCorner);
+      for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+        outputMin[dim] = vnl_math_min(outputMin[dim], outputCorner[dim]);
+        outputMax[dim] = vnl_math_max(outputMax[dim], outputCorner[dim]);
+      }
+    }
+
+    // One more pixel for the rounding of indices
+    OutputImageIndexType footprintIndex;
+    OutputImageSizeType  footprintSize;
+    for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+      footprintIndex[dim] = static_cast<typename OutputImageIndexType::IndexValueType>(std::floor(outputMin[dim])) - 1;
+      footprintSize[dim]  = static_cast<typename OutputImageSizeType::SizeValueType>(std::ceil(outputMax[dim]) + 1 - footprintIndex[dim] + 1);
+    }
+    OutputImageRegionType footprint(footprintIndex, footprintSize);
+    if (!footprint.Crop(outputRegion))
+    {
+      itkDebugMacro(<< "Image #" << imageIndex << " is outside the output image");
+      continue;
+    }
+    m_InputFootprints[imageIndex] = footprint;
+
+    // Check if the input grid is the output grid shifted by a whole number
+    // of pixels, at three corners of the footprint (the mapping is affine)
+    if (nearestNeighbor)
+    {
+      bool                 aligned = true;
+      InputImageOffsetType offset;
+      for (unsigned int corner = 0; corner < 3 && aligned; ++corner)
+      {
+        OutputImageIndexType outputIndex = footprint.GetIndex();
+        if (corner == 1)
+          outputIndex[0] = footprint.GetUpperIndex()[0];
+        if (corner == 2)
+          outputIndex[1] = footprint.GetUpperIndex()[1];
+
+        OutputImagePointType point;
+        ContinuousIndexType  inputIndex;
+        outputPtr->TransformIndexToPhysicalPoint(outputIndex, point);
+        currentImage->TransformPhysicalPointToContinuousIndex(point, inputIndex);
+        for (unsigned int dim = 0; dim < 2; ++dim)
+        {
+          const double shift = inputIndex[dim] - outputIndex[dim];
+          if (corner == 0)
+          {
+            offset[dim] = static_cast<typename InputImageOffsetType::OffsetValueType>(vnl_math_rnd(shift));
+          }
+          aligned = aligned && std::abs(shift - offset[dim]) < 1e-3;
+        }
+      }
+      if (aligned)
+      {
+        itkDebugMacro(<< "Image #" << imageIndex << " is aligned with the output grid (offset " << offset << ")");
+        m_AlignedInputs[imageIndex]       = true;
+        m_AlignedInputOffsets[imageIndex] = offset;
+      }
+    }
+  }
+
+  // Bins index: about one bin per input in the output image
+  const unsigned int binsPerDimension = vnl_math_max(1U, vnl_math_min(256U, static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(nbInputs))))));
+  for (unsigned int dim = 0; dim < 2; ++dim)
+  {
+    m_FootprintBinSize[dim]      = vnl_math_max(1UL, static_cast<unsigned long>(std::ceil(static_cast<double>(outputRegion.GetSize()[dim]) / binsPerDimension)));
+    m_NumberOfFootprintBins[dim] = (outputRegion.GetSize()[dim] + m_FootprintBinSize[dim] - 1) / m_FootprintBinSize[dim];
+  }
+  m_FootprintBins.assign(m_NumberOfFootprintBins[0] * m_NumberOfFootprintBins[1], IndicesListType());
+
+  for (unsigned int imageIndex = 0; imageIndex < nbInputs; ++imageIndex)
+  {
+    const OutputImageRegionType& footprint = m_InputFootprints[imageIndex];
+    if (footprint.GetNumberOfPixels() == 0)
+    {
+      continue;
+    }
+    const unsigned long binStartX = (footprint.GetIndex()[0] - outputRegion.GetIndex()[0]) / m_FootprintBinSize[0];
+    const unsigned long binStartY = (footprint.GetIndex()[1] - outputRegion.GetIndex()[1]) / m_FootprintBinSize[1];
+    const unsigned long binEndX   = (footprint.GetUpperIndex()[0] - outputRegion.GetIndex()[0]) / m_FootprintBinSize[0];
+    const unsigned long binEndY   = (footprint.GetUpperIndex()[1] - outputRegion.GetIndex()[1]) / m_FootprintBinSize[1];
+    for (unsigned long binY = binStartY; binY <= binEndY; ++binY)
+    {
+      for (unsigned long binX = binStartX; binX <= binEndX; ++binX)
+      {
+        m_FootprintBins[binY * m_NumberOfFootprintBins[0] + binX].push_back(imageIndex);
+      }
+    }
+  }
+}
+
+/**
+ * Find the inputs whose footprint intersects a region of the output image
+ */
+template <class TInputImage, class TOutputImage, class TInternalValueType>
+void StreamingMosaicFilterBase<TInputImage, TOutputImage, TInternalValueType>::FindInputsOverlappingRegion(const OutputImageRegionType& region,
+                                                                                                           IndicesListType&             indices) const
+{
+  indices.clear();
+
+  // Index not built: all the inputs may overlap
+  if (m_InputFootprints.size() != this->GetNumberOfInputs() || m_FootprintBins.empty())
+  {
+    for (unsigned int i = 0; i < this->GetNumberOfInputs(); ++i)
+    {
+      indices.push_back(i);
+    }
+    return;
+  }
+
+  const OutputImageRegionType& outputRegion  = this->GetOutput()->GetLargestPossibleRegion();
+  OutputImageRegionType        croppedRegion = region;
+  if (!croppedRegion.Crop(outputRegion))
+  {
+    return;
+  }
+
+  const unsigned long binStartX = (croppedRegion.GetIndex()[0] - outputRegion.GetIndex()[0]) / m_FootprintBinSize[0];
+  const unsigned long binStartY = (croppedRegion.GetIndex()[1] - outputRegion.GetIndex()[1]) / m_FootprintBinSize[1];
+  const unsigned long binEndX   = (croppedRegion.GetUpperIndex()[0] - outputRegion.GetIndex()[0]) / m_FootprintBinSize[0];
+  const unsigned long binEndY   = (croppedRegion.GetUpperIndex()[1] - outputRegion.GetIndex()[1]) / m_FootprintBinSize[1];
+  for (unsigned long binY = binStartY; binY <= binEndY; ++binY)
+  {
+    for (unsigned long binX = binStartX; binX <= binEndX; ++binX)
+    {
+      for (auto imageIndex : m_FootprintBins[binY * m_NumberOfFootprintBins[0] + binX])
+      {
+        OutputImageRegionType intersection = m_InputFootprints[imageIndex];
+        if (intersection.Crop(croppedRegion))
+        {
+          indices.push_back(imageIndex);
+        }
+      }
+    }
+  }
+
+  // An input can be found in several bins
+  std::sort(indices.begin(), indices.end());
+  indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+}
+
 /** Check if scales and shifts are good */
 template <class TInputImage, class TOutputImage, class TInternalValueType>
 void StreamingMosaicFilterBase<TInputImage, TOutputImage, TInternalValueType>::CheckShiftScaleMatrices()
@@ -358,6 +582,9 @@ void StreamingMosaicFilterBase<TInputImage, TOutputImage, TInternalValueType>::G
   outputPtr->SetNumberOfComponentsPerPixel(nbOfBands);
   outputPtr->SetLargestPossibleRegion(outputRegion);
 
+  // Index the input footprints in the output grid
+  ComputeInputFootprints();
+
   itkDebugMacro(<< "Output mosaic parameters:"
                 << "\n\tBands  : " << nbOfBands << "\n\tOrigin : " << m_OutputOrigin << "\n\tSize   : " << m_OutputSize << "\n\tSpacing: " << m_OutputSpacing);
 
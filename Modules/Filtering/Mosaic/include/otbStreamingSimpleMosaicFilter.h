@@ -38,6 +38,10 @@ namespace otb
  * The behavior of the filter is to put layers in the same order
  * as they are in input
  *
+ * Each thread only visits the inputs whose footprint intersects its
+ * region, and the pixels of inputs aligned with the output grid are read
+ * without interpolation (see StreamingMosaicFilterBase).
+ *
  * \ingroup OTBMosaic
  */
 template <class TInputImage, class TOutputImage = TInputImage, class TInternalValueType = double>
@@ -62,6 +66,7 @@ public:
   typedef typename Superclass::IteratorType            IteratorType;
   typedef typename Superclass::InterpolatorPointerType InterpolatorPointerType;
   typedef typename Superclass::InputImageRegionType    InputImageRegionType;
+  typedef typename Superclass::InputImageIndexType     InputImageIndexType;
 
   /** Output image typedefs.  */
   typedef typename Superclass::OutputImageType              OutputImageType;
@@ -69,6 +74,7 @@ public:
   typedef typename Superclass::OutputImagePixelType         OutputImagePixelType;
   typedef typename Superclass::OutputImageInternalPixelType OutputImageInternalPixelType;
   typedef typename Superclass::OutputImageRegionType        OutputImageRegionType;
+  typedef typename Superclass::OutputImageIndexType         OutputImageIndexType;
 
   /** Internal computing typedef support. */
   typedef typename Superclass::InternalValueType InternalValueType;
@@ -62,6 +62,18 @@ void StreamingSimpleMosaicFilter<TInputImage, TOutputImage, TInternalValueType>:
   typename std::vector<InterpolatorPointerType> interp;
   Superclass::PrepareImageAccessors(currentImage, interp);
 
+  // Keep only the used input images whose footprint intersects the thread
+  // region (in the same order)
+  std::vector<unsigned int> threadInputs;
+  for (unsigned int i = 0; i < nbOfUsedInputImages; i++)
+  {
+    OutputImageRegionType intersection = this->GetInputFootprint(Superclass::GetUsedInputImageIndice(i));
+    if (intersection.Crop(outputRegionForThread))
+    {
+      threadInputs.push_back(i);
+    }
+  }
+
   // Container for geo coordinates
   OutputImagePointType geoPoint;
 
@@ -71,43 +83,65 @@ void StreamingSimpleMosaicFilter<TInputImage, TOutputImage, TInternalValueType>:
     OutputImagePixelType outputPixel(Superclass::GetNoDataOutputPixel());
 
     // Current pixel --> Geographical point
-    mosaicImage->TransformIndexToPhysicalPoint(outputIt.GetIndex(), geoPoint);
+    const OutputImageIndexType& outputIndex = outputIt.GetIndex();
+    mosaicImage->TransformIndexToPhysicalPoint(outputIndex, geoPoint);
 
     // Loop on used input images
-    for (unsigned int i = 0; i < nbOfUsedInputImages; i++)
+    for (auto i : threadInputs)
     {
       // Get the input image pointer
       unsigned int imgIndex = Superclass::GetUsedInputImageIndice(i);
 
+      // Skip the input if the pixel is outside its footprint
+      if (!this->GetInputFootprint(imgIndex).IsInside(outputIndex))
+      {
+        continue;
+      }
+
+      // Compute the input pixel value, either directly when the input grid
+      // is aligned with the output grid, or by interpolation
+      InputImagePixelType interpolatedPixel;
+      if (this->IsInputGridAligned(imgIndex))
+      {
+        const InputImageIndexType inputIndex = outputIndex + this->GetAlignedInputOffset(imgIndex);
+        if (!currentImage[i]->GetBufferedRegion().IsInside(inputIndex))
+        {
+          continue;
+        }
+        interpolatedPixel = currentImage[i]->GetPixel(inputIndex);
+      }
       // Check if the point is inside the transformed thread region
       // (i.e. the region in the current input image which match the thread
       // region)
-      if (interp[i]->IsInsideBuffer(geoPoint))
+      else if (interp[i]->IsInsideBuffer(geoPoint))
       {
-
         // Compute the interpolated pixel value
-        InputImagePixelType interpolatedPixel = interp[i]->Evaluate(geoPoint);
+        interpolatedPixel = interp[i]->Evaluate(geoPoint);
+      }
+      else
+      {
+        continue;
+      }
 
-        // Check that interpolated pixel is not empty
-        if (Superclass::IsPixelNotEmpty(interpolatedPixel))
+      // Check that interpolated pixel is not empty
+      if (Superclass::IsPixelNotEmpty(interpolatedPixel))
+      {
+        // Update the output pixel
+        for (unsigned int band = 0; band < nBands; band++)
         {
-          // Update the output pixel
-          for (unsigned int band = 0; band < nBands; band++)
+          if (this->GetShiftScaleInputImages())
+          {
+            InternalValueType pixelValue = static_cast<InternalValueType>(interpolatedPixel[band]);
+            this->ShiftScaleValue(pixelValue, imgIndex, band);
+            outputPixel[band] = static_cast<OutputImageInternalPixelType>(pixelValue);
+          }
+          else
           {
-            if (this->GetShiftScaleInputImages())
-            {
-              InternalValueType pixelValue = static_cast<InternalValueType>(interpolatedPixel[band]);
-              this->ShiftScaleValue(pixelValue, imgIndex, band);
-              outputPixel[band] = static_cast<OutputImageInternalPixelType>(pixelValue);
-            }
-            else
-            {
-              outputPixel[band] = static_cast<OutputImageInternalPixelType>(interpolatedPixel[band]);
-            }
+            outputPixel[band] = static_cast<OutputImageInternalPixelType>(interpolatedPixel[band]);
           }
-        } // Interpolated pixel is not empty
-      }   // point inside buffer
-    }     // next image
+        }
+      } // Interpolated pixel is not empty
+    }   // next image
 
     // Update output pixel value
     outputIt.Set(outputPixel);
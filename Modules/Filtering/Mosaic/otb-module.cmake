@@ -30,6 +30,7 @@ otb_module(OTBMosaic
     OTBFunctor
 
   TEST_DEPENDS
+    OTBTestKernel
 
   DESCRIPTION
     "${DOCUMENTATION}"
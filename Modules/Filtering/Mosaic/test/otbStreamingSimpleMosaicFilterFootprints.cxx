@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbStreamingSimpleMosaicFilter.h"
+#include "otbVectorImage.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include <iostream>
+
+namespace
+{
+typedef otb::VectorImage<float, 2> ImageType;
+
+/** Mosaic filter exposing the footprints index, to check which inputs are
+ *  pruned or read without interpolation */
+class FootprintsMosaicFilter : public otb::StreamingSimpleMosaicFilter<ImageType>
+{
+public:
+  typedef FootprintsMosaicFilter                      Self;
+  typedef otb::StreamingSimpleMosaicFilter<ImageType> Superclass;
+  typedef itk::SmartPointer<Self>                     Pointer;
+
+  itkNewMacro(Self);
+
+  using Superclass::GetInputFootprint;
+  using Superclass::IsInputGridAligned;
+};
+
+// Two bands image, without no-data pixel except on the columns multiple of
+// holesStep (if not 0)
+ImageType::Pointer CreateImage(double originX, double originY, double spacing, unsigned int sizeX, unsigned int sizeY, float base, unsigned int holesStep)
+{
+  ImageType::Pointer image = ImageType::New();
+
+  ImageType::RegionType region;
+  region.GetModifiableIndex().Fill(0);
+  region.GetModifiableSize()[0] = sizeX;
+  region.GetModifiableSize()[1] = sizeY;
+
+  ImageType::PointType origin;
+  origin[0] = originX;
+  origin[1] = originY;
+  ImageType::SpacingType signedSpacing;
+  signedSpacing[0] = spacing;
+  signedSpacing[1] = -spacing;
+
+  image->SetRegions(region);
+  image->SetOrigin(origin);
+  image->SetSignedSpacing(signedSpacing);
+  image->SetNumberOfComponentsPerPixel(2);
+  image->Allocate();
+
+  ImageType::PixelType pixel(2);
+  for (itk::ImageRegionIteratorWithIndex<ImageType> it(image, region); !it.IsAtEnd(); ++it)
+  {
+    const ImageType::IndexType& index = it.GetIndex();
+    if (holesStep != 0 && index[0] % holesStep == 0)
+    {
+      pixel.Fill(0);
+    }
+    else
+    {
+      pixel[0] = base + index[0] + 50 * index[1];
+      pixel[1] = base;
+    }
+    it.Set(pixel);
+  }
+  return image;
+}
+}
+
+int otbStreamingSimpleMosaicFilterFootprints(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  // Inputs, in blending order:
+  //  #0 and #1 are aligned with the output grid (#1 has no-data columns)
+  //  #2 is shifted by half a pixel, #4 has a finer spacing
+  //  #3 is outside the output image
+  std::vector<ImageType::Pointer> inputs;
+  inputs.push_back(CreateImage(0., 0., 1., 30, 25, 1000.f, 0));
+  inputs.push_back(CreateImage(20., -15., 1., 25, 30, 2000.f, 7));
+  inputs.push_back(CreateImage(35.5, -20.5, 1., 20, 20, 3000.f, 0));
+  inputs.push_back(CreateImage(500., -500., 1., 10, 10, 4000.f, 0));
+  inputs.push_back(CreateImage(5.25, -30.25, 0.5, 40, 40, 5000.f, 0));
+
+  ImageType::PointType outputOrigin;
+  outputOrigin[0] = 0.;
+  outputOrigin[1] = 0.;
+  ImageType::SpacingType outputSpacing;
+  outputSpacing[0] = 1.;
+  outputSpacing[1] = -1.;
+  ImageType::SizeType outputSize;
+  outputSize[0] = 60;
+  outputSize[1] = 50;
+
+  std::vector<ImageType::Pointer> outputs;
+  int                             status = EXIT_SUCCESS;
+
+  for (unsigned int useFootprints = 0; useFootprints < 2; ++useFootprints)
+  {
+    FootprintsMosaicFilter::Pointer mosaic = FootprintsMosaicFilter::New();
+    for (unsigned int i = 0; i < inputs.size(); ++i)
+    {
+      mosaic->PushBackInput(inputs[i]);
+    }
+    mosaic->SetAutomaticOutputParametersComputation(false);
+    mosaic->SetOutputOrigin(outputOrigin);
+    mosaic->SetOutputSpacing(outputSpacing);
+    mosaic->SetOutputSize(outputSize);
+    mosaic->SetUseInputFootprints(useFootprints == 1);
+
+    // Stream by strips, so that some strips do not intersect some inputs
+    typedef itk::StreamingImageFilter<ImageType, ImageType> StreamerType;
+    StreamerType::Pointer streamer = StreamerType::New();
+    streamer->SetInput(mosaic->GetOutput());
+    streamer->SetNumberOfStreamDivisions(5);
+    streamer->Update();
+    outputs.push_back(streamer->GetOutput());
+
+    const bool expectedAligned[] = {true, true, false, false, false};
+    for (unsigned int i = 0; i < inputs.size(); ++i)
+    {
+      if (mosaic->IsInputGridAligned(i) != (useFootprints && expectedAligned[i]))
+      {
+        std::cerr << "Input #" << i << (mosaic->IsInputGridAligned(i) ? " is" : " is not") << " read without interpolation (footprints "
+                  << (useFootprints ? "on" : "off") << ")" << std::endl;
+        status = EXIT_FAILURE;
+      }
+    }
+    if (useFootprints && mosaic->GetInputFootprint(3).GetNumberOfPixels() != 0)
+    {
+      std::cerr << "Input #3 is outside the output image but has the footprint " << mosaic->GetInputFootprint(3) << std::endl;
+      status = EXIT_FAILURE;
+    }
+  }
+
+  // The pruned mosaic must be the one computed from all the inputs, with
+  // the interpolator everywhere
+  unsigned long nbDifferences = 0, nbValidPixels = 0;
+  for (itk::ImageRegionConstIterator<ImageType> itRef(outputs[0], outputs[0]->GetLargestPossibleRegion()),
+       itPruned(outputs[1], outputs[1]->GetLargestPossibleRegion());
+       !itRef.IsAtEnd(); ++itRef, ++itPruned)
+  {
+    if (itRef.Get() != itPruned.Get())
+    {
+      ++nbDifferences;
+    }
+    if (itRef.Get()[1] != 0)
+    {
+      ++nbValidPixels;
+    }
+  }
+
+  std::cout << nbValidPixels << " valid pixels, " << nbDifferences << " differences between the mosaics computed with and without footprints" << std::endl;
+
+  if (nbDifferences != 0)
+  {
+    status = EXIT_FAILURE;
+  }
+  if (nbValidPixels == 0)
+  {
+    std::cerr << "The mosaic is empty" << std::endl;
+    status = EXIT_FAILURE;
+  }
+  return status;
+}
@@ -106,6 +106,17 @@ public:
 
   otbGetObjectMemberConstReferenceMacro(Resampler, DisplacementFieldSpacing, SpacingType);
 
+  /** Maximum error (in input pixels) allowed when approximating the
+   * transform on the displacement field. 0 means exact evaluation. */
+  otbSetObjectMemberMacro(Resampler, ApproximationTolerance, double);
+  otbGetObjectMemberConstMacro(Resampler, ApproximationTolerance, double);
+
+  /** Approximation error achieved during the last update, in input pixels */
+  double GetMaximumApproximationError() const
+  {
+    return m_Resampler->GetMaximumApproximationError();
+  }
+
   /** The resampled image parameters */
   /** Output Origin */
   void SetOutputOrigin(const OriginType& origin)
@@ -27,6 +27,8 @@
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include <algorithm>
+#include <limits>
+#include <vector>
 
 
 namespace otb
@@ -137,6 +139,34 @@ public:
   }
 };
 
+/** \class KernelTraits
+ *
+ * Support of a kernel, i.e. the squared norm above which the kernel is
+ * zero. Neighbors are rejected as soon as the partial squared norm of their
+ * difference exceeds it, without evaluating the remaining components.
+ * Kernels with an unbounded support (the default) are evaluated for every
+ * neighbor.
+ *
+ * \ingroup OTBSmoothing
+ */
+template <class TKernel>
+struct KernelTraits
+{
+  static double GetSupport()
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+};
+
+template <>
+struct KernelTraits<KernelUniform>
+{
+  static double GetSupport()
+  {
+    return 1.0;
+  }
+};
+
 /** \class FastImageRegionConstIterator
  *
  * Iterator for reading pixels over an image region, specialized for faster
@@ -432,6 +462,20 @@ private:
  * spatial bandwidth parameter to the spatial radius defining how many pixels
  * are in the processing window local to a pixel.
  *
+ * When the kernel has a bounded support (see Meanshift::KernelTraits, which
+ * is the case of KernelUniform), the squared norm of each neighbor is
+ * accumulated spatial components first, and the neighbor is rejected as soon
+ * as the partial norm leaves the support. With a small range bandwidth, most
+ * neighbors are rejected after a few components. The result is identical to
+ * the full evaluation. The pixels of the joint image are also indexed by line
+ * and by bin of their first range component (bins of about RangeBandwidth,
+ * 256 at most), so that only the pixels of the spatial window whose value can
+ * be in the support are visited. They are visited in the same order as the
+ * window, so that the sums, and thus the results, are the same as without
+ * index. The index holds one 32 bits integer per pixel of the input buffered
+ * region. Contrary to the bucket mode (BucketImage, disabled), it does not
+ * change the summation order.
+ *
  * MeanShifVector squared norm is compared with Threshold (set using Get/Set accessor) to define pixel convergence (1e-3 by default).
  * MaxIterationNumber defines maximum iteration number for each pixel convergence (set using Get/Set accessor). Set to 4 by default.
  * ModeSearch is a boolean value, to choose between optimized and non optimized algorithm. If set to true (by default), assign mode value to each pixel on a
@@ -608,6 +652,10 @@ protected:
 
   virtual void CalculateMeanShiftVector(const typename RealVectorImageType::Pointer inputImagePtr, const RealVector& jointPixel,
                                         const OutputRegionType& outputRegion, const RealVector& bandwidth, RealVector& meanShiftVector);
+
+  /** Index the pixels of the joint image by line and by bin of their first
+   * range component, when the kernel has a bounded support */
+  void BuildRangeIndex();
 #if 0
   virtual void CalculateMeanShiftVectorBucket(const RealVector& jointPixel, RealVector& meanShiftVector);
 #endif
@@ -666,6 +714,18 @@ private:
    of labels */
   unsigned int m_ThreadIdNumberOfBits;
 
+  /** Index of the joint image pixels: for each line of m_RangeIndexRegion
+   * and each bin of the first range component (plus a last bin for the non
+   * finite values), m_RangeIndexStarts gives the first of their columns in
+   * m_RangeIndexColumns, sorted in increasing order */
+  std::vector<unsigned long> m_RangeIndexStarts;
+  std::vector<unsigned int>  m_RangeIndexColumns;
+  RegionType                 m_RangeIndexRegion;
+  RealType                   m_RangeIndexMinimum;
+  RealType                   m_RangeIndexBinWidth;
+  unsigned int               m_RangeIndexNumberOfBins;
+  bool                       m_UseRangeIndex;
+
 #if 0
   typedef Meanshift::BucketImage<RealVectorImageType> BucketImageType;
   BucketImageType m_BucketImage;
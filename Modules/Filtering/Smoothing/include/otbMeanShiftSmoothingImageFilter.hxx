@@ -29,6 +29,8 @@
 
 #include "itkProgressReporter.h"
 
+#include <cmath>
+
 
 namespace otb
 {
@@ -48,7 +50,11 @@ MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterati
     // , m_ModeTable(0)
     ,
     m_ModeSearch(false),
-    m_ThreadIdNumberOfBits(0)
+    m_ThreadIdNumberOfBits(0),
+    m_RangeIndexMinimum(0),
+    m_RangeIndexBinWidth(1),
+    m_RangeIndexNumberOfBins(0),
+    m_UseRangeIndex(false)
 #if 0
       , m_BucketOptimization(false)
 #endif
@@ -261,6 +267,8 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
   jointImageFunctor->Update();
   m_JointImage = jointImageFunctor->GetOutput();
 
+  this->BuildRangeIndex();
+
 #if 0
   if (m_BucketOptimization)
     {
@@ -344,6 +352,89 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
   }
 }
 
+// Sorts the pixels of the joint image by line and by bin of their first range component
+template <class TInputImage, class TOutputImage, class TKernel, class TOutputIterationImage>
+void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterationImage>::BuildRangeIndex()
+{
+  m_RangeIndexStarts.clear();
+  m_RangeIndexColumns.clear();
+
+  // Without a bounded support, every neighbor has to be evaluated
+  m_RangeIndexRegion = m_JointImage->GetBufferedRegion();
+  m_UseRangeIndex    = std::isfinite(Meanshift::KernelTraits<KernelType>::GetSupport()) && m_NumberOfComponentsPerPixel > 0 &&
+                    m_RangeIndexRegion.GetNumberOfPixels() > 0;
+  if (!m_UseRangeIndex)
+  {
+    return;
+  }
+
+  const unsigned int  jointDimension = ImageDimension + m_NumberOfComponentsPerPixel;
+  const unsigned long nbPixels       = m_RangeIndexRegion.GetNumberOfPixels();
+  const unsigned long lineLength     = m_RangeIndexRegion.GetSize()[0];
+  const unsigned long nbLines        = nbPixels / lineLength;
+  const RealType*     values         = m_JointImage->GetBufferPointer() + ImageDimension;
+
+  // Range of the finite values
+  RealType minimum = std::numeric_limits<RealType>::infinity();
+  RealType maximum = -std::numeric_limits<RealType>::infinity();
+  for (unsigned long i = 0; i < nbPixels; ++i)
+  {
+    const RealType value = values[i * jointDimension];
+    if (std::isfinite(value))
+    {
+      minimum = std::min(minimum, value);
+      maximum = std::max(maximum, value);
+    }
+  }
+  if (minimum > maximum)
+  {
+    minimum = 0;
+    maximum = 0;
+  }
+
+  // Bins of about the range bandwidth, in a bounded number. They are also
+  // wide enough for the rounding errors of the queries to stay far below
+  // one bin.
+  const unsigned int maximumNumberOfBins = 256;
+  RealType           binWidth            = std::abs(m_RangeBandwidth);
+  binWidth                               = std::max(binWidth, (maximum - minimum) / (maximumNumberOfBins - 1));
+  binWidth                               = std::max(binWidth, (std::abs(minimum) + std::abs(maximum)) * 1e-9);
+  if (!(binWidth > 0) || !std::isfinite(binWidth))
+  {
+    binWidth = 1;
+  }
+  m_RangeIndexMinimum      = minimum;
+  m_RangeIndexBinWidth     = binWidth;
+  m_RangeIndexNumberOfBins = std::min(static_cast<unsigned int>((maximum - minimum) / binWidth) + 1, maximumNumberOfBins);
+
+  // Non finite values go to an extra bin, which is always visited
+  const unsigned int nbBins = m_RangeIndexNumberOfBins + 1;
+  auto               binOf  = [this](RealType value) -> unsigned int {
+    if (!std::isfinite(value))
+    {
+      return m_RangeIndexNumberOfBins;
+    }
+    return std::min(static_cast<unsigned int>((value - m_RangeIndexMinimum) / m_RangeIndexBinWidth), m_RangeIndexNumberOfBins - 1);
+  };
+
+  // Counting sort: the columns of each line and bin stay in increasing order
+  m_RangeIndexStarts.assign(nbLines * nbBins + 1, 0);
+  for (unsigned long i = 0; i < nbPixels; ++i)
+  {
+    ++m_RangeIndexStarts[(i / lineLength) * nbBins + binOf(values[i * jointDimension]) + 1];
+  }
+  for (unsigned long i = 1; i < m_RangeIndexStarts.size(); ++i)
+  {
+    m_RangeIndexStarts[i] += m_RangeIndexStarts[i - 1];
+  }
+  m_RangeIndexColumns.resize(nbPixels);
+  std::vector<unsigned long> next(m_RangeIndexStarts.begin(), m_RangeIndexStarts.end() - 1);
+  for (unsigned long i = 0; i < nbPixels; ++i)
+  {
+    m_RangeIndexColumns[next[(i / lineLength) * nbBins + binOf(values[i * jointDimension])]++] = static_cast<unsigned int>(i % lineLength);
+  }
+}
+
 // Calculates the mean shift vector at the position given by jointPixel
 template <class TInputImage, class TOutputImage, class TKernel, class TOutputIterationImage>
 void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterationImage>::CalculateMeanShiftVector(
@@ -379,58 +470,35 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
   RealType   weightSum = 0;
   RealVector shifts(jointDimension);
 
-  // An iterator on the neighborhood of the current pixel (in joint
-  // spatial-range domain)
-  otb::Meanshift::FastImageRegionConstIterator<RealVectorImageType> it(jointImage, neighborhoodRegion);
-  // itk::ImageRegionConstIterator<RealVectorImageType> it(jointImage, neighborhoodRegion);
+  // Squared norm above which the kernel is zero
+  const RealType support = Meanshift::KernelTraits<KernelType>::GetSupport();
 
-  it.GoToBegin();
-  while (!it.IsAtEnd())
-  {
-    const RealType* jointNeighbor = it.GetPixelPointer();
+  // Raw pointers on the vectors used in the inner loops
+  const RealType* pixel         = jointPixel.GetDataPointer();
+  const RealType* bandwidthData = bandwidth.GetDataPointer();
+  RealType*       shiftData     = shifts.GetDataPointer();
+  RealType*       meanShiftData = meanShiftVector.GetDataPointer();
 
-    // Compute the squared norm of the difference
+  // Accumulates the contribution of a neighbor
+  auto accumulate = [&](const RealType* jointNeighbor) {
+    // Compute the squared norm of the difference, spatial components
+    // first. The neighbor is rejected as soon as the partial norm leaves
+    // the kernel support: its weight would be zero.
     // This is the L2 norm, TODO: replace by the templated norm
     RealType norm2 = 0;
     for (unsigned int comp = 0; comp < jointDimension; comp++)
     {
-      shifts[comp] = jointNeighbor[comp] - jointPixel[comp];
-      double d     = shifts[comp] / bandwidth[comp];
+      shiftData[comp] = jointNeighbor[comp] - pixel[comp];
+      const double d  = shiftData[comp] / bandwidthData[comp];
       norm2 += d * d;
+      if (norm2 > support)
+      {
+        return;
+      }
     }
 
     // Compute pixel weight from kernel
     const RealType weight = m_Kernel(norm2);
-    /*
-     // The following code is an alternative way to compute norm2 and weight
-     // It separates the norms of spatial and range elements
-     RealType spatialNorm2;
-     RealType rangeNorm2;
-     spatialNorm2 = 0;
-     for (unsigned int comp = 0; comp < ImageDimension; comp++)
-     {
-     RealType d;
-     d = jointNeighbor[comp] - jointPixel[comp];
-     spatialNorm2 += d*d;
-     }
-
-     if(spatialNorm2 >= 1.0)
-     {
-     weight = 0;
-     }
-     else
-     {
-     rangeNorm2 = 0;
-     for (unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; comp++)
-     {
-     RealType d;
-     d = jointNeighbor[ImageDimension + comp] - jointPixel[ImageDimension + comp];
-     rangeNorm2 += d*d;
-     }
-
-     weight = (rangeNorm2 <= 1.0)? 1.0 : 0.0;
-     }
-     */
 
     // Update sum of weights
     weightSum += weight;
@@ -438,10 +506,110 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
     // Update mean shift vector
     for (unsigned int comp = 0; comp < jointDimension; comp++)
     {
-      meanShiftVector[comp] += weight * shifts[comp];
+      meanShiftData[comp] += weight * shiftData[comp];
+    }
+  };
+
+  if (m_UseRangeIndex && jointImage == m_JointImage && neighborhoodRegion.GetNumberOfPixels() > 0)
+  {
+    // Only the bins of the first range component which may hold a value in
+    // the kernel support are visited, with one more bin on each side for the
+    // rounding errors. All the bins are visited when the support is not
+    // a finite interval.
+    const unsigned int nbBins   = m_RangeIndexNumberOfBins + 1;
+    const RealType     value    = pixel[ImageDimension];
+    const RealType     radius   = std::sqrt(support) * std::abs(bandwidthData[ImageDimension]);
+    unsigned int       firstBin = 0;
+    unsigned int       lastBin  = m_RangeIndexNumberOfBins - 1;
+    if (std::isfinite(value) && std::isfinite(radius) && radius > 0)
+    {
+      const RealType low  = std::floor((value - radius - m_RangeIndexMinimum) / m_RangeIndexBinWidth) - 1;
+      const RealType high = std::floor((value + radius - m_RangeIndexMinimum) / m_RangeIndexBinWidth) + 1;
+      if (high < 0 || low > lastBin)
+      {
+        // Only non finite values may be in the support
+        firstBin = 1;
+        lastBin  = 0;
+      }
+      else
+      {
+        firstBin = static_cast<unsigned int>(std::max(low, 0.));
+        lastBin  = static_cast<unsigned int>(std::min(high, static_cast<RealType>(lastBin)));
+      }
     }
 
-    ++it;
+    const RealType*     buffer      = jointImage->GetBufferPointer();
+    const unsigned long lineLength  = m_RangeIndexRegion.GetSize()[0];
+    const unsigned int  firstColumn = regionIndex[0] - m_RangeIndexRegion.GetIndex()[0];
+    const unsigned int  lastColumn  = firstColumn + regionSize[0] - 1;
+    const unsigned long nbLines     = neighborhoodRegion.GetNumberOfPixels() / regionSize[0];
+
+    std::vector<unsigned int> columns;
+    columns.reserve(regionSize[0]);
+    InputIndexType lineIndex = regionIndex;
+    for (unsigned long l = 0; l < nbLines; ++l)
+    {
+      // Line of lineIndex in the index
+      unsigned long line   = 0;
+      unsigned long stride = 1;
+      for (unsigned int dim = 1; dim < ImageDimension; ++dim)
+      {
+        line += (lineIndex[dim] - m_RangeIndexRegion.GetIndex()[dim]) * stride;
+        stride *= m_RangeIndexRegion.GetSize()[dim];
+      }
+
+      // Columns of the window in the visited bins
+      columns.clear();
+      unsigned int nbVisitedBins = 0;
+      auto         addBin        = [&](unsigned int bin) {
+        const unsigned int* first = m_RangeIndexColumns.data() + m_RangeIndexStarts[line * nbBins + bin];
+        const unsigned int* last  = m_RangeIndexColumns.data() + m_RangeIndexStarts[line * nbBins + bin + 1];
+        first                     = std::lower_bound(first, last, firstColumn);
+        last                      = std::upper_bound(first, last, lastColumn);
+        if (first != last)
+        {
+          columns.insert(columns.end(), first, last);
+          ++nbVisitedBins;
+        }
+      };
+      for (unsigned int bin = firstBin; bin <= lastBin; ++bin)
+      {
+        addBin(bin);
+      }
+      addBin(m_RangeIndexNumberOfBins);
+
+      // Neighbors are visited in the order of the image, as without index,
+      // so that the sums are identical
+      if (nbVisitedBins > 1)
+      {
+        std::sort(columns.begin(), columns.end());
+      }
+      const RealType* lineBuffer = buffer + line * lineLength * jointDimension;
+      for (unsigned int column : columns)
+      {
+        accumulate(lineBuffer + column * jointDimension);
+      }
+
+      // Next line of the window
+      for (unsigned int dim = 1; dim < ImageDimension; ++dim)
+      {
+        if (++lineIndex[dim] < static_cast<InputIndexValueType>(regionIndex[dim] + regionSize[dim]))
+        {
+          break;
+        }
+        lineIndex[dim] = regionIndex[dim];
+      }
+    }
+  }
+  else
+  {
+    // An iterator on the neighborhood of the current pixel (in joint
+    // spatial-range domain)
+    otb::Meanshift::FastImageRegionConstIterator<RealVectorImageType> it(jointImage, neighborhoodRegion);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      accumulate(it.GetPixelPointer());
+    }
   }
 
   if (weightSum > 0)
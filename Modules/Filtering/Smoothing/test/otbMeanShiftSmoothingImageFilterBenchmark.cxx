@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "itkMacro.h"
+#include "itkTimeProbe.h"
+#include "itkImageRegionConstIterator.h"
+#include "otbImageFileReader.h"
+#include "otbMeanShiftSmoothingImageFilter.h"
+
+namespace
+{
+/** Uniform kernel without Meanshift::KernelTraits: every neighbor of the
+ *  window is visited and fully evaluated, without early rejection nor range
+ *  index */
+class KernelUniformFullEvaluation : public otb::Meanshift::KernelUniform
+{
+};
+}
+
+int otbMeanShiftSmoothingImageFilterBenchmark(int argc, char* argv[])
+{
+  if (argc < 5 || (argc - 3) % 2 != 0)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputFileName maxIterationNumber spatialBandwidth rangeBandwidth [spatialBandwidth rangeBandwidth ...]"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const char*        inputFileName      = argv[1];
+  const unsigned int maxIterationNumber = atoi(argv[2]);
+
+  const unsigned int Dimension = 2;
+  typedef float      PixelType;
+  typedef otb::VectorImage<PixelType, Dimension> ImageType;
+  typedef otb::ImageFileReader<ImageType> ReaderType;
+  typedef otb::MeanShiftSmoothingImageFilter<ImageType, ImageType> FilterType;
+  typedef otb::MeanShiftSmoothingImageFilter<ImageType, ImageType, KernelUniformFullEvaluation> FullEvaluationFilterType;
+  typedef FilterType::OutputIterationImageType IterationImageType;
+  typedef itk::ImageRegionConstIterator<IterationImageType> IterationIteratorType;
+  typedef itk::ImageRegionConstIterator<ImageType>          IteratorType;
+
+  // Read the input once, so that only the filters are timed
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFileName);
+  reader->Update();
+
+  const unsigned long nbPixels = reader->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels();
+  int                 status   = EXIT_SUCCESS;
+
+  std::cout << "spatialr\tranger\tmodesearch\titerations\titerations/pixel\ttime(s)\tfull evaluation time(s)\tspeedup" << std::endl;
+
+  for (int arg = 3; arg + 1 < argc; arg += 2)
+  {
+    const double spatialBandwidth = atof(argv[arg]);
+    const double rangeBandwidth   = atof(argv[arg + 1]);
+
+    for (unsigned int modeSearch = 0; modeSearch < 2; ++modeSearch)
+    {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput(reader->GetOutput());
+      filter->SetSpatialBandwidth(spatialBandwidth);
+      filter->SetRangeBandwidth(rangeBandwidth);
+      filter->SetMaxIterationNumber(maxIterationNumber);
+      filter->SetModeSearch(modeSearch != 0);
+
+      FullEvaluationFilterType::Pointer fullFilter = FullEvaluationFilterType::New();
+      fullFilter->SetInput(reader->GetOutput());
+      fullFilter->SetSpatialBandwidth(spatialBandwidth);
+      fullFilter->SetRangeBandwidth(rangeBandwidth);
+      fullFilter->SetMaxIterationNumber(maxIterationNumber);
+      fullFilter->SetModeSearch(modeSearch != 0);
+
+      itk::TimeProbe chrono;
+      chrono.Start();
+      filter->Update();
+      chrono.Stop();
+
+      itk::TimeProbe fullChrono;
+      fullChrono.Start();
+      fullFilter->Update();
+      fullChrono.Stop();
+
+      // With mode search, pixels assigned along a convergence path keep
+      // their own (smaller) iteration count
+      unsigned long         iterations = 0, iterationDifferences = 0;
+      IterationIteratorType it(filter->GetIterationOutput(), filter->GetIterationOutput()->GetLargestPossibleRegion());
+      IterationIteratorType fullIt(fullFilter->GetIterationOutput(), fullFilter->GetIterationOutput()->GetLargestPossibleRegion());
+      for (it.GoToBegin(), fullIt.GoToBegin(); !it.IsAtEnd(); ++it, ++fullIt)
+      {
+        iterations += it.Get();
+        if (it.Get() != fullIt.Get())
+        {
+          ++iterationDifferences;
+        }
+      }
+
+      // The early rejection and the range index only skip neighbors of zero
+      // weight, in the order of the window: the results must be identical
+      unsigned long rangeDifferences = 0;
+      IteratorType  rangeIt(filter->GetRangeOutput(), filter->GetRangeOutput()->GetLargestPossibleRegion());
+      IteratorType  fullRangeIt(fullFilter->GetRangeOutput(), fullFilter->GetRangeOutput()->GetLargestPossibleRegion());
+      for (rangeIt.GoToBegin(), fullRangeIt.GoToBegin(); !rangeIt.IsAtEnd(); ++rangeIt, ++fullRangeIt)
+      {
+        if (rangeIt.Get() != fullRangeIt.Get())
+        {
+          ++rangeDifferences;
+        }
+      }
+
+      std::cout << spatialBandwidth << "\t" << rangeBandwidth << "\t" << modeSearch << "\t" << iterations << "\t"
+                << static_cast<double>(iterations) / nbPixels << "\t" << chrono.GetTotal() << "\t" << fullChrono.GetTotal() << "\t"
+                << fullChrono.GetTotal() / chrono.GetTotal() << std::endl;
+
+      if (iterations == 0 || iterations > static_cast<unsigned long>(maxIterationNumber) * nbPixels)
+      {
+        std::cerr << "Unexpected number of iterations: " << iterations << std::endl;
+        status = EXIT_FAILURE;
+      }
+      if (iterationDifferences != 0 || rangeDifferences != 0)
+      {
+        std::cerr << "The early rejection and the range index change " << rangeDifferences << " range pixels and " << iterationDifferences << " iteration counts" << std::endl;
+        status = EXIT_FAILURE;
+      }
+    }
+  }
+
+  return status;
+}
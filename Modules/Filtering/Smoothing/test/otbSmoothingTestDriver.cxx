@@ -25,5 +25,6 @@ void RegisterTests()
   REGISTER_TEST(otbMeanShiftSmoothingImageFilter);
   REGISTER_TEST(otbMeanShiftSmoothingImageFilterSpatialStability);
   REGISTER_TEST(otbMeanShiftSmoothingImageFilterThreading);
+  REGISTER_TEST(otbMeanShiftSmoothingImageFilterBenchmark);
   REGISTER_TEST(otbFastNLMeansImageFilter);
 }
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbQuantileSketch_h
+#define otbQuantileSketch_h
+
+#include <vector>
+
+#include "OTBStatisticsExport.h"
+
+namespace otb
+{
+
+/** \class QuantileSketch
+ *
+ * \brief Approximate quantiles of a stream of values, in bounded memory
+ *
+ * Values are summarized by weighted centroids, merged so that centroids
+ * near the extreme quantiles stay small (merging t-digest, with the k1
+ * scale function). The number of centroids is about the compression
+ * parameter, whatever the number of values, and two sketches can be merged,
+ * for instance the ones of two threads or two streamed regions.
+ *
+ * The quantile q of n values is interpolated between the centroids, the
+ * i-th of n single values being at position (i + 0.5) / n. As long as
+ * centroids hold single values (a few tens of values for the default
+ * compression), quantiles are exact: the median of an even number of
+ * values is the mean of the two middle ones. Minimum and maximum are kept
+ * exactly.
+ *
+ * \ingroup OTBStatistics
+ */
+class OTBStatistics_EXPORT QuantileSketch
+{
+public:
+  explicit QuantileSketch(double compression = 100.);
+
+  /** Add a value */
+  void Add(double value);
+
+  /** Add the values summarized by another sketch */
+  void Merge(const QuantileSketch& other);
+
+  /** Quantile q in [0, 1] of the values, NaN if there is no value */
+  double GetQuantile(double q) const;
+
+  /** Number of values */
+  double GetCount() const
+  {
+    return m_Count;
+  }
+
+  double GetMinimum() const
+  {
+    return m_Minimum;
+  }
+
+  double GetMaximum() const
+  {
+    return m_Maximum;
+  }
+
+  double GetCompression() const
+  {
+    return m_Compression;
+  }
+
+  /** Number of centroids once the pending values are merged */
+  unsigned int GetNumberOfCentroids() const;
+
+private:
+  struct Centroid
+  {
+    double Mean;
+    double Weight;
+
+    bool operator<(const Centroid& other) const
+    {
+      return Mean < other.Mean;
+    }
+  };
+
+  /** Merge the pending values into the centroids */
+  void Compress() const;
+
+  double m_Compression;
+  double m_Count;
+  double m_Minimum;
+  double m_Maximum;
+
+  // Compression is done lazily, also from const accessors
+  mutable std::vector<Centroid> m_Centroids;
+  mutable std::vector<Centroid> m_Pending;
+};
+
+} // end namespace otb
+
+#endif
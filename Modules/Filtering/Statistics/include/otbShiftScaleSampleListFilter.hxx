@@ -72,14 +72,14 @@ void ShiftScaleSampleListFilter<TInputSampleList, TOutputSampleList>::GenerateDa
   itk::ProgressReporter progress(this, 0, inputSampleListPtr->Size());
 
   // Iterate on the InputSampleList
+  // The output sample is reused, PushBack() copies it
+  OutputMeasurementVectorType currentOutputMeasurement;
+  currentOutputMeasurement.SetSize(inputSampleListPtr->GetMeasurementVectorSize());
+
   while (inputIt != inputSampleListPtr->End())
   {
     // Retrieve current input sample
-    InputMeasurementVectorType currentInputMeasurement = inputIt.GetMeasurementVector();
-
-    // Build current output sample
-    OutputMeasurementVectorType currentOutputMeasurement;
-    currentOutputMeasurement.SetSize(currentInputMeasurement.GetSize());
+    const InputMeasurementVectorType& currentInputMeasurement = inputIt.GetMeasurementVector();
 
     // Center and reduce each component
     for (unsigned int idx = 0; idx < invertedScales.Size(); ++idx)
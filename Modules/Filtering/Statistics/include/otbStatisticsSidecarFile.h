@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStatisticsSidecarFile_h
+#define otbStatisticsSidecarFile_h
+
+#include <string>
+#include <vector>
+
+#include "OTBStatisticsExport.h"
+
+namespace otb
+{
+
+/** \class StatisticsSidecarFile
+ *
+ * \brief Storage of partial statistics computed by streaming filters
+ *
+ * Persistent statistics filters accumulate partial statistics for each
+ * streamed region (tile). This class stores these partials in a text
+ * sidecar file, so that a later computation over the same data can merge
+ * them instead of reading the whole image again.
+ *
+ * The file is identified by a key (typically a fingerprint of the input
+ * file, see ComputeFileFingerprint()) and a signature describing the
+ * filter settings the partials depend on. Loading a file whose key or
+ * signature differ from the expected ones fails, and the file is then
+ * rewritten by the next Save().
+ *
+ * Values are written with enough digits to be read back exactly.
+ *
+ * \ingroup OTBStatistics
+ */
+class OTBStatistics_EXPORT StatisticsSidecarFile
+{
+public:
+  /** Partial statistics of a region. Index and size have one value per
+   * image dimension. */
+  struct TileType
+  {
+    std::vector<long>          index;
+    std::vector<unsigned long> size;
+    std::vector<double>        values;
+
+    unsigned long GetNumberOfPixels() const;
+
+    /** true if this tile is entirely inside the given region */
+    bool IsInside(const std::vector<long>& regionIndex, const std::vector<unsigned long>& regionSize) const;
+
+    /** true if this tile and the other one share at least one pixel */
+    bool Overlaps(const TileType& other) const;
+
+    /** Order by row, then by column (last dimension first) */
+    bool operator<(const TileType& other) const;
+  };
+
+  StatisticsSidecarFile();
+
+  void SetKey(const std::string& key);
+  const std::string& GetKey() const;
+
+  void SetSignature(const std::string& signature);
+  const std::string& GetSignature() const;
+
+  /** Load the tiles stored in a file. Returns false (and keeps no tile)
+   * if the file does not exist, is invalid, or was written with a
+   * different key or signature. */
+  bool Load(const std::string& fileName);
+
+  /** Write the tiles to a file */
+  void Save(const std::string& fileName) const;
+
+  /** Add a tile, replacing the stored tiles it overlaps */
+  void AddTile(const TileType& tile);
+
+  const std::vector<TileType>& GetTiles() const;
+
+  void Clear();
+
+  /** Find stored tiles that exactly partition the given region. Returns
+   * false if the stored tiles inside the region leave some pixels
+   * uncovered. Found tiles are sorted (see TileType::operator<). */
+  bool FindPartition(const std::vector<long>& regionIndex, const std::vector<unsigned long>& regionSize, std::vector<TileType>& tiles) const;
+
+  /** Identify a file by its name, size and modification time. This is
+   * used instead of a checksum of the content, which would require
+   * reading the whole file. The options of an extended filename
+   * (file.tif?&bands=1) are not part of the file name, but they are
+   * appended to the fingerprint as they change the data read. Returns an
+   * empty string if the file can not be found (a remote file, for
+   * instance): the data can not be identified then. */
+  static std::string ComputeFileFingerprint(const std::string& fileName);
+
+  /** Name of the sidecar file of an image: the image file name, without
+   * the options of an extended filename, followed by ".stats" */
+  static std::string GetSidecarFileName(const std::string& fileName);
+
+private:
+  std::string           m_Key;
+  std::string           m_Signature;
+  std::vector<TileType> m_Tiles;
+};
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,426 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingContingencyMatrixImageFilter_h
+#define otbStreamingContingencyMatrixImageFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "itkVariableSizeMatrix.h"
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace otb
+{
+
+/** \class ContingencyMatrixAccumulator
+ * \brief Counts the pairs of (reference, produced) labels
+ *
+ * Counts are stored in a dense matrix indexed by the order in which the
+ * labels are first seen, so that adding a pair does not need any
+ * allocation once the labels are known. The last row and column found are
+ * kept, as consecutive pixels usually have the same labels.
+ *
+ * GetReferenceLabels(), GetProducedLabels() and GetMatrix() give sorted
+ * labels, and the matching matrix (rows = reference labels, columns =
+ * produced labels).
+ *
+ * \ingroup OTBStatistics
+ */
+template <class TLabel>
+class ContingencyMatrixAccumulator
+{
+public:
+  typedef TLabel                             LabelType;
+  typedef uint64_t                           CountType;
+  typedef std::vector<LabelType>             LabelListType;
+  typedef itk::VariableSizeMatrix<CountType> MatrixType;
+
+  ContingencyMatrixAccumulator() : m_LastRow(0), m_LastColumn(0), m_NumberOfSamples(0)
+  {
+  }
+
+  /** Count a pair of labels */
+  void Add(LabelType reference, LabelType produced, CountType count = 1)
+  {
+    if (m_ReferenceLabels.empty() || m_ReferenceLabels[m_LastRow] != reference)
+    {
+      m_LastRow = FindOrInsert(reference, m_ReferenceLabels, m_ReferenceIndexes);
+      if (m_LastRow == m_Counts.size())
+      {
+        m_Counts.emplace_back();
+      }
+    }
+    if (m_ProducedLabels.empty() || m_ProducedLabels[m_LastColumn] != produced)
+    {
+      m_LastColumn = FindOrInsert(produced, m_ProducedLabels, m_ProducedIndexes);
+    }
+
+    // Rows are only extended when a new produced label is counted in it
+    std::vector<CountType>& row = m_Counts[m_LastRow];
+    if (row.size() <= m_LastColumn)
+    {
+      row.resize(m_ProducedLabels.size(), 0);
+    }
+    row[m_LastColumn] += count;
+    m_NumberOfSamples += count;
+  }
+
+  /** Add the counts of another accumulator */
+  void Update(const ContingencyMatrixAccumulator& other)
+  {
+    for (unsigned int i = 0; i < other.m_Counts.size(); ++i)
+    {
+      const std::vector<CountType>& row = other.m_Counts[i];
+      for (unsigned int j = 0; j < row.size(); ++j)
+      {
+        if (row[j] > 0)
+        {
+          this->Add(other.m_ReferenceLabels[i], other.m_ProducedLabels[j], row[j]);
+        }
+      }
+    }
+  }
+
+  /** Count of a pair of labels */
+  CountType GetCount(LabelType reference, LabelType produced) const
+  {
+    auto itRef  = m_ReferenceIndexes.find(reference);
+    auto itProd = m_ProducedIndexes.find(produced);
+    if (itRef == m_ReferenceIndexes.end() || itProd == m_ProducedIndexes.end())
+    {
+      return 0;
+    }
+    const std::vector<CountType>& row = m_Counts[itRef->second];
+    return itProd->second < row.size() ? row[itProd->second] : 0;
+  }
+
+  CountType GetNumberOfSamples() const
+  {
+    return m_NumberOfSamples;
+  }
+
+  /** Reference labels, sorted */
+  LabelListType GetReferenceLabels() const
+  {
+    LabelListType labels(m_ReferenceLabels);
+    std::sort(labels.begin(), labels.end());
+    return labels;
+  }
+
+  /** Produced labels, sorted */
+  LabelListType GetProducedLabels() const
+  {
+    LabelListType labels(m_ProducedLabels);
+    std::sort(labels.begin(), labels.end());
+    return labels;
+  }
+
+  /** Counts of sorted reference labels (rows) vs. sorted produced labels
+   * (columns) */
+  MatrixType GetMatrix() const
+  {
+    const LabelListType referenceLabels = this->GetReferenceLabels();
+    const LabelListType producedLabels  = this->GetProducedLabels();
+
+    MatrixType matrix(static_cast<unsigned int>(referenceLabels.size()), static_cast<unsigned int>(producedLabels.size()));
+    for (unsigned int i = 0; i < referenceLabels.size(); ++i)
+    {
+      for (unsigned int j = 0; j < producedLabels.size(); ++j)
+      {
+        matrix(i, j) = this->GetCount(referenceLabels[i], producedLabels[j]);
+      }
+    }
+    return matrix;
+  }
+
+private:
+  typedef std::unordered_map<LabelType, unsigned int> IndexMapType;
+
+  static unsigned int FindOrInsert(LabelType label, LabelListType& labels, IndexMapType& indexes)
+  {
+    auto inserted = indexes.emplace(label, static_cast<unsigned int>(labels.size()));
+    if (inserted.second)
+    {
+      labels.push_back(label);
+    }
+    return inserted.first->second;
+  }
+
+  LabelListType                       m_ReferenceLabels;
+  LabelListType                       m_ProducedLabels;
+  IndexMapType                        m_ReferenceIndexes;
+  IndexMapType                        m_ProducedIndexes;
+  std::vector<std::vector<CountType>> m_Counts;
+  unsigned int                        m_LastRow;
+  unsigned int                        m_LastColumn;
+  CountType                           m_NumberOfSamples;
+};
+
+/** \class PersistentContingencyMatrixImageFilter
+ * \brief Counts the pairs of reference and produced labels of two label images
+ *
+ * The produced labels are the input of the filter, the reference labels
+ * are set with SetReferenceImage(). Pixels with a no-data label in either
+ * image are skipped.
+ *
+ * Each thread counts its pixels in its own ContingencyMatrixAccumulator,
+ * and Synthetize() merges them. The memory used only depends on the number
+ * of labels, not on the number of pixels.
+ *
+ * When a zone image is set (SetZoneImage()), the pairs are also counted
+ * separately for each zone label, in the same pass.
+ *
+ * This filter persists its temporary data. It means that if you Update it n times on n different
+ * requested regions, the output matrices will be the matrices of the whole set of n regions.
+ *
+ * To reset the temporary data, one should call the Reset() function.
+ *
+ * To get the matrices once the regions have been processed via the pipeline, use the Synthetize() method.
+ *
+ * \sa StreamingContingencyMatrixImageFilter
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBStatistics
+ */
+template <class TLabelImage>
+class ITK_EXPORT PersistentContingencyMatrixImageFilter : public PersistentImageFilter<TLabelImage, TLabelImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentContingencyMatrixImageFilter          Self;
+  typedef PersistentImageFilter<TLabelImage, TLabelImage> Superclass;
+  typedef itk::SmartPointer<Self>                         Pointer;
+  typedef itk::SmartPointer<const Self>                   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentContingencyMatrixImageFilter, PersistentImageFilter);
+
+  /** Image related typedefs. */
+  typedef TLabelImage                          LabelImageType;
+  typedef typename LabelImageType::RegionType  RegionType;
+  typedef typename LabelImageType::PixelType   LabelType;
+
+  typedef ContingencyMatrixAccumulator<LabelType>                  AccumulatorType;
+  typedef std::unordered_map<LabelType, AccumulatorType>           ThreadAccumulatorMapType;
+  typedef std::map<LabelType, AccumulatorType>                     ZoneAccumulatorMapType;
+
+  /** Set/Get the image of reference labels */
+  void SetReferenceImage(const LabelImageType* image);
+  const LabelImageType* GetReferenceImage();
+
+  /** Set/Get the optional image of zone labels */
+  void SetZoneImage(const LabelImageType* image);
+  const LabelImageType* GetZoneImage();
+
+  itkSetMacro(ReferenceNoData, LabelType);
+  itkGetMacro(ReferenceNoData, LabelType);
+  itkSetMacro(UseReferenceNoData, bool);
+  itkGetMacro(UseReferenceNoData, bool);
+
+  itkSetMacro(ProducedNoData, LabelType);
+  itkGetMacro(ProducedNoData, LabelType);
+  itkSetMacro(UseProducedNoData, bool);
+  itkGetMacro(UseProducedNoData, bool);
+
+  /** Counts of the whole image */
+  const AccumulatorType& GetContingencyMatrix() const
+  {
+    return m_ContingencyMatrix;
+  }
+
+  /** Counts of each zone, empty if there is no zone image */
+  const ZoneAccumulatorMapType& GetZoneContingencyMatrices() const
+  {
+    return m_ZoneContingencyMatrices;
+  }
+
+  /** The output image is not used, nothing is allocated */
+  void AllocateOutputs() override;
+
+  void GenerateOutputInformation() override;
+
+  void Synthetize(void) override;
+
+  void Reset(void) override;
+
+protected:
+  PersistentContingencyMatrixImageFilter();
+  ~PersistentContingencyMatrixImageFilter() override
+  {
+  }
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  /** Only check that the inputs have the same size: the reference may be
+   * rasterized on the grid of the produced labels */
+  void VerifyInputInformation() override;
+
+  void ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
+
+private:
+  PersistentContingencyMatrixImageFilter(const Self&) = delete;
+  void operator=(const Self&) = delete;
+
+  LabelType m_ReferenceNoData;
+  bool      m_UseReferenceNoData;
+  LabelType m_ProducedNoData;
+  bool      m_UseProducedNoData;
+
+  /** Counts of each thread, per zone (a single zone without zone image) */
+  std::vector<ThreadAccumulatorMapType> m_ThreadAccumulators;
+
+  AccumulatorType        m_ContingencyMatrix;
+  ZoneAccumulatorMapType m_ZoneContingencyMatrices;
+
+}; // end of class PersistentContingencyMatrixImageFilter
+
+/*===========================================================================*/
+
+/** \class StreamingContingencyMatrixImageFilter
+ * \brief Counts the pairs of reference and produced labels of two label images
+ *
+ * This class streams the whole input images through the
+ * PersistentContingencyMatrixImageFilter.
+ *
+ * This filter can be used as:
+ * \code
+ * typedef otb::StreamingContingencyMatrixImageFilter<LabelImageType> ContingencyType;
+ * ContingencyType::Pointer contingency = ContingencyType::New();
+ * contingency->SetInput(classification);
+ * contingency->SetReferenceImage(groundTruth);
+ * contingency->Update();
+ * ContingencyType::AccumulatorType::MatrixType matrix = contingency->GetContingencyMatrix().GetMatrix();
+ * \endcode
+ *
+ * \sa PersistentContingencyMatrixImageFilter
+ * \sa PersistentImageFilter
+ * \sa PersistentFilterStreamingDecorator
+ * \sa StreamingImageVirtualWriter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBStatistics
+ */
+template <class TLabelImage>
+class ITK_EXPORT StreamingContingencyMatrixImageFilter : public PersistentFilterStreamingDecorator<PersistentContingencyMatrixImageFilter<TLabelImage>>
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingContingencyMatrixImageFilter                                                  Self;
+  typedef PersistentFilterStreamingDecorator<PersistentContingencyMatrixImageFilter<TLabelImage>> Superclass;
+  typedef itk::SmartPointer<Self>                                                                Pointer;
+  typedef itk::SmartPointer<const Self>                                                          ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(StreamingContingencyMatrixImageFilter, PersistentFilterStreamingDecorator);
+
+  typedef TLabelImage                                           LabelImageType;
+  typedef typename Superclass::FilterType::LabelType            LabelType;
+  typedef typename Superclass::FilterType::AccumulatorType      AccumulatorType;
+  typedef typename Superclass::FilterType::ZoneAccumulatorMapType ZoneAccumulatorMapType;
+
+  /** Set the image of produced labels */
+  using Superclass::SetInput;
+  void SetInput(const LabelImageType* input)
+  {
+    this->GetFilter()->SetInput(input);
+  }
+
+  const LabelImageType* GetInput()
+  {
+    return this->GetFilter()->GetInput();
+  }
+
+  void SetReferenceImage(const LabelImageType* input)
+  {
+    this->GetFilter()->SetReferenceImage(input);
+  }
+
+  const LabelImageType* GetReferenceImage()
+  {
+    return this->GetFilter()->GetReferenceImage();
+  }
+
+  void SetZoneImage(const LabelImageType* input)
+  {
+    this->GetFilter()->SetZoneImage(input);
+  }
+
+  const LabelImageType* GetZoneImage()
+  {
+    return this->GetFilter()->GetZoneImage();
+  }
+
+  void SetReferenceNoData(LabelType value)
+  {
+    this->GetFilter()->SetReferenceNoData(value);
+    this->GetFilter()->SetUseReferenceNoData(true);
+  }
+
+  void SetProducedNoData(LabelType value)
+  {
+    this->GetFilter()->SetProducedNoData(value);
+    this->GetFilter()->SetUseProducedNoData(true);
+  }
+
+  /** Counts of the whole image */
+  const AccumulatorType& GetContingencyMatrix() const
+  {
+    return this->GetFilter()->GetContingencyMatrix();
+  }
+
+  /** Counts of each zone, empty if there is no zone image */
+  const ZoneAccumulatorMapType& GetZoneContingencyMatrices() const
+  {
+    return this->GetFilter()->GetZoneContingencyMatrices();
+  }
+
+protected:
+  /** Constructor */
+  StreamingContingencyMatrixImageFilter()
+  {
+  }
+  /** Destructor */
+  ~StreamingContingencyMatrixImageFilter() override
+  {
+  }
+
+private:
+  StreamingContingencyMatrixImageFilter(const Self&) = delete;
+  void operator=(const Self&) = delete;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingContingencyMatrixImageFilter.hxx"
+#endif
+
+#endif
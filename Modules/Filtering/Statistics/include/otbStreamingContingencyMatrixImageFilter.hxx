@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingContingencyMatrixImageFilter_hxx
+#define otbStreamingContingencyMatrixImageFilter_hxx
+#include "otbStreamingContingencyMatrixImageFilter.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkProgressReporter.h"
+
+namespace otb
+{
+
+template <class TLabelImage>
+PersistentContingencyMatrixImageFilter<TLabelImage>::PersistentContingencyMatrixImageFilter()
+  : m_ReferenceNoData(), m_UseReferenceNoData(false), m_ProducedNoData(), m_UseProducedNoData(false)
+{
+  this->SetNumberOfRequiredInputs(2);
+  this->Reset();
+}
+
+template <class TLabelImage>
+void PersistentContingencyMatrixImageFilter<TLabelImage>::SetReferenceImage(const LabelImageType* image)
+{
+  // Process object is not const-correct so the const_cast is required here
+  this->itk::ProcessObject::SetNthInput(1, const_cast<LabelImageType*>(image));
+}
+
+template <class TLabelImage>
+const typename PersistentContingencyMatrixImageFilter<TLabelImage>::LabelImageType* PersistentContingencyMatrixImageFilter<TLabelImage>::GetReferenceImage()
+{
+  return static_cast<const LabelImageType*>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TLabelImage>
+void PersistentContingencyMatrixImageFilter<TLabelImage>::SetZoneImage(const LabelImageType* image)
+{
+  this->itk::ProcessObject::SetNthInput(2, const_cast<LabelImageType*>(image));
+}
+
+template <class TLabelImage>
+const typename PersistentContingencyMatrixImageFilter<TLabelImage>::LabelImageType* PersistentContingencyMatrixImageFilter<TLabelImage>::GetZoneImage()
+{
+  if (this->GetNumberOfInputs() < 3)
+  {
+    return nullptr;
+  }
+  return static_cast<const LabelImageType*>(this->itk::ProcessObject::GetInput(2));
+}
+
+template <class TLabelImage>
+void PersistentContingencyMatrixImageFilter<TLabelImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  if (this->GetInput())
+  {
+    this->GetOutput()->CopyInformation(this->GetInput());
+    this->GetOutput()->SetLargestPossibleRegion(this->GetInput()->GetLargestPossibleRegion());
+
+    if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+    {
+      this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+    }
+  }
+}
+
+template <class TLabelImage>
+void PersistentContingencyMatrixImageFilter<TLabelImage>::AllocateOutputs()
+{
+  // Nothing that needs to be allocated for the outputs : the output is not
+  // meant to be used
+}
+
+template <class TLabelImage>
+void PersistentContingencyMatrixImageFilter<TLabelImage>::VerifyInputInformation()
+{
+  const RegionType& region = this->GetInput()->GetLargestPossibleRegion();
+  for (unsigned int i = 1; i < this->GetNumberOfInputs(); ++i)
+  {
+    const LabelImageType* input = static_cast<const LabelImageType*>(this->itk::ProcessObject::GetInput(i));
+    if (input && input->GetLargestPossibleRegion() != region)
+    {
+      itkExceptionMacro(<< "Input " << i << " has a largest possible region " << input->GetLargestPossibleRegion()
+                        << " different from the produced labels image one " << region);
+    }
+  }
+}
+
+template <class TLabelImage>
+void PersistentContingencyMatrixImageFilter<TLabelImage>::Reset()
+{
+  m_ThreadAccumulators.clear();
+  m_ThreadAccumulators.resize(this->GetNumberOfThreads());
+
+  m_ContingencyMatrix = AccumulatorType();
+  m_ZoneContingencyMatrices.clear();
+}
+
+template <class TLabelImage>
+void PersistentContingencyMatrixImageFilter<TLabelImage>::Synthetize()
+{
+  const bool hasZones = this->GetZoneImage() != nullptr;
+
+  for (auto const& threadAccMap : m_ThreadAccumulators)
+  {
+    for (auto const& it : threadAccMap)
+    {
+      // Zones with no valid pixel are not reported
+      if (it.second.GetNumberOfSamples() == 0)
+      {
+        continue;
+      }
+      m_ContingencyMatrix.Update(it.second);
+      if (hasZones)
+      {
+        m_ZoneContingencyMatrices[it.first].Update(it.second);
+      }
+    }
+  }
+}
+
+template <class TLabelImage>
+void PersistentContingencyMatrixImageFilter<TLabelImage>::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  typedef itk::ImageRegionConstIterator<LabelImageType> IteratorType;
+
+  const LabelImageType* zoneImage = this->GetZoneImage();
+
+  IteratorType          prodIt(this->GetInput(), outputRegionForThread);
+  IteratorType          refIt(this->GetReferenceImage(), outputRegionForThread);
+  IteratorType          zoneIt;
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  if (zoneImage)
+  {
+    zoneIt = IteratorType(zoneImage, outputRegionForThread);
+    zoneIt.GoToBegin();
+  }
+
+  // Without zone image, all the pixels are counted in the zone of the
+  // default label
+  ThreadAccumulatorMapType& accumulators = m_ThreadAccumulators[threadId];
+  LabelType                 zone         = LabelType();
+  AccumulatorType*          acc          = &accumulators[zone];
+
+  for (prodIt.GoToBegin(), refIt.GoToBegin(); !prodIt.IsAtEnd(); ++prodIt, ++refIt)
+  {
+    if (zoneImage)
+    {
+      // Elements of an unordered_map are not moved by insertions
+      if (zoneIt.Get() != zone)
+      {
+        zone = zoneIt.Get();
+        acc  = &accumulators[zone];
+      }
+      ++zoneIt;
+    }
+
+    const LabelType reference = refIt.Get();
+    const LabelType produced  = prodIt.Get();
+    if ((!m_UseReferenceNoData || reference != m_ReferenceNoData) && (!m_UseProducedNoData || produced != m_ProducedNoData))
+    {
+      acc->Add(reference, produced);
+    }
+
+    progress.CompletedPixel();
+  }
+}
+
+template <class TLabelImage>
+void PersistentContingencyMatrixImageFilter<TLabelImage>::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of samples: " << m_ContingencyMatrix.GetNumberOfSamples() << std::endl;
+  os << indent << "Number of zones: " << m_ZoneContingencyMatrices.size() << std::endl;
+}
+
+} // end namespace otb
+#endif
@@ -24,6 +24,7 @@
 
 #include "otbPersistentImageFilter.h"
 #include "otbPersistentFilterStreamingDecorator.h"
+#include "otbPerThreadAccumulator.h"
 
 #include "otbObjectList.h"
 #include "itkStatisticsAlgorithm.h"
@@ -101,7 +102,7 @@ public:
   typedef PixelType                                      MeasurementVectorType;
   typedef ObjectList<HistogramType>                      HistogramListType;
   typedef typename HistogramListType::Pointer            HistogramListPointerType;
-  typedef typename std::vector<HistogramListPointerType> ArrayHistogramListType;
+  typedef PerThreadAccumulator<HistogramListPointerType> ArrayHistogramListType;
 
 
   /** Set the no data value. These value are ignored in histogram
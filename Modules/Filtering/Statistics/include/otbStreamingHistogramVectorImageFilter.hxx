@@ -155,7 +155,7 @@ void PersistentHistogramVectorImageFilter<TInputImage>::Reset()
 
 
   // Setup HistogramLists for each thread
-  m_ThreadHistogramList.clear();
+  m_ThreadHistogramList.Reset(numberOfThreads, HistogramListPointerType());
   for (unsigned int i = 0; i < numberOfThreads; ++i)
   {
     HistogramListPointerType histoList = HistogramListType::New();
@@ -179,7 +179,7 @@ void PersistentHistogramVectorImageFilter<TInputImage>::Reset()
 
       histoList->PushBack(histogram);
     }
-    m_ThreadHistogramList.push_back(histoList);
+    m_ThreadHistogramList[i] = histoList;
   }
 }
 
@@ -188,11 +188,11 @@ void PersistentHistogramVectorImageFilter<TInputImage>::Synthetize()
 {
   HistogramListType* outputHisto = this->GetHistogramListOutput();
 
-  int          numberOfThreads   = this->GetNumberOfThreads();
-  unsigned int numberOfComponent = this->GetInput()->GetNumberOfComponentsPerPixel();
+  const itk::ThreadIdType numberOfThreads   = m_ThreadHistogramList.Size();
+  unsigned int            numberOfComponent = this->GetInput()->GetNumberOfComponentsPerPixel();
 
   // copy histograms to output
-  for (int i = 0; i < numberOfThreads; ++i)
+  for (itk::ThreadIdType i = 0; i < numberOfThreads; ++i)
   {
     for (unsigned int j = 0; j < numberOfComponent; ++j)
     {
@@ -225,6 +225,12 @@ void PersistentHistogramVectorImageFilter<TInputImage>::ThreadedGenerateData(con
 
   typename HistogramType::IndexType index;
 
+  // Allocated once: a per pixel allocation serializes the threads in the allocator
+  typename HistogramType::MeasurementVectorType value;
+  value.SetSize(1);
+
+  HistogramListType* threadHistograms = m_ThreadHistogramList[threadId];
+
   itk::ImageRegionConstIteratorWithIndex<TInputImage> it(inputPtr, outputRegionForThread);
   it.GoToBegin();
 
@@ -277,12 +283,11 @@ void PersistentHistogramVectorImageFilter<TInputImage>::ThreadedGenerateData(con
     {
       for (unsigned int j = 0; j < vectorValue.GetSize(); ++j)
       {
-        typename HistogramType::MeasurementVectorType value;
-        value.SetSize(1);
+        HistogramType* histogram = threadHistograms->GetNthElement(j);
         value.Fill(vectorValue[j]);
 
-        m_ThreadHistogramList[threadId]->GetNthElement(j)->GetIndex(value, index);
-        if (!m_ThreadHistogramList[threadId]->GetNthElement(j)->IsIndexOutOfBounds(index))
+        histogram->GetIndex(value, index);
+        if (!histogram->IsIndexOutOfBounds(index))
         {
           // if the measurement vector is out of bound then
           // the GetIndex method has returned an index set to the max size of
@@ -290,7 +295,7 @@ void PersistentHistogramVectorImageFilter<TInputImage>::ThreadedGenerateData(con
           // bin value.
           // If the index isn't valid, we don't increase the frequency.
           // See the comments in Histogram->GetIndex() for more info.
-          m_ThreadHistogramList[threadId]->GetNthElement(j)->IncreaseFrequencyOfIndex(index, 1);
+          histogram->IncreaseFrequencyOfIndex(index, 1);
         }
       }
     }
@@ -27,6 +27,7 @@
 #include "itkNumericTraits.h"
 #include "itkSimpleDataObjectDecorator.h"
 #include "otbPersistentFilterStreamingDecorator.h"
+#include "otbPerThreadAccumulator.h"
 
 namespace otb
 {
@@ -146,10 +147,38 @@ private:
   PersistentMinMaxImageFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
 
-  std::vector<PixelType> m_ThreadMin;
-  std::vector<PixelType> m_ThreadMax;
-  std::vector<IndexType> m_ThreadMinIndex;
-  std::vector<IndexType> m_ThreadMaxIndex;
+  /** Min and max found by a thread, with their index */
+  struct ThreadMinMax
+  {
+    ThreadMinMax() : minimum(itk::NumericTraits<PixelType>::max()), maximum(itk::NumericTraits<PixelType>::NonpositiveMin())
+    {
+      minimumIndex.Fill(0);
+      maximumIndex.Fill(0);
+    }
+
+    /** Keep the extrema of this thread on ties, so that the index found
+     * does not depend on the reduction order */
+    void Merge(const ThreadMinMax& other)
+    {
+      if (other.minimum < minimum)
+      {
+        minimum      = other.minimum;
+        minimumIndex = other.minimumIndex;
+      }
+      if (other.maximum > maximum)
+      {
+        maximum      = other.maximum;
+        maximumIndex = other.maximumIndex;
+      }
+    }
+
+    PixelType minimum;
+    PixelType maximum;
+    IndexType minimumIndex;
+    IndexType maximumIndex;
+  };
+
+  PerThreadAccumulator<ThreadMinMax> m_ThreadMinMax;
 }; // end of class PersistentMinMaxImageFilter
 
 
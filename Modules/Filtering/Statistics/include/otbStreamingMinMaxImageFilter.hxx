@@ -150,51 +150,20 @@ void PersistentMinMaxImageFilter<TInputImage>::AllocateOutputs()
 template <class TInputImage>
 void PersistentMinMaxImageFilter<TInputImage>::Synthetize()
 {
-  int i;
-  int numberOfThreads = this->GetNumberOfThreads();
-
-  PixelType minimum = itk::NumericTraits<PixelType>::max();
-  PixelType maximum = itk::NumericTraits<PixelType>::NonpositiveMin();
-  IndexType minimumIdx;
-  IndexType maximumIdx;
-
-  for (i = 0; i < numberOfThreads; ++i)
-  {
-    if (m_ThreadMin[i] < minimum)
-    {
-      minimum    = m_ThreadMin[i];
-      minimumIdx = m_ThreadMinIndex[i];
-    }
-    if (m_ThreadMax[i] > maximum)
-    {
-      maximum    = m_ThreadMax[i];
-      maximumIdx = m_ThreadMaxIndex[i];
-    }
-  }
+  // Threads are merged pairwise, the lowest thread winning ties
+  const ThreadMinMax total = m_ThreadMinMax.Reduce([](ThreadMinMax& a, const ThreadMinMax& b) { a.Merge(b); });
 
   // Set the outputs
-  this->GetMinimumOutput()->Set(minimum);
-  this->GetMaximumOutput()->Set(maximum);
-  this->GetMinimumIndexOutput()->Set(minimumIdx);
-  this->GetMaximumIndexOutput()->Set(maximumIdx);
+  this->GetMinimumOutput()->Set(total.minimum);
+  this->GetMaximumOutput()->Set(total.maximum);
+  this->GetMinimumIndexOutput()->Set(total.minimumIndex);
+  this->GetMaximumIndexOutput()->Set(total.maximumIndex);
 }
 
 template <class TInputImage>
 void PersistentMinMaxImageFilter<TInputImage>::Reset()
 {
-  int numberOfThreads = this->GetNumberOfThreads();
-
-  m_ThreadMin.resize(numberOfThreads);
-  m_ThreadMax.resize(numberOfThreads);
-  std::fill(m_ThreadMin.begin(), m_ThreadMin.end(), itk::NumericTraits<PixelType>::max());
-  std::fill(m_ThreadMax.begin(), m_ThreadMax.end(), itk::NumericTraits<PixelType>::NonpositiveMin());
-
-  IndexType zeroIdx;
-  zeroIdx.Fill(0);
-  m_ThreadMinIndex.resize(numberOfThreads);
-  m_ThreadMaxIndex.resize(numberOfThreads);
-  std::fill(m_ThreadMinIndex.begin(), m_ThreadMinIndex.end(), zeroIdx);
-  std::fill(m_ThreadMaxIndex.begin(), m_ThreadMaxIndex.end(), zeroIdx);
+  m_ThreadMinMax.Reset(this->GetNumberOfThreads(), ThreadMinMax());
 }
 
 template <class TInputImage>
@@ -203,6 +172,8 @@ void PersistentMinMaxImageFilter<TInputImage>::ThreadedGenerateData(const Region
   // support progress methods/callbacks
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
+  ThreadMinMax& minMax = m_ThreadMinMax[threadId];
+
   InputImagePointer                          inputPtr = const_cast<TInputImage*>(this->GetInput(0));
   itk::ImageRegionConstIterator<TInputImage> it(inputPtr, outputRegionForThread);
   it.GoToBegin();
@@ -210,15 +181,15 @@ void PersistentMinMaxImageFilter<TInputImage>::ThreadedGenerateData(const Region
   while (!it.IsAtEnd())
   {
     PixelType value = it.Get();
-    if (value < m_ThreadMin[threadId])
+    if (value < minMax.minimum)
     {
-      m_ThreadMin[threadId]      = value;
-      m_ThreadMinIndex[threadId] = it.GetIndex();
+      minMax.minimum      = value;
+      minMax.minimumIndex = it.GetIndex();
     }
-    if (value > m_ThreadMax[threadId])
+    if (value > minMax.maximum)
     {
-      m_ThreadMax[threadId]      = value;
-      m_ThreadMaxIndex[threadId] = it.GetIndex();
+      minMax.maximum      = value;
+      minMax.maximumIndex = it.GetIndex();
     }
     ++it;
     progress.CompletedPixel();
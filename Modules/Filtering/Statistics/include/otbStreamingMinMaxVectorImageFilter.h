@@ -28,6 +28,7 @@
 #include "itkImageRegionSplitter.h"
 #include "itkVariableSizeMatrix.h"
 #include "itkVariableLengthVector.h"
+#include "otbStatisticsSidecarFile.h"
 
 namespace otb
 {
@@ -42,6 +43,10 @@ namespace otb
  *
  * To get the statistics once the regions have been processed via the pipeline, use the Synthetize() method.
  *
+ * If a statistics file name is set, the min and max of each processed region
+ * are saved in this sidecar file (see otb::StatisticsSidecarFile), and
+ * ReadStatisticsFile() can restore them without processing the image again.
+ *
  * \sa PersistentImageFilter
  * \ingroup Streamed
  * \ingroup Multithreaded
@@ -123,6 +128,21 @@ public:
    */
   itkBooleanMacro(NoDataFlag);
 
+  /** Sidecar file storing the min and max of each region (empty to disable) */
+  itkSetMacro(StatisticsFileName, std::string);
+  itkGetConstReferenceMacro(StatisticsFileName, std::string);
+
+  /** Key identifying the input data in the sidecar file */
+  itkSetMacro(StatisticsFileKey, std::string);
+  itkGetConstReferenceMacro(StatisticsFileKey, std::string);
+
+  /** Restore the min and max of the input largest possible region from
+   * the sidecar file. To be called after Reset(). Returns false if the
+   * file can not provide them: the input must then be processed. */
+  bool ReadStatisticsFile();
+
+  /** true if the last min and max were restored from the sidecar file */
+  itkGetConstMacro(StatisticsReadFromFile, bool);
 
   /** Return the computed Minimum. */
   PixelType GetMinimum() const
@@ -163,15 +183,32 @@ protected:
   /** Multi-thread version GenerateData. */
   void ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
 
+  /** Store the min and max of the processed region, if a statistics file is used */
+  void AfterThreadedGenerateData() override;
+
 private:
   PersistentMinMaxVectorImageFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
 
+  typedef StatisticsSidecarFile::TileType TileStatisticsType;
+
+  /** Set the per thread min and max to their initial values */
+  void ResetThreadAccumulators(unsigned int numberOfComponent);
+
+  /** Describe the settings the min and max depend on */
+  std::string GetStatisticsSignature() const;
+
   ArrayPixelType    m_ThreadMin;
   ArrayPixelType    m_ThreadMax;
   bool              m_NoDataFlag;
   InternalPixelType m_NoDataValue;
 
+  /* Min and max of each region, when a statistics file is used */
+  std::string                     m_StatisticsFileName;
+  std::string                     m_StatisticsFileKey;
+  std::vector<TileStatisticsType> m_TileStatistics;
+  bool                            m_StatisticsReadFromFile;
+
 }; // end of class PersistentStatisticsVectorImageFilter
 
 /**===========================================================================*/
@@ -185,6 +222,9 @@ private:
  * to compute the statistics. The accessor on the results are wrapping the accessors of the
  * internal PersistentMinMaxImageFilter.
  *
+ * When a statistics file name is set, the min and max are restored from this
+ * sidecar file if it holds them, and the image is not streamed at all.
+ *
  * \sa PersistentStatisticsVectorImageFilter
  * \sa PersistentImageFilter
  * \sa PersistentFilterStreamingDecorator
@@ -266,6 +306,14 @@ public:
     return this->GetFilter()->GetMaximumOutput();
   }
 
+  otbSetObjectMemberMacro(Filter, StatisticsFileName, std::string);
+  otbGetObjectMemberMacro(Filter, StatisticsFileName, std::string);
+
+  otbSetObjectMemberMacro(Filter, StatisticsFileKey, std::string);
+  otbGetObjectMemberMacro(Filter, StatisticsFileKey, std::string);
+
+  otbGetObjectMemberMacro(Filter, StatisticsReadFromFile, bool);
+
 protected:
   /** Constructor */
   StreamingMinMaxVectorImageFilter(){};
@@ -274,6 +322,20 @@ protected:
   {
   }
 
+  /** Skip the streaming when the statistics file holds the min and max */
+  void GenerateData(void) override
+  {
+    this->GetFilter()->Reset();
+
+    if (!this->GetFilter()->ReadStatisticsFile())
+    {
+      this->GetStreamer()->SetInput(this->GetFilter()->GetOutput());
+      this->GetStreamer()->Update();
+    }
+
+    this->GetFilter()->Synthetize();
+  }
+
 private:
   StreamingMinMaxVectorImageFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
@@ -29,12 +29,16 @@
 #include "itkProgressReporter.h"
 #include "otbMacro.h"
 
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
 namespace otb
 {
 
 template <class TInputImage>
 PersistentMinMaxVectorImageFilter<TInputImage>::PersistentMinMaxVectorImageFilter()
-  : m_NoDataFlag(false), m_NoDataValue(itk::NumericTraits<InternalPixelType>::Zero)
+  : m_NoDataFlag(false), m_NoDataValue(itk::NumericTraits<InternalPixelType>::Zero), m_StatisticsReadFromFile(false)
 {
   // first output is a copy of the image, DataObject created by
   // superclass
@@ -122,7 +126,6 @@ void PersistentMinMaxVectorImageFilter<TInputImage>::Reset()
   TInputImage* inputPtr = const_cast<TInputImage*>(this->GetInput());
   inputPtr->UpdateOutputInformation();
 
-  unsigned int numberOfThreads   = this->GetNumberOfThreads();
   unsigned int numberOfComponent = inputPtr->GetNumberOfComponentsPerPixel();
 
   // Variable Initialization
@@ -134,6 +137,17 @@ void PersistentMinMaxVectorImageFilter<TInputImage>::Reset()
   tempPixel.Fill(itk::NumericTraits<InternalPixelType>::max());
   this->GetMinimumOutput()->Set(tempPixel);
 
+  this->ResetThreadAccumulators(numberOfComponent);
+
+  m_TileStatistics.clear();
+  m_StatisticsReadFromFile = false;
+}
+
+template <class TInputImage>
+void PersistentMinMaxVectorImageFilter<TInputImage>::ResetThreadAccumulators(unsigned int numberOfComponent)
+{
+  unsigned int numberOfThreads = this->GetNumberOfThreads();
+
   PixelType tempTemporiesPixel;
   tempTemporiesPixel.SetSize(numberOfComponent);
   tempTemporiesPixel.Fill(itk::NumericTraits<InternalPixelType>::max());
@@ -143,6 +157,117 @@ void PersistentMinMaxVectorImageFilter<TInputImage>::Reset()
   m_ThreadMax = ArrayPixelType(numberOfThreads, tempTemporiesPixel);
 }
 
+template <class TInputImage>
+std::string PersistentMinMaxVectorImageFilter<TInputImage>::GetStatisticsSignature() const
+{
+  std::ostringstream oss;
+  oss.precision(std::numeric_limits<double>::max_digits10);
+  oss << "StreamingMinMaxVectorImageFilter"
+      << " dimension " << ImageDimension << " components " << this->GetInput()->GetNumberOfComponentsPerPixel() << " pixel "
+      << sizeof(InternalPixelType) << (std::numeric_limits<InternalPixelType>::is_integer ? "i" : "f") << " nodata " << m_NoDataFlag;
+  if (m_NoDataFlag)
+  {
+    oss << " " << static_cast<double>(m_NoDataValue);
+  }
+  return oss.str();
+}
+
+template <class TInputImage>
+bool PersistentMinMaxVectorImageFilter<TInputImage>::ReadStatisticsFile()
+{
+  m_TileStatistics.clear();
+  m_StatisticsReadFromFile = false;
+
+  if (m_StatisticsFileName.empty())
+  {
+    return false;
+  }
+
+  TInputImage* inputPtr = const_cast<TInputImage*>(this->GetInput());
+  inputPtr->UpdateOutputInformation();
+
+  StatisticsSidecarFile sidecar;
+  sidecar.SetKey(m_StatisticsFileKey);
+  sidecar.SetSignature(this->GetStatisticsSignature());
+  if (!sidecar.Load(m_StatisticsFileName))
+  {
+    return false;
+  }
+
+  const RegionType&          region = inputPtr->GetLargestPossibleRegion();
+  std::vector<long>          regionIndex(ImageDimension);
+  std::vector<unsigned long> regionSize(ImageDimension);
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    regionIndex[d] = region.GetIndex()[d];
+    regionSize[d]  = region.GetSize()[d];
+  }
+
+  std::vector<TileStatisticsType> tiles;
+  if (!sidecar.FindPartition(regionIndex, regionSize, tiles))
+  {
+    return false;
+  }
+
+  const unsigned int nbValues = 2 * inputPtr->GetNumberOfComponentsPerPixel();
+  for (const auto& tile : tiles)
+  {
+    if (tile.values.size() != nbValues)
+    {
+      return false;
+    }
+  }
+
+  otbMsgDevMacro(<< "Min and max of " << tiles.size() << " regions read from " << m_StatisticsFileName);
+  m_TileStatistics.swap(tiles);
+  m_StatisticsReadFromFile = true;
+  return true;
+}
+
+template <class TInputImage>
+void PersistentMinMaxVectorImageFilter<TInputImage>::AfterThreadedGenerateData()
+{
+  if (m_StatisticsFileName.empty())
+  {
+    return;
+  }
+
+  // Reduce the thread min and max to the ones of the processed region, and
+  // restart from empty accumulators for the next one
+  const unsigned int numberOfComponent = this->GetInput()->GetNumberOfComponentsPerPixel();
+  const unsigned int numberOfThreads   = this->GetNumberOfThreads();
+  const RegionType&  region            = this->GetOutput()->GetRequestedRegion();
+
+  TileStatisticsType tile;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    tile.index.push_back(region.GetIndex()[d]);
+    tile.size.push_back(region.GetSize()[d]);
+  }
+
+  PixelType minimum = m_ThreadMin[0];
+  PixelType maximum = m_ThreadMax[0];
+  for (unsigned int threadId = 1; threadId < numberOfThreads; ++threadId)
+  {
+    for (unsigned int j = 0; j < numberOfComponent; ++j)
+    {
+      minimum[j] = std::min(minimum[j], m_ThreadMin[threadId][j]);
+      maximum[j] = std::max(maximum[j], m_ThreadMax[threadId][j]);
+    }
+  }
+  for (unsigned int j = 0; j < numberOfComponent; ++j)
+  {
+    tile.values.push_back(static_cast<double>(minimum[j]));
+  }
+  for (unsigned int j = 0; j < numberOfComponent; ++j)
+  {
+    tile.values.push_back(static_cast<double>(maximum[j]));
+  }
+
+  m_TileStatistics.push_back(tile);
+  this->ResetThreadAccumulators(numberOfComponent);
+}
+
 template <class TInputImage>
 void PersistentMinMaxVectorImageFilter<TInputImage>::Synthetize()
 {
@@ -159,6 +284,21 @@ void PersistentMinMaxVectorImageFilter<TInputImage>::Synthetize()
   maximumVector.SetSize(numberOfComponent);
   maximumVector.Fill(itk::NumericTraits<InternalPixelType>::NonpositiveMin());
 
+  // With a statistics file, the min and max are the ones of the regions,
+  // whether they were computed or read
+  if (!m_StatisticsFileName.empty())
+  {
+    this->ResetThreadAccumulators(numberOfComponent);
+    for (const auto& tile : m_TileStatistics)
+    {
+      for (unsigned int j = 0; j < numberOfComponent; ++j)
+      {
+        m_ThreadMin[0][j] = std::min(m_ThreadMin[0][j], static_cast<InternalPixelType>(tile.values[j]));
+        m_ThreadMax[0][j] = std::max(m_ThreadMax[0][j], static_cast<InternalPixelType>(tile.values[numberOfComponent + j]));
+      }
+    }
+  }
+
   // Find the min/max over all threads and accumulate count, sum and
   // sum of squares
   for (i = 0; i < numberOfThreads; ++i)
@@ -179,6 +319,28 @@ void PersistentMinMaxVectorImageFilter<TInputImage>::Synthetize()
   // Set the outputs
   this->GetMinimumOutput()->Set(minimumVector);
   this->GetMaximumOutput()->Set(maximumVector);
+
+  if (!m_StatisticsFileName.empty() && !m_StatisticsReadFromFile)
+  {
+    // Keep the min and max of the other regions already in the file
+    StatisticsSidecarFile sidecar;
+    sidecar.SetKey(m_StatisticsFileKey);
+    sidecar.SetSignature(this->GetStatisticsSignature());
+    sidecar.Load(m_StatisticsFileName);
+    for (const auto& tile : m_TileStatistics)
+    {
+      sidecar.AddTile(tile);
+    }
+
+    try
+    {
+      sidecar.Save(m_StatisticsFileName);
+    }
+    catch (itk::ExceptionObject& err)
+    {
+      otbWarningMacro(<< "Statistics file not updated: " << err.GetDescription());
+    }
+  }
 }
 
 template <class TInputImage>
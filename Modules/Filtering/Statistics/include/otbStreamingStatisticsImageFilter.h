@@ -27,6 +27,9 @@
 #include "itkArray.h"
 #include "itkSimpleDataObjectDecorator.h"
 #include "otbPersistentFilterStreamingDecorator.h"
+#include "otbPerThreadAccumulator.h"
+#include "otbCompensatedAccumulators.h"
+#include <algorithm>
 
 namespace otb
 {
@@ -41,6 +44,11 @@ namespace otb
  *
  * To get the statistics once the regions have been processed via the pipeline, use the Synthetize() method.
  *
+ * Mean and variance are accumulated as sums of deviations from a shift and
+ * the sum with a compensated summation, in one accumulator per thread (see
+ * MomentsAccumulator and PerThreadAccumulator), so that the results stay
+ * accurate on large images.
+ *
  * \sa PersistentImageFilter
  * \ingroup Streamed
  * \ingroup Multithreaded
@@ -173,18 +181,39 @@ private:
   PersistentStatisticsImageFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
 
-  itk::Array<RealType>  m_ThreadSum;
-  itk::Array<RealType>  m_SumOfSquares;
-  itk::Array<long>      m_Count;
-  itk::Array<PixelType> m_ThreadMin;
-  itk::Array<PixelType> m_ThreadMax;
+  /** Partial statistics of a thread */
+  struct ThreadStatistics
+  {
+    ThreadStatistics()
+      : minimum(itk::NumericTraits<PixelType>::max()),
+        maximum(itk::NumericTraits<PixelType>::NonpositiveMin()),
+        ignoredInfinitePixelCount(0),
+        ignoredUserPixelCount(0)
+    {
+    }
+
+    void Merge(const ThreadStatistics& other)
+    {
+      moments.Merge(other.moments);
+      minimum = std::min(minimum, other.minimum);
+      maximum = std::max(maximum, other.maximum);
+      ignoredInfinitePixelCount += other.ignoredInfinitePixelCount;
+      ignoredUserPixelCount += other.ignoredUserPixelCount;
+    }
+
+    MomentsAccumulator<RealType> moments;
+    PixelType                    minimum;
+    PixelType                    maximum;
+    unsigned int                 ignoredInfinitePixelCount;
+    unsigned int                 ignoredUserPixelCount;
+  };
+
+  PerThreadAccumulator<ThreadStatistics> m_ThreadStatistics;
 
   /* Ignored values */
-  bool                      m_IgnoreInfiniteValues;
-  bool                      m_IgnoreUserDefinedValue;
-  RealType                  m_UserIgnoredValue;
-  std::vector<unsigned int> m_IgnoredInfinitePixelCount;
-  std::vector<unsigned int> m_IgnoredUserPixelCount;
+  bool     m_IgnoreInfiniteValues;
+  bool     m_IgnoreUserDefinedValue;
+  RealType m_UserIgnoredValue;
 
 
 }; // end of class PersistentStatisticsImageFilter
@@ -32,7 +32,7 @@ namespace otb
 
 template <class TInputImage>
 PersistentStatisticsImageFilter<TInputImage>::PersistentStatisticsImageFilter()
-  : m_ThreadSum(1), m_SumOfSquares(1), m_Count(1), m_ThreadMin(1), m_ThreadMax(1), m_IgnoreInfiniteValues(true), m_IgnoreUserDefinedValue(false)
+  : m_IgnoreInfiniteValues(true), m_IgnoreUserDefinedValue(false)
 {
   // first output is a copy of the image, DataObject created by
   // superclass
@@ -59,10 +59,6 @@ PersistentStatisticsImageFilter<TInputImage>::PersistentStatisticsImageFilter()
   this->GetVarianceOutput()->Set(itk::NumericTraits<RealType>::max());
   this->GetSumOutput()->Set(itk::NumericTraits<RealType>::Zero);
 
-  // Initiate the infinite ignored pixel counters
-  m_IgnoredInfinitePixelCount = std::vector<unsigned int>(this->GetNumberOfThreads(), 0);
-  m_IgnoredUserPixelCount     = std::vector<unsigned int>(this->GetNumberOfThreads(), 0);
-
   this->Reset();
 }
 
@@ -192,50 +188,22 @@ void PersistentStatisticsImageFilter<TInputImage>::AllocateOutputs()
 template <class TInputImage>
 void PersistentStatisticsImageFilter<TInputImage>::Synthetize()
 {
-  int      i;
-  long     count;
-  RealType sumOfSquares;
-
-  int numberOfThreads = this->GetNumberOfThreads();
-
-  PixelType minimum;
-  PixelType maximum;
-  RealType  mean     = itk::NumericTraits<RealType>::Zero;
-  RealType  sigma    = itk::NumericTraits<RealType>::Zero;
-  RealType  variance = itk::NumericTraits<RealType>::Zero;
-  RealType  sum;
-
-  sum = sumOfSquares = itk::NumericTraits<RealType>::Zero;
-  count              = 0;
-
-  // Find the min/max over all threads and accumulate count, sum and
-  // sum of squares
-  minimum = itk::NumericTraits<PixelType>::max();
-  maximum = itk::NumericTraits<PixelType>::NonpositiveMin();
-  for (i = 0; i < numberOfThreads; ++i)
-  {
-    count += m_Count[i];
-    sum += m_ThreadSum[i];
-    sumOfSquares += m_SumOfSquares[i];
+  RealType mean     = itk::NumericTraits<RealType>::Zero;
+  RealType sigma    = itk::NumericTraits<RealType>::Zero;
+  RealType variance = itk::NumericTraits<RealType>::Zero;
 
-    if (m_ThreadMin[i] < minimum)
-    {
-      minimum = m_ThreadMin[i];
-    }
-    if (m_ThreadMax[i] > maximum)
-    {
-      maximum = m_ThreadMax[i];
-    }
-  }
-  if (count > 0)
+  // Merge the statistics of all threads
+  const ThreadStatistics total = m_ThreadStatistics.Reduce([](ThreadStatistics& a, const ThreadStatistics& b) { a.Merge(b); });
+
+  if (total.moments.GetCount() > 0)
   {
     // compute statistics
-    mean = sum / static_cast<RealType>(count);
+    mean = total.moments.GetMean();
 
-    if (count > 1)
+    if (total.moments.GetCount() > 1)
     {
       // unbiased estimate
-      variance = (sumOfSquares - (sum * sum / static_cast<RealType>(count))) / static_cast<RealType>(count - 1);
+      variance = total.moments.GetVariance();
       sigma    = std::sqrt(variance);
     }
   }
@@ -245,40 +213,19 @@ void PersistentStatisticsImageFilter<TInputImage>::Synthetize()
   }
 
   // Set the outputs
-  this->GetMinimumOutput()->Set(minimum);
-  this->GetMaximumOutput()->Set(maximum);
+  this->GetMinimumOutput()->Set(total.minimum);
+  this->GetMaximumOutput()->Set(total.maximum);
   this->GetMeanOutput()->Set(mean);
   this->GetSigmaOutput()->Set(sigma);
   this->GetVarianceOutput()->Set(variance);
-  this->GetSumOutput()->Set(sum);
+  this->GetSumOutput()->Set(total.moments.GetSum());
 }
 
 template <class TInputImage>
 void PersistentStatisticsImageFilter<TInputImage>::Reset()
 {
-  int numberOfThreads = this->GetNumberOfThreads();
-
-  // Resize the thread temporaries
-  m_Count.SetSize(numberOfThreads);
-  m_SumOfSquares.SetSize(numberOfThreads);
-  m_ThreadSum.SetSize(numberOfThreads);
-  m_ThreadMin.SetSize(numberOfThreads);
-  m_ThreadMax.SetSize(numberOfThreads);
-  // Initialize the temporaries
-  m_Count.Fill(itk::NumericTraits<long>::Zero);
-  m_ThreadSum.Fill(itk::NumericTraits<RealType>::Zero);
-  m_SumOfSquares.Fill(itk::NumericTraits<RealType>::Zero);
-  m_ThreadMin.Fill(itk::NumericTraits<PixelType>::max());
-  m_ThreadMax.Fill(itk::NumericTraits<PixelType>::NonpositiveMin());
-  if (m_IgnoreInfiniteValues)
-  {
-    m_IgnoredInfinitePixelCount = std::vector<unsigned int>(numberOfThreads, 0);
-  }
-
-  if (m_IgnoreUserDefinedValue)
-  {
-    m_IgnoredUserPixelCount = std::vector<unsigned int>(this->GetNumberOfThreads(), 0);
-  }
+  // Initialize the thread temporaries
+  m_ThreadStatistics.Reset(this->GetNumberOfThreads(), ThreadStatistics());
 }
 
 template <class TInputImage>
@@ -291,6 +238,9 @@ void PersistentStatisticsImageFilter<TInputImage>::ThreadedGenerateData(const Re
   // support progress methods/callbacks
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
+  // Accumulate in a local copy, written back once the region is processed
+  ThreadStatistics stats = m_ThreadStatistics[threadId];
+
   RealType  realValue;
   PixelType value;
 
@@ -304,33 +254,33 @@ void PersistentStatisticsImageFilter<TInputImage>::ThreadedGenerateData(const Re
     realValue = static_cast<RealType>(value);
     if (m_IgnoreInfiniteValues && !(vnl_math_isfinite(realValue)))
     {
-      m_IgnoredInfinitePixelCount[threadId]++;
+      stats.ignoredInfinitePixelCount++;
     }
     else
     {
       if (m_IgnoreUserDefinedValue && (value == m_UserIgnoredValue))
       {
-        m_IgnoredUserPixelCount[threadId]++;
+        stats.ignoredUserPixelCount++;
       }
       else
       {
-        if (value < m_ThreadMin[threadId])
+        if (value < stats.minimum)
         {
-          m_ThreadMin[threadId] = value;
+          stats.minimum = value;
         }
-        if (value > m_ThreadMax[threadId])
+        if (value > stats.maximum)
         {
-          m_ThreadMax[threadId] = value;
+          stats.maximum = value;
         }
 
-        m_ThreadSum[threadId] += realValue;
-        m_SumOfSquares[threadId] += (realValue * realValue);
-        m_Count[threadId]++;
+        stats.moments.Add(realValue);
       }
     }
     ++it;
     progress.CompletedPixel();
   }
+
+  m_ThreadStatistics[threadId] = stats;
 }
 template <class TImage>
 void PersistentStatisticsImageFilter<TImage>::PrintSelf(std::ostream& os, itk::Indent indent) const
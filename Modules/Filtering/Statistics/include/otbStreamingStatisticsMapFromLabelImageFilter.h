@@ -27,7 +27,14 @@
 #include "itkArray.h"
 #include "itkSimpleDataObjectDecorator.h"
 #include "otbPersistentFilterStreamingDecorator.h"
+#include "otbPerThreadAccumulator.h"
+#include "otbQuantileSketch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace otb
 {
@@ -94,6 +101,26 @@ public:
     }
   }
 
+  // Constructor (initialize the accumulator with the given values of each band)
+  StatisticsAccumulator(RealValueType noDataValue, bool useNoDataValue, PixelCountType count, unsigned int nbBands, const PixelCountType* bandCount,
+                        const RealValueType* sum, const RealValueType* sqSum, const RealValueType* min, const RealValueType* max)
+    : m_NoDataValue(noDataValue), m_Count(count), m_UseNoDataValue(useNoDataValue)
+  {
+    m_BandCount.SetSize(nbBands);
+    m_Sum.SetSize(nbBands);
+    m_Min.SetSize(nbBands);
+    m_Max.SetSize(nbBands);
+    m_SqSum.SetSize(nbBands);
+    for (unsigned int band = 0; band < nbBands; band++)
+    {
+      m_BandCount[band] = bandCount[band];
+      m_Sum[band]       = sum[band];
+      m_Min[band]       = min[band];
+      m_Max[band]       = max[band];
+      m_SqSum[band]     = sqSum[band];
+    }
+  }
+
   // Function update (pixel)
   void Update(const TRealVectorPixelType& pixel)
   {
@@ -155,6 +182,129 @@ protected:
   bool                 m_UseNoDataValue;
 };
 
+/** \class DistributionAccumulator
+ * \brief Holds the distribution of the values of a label
+ *
+ * Quantiles of each band are estimated with a QuantileSketch, and the
+ * values of the categorical bands are counted to find their majority value.
+ * The categorical bands and the no data value are given to Update(), so
+ * that the accumulator of each label only stores sketches and counts.
+ * NaN values are ignored.
+ *
+ * \ingroup OTBStatistics
+ */
+class DistributionAccumulator
+{
+public:
+  typedef uint64_t                                       PixelCountType;
+  typedef std::vector<std::pair<double, PixelCountType>> CategoryCountListType;
+
+  DistributionAccumulator()
+  {
+  }
+
+  /** Allocate the sketches and the category counts */
+  void Initialize(unsigned int nbSketches, unsigned int nbCategoricalBands, double compression)
+  {
+    m_Sketches.assign(nbSketches, QuantileSketch(compression));
+    m_CategoryCounts.assign(nbCategoricalBands, CategoryCountListType());
+  }
+
+  bool IsInitialized() const
+  {
+    return !m_Sketches.empty() || !m_CategoryCounts.empty();
+  }
+
+  // Function update (pixel)
+  template <class TPixel>
+  void Update(const TPixel& pixel, const std::vector<unsigned int>& categoricalBands, double noDataValue, bool useNoDataValue)
+  {
+    for (unsigned int band = 0; band < m_Sketches.size(); band++)
+    {
+      const double value = pixel[band];
+      if (!std::isnan(value) && (!useNoDataValue || value != noDataValue))
+      {
+        m_Sketches[band].Add(value);
+      }
+    }
+    for (unsigned int i = 0; i < m_CategoryCounts.size(); i++)
+    {
+      const double value = pixel[categoricalBands[i]];
+      if (!std::isnan(value) && (!useNoDataValue || value != noDataValue))
+      {
+        AddCategory(m_CategoryCounts[i], value, 1);
+      }
+    }
+  }
+
+  // Function update (self)
+  void Update(const DistributionAccumulator& other)
+  {
+    if (!IsInitialized())
+    {
+      *this = other;
+      return;
+    }
+    for (unsigned int band = 0; band < m_Sketches.size(); band++)
+    {
+      m_Sketches[band].Merge(other.m_Sketches[band]);
+    }
+    for (unsigned int i = 0; i < m_CategoryCounts.size(); i++)
+    {
+      for (const auto& category : other.m_CategoryCounts[i])
+      {
+        AddCategory(m_CategoryCounts[i], category.first, category.second);
+      }
+    }
+  }
+
+  /** Quantile q (in [0, 1]) of a band, NaN if the band has no valid value */
+  double GetQuantile(unsigned int band, double q) const
+  {
+    return m_Sketches[band].GetQuantile(q);
+  }
+
+  /** Most frequent value of the i-th categorical band (the smallest one in
+   *  case of tie), NaN if the band has no valid value */
+  double GetMajority(unsigned int i) const
+  {
+    double         majority = std::numeric_limits<double>::quiet_NaN();
+    PixelCountType maxCount = 0;
+    for (const auto& category : m_CategoryCounts[i])
+    {
+      if (category.second > maxCount || (category.second == maxCount && category.first < majority))
+      {
+        majority = category.first;
+        maxCount = category.second;
+      }
+    }
+    return majority;
+  }
+
+private:
+  static void AddCategory(CategoryCountListType& counts, double value, PixelCountType count)
+  {
+    // Few categories are expected in a label: frequent ones are moved to the
+    // front of the list, where they are found first
+    for (auto it = counts.begin(); it != counts.end(); ++it)
+    {
+      if (it->first == value)
+      {
+        it->second += count;
+        if (it != counts.begin() && it->second > (it - 1)->second)
+        {
+          std::iter_swap(it, it - 1);
+        }
+        return;
+      }
+    }
+    counts.emplace_back(value, count);
+  }
+
+  std::vector<QuantileSketch>        m_Sketches;
+  std::vector<CategoryCountListType> m_CategoryCounts;
+};
+
 /** \class PersistentStreamingStatisticsMapFromLabelImageFilter
  * \brief Computes mean radiometric value for each label of a label image, based on a support VectorImage
  *
@@ -165,6 +315,18 @@ protected:
  *
  * To get the statistics once the regions have been processed via the pipeline, use the Synthetize() method.
  *
+ * Integer labels are accumulated in flat arrays (one per thread) over a
+ * range of consecutive labels, rather than in hash maps. The range is the
+ * one given by SetLabelRange(), or else it is found while reading the
+ * labels: it is extended up to MaximumDenseLabelRange labels (0 disables
+ * it), as long as most of it is used. Labels outside of the range are
+ * accumulated in hash maps. Each label of the range takes
+ * 8 + 40 * (number of bands) bytes per thread.
+ *
+ * Percentiles (SetPercentiles()) and the majority value of categorical
+ * bands (SetCategoricalBands()) can be computed in the same pass.
+ * Percentiles are estimated with a QuantileSketch for each label and band,
+ * they are exact for labels with a few tens of pixels.
  *
  * \sa StreamingStatisticsMapFromLabelImageFilter
  * \ingroup Streamed
@@ -195,16 +357,18 @@ public:
   typedef TLabelImage                         LabelImageType;
   typedef typename TLabelImage::Pointer       LabelImagePointer;
 
-  typedef typename VectorImageType::RegionType                    RegionType;
-  typedef typename VectorImageType::PixelType                     VectorPixelType;
-  typedef typename VectorImageType::PixelType::ValueType          VectorPixelValueType;
-  typedef typename LabelImageType::PixelType                      LabelPixelType;
-  typedef itk::VariableLengthVector<double>                       RealVectorPixelType;
-  typedef StatisticsAccumulator<RealVectorPixelType>              AccumulatorType;
-  typedef std::unordered_map<LabelPixelType, AccumulatorType>     AccumulatorMapType;
-  typedef std::vector<AccumulatorMapType>                         AccumulatorMapCollectionType;
-  typedef std::unordered_map<LabelPixelType, RealVectorPixelType> PixelValueMapType;
-  typedef std::unordered_map<LabelPixelType, double>              LabelPopulationMapType;
+  typedef typename VectorImageType::RegionType                        RegionType;
+  typedef typename VectorImageType::PixelType                         VectorPixelType;
+  typedef typename VectorImageType::PixelType::ValueType              VectorPixelValueType;
+  typedef typename LabelImageType::PixelType                          LabelPixelType;
+  typedef itk::VariableLengthVector<double>                           RealVectorPixelType;
+  typedef StatisticsAccumulator<RealVectorPixelType>                  AccumulatorType;
+  typedef typename AccumulatorType::PixelCountType                    PixelCountType;
+  typedef std::unordered_map<LabelPixelType, AccumulatorType>         AccumulatorMapType;
+  typedef std::unordered_map<LabelPixelType, DistributionAccumulator> DistributionMapType;
+  typedef std::vector<AccumulatorMapType>                             AccumulatorMapCollectionType;
+  typedef std::unordered_map<LabelPixelType, RealVectorPixelType>     PixelValueMapType;
+  typedef std::unordered_map<LabelPixelType, double>                  LabelPopulationMapType;
 
   itkStaticConstMacro(InputImageDimension, unsigned int, TInputVectorImage::ImageDimension);
 
@@ -216,6 +380,33 @@ public:
   itkGetMacro(UseNoDataValue, bool);
   itkSetMacro(UseNoDataValue, bool);
 
+  /** Set the range of the labels, accumulated in flat arrays. Labels
+   *  outside of this range are still accumulated, in hash maps. */
+  void SetLabelRange(LabelPixelType minimum, LabelPixelType maximum);
+  itkGetMacro(LabelRangeMinimum, LabelPixelType);
+  itkGetMacro(LabelRangeMaximum, LabelPixelType);
+  itkSetMacro(UseLabelRange, bool);
+  itkGetMacro(UseLabelRange, bool);
+  itkBooleanMacro(UseLabelRange);
+
+  /** Maximum number of labels of the range found while reading the labels,
+   *  when no label range is set (0 to use hash maps only) */
+  itkSetMacro(MaximumDenseLabelRange, unsigned long);
+  itkGetMacro(MaximumDenseLabelRange, unsigned long);
+
+  /** Percentiles to compute (in [0, 100]) */
+  void SetPercentiles(const std::vector<double>& percentiles);
+  const std::vector<double>& GetPercentiles() const;
+
+  /** Compression of the quantile sketches: larger values give more accurate
+   *  percentiles, using more memory */
+  itkSetMacro(PercentileCompression, double);
+  itkGetMacro(PercentileCompression, double);
+
+  /** Bands (starting at 0) holding categories, whose majority value is computed */
+  void SetCategoricalBands(const std::vector<unsigned int>& bands);
+  const std::vector<unsigned int>& GetCategoricalBands() const;
+
   /** Smart Pointer type to a DataObject. */
   typedef typename itk::DataObject::Pointer                  DataObjectPointer;
   typedef itk::ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
@@ -247,6 +438,13 @@ public:
   /** Return the computed number of labeled pixels for each label in the input label image */
   LabelPopulationMapType GetLabelPopulationMap() const;
 
+  /** Return the computed percentile for each label in the input label image
+   *  (index of the percentile in the Percentiles list) */
+  PixelValueMapType GetPercentileValueMap(unsigned int index) const;
+
+  /** Return the majority value of the categorical bands for each label in the input label image */
+  PixelValueMapType GetMajorityValueMap() const;
+
   /** Make a DataObject of the correct type to be used as the specified
    * output. */
   DataObjectPointer MakeOutput(DataObjectPointerArraySizeType idx) override;
@@ -280,10 +478,42 @@ private:
   PersistentStreamingStatisticsMapFromLabelImageFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
 
+  /** Accumulators of a thread. Labels of the dense range are accumulated in
+   *  flat arrays, at (label - DenseOffset) for counts and at
+   *  (label - DenseOffset) * nbBands + band for band statistics. */
+  struct ThreadAccumulator
+  {
+    long long                            DenseOffset         = 0;
+    unsigned long                        NumberOfDenseLabels = 0;
+    std::vector<PixelCountType>          DenseCount;
+    std::vector<PixelCountType>          DenseBandCount;
+    std::vector<double>                  DenseSum;
+    std::vector<double>                  DenseSqSum;
+    std::vector<double>                  DenseMin;
+    std::vector<double>                  DenseMax;
+    std::vector<DistributionAccumulator> DenseDistributions;
+    AccumulatorMapType                   Map;
+    DistributionMapType                  DistributionMap;
+  };
+
+  /** Try to extend the dense range of a thread to a label */
+  bool ExtendDenseRange(ThreadAccumulator& acc, long long label, unsigned int nbBands) const;
+
+  /** Move the dense range of a thread, keeping the accumulated labels */
+  void ResizeDenseRange(ThreadAccumulator& acc, long long offset, unsigned long size, unsigned int nbBands) const;
+
   VectorPixelValueType m_NoDataValue;
   bool                 m_UseNoDataValue;
 
-  AccumulatorMapCollectionType m_AccumulatorMaps;
+  LabelPixelType            m_LabelRangeMinimum;
+  LabelPixelType            m_LabelRangeMaximum;
+  bool                      m_UseLabelRange;
+  unsigned long             m_MaximumDenseLabelRange;
+  std::vector<double>       m_Percentiles;
+  double                    m_PercentileCompression;
+  std::vector<unsigned int> m_CategoricalBands;
+
+  PerThreadAccumulator<ThreadAccumulator> m_ThreadAccumulators;
 
   PixelValueMapType m_MeanRadiometricValue;
   PixelValueMapType m_StDevRadiometricValue;
@@ -292,6 +522,9 @@ private:
 
   LabelPopulationMapType m_LabelPopulation;
 
+  std::vector<PixelValueMapType> m_PercentileValues;
+  PixelValueMapType              m_MajorityValue;
+
 }; // end of class PersistentStreamingStatisticsMapFromLabelImageFilter
 
 
@@ -366,6 +599,7 @@ public:
   typedef typename Superclass::FilterType::PixelValueMapObjectType PixelValueMapObjectType;
 
   typedef typename Superclass::FilterType::LabelPopulationMapType LabelPopulationMapType;
+  typedef typename Superclass::FilterType::LabelPixelType         LabelPixelType;
 
   /** Set input multispectral image */
   using Superclass::SetInput;
@@ -446,6 +680,48 @@ public:
     return this->GetFilter()->GetUseNoDataValue();
   }
 
+  /** Set the range of the labels, accumulated in flat arrays */
+  void SetLabelRange(LabelPixelType minimum, LabelPixelType maximum)
+  {
+    this->GetFilter()->SetLabelRange(minimum, maximum);
+  }
+
+  /** Set the maximum number of labels of the range found while reading the labels */
+  void SetMaximumDenseLabelRange(unsigned long range)
+  {
+    this->GetFilter()->SetMaximumDenseLabelRange(range);
+  }
+
+  /** Set the percentiles to compute (in [0, 100]) */
+  void SetPercentiles(const std::vector<double>& percentiles)
+  {
+    this->GetFilter()->SetPercentiles(percentiles);
+  }
+
+  /** Set the compression of the quantile sketches */
+  void SetPercentileCompression(double compression)
+  {
+    this->GetFilter()->SetPercentileCompression(compression);
+  }
+
+  /** Set the bands holding categories */
+  void SetCategoricalBands(const std::vector<unsigned int>& bands)
+  {
+    this->GetFilter()->SetCategoricalBands(bands);
+  }
+
+  /** Return the computed percentile for each label */
+  PixelValueMapType GetPercentileValueMap(unsigned int index) const
+  {
+    return this->GetFilter()->GetPercentileValueMap(index);
+  }
+
+  /** Return the majority value of the categorical bands for each label */
+  PixelValueMapType GetMajorityValueMap() const
+  {
+    return this->GetFilter()->GetMajorityValueMap();
+  }
+
 protected:
   /** Constructor */
   StreamingStatisticsMapFromLabelImageFilter()
@@ -27,7 +27,9 @@
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
 #include "otbMacro.h"
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <utility>
 
 namespace otb
@@ -35,7 +37,12 @@ namespace otb
 
 template <class TInputVectorImage, class TLabelImage>
 PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::PersistentStreamingStatisticsMapFromLabelImageFilter()
-  : m_UseNoDataValue()
+  : m_UseNoDataValue(),
+    m_LabelRangeMinimum(),
+    m_LabelRangeMaximum(),
+    m_UseLabelRange(false),
+    m_MaximumDenseLabelRange(1 << 20),
+    m_PercentileCompression(100.)
 {
   // first output is a copy of the image, DataObject created by
   // superclass
@@ -104,6 +111,70 @@ PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelIm
   return m_LabelPopulation;
 }
 
+template <class TInputVectorImage, class TLabelImage>
+typename PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::PixelValueMapType
+PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::GetPercentileValueMap(unsigned int index) const
+{
+  if (index >= m_PercentileValues.size())
+  {
+    itkExceptionMacro(<< "No percentile at index " << index << ", " << m_PercentileValues.size() << " percentiles computed");
+  }
+  return m_PercentileValues[index];
+}
+
+template <class TInputVectorImage, class TLabelImage>
+typename PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::PixelValueMapType
+PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::GetMajorityValueMap() const
+{
+  return m_MajorityValue;
+}
+
+template <class TInputVectorImage, class TLabelImage>
+void PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::SetLabelRange(LabelPixelType minimum, LabelPixelType maximum)
+{
+  if (maximum < minimum)
+  {
+    itkExceptionMacro(<< "Invalid label range [" << minimum << ", " << maximum << "]");
+  }
+  m_LabelRangeMinimum = minimum;
+  m_LabelRangeMaximum = maximum;
+  m_UseLabelRange     = true;
+  this->Modified();
+}
+
+template <class TInputVectorImage, class TLabelImage>
+void PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::SetPercentiles(const std::vector<double>& percentiles)
+{
+  for (double percentile : percentiles)
+  {
+    if (!(percentile >= 0 && percentile <= 100))
+    {
+      itkExceptionMacro(<< "Invalid percentile " << percentile << ", it should be in [0, 100]");
+    }
+  }
+  m_Percentiles = percentiles;
+  this->Modified();
+}
+
+template <class TInputVectorImage, class TLabelImage>
+const std::vector<double>& PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::GetPercentiles() const
+{
+  return m_Percentiles;
+}
+
+template <class TInputVectorImage, class TLabelImage>
+void PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::SetCategoricalBands(const std::vector<unsigned int>& bands)
+{
+  m_CategoricalBands = bands;
+  this->Modified();
+}
+
+template <class TInputVectorImage, class TLabelImage>
+const std::vector<unsigned int>& PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::GetCategoricalBands() const
+{
+  return m_CategoricalBands;
+}
+
 template <class TInputVectorImage, class TLabelImage>
 void PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::GenerateOutputInformation()
 {
@@ -134,25 +205,55 @@ void PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLa
 template <class TInputVectorImage, class TLabelImage>
 void PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::Synthetize()
 {
+  const unsigned int nbBands              = this->GetInput()->GetNumberOfComponentsPerPixel();
+  const bool         computeDistributions = !m_Percentiles.empty() || !m_CategoricalBands.empty();
+
   // Update temporary accumulator
-  AccumulatorMapType outputAcc;
-  auto               endAcc = outputAcc.end();
+  AccumulatorMapType  outputAcc;
+  DistributionMapType outputDistributions;
 
-  for (auto const& threadAccMap : m_AccumulatorMaps)
+  auto mergeAccumulator = [&outputAcc](LabelPixelType label, const AccumulatorType& acc) {
+    auto itAcc = outputAcc.find(label);
+    if (itAcc == outputAcc.end())
+    {
+      outputAcc.emplace(label, acc);
+    }
+    else
+    {
+      itAcc->second.Update(acc);
+    }
+  };
+
+  for (itk::ThreadIdType threadId = 0; threadId < m_ThreadAccumulators.Size(); ++threadId)
   {
-    for (auto const& it : threadAccMap)
+    ThreadAccumulator& threadAcc = m_ThreadAccumulators[threadId];
+
+    for (std::size_t i = 0; i < threadAcc.DenseCount.size(); ++i)
     {
-      auto label = it.first;
-      auto itAcc = outputAcc.find(label);
-      if (itAcc == endAcc)
+      if (threadAcc.DenseCount[i] == 0)
       {
-        outputAcc.emplace(label, it.second);
+        continue;
       }
-      else
+      const LabelPixelType label  = static_cast<LabelPixelType>(threadAcc.DenseOffset + static_cast<long long>(i));
+      const std::size_t    offset = i * nbBands;
+      mergeAccumulator(label, AccumulatorType(this->GetNoDataValue(), this->GetUseNoDataValue(), threadAcc.DenseCount[i], nbBands,
+                                              &threadAcc.DenseBandCount[offset], &threadAcc.DenseSum[offset], &threadAcc.DenseSqSum[offset],
+                                              &threadAcc.DenseMin[offset], &threadAcc.DenseMax[offset]));
+      if (computeDistributions)
       {
-        itAcc->second.Update(it.second);
+        outputDistributions[label].Update(threadAcc.DenseDistributions[i]);
       }
     }
+
+    for (auto const& it : threadAcc.Map)
+    {
+      mergeAccumulator(it.first, it.second);
+    }
+
+    for (auto const& it : threadAcc.DistributionMap)
+    {
+      outputDistributions[it.first].Update(it.second);
+    }
   }
 
   // Publish output maps
@@ -196,19 +297,136 @@ void PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLa
     m_MinRadiometricValue.emplace(label, std::move(min));
     m_MaxRadiometricValue.emplace(label, std::move(max));
   }
+
+  // Percentiles & majority, with the no data value when no valid pixels were found
+  auto validValue = [this](double value) { return std::isnan(value) && this->GetUseNoDataValue() ? static_cast<double>(this->GetNoDataValue()) : value; };
+
+  m_PercentileValues.assign(m_Percentiles.size(), PixelValueMapType());
+  for (auto& it : outputDistributions)
+  {
+    for (unsigned int p = 0; p < m_Percentiles.size(); p++)
+    {
+      RealVectorPixelType percentile(nbBands);
+      for (unsigned int band = 0; band < nbBands; band++)
+      {
+        percentile[band] = validValue(it.second.GetQuantile(band, m_Percentiles[p] / 100.));
+      }
+      m_PercentileValues[p].emplace(it.first, std::move(percentile));
+    }
+
+    if (!m_CategoricalBands.empty())
+    {
+      RealVectorPixelType majority(m_CategoricalBands.size());
+      for (unsigned int i = 0; i < m_CategoricalBands.size(); i++)
+      {
+        majority[i] = validValue(it.second.GetMajority(i));
+      }
+      m_MajorityValue.emplace(it.first, std::move(majority));
+    }
+  }
 }
 
 template <class TInputVectorImage, class TLabelImage>
 void PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::Reset()
 {
-  m_AccumulatorMaps.clear();
-
   m_MeanRadiometricValue.clear();
   m_StDevRadiometricValue.clear();
   m_MinRadiometricValue.clear();
   m_MaxRadiometricValue.clear();
   m_LabelPopulation.clear();
-  m_AccumulatorMaps.resize(this->GetNumberOfThreads());
+  m_PercentileValues.clear();
+  m_MajorityValue.clear();
+  m_ThreadAccumulators.Reset(this->GetNumberOfThreads(), ThreadAccumulator());
+}
+
+template <class TInputVectorImage, class TLabelImage>
+bool PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::ExtendDenseRange(ThreadAccumulator& acc, long long label,
+                                                                                                            unsigned int nbBands) const
+{
+  // Smallest range that is always allowed, and minimum proportion of its
+  // labels to be found beyond
+  const unsigned long long minimumRange = 1 << 16;
+  const unsigned long long maximumRatio = 8;
+
+  long long first = label;
+  long long last  = label;
+  if (!acc.DenseCount.empty())
+  {
+    first = std::min(acc.DenseOffset, label);
+    last  = std::max(acc.DenseOffset + static_cast<long long>(acc.DenseCount.size()) - 1, label);
+  }
+  const unsigned long long range = static_cast<unsigned long long>(last) - static_cast<unsigned long long>(first) + 1;
+  if (range > m_MaximumDenseLabelRange || (range > minimumRange && range > maximumRatio * (acc.NumberOfDenseLabels + 1)))
+  {
+    return false;
+  }
+
+  // Extend the range further on the side of the new label, so that it is not
+  // reallocated for each new label
+  const long double        lowestLabel = std::numeric_limits<LabelPixelType>::lowest();
+  const long double        maxLabel    = std::numeric_limits<LabelPixelType>::max();
+  const unsigned long long margin      =
+      std::min<unsigned long long>(std::max<unsigned long long>(acc.DenseCount.size() / 2, 16), m_MaximumDenseLabelRange - range);
+  if (!acc.DenseCount.empty() && label < acc.DenseOffset && first - lowestLabel >= margin)
+  {
+    first -= margin;
+  }
+  else if (maxLabel - last >= margin)
+  {
+    last += margin;
+  }
+
+  ResizeDenseRange(acc, first, static_cast<unsigned long>(last - first + 1), nbBands);
+  return true;
+}
+
+template <class TInputVectorImage, class TLabelImage>
+void PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLabelImage>::ResizeDenseRange(ThreadAccumulator& acc, long long offset,
+                                                                                                            unsigned long size, unsigned int nbBands) const
+{
+  ThreadAccumulator resized;
+  resized.DenseOffset         = offset;
+  resized.NumberOfDenseLabels = acc.NumberOfDenseLabels;
+  resized.DenseCount.assign(size, 0);
+  resized.DenseBandCount.assign(size * nbBands, 0);
+  resized.DenseSum.assign(size * nbBands, 0.);
+  resized.DenseSqSum.assign(size * nbBands, 0.);
+  resized.DenseMin.assign(size * nbBands, std::numeric_limits<double>::max());
+  resized.DenseMax.assign(size * nbBands, std::numeric_limits<double>::lowest());
+  if (!m_Percentiles.empty() || !m_CategoricalBands.empty())
+  {
+    resized.DenseDistributions.resize(size);
+  }
+
+  // Copy the labels accumulated so far
+  const std::size_t shift = acc.DenseOffset - offset;
+  for (std::size_t i = 0; i < acc.DenseCount.size(); ++i)
+  {
+    if (acc.DenseCount[i] == 0)
+    {
+      continue;
+    }
+    resized.DenseCount[i + shift] = acc.DenseCount[i];
+    std::copy_n(&acc.DenseBandCount[i * nbBands], nbBands, &resized.DenseBandCount[(i + shift) * nbBands]);
+    std::copy_n(&acc.DenseSum[i * nbBands], nbBands, &resized.DenseSum[(i + shift) * nbBands]);
+    std::copy_n(&acc.DenseSqSum[i * nbBands], nbBands, &resized.DenseSqSum[(i + shift) * nbBands]);
+    std::copy_n(&acc.DenseMin[i * nbBands], nbBands, &resized.DenseMin[(i + shift) * nbBands]);
+    std::copy_n(&acc.DenseMax[i * nbBands], nbBands, &resized.DenseMax[(i + shift) * nbBands]);
+    if (!resized.DenseDistributions.empty())
+    {
+      resized.DenseDistributions[i + shift] = std::move(acc.DenseDistributions[i]);
+    }
+  }
+
+  acc.DenseOffset         = resized.DenseOffset;
+  acc.NumberOfDenseLabels = resized.NumberOfDenseLabels;
+  acc.DenseCount.swap(resized.DenseCount);
+  acc.DenseBandCount.swap(resized.DenseBandCount);
+  acc.DenseSum.swap(resized.DenseSum);
+  acc.DenseSqSum.swap(resized.DenseSqSum);
+  acc.DenseMin.swap(resized.DenseMin);
+  acc.DenseMax.swap(resized.DenseMax);
+  acc.DenseDistributions.swap(resized.DenseDistributions);
 }
 
 template <class TInputVectorImage, class TLabelImage>
@@ -253,8 +471,19 @@ void PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLa
   itk::ImageRegionConstIterator<TLabelImage>       labelIt(labelInputPtr, outputRegionForThread);
   itk::ProgressReporter                            progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
-  auto& acc    = m_AccumulatorMaps[threadId];
-  auto  endAcc = acc.end();
+  const unsigned int nbBands              = inputPtr->GetNumberOfComponentsPerPixel();
+  const double       noDataValue          = this->GetNoDataValue();
+  const bool         useNoDataValue       = this->GetUseNoDataValue();
+  const bool         computeDistributions = !m_Percentiles.empty() || !m_CategoricalBands.empty();
+  const bool         denseLabels          = std::numeric_limits<LabelPixelType>::is_integer && std::numeric_limits<LabelPixelType>::digits < 64 &&
+                                            (m_UseLabelRange || m_MaximumDenseLabelRange > 0);
+  ThreadAccumulator& acc                  = m_ThreadAccumulators[threadId];
+
+  if (denseLabels && m_UseLabelRange && acc.DenseCount.empty())
+  {
+    const long long first = static_cast<long long>(m_LabelRangeMinimum);
+    ResizeDenseRange(acc, first, static_cast<unsigned long>(static_cast<long long>(m_LabelRangeMaximum) - first + 1), nbBands);
+  }
 
   // do the work
   for (inIt.GoToBegin(), labelIt.GoToBegin(); !inIt.IsAtEnd() && !labelIt.IsAtEnd(); ++inIt, ++labelIt)
@@ -262,17 +491,78 @@ void PersistentStreamingStatisticsMapFromLabelImageFilter<TInputVectorImage, TLa
     const auto& value = inIt.Get();
     auto        label = labelIt.Get();
 
+    if (denseLabels)
+    {
+      const long long key = static_cast<long long>(label);
+      if ((key < acc.DenseOffset || key - acc.DenseOffset >= static_cast<long long>(acc.DenseCount.size())) && !m_UseLabelRange)
+      {
+        ExtendDenseRange(acc, key, nbBands);
+      }
+
+      if (key >= acc.DenseOffset && key - acc.DenseOffset < static_cast<long long>(acc.DenseCount.size()))
+      {
+        // Update the flat arrays
+        const std::size_t i = key - acc.DenseOffset;
+        if (acc.DenseCount[i]++ == 0)
+        {
+          ++acc.NumberOfDenseLabels;
+        }
+        PixelCountType* bandCount = &acc.DenseBandCount[i * nbBands];
+        double*         sum       = &acc.DenseSum[i * nbBands];
+        double*         sqSum     = &acc.DenseSqSum[i * nbBands];
+        double*         min       = &acc.DenseMin[i * nbBands];
+        double*         max       = &acc.DenseMax[i * nbBands];
+        for (unsigned int band = 0; band < nbBands; band++)
+        {
+          const double v = value[band];
+          if (!useNoDataValue || v != noDataValue)
+          {
+            ++bandCount[band];
+            sum[band] += v;
+            sqSum[band] += v * v;
+            if (v < min[band])
+              min[band] = v;
+            if (v > max[band])
+              max[band] = v;
+          }
+        }
+
+        if (computeDistributions)
+        {
+          DistributionAccumulator& distribution = acc.DenseDistributions[i];
+          if (!distribution.IsInitialized())
+          {
+            distribution.Initialize(m_Percentiles.empty() ? 0 : nbBands, m_CategoricalBands.size(), m_PercentileCompression);
+          }
+          distribution.Update(value, m_CategoricalBands, noDataValue, useNoDataValue);
+        }
+
+        progress.CompletedPixel();
+        continue;
+      }
+    }
+
     // Update the accumulator
-    auto itAcc = acc.find(label);
-    if (itAcc == endAcc)
+    auto itAcc = acc.Map.find(label);
+    if (itAcc == acc.Map.end())
     {
-      acc.emplace(label, AccumulatorType(this->GetNoDataValue(), this->GetUseNoDataValue(), value));
+      acc.Map.emplace(label, AccumulatorType(this->GetNoDataValue(), this->GetUseNoDataValue(), value));
     }
     else
     {
       itAcc->second.Update(value);
     }
 
+    if (computeDistributions)
+    {
+      DistributionAccumulator& distribution = acc.DistributionMap[label];
+      if (!distribution.IsInitialized())
+      {
+        distribution.Initialize(m_Percentiles.empty() ? 0 : nbBands, m_CategoricalBands.size(), m_PercentileCompression);
+      }
+      distribution.Update(value, m_CategoricalBands, noDataValue, useNoDataValue);
+    }
+
     progress.CompletedPixel();
   }
 }
@@ -28,6 +28,7 @@
 #include "itkImageRegionSplitter.h"
 #include "itkVariableSizeMatrix.h"
 #include "itkVariableLengthVector.h"
+#include "otbStatisticsSidecarFile.h"
 
 namespace otb
 {
@@ -42,6 +43,16 @@ namespace otb
  *
  * To get the statistics once the regions have been processed via the pipeline, use the Synthetize() method.
  *
+ * If a statistics file name is set, the partial statistics of each
+ * processed region are kept separately, merged in a deterministic order by
+ * Synthetize(), and saved in this sidecar file (see
+ * otb::StatisticsSidecarFile). ReadStatisticsFile() can then restore the
+ * statistics of the input largest possible region, or of any region made
+ * of previously processed regions, without processing the image again.
+ * The results are exactly the ones of the run which wrote the file. The
+ * statistics file key should identify the input data (for instance, the
+ * fingerprint of the input file).
+ *
  * \sa PersistentImageFilter
  * \ingroup Streamed
  * \ingroup Multithreaded
@@ -212,6 +223,22 @@ public:
   itkSetMacro(UseUnbiasedEstimator, bool);
   itkGetMacro(UseUnbiasedEstimator, bool);
 
+  /** Sidecar file storing the partial statistics (empty to disable) */
+  itkSetMacro(StatisticsFileName, std::string);
+  itkGetConstReferenceMacro(StatisticsFileName, std::string);
+
+  /** Key identifying the input data in the sidecar file */
+  itkSetMacro(StatisticsFileKey, std::string);
+  itkGetConstReferenceMacro(StatisticsFileKey, std::string);
+
+  /** Restore the partial statistics of the input largest possible region
+   * from the sidecar file. To be called after Reset(). Returns false if
+   * the file can not provide them: the input must then be processed. */
+  bool ReadStatisticsFile();
+
+  /** true if the last statistics were restored from the sidecar file */
+  itkGetConstMacro(StatisticsReadFromFile, bool);
+
 protected:
   PersistentStreamingStatisticsVectorImageFilter();
 
@@ -231,10 +258,28 @@ protected:
   /** Multi-thread version GenerateData. */
   void ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
 
+  /** Store the partial statistics of the processed region, if a
+   * statistics file is used */
+  void AfterThreadedGenerateData() override;
+
 private:
   PersistentStreamingStatisticsVectorImageFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
 
+  typedef StatisticsSidecarFile::TileType TileStatisticsType;
+
+  /** Set the per thread accumulators to their initial values */
+  void ResetThreadAccumulators(unsigned int numberOfComponent);
+
+  /** Describe the settings the partial statistics depend on */
+  std::string GetStatisticsSignature() const;
+
+  /** Number of values in the partial statistics of a region */
+  unsigned int GetNumberOfTileValues(unsigned int numberOfComponent) const;
+
+  /** Accumulate all the partial statistics in the accumulators of the first thread */
+  void MergeTileStatistics(unsigned int numberOfComponent);
+
   bool m_EnableMinMax;
   bool m_EnableFirstOrderStats;
   bool m_EnableSecondOrderStats;
@@ -257,6 +302,12 @@ private:
   std::vector<unsigned int> m_IgnoredInfinitePixelCount;
   std::vector<unsigned int> m_IgnoredUserPixelCount;
 
+  /* Partial statistics of each region, when a statistics file is used */
+  std::string                     m_StatisticsFileName;
+  std::string                     m_StatisticsFileKey;
+  std::vector<TileStatisticsType> m_TileStatistics;
+  bool                            m_StatisticsReadFromFile;
+
 }; // end of class PersistentStreamingStatisticsVectorImageFilter
 
 /**===========================================================================*/
@@ -272,6 +323,10 @@ private:
  * By default infinite values are ignored, use IgnoreInfiniteValues accessor to consider
  * infinite values in the computation.
  *
+ * When a statistics file name is set, the statistics are restored from this
+ * sidecar file if it holds them, and the image is not streamed at all.
+ * Otherwise, the image is streamed and the file is updated.
+ *
  * \sa PersistentStreamingStatisticsVectorImageFilter
  * \sa PersistentImageFilter
  * \sa PersistentFilterStreamingDecorator
@@ -488,6 +543,14 @@ public:
   otbSetObjectMemberMacro(Filter, UseUnbiasedEstimator, bool);
   otbGetObjectMemberMacro(Filter, UseUnbiasedEstimator, bool);
 
+  otbSetObjectMemberMacro(Filter, StatisticsFileName, std::string);
+  otbGetObjectMemberMacro(Filter, StatisticsFileName, std::string);
+
+  otbSetObjectMemberMacro(Filter, StatisticsFileKey, std::string);
+  otbGetObjectMemberMacro(Filter, StatisticsFileKey, std::string);
+
+  otbGetObjectMemberMacro(Filter, StatisticsReadFromFile, bool);
+
 protected:
   /** Constructor */
   StreamingStatisticsVectorImageFilter()
@@ -499,6 +562,20 @@ protected:
   {
   }
 
+  /** Skip the streaming when the statistics file holds the statistics */
+  void GenerateData(void) override
+  {
+    this->GetFilter()->Reset();
+
+    if (!this->GetFilter()->ReadStatisticsFile())
+    {
+      this->GetStreamer()->SetInput(this->GetFilter()->GetOutput());
+      this->GetStreamer()->Update();
+    }
+
+    this->GetFilter()->Synthetize();
+  }
+
 private:
   StreamingStatisticsVectorImageFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
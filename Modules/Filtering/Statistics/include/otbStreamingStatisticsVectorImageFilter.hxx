@@ -27,6 +27,10 @@
 #include "itkProgressReporter.h"
 #include "otbMacro.h"
 
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
 namespace otb
 {
 
@@ -38,7 +42,8 @@ PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::Persist
     m_UseUnbiasedEstimator(true),
     m_IgnoreInfiniteValues(true),
     m_IgnoreUserDefinedValue(false),
-    m_UserIgnoredValue(itk::NumericTraits<InternalPixelType>::Zero)
+    m_UserIgnoredValue(itk::NumericTraits<InternalPixelType>::Zero),
+    m_StatisticsReadFromFile(false)
 {
   // first output is a copy of the image, DataObject created by
   // superclass
@@ -267,7 +272,6 @@ void PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::Re
   TInputImage* inputPtr = const_cast<TInputImage*>(this->GetInput());
   inputPtr->UpdateOutputInformation();
 
-  unsigned int numberOfThreads   = this->GetNumberOfThreads();
   unsigned int numberOfComponent = inputPtr->GetNumberOfComponentsPerPixel();
 
   if (m_EnableMinMax)
@@ -280,7 +284,44 @@ void PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::Re
 
     tempPixel.Fill(itk::NumericTraits<InternalPixelType>::NonpositiveMin());
     this->GetMaximumOutput()->Set(tempPixel);
+  }
+
+  if (m_EnableSecondOrderStats)
+  {
+    m_EnableFirstOrderStats = true;
+  }
+
+  if (m_EnableFirstOrderStats)
+  {
+    RealPixelType zeroRealPixel;
+    zeroRealPixel.SetSize(numberOfComponent);
+    zeroRealPixel.Fill(itk::NumericTraits<PrecisionType>::ZeroValue());
+    this->GetMeanOutput()->Set(zeroRealPixel);
+    this->GetSumOutput()->Set(zeroRealPixel);
+  }
+
+  if (m_EnableSecondOrderStats)
+  {
+    MatrixType zeroMatrix;
+    zeroMatrix.SetSize(numberOfComponent, numberOfComponent);
+    zeroMatrix.Fill(itk::NumericTraits<PrecisionType>::Zero);
+    this->GetCovarianceOutput()->Set(zeroMatrix);
+    this->GetCorrelationOutput()->Set(zeroMatrix);
+  }
+
+  this->ResetThreadAccumulators(numberOfComponent);
+
+  m_TileStatistics.clear();
+  m_StatisticsReadFromFile = false;
+}
+
+template <class TInputImage, class TPrecision>
+void PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::ResetThreadAccumulators(unsigned int numberOfComponent)
+{
+  unsigned int numberOfThreads = this->GetNumberOfThreads();
 
+  if (m_EnableMinMax)
+  {
     PixelType tempTemporiesPixel;
     tempTemporiesPixel.SetSize(numberOfComponent);
     tempTemporiesPixel.Fill(itk::NumericTraits<InternalPixelType>::max());
@@ -290,18 +331,11 @@ void PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::Re
     m_ThreadMax = std::vector<PixelType>(numberOfThreads, tempTemporiesPixel);
   }
 
-  if (m_EnableSecondOrderStats)
-  {
-    m_EnableFirstOrderStats = true;
-  }
-
   if (m_EnableFirstOrderStats)
   {
     RealPixelType zeroRealPixel;
     zeroRealPixel.SetSize(numberOfComponent);
     zeroRealPixel.Fill(itk::NumericTraits<PrecisionType>::ZeroValue());
-    this->GetMeanOutput()->Set(zeroRealPixel);
-    this->GetSumOutput()->Set(zeroRealPixel);
     m_ThreadFirstOrderAccumulators.resize(numberOfThreads);
     std::fill(m_ThreadFirstOrderAccumulators.begin(), m_ThreadFirstOrderAccumulators.end(), zeroRealPixel);
 
@@ -315,9 +349,6 @@ void PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::Re
     MatrixType zeroMatrix;
     zeroMatrix.SetSize(numberOfComponent, numberOfComponent);
     zeroMatrix.Fill(itk::NumericTraits<PrecisionType>::Zero);
-    this->GetCovarianceOutput()->Set(zeroMatrix);
-    this->GetCorrelationOutput()->Set(zeroMatrix);
-
     m_ThreadSecondOrderAccumulators.resize(numberOfThreads);
     std::fill(m_ThreadSecondOrderAccumulators.begin(), m_ThreadSecondOrderAccumulators.end(), zeroMatrix);
 
@@ -333,7 +364,241 @@ void PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::Re
 
   if (m_IgnoreUserDefinedValue)
   {
-    m_IgnoredUserPixelCount = std::vector<unsigned int>(this->GetNumberOfThreads(), 0);
+    m_IgnoredUserPixelCount = std::vector<unsigned int>(numberOfThreads, 0);
+  }
+}
+
+template <class TInputImage, class TPrecision>
+std::string PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::GetStatisticsSignature() const
+{
+  std::ostringstream oss;
+  oss.precision(std::numeric_limits<double>::max_digits10);
+  oss << "StreamingStatisticsVectorImageFilter"
+      << " dimension " << ImageDimension << " components " << this->GetInput()->GetNumberOfComponentsPerPixel() << " pixel "
+      << sizeof(InternalPixelType) << (std::numeric_limits<InternalPixelType>::is_integer ? "i" : "f") << " precision " << sizeof(PrecisionType)
+      << " minmax " << m_EnableMinMax << " first " << m_EnableFirstOrderStats << " second " << m_EnableSecondOrderStats << " infinite "
+      << m_IgnoreInfiniteValues << " user " << m_IgnoreUserDefinedValue;
+  if (m_IgnoreUserDefinedValue)
+  {
+    oss << " " << static_cast<double>(m_UserIgnoredValue);
+  }
+  return oss.str();
+}
+
+template <class TInputImage, class TPrecision>
+unsigned int PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::GetNumberOfTileValues(unsigned int numberOfComponent) const
+{
+  // Ignored pixel counts, then min and max, first order and second order
+  // accumulators (see AfterThreadedGenerateData())
+  unsigned int nbValues = 2;
+  if (m_EnableMinMax)
+  {
+    nbValues += 2 * numberOfComponent;
+  }
+  if (m_EnableFirstOrderStats)
+  {
+    nbValues += numberOfComponent + 1;
+  }
+  if (m_EnableSecondOrderStats)
+  {
+    nbValues += numberOfComponent * numberOfComponent + 1;
+  }
+  return nbValues;
+}
+
+template <class TInputImage, class TPrecision>
+bool PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::ReadStatisticsFile()
+{
+  m_TileStatistics.clear();
+  m_StatisticsReadFromFile = false;
+
+  if (m_StatisticsFileName.empty())
+  {
+    return false;
+  }
+
+  TInputImage* inputPtr = const_cast<TInputImage*>(this->GetInput());
+  inputPtr->UpdateOutputInformation();
+
+  StatisticsSidecarFile sidecar;
+  sidecar.SetKey(m_StatisticsFileKey);
+  sidecar.SetSignature(this->GetStatisticsSignature());
+  if (!sidecar.Load(m_StatisticsFileName))
+  {
+    return false;
+  }
+
+  const RegionType&          region = inputPtr->GetLargestPossibleRegion();
+  std::vector<long>          regionIndex(ImageDimension);
+  std::vector<unsigned long> regionSize(ImageDimension);
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    regionIndex[d] = region.GetIndex()[d];
+    regionSize[d]  = region.GetSize()[d];
+  }
+
+  std::vector<TileStatisticsType> tiles;
+  if (!sidecar.FindPartition(regionIndex, regionSize, tiles))
+  {
+    return false;
+  }
+
+  const unsigned int nbValues = this->GetNumberOfTileValues(inputPtr->GetNumberOfComponentsPerPixel());
+  for (const auto& tile : tiles)
+  {
+    if (tile.values.size() != nbValues)
+    {
+      return false;
+    }
+  }
+
+  otbMsgDevMacro(<< "Statistics of " << tiles.size() << " regions read from " << m_StatisticsFileName);
+  m_TileStatistics.swap(tiles);
+  m_StatisticsReadFromFile = true;
+  return true;
+}
+
+template <class TInputImage, class TPrecision>
+void PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::AfterThreadedGenerateData()
+{
+  if (m_StatisticsFileName.empty())
+  {
+    return;
+  }
+
+  // Reduce the thread accumulators to the partial statistics of the
+  // processed region, and restart from empty accumulators for the next one
+  const unsigned int numberOfComponent = this->GetInput()->GetNumberOfComponentsPerPixel();
+  const unsigned int numberOfThreads   = this->GetNumberOfThreads();
+  const RegionType&  region            = this->GetOutput()->GetRequestedRegion();
+
+  TileStatisticsType tile;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    tile.index.push_back(region.GetIndex()[d]);
+    tile.size.push_back(region.GetSize()[d]);
+  }
+  tile.values.reserve(this->GetNumberOfTileValues(numberOfComponent));
+
+  unsigned int ignoredInfinitePixelCount = 0;
+  unsigned int ignoredUserPixelCount     = 0;
+  for (unsigned int threadId = 0; threadId < numberOfThreads; ++threadId)
+  {
+    ignoredInfinitePixelCount += m_IgnoredInfinitePixelCount[threadId];
+    ignoredUserPixelCount += m_IgnoredUserPixelCount[threadId];
+  }
+  tile.values.push_back(ignoredInfinitePixelCount);
+  tile.values.push_back(ignoredUserPixelCount);
+
+  if (m_EnableMinMax)
+  {
+    PixelType minimum = m_ThreadMin[0];
+    PixelType maximum = m_ThreadMax[0];
+    for (unsigned int threadId = 1; threadId < numberOfThreads; ++threadId)
+    {
+      for (unsigned int j = 0; j < numberOfComponent; ++j)
+      {
+        minimum[j] = std::min(minimum[j], m_ThreadMin[threadId][j]);
+        maximum[j] = std::max(maximum[j], m_ThreadMax[threadId][j]);
+      }
+    }
+    for (unsigned int j = 0; j < numberOfComponent; ++j)
+    {
+      tile.values.push_back(static_cast<double>(minimum[j]));
+    }
+    for (unsigned int j = 0; j < numberOfComponent; ++j)
+    {
+      tile.values.push_back(static_cast<double>(maximum[j]));
+    }
+  }
+
+  if (m_EnableFirstOrderStats)
+  {
+    RealPixelType firstOrder          = m_ThreadFirstOrderAccumulators[0];
+    RealType      firstOrderComponent = m_ThreadFirstOrderComponentAccumulators[0];
+    for (unsigned int threadId = 1; threadId < numberOfThreads; ++threadId)
+    {
+      firstOrder += m_ThreadFirstOrderAccumulators[threadId];
+      firstOrderComponent += m_ThreadFirstOrderComponentAccumulators[threadId];
+    }
+    for (unsigned int j = 0; j < numberOfComponent; ++j)
+    {
+      tile.values.push_back(firstOrder[j]);
+    }
+    tile.values.push_back(firstOrderComponent);
+  }
+
+  if (m_EnableSecondOrderStats)
+  {
+    MatrixType secondOrder          = m_ThreadSecondOrderAccumulators[0];
+    RealType   secondOrderComponent = m_ThreadSecondOrderComponentAccumulators[0];
+    for (unsigned int threadId = 1; threadId < numberOfThreads; ++threadId)
+    {
+      secondOrder += m_ThreadSecondOrderAccumulators[threadId];
+      secondOrderComponent += m_ThreadSecondOrderComponentAccumulators[threadId];
+    }
+    for (unsigned int r = 0; r < numberOfComponent; ++r)
+    {
+      for (unsigned int c = 0; c < numberOfComponent; ++c)
+      {
+        tile.values.push_back(secondOrder(r, c));
+      }
+    }
+    tile.values.push_back(secondOrderComponent);
+  }
+
+  m_TileStatistics.push_back(tile);
+  this->ResetThreadAccumulators(numberOfComponent);
+}
+
+template <class TInputImage, class TPrecision>
+void PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::MergeTileStatistics(unsigned int numberOfComponent)
+{
+  this->ResetThreadAccumulators(numberOfComponent);
+
+  // Regions are always merged in the same order, so that the statistics
+  // do not depend on the streaming order nor on the origin of the partials
+  std::sort(m_TileStatistics.begin(), m_TileStatistics.end());
+
+  for (const auto& tile : m_TileStatistics)
+  {
+    std::vector<double>::const_iterator value = tile.values.begin();
+
+    m_IgnoredInfinitePixelCount[0] += static_cast<unsigned int>(*value++);
+    m_IgnoredUserPixelCount[0] += static_cast<unsigned int>(*value++);
+
+    if (m_EnableMinMax)
+    {
+      for (unsigned int j = 0; j < numberOfComponent; ++j, ++value)
+      {
+        m_ThreadMin[0][j] = std::min(m_ThreadMin[0][j], static_cast<InternalPixelType>(*value));
+      }
+      for (unsigned int j = 0; j < numberOfComponent; ++j, ++value)
+      {
+        m_ThreadMax[0][j] = std::max(m_ThreadMax[0][j], static_cast<InternalPixelType>(*value));
+      }
+    }
+
+    if (m_EnableFirstOrderStats)
+    {
+      for (unsigned int j = 0; j < numberOfComponent; ++j, ++value)
+      {
+        m_ThreadFirstOrderAccumulators[0][j] += static_cast<PrecisionType>(*value);
+      }
+      m_ThreadFirstOrderComponentAccumulators[0] += static_cast<RealType>(*value++);
+    }
+
+    if (m_EnableSecondOrderStats)
+    {
+      for (unsigned int r = 0; r < numberOfComponent; ++r)
+      {
+        for (unsigned int c = 0; c < numberOfComponent; ++c, ++value)
+        {
+          m_ThreadSecondOrderAccumulators[0](r, c) += static_cast<PrecisionType>(*value);
+        }
+      }
+      m_ThreadSecondOrderComponentAccumulators[0] += static_cast<RealType>(*value++);
+    }
   }
 }
 
@@ -344,6 +609,13 @@ void PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::Sy
   const unsigned int nbPixels          = inputPtr->GetLargestPossibleRegion().GetNumberOfPixels();
   const unsigned int numberOfComponent = inputPtr->GetNumberOfComponentsPerPixel();
 
+  // With a statistics file, the totals are the merge of the partial
+  // statistics of each region, whether they were computed or read
+  if (!m_StatisticsFileName.empty())
+  {
+    this->MergeTileStatistics(numberOfComponent);
+  }
+
   PixelType minimum;
   minimum.SetSize(numberOfComponent);
   minimum.Fill(itk::NumericTraits<InternalPixelType>::max());
@@ -469,6 +741,28 @@ void PersistentStreamingStatisticsVectorImageFilter<TInputImage, TPrecision>::Sy
     this->GetComponentCorrelationOutput()->Set(streamSecondOrderComponentAccumulator / (nbRelevantPixel * numberOfComponent));
     this->GetComponentCovarianceOutput()->Set(regulComponent * (this->GetComponentCorrelation() - (this->GetComponentMean() * this->GetComponentMean())));
   }
+
+  if (!m_StatisticsFileName.empty() && !m_StatisticsReadFromFile)
+  {
+    // Keep the partial statistics of the other regions already in the file
+    StatisticsSidecarFile sidecar;
+    sidecar.SetKey(m_StatisticsFileKey);
+    sidecar.SetSignature(this->GetStatisticsSignature());
+    sidecar.Load(m_StatisticsFileName);
+    for (const auto& tile : m_TileStatistics)
+    {
+      sidecar.AddTile(tile);
+    }
+
+    try
+    {
+      sidecar.Save(m_StatisticsFileName);
+    }
+    catch (itk::ExceptionObject& err)
+    {
+      otbWarningMacro(<< "Statistics file not updated: " << err.GetDescription());
+    }
+  }
 }
 
 template <class TInputImage, class TPrecision>
@@ -572,6 +866,7 @@ void PersistentStreamingStatisticsVectorImageFilter<TImage, TPrecision>::PrintSe
   os << indent << "Component Covariance: " << this->GetComponentCovarianceOutput()->Get() << std::endl;
   os << indent << "Component Correlation: " << this->GetComponentCorrelationOutput()->Get() << std::endl;
   os << indent << "UseUnbiasedEstimator: " << (this->m_UseUnbiasedEstimator ? "true" : "false") << std::endl;
+  os << indent << "StatisticsFileName: " << m_StatisticsFileName << std::endl;
 }
 
 } // end namespace otb
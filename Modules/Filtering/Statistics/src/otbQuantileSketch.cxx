@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbQuantileSketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace otb
+{
+
+namespace
+{
+const double Pi = 3.14159265358979323846;
+
+/** Largest quantile a centroid starting at quantile q can reach: the k1
+ * scale function k(q) = compression / (2 pi) * asin(2q - 1) may increase by
+ * at most 1 over a centroid */
+double QuantileLimit(double q, double compression)
+{
+  const double k = compression / (2 * Pi) * std::asin(2 * q - 1) + 1;
+  if (k >= compression / 4)
+  {
+    return 1.;
+  }
+  return (std::sin(k * 2 * Pi / compression) + 1) / 2;
+}
+} // namespace
+
+QuantileSketch::QuantileSketch(double compression)
+  : m_Compression(std::max(compression, 10.)),
+    m_Count(0.),
+    m_Minimum(std::numeric_limits<double>::infinity()),
+    m_Maximum(-std::numeric_limits<double>::infinity())
+{
+}
+
+void QuantileSketch::Add(double value)
+{
+  m_Pending.push_back(Centroid{value, 1.});
+  m_Count += 1.;
+  m_Minimum = std::min(m_Minimum, value);
+  m_Maximum = std::max(m_Maximum, value);
+  if (m_Pending.size() >= m_Compression)
+  {
+    Compress();
+  }
+}
+
+void QuantileSketch::Merge(const QuantileSketch& other)
+{
+  if (other.m_Count == 0)
+  {
+    return;
+  }
+  other.Compress();
+  m_Pending.insert(m_Pending.end(), other.m_Centroids.begin(), other.m_Centroids.end());
+  m_Count += other.m_Count;
+  m_Minimum = std::min(m_Minimum, other.m_Minimum);
+  m_Maximum = std::max(m_Maximum, other.m_Maximum);
+  Compress();
+}
+
+void QuantileSketch::Compress() const
+{
+  if (m_Pending.empty())
+  {
+    return;
+  }
+
+  m_Pending.insert(m_Pending.end(), m_Centroids.begin(), m_Centroids.end());
+  std::sort(m_Pending.begin(), m_Pending.end());
+  m_Centroids.clear();
+
+  const double total        = m_Count;
+  double       weightBefore = 0.;
+  double       weightLimit  = total * QuantileLimit(0., m_Compression);
+  Centroid     current      = m_Pending.front();
+  for (auto it = m_Pending.begin() + 1; it != m_Pending.end(); ++it)
+  {
+    if (weightBefore + current.Weight + it->Weight <= weightLimit)
+    {
+      current.Weight += it->Weight;
+      current.Mean += (it->Mean - current.Mean) * it->Weight / current.Weight;
+    }
+    else
+    {
+      weightBefore += current.Weight;
+      m_Centroids.push_back(current);
+      weightLimit = total * QuantileLimit(weightBefore / total, m_Compression);
+      current     = *it;
+    }
+  }
+  m_Centroids.push_back(current);
+  m_Pending.clear();
+}
+
+unsigned int QuantileSketch::GetNumberOfCentroids() const
+{
+  Compress();
+  return m_Centroids.size();
+}
+
+double QuantileSketch::GetQuantile(double q) const
+{
+  if (m_Count == 0)
+  {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  Compress();
+
+  const double position = std::min(std::max(q, 0.), 1.) * m_Count;
+
+  // Before the center of the first centroid, or after the last one
+  const Centroid& first = m_Centroids.front();
+  if (position < first.Weight / 2)
+  {
+    return m_Minimum + (first.Mean - m_Minimum) * position / (first.Weight / 2);
+  }
+  const Centroid& last = m_Centroids.back();
+  if (position > m_Count - last.Weight / 2)
+  {
+    return m_Maximum - (m_Maximum - last.Mean) * (m_Count - position) / (last.Weight / 2);
+  }
+
+  // Between the centers of two centroids
+  double center = first.Weight / 2;
+  for (unsigned int i = 0; i + 1 < m_Centroids.size(); ++i)
+  {
+    const double step = (m_Centroids[i].Weight + m_Centroids[i + 1].Weight) / 2;
+    if (position <= center + step)
+    {
+      return m_Centroids[i].Mean + (m_Centroids[i + 1].Mean - m_Centroids[i].Mean) * (position - center) / step;
+    }
+    center += step;
+  }
+  return last.Mean;
+}
+
+} // end namespace otb
@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbStatisticsSidecarFile.h"
+#include "otbMacro.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace otb
+{
+
+namespace
+{
+const char* const SidecarMagic = "OTB_STATISTICS_SIDECAR";
+const int         SidecarVersion = 1;
+
+/** Read a double written by Save(), including nan and inf */
+bool ReadValue(std::istream& is, double& value)
+{
+  std::string token;
+  if (!(is >> token))
+  {
+    return false;
+  }
+  char* end = nullptr;
+  value     = std::strtod(token.c_str(), &end);
+  return end != token.c_str() && *end == '\0';
+}
+
+/** Split an extended filename into the file name and its options, as
+ * ExtendedFilenameHelper does */
+void SplitExtendedFileName(const std::string& fileName, std::string& simpleFileName, std::string& options)
+{
+  const std::string::size_type pos = fileName.find('?');
+  simpleFileName                   = fileName.substr(0, pos);
+  options                          = pos == std::string::npos ? std::string() : fileName.substr(pos);
+}
+} // namespace
+
+unsigned long StatisticsSidecarFile::TileType::GetNumberOfPixels() const
+{
+  unsigned long nbPixels = size.empty() ? 0 : 1;
+  for (auto s : size)
+  {
+    nbPixels *= s;
+  }
+  return nbPixels;
+}
+
+bool StatisticsSidecarFile::TileType::IsInside(const std::vector<long>& regionIndex, const std::vector<unsigned long>& regionSize) const
+{
+  if (regionIndex.size() != index.size() || regionSize.size() != size.size())
+  {
+    return false;
+  }
+  for (unsigned int d = 0; d < index.size(); ++d)
+  {
+    if (index[d] < regionIndex[d] || index[d] + static_cast<long>(size[d]) > regionIndex[d] + static_cast<long>(regionSize[d]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool StatisticsSidecarFile::TileType::Overlaps(const TileType& other) const
+{
+  if (other.index.size() != index.size())
+  {
+    return false;
+  }
+  for (unsigned int d = 0; d < index.size(); ++d)
+  {
+    if (index[d] >= other.index[d] + static_cast<long>(other.size[d]) || other.index[d] >= index[d] + static_cast<long>(size[d]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool StatisticsSidecarFile::TileType::operator<(const TileType& other) const
+{
+  return std::lexicographical_compare(index.rbegin(), index.rend(), other.index.rbegin(), other.index.rend());
+}
+
+StatisticsSidecarFile::StatisticsSidecarFile()
+{
+}
+
+void StatisticsSidecarFile::SetKey(const std::string& key)
+{
+  m_Key = key;
+}
+
+const std::string& StatisticsSidecarFile::GetKey() const
+{
+  return m_Key;
+}
+
+void StatisticsSidecarFile::SetSignature(const std::string& signature)
+{
+  m_Signature = signature;
+}
+
+const std::string& StatisticsSidecarFile::GetSignature() const
+{
+  return m_Signature;
+}
+
+bool StatisticsSidecarFile::Load(const std::string& fileName)
+{
+  m_Tiles.clear();
+
+  std::ifstream ifs(fileName.c_str());
+  if (!ifs)
+  {
+    return false;
+  }
+
+  std::string magic, line;
+  int         version = 0;
+  if (!(ifs >> magic >> version) || magic != SidecarMagic || version != SidecarVersion)
+  {
+    otbMsgDevMacro(<< "Not a statistics sidecar file: " << fileName);
+    return false;
+  }
+  std::getline(ifs, line);
+
+  // Key and signature take the rest of their lines
+  std::string key, signature;
+  if (!std::getline(ifs, line) || line.compare(0, 4, "key ") != 0)
+  {
+    return false;
+  }
+  key = line.substr(4);
+  if (!std::getline(ifs, line) || line.compare(0, 10, "signature ") != 0)
+  {
+    return false;
+  }
+  signature = line.substr(10);
+
+  if (key != m_Key || signature != m_Signature)
+  {
+    otbMsgDevMacro(<< "Statistics sidecar file " << fileName << " does not match the current data or settings");
+    return false;
+  }
+
+  std::string   token;
+  unsigned long nbTiles = 0;
+  if (!(ifs >> token >> nbTiles) || token != "tiles")
+  {
+    return false;
+  }
+
+  std::vector<TileType> tiles(nbTiles);
+  for (auto& tile : tiles)
+  {
+    unsigned int  dimension = 0;
+    unsigned long nbValues  = 0;
+    if (!(ifs >> dimension))
+    {
+      return false;
+    }
+    tile.index.resize(dimension);
+    tile.size.resize(dimension);
+    for (auto& i : tile.index)
+    {
+      ifs >> i;
+    }
+    for (auto& s : tile.size)
+    {
+      ifs >> s;
+    }
+    if (!(ifs >> nbValues))
+    {
+      return false;
+    }
+    tile.values.resize(nbValues);
+    for (auto& v : tile.values)
+    {
+      if (!ReadValue(ifs, v))
+      {
+        return false;
+      }
+    }
+  }
+
+  // Tiles of a valid file never overlap
+  for (unsigned int i = 0; i < tiles.size(); ++i)
+  {
+    for (unsigned int j = i + 1; j < tiles.size(); ++j)
+    {
+      if (tiles[i].Overlaps(tiles[j]))
+      {
+        return false;
+      }
+    }
+  }
+
+  m_Tiles.swap(tiles);
+  return true;
+}
+
+void StatisticsSidecarFile::Save(const std::string& fileName) const
+{
+  std::ofstream ofs(fileName.c_str());
+  if (!ofs)
+  {
+    itkGenericExceptionMacro(<< "Unable to write statistics sidecar file " << fileName);
+  }
+
+  ofs.precision(std::numeric_limits<double>::max_digits10);
+
+  ofs << SidecarMagic << " " << SidecarVersion << "\n";
+  ofs << "key " << m_Key << "\n";
+  ofs << "signature " << m_Signature << "\n";
+  ofs << "tiles " << m_Tiles.size() << "\n";
+  for (const auto& tile : m_Tiles)
+  {
+    ofs << tile.index.size();
+    for (auto i : tile.index)
+    {
+      ofs << " " << i;
+    }
+    for (auto s : tile.size)
+    {
+      ofs << " " << s;
+    }
+    ofs << " " << tile.values.size();
+    for (auto v : tile.values)
+    {
+      ofs << " " << v;
+    }
+    ofs << "\n";
+  }
+
+  if (!ofs)
+  {
+    itkGenericExceptionMacro(<< "Error while writing statistics sidecar file " << fileName);
+  }
+}
+
+void StatisticsSidecarFile::AddTile(const TileType& tile)
+{
+  m_Tiles.erase(std::remove_if(m_Tiles.begin(), m_Tiles.end(), [&tile](const TileType& t) { return t.Overlaps(tile); }), m_Tiles.end());
+  m_Tiles.push_back(tile);
+}
+
+const std::vector<StatisticsSidecarFile::TileType>& StatisticsSidecarFile::GetTiles() const
+{
+  return m_Tiles;
+}
+
+void StatisticsSidecarFile::Clear()
+{
+  m_Tiles.clear();
+}
+
+bool StatisticsSidecarFile::FindPartition(const std::vector<long>& regionIndex, const std::vector<unsigned long>& regionSize,
+                                          std::vector<TileType>& tiles) const
+{
+  tiles.clear();
+
+  unsigned long regionPixels = regionSize.empty() ? 0 : 1;
+  for (auto s : regionSize)
+  {
+    regionPixels *= s;
+  }
+
+  // Stored tiles never overlap (see AddTile()), so the tiles inside the
+  // region partition it if they cover as many pixels as the region
+  unsigned long coveredPixels = 0;
+  for (const auto& tile : m_Tiles)
+  {
+    if (tile.IsInside(regionIndex, regionSize))
+    {
+      tiles.push_back(tile);
+      coveredPixels += tile.GetNumberOfPixels();
+    }
+  }
+
+  if (regionPixels == 0 || coveredPixels != regionPixels)
+  {
+    tiles.clear();
+    return false;
+  }
+
+  std::sort(tiles.begin(), tiles.end());
+  return true;
+}
+
+std::string StatisticsSidecarFile::ComputeFileFingerprint(const std::string& fileName)
+{
+  std::string simpleFileName, options;
+  SplitExtendedFileName(fileName, simpleFileName, options);
+  if (simpleFileName.empty() || !itksys::SystemTools::FileExists(simpleFileName, true))
+  {
+    return std::string();
+  }
+  std::ostringstream oss;
+  oss << itksys::SystemTools::GetRealPath(simpleFileName) << " " << itksys::SystemTools::FileLength(simpleFileName) << " "
+      << itksys::SystemTools::ModifiedTime(simpleFileName);
+  if (!options.empty())
+  {
+    oss << " " << options;
+  }
+  return oss.str();
+}
+
+std::string StatisticsSidecarFile::GetSidecarFileName(const std::string& fileName)
+{
+  std::string simpleFileName, options;
+  SplitExtendedFileName(fileName, simpleFileName, options);
+  return simpleFileName + ".stats";
+}
+
+} // end namespace otb
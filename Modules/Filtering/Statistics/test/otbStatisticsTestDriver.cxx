@@ -38,12 +38,16 @@ void RegisterTests()
   REGISTER_TEST(otbProjectiveProjectionTestHighSNR);
   REGISTER_TEST(otbShiftScaleVectorImageFilterTest);
   REGISTER_TEST(otbStreamingCompareImageFilter);
+  REGISTER_TEST(otbStreamingContingencyMatrixImageFilter);
   REGISTER_TEST(otbStreamingStatisticsMapFromLabelImageFilterTest);
+  REGISTER_TEST(otbStreamingStatisticsMapFromLabelImageFilterDistribution);
   REGISTER_TEST(otbRealAndImaginaryImageToComplexImageFilterTest);
   REGISTER_TEST(otbStreamingStatisticsImageFilter);
   REGISTER_TEST(otbListSampleToBalancedListSampleFilter);
   REGISTER_TEST(otbStreamingStatisticsVectorImageFilter);
+  REGISTER_TEST(otbStreamingStatisticsVectorImageFilterSidecar);
   REGISTER_TEST(otbStreamingMinMaxVectorImageFilter);
+  REGISTER_TEST(otbStreamingMinMaxVectorImageFilterSidecar);
   REGISTER_TEST(otbListSampleGenerator);
   REGISTER_TEST(otbImaginaryImageToComplexImageFilterTest);
   REGISTER_TEST(otbListSampleToHistogramListGenerator);
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbImage.h"
+#include "otbStreamingContingencyMatrixImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include <map>
+
+int otbStreamingContingencyMatrixImageFilter(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  typedef otb::Image<int, 2> LabelImageType;
+  typedef otb::StreamingContingencyMatrixImageFilter<LabelImageType> FilterType;
+  typedef FilterType::AccumulatorType AccumulatorType;
+  typedef itk::ImageRegionIteratorWithIndex<LabelImageType> IteratorType;
+  typedef std::map<int, std::map<int, std::map<int, unsigned long>>> ExpectedCountsType;
+
+  const int noData = 255;
+
+  LabelImageType::RegionType region;
+  region.SetIndex(0, 0);
+  region.SetIndex(1, 0);
+  region.SetSize(0, 97);
+  region.SetSize(1, 83);
+
+  LabelImageType::Pointer produced  = LabelImageType::New();
+  LabelImageType::Pointer reference = LabelImageType::New();
+  LabelImageType::Pointer zones     = LabelImageType::New();
+  for (auto image : {produced, reference, zones})
+  {
+    image->SetRegions(region);
+    image->Allocate();
+  }
+
+  // Labels vary along lines and columns, some produced labels are not in
+  // the reference, and a few pixels are no-data in either image
+  ExpectedCountsType expected;
+  IteratorType       prodIt(produced, region);
+  IteratorType       refIt(reference, region);
+  IteratorType       zoneIt(zones, region);
+  for (prodIt.GoToBegin(), refIt.GoToBegin(), zoneIt.GoToBegin(); !prodIt.IsAtEnd(); ++prodIt, ++refIt, ++zoneIt)
+  {
+    const int x    = prodIt.GetIndex()[0];
+    const int y    = prodIt.GetIndex()[1];
+    const int ref  = (x / 10 + y / 20) % 5 + 1;
+    const int prod = (x * y) % 13 == 0 ? noData : ((x + y) % 7 == 0 ? ref + 10 : ref);
+    const int zone = (x < 50 ? 0 : 1) + (y < 40 ? 0 : 2);
+    refIt.Set((x + 3 * y) % 29 == 0 ? noData : ref);
+    prodIt.Set(prod);
+    zoneIt.Set(zone);
+    if (refIt.Get() != noData && prod != noData)
+    {
+      expected[zone][ref][prod]++;
+    }
+  }
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(produced);
+  filter->SetReferenceImage(reference);
+  filter->SetZoneImage(zones);
+  filter->SetReferenceNoData(noData);
+  filter->SetProducedNoData(noData);
+  filter->GetStreamer()->SetNumberOfDivisionsStrippedStreaming(5);
+  filter->Update();
+
+  const AccumulatorType&                   total        = filter->GetContingencyMatrix();
+  const FilterType::ZoneAccumulatorMapType& zoneMatrices = filter->GetZoneContingencyMatrices();
+
+  if (zoneMatrices.size() != expected.size())
+  {
+    std::cerr << "Wrong number of zones: " << zoneMatrices.size() << " instead of " << expected.size() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::map<int, std::map<int, unsigned long>> expectedTotal;
+  unsigned long                               nbSamples = 0;
+  for (auto const& zone : expected)
+  {
+    auto itZone = zoneMatrices.find(zone.first);
+    if (itZone == zoneMatrices.end())
+    {
+      std::cerr << "Zone " << zone.first << " is missing" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (auto const& ref : zone.second)
+    {
+      for (auto const& prod : ref.second)
+      {
+        if (itZone->second.GetCount(ref.first, prod.first) != prod.second)
+        {
+          std::cerr << "Wrong count in zone " << zone.first << " for labels " << ref.first << ", " << prod.first << ": "
+                    << itZone->second.GetCount(ref.first, prod.first) << " instead of " << prod.second << std::endl;
+          return EXIT_FAILURE;
+        }
+        expectedTotal[ref.first][prod.first] += prod.second;
+        nbSamples += prod.second;
+      }
+    }
+  }
+
+  if (total.GetNumberOfSamples() != nbSamples)
+  {
+    std::cerr << "Wrong number of samples: " << total.GetNumberOfSamples() << " instead of " << nbSamples << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The matrix is ordered by sorted labels
+  const AccumulatorType::LabelListType refLabels  = total.GetReferenceLabels();
+  const AccumulatorType::LabelListType prodLabels = total.GetProducedLabels();
+  const AccumulatorType::MatrixType    matrix     = total.GetMatrix();
+  std::cout << "Contingency matrix (" << refLabels.size() << " reference labels, " << prodLabels.size() << " produced labels):" << std::endl;
+  std::cout << matrix << std::endl;
+
+  for (unsigned int i = 0; i < refLabels.size(); ++i)
+  {
+    if (i > 0 && refLabels[i - 1] >= refLabels[i])
+    {
+      std::cerr << "Reference labels are not sorted" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (unsigned int j = 0; j < prodLabels.size(); ++j)
+    {
+      if (matrix(i, j) != expectedTotal[refLabels[i]][prodLabels[j]])
+      {
+        std::cerr << "Wrong count for labels " << refLabels[i] << ", " << prodLabels[j] << ": " << matrix(i, j) << " instead of "
+                  << expectedTotal[refLabels[i]][prodLabels[j]] << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
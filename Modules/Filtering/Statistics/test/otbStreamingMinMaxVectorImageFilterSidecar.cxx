@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbStreamingMinMaxVectorImageFilter.h"
+#include "otbImageFileReader.h"
+#include "otbVectorImage.h"
+#include "itksys/SystemTools.hxx"
+
+int otbStreamingMinMaxVectorImageFilterSidecar(int itkNotUsed(argc), char* argv[])
+{
+  // The sidecar file is written next to the image: work on a copy
+  const char* infname = argv[2];
+  if (!itksys::SystemTools::CopyFileAlways(argv[1], infname))
+  {
+    std::cerr << "Unable to copy " << argv[1] << " to " << infname << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  typedef otb::VectorImage<double, 2> ImageType;
+  typedef otb::ImageFileReader<ImageType>                  ReaderType;
+  typedef otb::StreamingMinMaxVectorImageFilter<ImageType> MinMaxFilterType;
+
+  // The options of an extended filename are not part of the sidecar file
+  // name, but they are part of the key
+  const std::string extendedfname = std::string(infname) + "?&bands=1";
+  const std::string sidecarfname  = otb::StatisticsSidecarFile::GetSidecarFileName(extendedfname);
+  if (sidecarfname != std::string(infname) + ".stats")
+  {
+    std::cerr << "Wrong sidecar file name " << sidecarfname << " for " << extendedfname << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const std::string key         = otb::StatisticsSidecarFile::ComputeFileFingerprint(infname);
+  const std::string extendedKey = otb::StatisticsSidecarFile::ComputeFileFingerprint(extendedfname);
+  if (key.empty() || extendedKey.empty() || extendedKey == key)
+  {
+    std::cerr << "The fingerprints of " << infname << " and " << extendedfname << " should be set and differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (!otb::StatisticsSidecarFile::ComputeFileFingerprint(std::string(infname) + ".missing").empty())
+  {
+    std::cerr << "The fingerprint of a missing file should be empty" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  itksys::SystemTools::RemoveFile(sidecarfname);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(extendedfname);
+
+  // First run: computes the min and max and writes the sidecar file
+  MinMaxFilterType::Pointer computed = MinMaxFilterType::New();
+  computed->GetStreamer()->SetNumberOfLinesStrippedStreaming(10);
+  computed->SetInput(reader->GetOutput());
+  computed->SetStatisticsFileName(sidecarfname);
+  computed->SetStatisticsFileKey(extendedKey);
+  computed->Update();
+
+  if (computed->GetStatisticsReadFromFile() || !itksys::SystemTools::FileExists(sidecarfname, true))
+  {
+    std::cerr << "First run should compute the min and max and write the sidecar file" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Second run: reads the min and max back, they must be exactly the same
+  MinMaxFilterType::Pointer read = MinMaxFilterType::New();
+  read->GetStreamer()->SetNumberOfLinesStrippedStreaming(7);
+  read->SetInput(reader->GetOutput());
+  read->SetStatisticsFileName(sidecarfname);
+  read->SetStatisticsFileKey(extendedKey);
+  read->Update();
+
+  if (!read->GetStatisticsReadFromFile())
+  {
+    std::cerr << "Second run should read the min and max from the sidecar file" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (read->GetMinimum() != computed->GetMinimum() || read->GetMaximum() != computed->GetMaximum())
+  {
+    std::cerr << "Min and max read from the sidecar file differ from the computed ones" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Different settings: the sidecar file can not be used
+  MinMaxFilterType::Pointer other = MinMaxFilterType::New();
+  other->SetInput(reader->GetOutput());
+  other->SetStatisticsFileName(sidecarfname);
+  other->SetStatisticsFileKey(extendedKey);
+  other->GetFilter()->SetNoDataFlag(true);
+  other->Update();
+
+  if (other->GetStatisticsReadFromFile())
+  {
+    std::cerr << "Sidecar file should not be used with different settings" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Other options of the extended filename: the sidecar file can not be used either
+  MinMaxFilterType::Pointer otherKey = MinMaxFilterType::New();
+  otherKey->SetInput(reader->GetOutput());
+  otherKey->SetStatisticsFileName(sidecarfname);
+  otherKey->SetStatisticsFileKey(key);
+  otherKey->GetFilter()->SetNoDataFlag(true);
+  otherKey->Update();
+
+  if (otherKey->GetStatisticsReadFromFile())
+  {
+    std::cerr << "Sidecar file should not be used with a different key" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
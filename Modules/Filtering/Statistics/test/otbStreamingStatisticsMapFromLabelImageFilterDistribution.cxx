@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbVectorImage.h"
+#include "otbImage.h"
+#include "otbStreamingStatisticsMapFromLabelImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+int otbStreamingStatisticsMapFromLabelImageFilterDistribution(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  typedef otb::VectorImage<float, 2>                                                       VectorImageType;
+  typedef otb::Image<unsigned int, 2>                                                      LabelImageType;
+  typedef otb::StreamingStatisticsMapFromLabelImageFilter<VectorImageType, LabelImageType> FilterType;
+  typedef FilterType::PixelValueMapType                                                    PixelValueMapType;
+  typedef FilterType::LabelPopulationMapType                                               LabelPopulationMapType;
+  typedef itk::ImageRegionIteratorWithIndex<VectorImageType>                               VectorIteratorType;
+  typedef itk::ImageRegionIteratorWithIndex<LabelImageType>                                LabelIteratorType;
+
+  const unsigned int        nbBands     = 3;
+  const float               noData      = -1;
+  const unsigned int        outlier     = 1000000;
+  const std::vector<double> percentiles = {0, 25, 50, 90, 100};
+
+  VectorImageType::RegionType region;
+  region.SetIndex(0, 0);
+  region.SetIndex(1, 0);
+  region.SetSize(0, 71);
+  region.SetSize(1, 53);
+
+  VectorImageType::Pointer image = VectorImageType::New();
+  image->SetNumberOfComponentsPerPixel(nbBands);
+  image->SetRegions(region);
+  image->Allocate();
+  LabelImageType::Pointer labels = LabelImageType::New();
+  labels->SetRegions(region);
+  labels->Allocate();
+
+  // Zones of 7x5 pixels, plus a label far from the others. Band 0 has
+  // no-data pixels, band 2 holds categories.
+  std::map<unsigned int, std::vector<std::vector<double>>> values;
+  VectorIteratorType imageIt(image, region);
+  LabelIteratorType  labelIt(labels, region);
+  for (imageIt.GoToBegin(), labelIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt, ++labelIt)
+  {
+    const unsigned int x     = imageIt.GetIndex()[0];
+    const unsigned int y     = imageIt.GetIndex()[1];
+    const unsigned int label = (x * y) % 37 == 5 ? outlier : x / 7 + (y / 5) * 11;
+
+    VectorImageType::PixelType pixel(nbBands);
+    pixel[0] = (x + 2 * y) % 17 == 0 ? noData : static_cast<float>((x * 31 + y * 17) % 101);
+    pixel[1] = static_cast<float>(x) * 0.5f - static_cast<float>(y);
+    pixel[2] = static_cast<float>((x / 3 + y / 2) % 4);
+    imageIt.Set(pixel);
+    labelIt.Set(label);
+
+    auto& labelValues = values[label];
+    labelValues.resize(nbBands);
+    for (unsigned int band = 0; band < nbBands; ++band)
+    {
+      if (pixel[band] != noData)
+      {
+        labelValues[band].push_back(pixel[band]);
+      }
+    }
+  }
+
+  // Hash maps only, labels found while reading, and a given label range
+  std::vector<FilterType::Pointer> filters;
+  for (unsigned int mode = 0; mode < 3; ++mode)
+  {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(image);
+    filter->SetInputLabelImage(labels);
+    filter->SetNoDataValue(noData);
+    filter->SetUseNoDataValue(true);
+    filter->SetPercentiles(percentiles);
+    filter->SetCategoricalBands({2});
+    if (mode == 0)
+    {
+      filter->SetMaximumDenseLabelRange(0);
+    }
+    else if (mode == 2)
+    {
+      filter->SetLabelRange(0, 120);
+    }
+    filter->GetStreamer()->SetNumberOfDivisionsStrippedStreaming(4);
+    filter->Update();
+    filters.push_back(filter);
+  }
+
+  auto sameMaps = [](const PixelValueMapType& a, const PixelValueMapType& b, double tolerance) {
+    if (a.size() != b.size())
+    {
+      return false;
+    }
+    for (const auto& it : a)
+    {
+      auto other = b.find(it.first);
+      if (other == b.end() || other->second.GetSize() != it.second.GetSize())
+      {
+        return false;
+      }
+      for (unsigned int i = 0; i < it.second.GetSize(); ++i)
+      {
+        if (std::abs(it.second[i] - other->second[i]) > tolerance * (1 + std::abs(it.second[i])))
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  int result = EXIT_SUCCESS;
+  for (unsigned int mode = 1; mode < filters.size(); ++mode)
+  {
+    bool same = filters[mode]->GetLabelPopulationMap() == filters[0]->GetLabelPopulationMap() &&
+                sameMaps(filters[mode]->GetMeanValueMap(), filters[0]->GetMeanValueMap(), 1e-12) &&
+                sameMaps(filters[mode]->GetStandardDeviationValueMap(), filters[0]->GetStandardDeviationValueMap(), 1e-9) &&
+                sameMaps(filters[mode]->GetMinValueMap(), filters[0]->GetMinValueMap(), 0) &&
+                sameMaps(filters[mode]->GetMaxValueMap(), filters[0]->GetMaxValueMap(), 0) &&
+                sameMaps(filters[mode]->GetMajorityValueMap(), filters[0]->GetMajorityValueMap(), 0);
+    for (unsigned int p = 0; p < percentiles.size(); ++p)
+    {
+      same = same && sameMaps(filters[mode]->GetPercentileValueMap(p), filters[0]->GetPercentileValueMap(p), 0);
+    }
+    if (!same)
+    {
+      std::cout << "Statistics of mode " << mode << " differ from the ones computed with hash maps" << std::endl;
+      result = EXIT_FAILURE;
+    }
+  }
+
+  // Check the percentiles and the majority against the sorted values
+  LabelPopulationMapType population = filters[1]->GetLabelPopulationMap();
+  PixelValueMapType      majority   = filters[1]->GetMajorityValueMap();
+  if (population.size() != values.size())
+  {
+    std::cout << "Found " << population.size() << " labels instead of " << values.size() << std::endl;
+    return EXIT_FAILURE;
+  }
+  for (auto& it : values)
+  {
+    for (unsigned int band = 0; band < nbBands; ++band)
+    {
+      std::vector<double>& sorted = it.second[band];
+      std::sort(sorted.begin(), sorted.end());
+      for (unsigned int p = 0; p < percentiles.size(); ++p)
+      {
+        // Allow one rank of error on each side
+        const double value = filters[1]->GetPercentileValueMap(p)[it.first][band];
+        const double rank  = percentiles[p] / 100. * (sorted.size() - 1);
+        const double lower = sorted[std::max(0., std::floor(rank) - 1.)];
+        const double upper = sorted[std::min(sorted.size() - 1., std::ceil(rank) + 1.)];
+        if (value < lower || value > upper || (p == 0 && value != sorted.front()) || (p + 1 == percentiles.size() && value != sorted.back()))
+        {
+          std::cout << "Label " << it.first << " band " << band << ": percentile " << percentiles[p] << " is " << value << ", expected in [" << lower << ", "
+                    << upper << "]" << std::endl;
+          result = EXIT_FAILURE;
+        }
+      }
+    }
+
+    std::map<double, unsigned int> counts;
+    for (double value : it.second[2])
+    {
+      counts[value]++;
+    }
+    auto expected = std::max_element(counts.begin(), counts.end(), [](const std::pair<const double, unsigned int>& a,
+                                                                      const std::pair<const double, unsigned int>& b) { return a.second < b.second; });
+    if (majority[it.first][0] != expected->first)
+    {
+      std::cout << "Label " << it.first << ": majority is " << majority[it.first][0] << " instead of " << expected->first << std::endl;
+      result = EXIT_FAILURE;
+    }
+  }
+
+  return result;
+}
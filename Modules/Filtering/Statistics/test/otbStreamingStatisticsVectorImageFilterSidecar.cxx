@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbStreamingStatisticsVectorImageFilter.h"
+#include "otbImageFileReader.h"
+#include "otbVectorImage.h"
+#include "itksys/SystemTools.hxx"
+
+int otbStreamingStatisticsVectorImageFilterSidecar(int itkNotUsed(argc), char* argv[])
+{
+  const char* infname      = argv[1];
+  const char* sidecarfname = argv[2];
+
+  typedef otb::VectorImage<double, 2> ImageType;
+  typedef otb::ImageFileReader<ImageType>                      ReaderType;
+  typedef otb::StreamingStatisticsVectorImageFilter<ImageType> StatisticsFilterType;
+
+  itksys::SystemTools::RemoveFile(sidecarfname);
+  const std::string key = otb::StatisticsSidecarFile::ComputeFileFingerprint(infname);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(infname);
+
+  // First run: computes the statistics and writes the sidecar file
+  StatisticsFilterType::Pointer computed = StatisticsFilterType::New();
+  computed->GetStreamer()->SetNumberOfLinesStrippedStreaming(10);
+  computed->SetInput(reader->GetOutput());
+  computed->SetStatisticsFileName(sidecarfname);
+  computed->SetStatisticsFileKey(key);
+  computed->Update();
+
+  if (computed->GetStatisticsReadFromFile() || !itksys::SystemTools::FileExists(sidecarfname, true))
+  {
+    std::cerr << "First run should compute the statistics and write the sidecar file" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Second run: reads the statistics back, they must be exactly the same
+  StatisticsFilterType::Pointer read = StatisticsFilterType::New();
+  read->GetStreamer()->SetNumberOfLinesStrippedStreaming(7);
+  read->SetInput(reader->GetOutput());
+  read->SetStatisticsFileName(sidecarfname);
+  read->SetStatisticsFileKey(key);
+  read->Update();
+
+  if (!read->GetStatisticsReadFromFile())
+  {
+    std::cerr << "Second run should read the statistics from the sidecar file" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (read->GetMinimum() != computed->GetMinimum() || read->GetMaximum() != computed->GetMaximum() || read->GetSum() != computed->GetSum() ||
+      read->GetMean() != computed->GetMean() || read->GetCovariance() != computed->GetCovariance() ||
+      read->GetCorrelation() != computed->GetCorrelation() || read->GetComponentMean() != computed->GetComponentMean() ||
+      read->GetComponentCovariance() != computed->GetComponentCovariance())
+  {
+    std::cerr << "Statistics read from the sidecar file differ from the computed ones" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Different settings: the sidecar file can not be used
+  StatisticsFilterType::Pointer other = StatisticsFilterType::New();
+  other->SetInput(reader->GetOutput());
+  other->SetStatisticsFileName(sidecarfname);
+  other->SetStatisticsFileKey(key);
+  other->SetEnableSecondOrderStats(false);
+  other->Update();
+
+  if (other->GetStatisticsReadFromFile())
+  {
+    std::cerr << "Sidecar file should not be used with different settings" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Different data: the sidecar file can not be used either
+  StatisticsFilterType::Pointer otherKey = StatisticsFilterType::New();
+  otherKey->SetInput(reader->GetOutput());
+  otherKey->SetStatisticsFileName(sidecarfname);
+  otherKey->SetStatisticsFileKey(key + " modified");
+  otherKey->SetEnableSecondOrderStats(false);
+  otherKey->Update();
+
+  if (otherKey->GetStatisticsReadFromFile())
+  {
+    std::cerr << "Sidecar file should not be used with a different key" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -36,6 +36,7 @@ namespace otb
  * - &writegeom=ON : to activate the creation of an external geom file
  * - &gdal:co:<KEY>=<VALUE> : the gdal creation option <KEY>
  * - streaming modes
+ * - &streaming:async=<(bool)false> : to overlap block computation and block writing
  * - box
  * - &bands=<BANDS_LIST> : to select a subset of bands from the output image
  * - &nodata=<VALUE>/<VALUE:VALUE...> : to set specific nodata values
@@ -80,6 +81,7 @@ public:
     std::pair<bool, std::string> streamingType;
     std::pair<bool, std::string> streamingSizeMode;
     std::pair<bool, double>      streamingSizeValue;
+    std::pair<bool, bool>        streamingAsync;
     std::pair<bool, std::string> box;
     std::pair<bool, std::string> bandRange;
     std::pair<bool, unsigned int> srsValue;
@@ -117,6 +119,8 @@ public:
   std::string GetStreamingSizeMode() const;
   bool        StreamingSizeValueIsSet() const;
   double      GetStreamingSizeValue() const;
+  bool        StreamingAsyncIsSet() const;
+  bool        GetStreamingAsync() const;
   std::string GetBandRange() const;
   bool        SrsValueIsSet() const;
   unsigned int GetSrsValue() const;
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbGDALDatasetPool_h
+#define otbGDALDatasetPool_h
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "otbGDALDatasetWrapper.h"
+#include "OTBIOGDALExport.h"
+
+namespace otb
+{
+
+/** \class GDALDatasetPool
+ *
+ * \brief Process-wide pool bounding the number of idle open GDAL datasets
+ *
+ * By default, each GDALImageIO keeps its dataset (and thus a file
+ * descriptor) open from CanReadFile() until its destruction. Pipelines with
+ * thousands of input images, like large mosaics, then hit the limit of open
+ * files of the process.
+ *
+ * When the maximum number of datasets of the pool is not 0, GDALImageIO
+ * gives its dataset back to the pool once it has read the image information
+ * or a region, and acquires it again before the next access. The pool keeps
+ * the least recently released datasets open, up to the maximum number, and
+ * closes the others. A closed dataset is opened again by Acquire() when its
+ * owner needs it, so that only the images actually read keep a file open.
+ *
+ * Datasets are identified by their owner and name: they are never shared
+ * between owners, as before. The maximum number is 0 unless the
+ * OTB_GDAL_MAX_OPEN_DATASETS environment variable gives a number.
+ *
+ * This class is thread safe.
+ *
+ * \ingroup OTBIOGDAL
+ */
+class OTBIOGDAL_EXPORT GDALDatasetPool
+{
+public:
+  static GDALDatasetPool& GetInstance();
+
+  /** Maximum number of idle datasets kept open. Reducing it closes
+   *  datasets immediately, 0 disables the pool. */
+  void SetMaximumNumberOfDatasets(unsigned int number);
+  unsigned int GetMaximumNumberOfDatasets() const;
+
+  /** Number of idle datasets currently open in the pool */
+  unsigned int GetNumberOfDatasets() const;
+
+  /** Take the dataset of an owner out of the pool, or open it again if it
+   *  was closed. Returns a null pointer if the dataset can not be opened. */
+  GDALDatasetWrapper::Pointer Acquire(const void* owner, const std::string& name);
+
+  /** Give back an acquired dataset */
+  void Release(const void* owner, const std::string& name, const GDALDatasetWrapper::Pointer& dataset);
+
+  /** Close the datasets of an owner, for instance when it is destroyed */
+  void Remove(const void* owner);
+
+  /** Close all the idle datasets */
+  void Clear();
+
+  /** Number of datasets opened again by Acquire() */
+  unsigned long GetNumberOfReopenings() const;
+
+private:
+  GDALDatasetPool();
+  ~GDALDatasetPool() = default;
+  GDALDatasetPool(const GDALDatasetPool&) = delete;
+  void operator=(const GDALDatasetPool&) = delete;
+
+  typedef std::pair<const void*, std::string> KeyType;
+  typedef std::list<KeyType>                  LRUListType;
+
+  struct EntryType
+  {
+    GDALDatasetWrapper::Pointer dataset;
+    LRUListType::iterator       position;
+  };
+
+  typedef std::map<KeyType, EntryType> MapType;
+
+  /** Close the least recently released datasets until the number fits
+   *  (lock must be held). The datasets are moved to closed, so that they
+   *  are actually closed after the lock is released. */
+  void Shrink(std::list<GDALDatasetWrapper::Pointer>& closed);
+
+  mutable std::mutex m_Mutex;
+  MapType            m_Datasets;
+  LRUListType        m_LRU; // most recently released first
+  unsigned int       m_MaximumNumberOfDatasets;
+  unsigned long      m_Reopenings;
+};
+
+} // end namespace otb
+
+#endif
@@ -31,6 +31,7 @@
 
 #include "OTBIOGDALExport.h"
 #include "otbSpatialReference.h"
+#include "otbGDALTileCache.h"
 
 namespace otb
 {
@@ -247,11 +248,49 @@ private:
    */
   bool CreationOptionContains(std::string partialOption) const;
 
+  /** Whether Read() can go through the GDALTileCache */
+  bool CanUseTileCache() const;
+
+  /** Read the region through the GDALTileCache. The arguments are the
+   *  region and the buffer layout given to RasterIO() by Read() */
+  void ReadWithTileCache(unsigned char* buffer, int firstColumn, int firstLine, int nbColumns, int nbLines, int pixelOffset, int lineOffset,
+                         int bandOffset);
+
+  /** Get the dataset back from the GDALDatasetPool if it was released */
+  void AcquireDataset();
+
+  /** Give the dataset to the GDALDatasetPool when the pool is enabled and
+   *  no DatasetScope uses it anymore */
+  void ReleaseDataset();
+
+  /** Keep the dataset acquired during a read access */
+  class DatasetScope
+  {
+  public:
+    explicit DatasetScope(GDALImageIO* io) : m_IO(io)
+    {
+      m_IO->AcquireDataset();
+    }
+    ~DatasetScope()
+    {
+      m_IO->ReleaseDataset();
+    }
+
+  private:
+    GDALImageIO* m_IO;
+  };
+
   /** GDAL parameters. */
   typedef itk::SmartPointer<GDALDatasetWrapper> GDALDatasetWrapperPointer;
   GDALDatasetWrapperPointer                     m_Dataset;
   unsigned int                                  m_epsgCode;
 
+  /** Name the read dataset was opened with (empty when writing) */
+  std::string m_DatasetName;
+
+  /** Number of DatasetScope using the dataset */
+  unsigned int m_DatasetUsers;
+
   GDALDataTypeWrapper* m_PxType;
   /** Number of bytes per pixel */
   int m_BytePerPixel;
@@ -290,6 +329,11 @@ private:
    */
   std::vector<unsigned int> m_OriginalDimensions;
 
+  /**
+   * Version of the file holding the dataset, identifies its tiles in the cache
+   */
+  GDALTileCache::FileStampType m_DatasetFileStamp;
+
   /**
    * True if RPC tags should be exported
    */
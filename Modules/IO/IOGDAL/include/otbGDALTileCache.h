@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbGDALTileCache_h
+#define otbGDALTileCache_h
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "OTBIOGDALExport.h"
+
+namespace otb
+{
+
+/** \class GDALTileCache
+ *
+ * \brief Process-wide cache of decoded image tiles read with GDAL
+ *
+ * GDALImageIO reads images by fixed size tiles of TileSize x TileSize
+ * pixels, and keeps the decoded data of each band in this cache. Overlapping
+ * requests (padded regions of neighborhood filters, several readers on the
+ * same file, ...) are then served from memory instead of calling
+ * GDALDataset::RasterIO() again.
+ *
+ * Tiles are identified by the file holding the dataset, the dataset name,
+ * the resolution factor, the band and the tile position. The file is known
+ * by its normalized name, so that readers and writers using different names
+ * for it (relative paths, symbolic links, ...) agree, and by its size and
+ * modification time, so that the tiles of a previous version of the file
+ * are not used. The memory used by the
+ * cache is bounded, the least recently used tiles are dropped first. The
+ * cache is disabled when its maximum size is 0, which is the default unless
+ * the OTB_GDAL_TILE_CACHE_SIZE environment variable gives a size in MB.
+ *
+ * This class is thread safe.
+ *
+ * \ingroup OTBIOGDAL
+ */
+class OTBIOGDAL_EXPORT GDALTileCache
+{
+public:
+  /** Side of the cached tiles, in pixels */
+  static const unsigned int TileSize = 256;
+
+  /** Identifier of a version of a file */
+  struct FileStampType
+  {
+    std::string   fileName;
+    unsigned long length;
+    long          modifiedTime;
+
+    bool operator<(const FileStampType& other) const;
+  };
+
+  /** Identifier of a tile of a band */
+  struct KeyType
+  {
+    FileStampType file;
+    std::string   dataset;
+    unsigned int  resolution;
+    int           band;
+    unsigned int  tileX;
+    unsigned int  tileY;
+
+    bool operator<(const KeyType& other) const;
+  };
+
+  /** Decoded data of a tile, shared with the readers using it */
+  typedef std::shared_ptr<const std::vector<char>> TileDataPointer;
+
+  static GDALTileCache& GetInstance();
+
+  /** Normalized name of a file: its real path if it exists, the name itself
+   *  otherwise (virtual file systems, ...) */
+  static std::string NormalizeFileName(const std::string& fileName);
+
+  /** Normalized name, length and modification time of a file */
+  static FileStampType GetFileStamp(const std::string& fileName);
+
+  /** Maximum memory used by the cache, in bytes. Reducing it drops tiles
+   *  immediately, 0 disables the cache. */
+  void SetMaximumSize(std::size_t size);
+  std::size_t GetMaximumSize() const;
+
+  /** Memory currently used by the cached tiles, in bytes */
+  std::size_t GetCurrentSize() const;
+
+  /** Return the cached tile, or a null pointer if it is not in the cache */
+  TileDataPointer Find(const KeyType& key);
+
+  /** Add a tile to the cache */
+  void Insert(const KeyType& key, const TileDataPointer& data);
+
+  /** Remove all the tiles read from a file, for instance when it is
+   *  written. Any name of the file can be given, it is normalized. */
+  void Invalidate(const std::string& fileName);
+
+  /** Remove all the tiles */
+  void Clear();
+
+  /** Statistics of the Find() calls */
+  unsigned long GetNumberOfHits() const;
+  unsigned long GetNumberOfMisses() const;
+  void ResetStatistics();
+
+private:
+  GDALTileCache();
+  ~GDALTileCache() = default;
+  GDALTileCache(const GDALTileCache&) = delete;
+  void operator=(const GDALTileCache&) = delete;
+
+  /** Drop the least recently used tiles until the size fits (lock must be
+   *  held) */
+  void Shrink();
+
+  typedef std::list<KeyType> LRUListType;
+
+  struct EntryType
+  {
+    TileDataPointer       data;
+    LRUListType::iterator position;
+  };
+
+  typedef std::map<KeyType, EntryType> MapType;
+
+  mutable std::mutex m_Mutex;
+  MapType            m_Tiles;
+  LRUListType        m_LRU; // most recently used first
+  std::size_t        m_MaximumSize;
+  std::size_t        m_CurrentSize;
+  unsigned long      m_Hits;
+  unsigned long      m_Misses;
+};
+
+} // end namespace otb
+
+#endif
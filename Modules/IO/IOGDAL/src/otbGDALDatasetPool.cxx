@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbGDALDatasetPool.h"
+#include "otbGDALDriverManagerWrapper.h"
+#include "itksys/SystemTools.hxx"
+
+namespace otb
+{
+
+GDALDatasetPool& GDALDatasetPool::GetInstance()
+{
+  // Constructed on first use, to avoid static initialization order problems
+  static GDALDatasetPool theUniqueInstance;
+  return theUniqueInstance;
+}
+
+GDALDatasetPool::GDALDatasetPool() : m_MaximumNumberOfDatasets(0), m_Reopenings(0)
+{
+  std::string number;
+  if (itksys::SystemTools::GetEnv("OTB_GDAL_MAX_OPEN_DATASETS", number))
+  {
+    try
+    {
+      m_MaximumNumberOfDatasets = static_cast<unsigned int>(std::stoul(number));
+    }
+    catch (std::exception&)
+    {
+      m_MaximumNumberOfDatasets = 0;
+    }
+  }
+}
+
+void GDALDatasetPool::SetMaximumNumberOfDatasets(unsigned int number)
+{
+  std::list<GDALDatasetWrapper::Pointer> closed;
+  std::lock_guard<std::mutex>            lock(m_Mutex);
+  m_MaximumNumberOfDatasets = number;
+  Shrink(closed);
+}
+
+unsigned int GDALDatasetPool::GetMaximumNumberOfDatasets() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_MaximumNumberOfDatasets;
+}
+
+unsigned int GDALDatasetPool::GetNumberOfDatasets() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Datasets.size();
+}
+
+GDALDatasetWrapper::Pointer GDALDatasetPool::Acquire(const void* owner, const std::string& name)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    MapType::iterator           it = m_Datasets.find(KeyType(owner, name));
+    if (it != m_Datasets.end())
+    {
+      GDALDatasetWrapper::Pointer dataset = it->second.dataset;
+      m_LRU.erase(it->second.position);
+      m_Datasets.erase(it);
+      return dataset;
+    }
+    ++m_Reopenings;
+  }
+
+  // Open outside of the lock, this can be slow
+  return GDALDriverManagerWrapper::GetInstance().Open(name);
+}
+
+void GDALDatasetPool::Release(const void* owner, const std::string& name, const GDALDatasetWrapper::Pointer& dataset)
+{
+  std::list<GDALDatasetWrapper::Pointer> closed;
+  std::lock_guard<std::mutex>            lock(m_Mutex);
+
+  KeyType           key(owner, name);
+  MapType::iterator it = m_Datasets.find(key);
+  if (it != m_Datasets.end())
+  {
+    closed.push_back(it->second.dataset);
+    m_LRU.erase(it->second.position);
+    m_Datasets.erase(it);
+  }
+
+  m_LRU.push_front(key);
+  EntryType entry;
+  entry.dataset  = dataset;
+  entry.position = m_LRU.begin();
+  m_Datasets.insert(std::make_pair(key, entry));
+
+  Shrink(closed);
+}
+
+void GDALDatasetPool::Remove(const void* owner)
+{
+  std::list<GDALDatasetWrapper::Pointer> closed;
+  std::lock_guard<std::mutex>            lock(m_Mutex);
+
+  MapType::iterator it = m_Datasets.lower_bound(KeyType(owner, std::string()));
+  while (it != m_Datasets.end() && it->first.first == owner)
+  {
+    closed.push_back(it->second.dataset);
+    m_LRU.erase(it->second.position);
+    it = m_Datasets.erase(it);
+  }
+}
+
+void GDALDatasetPool::Clear()
+{
+  MapType                     datasets;
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  datasets.swap(m_Datasets);
+  m_LRU.clear();
+}
+
+unsigned long GDALDatasetPool::GetNumberOfReopenings() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Reopenings;
+}
+
+void GDALDatasetPool::Shrink(std::list<GDALDatasetWrapper::Pointer>& closed)
+{
+  while (m_Datasets.size() > m_MaximumNumberOfDatasets)
+  {
+    MapType::iterator it = m_Datasets.find(m_LRU.back());
+    closed.push_back(it->second.dataset);
+    m_Datasets.erase(it);
+    m_LRU.pop_back();
+  }
+}
+
+} // end namespace otb
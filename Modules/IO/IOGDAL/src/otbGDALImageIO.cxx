@@ -22,6 +22,8 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
+#include <cstring>
 
 #include "otbGDALImageIO.h"
 #include "otbMacro.h"
@@ -43,6 +45,8 @@
 #include "ogr_srs_api.h"
 
 #include "otbGDALDriverManagerWrapper.h"
+#include "otbGDALDatasetPool.h"
+#include "otbGDALTileCache.h"
 
 #include "otb_boost_string_header.h"
 
@@ -118,10 +122,12 @@ GDALImageIO::GDALImageIO()
   m_WriteRPCTags      = false;
 
   m_epsgCode          = 0;
+  m_DatasetUsers      = 0;
 }
 
 GDALImageIO::~GDALImageIO()
 {
+  GDALDatasetPool::GetInstance().Remove(this);
   delete m_PxType;
 }
 
@@ -133,10 +139,36 @@ bool GDALImageIO::CanReadFile(const char* file)
   {
     return false;
   }
-  m_Dataset = GDALDriverManagerWrapper::GetInstance().Open(file);
+  GDALDatasetPool::GetInstance().Remove(this);
+  m_DatasetName = file;
+  m_Dataset     = GDALDriverManagerWrapper::GetInstance().Open(file);
   return m_Dataset.IsNotNull();
 }
 
+void GDALImageIO::AcquireDataset()
+{
+  ++m_DatasetUsers;
+  if (m_Dataset.IsNull() && !m_DatasetName.empty())
+  {
+    m_Dataset = GDALDatasetPool::GetInstance().Acquire(this, m_DatasetName);
+    if (m_Dataset.IsNull())
+    {
+      --m_DatasetUsers;
+      itkExceptionMacro(<< "Unable to open again the dataset " << m_DatasetName << " : " << CPLGetLastErrorMsg());
+    }
+  }
+}
+
+void GDALImageIO::ReleaseDataset()
+{
+  --m_DatasetUsers;
+  if (m_DatasetUsers == 0 && m_Dataset.IsNotNull() && !m_DatasetName.empty() && GDALDatasetPool::GetInstance().GetMaximumNumberOfDatasets() > 0)
+  {
+    GDALDatasetPool::GetInstance().Release(this, m_DatasetName, m_Dataset);
+    m_Dataset = nullptr;
+  }
+}
+
 // Used to print information about this object
 void GDALImageIO::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
@@ -164,6 +196,8 @@ void GDALImageIO::Read(void* buffer)
     return;
   }
 
+  DatasetScope datasetScope(this);
+
   // Get the origin of the region to read
   int lFirstLineRegion   = this->GetIORegion().GetIndex()[1];
   int lFirstColumnRegion = this->GetIORegion().GetIndex()[0];
@@ -245,6 +279,12 @@ void GDALImageIO::Read(void* buffer)
       bandOffset  = m_BytePerPixel;
     }
 
+    if (this->CanUseTileCache())
+    {
+      this->ReadWithTileCache(p, lFirstColumnRegion, lFirstLineRegion, lNbColumnsRegion, lNbLinesRegion, pixelOffset, lineOffset, bandOffset);
+      return;
+    }
+
     // keep it for the moment
     otbLogMacro(Debug, << "GDAL reads [" << lFirstColumn << ", " << lFirstColumnRegion + lNbColumnsRegion - 1 << "]x[" << lFirstLineRegion << ", "
                        << lFirstLineRegion + lNbLinesRegion - 1 << "] x " << nbBands << " bands of type " << GDALGetDataTypeName(m_PxType->pixType)
@@ -267,10 +307,131 @@ void GDALImageIO::Read(void* buffer)
   }
 }
 
+bool GDALImageIO::CanUseTileCache() const
+{
+  if (GDALTileCache::GetInstance().GetMaximumSize() == 0 || m_IsIndexed)
+  {
+    return false;
+  }
+  // Memory datasets point to buffers which may change
+  const GDALDriver* driver = m_Dataset->GetDataSet()->GetDriver();
+  if (driver == nullptr || strcmp(driver->GetDescription(), "MEM") == 0)
+  {
+    return false;
+  }
+  // With a resolution factor, a tile must be decimated exactly as the
+  // direct read of any region including it, which only holds when no
+  // clamping is needed at the image borders
+  const unsigned int factor = 1 << m_ResolutionFactor;
+  return m_OriginalDimensions[0] == m_Dimensions[0] * factor && m_OriginalDimensions[1] == m_Dimensions[1] * factor;
+}
+
+void GDALImageIO::ReadWithTileCache(unsigned char* buffer, int firstColumn, int firstLine, int nbColumns, int nbLines, int pixelOffset, int lineOffset,
+                                    int bandOffset)
+{
+  GDALTileCache&     cache    = GDALTileCache::GetInstance();
+  GDALDataset*       dataset  = m_Dataset->GetDataSet();
+  const int          tileSize = GDALTileCache::TileSize;
+  const int          factor   = 1 << m_ResolutionFactor;
+  const std::size_t  dataSize = GDALGetDataTypeSize(m_PxType->pixType) / 8;
+  const unsigned int nbBands  = m_NbBands;
+
+  GDALTileCache::KeyType key;
+  key.file       = m_DatasetFileStamp;
+  key.dataset    = dataset->GetDescription();
+  key.resolution = m_ResolutionFactor;
+
+  std::vector<GDALTileCache::TileDataPointer> tiles(nbBands);
+  unsigned int                                nbRead = 0;
+
+  const int firstTileX = firstColumn / tileSize;
+  const int lastTileX  = (firstColumn + nbColumns - 1) / tileSize;
+  const int firstTileY = firstLine / tileSize;
+  const int lastTileY  = (firstLine + nbLines - 1) / tileSize;
+
+  otb::Stopwatch chrono = otb::Stopwatch::StartNew();
+  for (int tileY = firstTileY; tileY <= lastTileY; ++tileY)
+  {
+    for (int tileX = firstTileX; tileX <= lastTileX; ++tileX)
+    {
+      const int x0 = tileX * tileSize;
+      const int y0 = tileY * tileSize;
+      const int w  = std::min(tileSize, static_cast<int>(m_Dimensions[0]) - x0);
+      const int h  = std::min(tileSize, static_cast<int>(m_Dimensions[1]) - y0);
+
+      key.tileX = tileX;
+      key.tileY = tileY;
+
+      bool complete = true;
+      for (unsigned int band = 0; band < nbBands; ++band)
+      {
+        key.band    = band;
+        tiles[band] = cache.Find(key);
+        complete    = complete && tiles[band];
+      }
+
+      if (!complete)
+      {
+        // Decode all the bands of the tile at once
+        const std::size_t bandSize = dataSize * w * h;
+        std::vector<char> tile(bandSize * nbBands);
+        CPLErr lCrGdal = dataset->RasterIO(GF_Read, x0 * factor, y0 * factor, w * factor, h * factor, &tile[0], w, h, m_PxType->pixType, nbBands, nullptr,
+                                           dataSize, dataSize * w, bandSize);
+        if (lCrGdal == CE_Failure)
+        {
+          itkExceptionMacro(<< "Error while reading image (GDAL format) '" << m_FileName << "' : " << CPLGetLastErrorMsg());
+        }
+        ++nbRead;
+
+        for (unsigned int band = 0; band < nbBands; ++band)
+        {
+          key.band    = band;
+          tiles[band] = std::make_shared<const std::vector<char>>(tile.begin() + band * bandSize, tile.begin() + (band + 1) * bandSize);
+          cache.Insert(key, tiles[band]);
+        }
+      }
+
+      // Copy the part of the tile inside the requested region
+      const int startX = std::max(x0, firstColumn);
+      const int endX   = std::min(x0 + w, firstColumn + nbColumns);
+      const int startY = std::max(y0, firstLine);
+      const int endY   = std::min(y0 + h, firstLine + nbLines);
+
+      for (unsigned int band = 0; band < nbBands; ++band)
+      {
+        const char* bandData = tiles[band]->data();
+        for (int y = startY; y < endY; ++y)
+        {
+          const char*    src = bandData + (static_cast<std::size_t>(y - y0) * w + (startX - x0)) * dataSize;
+          unsigned char* dst = buffer + band * static_cast<std::ptrdiff_t>(bandOffset) + (y - firstLine) * static_cast<std::ptrdiff_t>(lineOffset) +
+                               (startX - firstColumn) * static_cast<std::ptrdiff_t>(pixelOffset);
+          if (pixelOffset == static_cast<int>(dataSize))
+          {
+            memcpy(dst, src, (endX - startX) * dataSize);
+          }
+          else
+          {
+            for (int x = startX; x < endX; ++x, src += dataSize, dst += pixelOffset)
+            {
+              memcpy(dst, src, dataSize);
+            }
+          }
+        }
+      }
+    }
+  }
+  chrono.Stop();
+
+  otbLogMacro(Debug, << "GDAL reads [" << firstColumn << ", " << firstColumn + nbColumns - 1 << "]x[" << firstLine << ", " << firstLine + nbLines - 1
+                     << "] x " << nbBands << " bands of type " << GDALGetDataTypeName(m_PxType->pixType) << " from file " << m_FileName << " through the tile cache ("
+                     << nbRead << " tiles decoded) in " << chrono.GetElapsedMilliseconds() << " ms");
+}
+
 bool GDALImageIO::GetSubDatasetInfo(std::vector<std::string>& names, std::vector<std::string>& desc)
 {
   // Note: we assume that the subdatasets are in order : SUBDATASET_ID_NAME, SUBDATASET_ID_DESC, SUBDATASET_ID+1_NAME, SUBDATASET_ID+1_DESC
-  char** papszMetadata;
+  DatasetScope datasetScope(this);
+  char**       papszMetadata;
   papszMetadata = m_Dataset->GetDataSet()->GetMetadata("SUBDATASETS");
 
   // Have we find some dataSet ?
@@ -317,11 +478,13 @@ bool GDALImageIO::GDALPixelTypeIsComplex()
 void GDALImageIO::ReadImageInformation()
 {
   // std::ifstream file;
+  DatasetScope datasetScope(this);
   this->InternalReadImageInformation();
 }
 
 unsigned int GDALImageIO::GetOverviewsCount()
 {
+  DatasetScope datasetScope(this);
   GDALDataset* dataset = m_Dataset->GetDataSet();
 
   // JPEG2000 case : use the number of overviews actually in the dataset
@@ -356,6 +519,7 @@ unsigned int GDALImageIO::GetOverviewsCount()
 std::vector<std::string> GDALImageIO::GetOverviewsInfo()
 {
   std::vector<std::string> desc;
+  DatasetScope             datasetScope(this);
 
   // This should never happen, according to implementation of GetOverviewCount()
   if (this->GetOverviewsCount() == 0)
@@ -447,7 +611,8 @@ void GDALImageIO::InternalReadImageInformation()
     }
     if (m_DatasetNumber < names.size())
     {
-      m_Dataset = GDALDriverManagerWrapper::GetInstance().Open(names[m_DatasetNumber]);
+      m_DatasetName = names[m_DatasetNumber];
+      m_Dataset     = GDALDriverManagerWrapper::GetInstance().Open(m_DatasetName);
     }
     else
     {
@@ -471,6 +636,15 @@ void GDALImageIO::InternalReadImageInformation()
   m_OriginalDimensions.push_back(dataset->GetRasterXSize());
   m_OriginalDimensions.push_back(dataset->GetRasterYSize());
 
+  // Cached tiles of a previous version of the file must not be used. The
+  // description of the dataset may carry a driver prefix or a subdataset
+  // name, the stamp is computed on the main file of the dataset, which is
+  // also the name given to GDALTileCache::Invalidate() when it is written.
+  char**            fileList = dataset->GetFileList();
+  const std::string mainFile = (fileList != nullptr && fileList[0] != nullptr) ? fileList[0] : dataset->GetDescription();
+  CSLDestroy(fileList);
+  m_DatasetFileStamp = GDALTileCache::GetFileStamp(mainFile);
+
   // Get Number of Bands
   m_NbBands = dataset->GetRasterCount();
 
@@ -1248,6 +1422,9 @@ void GDALImageIO::Write(const void* buffer)
     // Last pixel written
     // Reinitialize to close the file
     m_Dataset = GDALDatasetWrapperPointer();
+
+    // Tiles read before or while writing are outdated
+    GDALTileCache::GetInstance().Invalidate(GetGdalWriteImageFileName(FilenameToGdalDriverShortName(m_FileName), m_FileName));
   }
 }
 
@@ -1372,8 +1549,14 @@ void GDALImageIO::InternalWriteImageInformation(const void* buffer)
     itkExceptionMacro(<< "GDAL Writing failed: the image file name '" << m_FileName << "' is not recognized by GDAL.");
   }
 
+  // Datasets opened for writing are never released to the GDALDatasetPool
+  GDALDatasetPool::GetInstance().Remove(this);
+  m_DatasetName.clear();
+
   if (m_CanStreamWrite)
   {
+    GDALTileCache::GetInstance().Invalidate(GetGdalWriteImageFileName(driverShortName, m_FileName));
+
     GDALCreationOptionsType creationOptions = m_CreationOptions;
     m_Dataset =
         GDALDriverManagerWrapper::GetInstance().Create(driverShortName, GetGdalWriteImageFileName(driverShortName, m_FileName), m_Dimensions[0],
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbGDALTileCache.h"
+#include "itksys/SystemTools.hxx"
+
+#include <tuple>
+
+namespace otb
+{
+
+const unsigned int GDALTileCache::TileSize;
+
+bool GDALTileCache::FileStampType::operator<(const FileStampType& other) const
+{
+  return std::tie(fileName, length, modifiedTime) < std::tie(other.fileName, other.length, other.modifiedTime);
+}
+
+bool GDALTileCache::KeyType::operator<(const KeyType& other) const
+{
+  return std::tie(file, dataset, resolution, band, tileY, tileX) < std::tie(other.file, other.dataset, other.resolution, other.band, other.tileY, other.tileX);
+}
+
+GDALTileCache& GDALTileCache::GetInstance()
+{
+  // Constructed on first use, to avoid static initialization order problems
+  static GDALTileCache theUniqueInstance;
+  return theUniqueInstance;
+}
+
+std::string GDALTileCache::NormalizeFileName(const std::string& fileName)
+{
+  if (itksys::SystemTools::FileExists(fileName, true))
+  {
+    return itksys::SystemTools::GetRealPath(fileName);
+  }
+  return fileName;
+}
+
+GDALTileCache::FileStampType GDALTileCache::GetFileStamp(const std::string& fileName)
+{
+  FileStampType stamp;
+  stamp.fileName     = NormalizeFileName(fileName);
+  stamp.length       = itksys::SystemTools::FileLength(fileName);
+  stamp.modifiedTime = itksys::SystemTools::ModifiedTime(fileName);
+  return stamp;
+}
+
+GDALTileCache::GDALTileCache() : m_MaximumSize(0), m_CurrentSize(0), m_Hits(0), m_Misses(0)
+{
+  std::string size;
+  if (itksys::SystemTools::GetEnv("OTB_GDAL_TILE_CACHE_SIZE", size))
+  {
+    try
+    {
+      m_MaximumSize = static_cast<std::size_t>(std::stoul(size)) * 1024 * 1024;
+    }
+    catch (std::exception&)
+    {
+      m_MaximumSize = 0;
+    }
+  }
+}
+
+void GDALTileCache::SetMaximumSize(std::size_t size)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_MaximumSize = size;
+  Shrink();
+}
+
+std::size_t GDALTileCache::GetMaximumSize() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_MaximumSize;
+}
+
+std::size_t GDALTileCache::GetCurrentSize() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_CurrentSize;
+}
+
+GDALTileCache::TileDataPointer GDALTileCache::Find(const KeyType& key)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  MapType::iterator           it = m_Tiles.find(key);
+  if (it == m_Tiles.end())
+  {
+    ++m_Misses;
+    return TileDataPointer();
+  }
+  ++m_Hits;
+  m_LRU.splice(m_LRU.begin(), m_LRU, it->second.position);
+  return it->second.data;
+}
+
+void GDALTileCache::Insert(const KeyType& key, const TileDataPointer& data)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (!data || data->size() > m_MaximumSize)
+  {
+    return;
+  }
+
+  MapType::iterator it = m_Tiles.find(key);
+  if (it != m_Tiles.end())
+  {
+    // Another reader decoded the same tile meanwhile
+    m_CurrentSize -= it->second.data->size();
+    it->second.data = data;
+    m_LRU.splice(m_LRU.begin(), m_LRU, it->second.position);
+  }
+  else
+  {
+    m_LRU.push_front(key);
+    EntryType entry;
+    entry.data     = data;
+    entry.position = m_LRU.begin();
+    m_Tiles.insert(std::make_pair(key, entry));
+  }
+  m_CurrentSize += data->size();
+  Shrink();
+}
+
+void GDALTileCache::Invalidate(const std::string& fileName)
+{
+  const std::string normalizedName = NormalizeFileName(fileName);
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  for (MapType::iterator it = m_Tiles.begin(); it != m_Tiles.end();)
+  {
+    if (it->first.file.fileName == normalizedName)
+    {
+      m_CurrentSize -= it->second.data->size();
+      m_LRU.erase(it->second.position);
+      it = m_Tiles.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void GDALTileCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Tiles.clear();
+  m_LRU.clear();
+  m_CurrentSize = 0;
+}
+
+unsigned long GDALTileCache::GetNumberOfHits() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Hits;
+}
+
+unsigned long GDALTileCache::GetNumberOfMisses() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Misses;
+}
+
+void GDALTileCache::ResetStatistics()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Hits   = 0;
+  m_Misses = 0;
+}
+
+void GDALTileCache::Shrink()
+{
+  while (m_CurrentSize > m_MaximumSize && !m_LRU.empty())
+  {
+    MapType::iterator it = m_Tiles.find(m_LRU.back());
+    m_CurrentSize -= it->second.data->size();
+    m_Tiles.erase(it);
+    m_LRU.pop_back();
+  }
+}
+
+} // end namespace otb
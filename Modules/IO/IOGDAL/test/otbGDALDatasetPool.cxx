@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbGDALImageIO.h"
+#include "otbGDALDatasetPool.h"
+#include "itkMacro.h"
+#include <iostream>
+#include <vector>
+
+namespace
+{
+std::vector<char> ReadRegion(otb::GDALImageIO* io, int x, int y, int sizeX, int sizeY)
+{
+  itk::ImageIORegion region(2);
+  region.SetIndex(0, x);
+  region.SetIndex(1, y);
+  region.SetSize(0, sizeX);
+  region.SetSize(1, sizeY);
+  io->SetIORegion(region);
+
+  std::vector<char> buffer(static_cast<std::size_t>(sizeX) * sizeY * io->GetNumberOfComponents() * io->GetComponentSize());
+  io->Read(&buffer[0]);
+  return buffer;
+}
+}
+
+int otbGDALDatasetPool(int itkNotUsed(argc), char* argv[])
+{
+  const char*           filename      = argv[1];
+  otb::GDALDatasetPool& pool          = otb::GDALDatasetPool::GetInstance();
+  const unsigned int    initialNumber = pool.GetMaximumNumberOfDatasets();
+
+  // Reference read, datasets stay open in their ImageIO
+  pool.SetMaximumNumberOfDatasets(0);
+  otb::GDALImageIO::Pointer reference = otb::GDALImageIO::New();
+  if (!reference->CanReadFile(filename))
+  {
+    std::cerr << "Can not read " << filename << std::endl;
+    return EXIT_FAILURE;
+  }
+  reference->ReadImageInformation();
+  const std::vector<char> expected = ReadRegion(reference, 10, 20, 30, 40);
+
+  // Several readers sharing a pool of one dataset
+  pool.SetMaximumNumberOfDatasets(1);
+  const unsigned long                    initialReopenings = pool.GetNumberOfReopenings();
+  std::vector<otb::GDALImageIO::Pointer> readers;
+  for (unsigned int i = 0; i < 5; ++i)
+  {
+    otb::GDALImageIO::Pointer io = otb::GDALImageIO::New();
+    io->CanReadFile(filename);
+    io->ReadImageInformation();
+    readers.push_back(io);
+  }
+
+  int status = EXIT_SUCCESS;
+  if (pool.GetNumberOfDatasets() > 1)
+  {
+    std::cerr << pool.GetNumberOfDatasets() << " datasets are open, the maximum is 1" << std::endl;
+    status = EXIT_FAILURE;
+  }
+
+  for (unsigned int pass = 0; pass < 2; ++pass)
+  {
+    for (unsigned int i = 0; i < readers.size(); ++i)
+    {
+      if (ReadRegion(readers[i], 10, 20, 30, 40) != expected)
+      {
+        std::cerr << "Reader " << i << " read different data after its dataset was closed (pass " << pass << ")" << std::endl;
+        status = EXIT_FAILURE;
+      }
+    }
+  }
+
+  std::cout << pool.GetNumberOfReopenings() - initialReopenings << " datasets opened again" << std::endl;
+  if (pool.GetNumberOfReopenings() == initialReopenings)
+  {
+    std::cerr << "Datasets were never closed" << std::endl;
+    status = EXIT_FAILURE;
+  }
+
+  // Destroying the readers closes their datasets
+  readers.clear();
+  if (pool.GetNumberOfDatasets() != 0)
+  {
+    std::cerr << "Datasets of destroyed readers are still open" << std::endl;
+    status = EXIT_FAILURE;
+  }
+
+  pool.SetMaximumNumberOfDatasets(initialNumber);
+  return status;
+}
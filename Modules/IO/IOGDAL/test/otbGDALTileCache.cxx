@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbGDALImageIO.h"
+#include "otbGDALTileCache.h"
+#include "itkMacro.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::vector<char> ReadRegion(const char* filename, int x, int y, int sizeX, int sizeY)
+{
+  otb::GDALImageIO::Pointer io = otb::GDALImageIO::New();
+  io->SetFileName(filename);
+  if (!io->CanReadFile(filename))
+  {
+    itkGenericExceptionMacro(<< "Can not read " << filename);
+  }
+  io->ReadImageInformation();
+
+  // Clip the region to the image
+  sizeX = std::min<int>(sizeX, io->GetDimensions(0) - x);
+  sizeY = std::min<int>(sizeY, io->GetDimensions(1) - y);
+
+  itk::ImageIORegion region(2);
+  region.SetIndex(0, x);
+  region.SetIndex(1, y);
+  region.SetSize(0, sizeX);
+  region.SetSize(1, sizeY);
+  io->SetIORegion(region);
+
+  std::vector<char> buffer(static_cast<std::size_t>(sizeX) * sizeY * io->GetNumberOfComponents() * io->GetComponentSize());
+  io->Read(&buffer[0]);
+  return buffer;
+}
+}
+
+int otbGDALTileCache(int itkNotUsed(argc), char* argv[])
+{
+  const char*         filename    = argv[1];
+  otb::GDALTileCache& cache       = otb::GDALTileCache::GetInstance();
+  const std::size_t   initialSize = cache.GetMaximumSize();
+
+  // Overlapping strips, as requested by a neighborhood filter, and regions
+  // crossing the tile boundaries
+  const int regions[][4] = {{0, 0, 1000, 60}, {0, 50, 1000, 60}, {0, 100, 1000, 60}, {17, 250, 300, 20}, {250, 3, 11, 300}, {0, 0, 1, 1}};
+
+  cache.SetMaximumSize(0);
+  std::vector<std::vector<char>> expected;
+  for (const auto& r : regions)
+  {
+    expected.push_back(ReadRegion(filename, r[0], r[1], r[2], r[3]));
+  }
+
+  cache.Clear();
+  cache.ResetStatistics();
+  cache.SetMaximumSize(64 * 1024 * 1024);
+
+  int status = EXIT_SUCCESS;
+  // Second pass simulates another reader of the same file
+  for (unsigned int pass = 0; pass < 2; ++pass)
+  {
+    for (unsigned int i = 0; i < expected.size(); ++i)
+    {
+      if (ReadRegion(filename, regions[i][0], regions[i][1], regions[i][2], regions[i][3]) != expected[i])
+      {
+        std::cerr << "Region " << i << " read through the tile cache differs from the direct read (pass " << pass << ")" << std::endl;
+        status = EXIT_FAILURE;
+      }
+    }
+    std::cout << "Pass " << pass << ": " << cache.GetNumberOfHits() << " hits, " << cache.GetNumberOfMisses() << " misses, " << cache.GetCurrentSize()
+              << " bytes cached" << std::endl;
+  }
+
+  if (cache.GetNumberOfHits() == 0)
+  {
+    std::cerr << "Overlapping reads were not served by the cache" << std::endl;
+    status = EXIT_FAILURE;
+  }
+
+  // Writing the file under another spelling of its name must drop its tiles
+  const std::string filenameStr(filename);
+  const std::size_t slash     = filenameStr.find_last_of('/');
+  const std::string otherName = slash == std::string::npos ? "./" + filenameStr : filenameStr.substr(0, slash) + "/./" + filenameStr.substr(slash + 1);
+  cache.Invalidate(otherName);
+  if (cache.GetCurrentSize() != 0)
+  {
+    std::cerr << "Invalidating " << otherName << " left " << cache.GetCurrentSize() << " bytes cached" << std::endl;
+    status = EXIT_FAILURE;
+  }
+  ReadRegion(filename, regions[0][0], regions[0][1], regions[0][2], regions[0][3]);
+
+  // A small cache must stay within its bounds
+  cache.SetMaximumSize(100 * 1024);
+  if (cache.GetCurrentSize() > 100 * 1024)
+  {
+    std::cerr << "Cache size " << cache.GetCurrentSize() << " exceeds its maximum" << std::endl;
+    status = EXIT_FAILURE;
+  }
+
+  cache.Clear();
+  cache.SetMaximumSize(initialSize);
+  return status;
+}
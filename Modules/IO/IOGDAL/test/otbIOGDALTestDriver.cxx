@@ -33,4 +33,6 @@ void RegisterTests()
   REGISTER_TEST(otbGDALImageIOTestCanRead);
   REGISTER_TEST(otbMultiDatasetReadingInfo);
   REGISTER_TEST(otbOGRVectorDataIOTestCanRead);
+  REGISTER_TEST(otbGDALTileCache);
+  REGISTER_TEST(otbGDALDatasetPool);
 }
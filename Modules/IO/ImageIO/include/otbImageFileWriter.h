@@ -50,6 +50,17 @@ namespace otb
  * ImageFileWriter will write directly the streaming buffer in the image file, so
  * that the output image never needs to be completely allocated
  *
+ * When AsynchronousWriting is On, each computed piece is copied and handed
+ * to a dedicated I/O thread, so that the upstream pipeline can compute the
+ * next piece while the previous one is encoded and flushed by the ImageIO.
+ * The number of pieces waiting to be written is bounded by
+ * MaximumNumberOfPendingBlocks and by the RAM budget of the StreamingManager:
+ * the copies of the pending pieces, of the piece being written and of the
+ * piece being queued fit in half of the budget when possible (at least one
+ * piece may be pending). These copies come on top of the pipeline, which is
+ * still streamed with the whole budget: asynchronous writing may thus use
+ * about 1.5 times the RAM budget.
+ *
  * ImageFileWriter supports extended filenames, which allow controlling
  * some properties of the output file. See
  * http://wiki.orfeo-toolbox.org/index.php/ExtendedFileName for more
@@ -197,6 +208,19 @@ public:
   itkGetConstReferenceMacro(UseInputMetaDataDictionary, bool);
   itkBooleanMacro(UseInputMetaDataDictionary);
 
+  /** Set the asynchronous writing On or Off. When On, pieces are written
+   *  by a dedicated I/O thread while the next piece is being computed */
+  itkSetMacro(AsynchronousWriting, bool);
+  itkGetConstReferenceMacro(AsynchronousWriting, bool);
+  itkBooleanMacro(AsynchronousWriting);
+
+  /** Maximum number of computed pieces waiting for the I/O thread in
+   *  asynchronous mode (default is 2). The actual value is further reduced
+   *  so that the pending pieces, with the piece being written and the piece
+   *  being queued, fit in half of the streaming RAM budget. It is at least 1. */
+  itkSetMacro(MaximumNumberOfPendingBlocks, unsigned int);
+  itkGetConstMacro(MaximumNumberOfPendingBlocks, unsigned int);
+
   itkSetObjectMacro(ImageIO, otb::ImageIOBase);
   itkGetObjectMacro(ImageIO, otb::ImageIOBase);
   itkGetConstObjectMacro(ImageIO, otb::ImageIOBase);
@@ -219,6 +243,27 @@ protected:
   /** Prepare the streaming and write the output information on disk */
   void GenerateOutputInformation(void) override;
 
+  /** Set the pixel type and number of components of the ImageIO from the
+   *  input image, and resolve the band range if any */
+  void ConfigureImageIOPixelType(const InputImageType* input);
+
+  /** Copy a region of the input in a standalone buffer, with enough room
+   *  for the band remapping */
+  InputImagePointer CopyRegionToCacheImage(const InputImageType* input, const InputImageRegionType& region);
+
+  /** Write a buffer matching the current IO region of the ImageIO */
+  void WriteBuffer(const void* dataPtr, itk::SizeValueType numberOfPixels);
+
+  /** Write the geom file if requested */
+  void WriteGeomFileIfRequested();
+
+  /** Streaming loop where the pieces are written by a dedicated I/O
+   *  thread while the next piece is computed */
+  void StreamAndWriteAsynchronously();
+
+  /** Number of pieces allowed in the I/O queue in asynchronous mode */
+  unsigned int ComputeNumberOfPendingBlocks();
+
 private:
   ImageFileWriter(const ImageFileWriter&) = delete;
   void operator=(const ImageFileWriter&) = delete;
@@ -266,6 +311,9 @@ private:
   bool m_WriteGeomFile; // Write a geom file to store the
                         // kwl
 
+  bool         m_AsynchronousWriting;          // overlap compute and I/O
+  unsigned int m_MaximumNumberOfPendingBlocks; // queue depth in async mode
+
   FNameHelperType::Pointer m_FilenameHelper;
 
   StreamingManagerPointerType m_StreamingManager;
@@ -51,6 +51,14 @@
 #include "otbStringUtils.h"
 #include "otbUtils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 namespace otb
 {
 
@@ -68,6 +76,8 @@ ImageFileWriter<TInputImage>::ImageFileWriter()
     m_UseCompression(false),
     m_UseInputMetaDataDictionary(false),
     m_WriteGeomFile(false),
+    m_AsynchronousWriting(false),
+    m_MaximumNumberOfPendingBlocks(2),
     m_FilenameHelper(),
     m_IsObserving(true),
     m_ObserverID(0),
@@ -205,6 +215,9 @@ void ImageFileWriter<TInputImage>::PrintSelf(std::ostream& os, itk::Indent inden
   {
     os << indent << "FactorySpecifiedmageIO: Off\n";
   }
+
+  os << indent << "AsynchronousWriting: " << (m_AsynchronousWriting ? "On" : "Off") << "\n";
+  os << indent << "MaximumNumberOfPendingBlocks: " << m_MaximumNumberOfPendingBlocks << "\n";
 }
 
 //---------------------------------------------------------
@@ -376,6 +389,11 @@ void ImageFileWriter<TInputImage>::GenerateOutputInformation(void)
     }
   }
 
+  if (m_FilenameHelper->StreamingAsyncIsSet())
+  {
+    m_AsynchronousWriting = m_FilenameHelper->GetStreamingAsync();
+  }
+
   /** Prepare ImageIO  : create ImageFactory */
 
   if (m_FileName == "")
@@ -611,28 +629,35 @@ void ImageFileWriter<TInputImage>::Update()
    */
   InputImageRegionType streamRegion;
 
-  for (m_CurrentDivision = 0; m_CurrentDivision < m_NumberOfDivisions && !this->GetAbortGenerateData();
-       m_CurrentDivision++, m_DivisionProgress = 0, this->UpdateFilterProgress())
+  if (m_AsynchronousWriting && m_NumberOfDivisions > 1)
   {
-    streamRegion = m_StreamingManager->GetSplit(m_CurrentDivision);
+    this->StreamAndWriteAsynchronously();
+  }
+  else
+  {
+    for (m_CurrentDivision = 0; m_CurrentDivision < m_NumberOfDivisions && !this->GetAbortGenerateData();
+         m_CurrentDivision++, m_DivisionProgress = 0, this->UpdateFilterProgress())
+    {
+      streamRegion = m_StreamingManager->GetSplit(m_CurrentDivision);
 
-    inputPtr->SetRequestedRegion(streamRegion);
-    inputPtr->PropagateRequestedRegion();
-    inputPtr->UpdateOutputData();
+      inputPtr->SetRequestedRegion(streamRegion);
+      inputPtr->PropagateRequestedRegion();
+      inputPtr->UpdateOutputData();
 
-    // Write the whole image
-    itk::ImageIORegion ioRegion(TInputImage::ImageDimension);
-    for (unsigned int i = 0; i < TInputImage::ImageDimension; ++i)
-    {
-      ioRegion.SetSize(i, streamRegion.GetSize(i));
-      // Set the ioRegion index using the shifted index ( (0,0 without box parameter))
-      ioRegion.SetIndex(i, streamRegion.GetIndex(i) - m_ShiftOutputIndex[i]);
-    }
-    this->SetIORegion(ioRegion);
-    m_ImageIO->SetIORegion(m_IORegion);
+      // Write the whole image
+      itk::ImageIORegion ioRegion(TInputImage::ImageDimension);
+      for (unsigned int i = 0; i < TInputImage::ImageDimension; ++i)
+      {
+        ioRegion.SetSize(i, streamRegion.GetSize(i));
+        // Set the ioRegion index using the shifted index ( (0,0 without box parameter))
+        ioRegion.SetIndex(i, streamRegion.GetIndex(i) - m_ShiftOutputIndex[i]);
+      }
+      this->SetIORegion(ioRegion);
+      m_ImageIO->SetIORegion(m_IORegion);
 
-    // Start writing stream region in the image file
-    this->GenerateData();
+      // Start writing stream region in the image file
+      this->GenerateData();
+    }
   }
 
   /**
@@ -685,11 +710,174 @@ void ImageFileWriter<TInputImage>::Update()
  *
  */
 template <class TInputImage>
-void ImageFileWriter<TInputImage>::GenerateData(void)
+unsigned int ImageFileWriter<TInputImage>::ComputeNumberOfPendingBlocks()
 {
   const InputImageType* input = this->GetInput();
-  InputImagePointer     cacheImage;
 
+  // Estimate the size of the copy of the largest piece
+  itk::SizeValueType nbPixels = 0;
+  for (unsigned int i = 0; i < m_NumberOfDivisions; ++i)
+  {
+    nbPixels = std::max(nbPixels, m_StreamingManager->GetSplit(i).GetNumberOfPixels());
+  }
+  const itk::SizeValueType nbComponents = std::max<itk::SizeValueType>(input->GetNumberOfComponentsPerPixel(), m_BandList.size());
+  const double blockSizeInBytes = static_cast<double>(nbPixels) * nbComponents * sizeof(typename InputImageType::InternalPixelType);
+
+  // Besides the pending pieces, one copy is being written by the I/O
+  // thread and one is waiting to be queued. All of them may use at most
+  // half of the streaming RAM budget, on top of the pipeline which uses
+  // the whole budget.
+  const double       availableRAMInBytes = 0.5 * m_StreamingManager->GetAvailableRAMInBytes();
+  const unsigned int nbInFlightBlocks    = 2;
+
+  unsigned int nbPendingBlocks = std::max(1u, m_MaximumNumberOfPendingBlocks);
+  if (blockSizeInBytes > 0 && availableRAMInBytes < (nbPendingBlocks + nbInFlightBlocks) * blockSizeInBytes)
+  {
+    const double nbBlocks = std::floor(availableRAMInBytes / blockSizeInBytes);
+    nbPendingBlocks       = nbBlocks > nbInFlightBlocks + 1 ? static_cast<unsigned int>(nbBlocks) - nbInFlightBlocks : 1;
+    if (nbBlocks < nbInFlightBlocks + 1)
+    {
+      otbLogMacro(Warning, << "The copies of the pieces of " << m_FileName << " exceed half of the RAM budget");
+    }
+  }
+  return nbPendingBlocks;
+}
+
+/**
+ *
+ */
+template <class TInputImage>
+void ImageFileWriter<TInputImage>::StreamAndWriteAsynchronously()
+{
+  InputImagePointer inputPtr = const_cast<InputImageType*>(this->GetInput());
+
+  // The ImageIO is only used by the I/O thread from now on, so it is
+  // configured once here
+  this->ConfigureImageIOPixelType(inputPtr);
+
+  const unsigned int nbPendingBlocks = this->ComputeNumberOfPendingBlocks();
+  otbLogMacro(Info, << "Asynchronous writing of " << m_FileName << " with up to " << nbPendingBlocks << " pending blocks");
+
+  struct PendingBlock
+  {
+    InputImagePointer  image;
+    itk::ImageIORegion ioRegion;
+  };
+
+  std::deque<PendingBlock> queue;
+  std::mutex               queueMutex;
+  std::condition_variable  queueNotFull;
+  std::condition_variable  queueNotEmpty;
+  bool                     computeDone = false;
+  std::exception_ptr       ioException;
+
+  std::thread ioThread([&]() {
+    try
+    {
+      while (true)
+      {
+        PendingBlock block;
+        {
+          std::unique_lock<std::mutex> lock(queueMutex);
+          queueNotEmpty.wait(lock, [&]() { return !queue.empty() || computeDone; });
+          if (queue.empty())
+          {
+            return;
+          }
+          block = queue.front();
+          queue.pop_front();
+        }
+        queueNotFull.notify_one();
+
+        m_ImageIO->SetIORegion(block.ioRegion);
+        this->WriteBuffer(block.image->GetBufferPointer(), block.image->GetBufferedRegion().GetNumberOfPixels());
+      }
+    }
+    catch (...)
+    {
+      {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        ioException = std::current_exception();
+        queue.clear();
+      }
+      queueNotFull.notify_all();
+    }
+  });
+
+  // Stop the I/O thread once the pending pieces are written (or discarded)
+  auto joinIOThread = [&](bool discardPendingBlocks) {
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      computeDone = true;
+      if (discardPendingBlocks)
+      {
+        queue.clear();
+      }
+    }
+    queueNotEmpty.notify_all();
+    ioThread.join();
+  };
+
+  try
+  {
+    for (m_CurrentDivision = 0; m_CurrentDivision < m_NumberOfDivisions && !this->GetAbortGenerateData();
+         m_CurrentDivision++, m_DivisionProgress = 0, this->UpdateFilterProgress())
+    {
+      InputImageRegionType streamRegion = m_StreamingManager->GetSplit(m_CurrentDivision);
+
+      inputPtr->SetRequestedRegion(streamRegion);
+      inputPtr->PropagateRequestedRegion();
+      inputPtr->UpdateOutputData();
+
+      itk::ImageIORegion ioRegion(TInputImage::ImageDimension);
+      for (unsigned int i = 0; i < TInputImage::ImageDimension; ++i)
+      {
+        ioRegion.SetSize(i, streamRegion.GetSize(i));
+        // Set the ioRegion index using the shifted index ( (0,0 without box parameter))
+        ioRegion.SetIndex(i, streamRegion.GetIndex(i) - m_ShiftOutputIndex[i]);
+      }
+      this->SetIORegion(ioRegion);
+
+      // The pipeline buffer is reused by the next piece, so the queue
+      // holds its own copy
+      PendingBlock block;
+      block.image    = this->CopyRegionToCacheImage(inputPtr, streamRegion);
+      block.ioRegion = ioRegion;
+
+      {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueNotFull.wait(lock, [&]() { return queue.size() < nbPendingBlocks || ioException; });
+        if (ioException)
+        {
+          break;
+        }
+        queue.push_back(block);
+      }
+      queueNotEmpty.notify_one();
+    }
+  }
+  catch (...)
+  {
+    joinIOThread(true);
+    throw;
+  }
+
+  joinIOThread(this->GetAbortGenerateData());
+
+  if (ioException)
+  {
+    std::rethrow_exception(ioException);
+  }
+
+  this->WriteGeomFileIfRequested();
+}
+
+/**
+ *
+ */
+template <class TInputImage>
+void ImageFileWriter<TInputImage>::ConfigureImageIOPixelType(const InputImageType* input)
+{
   // Make sure that the image is the right type and no more than
   // four components.
   typedef typename InputImageType::PixelType ImagePixelType;
@@ -720,6 +908,91 @@ void ImageFileWriter<TInputImage>::GenerateData(void)
     // Set the pixel and component type; the number of components.
     m_ImageIO->SetPixelTypeInfo(typeid(ImagePixelType));
   }
+}
+
+/**
+ *
+ */
+template <class TInputImage>
+typename ImageFileWriter<TInputImage>::InputImagePointer ImageFileWriter<TInputImage>::CopyRegionToCacheImage(const InputImageType*       input,
+                                                                                                              const InputImageRegionType& region)
+{
+  InputImagePointer cacheImage = InputImageType::New();
+  cacheImage->CopyInformation(input);
+
+  // set number of components at the band range size
+  if (m_FilenameHelper->BandRangeIsSet() && (m_IOComponents < m_BandList.size()))
+  {
+    cacheImage->SetNumberOfComponentsPerPixel(m_BandList.size());
+  }
+
+  cacheImage->SetBufferedRegion(region);
+  cacheImage->Allocate();
+
+  // set number of components at the initial size
+  if (m_FilenameHelper->BandRangeIsSet() && (m_IOComponents < m_BandList.size()))
+  {
+    cacheImage->SetNumberOfComponentsPerPixel(m_IOComponents);
+  }
+
+  typedef itk::ImageRegionConstIterator<TInputImage> ConstIteratorType;
+  typedef itk::ImageRegionIterator<TInputImage>      IteratorType;
+
+  ConstIteratorType in(input, region);
+  IteratorType      out(cacheImage, region);
+
+  // copy the data into a buffer to match the ioregion
+  for (in.GoToBegin(), out.GoToBegin(); !in.IsAtEnd(); ++in, ++out)
+  {
+    out.Set(in.Get());
+  }
+
+  return cacheImage;
+}
+
+/**
+ *
+ */
+template <class TInputImage>
+void ImageFileWriter<TInputImage>::WriteBuffer(const void* dataPtr, itk::SizeValueType numberOfPixels)
+{
+  if (m_FilenameHelper->BandRangeIsSet() && (!m_BandList.empty()))
+  {
+    // Adapt the image size with the region and take into account a potential
+    // remapping of the components. m_BandList is empty if no band range is set
+    m_ImageIO->SetNumberOfComponents(m_IOComponents);
+    m_ImageIO->DoMapBuffer(const_cast<void*>(dataPtr), numberOfPixels, this->m_BandList);
+    m_ImageIO->SetNumberOfComponents(m_BandList.size());
+  }
+
+  m_ImageIO->Write(dataPtr);
+}
+
+/**
+ *
+ */
+template <class TInputImage>
+void ImageFileWriter<TInputImage>::WriteGeomFileIfRequested()
+{
+  if (m_WriteGeomFile || m_FilenameHelper->GetWriteGEOMFile())
+  {
+    ImageKeywordlist        otb_kwl;
+    itk::MetaDataDictionary dict = this->GetInput()->GetMetaDataDictionary();
+    itk::ExposeMetaData<ImageKeywordlist>(dict, MetaDataKey::OSSIMKeywordlistKey, otb_kwl);
+    WriteGeometry(otb_kwl, this->GetFileName());
+  }
+}
+
+/**
+ *
+ */
+template <class TInputImage>
+void ImageFileWriter<TInputImage>::GenerateData(void)
+{
+  const InputImageType* input = this->GetInput();
+  InputImagePointer     cacheImage;
+
+  this->ConfigureImageIOPixelType(input);
 
   // Setup the image IO for writing.
   //
@@ -740,37 +1013,8 @@ void ImageFileWriter<TInputImage>::GenerateData(void)
   {
     if (m_NumberOfDivisions > 1 || m_UserSpecifiedIORegion)
     {
-      cacheImage = InputImageType::New();
-      cacheImage->CopyInformation(input);
-
-      // set number of components at the band range size
-      if (m_FilenameHelper->BandRangeIsSet() && (m_IOComponents < m_BandList.size()))
-      {
-        cacheImage->SetNumberOfComponentsPerPixel(m_BandList.size());
-      }
-
-      cacheImage->SetBufferedRegion(ioRegion);
-      cacheImage->Allocate();
-
-      // set number of components at the initial size
-      if (m_FilenameHelper->BandRangeIsSet() && (m_IOComponents < m_BandList.size()))
-      {
-        cacheImage->SetNumberOfComponentsPerPixel(m_IOComponents);
-      }
-
-      typedef itk::ImageRegionConstIterator<TInputImage> ConstIteratorType;
-      typedef itk::ImageRegionIterator<TInputImage>      IteratorType;
-
-      ConstIteratorType in(input, ioRegion);
-      IteratorType      out(cacheImage, ioRegion);
-
-      // copy the data into a buffer to match the ioregion
-      for (in.GoToBegin(), out.GoToBegin(); !in.IsAtEnd(); ++in, ++out)
-      {
-        out.Set(in.Get());
-      }
-
-      dataPtr = (const void*)cacheImage->GetBufferPointer();
+      cacheImage = this->CopyRegionToCacheImage(input, ioRegion);
+      dataPtr    = (const void*)cacheImage->GetBufferPointer();
     }
     else
     {
@@ -787,23 +1031,9 @@ void ImageFileWriter<TInputImage>::GenerateData(void)
     }
   }
 
-  if (m_FilenameHelper->BandRangeIsSet() && (!m_BandList.empty()))
-  {
-    // Adapt the image size with the region and take into account a potential
-    // remapping of the components. m_BandList is empty if no band range is set
-    m_ImageIO->DoMapBuffer(const_cast<void*>(dataPtr), bufferedRegion.GetNumberOfPixels(), this->m_BandList);
-    m_ImageIO->SetNumberOfComponents(m_BandList.size());
-  }
-
-  m_ImageIO->Write(dataPtr);
+  this->WriteBuffer(dataPtr, ioRegion.GetNumberOfPixels());
 
-  if (m_WriteGeomFile || m_FilenameHelper->GetWriteGEOMFile())
-  {
-    ImageKeywordlist        otb_kwl;
-    itk::MetaDataDictionary dict = this->GetInput()->GetMetaDataDictionary();
-    itk::ExposeMetaData<ImageKeywordlist>(dict, MetaDataKey::OSSIMKeywordlistKey, otb_kwl);
-    WriteGeometry(otb_kwl, this->GetFileName());
-  }
+  this->WriteGeomFileIfRequested();
 }
 
 template <class TInputImage>
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbDenseListSample_h
+#define otbDenseListSample_h
+
+#include "itkListSample.h"
+#include "itkVariableLengthVector.h"
+#include <algorithm>
+#include <vector>
+
+namespace otb
+{
+
+/** \class DenseListSample
+ *
+ * \brief ListSample storing all its samples in one row-major buffer
+ *
+ * An itk::Statistics::ListSample of VariableLengthVector allocates each
+ * sample separately. This list sample stores the components of all its
+ * samples in one contiguous buffer (sample after sample), and its
+ * measurement vectors are views on this buffer. It can be used wherever a
+ * ListSample is expected, and learning models read the buffer directly
+ * (see GetDenseBuffer()) instead of iterating over the samples.
+ *
+ * The measurement vector size must be set before adding samples. Resize(),
+ * PushBack() and Clear() must be called on the DenseListSample type: the
+ * ListSample versions are not virtual and do not update the buffer (samples
+ * added this way are still valid, but the list is no longer contiguous, see
+ * IsContiguous()).
+ *
+ * \ingroup OTBLearningBase
+ */
+template <class TValue>
+class ITK_EXPORT DenseListSample : public itk::Statistics::ListSample<itk::VariableLengthVector<TValue>>
+{
+public:
+  /** Standard class typedefs */
+  typedef DenseListSample Self;
+  typedef itk::Statistics::ListSample<itk::VariableLengthVector<TValue>> Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Standard macros */
+  itkTypeMacro(DenseListSample, ListSample);
+  itkNewMacro(Self);
+
+  typedef TValue                                  ValueType;
+  typedef typename Superclass::MeasurementVectorType MeasurementVectorType;
+  typedef typename Superclass::InstanceIdentifier    InstanceIdentifier;
+
+  /** Resize the list, new samples are set to 0 */
+  void Resize(InstanceIdentifier newSize)
+  {
+    // Resizing the container may copy the views, the buffer must still be
+    // valid at that time
+    Superclass::Resize(newSize);
+    m_Buffer.resize(newSize * this->GetMeasurementVectorSize(), ValueType());
+    this->UpdateViews(0);
+  }
+
+  /** Add a sample, copied into the buffer */
+  void PushBack(const MeasurementVectorType& mv)
+  {
+    const unsigned int sampleSize = this->GetMeasurementVectorSize();
+    const InstanceIdentifier id   = this->Size();
+    if (mv.Size() != sampleSize)
+    {
+      itkExceptionMacro(<< "Sample size " << mv.Size() << " differs from the measurement vector size " << sampleSize);
+    }
+
+    // Copy first a sample of this list, the buffer may move
+    if (m_Buffer.size() > 0 && &mv[0] >= m_Buffer.data() && &mv[0] < m_Buffer.data() + m_Buffer.size())
+    {
+      this->PushBack(MeasurementVectorType(mv));
+      return;
+    }
+
+    // The container is resized first, as it may copy the views
+    const MeasurementVectorType* oldFirst = id > 0 ? &Superclass::GetMeasurementVector(0) : nullptr;
+    Superclass::Resize(id + 1);
+
+    // Grow the buffer geometrically
+    const ValueType* oldData = m_Buffer.data();
+    if (m_Buffer.size() + sampleSize > m_Buffer.capacity())
+    {
+      m_Buffer.reserve(std::max(2 * m_Buffer.capacity(), m_Buffer.size() + sampleSize));
+    }
+    m_Buffer.insert(m_Buffer.end(), &mv[0], &mv[0] + sampleSize);
+
+    // Views are updated when the buffer or the measurement vectors move
+    const bool moved = m_Buffer.data() != oldData || (oldFirst && oldFirst != &Superclass::GetMeasurementVector(0));
+    this->UpdateViews(moved ? 0 : id);
+  }
+
+  /** Add nbSamples samples set to 0, and return a pointer to their
+   * components in the buffer, so that they can be filled in place */
+  ValueType* PushBackSamples(InstanceIdentifier nbSamples)
+  {
+    const InstanceIdentifier first = this->Size();
+    this->Resize(first + nbSamples);
+    return m_Buffer.data() + first * this->GetMeasurementVectorSize();
+  }
+
+  void Clear()
+  {
+    Superclass::Clear();
+    m_Buffer.clear();
+  }
+
+  /** Pointer to the Size() x GetMeasurementVectorSize() row-major buffer */
+  const ValueType* GetBufferPointer() const
+  {
+    return m_Buffer.data();
+  }
+
+  /** true if every measurement vector is a view on the buffer */
+  bool IsContiguous() const
+  {
+    const unsigned int sampleSize = this->GetMeasurementVectorSize();
+    if (this->Size() * sampleSize != m_Buffer.size())
+    {
+      return false;
+    }
+    for (InstanceIdentifier id = 0; id < this->Size(); ++id)
+    {
+      const MeasurementVectorType& mv = Superclass::GetMeasurementVector(id);
+      if (mv.Size() != sampleSize || (sampleSize > 0 && &mv[0] != m_Buffer.data() + id * sampleSize))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+protected:
+  DenseListSample()
+  {
+  }
+  ~DenseListSample() override
+  {
+  }
+
+private:
+  DenseListSample(const Self&) = delete;
+  void operator=(const Self&) = delete;
+
+  /** Point the measurement vectors from the given one onwards to the buffer */
+  void UpdateViews(InstanceIdentifier first)
+  {
+    const unsigned int sampleSize = this->GetMeasurementVectorSize();
+    for (InstanceIdentifier id = first; id < this->Size(); ++id)
+    {
+      // Measurement vectors are only exposed as const references by
+      // ListSample, but they are not const objects
+      MeasurementVectorType& mv = const_cast<MeasurementVectorType&>(Superclass::GetMeasurementVector(id));
+      mv.SetData(m_Buffer.data() + id * sampleSize, sampleSize, false);
+    }
+  }
+
+  std::vector<ValueType> m_Buffer;
+};
+
+/** Return the buffer of a contiguous DenseListSample, or null if the list
+ * sample is not one */
+template <class TValue>
+const TValue* GetDenseBuffer(const itk::Statistics::ListSample<itk::VariableLengthVector<TValue>>* listSample)
+{
+  const DenseListSample<TValue>* dense = dynamic_cast<const DenseListSample<TValue>*>(listSample);
+  return dense && dense->IsContiguous() ? dense->GetBufferPointer() : nullptr;
+}
+
+} // end namespace otb
+
+#endif
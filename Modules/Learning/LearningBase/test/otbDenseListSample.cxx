@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbDenseListSample.h"
+#include <iostream>
+
+int otbDenseListSample(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  typedef otb::DenseListSample<float> DenseListSampleType;
+  typedef itk::Statistics::ListSample<itk::VariableLengthVector<float>> ListSampleType;
+
+  const unsigned int                 sampleSize = 3;
+  const unsigned int                 nbSamples  = 1000;
+  DenseListSampleType::Pointer       dense      = DenseListSampleType::New();
+  DenseListSampleType::MeasurementVectorType mv(sampleSize);
+  dense->SetMeasurementVectorSize(sampleSize);
+
+  // Enough samples to move the buffer several times
+  for (unsigned int i = 0; i < nbSamples; ++i)
+  {
+    for (unsigned int j = 0; j < sampleSize; ++j)
+    {
+      mv[j] = static_cast<float>(i * sampleSize + j);
+    }
+    dense->PushBack(mv);
+  }
+  // Add a sample of the list itself
+  dense->PushBack(dense->GetMeasurementVector(0));
+
+  if (dense->Size() != nbSamples + 1 || !dense->IsContiguous())
+  {
+    std::cerr << "The list sample is not contiguous" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const ListSampleType* listSample = dense.GetPointer();
+  const float*          buffer     = otb::GetDenseBuffer(listSample);
+  if (buffer == nullptr)
+  {
+    std::cerr << "No dense buffer found" << std::endl;
+    return EXIT_FAILURE;
+  }
+  for (unsigned int i = 0; i <= nbSamples; ++i)
+  {
+    const unsigned int expected = i < nbSamples ? i : 0;
+    for (unsigned int j = 0; j < sampleSize; ++j)
+    {
+      if (listSample->GetMeasurementVector(i)[j] != static_cast<float>(expected * sampleSize + j) || buffer[i * sampleSize + j] != listSample->GetMeasurementVector(i)[j])
+      {
+        std::cerr << "Wrong value for sample " << i << ", component " << j << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // A plain list sample has no dense buffer
+  ListSampleType::Pointer sparse = ListSampleType::New();
+  sparse->SetMeasurementVectorSize(sampleSize);
+  sparse->PushBack(mv);
+  if (otb::GetDenseBuffer(sparse.GetPointer()) != nullptr)
+  {
+    std::cerr << "A ListSample should not have a dense buffer" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  dense->Resize(10);
+  if (dense->Size() != 10 || !dense->IsContiguous() || dense->GetMeasurementVector(9)[2] != static_cast<float>(9 * sampleSize + 2))
+  {
+    std::cerr << "Resize() failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Fill samples in place
+  float* block = dense->PushBackSamples(5);
+  for (unsigned int k = 0; k < 5 * sampleSize; ++k)
+  {
+    block[k] = -static_cast<float>(k);
+  }
+  if (dense->Size() != 15 || !dense->IsContiguous() || dense->GetMeasurementVector(9)[2] != static_cast<float>(9 * sampleSize + 2) ||
+      dense->GetMeasurementVector(14)[2] != -static_cast<float>(4 * sampleSize + 2))
+  {
+    std::cerr << "PushBackSamples() failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  dense->Clear();
+  if (dense->Size() != 0 || !dense->IsContiguous())
+  {
+    std::cerr << "Clear() failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -26,6 +26,7 @@
 #include "otbOGRDataSourceWrapper.h"
 #include "otbImage.h"
 #include <string>
+#include <vector>
 
 namespace otb
 {
@@ -35,6 +36,15 @@ namespace otb
  *
  * \brief Persistent filter to extract sample values from an image
  *
+ * When the output samples are written to a new container (copy mode),
+ * each streamed region only requests the image block bounding the sample
+ * positions it contains. Pixel values are read by several threads, in the
+ * row order of the image, then the output features are written in one
+ * transaction, in the order of the input layer. Only the samples of the
+ * current region are held in memory. The update mode (output container
+ * equal to the input one) relies on the generic implementation of
+ * PersistentSamplingFilterBase.
+ *
  * \ingroup OTBSampling
  */
 template <class TInputImage>
@@ -50,6 +60,7 @@ public:
   typedef TInputImage                                InputImageType;
   typedef typename InputImageType::Pointer           InputImagePointer;
   typedef typename InputImageType::RegionType        RegionType;
+  typedef typename InputImageType::SizeType          SizeType;
   typedef typename InputImageType::PointType         PointType;
   typedef typename InputImageType::IndexType         IndexType;
   typedef typename InputImageType::PixelType         PixelType;
@@ -99,8 +110,13 @@ protected:
 
   void GenerateOutputInformation() override;
 
+  /** Request the block bounding the sample positions of the output requested
+   *  region, or its first pixel if it holds no sample */
   void GenerateInputRequestedRegion() override;
 
+  /** Extract values in copy mode, use the generic implementation otherwise */
+  void GenerateData(void) override;
+
   /** process only points */
   void ThreadedGenerateVectorData(const ogr::Layer& layerForThread, itk::ThreadIdType threadid) override;
 
@@ -111,12 +127,34 @@ private:
   /** Initialize fields to store extracted values (Real type) */
   void InitializeFields();
 
+  /** Compute the pixel index of each point feature inside a region, in the
+   *  iteration order of the input layer */
+  void ComputeSampleIndexes(const RegionType& region);
+
+  /** Return the point geometry of a feature, or null if it is not a point */
+  static const OGRPoint* GetSamplePoint(const ogr::Feature& feature);
+
+  /** Callback reading the pixel values of a range of samples */
+  static ITK_THREAD_RETURN_TYPE SampleThreaderCallback(void* arg);
+
+  struct SampleThreadStruct
+  {
+    Self*                       Filter;
+    std::vector<unsigned long>* Order;
+    std::vector<double>*        Values;
+  };
+
   /** Prefix to generate field names for each input channel
    *  (ignored if the field names are given directly) */
   std::string m_SampleFieldPrefix;
 
   /** List of field names for each component */
   std::vector<std::string> m_SampleFieldNames;
+
+  /** Pixel index of the point features in the region m_SampleIndexesRegion */
+  std::vector<IndexType> m_SampleIndexes;
+
+  RegionType m_SampleIndexesRegion;
 };
 
 /**
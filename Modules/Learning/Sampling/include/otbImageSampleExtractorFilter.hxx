@@ -24,6 +24,7 @@
 #include "otbImageSampleExtractorFilter.h"
 #include "itkDefaultConvertPixelTraits.h"
 #include "itkProgressReporter.h"
+#include <algorithm>
 
 namespace otb
 {
@@ -84,6 +85,9 @@ void PersistentImageSampleExtractorFilter<TInputImage>::Reset(void)
   ogr::DataSource* inputDS = const_cast<ogr::DataSource*>(this->GetOGRData());
   ogr::DataSource* output  = this->GetOutputSamples();
   this->InitializeOutputDataSource(inputDS, output);
+
+  m_SampleIndexes.clear();
+  m_SampleIndexesRegion = RegionType();
 }
 
 template <class TInputImage>
@@ -142,9 +146,213 @@ void PersistentImageSampleExtractorFilter<TInputImage>::GenerateInputRequestedRe
 {
   InputImageType* input     = const_cast<InputImageType*>(this->GetInput());
   RegionType      requested = this->GetOutput()->GetRequestedRegion();
-  input->SetRequestedRegion(requested);
+
+  this->ComputeSampleIndexes(requested);
+
+  // Only read the block bounding the samples. Without sample, a single pixel
+  // of the requested region is read: an empty region would be propagated
+  // to the upstream filters, which do not all support it.
+  RegionType pixelRegion = requested;
+  SizeType   pixelSize;
+  pixelSize.Fill(1);
+  pixelRegion.SetSize(pixelSize);
+  pixelRegion.Crop(input->GetLargestPossibleRegion());
+
+  RegionType sampleRegion = pixelRegion;
+  if (!m_SampleIndexes.empty())
+  {
+    IndexType lower = m_SampleIndexes.front();
+    IndexType upper = m_SampleIndexes.front();
+    for (const auto& index : m_SampleIndexes)
+    {
+      for (unsigned int dim = 0; dim < InputImageType::ImageDimension; ++dim)
+      {
+        lower[dim] = std::min(lower[dim], index[dim]);
+        upper[dim] = std::max(upper[dim], index[dim]);
+      }
+    }
+    sampleRegion.SetIndex(lower);
+    sampleRegion.SetUpperIndex(upper);
+    if (!sampleRegion.Crop(input->GetLargestPossibleRegion()))
+    {
+      sampleRegion = pixelRegion;
+    }
+  }
+  input->SetRequestedRegion(sampleRegion);
+}
+
+template <class TInputImage>
+void PersistentImageSampleExtractorFilter<TInputImage>::GenerateData(void)
+{
+  ogr::DataSource* output = this->GetOutputSamples();
+  if (output == this->GetOGRData())
+  {
+    // Update mode : features are rewritten in place by the generic implementation
+    Superclass::GenerateData();
+    return;
+  }
+
+  // No in-memory layer is needed here
+  Superclass::Superclass::AllocateOutputs();
+  this->BeforeThreadedGenerateData();
+
+  const RegionType& requested = this->GetOutput()->GetRequestedRegion();
+  if (requested != m_SampleIndexesRegion)
+  {
+    this->ComputeSampleIndexes(requested);
+  }
+
+  const TInputImage*  inputImage = this->GetInput();
+  const unsigned int  nbBand     = inputImage->GetNumberOfComponentsPerPixel();
+  const unsigned long nbSamples  = m_SampleIndexes.size();
+
+  // Read the samples row by row, to follow the image buffer
+  std::vector<unsigned long> order(nbSamples);
+  for (unsigned long i = 0; i < nbSamples; ++i)
+  {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [this](unsigned long a, unsigned long b) {
+    const IndexType& indexA = m_SampleIndexes[a];
+    const IndexType& indexB = m_SampleIndexes[b];
+    return indexA[1] < indexB[1] || (indexA[1] == indexB[1] && indexA[0] < indexB[0]);
+  });
+
+  std::vector<double> values(nbSamples * nbBand, 0.);
+
+  SampleThreadStruct str;
+  str.Filter = this;
+  str.Order  = &order;
+  str.Values = &values;
+
+  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+  this->GetMultiThreader()->SetSingleMethod(this->SampleThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // Write the features in the order of the input layer
+  ogr::DataSource* vectors  = const_cast<ogr::DataSource*>(this->GetOGRData());
+  ogr::Layer       inLayer  = vectors->GetLayer(this->GetLayerIndex());
+  ogr::Layer       outLayer = output->GetLayersCount() == 1 ? output->GetLayer(0) : output->GetLayer(this->GetOutLayerName());
+
+  OGRErr err = outLayer.ogr().StartTransaction();
+  if (err != OGRERR_NONE)
+  {
+    itkExceptionMacro(<< "Unable to start transaction for OGR layer " << outLayer.ogr().GetName() << ".");
+  }
+
+  const RegionType& bufferedRegion = inputImage->GetBufferedRegion();
+  unsigned long     sample         = 0;
+  this->SetLayerSpatialFilter(inLayer, requested);
+  for (ogr::Layer::const_iterator featIt = inLayer.begin(); featIt != inLayer.end(); ++featIt)
+  {
+    if (!GetSamplePoint(*featIt))
+    {
+      OGRGeometry* geom = featIt->ogr().GetGeometryRef();
+      otbWarningMacro("Geometry not handled: " << (geom ? geom->getGeometryName() : "null"));
+      continue;
+    }
+    if (sample >= nbSamples)
+    {
+      itkExceptionMacro(<< "Features of layer " << inLayer.ogr().GetName() << " changed during the extraction.");
+    }
+
+    ogr::Feature dstFeature(outLayer.GetLayerDefn());
+    dstFeature.SetFrom(*featIt, TRUE);
+    if (bufferedRegion.IsInside(m_SampleIndexes[sample]))
+    {
+      for (unsigned int i = 0; i < nbBand; ++i)
+      {
+        dstFeature[m_SampleFieldNames[i]].SetValue(values[sample * nbBand + i]);
+      }
+    }
+    outLayer.CreateFeature(dstFeature);
+    ++sample;
+  }
+  inLayer.SetSpatialFilter(nullptr);
+
+  err = outLayer.ogr().CommitTransaction();
+  if (err != OGRERR_NONE)
+  {
+    itkExceptionMacro(<< "Unable to commit transaction for OGR layer " << outLayer.ogr().GetName() << ".");
+  }
+
+  this->AfterThreadedGenerateData();
+}
+
+template <class TInputImage>
+void PersistentImageSampleExtractorFilter<TInputImage>::ComputeSampleIndexes(const RegionType& region)
+{
+  const TInputImage* inputImage = this->GetInput();
+  ogr::DataSource*   vectors    = const_cast<ogr::DataSource*>(this->GetOGRData());
+  ogr::Layer         inLayer    = vectors->GetLayer(this->GetLayerIndex());
+
+  m_SampleIndexes.clear();
+  m_SampleIndexesRegion = region;
+
+  PointType imgPoint;
+  IndexType imgIndex;
+  this->SetLayerSpatialFilter(inLayer, region);
+  for (ogr::Layer::const_iterator featIt = inLayer.begin(); featIt != inLayer.end(); ++featIt)
+  {
+    const OGRPoint* point = GetSamplePoint(*featIt);
+    if (point)
+    {
+      imgPoint[0] = point->getX();
+      imgPoint[1] = point->getY();
+      inputImage->TransformPhysicalPointToIndex(imgPoint, imgIndex);
+      m_SampleIndexes.push_back(imgIndex);
+    }
+  }
+  inLayer.SetSpatialFilter(nullptr);
 }
 
+template <class TInputImage>
+const OGRPoint* PersistentImageSampleExtractorFilter<TInputImage>::GetSamplePoint(const ogr::Feature& feature)
+{
+  const OGRGeometry* geom = feature.ogr().GetGeometryRef();
+  if (geom == nullptr || (geom->getGeometryType() != wkbPoint && geom->getGeometryType() != wkbPoint25D))
+  {
+    return nullptr;
+  }
+  return dynamic_cast<const OGRPoint*>(geom);
+}
+
+template <class TInputImage>
+ITK_THREAD_RETURN_TYPE PersistentImageSampleExtractorFilter<TInputImage>::SampleThreaderCallback(void* arg)
+{
+  itk::ThreadIdType threadId    = ((itk::MultiThreader::ThreadInfoStruct*)(arg))->ThreadID;
+  itk::ThreadIdType threadCount = ((itk::MultiThreader::ThreadInfoStruct*)(arg))->NumberOfThreads;
+  SampleThreadStruct* str       = (SampleThreadStruct*)(((itk::MultiThreader::ThreadInfoStruct*)(arg))->UserData);
+
+  Self*                             filter     = str->Filter;
+  const TInputImage*                inputImage = filter->GetInput();
+  const RegionType&                 buffered   = inputImage->GetBufferedRegion();
+  const unsigned int                nbBand     = inputImage->GetNumberOfComponentsPerPixel();
+  const std::vector<unsigned long>& order      = *(str->Order);
+  std::vector<double>&              values     = *(str->Values);
+
+  // Each thread reads a contiguous range of the sorted samples
+  const unsigned long begin = order.size() * threadId / threadCount;
+  const unsigned long end   = order.size() * (threadId + 1) / threadCount;
+
+  itk::ProgressReporter progress(filter, threadId, end - begin);
+  for (unsigned long k = begin; k < end; ++k)
+  {
+    const unsigned long sample = order[k];
+    const IndexType&    index  = filter->m_SampleIndexes[sample];
+    if (buffered.IsInside(index))
+    {
+      const PixelType& imgPixel = inputImage->GetPixel(index);
+      for (unsigned int i = 0; i < nbBand; ++i)
+      {
+        values[sample * nbBand + i] = static_cast<double>(itk::DefaultConvertPixelTraits<PixelType>::GetNthComponent(i, imgPixel));
+      }
+    }
+    progress.CompletedPixel();
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
 
 template <class TInputImage>
 void PersistentImageSampleExtractorFilter<TInputImage>::ThreadedGenerateVectorData(const ogr::Layer& layerForThread, itk::ThreadIdType threadid)
@@ -23,6 +23,7 @@
 
 #include "otbPersistentSamplingFilterBase.h"
 #include "otbPersistentFilterStreamingDecorator.h"
+#include "otbPerThreadAccumulator.h"
 #include "itkSimpleDataObjectDecorator.h"
 #include <string>
 
@@ -102,16 +103,39 @@ private:
   PersistentOGRDataToClassStatisticsFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
 
-  /** Number of pixels in all the polygons (per thread) */
-  std::vector<unsigned long> m_NbPixelsThread;
-  /** Number of pixels in each classes (per thread) */
-  std::vector<ClassCountMapType> m_ElmtsInClassThread;
-  /** Number of pixels in each polygons (per thread) */
-  std::vector<PolygonSizeMapType> m_PolygonThread;
-  /** Class name of the current feature (per thread) */
-  std::vector<std::string> m_CurrentClass;
-  /** FID of the current feature (per thread) */
-  std::vector<unsigned long> m_CurrentFID;
+  /** Statistics gathered by each thread */
+  struct ThreadStatistics
+  {
+    ThreadStatistics() : nbPixels(0), currentClassCount(nullptr), currentPolygonSize(nullptr)
+    {
+    }
+
+    void Merge(const ThreadStatistics& other)
+    {
+      nbPixels += other.nbPixels;
+      for (const auto& count : other.elmtsInClass)
+      {
+        elmtsInClass[count.first] += count.second;
+      }
+      for (const auto& size : other.polygonSize)
+      {
+        polygonSize[size.first] += size.second;
+      }
+    }
+
+    /** Number of pixels in all the polygons */
+    unsigned long nbPixels;
+    /** Number of pixels in each class */
+    ClassCountMapType elmtsInClass;
+    /** Number of pixels in each polygon */
+    PolygonSizeMapType polygonSize;
+    /** Counters of the class and of the polygon of the current feature, set
+     *  by PrepareFeature() so that ProcessSample() does no map lookup */
+    unsigned long* currentClassCount;
+    unsigned long* currentPolygonSize;
+  };
+
+  PerThreadAccumulator<ThreadStatistics> m_ThreadStatistics;
 };
 
 /**
@@ -45,55 +45,18 @@ void PersistentOGRDataToClassStatisticsFilter<TInputImage, TMaskImage>::Syntheti
   ClassCountMapType&  classCount  = this->GetClassCountOutput()->Get();
   PolygonSizeMapType& polygonSize = this->GetPolygonSizeOutput()->Get();
 
-  // Reset outputs
-  classCount.clear();
-  polygonSize.clear();
-  // Copy temporary stats to outputs
-  for (unsigned int k = 0; k < this->GetNumberOfThreads(); k++)
-  {
-    ClassCountMapType::iterator itClass = m_ElmtsInClassThread[k].begin();
-    for (; itClass != m_ElmtsInClassThread[k].end(); ++itClass)
-    {
-      if (classCount.count(itClass->first))
-      {
-        classCount[itClass->first] += itClass->second;
-      }
-      else
-      {
-        classCount[itClass->first] = itClass->second;
-      }
-    }
-    PolygonSizeMapType::iterator itPoly = m_PolygonThread[k].begin();
-    for (; itPoly != m_PolygonThread[k].end(); ++itPoly)
-    {
-      if (polygonSize.count(itPoly->first))
-      {
-        polygonSize[itPoly->first] += itPoly->second;
-      }
-      else
-      {
-        polygonSize[itPoly->first] = itPoly->second;
-      }
-    }
-  }
+  // Merge the statistics of the threads
+  const ThreadStatistics total = m_ThreadStatistics.Reduce([](ThreadStatistics& a, const ThreadStatistics& b) { a.Merge(b); });
+  classCount                   = total.elmtsInClass;
+  polygonSize                  = total.polygonSize;
 
-  m_ElmtsInClassThread.clear();
-  m_PolygonThread.clear();
-  m_NbPixelsThread.clear();
+  m_ThreadStatistics.Reset(0, ThreadStatistics());
 }
 
 template <class TInputImage, class TMaskImage>
 void PersistentOGRDataToClassStatisticsFilter<TInputImage, TMaskImage>::Reset(void)
 {
-  m_ElmtsInClassThread.clear();
-  m_PolygonThread.clear();
-  m_NbPixelsThread.clear();
-
-  m_ElmtsInClassThread.resize(this->GetNumberOfThreads());
-  m_PolygonThread.resize(this->GetNumberOfThreads());
-  m_NbPixelsThread.resize(this->GetNumberOfThreads());
-  m_CurrentClass.resize(this->GetNumberOfThreads());
-  m_CurrentFID.resize(this->GetNumberOfThreads());
+  m_ThreadStatistics.Reset(this->GetNumberOfThreads(), ThreadStatistics());
 }
 
 template <class TInputImage, class TMaskImage>
@@ -165,29 +128,21 @@ template <class TInputImage, class TMaskImage>
 void PersistentOGRDataToClassStatisticsFilter<TInputImage, TMaskImage>::ProcessSample(const ogr::Feature&, typename TInputImage::IndexType&,
                                                                                       typename TInputImage::PointType&, itk::ThreadIdType& threadid)
 {
-  std::string&   className = m_CurrentClass[threadid];
-  unsigned long& fId       = m_CurrentFID[threadid];
-
-  m_ElmtsInClassThread[threadid][className]++;
-  m_PolygonThread[threadid][fId]++;
-  m_NbPixelsThread[threadid]++;
+  ThreadStatistics& stats = m_ThreadStatistics[threadid];
+  ++*stats.currentClassCount;
+  ++*stats.currentPolygonSize;
+  ++stats.nbPixels;
 }
 
 template <class TInputImage, class TMaskImage>
 void PersistentOGRDataToClassStatisticsFilter<TInputImage, TMaskImage>::PrepareFeature(const ogr::Feature& feature, itk::ThreadIdType& threadid)
 {
-  std::string   className(feature.ogr().GetFieldAsString(this->GetFieldIndex()));
-  unsigned long fId = feature.ogr().GetFID();
-  if (!m_ElmtsInClassThread[threadid].count(className))
-  {
-    m_ElmtsInClassThread[threadid][className] = 0;
-  }
-  if (!m_PolygonThread[threadid].count(fId))
-  {
-    m_PolygonThread[threadid][fId] = 0;
-  }
-  m_CurrentClass[threadid] = className;
-  m_CurrentFID[threadid]   = fId;
+  // Create the counters of the feature (even if it contains no pixel) and
+  // keep them at hand for ProcessSample(). Pointers to std::map elements
+  // stay valid while other elements are inserted.
+  ThreadStatistics& stats  = m_ThreadStatistics[threadid];
+  stats.currentClassCount  = &stats.elmtsInClass[feature.ogr().GetFieldAsString(this->GetFieldIndex())];
+  stats.currentPolygonSize = &stats.polygonSize[feature.ogr().GetFID()];
 }
 
 // -------------- otb::OGRDataToClassStatisticsFilter --------------------------
@@ -143,6 +143,10 @@ protected:
   /** Get the region bounding a set of features */
   RegionType FeatureBoundingRegion(const TInputImage* image, otb::ogr::Layer::const_iterator& featIt) const;
 
+  /** Restrict a layer to the features that may fall inside an image region
+   *  (pixel borders included). Reset with layer.SetSpatialFilter(nullptr). */
+  void SetLayerSpatialFilter(ogr::Layer& layer, const RegionType& region);
+
   /** Method to split the input OGRDataSource between several containers
    *  for each thread. Default is to put the same number of features for
    *  each thread.*/
@@ -616,15 +616,11 @@ PersistentSamplingFilterBase<TInputImage, TMaskImage>::FeatureBoundingRegion(con
 }
 
 template <class TInputImage, class TMaskImage>
-void PersistentSamplingFilterBase<TInputImage, TMaskImage>::DispatchInputVectors()
+void PersistentSamplingFilterBase<TInputImage, TMaskImage>::SetLayerSpatialFilter(ogr::Layer& layer, const RegionType& region)
 {
-  TInputImage*     outputImage = this->GetOutput();
-  ogr::DataSource* vectors     = const_cast<ogr::DataSource*>(this->GetOGRData());
-  ogr::Layer       inLayer     = vectors->GetLayer(m_LayerIndex);
-
-  const RegionType&            requestedRegion = outputImage->GetRequestedRegion();
-  itk::ContinuousIndex<double> startIndex(requestedRegion.GetIndex());
-  itk::ContinuousIndex<double> endIndex(requestedRegion.GetUpperIndex());
+  TInputImage*                 outputImage = this->GetOutput();
+  itk::ContinuousIndex<double> startIndex(region.GetIndex());
+  itk::ContinuousIndex<double> endIndex(region.GetUpperIndex());
   startIndex[0] += -0.5;
   startIndex[1] += -0.5;
   endIndex[0] += 0.5;
@@ -644,7 +640,16 @@ void PersistentSamplingFilterBase<TInputImage, TMaskImage>::DispatchInputVectors
   ring.addPoint(startPoint[0], startPoint[1], 0.0);
   tmpPolygon.addRing(&ring);
 
-  inLayer.SetSpatialFilter(&tmpPolygon);
+  layer.SetSpatialFilter(&tmpPolygon);
+}
+
+template <class TInputImage, class TMaskImage>
+void PersistentSamplingFilterBase<TInputImage, TMaskImage>::DispatchInputVectors()
+{
+  ogr::DataSource* vectors = const_cast<ogr::DataSource*>(this->GetOGRData());
+  ogr::Layer       inLayer = vectors->GetLayer(m_LayerIndex);
+
+  this->SetLayerSpatialFilter(inLayer, this->GetOutput()->GetRequestedRegion());
 
   unsigned int            numberOfThreads = this->GetNumberOfThreads();
   std::vector<ogr::Layer> tmpLayers;
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSampleStore_h
+#define otbSampleStore_h
+
+#include "otbOGRLayerWrapper.h"
+#include "itkMacro.h"
+#include "OTBSamplingExport.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace otb
+{
+
+/** \class SampleStore
+ *
+ * \brief Columnar binary storage of learning samples
+ *
+ * A sample store is a table with one typed column per feature (and per
+ * label). Each column is stored contiguously, so that training samples
+ * are read with one read per column and copied into a sample matrix,
+ * instead of parsing every field of every feature of an OGR layer.
+ *
+ * The file starts with a text header giving the byte order, the number
+ * of samples, and the type and name of each column. Columns follow in
+ * native byte order, each one starting at a multiple of 8 bytes so that
+ * the file can also be memory-mapped. Loading a file written with a
+ * different byte order fails.
+ *
+ * Stores are created from OGR layers with ImportLayer(), for instance
+ * from the output of SampleExtraction.
+ *
+ * Load() reads all the columns into memory, and GetSamples() copies them
+ * into a row-major matrix: reading samples for training takes the memory of
+ * the store plus the one of the matrix, until the store is destroyed. The
+ * training applications use the buffer of a DenseListSample as the matrix,
+ * so that the samples are not copied again.
+ *
+ * \ingroup OTBSampling
+ */
+class OTBSampling_EXPORT SampleStore
+{
+public:
+  enum ColumnType
+  {
+    Int32,
+    Int64,
+    Float32,
+    Float64
+  };
+
+  struct ColumnInfo
+  {
+    std::string Name;
+    ColumnType  Type;
+  };
+
+  SampleStore();
+
+  void Clear();
+
+  unsigned long GetNumberOfSamples() const;
+
+  const std::vector<ColumnInfo>& GetColumns() const;
+
+  /** Index of the column with the given name, -1 if there is none */
+  int GetColumnIndex(const std::string& name) const;
+
+  /** true if the column values are loaded (see LoadInformation()) */
+  bool HasValues() const;
+
+  /** Read a whole store */
+  void Load(const std::string& fileName);
+
+  /** Read the columns and the number of samples, but no value */
+  void LoadInformation(const std::string& fileName);
+
+  void Save(const std::string& fileName) const;
+
+  /** Replace the content of the store with some fields of an OGR layer.
+   * Integer and real fields keep their type. String fields are converted
+   * to Float64 (labels stored as text), unset fields are stored as 0.
+   * Throws if a string field holds something else than a number. */
+  void ImportLayer(ogr::Layer& layer, const std::vector<std::string>& fieldNames);
+
+  /** Copy a column into an array of GetNumberOfSamples() values */
+  template <class T>
+  void GetColumn(unsigned int column, T* values) const
+  {
+    this->CopyColumn(column, values, 1);
+  }
+
+  /** Copy several columns into a row-major matrix of
+   * GetNumberOfSamples() x columns.size() values */
+  template <class T>
+  void GetSamples(const std::vector<unsigned int>& columns, T* matrix) const
+  {
+    for (unsigned int k = 0; k < columns.size(); ++k)
+    {
+      this->CopyColumn(columns[k], matrix + k, columns.size());
+    }
+  }
+
+  /** true if the file starts like a sample store */
+  static bool CanReadFile(const std::string& fileName);
+
+  static unsigned int GetTypeSize(ColumnType type);
+
+private:
+  template <class T>
+  void CopyColumn(unsigned int column, T* values, unsigned int stride) const
+  {
+    if (column >= m_Data.size())
+    {
+      itkGenericExceptionMacro(<< "Values of column " << column << " are not loaded");
+    }
+    const char* data = m_Data[column].data();
+    switch (m_Columns[column].Type)
+    {
+    case Int32:
+      CopyValues<int32_t>(data, values, stride);
+      break;
+    case Int64:
+      CopyValues<int64_t>(data, values, stride);
+      break;
+    case Float32:
+      CopyValues<float>(data, values, stride);
+      break;
+    case Float64:
+      CopyValues<double>(data, values, stride);
+      break;
+    }
+  }
+
+  template <class TStored, class T>
+  void CopyValues(const char* data, T* values, unsigned int stride) const
+  {
+    for (unsigned long i = 0; i < m_NumberOfSamples; ++i)
+    {
+      TStored value;
+      std::memcpy(&value, data + i * sizeof(TStored), sizeof(TStored));
+      values[i * stride] = static_cast<T>(value);
+    }
+  }
+
+  /** Read the header, return the offset of the first column */
+  unsigned long ReadHeader(std::istream& is, const std::string& fileName);
+
+  unsigned long                  m_NumberOfSamples;
+  std::vector<ColumnInfo>        m_Columns;
+  std::vector<std::vector<char>> m_Data;
+};
+
+} // end namespace otb
+
+#endif
@@ -25,6 +25,7 @@ otb_module(OTBSampling
   DEPENDS
     OTBCommon
     OTBConversion
+    OTBGdalAdapters
     OTBImageManipulation
     OTBITK
     OTBStatistics
@@ -0,0 +1,391 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbSampleStore.h"
+#include "otbOGRFeatureWrapper.h"
+#include "itkByteSwapper.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace otb
+{
+
+namespace
+{
+const char* const StoreMagic   = "OTB_SAMPLE_STORE";
+const int         StoreVersion = 1;
+
+/** Columns and data start at a multiple of this size */
+const unsigned long StoreAlignment = 8;
+
+const char* SystemByteOrder()
+{
+  return itk::ByteSwapper<int>::SystemIsBigEndian() ? "big" : "little";
+}
+
+const char* TypeName(SampleStore::ColumnType type)
+{
+  switch (type)
+  {
+  case SampleStore::Int32:
+    return "int32";
+  case SampleStore::Int64:
+    return "int64";
+  case SampleStore::Float32:
+    return "float32";
+  default:
+    return "float64";
+  }
+}
+
+bool TypeFromName(const std::string& name, SampleStore::ColumnType& type)
+{
+  if (name == "int32")
+    type = SampleStore::Int32;
+  else if (name == "int64")
+    type = SampleStore::Int64;
+  else if (name == "float32")
+    type = SampleStore::Float32;
+  else if (name == "float64")
+    type = SampleStore::Float64;
+  else
+    return false;
+  return true;
+}
+
+unsigned long AlignedSize(unsigned long size)
+{
+  return (size + StoreAlignment - 1) / StoreAlignment * StoreAlignment;
+}
+
+template <class T>
+void AppendValue(std::vector<char>& data, T value)
+{
+  const char* bytes = reinterpret_cast<const char*>(&value);
+  data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+/** Read a number stored as text. Fails if the text holds anything else
+ * than the number and surrounding spaces. */
+bool ParseNumber(const char* text, double& value)
+{
+  char* end = nullptr;
+  value     = std::strtod(text, &end);
+  if (end == text)
+  {
+    return false;
+  }
+  while (std::isspace(static_cast<unsigned char>(*end)))
+  {
+    ++end;
+  }
+  return *end == '\0';
+}
+} // namespace
+
+SampleStore::SampleStore() : m_NumberOfSamples(0)
+{
+}
+
+void SampleStore::Clear()
+{
+  m_NumberOfSamples = 0;
+  m_Columns.clear();
+  m_Data.clear();
+}
+
+unsigned long SampleStore::GetNumberOfSamples() const
+{
+  return m_NumberOfSamples;
+}
+
+const std::vector<SampleStore::ColumnInfo>& SampleStore::GetColumns() const
+{
+  return m_Columns;
+}
+
+int SampleStore::GetColumnIndex(const std::string& name) const
+{
+  for (unsigned int i = 0; i < m_Columns.size(); ++i)
+  {
+    if (m_Columns[i].Name == name)
+    {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+bool SampleStore::HasValues() const
+{
+  return m_Data.size() == m_Columns.size();
+}
+
+unsigned int SampleStore::GetTypeSize(ColumnType type)
+{
+  switch (type)
+  {
+  case Int32:
+    return sizeof(int32_t);
+  case Int64:
+    return sizeof(int64_t);
+  case Float32:
+    return sizeof(float);
+  default:
+    return sizeof(double);
+  }
+}
+
+bool SampleStore::CanReadFile(const std::string& fileName)
+{
+  std::ifstream ifs(fileName.c_str(), std::ios::binary);
+  std::string   magic;
+  return ifs && (ifs >> magic) && magic == StoreMagic;
+}
+
+unsigned long SampleStore::ReadHeader(std::istream& is, const std::string& fileName)
+{
+  this->Clear();
+
+  std::string   magic, token, byteOrder;
+  int           version  = 0;
+  unsigned long nbColumns = 0;
+  if (!(is >> magic >> version) || magic != StoreMagic)
+  {
+    itkGenericExceptionMacro(<< fileName << " is not a sample store");
+  }
+  if (version != StoreVersion)
+  {
+    itkGenericExceptionMacro(<< "Unsupported version " << version << " of sample store " << fileName);
+  }
+  if (!(is >> token >> byteOrder) || token != "byteorder")
+  {
+    itkGenericExceptionMacro(<< "Invalid header in sample store " << fileName);
+  }
+  if (byteOrder != SystemByteOrder())
+  {
+    itkGenericExceptionMacro(<< "Sample store " << fileName << " was written with a " << byteOrder << " endian byte order");
+  }
+  if (!(is >> token >> m_NumberOfSamples) || token != "samples" || !(is >> token >> nbColumns) || token != "columns")
+  {
+    itkGenericExceptionMacro(<< "Invalid header in sample store " << fileName);
+  }
+
+  // One column per line: type, then name (which may contain spaces)
+  std::string line;
+  std::getline(is, line);
+  m_Columns.resize(nbColumns);
+  for (auto& column : m_Columns)
+  {
+    std::string typeName;
+    if (!std::getline(is, line))
+    {
+      itkGenericExceptionMacro(<< "Invalid header in sample store " << fileName);
+    }
+    const std::string::size_type sep = line.find(' ');
+    typeName                         = line.substr(0, sep);
+    if (sep == std::string::npos || !TypeFromName(typeName, column.Type))
+    {
+      itkGenericExceptionMacro(<< "Invalid column \"" << line << "\" in sample store " << fileName);
+    }
+    column.Name = line.substr(sep + 1);
+  }
+
+  unsigned long offset = 0;
+  if (!(is >> token >> offset) || token != "data")
+  {
+    itkGenericExceptionMacro(<< "Invalid header in sample store " << fileName);
+  }
+  return offset;
+}
+
+void SampleStore::LoadInformation(const std::string& fileName)
+{
+  std::ifstream ifs(fileName.c_str(), std::ios::binary);
+  if (!ifs)
+  {
+    itkGenericExceptionMacro(<< "Unable to open sample store " << fileName);
+  }
+  this->ReadHeader(ifs, fileName);
+}
+
+void SampleStore::Load(const std::string& fileName)
+{
+  std::ifstream ifs(fileName.c_str(), std::ios::binary);
+  if (!ifs)
+  {
+    itkGenericExceptionMacro(<< "Unable to open sample store " << fileName);
+  }
+  const unsigned long offset = this->ReadHeader(ifs, fileName);
+
+  ifs.seekg(offset);
+  m_Data.resize(m_Columns.size());
+  for (unsigned int i = 0; i < m_Columns.size(); ++i)
+  {
+    const unsigned long size = m_NumberOfSamples * GetTypeSize(m_Columns[i].Type);
+    m_Data[i].resize(size);
+    ifs.read(m_Data[i].data(), size);
+    ifs.seekg(AlignedSize(size) - size, std::ios::cur);
+    if (!ifs)
+    {
+      m_Data.clear();
+      itkGenericExceptionMacro(<< "Unable to read column " << m_Columns[i].Name << " of sample store " << fileName);
+    }
+  }
+}
+
+void SampleStore::Save(const std::string& fileName) const
+{
+  if (!this->HasValues())
+  {
+    itkGenericExceptionMacro(<< "Values of the sample store are not loaded");
+  }
+
+  std::ostringstream header;
+  header << StoreMagic << " " << StoreVersion << "\n";
+  header << "byteorder " << SystemByteOrder() << "\n";
+  header << "samples " << m_NumberOfSamples << "\n";
+  header << "columns " << m_Columns.size() << "\n";
+  for (const auto& column : m_Columns)
+  {
+    header << TypeName(column.Type) << " " << column.Name << "\n";
+  }
+
+  // The offset is written on a fixed width, so that it can be computed
+  // before writing it
+  char         dataLine[32];
+  const size_t dataLineSize = std::snprintf(dataLine, sizeof(dataLine), "data %016lu\n", 0ul);
+  const unsigned long offset = AlignedSize(header.str().size() + dataLineSize);
+  std::snprintf(dataLine, sizeof(dataLine), "data %016lu\n", offset);
+  header << dataLine;
+
+  std::ofstream ofs(fileName.c_str(), std::ios::binary);
+  if (!ofs)
+  {
+    itkGenericExceptionMacro(<< "Unable to write sample store " << fileName);
+  }
+
+  const std::string      headerString = header.str();
+  const std::vector<char> padding(StoreAlignment, '\n');
+  ofs.write(headerString.data(), headerString.size());
+  ofs.write(padding.data(), offset - headerString.size());
+  for (const auto& data : m_Data)
+  {
+    ofs.write(data.data(), data.size());
+    ofs.write(padding.data(), AlignedSize(data.size()) - data.size());
+  }
+
+  if (!ofs)
+  {
+    itkGenericExceptionMacro(<< "Error while writing sample store " << fileName);
+  }
+}
+
+void SampleStore::ImportLayer(ogr::Layer& layer, const std::vector<std::string>& fieldNames)
+{
+  this->Clear();
+
+  OGRFeatureDefn&   layerDefn = layer.GetLayerDefn();
+  std::vector<int>  fieldIndex(fieldNames.size());
+  std::vector<bool> isString(fieldNames.size(), false);
+  m_Columns.resize(fieldNames.size());
+  for (unsigned int k = 0; k < fieldNames.size(); ++k)
+  {
+    fieldIndex[k] = layerDefn.GetFieldIndex(fieldNames[k].c_str());
+    if (fieldIndex[k] < 0)
+    {
+      itkGenericExceptionMacro(<< "Field " << fieldNames[k] << " not found in layer " << layer.GetName());
+    }
+    m_Columns[k].Name = fieldNames[k];
+    switch (layerDefn.GetFieldDefn(fieldIndex[k])->GetType())
+    {
+    case OFTInteger:
+      m_Columns[k].Type = Int32;
+      break;
+    case OFTInteger64:
+      m_Columns[k].Type = Int64;
+      break;
+    case OFTString:
+      isString[k]       = true;
+      m_Columns[k].Type = Float64;
+      break;
+    case OFTReal:
+      m_Columns[k].Type = Float64;
+      break;
+    default:
+      itkGenericExceptionMacro(<< "Field " << fieldNames[k] << " of layer " << layer.GetName() << " has an unsupported type");
+    }
+  }
+
+  m_Data.resize(m_Columns.size());
+  const int nbFeatures = layer.GetFeatureCount(false);
+  if (nbFeatures > 0)
+  {
+    for (unsigned int k = 0; k < m_Columns.size(); ++k)
+    {
+      m_Data[k].reserve(nbFeatures * GetTypeSize(m_Columns[k].Type));
+    }
+  }
+
+  for (auto featIt = layer.cbegin(); featIt != layer.cend(); ++featIt)
+  {
+    OGRFeature& feature = featIt->ogr();
+    for (unsigned int k = 0; k < m_Columns.size(); ++k)
+    {
+      const bool isSet = feature.IsFieldSet(fieldIndex[k]);
+      switch (m_Columns[k].Type)
+      {
+      case Int32:
+        AppendValue<int32_t>(m_Data[k], isSet ? feature.GetFieldAsInteger(fieldIndex[k]) : 0);
+        break;
+      case Int64:
+        AppendValue<int64_t>(m_Data[k], isSet ? feature.GetFieldAsInteger64(fieldIndex[k]) : 0);
+        break;
+      default:
+      {
+        double value = 0.;
+        if (isSet && isString[k])
+        {
+          // Labels stored as text must be numbers: GetFieldAsDouble() would
+          // silently turn any other text into 0
+          if (!ParseNumber(feature.GetFieldAsString(fieldIndex[k]), value))
+          {
+            itkGenericExceptionMacro(<< "Field " << fieldNames[k] << " of feature " << feature.GetFID() << " of layer " << layer.GetName()
+                                     << " holds the non numeric value \"" << feature.GetFieldAsString(fieldIndex[k]) << "\"");
+          }
+        }
+        else if (isSet)
+        {
+          value = feature.GetFieldAsDouble(fieldIndex[k]);
+        }
+        AppendValue<double>(m_Data[k], value);
+        break;
+      }
+      }
+    }
+    ++m_NumberOfSamples;
+  }
+}
+
+} // end namespace otb
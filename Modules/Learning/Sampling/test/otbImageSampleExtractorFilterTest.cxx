@@ -25,6 +25,42 @@
 #include "otbStopwatch.h"
 #include "itkPhysicalPointImageSource.h"
 #include <fstream>
+#include <limits>
+
+namespace
+{
+typedef otb::VectorImage<float> SampledImageType;
+
+/** Image source recording the smallest region requested on its output */
+class RequestedRegionRecordingSource : public itk::PhysicalPointImageSource<SampledImageType>
+{
+public:
+  typedef RequestedRegionRecordingSource                  Self;
+  typedef itk::PhysicalPointImageSource<SampledImageType> Superclass;
+  typedef itk::SmartPointer<Self>                         Pointer;
+
+  itkNewMacro(Self);
+
+  unsigned long GetMinimumRequestedPixels() const
+  {
+    return m_MinimumRequestedPixels;
+  }
+
+protected:
+  RequestedRegionRecordingSource() : m_MinimumRequestedPixels(std::numeric_limits<unsigned long>::max())
+  {
+  }
+
+  void EnlargeOutputRequestedRegion(itk::DataObject* output) override
+  {
+    Superclass::EnlargeOutputRequestedRegion(output);
+    m_MinimumRequestedPixels = std::min<unsigned long>(m_MinimumRequestedPixels, this->GetOutput()->GetRequestedRegion().GetNumberOfPixels());
+  }
+
+private:
+  unsigned long m_MinimumRequestedPixels;
+};
+}
 
 
 int otbImageSampleExtractorFilter(int argc, char* argv[])
@@ -173,3 +209,78 @@ int otbImageSampleExtractorFilterUpdate(int argc, char* argv[])
 
   return EXIT_SUCCESS;
 }
+
+int otbImageSampleExtractorFilterEmptyRegions(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  typedef otb::ImageSampleExtractorFilter<SampledImageType> FilterType;
+
+  // Samples at the centre of pixels of the first 5 lines only
+  otb::ogr::DataSource::Pointer vectors = otb::ogr::DataSource::New();
+  otb::ogr::Layer               inLayer = vectors->CreateLayer("samples", nullptr, wkbPoint);
+  OGRFieldDefn                  labelField("label", OFTInteger);
+  inLayer.CreateField(labelField, true);
+  for (int i = 0; i < 10; ++i)
+  {
+    otb::ogr::Feature feature(inLayer.GetLayerDefn());
+    OGRPoint          point(0.5 + 7 * i, 0.5 - (i % 5));
+    feature.SetGeometry(&point);
+    feature["label"].SetValue(i);
+    inLayer.CreateFeature(feature);
+  }
+
+  otb::ogr::DataSource::Pointer output = otb::ogr::DataSource::New();
+
+  SampledImageType::SizeType size;
+  size[0] = 99;
+  size[1] = 50;
+
+  SampledImageType::PointType origin;
+  origin.Fill(0.5);
+
+  SampledImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = -1.0;
+
+  RequestedRegionRecordingSource::Pointer imgSource = RequestedRegionRecordingSource::New();
+  imgSource->SetSize(size);
+  imgSource->SetSpacing(spacing);
+  imgSource->SetOrigin(origin);
+
+  // Strips of 5 lines: only the first one holds samples
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(imgSource->GetOutput());
+  filter->SetLayerIndex(0);
+  filter->SetSamplePositions(vectors);
+  filter->SetOutputSamples(output);
+  filter->SetClassFieldName("label");
+  filter->SetOutputFieldPrefix("measure_");
+  filter->GetStreamer()->SetNumberOfLinesStrippedStreaming(5);
+  filter->Update();
+
+  if (imgSource->GetMinimumRequestedPixels() == 0)
+  {
+    std::cerr << "An empty region was requested to the input image" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The values of the physical point image are the sample positions
+  otb::ogr::Layer outLayer  = output->GetLayer(0);
+  int             nbSamples = 0;
+  for (otb::ogr::Layer::const_iterator featIt = outLayer.begin(); featIt != outLayer.end(); ++featIt, ++nbSamples)
+  {
+    const OGRPoint* point = dynamic_cast<const OGRPoint*>(featIt->GetGeometry());
+    if (point == nullptr || (*featIt)["measure_0"].GetValue<double>() != point->getX() || (*featIt)["measure_1"].GetValue<double>() != point->getY())
+    {
+      std::cerr << "Wrong values for sample #" << nbSamples << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (nbSamples != 10)
+  {
+    std::cerr << "Got " << nbSamples << " samples instead of 10" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbSampleStore.h"
+#include "otbOGRDataSourceWrapper.h"
+#include "otbOGRFeatureWrapper.h"
+
+int otbSampleStore(int argc, char* argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " input_vectors output_store field1 [field2 ...]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> fieldNames(argv + 3, argv + argc);
+
+  otb::ogr::DataSource::Pointer vectors = otb::ogr::DataSource::New(argv[1], otb::ogr::DataSource::Modes::Read);
+  otb::ogr::Layer               layer   = vectors->GetLayer(0);
+
+  otb::SampleStore store;
+  store.ImportLayer(layer, fieldNames);
+  store.Save(argv[2]);
+
+  if (!otb::SampleStore::CanReadFile(argv[2]) || otb::SampleStore::CanReadFile(argv[1]))
+  {
+    std::cout << "Wrong detection of sample store files" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Read back
+  otb::SampleStore storeCheck;
+  storeCheck.Load(argv[2]);
+  const unsigned long nbSamples = storeCheck.GetNumberOfSamples();
+  if (nbSamples != static_cast<unsigned long>(layer.GetFeatureCount(true)) || storeCheck.GetColumns().size() != fieldNames.size())
+  {
+    std::cout << "Wrong number of samples or columns: " << nbSamples << " x " << storeCheck.GetColumns().size() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<unsigned int> columns(fieldNames.size());
+  for (unsigned int k = 0; k < fieldNames.size(); ++k)
+  {
+    columns[k] = storeCheck.GetColumnIndex(fieldNames[k]);
+  }
+  std::vector<double> samples(nbSamples * columns.size());
+  storeCheck.GetSamples(columns, samples.data());
+
+  unsigned long sample = 0;
+  for (auto featIt = layer.cbegin(); featIt != layer.cend(); ++featIt, ++sample)
+  {
+    for (unsigned int k = 0; k < fieldNames.size(); ++k)
+    {
+      const double expected = featIt->ogr().GetFieldAsDouble(fieldNames[k].c_str());
+      if (samples[sample * columns.size() + k] != expected)
+      {
+        std::cout << "Wrong value for sample " << sample << ", field " << fieldNames[k] << ": " << samples[sample * columns.size() + k] << " instead of "
+                  << expected << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // Labels stored as text are read as numbers, other text is rejected
+  otb::ogr::DataSource::Pointer labels     = otb::ogr::DataSource::New();
+  otb::ogr::Layer               labelLayer = labels->CreateLayer("labels", nullptr, wkbPoint);
+  OGRFieldDefn                  labelField("label", OFTString);
+  labelLayer.CreateField(labelField, true);
+  const char* const labelValues[] = {"12", " 3.5 ", "water"};
+  for (const char* value : labelValues)
+  {
+    otb::ogr::Feature feature(labelLayer.GetLayerDefn());
+    feature["label"].SetValue(std::string(value));
+    labelLayer.CreateFeature(feature);
+  }
+
+  const std::vector<std::string> labelNames(1, "label");
+  otb::SampleStore               labelStore;
+  bool                           rejected = false;
+  try
+  {
+    labelStore.ImportLayer(labelLayer, labelNames);
+  }
+  catch (itk::ExceptionObject&)
+  {
+    rejected = true;
+  }
+  if (!rejected)
+  {
+    std::cout << "A non numeric label should be rejected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  labelLayer.DeleteFeature(2);
+  labelStore.ImportLayer(labelLayer, labelNames);
+  std::vector<double> labelSamples(labelStore.GetNumberOfSamples());
+  labelStore.GetColumn(0, labelSamples.data());
+  if (labelSamples.size() != 2 || labelSamples[0] != 12. || labelSamples[1] != 3.5)
+  {
+    std::cout << "Wrong values for the numeric labels stored as text" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -28,5 +28,7 @@ void RegisterTests()
   REGISTER_TEST(otbOGRDataToClassStatisticsFilter);
   REGISTER_TEST(otbImageSampleExtractorFilter);
   REGISTER_TEST(otbImageSampleExtractorFilterUpdate);
+  REGISTER_TEST(otbImageSampleExtractorFilterEmptyRegions);
   REGISTER_TEST(otbSamplingRateCalculatorList);
+  REGISTER_TEST(otbSampleStore);
 }
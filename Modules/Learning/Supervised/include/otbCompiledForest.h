@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbCompiledForest_h
+#define otbCompiledForest_h
+
+#include "otbOpenCVUtils.h"
+#include <vector>
+#include <cstddef>
+
+namespace otb
+{
+
+/** \class CompiledForest
+ * \brief Flat, cache-friendly representation of a trained OpenCV forest
+ *
+ * The trees of a cv::ml::DTrees based forest (random trees) are compiled into
+ * contiguous arrays (structure of arrays). Each tree is stored in pre-order,
+ * so that the left child of a split node is always the next node and only the
+ * right child offset needs to be stored:
+ *
+ * - m_Feature: index of the tested feature, or -1 for a leaf
+ * - m_Threshold: split threshold (the sample goes left if value <= threshold),
+ *   or the leaf value (class label or regression value) for a leaf
+ * - m_Right: index of the right child, or the class index for a leaf
+ *
+ * Samples are evaluated by blocks, tree by tree, so that the nodes of a tree
+ * stay in cache while a whole block is pushed through it.
+ *
+ * Only numerical splits are supported: Compile() returns false for a forest
+ * with categorical splits, in which case the caller should keep using the
+ * OpenCV implementation. Missing values are not handled either. The tested
+ * feature is read at the split variable index, so Compile() also returns
+ * false for a forest trained on a subset or a permutation of the variables.
+ *
+ * \ingroup OTBSupervised
+ */
+class OTBSupervised_EXPORT CompiledForest
+{
+public:
+  CompiledForest();
+
+  /** Build the flat representation from a trained forest. Returns false (and
+   *  leaves the object empty) if the forest can not be compiled. */
+  bool Compile(const cv::ml::DTrees& forest);
+
+  /** Release the compiled representation */
+  void Clear();
+
+  bool IsCompiled() const
+  {
+    return !m_Roots.empty();
+  }
+
+  unsigned int GetNumberOfTrees() const
+  {
+    return static_cast<unsigned int>(m_Roots.size());
+  }
+
+  unsigned int GetNumberOfNodes() const
+  {
+    return static_cast<unsigned int>(m_Feature.size());
+  }
+
+  /** Predict nbSamples samples, stored row by row in samples with a stride of
+   *  stride floats between two consecutive samples. The label (or regression
+   *  value) is written in results. If confidence is not null, the proportion
+   *  of votes for the majority class (or the normalized difference between the
+   *  two most voted classes if computeMargin is true) is written in it, as in
+   *  CvRTreesWrapper::predict_confidence() and predict_margin(). */
+  void Predict(const float* samples, std::size_t nbSamples, std::size_t stride, float* results, float* confidence = nullptr,
+               bool computeMargin = false) const;
+
+  /** Number of samples pushed together through each tree */
+  static const std::size_t BlockSize = 64;
+
+private:
+  std::vector<int>   m_Roots;
+  std::vector<int>   m_Feature;
+  std::vector<float> m_Threshold;
+  std::vector<int>   m_Right;
+
+  /** Class label for each class index (classification only) */
+  std::vector<float> m_ClassLabels;
+
+  bool m_IsClassifier;
+};
+
+} // end namespace otb
+
+#endif
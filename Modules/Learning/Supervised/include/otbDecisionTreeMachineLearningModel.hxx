@@ -42,7 +42,8 @@ DecisionTreeMachineLearningModel<TInputValue, TOutputValue>::DecisionTreeMachine
     m_Use1seRule(true),
     m_TruncatePrunedTree(true)
 {
-  this->m_IsRegressionSupported = true;
+  this->m_IsRegressionSupported         = true;
+  this->m_IsDoPredictBatchMultiThreaded = true;
 }
 
 /** Train the machine learning model */
@@ -102,6 +103,32 @@ DecisionTreeMachineLearningModel<TInputValue, TOutputValue>::DoPredict(const Inp
   return target;
 }
 
+template <class TInputValue, class TOutputValue>
+void DecisionTreeMachineLearningModel<TInputValue, TOutputValue>::DoPredictBatch(const InputListSampleType* input, const unsigned int& startIndex,
+                                                                                 const unsigned int& size, TargetListSampleType* targets,
+                                                                                 ConfidenceListSampleType* quality, ProbaListSampleType* proba) const
+{
+  assert(targets != nullptr);
+
+  cv::Mat samples;
+  otb::PrepareBatchPrediction(this, input, startIndex, size, quality, proba, samples);
+
+  // Nothing may throw inside the stripes: all checks are done in PrepareBatchPrediction
+  auto predictStripe = [&](int begin, int end) {
+    cv::Mat results;
+    m_DTreeModel->predict(samples.rowRange(begin, end), results);
+
+    for (int i = begin; i < end; ++i)
+    {
+      TargetSampleType target;
+      target[0] = static_cast<TOutputValue>(results.at<float>(i - begin, 0));
+      targets->SetMeasurementVector(startIndex + i, target);
+    }
+  };
+
+  otb::ParallelForRowRanges(samples.rows, predictStripe);
+}
+
 template <class TInputValue, class TOutputValue>
 void DecisionTreeMachineLearningModel<TInputValue, TOutputValue>::Save(const std::string& filename, const std::string& name)
 {
@@ -26,7 +26,9 @@
 #include "otbOpenCVUtils.h"
 
 #include <fstream>
+#include <algorithm>
 #include <set>
+#include <vector>
 #include "itkMacro.h"
 
 namespace otb
@@ -39,8 +41,9 @@ KNearestNeighborsMachineLearningModel<TInputValue, TTargetValue>::KNearestNeighb
     m_K(32),
     m_DecisionRule(KNN_VOTING)
 {
-  this->m_ConfidenceIndex       = true;
-  this->m_IsRegressionSupported = true;
+  this->m_ConfidenceIndex               = true;
+  this->m_IsRegressionSupported         = true;
+  this->m_IsDoPredictBatchMultiThreaded = true;
 }
 
 /** Train the machine learning model */
@@ -133,6 +136,55 @@ KNearestNeighborsMachineLearningModel<TInputValue, TTargetValue>::DoPredict(cons
   return target;
 }
 
+template <class TInputValue, class TTargetValue>
+void KNearestNeighborsMachineLearningModel<TInputValue, TTargetValue>::DoPredictBatch(const InputListSampleType* input, const unsigned int& startIndex,
+                                                                                      const unsigned int& size, TargetListSampleType* targets,
+                                                                                      ConfidenceListSampleType* quality, ProbaListSampleType* proba) const
+{
+  assert(targets != nullptr);
+
+  // quality is only computed in classification mode
+  assert(quality == nullptr || !this->m_RegressionMode);
+
+  cv::Mat samples;
+  otb::PrepareBatchPrediction(this, input, startIndex, size, quality, proba, samples);
+
+  // Nothing may throw inside the stripes: all checks are done in PrepareBatchPrediction
+  auto predictStripe = [&](int begin, int end) {
+    cv::Mat results;
+    cv::Mat nearest;
+    m_KNearestModel->findNearest(samples.rowRange(begin, end), m_K, results, nearest, cv::noArray());
+
+    std::vector<float> values(m_K);
+    for (int i = begin; i < end; ++i)
+    {
+      const float* neighbors = nearest.ptr<float>(i - begin);
+      float        result    = results.at<float>(i - begin, 0);
+
+      if (quality != nullptr)
+      {
+        ConfidenceSampleType confidence;
+        confidence[0] = static_cast<ConfidenceValueType>(std::count(neighbors, neighbors + m_K, result));
+        quality->SetMeasurementVector(startIndex + i, confidence);
+      }
+
+      // MEDIAN decision rule is handled here, see DoPredict()
+      if (this->m_DecisionRule == KNN_MEDIAN)
+      {
+        values.assign(neighbors, neighbors + m_K);
+        std::nth_element(values.begin(), values.begin() + (m_K >> 1), values.end());
+        result = values[m_K >> 1];
+      }
+
+      TargetSampleType target;
+      target[0] = static_cast<TTargetValue>(result);
+      targets->SetMeasurementVector(startIndex + i, target);
+    }
+  };
+
+  otb::ParallelForRowRanges(samples.rows, predictStripe);
+}
+
 template <class TInputValue, class TTargetValue>
 void KNearestNeighborsMachineLearningModel<TInputValue, TTargetValue>::Save(const std::string& filename, const std::string& name)
 {
@@ -301,9 +301,11 @@ void LibSVMMachineLearningModel<TInputValue, TOutputValue>::BuildProblem()
   m_Problem.l = probl;
   m_Problem.y = new double[probl];
   m_Problem.x = new struct svm_node*[probl];
-  for (int i = 0; i < probl; ++i)
+  // LibSVM needs its own (index, value) nodes, allocate them in one block
+  m_Problem.x[0] = new struct svm_node[static_cast<size_t>(probl) * (elements + 1)];
+  for (int i = 1; i < probl; ++i)
   {
-    m_Problem.x[i] = new struct svm_node[elements + 1];
+    m_Problem.x[i] = m_Problem.x[0] + static_cast<size_t>(i) * (elements + 1);
   }
 
   // Iterate on the samples
@@ -368,12 +370,10 @@ void LibSVMMachineLearningModel<TInputValue, TOutputValue>::DeleteProblem()
   }
   if (m_Problem.x)
   {
-    for (int i = 0; i < m_Problem.l; ++i)
+    // Nodes of all the samples are allocated in one block (see BuildProblem())
+    if (m_Problem.l > 0)
     {
-      if (m_Problem.x[i])
-      {
-        delete[] m_Problem.x[i];
-      }
+      delete[] m_Problem.x[0];
     }
     delete[] m_Problem.x;
     m_Problem.x = nullptr;
@@ -44,8 +44,9 @@ NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::NeuralNetworkMachi
     m_MaxIter(1000),
     m_Epsilon(0.01)
 {
-  this->m_ConfidenceIndex       = true;
-  this->m_IsRegressionSupported = true;
+  this->m_ConfidenceIndex               = true;
+  this->m_IsRegressionSupported         = true;
+  this->m_IsDoPredictBatchMultiThreaded = true;
 }
 
 /** Sets the topology of the NN */
@@ -238,6 +239,69 @@ NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::DoPredict(const In
   return target;
 }
 
+template <class TInputValue, class TOutputValue>
+void NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::DoPredictBatch(const InputListSampleType* input, const unsigned int& startIndex,
+                                                                                  const unsigned int& size, TargetListSampleType* targets,
+                                                                                  ConfidenceListSampleType* quality, ProbaListSampleType* proba) const
+{
+  assert(targets != nullptr);
+
+  cv::Mat samples;
+  otb::PrepareBatchPrediction(this, input, startIndex, size, quality, proba, samples);
+
+  // Nothing may throw inside the stripes: all checks are done in PrepareBatchPrediction
+  auto predictStripe = [&](int begin, int end) {
+    cv::Mat responses;
+    m_ANNModel->predict(samples.rowRange(begin, end), responses);
+
+    const unsigned int nbClasses = m_MatrixOfLabels.size[1];
+
+    for (int i = begin; i < end; ++i)
+    {
+      const float*     response    = responses.ptr<float>(i - begin);
+      float            maxResponse = response[0];
+      TargetSampleType target;
+
+      if (this->m_RegressionMode)
+      {
+        // MODE REGRESSION : only output first response
+        target[0] = maxResponse;
+        targets->SetMeasurementVector(startIndex + i, target);
+        continue;
+      }
+
+      // MODE CLASSIFICATION : find the highest response
+      float secondResponse = -1e10;
+      target[0]            = m_MatrixOfLabels.at<TOutputValue>(0);
+
+      for (unsigned int itLabel = 1; itLabel < nbClasses; ++itLabel)
+      {
+        const float currentResponse = response[itLabel];
+        if (currentResponse > maxResponse)
+        {
+          secondResponse = maxResponse;
+          maxResponse    = currentResponse;
+          target[0]      = m_MatrixOfLabels.at<TOutputValue>(itLabel);
+        }
+        else if (currentResponse > secondResponse)
+        {
+          secondResponse = currentResponse;
+        }
+      }
+      targets->SetMeasurementVector(startIndex + i, target);
+
+      if (quality != nullptr)
+      {
+        ConfidenceSampleType confidence;
+        confidence[0] = static_cast<ConfidenceValueType>(maxResponse) - static_cast<ConfidenceValueType>(secondResponse);
+        quality->SetMeasurementVector(startIndex + i, confidence);
+      }
+    }
+  };
+
+  otb::ParallelForRowRanges(samples.rows, predictStripe);
+}
+
 template <class TInputValue, class TOutputValue>
 void NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::Save(const std::string& filename, const std::string& name)
 {
@@ -33,6 +33,7 @@ template <class TInputValue, class TOutputValue>
 NormalBayesMachineLearningModel<TInputValue, TOutputValue>::NormalBayesMachineLearningModel()
   : m_NormalBayesModel(cv::ml::NormalBayesClassifier::create())
 {
+  this->m_IsDoPredictBatchMultiThreaded = true;
 }
 
 /** Train the machine learning model */
@@ -83,6 +84,34 @@ NormalBayesMachineLearningModel<TInputValue, TOutputValue>::DoPredict(const Inpu
   return target;
 }
 
+template <class TInputValue, class TOutputValue>
+void NormalBayesMachineLearningModel<TInputValue, TOutputValue>::DoPredictBatch(const InputListSampleType* input, const unsigned int& startIndex,
+                                                                                const unsigned int& size, TargetListSampleType* targets,
+                                                                                ConfidenceListSampleType* quality, ProbaListSampleType* proba) const
+{
+  assert(targets != nullptr);
+
+  cv::Mat samples;
+  otb::PrepareBatchPrediction(this, input, startIndex, size, quality, proba, samples);
+
+  // Nothing may throw inside the stripes: all checks are done in PrepareBatchPrediction
+  auto predictStripe = [&](int begin, int end) {
+    cv::Mat results;
+    m_NormalBayesModel->predict(samples.rowRange(begin, end), results);
+    // NormalBayesClassifier outputs integer labels
+    results.convertTo(results, CV_32F);
+
+    for (int i = begin; i < end; ++i)
+    {
+      TargetSampleType target;
+      target[0] = static_cast<TOutputValue>(results.at<float>(i - begin, 0));
+      targets->SetMeasurementVector(startIndex + i, target);
+    }
+  };
+
+  otb::ParallelForRowRanges(samples.rows, predictStripe);
+}
+
 template <class TInputValue, class TOutputValue>
 void NormalBayesMachineLearningModel<TInputValue, TOutputValue>::Save(const std::string& filename, const std::string& name)
 {
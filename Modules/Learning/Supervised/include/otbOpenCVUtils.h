@@ -46,6 +46,12 @@
 #include "OTBSupervisedExport.h"
 
 #include "itkListSample.h"
+#include "itkMacro.h"
+#include "itkMultiThreader.h"
+#include "otbDenseListSample.h"
+
+#include <algorithm>
+#include <cassert>
 
 #define CV_TYPE_NAME_ML_SVM "opencv-ml-svm"
 #define CV_TYPE_NAME_ML_RTREES "opencv-ml-random-trees"
@@ -78,6 +84,51 @@ void SampleToMat(const T& sample, cv::Mat& output)
 }
 
 
+/** Fast path of the ListSample conversions below: if the list sample is a
+ *  contiguous DenseListSample, the output matrix shares its buffer (float
+ *  samples) or converts it in one call (double samples). Returns false
+ *  for other list samples.
+ */
+template <class T>
+bool DenseListSampleRangeToMat(const T*, unsigned int, unsigned int, cv::Mat&)
+{
+  return false;
+}
+
+template <class TValue>
+bool DenseBufferRangeToMat(const itk::Statistics::ListSample<itk::VariableLengthVector<TValue>>* listSample, unsigned int startIndex, unsigned int size,
+                           cv::Mat& output)
+{
+  const TValue* buffer = GetDenseBuffer(listSample);
+  if (buffer == nullptr || size == 0)
+  {
+    return false;
+  }
+  const unsigned int sampleSize = listSample->GetMeasurementVectorSize();
+  cv::Mat            dense(size, sampleSize, cv::DataType<TValue>::type, const_cast<TValue*>(buffer) + static_cast<size_t>(startIndex) * sampleSize);
+  if (dense.type() == CV_32FC1)
+  {
+    output = dense;
+  }
+  else
+  {
+    dense.convertTo(output, CV_32F);
+  }
+  return true;
+}
+
+inline bool DenseListSampleRangeToMat(const itk::Statistics::ListSample<itk::VariableLengthVector<float>>* listSample, unsigned int startIndex,
+                                      unsigned int size, cv::Mat& output)
+{
+  return DenseBufferRangeToMat(listSample, startIndex, size, output);
+}
+
+inline bool DenseListSampleRangeToMat(const itk::Statistics::ListSample<itk::VariableLengthVector<double>>* listSample, unsigned int startIndex,
+                                      unsigned int size, cv::Mat& output)
+{
+  return DenseBufferRangeToMat(listSample, startIndex, size, output);
+}
+
 /** Converts a ListSample of VariableLengthVector to a CvMat. The user
  *  is responsible for freeing the output pointer with the
  *  cvReleaseMat function.  A null pointer is resturned in case the
@@ -92,6 +143,11 @@ void ListSampleToMat(const T* listSample, cv::Mat& output)
   // Check for valid listSample
   if (listSample != nullptr && listSample->Size() > 0)
   {
+    if (DenseListSampleRangeToMat(listSample, 0, listSample->Size(), output))
+    {
+      return;
+    }
+
     // Retrieve samples count
     unsigned int sampleCount = listSample->Size();
 
@@ -131,6 +187,97 @@ void ListSampleToMat(typename T::ConstPointer listSample, cv::Mat& output)
   return ListSampleToMat(listSample.GetPointer(), output);
 }
 
+/** Converts the range [startIndex, startIndex + size[ of a ListSample
+ *  into a single contiguous CV_32FC1 matrix (one sample per row), so
+ *  that a whole batch can be handed to the OpenCV predict methods.
+ */
+template <class T>
+void ListSampleRangeToMat(const T* listSample, unsigned int startIndex, unsigned int size, cv::Mat& output)
+{
+  if (DenseListSampleRangeToMat(listSample, startIndex, size, output))
+  {
+    return;
+  }
+
+  const unsigned int sampleSize = listSample->GetMeasurementVectorSize();
+
+  output.create(size, sampleSize, CV_32FC1);
+
+  for (unsigned int sampleIdx = 0; sampleIdx < size; ++sampleIdx)
+  {
+    const typename T::MeasurementVectorType& sample = listSample->GetMeasurementVector(startIndex + sampleIdx);
+
+    float* row = output.ptr<float>(sampleIdx);
+    for (unsigned int i = 0; i < sampleSize; ++i)
+    {
+      row[i] = static_cast<float>(sample[i]);
+    }
+  }
+}
+
+/** Common prologue of the DoPredictBatch methods of the OpenCV based
+ *  models: check the requested range and the requested outputs against
+ *  the model capabilities, then convert the whole batch into a single
+ *  contiguous matrix. All checks are done here, so that the prediction
+ *  stripes run afterwards have nothing left to throw.
+ */
+template <class TModel>
+void PrepareBatchPrediction(const TModel* model, const typename TModel::InputListSampleType* input, unsigned int startIndex, unsigned int size,
+                            const typename TModel::ConfidenceListSampleType* quality, const typename TModel::ProbaListSampleType* proba, cv::Mat& samples)
+{
+  assert(input != nullptr);
+
+  if (startIndex + size > input->Size())
+  {
+    itkGenericExceptionMacro(<< model->GetNameOfClass() << ": requested range [" << startIndex << ", " << startIndex + size
+                             << "[ partially outside input sample list range.[0," << input->Size() << "[");
+  }
+  if (quality != nullptr && !model->HasConfidenceIndex())
+    itkGenericExceptionMacro(<< model->GetNameOfClass() << ": Confidence index not available for this classifier !");
+  if (proba != nullptr && !model->HasProbaIndex())
+    itkGenericExceptionMacro(<< model->GetNameOfClass() << ": Probability per class not available for this classifier !");
+
+  ListSampleRangeToMat(input, startIndex, size, samples);
+}
+
+/** \class OpenCVRowRangeInvoker
+ *  \brief Adapts a functor taking a [begin, end[ row range to cv::ParallelLoopBody
+ *
+ * \ingroup OTBSupervised
+ */
+template <class TFunctor>
+class OpenCVRowRangeInvoker : public cv::ParallelLoopBody
+{
+public:
+  explicit OpenCVRowRangeInvoker(const TFunctor& functor) : m_Functor(functor)
+  {
+  }
+
+  void operator()(const cv::Range& range) const override
+  {
+    m_Functor(range.start, range.end);
+  }
+
+private:
+  const TFunctor& m_Functor;
+};
+
+/** Split the rows [0, nbRows[ into stripes and process them with the
+ *  OpenCV parallel framework. The number of stripes follows the ITK
+ *  global number of threads. The functor receives a [begin, end[ row
+ *  range and must not throw.
+ */
+template <class TFunctor>
+void ParallelForRowRanges(int nbRows, const TFunctor& functor)
+{
+  if (nbRows <= 0)
+  {
+    return;
+  }
+  const int nbStripes = std::max(1, std::min(nbRows, static_cast<int>(itk::MultiThreader::GetGlobalDefaultNumberOfThreads())));
+  cv::parallel_for_(cv::Range(0, nbRows), OpenCVRowRangeInvoker<TFunctor>(functor), nbStripes);
+}
+
 template <typename T>
 typename T::Pointer MatToListSample(const cv::Mat& cvmat)
 {
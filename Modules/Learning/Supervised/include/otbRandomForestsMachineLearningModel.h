@@ -28,6 +28,7 @@
 #include "otbMachineLearningModel.h"
 #include "itkVariableSizeMatrix.h"
 #include "otbCvRTreesWrapper.h"
+#include "otbCompiledForest.h"
 
 namespace otb
 {
@@ -42,14 +43,17 @@ public:
   typedef itk::SmartPointer<Self>       Pointer;
   typedef itk::SmartPointer<const Self> ConstPointer;
 
-  typedef typename Superclass::InputValueType       InputValueType;
-  typedef typename Superclass::InputSampleType      InputSampleType;
-  typedef typename Superclass::InputListSampleType  InputListSampleType;
-  typedef typename Superclass::TargetValueType      TargetValueType;
-  typedef typename Superclass::TargetSampleType     TargetSampleType;
-  typedef typename Superclass::TargetListSampleType TargetListSampleType;
-  typedef typename Superclass::ConfidenceValueType  ConfidenceValueType;
-  typedef typename Superclass::ProbaSampleType      ProbaSampleType;
+  typedef typename Superclass::InputValueType           InputValueType;
+  typedef typename Superclass::InputSampleType          InputSampleType;
+  typedef typename Superclass::InputListSampleType      InputListSampleType;
+  typedef typename Superclass::TargetValueType          TargetValueType;
+  typedef typename Superclass::TargetSampleType         TargetSampleType;
+  typedef typename Superclass::TargetListSampleType     TargetListSampleType;
+  typedef typename Superclass::ConfidenceValueType      ConfidenceValueType;
+  typedef typename Superclass::ConfidenceSampleType     ConfidenceSampleType;
+  typedef typename Superclass::ConfidenceListSampleType ConfidenceListSampleType;
+  typedef typename Superclass::ProbaSampleType          ProbaSampleType;
+  typedef typename Superclass::ProbaListSampleType      ProbaListSampleType;
   // Other
   typedef itk::VariableSizeMatrix<float> VariableImportanceMatrixType;
 
@@ -123,6 +127,20 @@ public:
   itkGetMacro(ComputeMargin, bool);
   itkSetMacro(ComputeMargin, bool);
 
+  /** Use a flat, compiled copy of the forest (see CompiledForest) for
+   *  prediction instead of the OpenCV implementation. The forest is compiled
+   *  when the option is set and after each Train() or Load(). If the forest
+   *  can not be compiled, the OpenCV implementation is used. */
+  itkGetMacro(UseCompiledForest, bool);
+  void SetUseCompiledForest(bool use);
+  itkBooleanMacro(UseCompiledForest);
+
+  /** Is the compiled forest actually used for prediction ? */
+  bool IsCompiledForestUsed() const
+  {
+    return m_CompiledForest.IsCompiled();
+  }
+
   /** Returns a matrix containing variable importance */
   VariableImportanceMatrixType GetVariableImportance();
 
@@ -138,6 +156,11 @@ protected:
   /** Predict values using the model */
   TargetSampleType DoPredict(const InputSampleType& input, ConfidenceValueType* quality = nullptr, ProbaSampleType* proba = nullptr) const override;
 
+  /** Predict a whole batch at once: the batch is converted to a single
+   *  cv::Mat and processed in parallel stripes */
+  void DoPredictBatch(const InputListSampleType* input, const unsigned int& startIndex, const unsigned int& size, TargetListSampleType* targets,
+                      ConfidenceListSampleType* quality = nullptr, ProbaListSampleType* proba = nullptr) const override;
+
   /** PrintSelf method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const override;
 
@@ -151,6 +174,9 @@ private:
   RandomForestsMachineLearningModel(const Self&) = delete;
   void operator=(const Self&) = delete;
 
+  /** (Re)compile m_CompiledForest according to m_UseCompiledForest */
+  void UpdateCompiledForest();
+
   cv::Ptr<CvRTreesWrapper> m_RFModel;
 
   /** The depth of the tree. A low value will likely underfit and conversely a
@@ -216,6 +242,12 @@ private:
    * 2 most voted classes) instead of confidence (probability of the most
    * voted class) in prediction*/
   bool m_ComputeMargin;
+
+  /** Whether to predict with the compiled forest */
+  bool m_UseCompiledForest;
+
+  /** Flat copy of m_RFModel, used for prediction when m_UseCompiledForest is on */
+  CompiledForest m_CompiledForest;
 };
 } // end namespace otb
 
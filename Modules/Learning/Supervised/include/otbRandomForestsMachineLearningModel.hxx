@@ -25,6 +25,8 @@
 #include "itkMacro.h"
 #include "otbRandomForestsMachineLearningModel.h"
 #include "otbOpenCVUtils.h"
+#include "otbMacro.h"
+#include <vector>
 
 namespace otb
 {
@@ -43,11 +45,13 @@ RandomForestsMachineLearningModel<TInputValue, TOutputValue>::RandomForestsMachi
     m_MaxNumberOfTrees(100),
     m_ForestAccuracy(0.01),
     m_TerminationCriteria(CV_TERMCRIT_ITER | CV_TERMCRIT_EPS), // identic for v3 ?
-    m_ComputeMargin(false)
+    m_ComputeMargin(false),
+    m_UseCompiledForest(false)
 {
-  this->m_ConfidenceIndex       = true;
-  this->m_ProbaIndex            = false;
-  this->m_IsRegressionSupported = true;
+  this->m_ConfidenceIndex               = true;
+  this->m_ProbaIndex                    = false;
+  this->m_IsRegressionSupported         = true;
+  this->m_IsDoPredictBatchMultiThreaded = true;
 }
 
 template <class TInputValue, class TOutputValue>
@@ -105,6 +109,39 @@ void RandomForestsMachineLearningModel<TInputValue, TOutputValue>::Train()
   m_RFModel->setActiveVarCount(m_MaxNumberOfVariables);
   m_RFModel->setTermCriteria(cv::TermCriteria(m_TerminationCriteria, m_MaxNumberOfTrees, m_ForestAccuracy));
   m_RFModel->train(cv::ml::TrainData::create(samples, cv::ml::ROW_SAMPLE, labels, cv::noArray(), cv::noArray(), cv::noArray(), var_type));
+
+  UpdateCompiledForest();
+}
+
+template <class TInputValue, class TOutputValue>
+void RandomForestsMachineLearningModel<TInputValue, TOutputValue>::SetUseCompiledForest(bool use)
+{
+  if (m_UseCompiledForest != use)
+  {
+    m_UseCompiledForest = use;
+    UpdateCompiledForest();
+    this->Modified();
+  }
+}
+
+template <class TInputValue, class TOutputValue>
+void RandomForestsMachineLearningModel<TInputValue, TOutputValue>::UpdateCompiledForest()
+{
+  m_CompiledForest.Clear();
+
+  if (!m_UseCompiledForest || !m_RFModel->isTrained())
+  {
+    return;
+  }
+
+  if (m_CompiledForest.Compile(*m_RFModel))
+  {
+    otbLogMacro(Debug, << "Random forest compiled: " << m_CompiledForest.GetNumberOfTrees() << " trees, " << m_CompiledForest.GetNumberOfNodes() << " nodes");
+  }
+  else
+  {
+    otbLogMacro(Warning, << "Random forest can not be compiled (categorical splits?), the OpenCV implementation will be used for prediction");
+  }
 }
 
 template <class TInputValue, class TOutputValue>
@@ -119,6 +156,20 @@ RandomForestsMachineLearningModel<TInputValue, TOutputValue>::DoPredict(const In
 
   otb::SampleToMat<InputSampleType>(value, sample);
 
+  if (m_CompiledForest.IsCompiled())
+  {
+    float result     = 0.f;
+    float confidence = 0.f;
+    m_CompiledForest.Predict(sample.ptr<float>(), 1, sample.cols, &result, quality != nullptr ? &confidence : nullptr, m_ComputeMargin);
+
+    target[0] = static_cast<TOutputValue>(result);
+    if (quality != nullptr)
+      (*quality) = confidence;
+    if (proba != nullptr && !this->m_ProbaIndex)
+      itkExceptionMacro("Probability per class not available for this classifier !");
+    return target[0];
+  }
+
   double result = m_RFModel->predict(sample);
 
   target[0] = static_cast<TOutputValue>(result);
@@ -137,6 +188,66 @@ RandomForestsMachineLearningModel<TInputValue, TOutputValue>::DoPredict(const In
   return target[0];
 }
 
+template <class TInputValue, class TOutputValue>
+void RandomForestsMachineLearningModel<TInputValue, TOutputValue>::DoPredictBatch(const InputListSampleType* input, const unsigned int& startIndex,
+                                                                                  const unsigned int& size, TargetListSampleType* targets,
+                                                                                  ConfidenceListSampleType* quality, ProbaListSampleType* proba) const
+{
+  assert(targets != nullptr);
+
+  cv::Mat samples;
+  otb::PrepareBatchPrediction(this, input, startIndex, size, quality, proba, samples);
+
+  // Nothing may throw inside the stripes: all checks are done in PrepareBatchPrediction
+  auto predictStripe = [&](int begin, int end) {
+    if (m_CompiledForest.IsCompiled())
+    {
+      std::vector<float> results(end - begin);
+      std::vector<float> confidences(quality != nullptr ? end - begin : 0);
+      m_CompiledForest.Predict(samples.ptr<float>(begin), end - begin, samples.step1(), results.data(),
+                               quality != nullptr ? confidences.data() : nullptr, m_ComputeMargin);
+
+      for (int i = begin; i < end; ++i)
+      {
+        TargetSampleType target;
+        target[0] = static_cast<TOutputValue>(results[i - begin]);
+        targets->SetMeasurementVector(startIndex + i, target);
+
+        if (quality != nullptr)
+        {
+          ConfidenceSampleType confidence;
+          confidence[0] = confidences[i - begin];
+          quality->SetMeasurementVector(startIndex + i, confidence);
+        }
+      }
+      return;
+    }
+
+    cv::Mat results;
+    m_RFModel->predict(samples.rowRange(begin, end), results);
+
+    for (int i = begin; i < end; ++i)
+    {
+      TargetSampleType target;
+      target[0] = static_cast<TOutputValue>(results.at<float>(i - begin, 0));
+      targets->SetMeasurementVector(startIndex + i, target);
+
+      if (quality != nullptr)
+      {
+        const cv::Mat        sample = samples.row(i);
+        ConfidenceSampleType confidence;
+        if (m_ComputeMargin)
+          confidence[0] = m_RFModel->predict_margin(sample);
+        else
+          confidence[0] = m_RFModel->predict_confidence(sample);
+        quality->SetMeasurementVector(startIndex + i, confidence);
+      }
+    }
+  };
+
+  otb::ParallelForRowRanges(samples.rows, predictStripe);
+}
+
 template <class TInputValue, class TOutputValue>
 void RandomForestsMachineLearningModel<TInputValue, TOutputValue>::Save(const std::string& filename, const std::string& name)
 {
@@ -152,6 +263,8 @@ void RandomForestsMachineLearningModel<TInputValue, TOutputValue>::Load(const st
 {
   cv::FileStorage fs(filename, cv::FileStorage::READ);
   m_RFModel->read(name.empty() ? fs.getFirstTopLevelNode() : fs[name]);
+
+  UpdateCompiledForest();
 }
 
 template <class TInputValue, class TOutputValue>
@@ -52,8 +52,9 @@ SVMMachineLearningModel<TInputValue, TOutputValue>::SVMMachineLearningModel()
     m_OutputNu(0),
     m_OutputP(0)
 {
-  this->m_ConfidenceIndex       = true;
-  this->m_IsRegressionSupported = true;
+  this->m_ConfidenceIndex               = true;
+  this->m_IsRegressionSupported         = true;
+  this->m_IsDoPredictBatchMultiThreaded = true;
 }
 
 /** Train the machine learning model */
@@ -133,6 +134,46 @@ SVMMachineLearningModel<TInputValue, TOutputValue>::DoPredict(const InputSampleT
   return target;
 }
 
+template <class TInputValue, class TOutputValue>
+void SVMMachineLearningModel<TInputValue, TOutputValue>::DoPredictBatch(const InputListSampleType* input, const unsigned int& startIndex,
+                                                                        const unsigned int& size, TargetListSampleType* targets,
+                                                                        ConfidenceListSampleType* quality, ProbaListSampleType* proba) const
+{
+  assert(targets != nullptr);
+
+  cv::Mat samples;
+  otb::PrepareBatchPrediction(this, input, startIndex, size, quality, proba, samples);
+
+  // Nothing may throw inside the stripes: all checks are done in PrepareBatchPrediction
+  auto predictStripe = [&](int begin, int end) {
+    const cv::Mat rows = samples.rowRange(begin, end);
+    cv::Mat       results;
+    m_SVMModel->predict(rows, results);
+
+    cv::Mat rawResults;
+    if (quality != nullptr)
+    {
+      m_SVMModel->predict(rows, rawResults, cv::ml::StatModel::RAW_OUTPUT);
+    }
+
+    for (int i = begin; i < end; ++i)
+    {
+      TargetSampleType target;
+      target[0] = static_cast<TOutputValue>(results.at<float>(i - begin, 0));
+      targets->SetMeasurementVector(startIndex + i, target);
+
+      if (quality != nullptr)
+      {
+        ConfidenceSampleType confidence;
+        confidence[0] = static_cast<ConfidenceValueType>(rawResults.at<float>(i - begin, 0));
+        quality->SetMeasurementVector(startIndex + i, confidence);
+      }
+    }
+  };
+
+  otb::ParallelForRowRanges(samples.rows, predictStripe);
+}
+
 template <class TInputValue, class TOutputValue>
 void SVMMachineLearningModel<TInputValue, TOutputValue>::Save(const std::string& filename, const std::string& name)
 {
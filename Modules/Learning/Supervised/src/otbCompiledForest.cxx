@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbCompiledForest.h"
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace otb
+{
+
+namespace
+{
+/** Split::varIdx is used as an offset in the sample, which is only valid if
+ *  the forest uses all the variables in their natural order. DTrees does not
+ *  expose its variable mapping, so it is read back from the serialized model
+ *  parameters: the "var_idx" array is only written for a forest trained on a
+ *  selection of variables. */
+bool HasIdentityVariableMapping(const cv::ml::DTrees& forest)
+{
+  cv::FileStorage output(".yml", cv::FileStorage::WRITE | cv::FileStorage::MEMORY);
+  forest.write(output);
+  const std::string serialized = output.releaseAndGetString();
+
+  cv::FileStorage    input(serialized, cv::FileStorage::READ | cv::FileStorage::MEMORY);
+  const cv::FileNode varIdxNode = input.root()["var_idx"];
+  if (varIdxNode.empty())
+  {
+    return true;
+  }
+
+  std::vector<int> varIdx;
+  varIdxNode >> varIdx;
+  for (std::size_t i = 0; i < varIdx.size(); ++i)
+  {
+    if (varIdx[i] != static_cast<int>(i))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+const std::size_t CompiledForest::BlockSize;
+
+CompiledForest::CompiledForest() : m_IsClassifier(true)
+{
+}
+
+void CompiledForest::Clear()
+{
+  m_Roots.clear();
+  m_Feature.clear();
+  m_Threshold.clear();
+  m_Right.clear();
+  m_ClassLabels.clear();
+}
+
+bool CompiledForest::Compile(const cv::ml::DTrees& forest)
+{
+  Clear();
+
+  if (!forest.isTrained() || !HasIdentityVariableMapping(forest))
+  {
+    return false;
+  }
+
+  m_IsClassifier = forest.isClassifier();
+
+  const std::vector<cv::ml::DTrees::Node>&  nodes  = forest.getNodes();
+  const std::vector<cv::ml::DTrees::Split>& splits = forest.getSplits();
+  const std::vector<int>&                   roots  = forest.getRoots();
+
+  m_Roots.reserve(roots.size());
+  m_Feature.reserve(nodes.size());
+  m_Threshold.reserve(nodes.size());
+  m_Right.reserve(nodes.size());
+
+  // (source node, flat index of the parent whose right child is this node or -1)
+  std::vector<std::pair<int, int>> stack;
+
+  for (int root : roots)
+  {
+    m_Roots.push_back(static_cast<int>(m_Feature.size()));
+    stack.push_back(std::make_pair(root, -1));
+
+    while (!stack.empty())
+    {
+      const int sourceIdx = stack.back().first;
+      const int parentIdx = stack.back().second;
+      stack.pop_back();
+
+      const int flatIdx = static_cast<int>(m_Feature.size());
+      if (parentIdx >= 0)
+      {
+        m_Right[parentIdx] = flatIdx;
+      }
+
+      const cv::ml::DTrees::Node& node = nodes[sourceIdx];
+      if (node.split < 0)
+      {
+        // leaf
+        m_Feature.push_back(-1);
+        m_Threshold.push_back(static_cast<float>(node.value));
+        m_Right.push_back(node.classIdx);
+
+        if (m_IsClassifier)
+        {
+          if (node.classIdx < 0)
+          {
+            Clear();
+            return false;
+          }
+          if (static_cast<std::size_t>(node.classIdx) >= m_ClassLabels.size())
+          {
+            m_ClassLabels.resize(node.classIdx + 1, 0.f);
+          }
+          m_ClassLabels[node.classIdx] = static_cast<float>(node.value);
+        }
+        continue;
+      }
+
+      const cv::ml::DTrees::Split& split = splits[node.split];
+      if (split.subsetOfs >= 0)
+      {
+        // categorical split: not supported
+        Clear();
+        return false;
+      }
+
+      int left  = node.left;
+      int right = node.right;
+      if (split.inversed)
+      {
+        std::swap(left, right);
+      }
+
+      m_Feature.push_back(split.varIdx);
+      m_Threshold.push_back(split.c);
+      m_Right.push_back(-1);
+
+      // The left child is popped first, hence stored right after its parent
+      stack.push_back(std::make_pair(right, flatIdx));
+      stack.push_back(std::make_pair(left, -1));
+    }
+  }
+  return true;
+}
+
+void CompiledForest::Predict(const float* samples, std::size_t nbSamples, std::size_t stride, float* results, float* confidence, bool computeMargin) const
+{
+  const std::size_t nbTrees   = m_Roots.size();
+  const std::size_t nbClasses = m_IsClassifier ? m_ClassLabels.size() : 0;
+
+  const int*   feature   = m_Feature.data();
+  const float* threshold = m_Threshold.data();
+  const int*   right     = m_Right.data();
+
+  std::vector<unsigned int> votes(BlockSize * nbClasses);
+  std::vector<double>       sums(BlockSize);
+
+  for (std::size_t blockStart = 0; blockStart < nbSamples; blockStart += BlockSize)
+  {
+    const std::size_t blockSize   = std::min(BlockSize, nbSamples - blockStart);
+    const float*      blockSample = samples + blockStart * stride;
+
+    std::fill(votes.begin(), votes.end(), 0);
+    std::fill(sums.begin(), sums.end(), 0.);
+
+    for (std::size_t t = 0; t < nbTrees; ++t)
+    {
+      const int root = m_Roots[t];
+      for (std::size_t s = 0; s < blockSize; ++s)
+      {
+        const float* sample = blockSample + s * stride;
+
+        int nodeIdx = root;
+        while (feature[nodeIdx] >= 0)
+        {
+          nodeIdx = sample[feature[nodeIdx]] <= threshold[nodeIdx] ? nodeIdx + 1 : right[nodeIdx];
+        }
+
+        if (m_IsClassifier)
+          ++votes[s * nbClasses + right[nodeIdx]];
+        else
+          sums[s] += threshold[nodeIdx];
+      }
+    }
+
+    for (std::size_t s = 0; s < blockSize; ++s)
+    {
+      if (!m_IsClassifier)
+      {
+        results[blockStart + s] = static_cast<float>(sums[s] / nbTrees);
+        if (confidence != nullptr)
+        {
+          confidence[blockStart + s] = 0.f;
+        }
+        continue;
+      }
+
+      // Same tie-breaking rule as OpenCV: the first most voted class wins
+      const unsigned int* sampleVotes = votes.data() + s * nbClasses;
+      std::size_t         best        = 0;
+      for (std::size_t k = 1; k < nbClasses; ++k)
+      {
+        if (sampleVotes[k] > sampleVotes[best])
+        {
+          best = k;
+        }
+      }
+      results[blockStart + s] = m_ClassLabels[best];
+
+      if (confidence != nullptr)
+      {
+        if (computeMargin)
+        {
+          unsigned int second = 0;
+          for (std::size_t k = 0; k < nbClasses; ++k)
+          {
+            if (k != best)
+            {
+              second = std::max(second, sampleVotes[k]);
+            }
+          }
+          confidence[blockStart + s] = static_cast<float>(sampleVotes[best] - second) / nbTrees;
+        }
+        else
+        {
+          confidence[blockStart + s] = static_cast<float>(sampleVotes[best]) / nbTrees;
+        }
+      }
+    }
+  }
+}
+
+} // end namespace otb
@@ -60,7 +60,8 @@ void CvRTreesWrapper::get_votes(const cv::Mat& sample, const cv::Mat& missing, C
       const cv::ml::DTrees::Split& split  = splits[curNode.split];
       int                          varIdx = split.varIdx;
       float                        val    = samplePtr[varIdx];
-      nodeIdx                             = val <= split.c ? curNode.left : curNode.right;
+      // As in OpenCV, an inversed split sends the samples above the threshold to the left
+      nodeIdx = (val <= split.c) != split.inversed ? curNode.left : curNode.right;
     }
     predictedClass = nodes[prevNodeIdx].classIdx;
     votes[predictedClass] += 1;
@@ -54,6 +54,8 @@ void RegisterTests()
   REGISTER_TEST(otbSVMMachineLearningModel);
   REGISTER_TEST(otbKNearestNeighborsMachineLearningModel);
   REGISTER_TEST(otbRandomForestsMachineLearningModel);
+  REGISTER_TEST(otbRandomForestsMachineLearningModelCompiled);
+  REGISTER_TEST(otbRandomForestsMachineLearningModelInversedSplits);
   REGISTER_TEST(otbBoostMachineLearningModel);
   REGISTER_TEST(otbANNMachineLearningModel);
   REGISTER_TEST(otbNormalBayesMachineLearningModel);
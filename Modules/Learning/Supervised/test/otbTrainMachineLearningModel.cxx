@@ -20,6 +20,7 @@
 
 
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <algorithm>
 #include <chrono>
@@ -71,6 +72,42 @@ void SetupModel(TModel* /*model*/)
   // do nothing by default
 }
 
+// Check that the batch prediction (labels and confidence) matches the
+// sample by sample prediction
+template <class TModel>
+bool CheckBatchAgainstSinglePrediction(const TModel* model, const InputListSampleType* samples)
+{
+  typedef typename TModel::ConfidenceValueType      ConfidenceValueType;
+  typedef typename TModel::ConfidenceListSampleType ConfidenceListSampleType;
+
+  typename ConfidenceListSampleType::Pointer quality = ConfidenceListSampleType::New();
+  const bool                                 hasConfidence = model->HasConfidenceIndex();
+
+  TargetListSampleType::Pointer predicted = model->PredictBatch(samples, hasConfidence ? quality.GetPointer() : nullptr);
+
+  for (unsigned int i = 0; i < samples->Size(); ++i)
+  {
+    ConfidenceValueType confidence = 0;
+    TargetSampleType    target     = model->Predict(samples->GetMeasurementVector(i), hasConfidence ? &confidence : nullptr);
+    if (target[0] != predicted->GetMeasurementVector(i)[0])
+    {
+      std::cout << "Batch and single predictions differ for sample " << i << ": " << predicted->GetMeasurementVector(i)[0] << " != " << target[0]
+                << std::endl;
+      return false;
+    }
+    if (hasConfidence)
+    {
+      const ConfidenceValueType batchConfidence = quality->GetMeasurementVector(i)[0];
+      if (std::abs(batchConfidence - confidence) > 1e-6 * std::max(ConfidenceValueType(1), std::abs(confidence)))
+      {
+        std::cout << "Batch and single confidences differ for sample " << i << ": " << batchConfidence << " != " << confidence << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 template <class TModel>
 int otbGenericMachineLearningModel(int argc, char* argv[])
 {
@@ -108,6 +145,11 @@ int otbGenericMachineLearningModel(int argc, char* argv[])
   otbLogMacro(Debug, << "PredictBatch took " << elapsed << " ms");
   const float kappaLoad = GetConfusionMatrixResults(predictedLoad, labels);
 
+  if (!CheckBatchAgainstSinglePrediction<TModel>(classifierLoad, samples))
+  {
+    return EXIT_FAILURE;
+  }
+
   return (std::abs(kappaLoad - kappa) < 0.00000001 ? EXIT_SUCCESS : EXIT_FAILURE);
 }
 
@@ -227,6 +269,204 @@ void SetupModel(RandomForestType* model)
   model->SetPriors(priors);
 }
 
+// Compare the compiled forest with the OpenCV implementation, on the model
+// produced by otbRandomForestsMachineLearningModel, and report the throughput
+// of both
+int otbRandomForestsMachineLearningModelCompiled(int argc, char* argv[])
+{
+  if (argc != 3)
+  {
+    std::cout << "Wrong number of arguments " << std::endl;
+    std::cout << "Usage : sample file, model file " << std::endl;
+    return EXIT_FAILURE;
+  }
+  InputListSampleType::Pointer  samples = InputListSampleType::New();
+  TargetListSampleType::Pointer labels  = TargetListSampleType::New();
+  if (!otb::ReadDataFile(argv[1], samples, labels))
+  {
+    std::cout << "Failed to read samples file " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  typedef RandomForestType::ConfidenceListSampleType ConfidenceListSampleType;
+  using TimeT = std::chrono::duration<double>;
+
+  RandomForestType::Pointer classifier = RandomForestType::New();
+  classifier->Load(argv[2]);
+
+  ConfidenceListSampleType::Pointer quality = ConfidenceListSampleType::New();
+  auto                              start   = std::chrono::system_clock::now();
+  TargetListSampleType::Pointer     ref     = classifier->PredictBatch(samples, quality);
+  const double refTime = std::chrono::duration_cast<TimeT>(std::chrono::system_clock::now() - start).count();
+
+  classifier->SetUseCompiledForest(true);
+  if (!classifier->IsCompiledForestUsed())
+  {
+    std::cout << "Forest could not be compiled" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ConfidenceListSampleType::Pointer compiledQuality = ConfidenceListSampleType::New();
+  start                                             = std::chrono::system_clock::now();
+  TargetListSampleType::Pointer compiled            = classifier->PredictBatch(samples, compiledQuality);
+  const double compiledTime = std::chrono::duration_cast<TimeT>(std::chrono::system_clock::now() - start).count();
+
+  otbLogMacro(Info, << "OpenCV forest: " << samples->Size() / std::max(refTime, 1e-9) << " samples/s");
+  otbLogMacro(Info, << "Compiled forest: " << samples->Size() / std::max(compiledTime, 1e-9) << " samples/s");
+
+  for (unsigned int i = 0; i < samples->Size(); ++i)
+  {
+    if (ref->GetMeasurementVector(i)[0] != compiled->GetMeasurementVector(i)[0] ||
+        std::abs(quality->GetMeasurementVector(i)[0] - compiledQuality->GetMeasurementVector(i)[0]) > 1e-6)
+    {
+      std::cout << "Compiled forest prediction differs for sample " << i << ": " << compiled->GetMeasurementVector(i)[0] << " ("
+                << compiledQuality->GetMeasurementVector(i)[0] << ") != " << ref->GetMeasurementVector(i)[0] << " (" << quality->GetMeasurementVector(i)[0]
+                << ")" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return CheckBatchAgainstSinglePrediction<RandomForestType>(classifier, samples) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Store every other split of a saved forest as "gt" instead of "le": OpenCV
+// reads these splits as inversed. Returns the number of inversed splits.
+unsigned int InverseSplits(std::string& model)
+{
+  unsigned int nbSplits   = 0;
+  unsigned int nbInversed = 0;
+  for (std::size_t pos = model.find("le"); pos != std::string::npos && pos + 2 < model.size(); pos = model.find("le", pos + 2))
+  {
+    // XML element <le>c</le>, or YAML key "le:" in a flow mapping
+    const bool xmlElement = pos > 0 && model[pos - 1] == '<' && model[pos + 2] == '>';
+    const bool yamlKey    = pos > 0 && model[pos + 2] == ':' && (model[pos - 1] == ' ' || model[pos - 1] == '{' || model[pos - 1] == ',');
+    if (!xmlElement && !yamlKey)
+    {
+      continue;
+    }
+    if (nbSplits++ % 2 == 0)
+    {
+      continue;
+    }
+    model.replace(pos, 2, "gt");
+    if (xmlElement)
+    {
+      const std::size_t end = model.find("</le>", pos);
+      if (end == std::string::npos)
+      {
+        return 0;
+      }
+      model.replace(end + 2, 2, "gt");
+    }
+    ++nbInversed;
+  }
+  return nbInversed;
+}
+
+int otbRandomForestsMachineLearningModelInversedSplits(int argc, char* argv[])
+{
+  if (argc != 4)
+  {
+    std::cout << "Wrong number of arguments " << std::endl;
+    std::cout << "Usage : sample file, model file, output model file " << std::endl;
+    return EXIT_FAILURE;
+  }
+  InputListSampleType::Pointer  samples = InputListSampleType::New();
+  TargetListSampleType::Pointer labels  = TargetListSampleType::New();
+  if (!otb::ReadDataFile(argv[1], samples, labels))
+  {
+    std::cout << "Failed to read samples file " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream     ifs(argv[2]);
+  std::stringstream model;
+  model << ifs.rdbuf();
+  std::string inversedModel = model.str();
+  if (InverseSplits(inversedModel) == 0)
+  {
+    std::cout << "No split could be inversed in " << argv[2] << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::ofstream ofs(argv[3]);
+  ofs << inversedModel;
+  ofs.close();
+
+  typedef RandomForestType::ConfidenceListSampleType ConfidenceListSampleType;
+
+  RandomForestType::Pointer classifier = RandomForestType::New();
+  classifier->Load(argv[3]);
+
+  // Labels from the OpenCV traversal, confidence from the vote count of CvRTreesWrapper
+  ConfidenceListSampleType::Pointer quality = ConfidenceListSampleType::New();
+  TargetListSampleType::Pointer     ref     = classifier->PredictBatch(samples, quality);
+
+  classifier->SetUseCompiledForest(true);
+  if (!classifier->IsCompiledForestUsed())
+  {
+    std::cout << "Forest could not be compiled" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ConfidenceListSampleType::Pointer compiledQuality = ConfidenceListSampleType::New();
+  TargetListSampleType::Pointer     compiled        = classifier->PredictBatch(samples, compiledQuality);
+
+  for (unsigned int i = 0; i < samples->Size(); ++i)
+  {
+    if (ref->GetMeasurementVector(i)[0] != compiled->GetMeasurementVector(i)[0] ||
+        std::abs(quality->GetMeasurementVector(i)[0] - compiledQuality->GetMeasurementVector(i)[0]) > 1e-6)
+    {
+      std::cout << "Compiled forest prediction differs for sample " << i << ": " << compiled->GetMeasurementVector(i)[0] << " ("
+                << compiledQuality->GetMeasurementVector(i)[0] << ") != " << ref->GetMeasurementVector(i)[0] << " (" << quality->GetMeasurementVector(i)[0]
+                << ")" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+#ifdef OTB_OPENCV_4
+  // The vote count must also match the votes computed by OpenCV
+  cv::Ptr<otb::CvRTreesWrapper> forest = cv::makePtr<otb::CvRTreesWrapper>();
+  cv::FileStorage               fs(argv[3], cv::FileStorage::READ);
+  forest->read(fs.getFirstTopLevelNode());
+
+  const unsigned int nbFeatures = samples->GetMeasurementVectorSize();
+  cv::Mat            sample(1, nbFeatures, CV_32FC1);
+  for (unsigned int i = 0; i < samples->Size(); ++i)
+  {
+    for (unsigned int j = 0; j < nbFeatures; ++j)
+    {
+      sample.at<float>(0, j) = samples->GetMeasurementVector(i)[j];
+    }
+
+    otb::CvRTreesWrapper::VotesVectorType votes;
+    forest->get_votes(sample, cv::Mat(), votes);
+
+    cv::Mat                               cvVotes;
+    otb::CvRTreesWrapper::VotesVectorType refVotes;
+    forest->getVotes(sample, cvVotes, 0);
+    for (int c = 0; c < cvVotes.cols; ++c)
+    {
+      if (cvVotes.at<int>(1, c) > 0)
+      {
+        refVotes.push_back(cvVotes.at<int>(1, c));
+      }
+    }
+
+    // Classes without votes are not counted the same way: compare the votes of the voted classes
+    votes.erase(std::remove(votes.begin(), votes.end(), 0U), votes.end());
+    std::sort(votes.begin(), votes.end());
+    std::sort(refVotes.begin(), refVotes.end());
+    if (votes != refVotes)
+    {
+      std::cout << "Vote count differs from OpenCV for sample " << i << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+#endif
+
+  return EXIT_SUCCESS;
+}
+
 using BoostType = otb::BoostMachineLearningModel<InputValueType, TargetValueType>;
 int otbBoostMachineLearningModel(int argc, char* argv[])
 {
@@ -70,6 +70,21 @@ otb_add_test(NAME leTvRandomForestsMachineLearningModel COMMAND otbSupervisedTes
   ${TEMP}/rf_model.txt
   )
 
+otb_add_test(NAME leTvRandomForestsMachineLearningModelCompiled COMMAND otbSupervisedTestDriver
+  otbRandomForestsMachineLearningModelCompiled
+  ${INPUTDATA}/letter_light.scale
+  ${TEMP}/rf_model.txt
+  )
+set_property(TEST leTvRandomForestsMachineLearningModelCompiled PROPERTY DEPENDS leTvRandomForestsMachineLearningModel)
+
+otb_add_test(NAME leTvRandomForestsMachineLearningModelInversedSplits COMMAND otbSupervisedTestDriver
+  otbRandomForestsMachineLearningModelInversedSplits
+  ${INPUTDATA}/letter_light.scale
+  ${TEMP}/rf_model.txt
+  ${TEMP}/rf_model_inversed.txt
+  )
+set_property(TEST leTvRandomForestsMachineLearningModelInversedSplits PROPERTY DEPENDS leTvRandomForestsMachineLearningModel)
+
 otb_add_test(NAME leTvKNearestNeighborsMachineLearningModel COMMAND otbSupervisedTestDriver
   otbKNearestNeighborsMachineLearningModel
   ${INPUTDATA}/letter_light.scale
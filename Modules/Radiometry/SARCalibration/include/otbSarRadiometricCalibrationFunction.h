@@ -97,6 +97,13 @@ public:
     return this->EvaluateAtIndex(index);
   }
 
+  /** Evaluate the function on length consecutive pixels of a line, starting
+   * at index. The values are exactly the ones of EvaluateAtIndex(), but the
+   * lookup data are interpolated once for the whole line (see
+   * SarCalibrationLookupData::GetLineValues()) and each correction is
+   * applied to the whole line in a simple loop. */
+  void EvaluateLine(const IndexType& index, unsigned int length, OutputType* output) const;
+
   /** Set the input image.
    * \warning this method caches BufferedRegion information.
    * If the BufferedRegion has changed, user must call
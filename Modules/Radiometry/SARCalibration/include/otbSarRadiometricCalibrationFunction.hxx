@@ -24,6 +24,7 @@
 
 #include "otbSarRadiometricCalibrationFunction.h"
 #include "itkNumericTraits.h"
+#include <vector>
 
 namespace otb
 {
@@ -97,9 +98,9 @@ SarRadiometricCalibrationFunction<TInputImage, TCoordRep>::EvaluateAtIndex(const
     return (itk::NumericTraits<OutputType>::max());
   }
 
-  /* convert index to point */
+  /* convert index to point, for the parametric functions (noise included) */
   PointType point;
-  if (m_ApplyAntennaPatternGain || m_ApplyIncidenceAngleCorrection || m_ApplyRangeSpreadLossCorrection)
+  if (m_EnableNoise || m_ApplyAntennaPatternGain || m_ApplyIncidenceAngleCorrection || m_ApplyRangeSpreadLossCorrection)
     this->GetInputImage()->TransformIndexToPhysicalPoint(index, point);
 
   /** digitalNumber:
@@ -163,6 +164,107 @@ SarRadiometricCalibrationFunction<TInputImage, TCoordRep>::EvaluateAtIndex(const
   return static_cast<OutputType>(sigma);
 }
 
+template <class TInputImage, class TCoordRep>
+void SarRadiometricCalibrationFunction<TInputImage, TCoordRep>::EvaluateLine(const IndexType& index, unsigned int length, OutputType* output) const
+{
+  if (length == 0)
+  {
+    return;
+  }
+
+  IndexType lastIndex = index;
+  lastIndex[0] += length - 1;
+  if (!this->IsInsideBuffer(index) || !this->IsInsideBuffer(lastIndex))
+  {
+    IndexType currentIndex = index;
+    for (unsigned int i = 0; i < length; ++i, ++currentIndex[0])
+    {
+      output[i] = this->EvaluateAtIndex(currentIndex);
+    }
+    return;
+  }
+
+  // Pixels of a line are contiguous in the input buffer
+  const InputPixelType* input = &(this->GetInputImage()->GetPixel(index));
+
+  /* see EvaluateAtIndex() for the details of each step */
+  std::vector<RealType> sigma(length);
+  for (unsigned int i = 0; i < length; ++i)
+  {
+    const std::complex<float> pVal          = input[i];
+    const RealType            digitalNumber = std::sqrt((pVal.real() * pVal.real()) + (pVal.imag() * pVal.imag()));
+    sigma[i]                                = m_Scale * digitalNumber * digitalNumber;
+  }
+
+  const bool applyParametricFunctions = m_EnableNoise || m_ApplyIncidenceAngleCorrection || m_ApplyAntennaPatternGain || m_ApplyRangeSpreadLossCorrection;
+  if (applyParametricFunctions)
+  {
+    std::vector<PointType> points(length);
+    IndexType              currentIndex = index;
+    for (unsigned int i = 0; i < length; ++i, ++currentIndex[0])
+    {
+      this->GetInputImage()->TransformIndexToPhysicalPoint(currentIndex, points[i]);
+    }
+
+    if (m_EnableNoise)
+    {
+      for (unsigned int i = 0; i < length; ++i)
+      {
+        sigma[i] -= static_cast<RealType>(m_Noise->Evaluate(points[i]));
+      }
+    }
+
+    if (m_ApplyIncidenceAngleCorrection)
+    {
+      for (unsigned int i = 0; i < length; ++i)
+      {
+        sigma[i] *= std::sin(static_cast<RealType>(m_IncidenceAngle->Evaluate(points[i])));
+      }
+    }
+
+    if (m_ApplyAntennaPatternGain)
+    {
+      for (unsigned int i = 0; i < length; ++i)
+      {
+        sigma[i] *= static_cast<RealType>(m_AntennaPatternNewGain->Evaluate(points[i]));
+        sigma[i] /= static_cast<RealType>(m_AntennaPatternOldGain->Evaluate(points[i]));
+      }
+    }
+
+    if (m_ApplyRangeSpreadLossCorrection)
+    {
+      for (unsigned int i = 0; i < length; ++i)
+      {
+        sigma[i] *= static_cast<RealType>(m_RangeSpreadLoss->Evaluate(points[i]));
+      }
+    }
+  }
+
+  if (m_ApplyLookupDataCorrection)
+  {
+    std::vector<double> lutValues(length);
+    m_Lut->GetLineValues(index[0], index[1], length, lutValues.data());
+    for (unsigned int i = 0; i < length; ++i)
+    {
+      const RealType lutVal = static_cast<RealType>(lutValues[i]);
+      sigma[i] /= lutVal * lutVal;
+    }
+  }
+
+  if (m_ApplyRescalingFactor)
+  {
+    for (unsigned int i = 0; i < length; ++i)
+    {
+      sigma[i] /= m_RescalingFactor;
+    }
+  }
+
+  for (unsigned int i = 0; i < length; ++i)
+  {
+    output[i] = static_cast<OutputType>(sigma[i] < 0.0 ? 0.0 : sigma[i]);
+  }
+}
+
 } // end namespace otb
 
 #endif
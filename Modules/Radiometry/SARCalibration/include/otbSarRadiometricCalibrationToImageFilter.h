@@ -44,6 +44,10 @@ namespace otb
  * class. Each have a Evaluate() method and a special
  * EvaluateParametricCoefficient() which computes the actual value.
  *
+ * The output is computed line by line: the lookup data (e.g. the Sentinel-1
+ * calibration vectors) are interpolated once per output line instead of
+ * being searched for each pixel.
+ *
  * The technical details and more discussion of SarCalibration can be found in jira
  * story #863.
  *
@@ -120,6 +124,10 @@ protected:
   /** Update the function list and input parameters*/
   void BeforeThreadedGenerateData() override;
 
+  /** Evaluate the function line by line (see
+   * SarRadiometricCalibrationFunction::EvaluateLine()) */
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
+
 private:
   SarRadiometricCalibrationToImageFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
@@ -25,6 +25,9 @@
 #include "otbSarRadiometricCalibrationToImageFilter.h"
 #include "otbSarImageMetadataInterfaceFactory.h"
 #include "otbSarCalibrationLookupData.h"
+#include "itkImageScanlineIterator.h"
+#include "itkProgressReporter.h"
+#include <vector>
 
 namespace otb
 {
@@ -162,6 +165,30 @@ See Also: otbSentinel1ImageMetadataInterface, otbTerraSarImageMetadataInterface,
   }
 }
 
+template <class TInputImage, class TOutputImage>
+void SarRadiometricCalibrationToImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                                                                                             itk::ThreadIdType threadId)
+{
+  OutputImagePointer outputPtr = this->GetOutput();
+  FunctionPointer    function  = this->GetFunction();
+
+  itk::ImageScanlineIterator<OutputImageType> outputIt(outputPtr, outputRegionForThread);
+  itk::ProgressReporter                       progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  const unsigned int             lineLength = outputRegionForThread.GetSize()[0];
+  std::vector<FunctionValueType> values(lineLength);
+
+  for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); outputIt.NextLine())
+  {
+    function->EvaluateLine(outputIt.GetIndex(), lineLength, values.data());
+    for (unsigned int i = 0; i < lineLength; ++i, ++outputIt)
+    {
+      outputIt.Set(static_cast<OutputImagePixelType>(values[i]));
+      progress.CompletedPixel();
+    }
+  }
+}
+
 } // end namespace otb
 
 #endif
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbSarRadiometricCalibrationFunction.h"
+#include "otbSentinel1ImageMetadataInterface.h"
+#include "otbImage.h"
+#include "itkTimeProbe.h"
+#include <iostream>
+#include <vector>
+
+namespace
+{
+/** Synthetic Sentinel-1 calibration annotation: one calibration vector every
+ * vectorSpacing lines, with one knot every knotSpacing pixels, like in IW
+ * GRD products */
+otb::Sentinel1CalibrationLookupData::Pointer CreateLookupData(int width, int height, int vectorSpacing, int knotSpacing)
+{
+  const double firstLineTime = 58000.;
+  const double lineInterval  = 1e-7;
+
+  std::vector<otb::Sentinel1CalibrationStruct> vectors;
+  for (int line = 0; line < height + vectorSpacing; line += vectorSpacing)
+  {
+    otb::Sentinel1CalibrationStruct v;
+    v.line     = line;
+    v.timeMJD  = firstLineTime + line * lineInterval;
+    v.deltaMJD = vectors.empty() ? 0. : v.timeMJD - vectors.back().timeMJD;
+    for (int pixel = 0; pixel < width + knotSpacing; pixel += knotSpacing)
+    {
+      v.deltaPixels.push_back(v.pixels.empty() ? 0. : pixel - v.pixels.back());
+      v.pixels.push_back(pixel);
+      v.vect.push_back(500.f + 0.01f * pixel + 0.003f * line + 5.f * std::sin(0.001f * pixel));
+    }
+    vectors.push_back(v);
+  }
+
+  otb::Sentinel1CalibrationLookupData::Pointer lut = otb::Sentinel1CalibrationLookupData::New();
+  lut->InitParameters(otb::SarCalibrationLookupData::SIGMA, firstLineTime, firstLineTime + (height - 1) * lineInterval, height, vectors.size(), vectors);
+  return lut;
+}
+}
+
+int otbSarRadiometricCalibrationFunctionLineTest(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  typedef otb::Image<float, 2> ImageType;
+  typedef otb::SarRadiometricCalibrationFunction<ImageType> FunctionType;
+
+  // Benchmark of the lookup data on lines as wide as an IW GRD product
+  const int width = 25000, height = 17000, nbLines = 200;
+
+  otb::Sentinel1CalibrationLookupData::Pointer lut = CreateLookupData(width, height, 400, 40);
+
+  std::vector<double> pixelValues(width), lineValues(width);
+  itk::TimeProbe      pixelProbe, lineProbe;
+  bool                identical = true;
+
+  for (int y = 0; y < height; y += height / nbLines)
+  {
+    pixelProbe.Start();
+    for (int x = 0; x < width; ++x)
+    {
+      pixelValues[x] = lut->GetValue(x, y);
+    }
+    pixelProbe.Stop();
+
+    lineProbe.Start();
+    lut->GetLineValues(0, y, width, lineValues.data());
+    lineProbe.Stop();
+
+    identical = identical && pixelValues == lineValues;
+  }
+
+  std::cout << "Lookup of " << nbLines << " lines of " << width << " pixels: " << pixelProbe.GetTotal() << " s pixel by pixel, " << lineProbe.GetTotal()
+            << " s line by line" << std::endl;
+
+  if (!identical)
+  {
+    std::cerr << "Line lookup values differ from the pixel ones" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Line evaluation of the calibration function, with and without noise
+  ImageType::Pointer    image = ImageType::New();
+  ImageType::RegionType region;
+  region.SetSize(0, 1000);
+  region.SetSize(1, 300);
+  image->SetRegions(region);
+  image->Allocate();
+  unsigned int seed = 42;
+  for (unsigned int i = 0; i < region.GetNumberOfPixels(); ++i)
+  {
+    seed                         = seed * 1103515245 + 12345;
+    image->GetBufferPointer()[i] = static_cast<float>((seed >> 16) % 1000);
+  }
+
+  FunctionType::Pointer function = FunctionType::New();
+  function->SetInputImage(image);
+  function->SetApplyAntennaPatternGain(false);
+  function->SetApplyIncidenceAngleCorrection(false);
+  function->SetApplyRangeSpreadLossCorrection(false);
+  function->SetApplyLookupDataCorrection(true);
+  function->SetCalibrationLookupData(CreateLookupData(1000, 300, 100, 40).GetPointer());
+
+  std::vector<FunctionType::OutputType> values(1000);
+  for (int noise = 0; noise < 2; ++noise)
+  {
+    function->SetEnableNoise(noise == 1);
+    function->GetNoise()->SetConstantValue(1.5);
+
+    for (int y = 0; y < 300; ++y)
+    {
+      FunctionType::IndexType start;
+      start[0] = 10;
+      start[1] = y;
+      function->EvaluateLine(start, 990, values.data());
+      FunctionType::IndexType index = start;
+      for (unsigned int i = 0; i < 990; ++i, ++index[0])
+      {
+        if (values[i] != function->EvaluateAtIndex(index))
+        {
+          std::cerr << "Line evaluation differs from the pixel evaluation at " << index << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
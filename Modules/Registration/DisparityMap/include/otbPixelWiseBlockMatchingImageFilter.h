@@ -26,6 +26,9 @@
 #include "itkConstNeighborhoodIterator.h"
 #include "itkImageRegionIterator.h"
 #include "otbImage.h"
+#include <cmath>
+#include <type_traits>
+#include <vector>
 
 namespace otb
 {
@@ -63,6 +66,12 @@ public:
 
     return ssd;
   }
+
+  // Cost of a pair of pixels, the metric is the sum on the block
+  inline double PixelCost(double a, double b) const
+  {
+    return (a - b) * (a - b);
+  }
 };
 
 
@@ -214,6 +223,11 @@ public:
     }
   }
 
+  double GetP() const
+  {
+    return m_P;
+  }
+
   // Implement the Lp metric
   inline MetricValueType operator()(ConstNeighborhoodIteratorType& a, ConstNeighborhoodIteratorType& b) const
   {
@@ -228,10 +242,64 @@ public:
     return score;
   }
 
+  // Cost of a pair of pixels, the metric is the sum on the block
+  inline double PixelCost(double a, double b) const
+  {
+    return std::pow(std::abs(a - b), m_P);
+  }
+
 private:
   double m_P;
 };
 
+/** \class BlockMatchingCostVolumeTraits
+ *  \brief Tells how PixelWiseBlockMatchingImageFilter can compute a metric on a cost volume
+ *
+ *  Some metrics only depend on sums over the block, which the filter
+ *  computes for each disparity with running box sums instead of
+ *  evaluating the functor on each block. The Tag typedef is:
+ *  - SumOfPixelCostsTag if the metric is the sum of the functor
+ *    PixelCost(a, b) over the block (SSD, Lp),
+ *  - NCCTag for the normalized cross-correlation,
+ *  - NoCostVolumeTag otherwise (default): the functor is evaluated on
+ *    each block.
+ *
+ * \ingroup OTBDisparityMap
+ */
+struct NoCostVolumeTag
+{
+};
+struct SumOfPixelCostsTag
+{
+};
+struct NCCTag
+{
+};
+
+template <class TBlockMatchingFunctor>
+struct BlockMatchingCostVolumeTraits
+{
+  typedef NoCostVolumeTag Tag;
+};
+
+template <class TInputImage, class TOutputMetricImage>
+struct BlockMatchingCostVolumeTraits<SSDBlockMatching<TInputImage, TOutputMetricImage>>
+{
+  typedef SumOfPixelCostsTag Tag;
+};
+
+template <class TInputImage, class TOutputMetricImage>
+struct BlockMatchingCostVolumeTraits<LPBlockMatching<TInputImage, TOutputMetricImage>>
+{
+  typedef SumOfPixelCostsTag Tag;
+};
+
+template <class TInputImage, class TOutputMetricImage>
+struct BlockMatchingCostVolumeTraits<NCCBlockMatching<TInputImage, TOutputMetricImage>>
+{
+  typedef NCCTag Tag;
+};
+
 } // End Namespace Functor
 
 /** \class PixelWiseBlockMatchingImageFilter
@@ -282,6 +350,13 @@ private:
  *  an exploration radius indicates the disparity range to be explored around
  *  the initial estimate (global minimum and maximum values are still in use).
  *
+ *  When the metric only depends on sums over the block (SSD, Lp and NCC
+ *  functors, see BlockMatchingCostVolumeTraits) and no exploration radius is
+ *  set, the metric of each disparity is computed from the pixel costs with
+ *  separable running box sums: the cost per pixel no longer depends on the
+ *  block size. This can be disabled with UseCostVolumeOff(), the functor is
+ *  then evaluated on each block.
+ *
  *  \sa FineRegistrationImageFilter
  *  \sa StereorectificationDisplacementFieldSource
  *  \sa SubPixelDisparityImageFilter
@@ -394,6 +469,12 @@ public:
   itkSetMacro(ExplorationRadius, SizeType);
   itkGetConstReferenceMacro(ExplorationRadius, SizeType);
 
+  /** Set/Get whether the metric is computed on a cost volume when the
+   * functor allows it (on by default) */
+  itkSetMacro(UseCostVolume, bool);
+  itkGetConstReferenceMacro(UseCostVolume, bool);
+  itkBooleanMacro(UseCostVolume);
+
   /** Set/Get the initial horizontal disparity */
   itkSetMacro(InitHorizontalDisparity, int);
   itkGetConstReferenceMacro(InitHorizontalDisparity, int);
@@ -457,7 +538,61 @@ protected:
   /** Threaded generate data */
   void ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
 
+  /** Threaded generate data on a cost volume. Returns false if the
+   * functor or the settings do not allow it. */
+  bool CostVolumeGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId);
+
 private:
+  typedef typename Functor::BlockMatchingCostVolumeTraits<TBlockMatchingFunctor>::Tag CostVolumeTagType;
+
+  /** Buffers used by CostVolumeGenerateData() for the region of a thread */
+  struct CostVolumeData
+  {
+    /** Left pixels and mask validity around the region of the thread */
+    RegionType                 LeftRegion;
+    std::vector<double>        Left;
+    std::vector<unsigned char> LeftValid;
+
+    /** Right pixels and mask validity, for all the disparities */
+    RegionType                 RightRegion;
+    std::vector<double>        Right;
+    std::vector<unsigned char> RightValid;
+
+    /** Box sums of the pixels and their squares (NCC only) */
+    RegionType          LeftSumRegion;
+    std::vector<double> LeftSum;
+    std::vector<double> LeftSqSum;
+    RegionType          RightSumRegion;
+    std::vector<double> RightSum;
+    std::vector<double> RightSqSum;
+
+    /** Work buffers */
+    std::vector<double> Costs;
+    std::vector<double> RowSums;
+  };
+
+  /** Compute the metric of a disparity on a region (sums of pixel costs) */
+  void ComputeMetricPlane(CostVolumeData& data, const RegionType& region, int hdisparity, int vdisparity, std::vector<double>& metric,
+                          Functor::SumOfPixelCostsTag) const;
+
+  /** Compute the metric of a disparity on a region (normalized cross-correlation) */
+  void ComputeMetricPlane(CostVolumeData& data, const RegionType& region, int hdisparity, int vdisparity, std::vector<double>& metric,
+                          Functor::NCCTag) const;
+
+  /** Not used: CostVolumeGenerateData() returns before */
+  void ComputeMetricPlane(CostVolumeData&, const RegionType&, int, int, std::vector<double>&, Functor::NoCostVolumeTag) const
+  {
+  }
+
+  /** Copy an image region in a buffer, pixels outside the buffered region are 0 */
+  template <class TImage>
+  static void CopyRegion(const TImage* image, const RegionType& region, std::vector<double>& buffer);
+
+  /** Sums over a box of radius (rx, ry) of a (width + 2 rx) x (height + 2 ry)
+   * buffer, computed with running sums along rows then columns */
+  static void BoxSum(const double* input, unsigned int width, unsigned int height, unsigned int rx, unsigned int ry, std::vector<double>& rowSums,
+                     double* output);
+
   PixelWiseBlockMatchingImageFilter(const Self&) = delete;
   void operator                                  =(const Self&); // purposely not implemeFnted
 
@@ -500,6 +635,9 @@ private:
    *  Each coordinate shall lie in [0, m_Step-1]
    */
   IndexType m_GridIndex;
+
+  /** Compute the metric on a cost volume when the functor allows it */
+  bool m_UseCostVolume;
 };
 } // end namespace otb
 
@@ -24,6 +24,8 @@
 #include "otbPixelWiseBlockMatchingImageFilter.h"
 #include "itkProgressReporter.h"
 #include "itkConstantBoundaryCondition.h"
+#include "itkImageScanlineConstIterator.h"
+#include <limits>
 
 namespace otb
 {
@@ -66,6 +68,9 @@ PixelWiseBlockMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDispar
   // Default grid index
   m_GridIndex[0] = 0;
   m_GridIndex[1] = 0;
+
+  // Use the cost volume when the functor allows it
+  m_UseCostVolume = true;
 }
 
 
@@ -472,6 +477,12 @@ template <class TInputImage, class TOutputMetricImage, class TOutputDisparityIma
 void PixelWiseBlockMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage, TBlockMatchingFunctor>::ThreadedGenerateData(
     const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
 {
+  // Metrics computed from sums over the block use the cost volume
+  if (this->CostVolumeGenerateData(outputRegionForThread, threadId))
+  {
+    return;
+  }
+
   // Retrieve pointers
   const TInputImage*           inLeftPtr      = this->GetLeftInput();
   const TInputImage*           inRightPtr     = this->GetRightInput();
@@ -692,6 +703,407 @@ void PixelWiseBlockMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputD
   }
 }
 
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+bool PixelWiseBlockMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage, TBlockMatchingFunctor>::CostVolumeGenerateData(
+    const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  // The exploration radius restricts the disparities pixel by pixel: in that
+  // case evaluating the functor on the explored blocks is cheaper
+  if (!m_UseCostVolume || std::is_same<CostVolumeTagType, Functor::NoCostVolumeTag>::value || m_ExplorationRadius[0] >= 1 || m_ExplorationRadius[1] >= 1)
+  {
+    return false;
+  }
+
+  // Retrieve pointers
+  const TInputImage*     inLeftPtr      = this->GetLeftInput();
+  const TInputImage*     inRightPtr     = this->GetRightInput();
+  const TMaskImage*      inLeftMaskPtr  = this->GetLeftMaskInput();
+  const TMaskImage*      inRightMaskPtr = this->GetRightMaskInput();
+  TOutputMetricImage*    outMetricPtr   = this->GetMetricOutput();
+  TOutputDisparityImage* outHDispPtr    = this->GetHorizontalDisparityOutput();
+  TOutputDisparityImage* outVDispPtr    = this->GetVerticalDisparityOutput();
+
+  // Set-up progress reporting, as in ThreadedGenerateData()
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels() * (m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity + 1) *
+                                                     (m_MaximumVerticalDisparity - m_MinimumVerticalDisparity + 1),
+                                 100);
+
+  // Compute region for thread at full resolution
+  RegionType fullRegionForThread = this->ConvertSubsampledToFullRegion(outputRegionForThread, this->m_Step, this->m_GridIndex);
+
+  // Right region seen by all the disparities
+  RegionType rightRegion = fullRegionForThread;
+  IndexType  rightIndex  = rightRegion.GetIndex();
+  SizeType   rightSize   = rightRegion.GetSize();
+  rightIndex[0] += m_MinimumHorizontalDisparity;
+  rightIndex[1] += m_MinimumVerticalDisparity;
+  rightSize[0] += m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity;
+  rightSize[1] += m_MaximumVerticalDisparity - m_MinimumVerticalDisparity;
+  rightRegion.SetIndex(rightIndex);
+  rightRegion.SetSize(rightSize);
+
+  // Copy the pixels around these regions: the neighborhoods of the
+  // functors also see 0 outside the buffered regions
+  CostVolumeData data;
+  data.LeftSumRegion  = fullRegionForThread;
+  data.RightSumRegion = rightRegion;
+  data.LeftRegion     = fullRegionForThread;
+  data.LeftRegion.PadByRadius(m_Radius);
+  data.RightRegion = rightRegion;
+  data.RightRegion.PadByRadius(m_Radius);
+  CopyRegion(inLeftPtr, data.LeftRegion, data.Left);
+  CopyRegion(inRightPtr, data.RightRegion, data.Right);
+
+  // Mask validity, without the radius
+  std::vector<double> maskValues;
+  data.LeftValid.assign(data.LeftSumRegion.GetNumberOfPixels(), 1);
+  if (inLeftMaskPtr)
+  {
+    CopyRegion(inLeftMaskPtr, data.LeftSumRegion, maskValues);
+    for (unsigned int i = 0; i < maskValues.size(); ++i)
+    {
+      data.LeftValid[i] = maskValues[i] > 0;
+    }
+  }
+  data.RightValid.assign(data.RightSumRegion.GetNumberOfPixels(), 1);
+  if (inRightMaskPtr)
+  {
+    CopyRegion(inRightMaskPtr, data.RightSumRegion, maskValues);
+    for (unsigned int i = 0; i < maskValues.size(); ++i)
+    {
+      data.RightValid[i] = maskValues[i] > 0;
+    }
+  }
+
+  // The NCC needs the sums of the pixels and of their squares on each
+  // block, which do not depend on the disparity
+  if (std::is_same<CostVolumeTagType, Functor::NCCTag>::value)
+  {
+    std::vector<double> squares(data.Left.size());
+    for (unsigned int i = 0; i < squares.size(); ++i)
+    {
+      squares[i] = data.Left[i] * data.Left[i];
+    }
+    data.LeftSum.resize(data.LeftSumRegion.GetNumberOfPixels());
+    data.LeftSqSum.resize(data.LeftSumRegion.GetNumberOfPixels());
+    BoxSum(data.Left.data(), data.LeftSumRegion.GetSize(0), data.LeftSumRegion.GetSize(1), m_Radius[0], m_Radius[1], data.RowSums, data.LeftSum.data());
+    BoxSum(squares.data(), data.LeftSumRegion.GetSize(0), data.LeftSumRegion.GetSize(1), m_Radius[0], m_Radius[1], data.RowSums, data.LeftSqSum.data());
+
+    squares.resize(data.Right.size());
+    for (unsigned int i = 0; i < squares.size(); ++i)
+    {
+      squares[i] = data.Right[i] * data.Right[i];
+    }
+    data.RightSum.resize(data.RightSumRegion.GetNumberOfPixels());
+    data.RightSqSum.resize(data.RightSumRegion.GetNumberOfPixels());
+    BoxSum(data.Right.data(), data.RightSumRegion.GetSize(0), data.RightSumRegion.GetSize(1), m_Radius[0], m_Radius[1], data.RowSums, data.RightSum.data());
+    BoxSum(squares.data(), data.RightSumRegion.GetSize(0), data.RightSumRegion.GetSize(1), m_Radius[0], m_Radius[1], data.RowSums,
+           data.RightSqSum.data());
+  }
+
+  // Output buffers
+  typename TOutputMetricImage::PixelType*    outMetric = outMetricPtr->GetBufferPointer();
+  typename TOutputDisparityImage::PixelType* outHDisp  = outHDispPtr->GetBufferPointer();
+  typename TOutputDisparityImage::PixelType* outVDisp  = outVDispPtr->GetBufferPointer();
+
+  // Handle initialization properly
+  std::vector<unsigned char> init(outputRegionForThread.GetNumberOfPixels(), 0);
+
+  // step value as disparityType
+  DisparityPixelType stepDisparityInv = 1. / static_cast<DisparityPixelType>(this->m_Step);
+
+  const long step = this->m_Step;
+  const long gridX = this->m_GridIndex[0];
+  const long gridY = this->m_GridIndex[1];
+
+  std::vector<double> metricPlane;
+
+  // We loop on disparities, in the same order as ThreadedGenerateData()
+  for (int vdisparity = m_MinimumVerticalDisparity; vdisparity <= m_MaximumVerticalDisparity; ++vdisparity)
+  {
+    for (int hdisparity = m_MinimumHorizontalDisparity; hdisparity <= m_MaximumHorizontalDisparity; ++hdisparity)
+    {
+      // Left pixels whose shift is in the right image
+      IndexType rightRequestedRegionIndex = fullRegionForThread.GetIndex();
+      rightRequestedRegionIndex[0] += hdisparity;
+      rightRequestedRegionIndex[1] += vdisparity;
+
+      RegionType inputRightRegion;
+      inputRightRegion.SetIndex(rightRequestedRegionIndex);
+      inputRightRegion.SetSize(fullRegionForThread.GetSize());
+      if (!inputRightRegion.Crop(inRightPtr->GetLargestPossibleRegion()))
+      {
+        continue;
+      }
+
+      IndexType leftRequestedRegionIndex = inputRightRegion.GetIndex();
+      leftRequestedRegionIndex[0] -= hdisparity;
+      leftRequestedRegionIndex[1] -= vdisparity;
+
+      RegionType inputLeftRegion;
+      inputLeftRegion.SetIndex(leftRequestedRegionIndex);
+      inputLeftRegion.SetSize(inputRightRegion.GetSize());
+
+      // Metric of this disparity for each pixel of inputLeftRegion
+      this->ComputeMetricPlane(data, inputLeftRegion, hdisparity, vdisparity, metricPlane, CostVolumeTagType());
+
+      const DisparityPixelType hdisp = static_cast<DisparityPixelType>(hdisparity) * stepDisparityInv;
+      const DisparityPixelType vdisp = static_cast<DisparityPixelType>(vdisparity) * stepDisparityInv;
+      const long               x0    = inputLeftRegion.GetIndex(0);
+      const long               y0    = inputLeftRegion.GetIndex(1);
+      const long               x1    = x0 + static_cast<long>(inputLeftRegion.GetSize(0));
+      const long               y1    = y0 + static_cast<long>(inputLeftRegion.GetSize(1));
+
+      // First pixel of the subsampled grid in each row
+      long xStart = x0;
+      while ((xStart - gridX + step) % step != 0)
+      {
+        ++xStart;
+      }
+
+      for (long y = y0; y < y1; ++y)
+      {
+        if ((y - gridY + step) % step != 0)
+        {
+          continue;
+        }
+        for (long x = xStart; x < x1; x += step)
+        {
+          IndexType outIndex;
+          outIndex[0] = (x - gridX) / step;
+          outIndex[1] = (y - gridY) / step;
+
+          const long leftOffset  = (y - data.LeftSumRegion.GetIndex(1)) * data.LeftSumRegion.GetSize(0) + (x - data.LeftSumRegion.GetIndex(0));
+          const long rightOffset = (y + vdisparity - data.RightSumRegion.GetIndex(1)) * data.RightSumRegion.GetSize(0) +
+                                   (x + hdisparity - data.RightSumRegion.GetIndex(0));
+
+          // If the masks are valid
+          if (data.LeftValid[leftOffset] && data.RightValid[rightOffset])
+          {
+            // Round as the functor does, so that ties are broken the same way
+            const MetricValueType metric = static_cast<MetricValueType>(metricPlane[(y - y0) * (x1 - x0) + (x - x0)]);
+
+            const long initOffset = (outIndex[1] - outputRegionForThread.GetIndex(1)) * outputRegionForThread.GetSize(0) +
+                                    (outIndex[0] - outputRegionForThread.GetIndex(0));
+            const long metricOffset = outMetricPtr->ComputeOffset(outIndex);
+            const long hdispOffset  = outHDispPtr->ComputeOffset(outIndex);
+            const long vdispOffset  = outVDispPtr->ComputeOffset(outIndex);
+
+            // If we are at first loop, fill both outputs
+            if (!init[initOffset] || (m_Minimize && metric < outMetric[metricOffset]) || (!m_Minimize && metric > outMetric[metricOffset]))
+            {
+              outHDisp[hdispOffset]   = hdisp;
+              outVDisp[vdispOffset]   = vdisp;
+              outMetric[metricOffset] = metric;
+              init[initOffset]        = 1;
+            }
+          }
+          progress.CompletedPixel();
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+void PixelWiseBlockMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage, TBlockMatchingFunctor>::ComputeMetricPlane(
+    CostVolumeData& data, const RegionType& region, int hdisparity, int vdisparity, std::vector<double>& metric, Functor::SumOfPixelCostsTag) const
+{
+  // Pixel costs on the blocks centered in the region
+  RegionType costRegion = region;
+  costRegion.PadByRadius(m_Radius);
+
+  const unsigned long width  = costRegion.GetSize(0);
+  const unsigned long height = costRegion.GetSize(1);
+  data.Costs.resize(width * height);
+
+  for (unsigned long j = 0; j < height; ++j)
+  {
+    const long    y     = costRegion.GetIndex(1) + static_cast<long>(j);
+    const double* left  = &data.Left[(y - data.LeftRegion.GetIndex(1)) * data.LeftRegion.GetSize(0) + (costRegion.GetIndex(0) - data.LeftRegion.GetIndex(0))];
+    const double* right = &data.Right[(y + vdisparity - data.RightRegion.GetIndex(1)) * data.RightRegion.GetSize(0) +
+                                      (costRegion.GetIndex(0) + hdisparity - data.RightRegion.GetIndex(0))];
+    double* costs = &data.Costs[j * width];
+
+    // Contiguous loop, left for the compiler to vectorize
+    for (unsigned long i = 0; i < width; ++i)
+    {
+      costs[i] = m_Functor.PixelCost(left[i], right[i]);
+    }
+  }
+
+  metric.resize(region.GetNumberOfPixels());
+  BoxSum(data.Costs.data(), region.GetSize(0), region.GetSize(1), m_Radius[0], m_Radius[1], data.RowSums, metric.data());
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+void PixelWiseBlockMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage, TBlockMatchingFunctor>::ComputeMetricPlane(
+    CostVolumeData& data, const RegionType& region, int hdisparity, int vdisparity, std::vector<double>& metric, Functor::NCCTag) const
+{
+  // Products of the pixels on the blocks centered in the region
+  RegionType costRegion = region;
+  costRegion.PadByRadius(m_Radius);
+
+  const unsigned long width  = costRegion.GetSize(0);
+  const unsigned long height = costRegion.GetSize(1);
+  data.Costs.resize(width * height);
+
+  for (unsigned long j = 0; j < height; ++j)
+  {
+    const long    y     = costRegion.GetIndex(1) + static_cast<long>(j);
+    const double* left  = &data.Left[(y - data.LeftRegion.GetIndex(1)) * data.LeftRegion.GetSize(0) + (costRegion.GetIndex(0) - data.LeftRegion.GetIndex(0))];
+    const double* right = &data.Right[(y + vdisparity - data.RightRegion.GetIndex(1)) * data.RightRegion.GetSize(0) +
+                                      (costRegion.GetIndex(0) + hdisparity - data.RightRegion.GetIndex(0))];
+    double* costs = &data.Costs[j * width];
+
+    for (unsigned long i = 0; i < width; ++i)
+    {
+      costs[i] = left[i] * right[i];
+    }
+  }
+
+  metric.resize(region.GetNumberOfPixels());
+  BoxSum(data.Costs.data(), region.GetSize(0), region.GetSize(1), m_Radius[0], m_Radius[1], data.RowSums, metric.data());
+
+  // With n pixels per block, the functor computes
+  //   ncc = |cov| / (sigmaA * sigmaB)
+  //       = |n Sab - Sa Sb| / sqrt((n Saa - Sa^2) (n Sbb - Sb^2))
+  // where S are the sums on the block
+  const double n         = static_cast<double>((2 * m_Radius[0] + 1) * (2 * m_Radius[1] + 1));
+  const double minSigma2 = 1e-40 * n * (n - 1);
+  const double tolerance = 64 * std::numeric_limits<double>::epsilon();
+
+  const unsigned long rwidth = region.GetSize(0);
+  const unsigned long rheight = region.GetSize(1);
+  for (unsigned long j = 0; j < rheight; ++j)
+  {
+    const long    y         = region.GetIndex(1) + static_cast<long>(j);
+    const long    leftRow   = (y - data.LeftSumRegion.GetIndex(1)) * data.LeftSumRegion.GetSize(0) + (region.GetIndex(0) - data.LeftSumRegion.GetIndex(0));
+    const long    rightRow  = (y + vdisparity - data.RightSumRegion.GetIndex(1)) * data.RightSumRegion.GetSize(0) +
+                              (region.GetIndex(0) + hdisparity - data.RightSumRegion.GetIndex(0));
+    const double* sumA      = &data.LeftSum[leftRow];
+    const double* sumSqA    = &data.LeftSqSum[leftRow];
+    const double* sumB      = &data.RightSum[rightRow];
+    const double* sumSqB    = &data.RightSqSum[rightRow];
+    double*       sumAB     = &metric[j * rwidth];
+
+    for (unsigned long i = 0; i < rwidth; ++i)
+    {
+      const double cov    = n * sumAB[i] - sumA[i] * sumB[i];
+      double       sigmaA = n * sumSqA[i] - sumA[i] * sumA[i];
+      double       sigmaB = n * sumSqB[i] - sumB[i] * sumB[i];
+
+      // Variances lost in the rounding of the sums are null
+      if (sigmaA <= tolerance * n * sumSqA[i])
+      {
+        sigmaA = 0.;
+      }
+      if (sigmaB <= tolerance * n * sumSqB[i])
+      {
+        sigmaB = 0.;
+      }
+
+      if (sigmaA > minSigma2 && sigmaB > minSigma2)
+      {
+        sumAB[i] = std::abs(cov) / std::sqrt(sigmaA * sigmaB);
+      }
+      else
+      {
+        sumAB[i] = 0.;
+      }
+    }
+  }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+template <class TImage>
+void PixelWiseBlockMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage, TBlockMatchingFunctor>::CopyRegion(
+    const TImage* image, const RegionType& region, std::vector<double>& buffer)
+{
+  buffer.assign(region.GetNumberOfPixels(), 0.);
+
+  RegionType bufferedRegion = region;
+  if (!bufferedRegion.Crop(image->GetBufferedRegion()))
+  {
+    return;
+  }
+
+  itk::ImageScanlineConstIterator<TImage> it(image, bufferedRegion);
+  it.GoToBegin();
+  while (!it.IsAtEnd())
+  {
+    const typename TImage::IndexType index = it.GetIndex();
+    double* line = &buffer[(index[1] - region.GetIndex(1)) * region.GetSize(0) + (index[0] - region.GetIndex(0))];
+    while (!it.IsAtEndOfLine())
+    {
+      *line = static_cast<double>(it.Get());
+      ++line;
+      ++it;
+    }
+    it.NextLine();
+  }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+void PixelWiseBlockMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage, TBlockMatchingFunctor>::BoxSum(
+    const double* input, unsigned int width, unsigned int height, unsigned int rx, unsigned int ry, std::vector<double>& rowSums, double* output)
+{
+  if (width == 0 || height == 0)
+  {
+    return;
+  }
+
+  const unsigned int inWidth  = width + 2 * rx;
+  const unsigned int inHeight = height + 2 * ry;
+  rowSums.resize(static_cast<unsigned long>(width) * inHeight);
+
+  // Running sums along the rows
+  for (unsigned int j = 0; j < inHeight; ++j)
+  {
+    const double* in  = input + static_cast<unsigned long>(j) * inWidth;
+    double*       out = &rowSums[static_cast<unsigned long>(j) * width];
+    double        sum = 0.;
+    for (unsigned int i = 0; i < 2 * rx + 1; ++i)
+    {
+      sum += in[i];
+    }
+    out[0] = sum;
+    for (unsigned int i = 1; i < width; ++i)
+    {
+      sum += in[i + 2 * rx] - in[i - 1];
+      out[i] = sum;
+    }
+  }
+
+  // Running sums along the columns, a whole row at a time
+  double* out = output;
+  for (unsigned int i = 0; i < width; ++i)
+  {
+    out[i] = 0.;
+  }
+  for (unsigned int k = 0; k < 2 * ry + 1; ++k)
+  {
+    const double* in = &rowSums[static_cast<unsigned long>(k) * width];
+    for (unsigned int i = 0; i < width; ++i)
+    {
+      out[i] += in[i];
+    }
+  }
+  for (unsigned int j = 1; j < height; ++j)
+  {
+    const double* previous = output + static_cast<unsigned long>(j - 1) * width;
+    const double* added    = &rowSums[static_cast<unsigned long>(j + 2 * ry) * width];
+    const double* removed  = &rowSums[static_cast<unsigned long>(j - 1) * width];
+    out                    = output + static_cast<unsigned long>(j) * width;
+    for (unsigned int i = 0; i < width; ++i)
+    {
+      out[i] = previous[i] + added[i] - removed[i];
+    }
+  }
+}
+
 template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
 typename PixelWiseBlockMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage, TBlockMatchingFunctor>::RegionType
 PixelWiseBlockMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage, TBlockMatchingFunctor>::ConvertFullToSubsampledRegion(
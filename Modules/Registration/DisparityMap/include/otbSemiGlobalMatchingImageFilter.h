@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSemiGlobalMatchingImageFilter_h
+#define otbSemiGlobalMatchingImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "otbImage.h"
+#include <vector>
+
+namespace otb
+{
+
+/** \class SemiGlobalMatchingImageFilter
+ *  \brief Estimate a disparity map between epipolar images with semi-global matching
+ *
+ *  This filter computes the horizontal disparity between a pair of
+ *  images in epipolar geometry (such as the ones resampled with the grids
+ *  of StereorectificationDisplacementFieldSource), with the semi-global
+ *  matching method of Hirschmuller:
+ *  - the matching cost of a pixel and a disparity is the Hamming distance
+ *    between the census transforms of the left and right pixels, on a
+ *    window of radius SetRadius() (at most 64 neighbors, so a radius of 3),
+ *  - costs are aggregated along 8 paths with a penalty P1 for disparity
+ *    changes of one pixel and P2 for larger changes,
+ *  - the disparity minimizing the sum of the aggregated costs is kept,
+ *    and refined by fitting a parabola if SubPixelRefinementOn() is set.
+ *
+ *  The outputs are the same as the ones of PixelWiseBlockMatchingImageFilter:
+ *  the metric image (sum of the aggregated costs at the kept disparity),
+ *  the horizontal disparity map and the vertical disparity map (always 0).
+ *  Pixels where the left mask is not strictly positive exhibit a null
+ *  metric value and the minimum disparity. Right pixels where the right mask
+ *  is not strictly positive have the maximum cost.
+ *
+ *  Costs are stored on 16 bits. To bound the memory, the region of each
+ *  thread is processed by blocks of at most BlockSize x BlockSize pixels,
+ *  and the paths only run on each block padded by an overlap (SetOverlap()).
+ *  The memory used by each thread is about 4 x (BlockSize + 2 Overlap)^2 x
+ *  (number of disparities) bytes. Paths are cut at the border of the padded
+ *  block, so the overlap should be large enough for the penalties to
+ *  propagate.
+ *
+ *  \sa PixelWiseBlockMatchingImageFilter
+ *  \sa StereorectificationDisplacementFieldSource
+ *
+ *  \ingroup Streamed
+ *  \ingroup Threaded
+ *
+ * \ingroup OTBDisparityMap
+ */
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage = TOutputMetricImage, class TMaskImage = otb::Image<unsigned char>>
+class ITK_EXPORT SemiGlobalMatchingImageFilter : public itk::ImageToImageFilter<TInputImage, TOutputDisparityImage>
+{
+public:
+  /** Standard class typedef */
+  typedef SemiGlobalMatchingImageFilter Self;
+  typedef itk::ImageToImageFilter<TInputImage, TOutputDisparityImage> Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SemiGlobalMatchingImageFilter, ImageToImageFilter);
+
+  /** Useful typedefs */
+  typedef TInputImage           InputImageType;
+  typedef TOutputMetricImage    OutputMetricImageType;
+  typedef TOutputDisparityImage OutputDisparityImageType;
+  typedef TMaskImage            InputMaskImageType;
+
+  typedef typename InputImageType::SizeType   SizeType;
+  typedef typename InputImageType::IndexType  IndexType;
+  typedef typename InputImageType::RegionType RegionType;
+
+  typedef typename TOutputMetricImage::ValueType       MetricValueType;
+  typedef typename OutputDisparityImageType::PixelType DisparityPixelType;
+
+  /** Type of the matching and aggregated costs */
+  typedef unsigned short CostType;
+
+  /** Set left input */
+  void SetLeftInput(const TInputImage* image);
+
+  /** Set right input */
+  void SetRightInput(const TInputImage* image);
+
+  /** Set mask input (optional) */
+  void SetLeftMaskInput(const TMaskImage* image);
+
+  /** Set right mask input (optional) */
+  void SetRightMaskInput(const TMaskImage* image);
+
+  /** Get the inputs */
+  const TInputImage* GetLeftInput() const;
+  const TInputImage* GetRightInput() const;
+  const TMaskImage*  GetLeftMaskInput() const;
+  const TMaskImage*  GetRightMaskInput() const;
+
+  /** Get the metric output */
+  const TOutputMetricImage* GetMetricOutput() const;
+  TOutputMetricImage*       GetMetricOutput();
+
+  /** Get the disparity output */
+  const TOutputDisparityImage* GetHorizontalDisparityOutput() const;
+  TOutputDisparityImage*       GetHorizontalDisparityOutput();
+
+  /** Get the disparity output */
+  const TOutputDisparityImage* GetVerticalDisparityOutput() const;
+  TOutputDisparityImage*       GetVerticalDisparityOutput();
+
+  /** Set unsigned int radius */
+  void SetRadius(unsigned int radius)
+  {
+    m_Radius.Fill(radius);
+  }
+
+  /** Set/Get the radius of the census transform window */
+  itkSetMacro(Radius, SizeType);
+  itkGetConstReferenceMacro(Radius, SizeType);
+
+  /*** Set/Get the minimum disparity to explore */
+  itkSetMacro(MinimumHorizontalDisparity, int);
+  itkGetConstReferenceMacro(MinimumHorizontalDisparity, int);
+
+  /*** Set/Get the maximum disparity to explore */
+  itkSetMacro(MaximumHorizontalDisparity, int);
+  itkGetConstReferenceMacro(MaximumHorizontalDisparity, int);
+
+  /** Set/Get the penalty of disparity changes of one pixel along a path */
+  itkSetMacro(P1, unsigned int);
+  itkGetConstReferenceMacro(P1, unsigned int);
+
+  /** Set/Get the penalty of larger disparity changes along a path */
+  itkSetMacro(P2, unsigned int);
+  itkGetConstReferenceMacro(P2, unsigned int);
+
+  /** Set/Get the number of pixels the paths run beyond each block */
+  itkSetMacro(Overlap, unsigned int);
+  itkGetConstReferenceMacro(Overlap, unsigned int);
+
+  /** Set/Get the maximum size of the blocks processed at once */
+  itkSetMacro(BlockSize, unsigned int);
+  itkGetConstReferenceMacro(BlockSize, unsigned int);
+
+  /** Set/Get whether disparities are refined by fitting a parabola on the costs */
+  itkSetMacro(SubPixelRefinement, bool);
+  itkGetConstReferenceMacro(SubPixelRefinement, bool);
+  itkBooleanMacro(SubPixelRefinement);
+
+protected:
+  /** Constructor */
+  SemiGlobalMatchingImageFilter();
+
+  /** Destructor */
+  ~SemiGlobalMatchingImageFilter() override
+  {
+  }
+
+  /** Generate input requested region */
+  void GenerateInputRequestedRegion() override;
+
+  /** Before threaded generate data */
+  void BeforeThreadedGenerateData() override;
+
+  /** Threaded generate data */
+  void ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
+
+private:
+  SemiGlobalMatchingImageFilter(const Self&) = delete;
+  void operator=(const Self&) = delete;
+
+  /** Buffers of a thread, reused from one block to the next */
+  struct BlockData
+  {
+    std::vector<double>             Pixels;
+    std::vector<unsigned long long> LeftCensus;
+    std::vector<unsigned long long> RightCensus;
+    std::vector<unsigned char>      RightValid;
+    std::vector<CostType>           Costs;
+    std::vector<CostType>           Sums;
+    std::vector<CostType>           PreviousLine;
+    std::vector<CostType>           CurrentLine;
+    std::vector<CostType>           PreviousMin;
+    std::vector<CostType>           CurrentMin;
+  };
+
+  /** Compute the disparities of a block */
+  void ProcessBlock(const RegionType& block, BlockData& data) const;
+
+  /** Census transform of the pixels of a region */
+  void ComputeCensus(const TInputImage* image, const RegionType& region, std::vector<double>& pixels, std::vector<unsigned long long>& census) const;
+
+  /** Add the costs aggregated along one direction to data.Sums */
+  void AggregatePath(unsigned int width, unsigned int height, int dx, int dy, BlockData& data) const;
+
+  /** Number of bits of the census transform */
+  unsigned int GetNumberOfCensusBits() const;
+
+  /** The radius of the census window */
+  SizeType m_Radius;
+
+  /** Minimum horizontal disparity */
+  int m_MinimumHorizontalDisparity;
+
+  /** Maximum horizontal disparity */
+  int m_MaximumHorizontalDisparity;
+
+  /** Penalty of small disparity changes */
+  unsigned int m_P1;
+
+  /** Penalty of large disparity changes */
+  unsigned int m_P2;
+
+  /** Padding of the blocks */
+  unsigned int m_Overlap;
+
+  /** Maximum size of the blocks */
+  unsigned int m_BlockSize;
+
+  /** Refine disparities with a parabola */
+  bool m_SubPixelRefinement;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbSemiGlobalMatchingImageFilter.hxx"
+#endif
+
+#endif
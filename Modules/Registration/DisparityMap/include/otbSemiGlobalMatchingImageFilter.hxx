@@ -0,0 +1,634 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSemiGlobalMatchingImageFilter_hxx
+#define otbSemiGlobalMatchingImageFilter_hxx
+
+#include "otbSemiGlobalMatchingImageFilter.h"
+#include "itkProgressReporter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include <algorithm>
+#include <limits>
+
+namespace otb
+{
+
+namespace
+{
+/** Number of bits set in a census transform */
+inline unsigned int CensusHammingWeight(unsigned long long v)
+{
+  v = v - ((v >> 1) & 0x5555555555555555ULL);
+  v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+  v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return static_cast<unsigned int>((v * 0x0101010101010101ULL) >> 56);
+}
+} // end anonymous namespace
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::SemiGlobalMatchingImageFilter()
+{
+  // Set the number of inputs
+  this->SetNumberOfRequiredInputs(2);
+
+  // Set the outputs
+  this->SetNumberOfRequiredOutputs(3);
+  this->SetNthOutput(0, TOutputMetricImage::New());
+  this->SetNthOutput(1, TOutputDisparityImage::New());
+  this->SetNthOutput(2, TOutputDisparityImage::New());
+
+  // Default census window : 5x5
+  m_Radius.Fill(2);
+
+  // Default disparity range
+  m_MinimumHorizontalDisparity = -10;
+  m_MaximumHorizontalDisparity = 10;
+
+  // Default penalties, in number of census bits
+  m_P1 = 8;
+  m_P2 = 32;
+
+  // Default blocks
+  m_Overlap   = 32;
+  m_BlockSize = 192;
+
+  m_SubPixelRefinement = true;
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::SetLeftInput(const TInputImage* image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(0, const_cast<TInputImage*>(image));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::SetRightInput(const TInputImage* image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(1, const_cast<TInputImage*>(image));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::SetLeftMaskInput(const TMaskImage* image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(2, const_cast<TMaskImage*>(image));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::SetRightMaskInput(const TMaskImage* image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(3, const_cast<TMaskImage*>(image));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TInputImage* SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GetLeftInput() const
+{
+  if (this->GetNumberOfInputs() < 1)
+  {
+    return nullptr;
+  }
+  return static_cast<const TInputImage*>(this->itk::ProcessObject::GetInput(0));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TInputImage* SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GetRightInput() const
+{
+  if (this->GetNumberOfInputs() < 2)
+  {
+    return nullptr;
+  }
+  return static_cast<const TInputImage*>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TMaskImage* SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GetLeftMaskInput() const
+{
+  if (this->GetNumberOfInputs() < 3)
+  {
+    return nullptr;
+  }
+  return static_cast<const TMaskImage*>(this->itk::ProcessObject::GetInput(2));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TMaskImage* SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GetRightMaskInput() const
+{
+  if (this->GetNumberOfInputs() < 4)
+  {
+    return nullptr;
+  }
+  return static_cast<const TMaskImage*>(this->itk::ProcessObject::GetInput(3));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TOutputMetricImage* SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GetMetricOutput() const
+{
+  if (this->GetNumberOfOutputs() < 1)
+  {
+    return nullptr;
+  }
+  return static_cast<const TOutputMetricImage*>(this->itk::ProcessObject::GetOutput(0));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+TOutputMetricImage* SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GetMetricOutput()
+{
+  if (this->GetNumberOfOutputs() < 1)
+  {
+    return nullptr;
+  }
+  return static_cast<TOutputMetricImage*>(this->itk::ProcessObject::GetOutput(0));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TOutputDisparityImage*
+SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GetHorizontalDisparityOutput() const
+{
+  if (this->GetNumberOfOutputs() < 2)
+  {
+    return nullptr;
+  }
+  return static_cast<const TOutputDisparityImage*>(this->itk::ProcessObject::GetOutput(1));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+TOutputDisparityImage* SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GetHorizontalDisparityOutput()
+{
+  if (this->GetNumberOfOutputs() < 2)
+  {
+    return nullptr;
+  }
+  return static_cast<TOutputDisparityImage*>(this->itk::ProcessObject::GetOutput(1));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TOutputDisparityImage*
+SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GetVerticalDisparityOutput() const
+{
+  if (this->GetNumberOfOutputs() < 3)
+  {
+    return nullptr;
+  }
+  return static_cast<const TOutputDisparityImage*>(this->itk::ProcessObject::GetOutput(2));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+TOutputDisparityImage* SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GetVerticalDisparityOutput()
+{
+  if (this->GetNumberOfOutputs() < 3)
+  {
+    return nullptr;
+  }
+  return static_cast<TOutputDisparityImage*>(this->itk::ProcessObject::GetOutput(2));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+unsigned int SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GetNumberOfCensusBits() const
+{
+  return (2 * m_Radius[0] + 1) * (2 * m_Radius[1] + 1) - 1;
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::GenerateInputRequestedRegion()
+{
+  // Call superclass implementation
+  Superclass::GenerateInputRequestedRegion();
+
+  // Retrieve input pointers
+  TInputImage* inLeftPtr      = const_cast<TInputImage*>(this->GetLeftInput());
+  TInputImage* inRightPtr     = const_cast<TInputImage*>(this->GetRightInput());
+  TMaskImage*  inLeftMaskPtr  = const_cast<TMaskImage*>(this->GetLeftMaskInput());
+  TMaskImage*  inRightMaskPtr = const_cast<TMaskImage*>(this->GetRightMaskInput());
+
+  TOutputMetricImage* outMetricPtr = this->GetMetricOutput();
+
+  // Check pointers before using them
+  if (!inLeftPtr || !inRightPtr || !outMetricPtr)
+  {
+    return;
+  }
+
+  // Now, we impose that both inputs have the same size
+  if (inLeftPtr->GetLargestPossibleRegion() != inRightPtr->GetLargestPossibleRegion())
+  {
+    itkExceptionMacro(<< "Left and right images do not have the same size ! Left largest region: " << inLeftPtr->GetLargestPossibleRegion()
+                      << ", right largest region: " << inRightPtr->GetLargestPossibleRegion());
+  }
+  if (inLeftMaskPtr && inLeftPtr->GetLargestPossibleRegion() != inLeftMaskPtr->GetLargestPossibleRegion())
+  {
+    itkExceptionMacro(<< "Left and mask images do not have the same size ! Left largest region: " << inLeftPtr->GetLargestPossibleRegion()
+                      << ", mask largest region: " << inLeftMaskPtr->GetLargestPossibleRegion());
+  }
+  if (inRightMaskPtr && inRightPtr->GetLargestPossibleRegion() != inRightMaskPtr->GetLargestPossibleRegion())
+  {
+    itkExceptionMacro(<< "Right and mask images do not have the same size ! Right largest region: " << inRightPtr->GetLargestPossibleRegion()
+                      << ", mask largest region: " << inRightMaskPtr->GetLargestPossibleRegion());
+  }
+
+  // Paths run on the overlap, census needs the radius
+  RegionType inputLeftRegion = outMetricPtr->GetRequestedRegion();
+  SizeType   padding;
+  padding[0] = m_Overlap + m_Radius[0];
+  padding[1] = m_Overlap + m_Radius[1];
+  inputLeftRegion.PadByRadius(padding);
+
+  // Corresponding region in the right image
+  RegionType inputRightRegion = inputLeftRegion;
+  IndexType  rightIndex       = inputRightRegion.GetIndex();
+  SizeType   rightSize        = inputRightRegion.GetSize();
+  rightIndex[0] += m_MinimumHorizontalDisparity;
+  rightSize[0] += m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity;
+  inputRightRegion.SetIndex(rightIndex);
+  inputRightRegion.SetSize(rightSize);
+
+  if (!inputLeftRegion.Crop(inLeftPtr->GetLargestPossibleRegion()))
+  {
+    inLeftPtr->SetRequestedRegion(inputLeftRegion);
+
+    itk::InvalidRequestedRegionError e(__FILE__, __LINE__);
+    std::ostringstream               msg;
+    msg << this->GetNameOfClass() << "::GenerateInputRequestedRegion()";
+    e.SetLocation(msg.str());
+    e.SetDescription("Requested region is (at least partially) outside the largest possible region of left image.");
+    e.SetDataObject(inLeftPtr);
+    throw e;
+  }
+  inLeftPtr->SetRequestedRegion(inputLeftRegion);
+
+  // The right region may be outside the right image for large disparities:
+  // these right pixels then have the maximum cost
+  if (!inputRightRegion.Crop(inRightPtr->GetLargestPossibleRegion()))
+  {
+    inputRightRegion = inputLeftRegion;
+  }
+  inRightPtr->SetRequestedRegion(inputRightRegion);
+
+  if (inLeftMaskPtr)
+  {
+    inLeftMaskPtr->SetRequestedRegion(inputLeftRegion);
+  }
+  if (inRightMaskPtr)
+  {
+    inRightMaskPtr->SetRequestedRegion(inputRightRegion);
+  }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::BeforeThreadedGenerateData()
+{
+  if (m_MaximumHorizontalDisparity < m_MinimumHorizontalDisparity)
+  {
+    itkExceptionMacro(<< "Maximum disparity (" << m_MaximumHorizontalDisparity << ") is lower than minimum disparity (" << m_MinimumHorizontalDisparity
+                      << ")");
+  }
+  if (GetNumberOfCensusBits() > 64)
+  {
+    itkExceptionMacro(<< "Census window of radius " << m_Radius << " has more than 64 neighbors");
+  }
+  if (m_P1 > m_P2)
+  {
+    itkExceptionMacro(<< "P1 (" << m_P1 << ") should not be greater than P2 (" << m_P2 << ")");
+  }
+  // The sum of the 8 aggregated costs must fit in CostType
+  if (8 * (static_cast<unsigned long>(GetNumberOfCensusBits()) + m_P2) > std::numeric_limits<CostType>::max())
+  {
+    itkExceptionMacro(<< "P2 (" << m_P2 << ") is too large to store the aggregated costs on " << 8 * sizeof(CostType) << " bits");
+  }
+  if (m_BlockSize == 0)
+  {
+    m_BlockSize = 1;
+  }
+
+  // Fill buffers with default values
+  this->GetMetricOutput()->FillBuffer(0.);
+  this->GetHorizontalDisparityOutput()->FillBuffer(static_cast<DisparityPixelType>(m_MinimumHorizontalDisparity));
+  this->GetVerticalDisparityOutput()->FillBuffer(0.);
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::ThreadedGenerateData(
+    const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  // Process the region by blocks
+  const IndexType index = outputRegionForThread.GetIndex();
+  const SizeType  size  = outputRegionForThread.GetSize();
+
+  // Progress is reported by block
+  itk::ProgressReporter progress(this, threadId, ((size[0] + m_BlockSize - 1) / m_BlockSize) * ((size[1] + m_BlockSize - 1) / m_BlockSize));
+
+  BlockData data;
+  for (unsigned long y = 0; y < size[1]; y += m_BlockSize)
+  {
+    for (unsigned long x = 0; x < size[0]; x += m_BlockSize)
+    {
+      IndexType blockIndex;
+      SizeType  blockSize;
+      blockIndex[0] = index[0] + x;
+      blockIndex[1] = index[1] + y;
+      blockSize[0]  = std::min<unsigned long>(m_BlockSize, size[0] - x);
+      blockSize[1]  = std::min<unsigned long>(m_BlockSize, size[1] - y);
+
+      RegionType block(blockIndex, blockSize);
+      this->ProcessBlock(block, data);
+      progress.CompletedPixel();
+    }
+  }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::ProcessBlock(const RegionType& block,
+                                                                                                                     BlockData&        data) const
+{
+  const TInputImage* inLeftPtr      = this->GetLeftInput();
+  const TInputImage* inRightPtr     = this->GetRightInput();
+  const TMaskImage*  inLeftMaskPtr  = this->GetLeftMaskInput();
+  const TMaskImage*  inRightMaskPtr = this->GetRightMaskInput();
+
+  // Region where the paths run
+  RegionType region = block;
+  SizeType   overlap;
+  overlap.Fill(m_Overlap);
+  region.PadByRadius(overlap);
+  region.Crop(inLeftPtr->GetLargestPossibleRegion());
+
+  const unsigned int width        = region.GetSize(0);
+  const unsigned int height       = region.GetSize(1);
+  const unsigned int nbDisparities = m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity + 1;
+
+  // Right pixels of all the disparities
+  RegionType rightRegion = region;
+  IndexType  rightIndex  = rightRegion.GetIndex();
+  SizeType   rightSize   = rightRegion.GetSize();
+  rightIndex[0] += m_MinimumHorizontalDisparity;
+  rightSize[0] += nbDisparities - 1;
+  rightRegion.SetIndex(rightIndex);
+  rightRegion.SetSize(rightSize);
+  const unsigned int rightWidth = rightSize[0];
+
+  this->ComputeCensus(inLeftPtr, region, data.Pixels, data.LeftCensus);
+  this->ComputeCensus(inRightPtr, rightRegion, data.Pixels, data.RightCensus);
+
+  // Right pixels outside the right image, or masked, have the maximum cost
+  data.RightValid.assign(rightRegion.GetNumberOfPixels(), 0);
+  RegionType validRegion = rightRegion;
+  if (validRegion.Crop(inRightPtr->GetLargestPossibleRegion()))
+  {
+    for (long y = validRegion.GetIndex(1); y < validRegion.GetIndex(1) + static_cast<long>(validRegion.GetSize(1)); ++y)
+    {
+      for (long x = validRegion.GetIndex(0); x < validRegion.GetIndex(0) + static_cast<long>(validRegion.GetSize(0)); ++x)
+      {
+        data.RightValid[(y - rightIndex[1]) * rightWidth + (x - rightIndex[0])] = 1;
+      }
+    }
+    if (inRightMaskPtr)
+    {
+      itk::ImageRegionConstIterator<TMaskImage> maskIt(inRightMaskPtr, validRegion);
+      for (maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt)
+      {
+        if (!(maskIt.Get() > 0))
+        {
+          const IndexType maskIndex                                                               = maskIt.GetIndex();
+          data.RightValid[(maskIndex[1] - rightIndex[1]) * rightWidth + (maskIndex[0] - rightIndex[0])] = 0;
+        }
+      }
+    }
+  }
+
+  // Matching costs
+  const CostType maxCost = static_cast<CostType>(GetNumberOfCensusBits());
+  data.Costs.resize(static_cast<unsigned long>(width) * height * nbDisparities);
+  for (unsigned int j = 0; j < height; ++j)
+  {
+    for (unsigned int i = 0; i < width; ++i)
+    {
+      const unsigned long long   leftCensus  = data.LeftCensus[j * width + i];
+      const unsigned long long*  rightCensus = &data.RightCensus[j * rightWidth + i];
+      const unsigned char*       rightValid  = &data.RightValid[j * rightWidth + i];
+      CostType*                  costs       = &data.Costs[(static_cast<unsigned long>(j) * width + i) * nbDisparities];
+      for (unsigned int k = 0; k < nbDisparities; ++k)
+      {
+        costs[k] = rightValid[k] ? static_cast<CostType>(CensusHammingWeight(leftCensus ^ rightCensus[k])) : maxCost;
+      }
+    }
+  }
+
+  // Aggregation along 8 paths
+  data.Sums.assign(data.Costs.size(), 0);
+  const int directions[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, 1}, {1, -1}, {-1, -1}};
+  for (unsigned int p = 0; p < 8; ++p)
+  {
+    this->AggregatePath(width, height, directions[p][0], directions[p][1], data);
+  }
+
+  // Winner takes all, on the block only
+  TOutputMetricImage*    outMetricPtr = const_cast<Self*>(this)->GetMetricOutput();
+  TOutputDisparityImage* outHDispPtr  = const_cast<Self*>(this)->GetHorizontalDisparityOutput();
+
+  itk::ImageRegionIterator<TOutputMetricImage>    outMetricIt(outMetricPtr, block);
+  itk::ImageRegionIterator<TOutputDisparityImage> outHDispIt(outHDispPtr, block);
+  itk::ImageRegionConstIterator<TMaskImage>       inLeftMaskIt;
+  if (inLeftMaskPtr)
+  {
+    inLeftMaskIt = itk::ImageRegionConstIterator<TMaskImage>(inLeftMaskPtr, block);
+    inLeftMaskIt.GoToBegin();
+  }
+
+  for (outMetricIt.GoToBegin(), outHDispIt.GoToBegin(); !outMetricIt.IsAtEnd(); ++outMetricIt, ++outHDispIt)
+  {
+    const bool valid = !inLeftMaskPtr || inLeftMaskIt.Get() > 0;
+    if (inLeftMaskPtr)
+    {
+      ++inLeftMaskIt;
+    }
+    if (!valid)
+    {
+      continue;
+    }
+
+    const IndexType outIndex = outMetricIt.GetIndex();
+    const CostType* sums = &data.Sums[(static_cast<unsigned long>(outIndex[1] - region.GetIndex(1)) * width + (outIndex[0] - region.GetIndex(0))) * nbDisparities];
+
+    unsigned int best = 0;
+    for (unsigned int k = 1; k < nbDisparities; ++k)
+    {
+      if (sums[k] < sums[best])
+      {
+        best = k;
+      }
+    }
+
+    double disparity = static_cast<double>(m_MinimumHorizontalDisparity) + best;
+    if (m_SubPixelRefinement && best > 0 && best + 1 < nbDisparities)
+    {
+      const double previous  = sums[best - 1];
+      const double next      = sums[best + 1];
+      const double curvature = previous - 2. * sums[best] + next;
+      if (curvature > 0.)
+      {
+        disparity += 0.5 * (previous - next) / curvature;
+      }
+    }
+
+    outHDispIt.Set(static_cast<DisparityPixelType>(disparity));
+    outMetricIt.Set(static_cast<MetricValueType>(sums[best]));
+  }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::ComputeCensus(
+    const TInputImage* image, const RegionType& region, std::vector<double>& pixels, std::vector<unsigned long long>& census) const
+{
+  // Copy the pixels around the region, 0 outside the buffered region
+  RegionType paddedRegion = region;
+  paddedRegion.PadByRadius(m_Radius);
+  const unsigned int paddedWidth = paddedRegion.GetSize(0);
+
+  pixels.assign(paddedRegion.GetNumberOfPixels(), 0.);
+  RegionType bufferedRegion = paddedRegion;
+  if (bufferedRegion.Crop(image->GetBufferedRegion()))
+  {
+    itk::ImageRegionConstIterator<TInputImage> it(image, bufferedRegion);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const IndexType index = it.GetIndex();
+      pixels[(index[1] - paddedRegion.GetIndex(1)) * paddedWidth + (index[0] - paddedRegion.GetIndex(0))] = static_cast<double>(it.Get());
+    }
+  }
+
+  // One bit per neighbor: is it darker than the center ?
+  const unsigned int width  = region.GetSize(0);
+  const unsigned int height = region.GetSize(1);
+  const unsigned int rx     = m_Radius[0];
+  const unsigned int ry     = m_Radius[1];
+  census.resize(region.GetNumberOfPixels());
+  for (unsigned int j = 0; j < height; ++j)
+  {
+    for (unsigned int i = 0; i < width; ++i)
+    {
+      const double       center = pixels[(j + ry) * paddedWidth + i + rx];
+      unsigned long long bits   = 0;
+      for (unsigned int v = 0; v < 2 * ry + 1; ++v)
+      {
+        const double* row = &pixels[(j + v) * paddedWidth + i];
+        for (unsigned int u = 0; u < 2 * rx + 1; ++u)
+        {
+          if (u != rx || v != ry)
+          {
+            bits = (bits << 1) | (row[u] < center ? 1 : 0);
+          }
+        }
+      }
+      census[j * width + i] = bits;
+    }
+  }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void SemiGlobalMatchingImageFilter<TInputImage, TOutputMetricImage, TOutputDisparityImage, TMaskImage>::AggregatePath(unsigned int width,
+                                                                                                                      unsigned int height, int dx, int dy,
+                                                                                                                      BlockData& data) const
+{
+  const unsigned int nbDisparities = m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity + 1;
+  const unsigned int p1            = m_P1;
+  const unsigned int p2            = m_P2;
+
+  // Aggregated costs of the previous line (along dy) and of the current one
+  data.PreviousLine.resize(static_cast<unsigned long>(width) * nbDisparities);
+  data.CurrentLine.resize(static_cast<unsigned long>(width) * nbDisparities);
+  data.PreviousMin.resize(width);
+  data.CurrentMin.resize(width);
+
+  for (unsigned int l = 0; l < height; ++l)
+  {
+    const unsigned int j = dy >= 0 ? l : height - 1 - l;
+
+    // Along a row, the previous pixel is on the current line
+    for (unsigned int m = 0; m < width; ++m)
+    {
+      const unsigned int i = dx >= 0 ? m : width - 1 - m;
+
+      const CostType* costs  = &data.Costs[(static_cast<unsigned long>(j) * width + i) * nbDisparities];
+      CostType*       sums   = &data.Sums[(static_cast<unsigned long>(j) * width + i) * nbDisparities];
+      CostType*       values = &data.CurrentLine[static_cast<unsigned long>(i) * nbDisparities];
+
+      // Previous pixel on the path
+      const long      pi       = static_cast<long>(i) - dx;
+      const CostType* previous = nullptr;
+      unsigned int    minPrevious = 0;
+      if (pi >= 0 && pi < static_cast<long>(width))
+      {
+        if (dy == 0)
+        {
+          previous    = &data.CurrentLine[pi * nbDisparities];
+          minPrevious = data.CurrentMin[pi];
+        }
+        else if (l > 0)
+        {
+          previous    = &data.PreviousLine[pi * nbDisparities];
+          minPrevious = data.PreviousMin[pi];
+        }
+      }
+
+      unsigned int minValue = std::numeric_limits<unsigned int>::max();
+      if (!previous)
+      {
+        // Start of the path
+        for (unsigned int k = 0; k < nbDisparities; ++k)
+        {
+          values[k] = costs[k];
+          sums[k] += costs[k];
+          minValue = std::min<unsigned int>(minValue, costs[k]);
+        }
+      }
+      else
+      {
+        const unsigned int jump = minPrevious + p2;
+        for (unsigned int k = 0; k < nbDisparities; ++k)
+        {
+          unsigned int best = std::min<unsigned int>(previous[k], jump);
+          if (k > 0)
+          {
+            best = std::min<unsigned int>(best, previous[k - 1] + p1);
+          }
+          if (k + 1 < nbDisparities)
+          {
+            best = std::min<unsigned int>(best, previous[k + 1] + p1);
+          }
+          const unsigned int value = costs[k] + best - minPrevious;
+          values[k]                = static_cast<CostType>(value);
+          sums[k] += static_cast<CostType>(value);
+          minValue = std::min(minValue, value);
+        }
+      }
+      data.CurrentMin[i] = static_cast<CostType>(minValue);
+    }
+
+    data.PreviousLine.swap(data.CurrentLine);
+    data.PreviousMin.swap(data.CurrentMin);
+  }
+}
+
+} // end namespace otb
+
+#endif
@@ -33,4 +33,6 @@ void RegisterTests()
   REGISTER_TEST(otbNCCRegistrationFilter);
   REGISTER_TEST(otbPixelWiseBlockMatchingImageFilter);
   REGISTER_TEST(otbPixelWiseBlockMatchingImageFilterNCC);
+  REGISTER_TEST(otbPixelWiseBlockMatchingImageFilterCostVolume);
+  REGISTER_TEST(otbSemiGlobalMatchingImageFilter);
 }
@@ -23,6 +23,7 @@
 #include "otbImageFileReader.h"
 #include "otbImageFileWriter.h"
 #include "otbStandardWriterWatcher.h"
+#include "itkImageRegionConstIterator.h"
 
 typedef otb::Image<unsigned short>           ImageType;
 typedef otb::Image<float>                    FloatImageType;
@@ -120,3 +121,82 @@ int otbPixelWiseBlockMatchingImageFilterNCC(int argc, char* argv[])
 
   return EXIT_SUCCESS;
 }
+
+template <class TFilter>
+bool CompareCostVolumeWithBlocks(TFilter* costVolumeFilter, TFilter* blockFilter, double metricTolerance)
+{
+  typedef itk::ImageRegionConstIterator<FloatImageType> IteratorType;
+
+  costVolumeFilter->UseCostVolumeOn();
+  costVolumeFilter->Update();
+  blockFilter->UseCostVolumeOff();
+  blockFilter->Update();
+
+  const FloatImageType::RegionType region = costVolumeFilter->GetMetricOutput()->GetLargestPossibleRegion();
+  IteratorType cvMetricIt(costVolumeFilter->GetMetricOutput(), region);
+  IteratorType cvDispIt(costVolumeFilter->GetHorizontalDisparityOutput(), region);
+  IteratorType metricIt(blockFilter->GetMetricOutput(), region);
+  IteratorType dispIt(blockFilter->GetHorizontalDisparityOutput(), region);
+
+  unsigned int nbDifferences = 0;
+  cvMetricIt.GoToBegin();
+  cvDispIt.GoToBegin();
+  metricIt.GoToBegin();
+  dispIt.GoToBegin();
+  for (; !cvMetricIt.IsAtEnd(); ++cvMetricIt, ++cvDispIt, ++metricIt, ++dispIt)
+  {
+    if (cvDispIt.Get() != dispIt.Get() || std::abs(cvMetricIt.Get() - metricIt.Get()) > metricTolerance)
+    {
+      if (nbDifferences < 10)
+      {
+        std::cerr << "At " << cvMetricIt.GetIndex() << ": cost volume gives " << cvDispIt.Get() << " (" << cvMetricIt.Get() << "), blocks give " << dispIt.Get()
+                  << " (" << metricIt.Get() << ")" << std::endl;
+      }
+      ++nbDifferences;
+    }
+  }
+  std::cout << nbDifferences << " differences over " << region.GetNumberOfPixels() << " pixels" << std::endl;
+  return nbDifferences == 0;
+}
+
+int otbPixelWiseBlockMatchingImageFilterCostVolume(int itkNotUsed(argc), char* argv[])
+{
+  ReaderType::Pointer leftReader = ReaderType::New();
+  leftReader->SetFileName(argv[1]);
+
+  ReaderType::Pointer rightReader = ReaderType::New();
+  rightReader->SetFileName(argv[2]);
+
+  const unsigned int radius   = atoi(argv[3]);
+  const int          minHDisp = atoi(argv[4]);
+  const int          maxHDisp = atoi(argv[5]);
+  const unsigned int step     = atoi(argv[6]);
+
+  PixelWiseBlockMatchingImageFilterType::Pointer ssdFilters[2];
+  PixelWiseNCCBlockMatchingImageFilterType::Pointer nccFilters[2];
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    ssdFilters[i] = PixelWiseBlockMatchingImageFilterType::New();
+    ssdFilters[i]->SetLeftInput(leftReader->GetOutput());
+    ssdFilters[i]->SetRightInput(rightReader->GetOutput());
+    ssdFilters[i]->SetRadius(radius);
+    ssdFilters[i]->SetMinimumHorizontalDisparity(minHDisp);
+    ssdFilters[i]->SetMaximumHorizontalDisparity(maxHDisp);
+    ssdFilters[i]->SetStep(step);
+
+    nccFilters[i] = PixelWiseNCCBlockMatchingImageFilterType::New();
+    nccFilters[i]->SetLeftInput(leftReader->GetOutput());
+    nccFilters[i]->SetRightInput(rightReader->GetOutput());
+    nccFilters[i]->SetRadius(radius);
+    nccFilters[i]->SetMinimumHorizontalDisparity(minHDisp);
+    nccFilters[i]->SetMaximumHorizontalDisparity(maxHDisp);
+    nccFilters[i]->SetStep(step);
+    nccFilters[i]->MinimizeOff();
+  }
+
+  // Sums of integer costs are exact, the NCC is computed differently
+  bool ok = CompareCostVolumeWithBlocks(ssdFilters[0].GetPointer(), ssdFilters[1].GetPointer(), 0.);
+  ok      = CompareCostVolumeWithBlocks(nccFilters[0].GetPointer(), nccFilters[1].GetPointer(), 1e-6) && ok;
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
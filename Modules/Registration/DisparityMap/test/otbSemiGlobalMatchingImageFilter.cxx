@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbSemiGlobalMatchingImageFilter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include <random>
+
+int otbSemiGlobalMatchingImageFilter(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  typedef otb::Image<float> FloatImageType;
+  typedef otb::SemiGlobalMatchingImageFilter<FloatImageType, FloatImageType> SGMFilterType;
+  typedef itk::StreamingImageFilter<FloatImageType, FloatImageType> StreamingFilterType;
+
+  // Random texture, the right image is shifted by a constant disparity
+  const int  disparity = 3;
+  const long margin    = 12;
+
+  FloatImageType::SizeType size;
+  size[0] = 200;
+  size[1] = 150;
+  FloatImageType::RegionType region;
+  region.SetSize(size);
+
+  FloatImageType::Pointer left  = FloatImageType::New();
+  FloatImageType::Pointer right = FloatImageType::New();
+  left->SetRegions(region);
+  left->Allocate();
+  right->SetRegions(region);
+  right->Allocate();
+
+  std::mt19937                       generator(42);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<float>                 texture((size[0] + 2 * margin) * size[1]);
+  for (auto& value : texture)
+  {
+    value = distribution(generator);
+  }
+
+  itk::ImageRegionIterator<FloatImageType> leftIt(left, region);
+  itk::ImageRegionIterator<FloatImageType> rightIt(right, region);
+  for (leftIt.GoToBegin(), rightIt.GoToBegin(); !leftIt.IsAtEnd(); ++leftIt, ++rightIt)
+  {
+    const FloatImageType::IndexType index = leftIt.GetIndex();
+    const long                      row   = index[1] * (size[0] + 2 * margin) + margin;
+    leftIt.Set(texture[row + index[0]]);
+    rightIt.Set(texture[row + index[0] - disparity]);
+  }
+
+  // Small blocks, so that each stream is processed by several blocks
+  SGMFilterType::Pointer sgmFilter = SGMFilterType::New();
+  sgmFilter->SetLeftInput(left);
+  sgmFilter->SetRightInput(right);
+  sgmFilter->SetRadius(2);
+  sgmFilter->SetMinimumHorizontalDisparity(-8);
+  sgmFilter->SetMaximumHorizontalDisparity(8);
+  sgmFilter->SetBlockSize(32);
+  sgmFilter->SetOverlap(16);
+
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput(sgmFilter->GetHorizontalDisparityOutput());
+  streamer->SetNumberOfStreamDivisions(4);
+  streamer->Update();
+
+  // Right pixels of the border may be outside the right image
+  unsigned int nbErrors = 0;
+  itk::ImageRegionConstIteratorWithIndex<FloatImageType> dispIt(streamer->GetOutput(), region);
+  for (dispIt.GoToBegin(); !dispIt.IsAtEnd(); ++dispIt)
+  {
+    const FloatImageType::IndexType index = dispIt.GetIndex();
+    if (index[0] >= margin && index[0] < static_cast<long>(size[0]) - margin && std::abs(dispIt.Get() - disparity) > 0.5)
+    {
+      if (nbErrors < 10)
+      {
+        std::cerr << "Wrong disparity at " << index << ": " << dispIt.Get() << std::endl;
+      }
+      ++nbErrors;
+    }
+  }
+
+  std::cout << nbErrors << " wrong disparities" << std::endl;
+  return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
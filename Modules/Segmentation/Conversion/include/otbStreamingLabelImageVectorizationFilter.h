@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingLabelImageVectorizationFilter_h
+#define otbStreamingLabelImageVectorizationFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "otbPerThreadAccumulator.h"
+#include "otbOGRLayerWrapper.h"
+#include "otbOGRFeatureWrapper.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace otb
+{
+
+/** \class PersistentLabelImageVectorizationFilter
+ *  \brief Vectorize a label image in a persistent way, one polygon per label.
+ *
+ *  Each thread traces the boundaries of the regions of its part of the
+ *  streamed region directly on the pixel grid: boundary edges are followed
+ *  with the regions on their right, taking the rightmost turn at vertices
+ *  where two pixels of the same label only touch by a corner, so that regions
+ *  are 4-connected as with \c GDALPolygonize(). Boundaries crossing the border
+ *  of the thread region are kept as open chains.
+ *
+ *  In Synthetize(), open chains of all the streamed regions are joined at the
+ *  region borders into rings, holes are attached to the outer ring enclosing
+ *  them, and one feature is written per label in the \c ogr::Layer set with
+ *  SetOGRLayer(). Geometries are polygons, or multipolygons for labels with
+ *  several parts or when the layer type is \c wkbMultiPolygon. They have no
+ *  collinear vertices. The label is written in an integer field (FieldName,
+ *  "DN" by default), created if needed. Other fields can be filled by the
+ *  function set with SetFeatureFieldsFunction(). Features are written in
+ *  transactions of TransactionSize features.
+ *
+ *  Contrary to the stream stitching of \c OGRLayerStreamStitchingFilter,
+ *  labels are global: the same label in two streamed regions is the same
+ *  region, and the result does not depend on the streaming.
+ *
+ *  \warning Nothing is written before Synthetize(): the chains and rings of
+ *  all the streamed regions stay in memory until then, even the closed ones.
+ *  Memory use thus grows with the number of boundary vertices of the whole
+ *  image (about two coordinates per turn of a boundary), not with the size
+ *  of the streamed regions. Streaming bounds the memory used to read the
+ *  image, not the memory used by the polygons.
+ *
+ *  An optional mask excludes the pixels where it is 0, as in
+ *  \c LabelImageToOGRDataSourceFilter.
+ *
+ * \sa LabelImageToOGRDataSourceFilter
+ * \sa StreamingLabelImageVectorizationFilter
+ *
+ * \ingroup OTBConversion
+ */
+template <class TInputImage>
+class ITK_EXPORT PersistentLabelImageVectorizationFilter : public PersistentImageFilter<TInputImage, TInputImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentLabelImageVectorizationFilter Self;
+  typedef PersistentImageFilter<TInputImage, TInputImage> Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentLabelImageVectorizationFilter, PersistentImageFilter);
+
+  /** Image related typedefs. */
+  typedef TInputImage                                          InputImageType;
+  typedef typename InputImageType::Pointer                     InputImagePointer;
+  typedef typename InputImageType::RegionType                  RegionType;
+  typedef typename InputImageType::SizeType                    SizeType;
+  typedef typename InputImageType::IndexType                   IndexType;
+  typedef typename InputImageType::PixelType                   InputPixelType;
+  typedef typename IndexType::IndexValueType                   IndexValueType;
+  typedef ogr::Layer                                           OGRLayerType;
+  typedef ogr::Feature                                         OGRFeatureType;
+  typedef std::function<void(OGRFeatureType&, InputPixelType)> FeatureFieldsFunctionType;
+
+  /** Set the input mask image. Pixels where the mask is 0 are not vectorized. */
+  void SetInputMask(const InputImageType* mask);
+  const InputImageType* GetInputMask();
+
+  /** Set the \c ogr::Layer in which the features will be written */
+  void SetOGRLayer(const OGRLayerType& ogrLayer);
+  /** Get the \c ogr::Layer in which the features are written */
+  const OGRLayerType& GetOGRLayer(void) const;
+
+  /** Name of the integer field holding the label (default is "DN") */
+  itkSetMacro(FieldName, std::string);
+  itkGetMacro(FieldName, std::string);
+
+  /** Number of features written in each transaction */
+  itkSetMacro(TransactionSize, unsigned long);
+  itkGetMacro(TransactionSize, unsigned long);
+
+  /** Set a function called with each feature and its label before the
+   *  feature is written, to fill additional fields */
+  void SetFeatureFieldsFunction(const FeatureFieldsFunctionType& function);
+
+  /** Number of features written by the last Synthetize() */
+  itkGetMacro(NumberOfFeatures, unsigned long);
+
+  void Reset(void) override;
+  void Synthetize(void) override;
+
+protected:
+  PersistentLabelImageVectorizationFilter();
+  ~PersistentLabelImageVectorizationFilter() override
+  {
+  }
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  void GenerateOutputInformation() override;
+
+  /** Pixels above and on the left of the requested region are needed to
+   *  find the boundaries on its top and left borders */
+  void GenerateInputRequestedRegion() override;
+
+  /** The output is not used: nothing to allocate */
+  void AllocateOutputs() override;
+
+  void ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
+
+  /** Vertex of the pixel grid: the top left corner of pixel (x, y) is the vertex (x, y) */
+  struct VertexType
+  {
+    IndexValueType x;
+    IndexValueType y;
+  };
+
+  /** Part of the boundary of a label, from its start vertex to its end
+   *  vertex, with the label region on its right. Directions are 0 (+x),
+   *  1 (+y), 2 (-x) and 3 (-y). Only corner vertices are stored, except the
+   *  ends of open chains. Closed chains are complete rings. */
+  struct ChainType
+  {
+    InputPixelType          Label;
+    bool                    Closed;
+    unsigned char           StartDirection;
+    unsigned char           EndDirection;
+    std::vector<VertexType> Vertices;
+  };
+
+  typedef std::vector<ChainType>  ChainListType;
+  typedef std::vector<VertexType> RingType;
+
+  /** Assemble the chains into rings */
+  void AssembleRings(ChainListType& chains, std::vector<RingType>& rings, std::vector<InputPixelType>& ringLabels) const;
+
+  /** Remove the collinear vertices of a ring */
+  static void RemoveCollinearVertices(RingType& ring);
+
+  /** Twice the signed area of a ring, positive for outer rings */
+  static double SignedArea(const RingType& ring);
+
+  /** Even-odd test of a point against a ring */
+  static bool IsInside(double x, double y, const RingType& ring);
+
+  /** Build the geometry of a label from its outer rings and holes */
+  OGRGeometry* CreateGeometry(const std::vector<const RingType*>& outers, const std::vector<const RingType*>& holes, bool forceMultiPolygon) const;
+
+private:
+  PersistentLabelImageVectorizationFilter(const Self&) = delete;
+  void operator=(const Self&) = delete;
+
+  std::string               m_FieldName;
+  unsigned long             m_TransactionSize;
+  unsigned long             m_NumberOfFeatures;
+  FeatureFieldsFunctionType m_FeatureFieldsFunction;
+
+  // The layer where features are written
+  OGRLayerType m_OGRLayer;
+
+  // Chains traced by each thread, kept until Synthetize()
+  PerThreadAccumulator<ChainListType> m_ThreadChains;
+};
+
+/** \class StreamingLabelImageVectorizationFilter
+ *  \brief Vectorize a label image by streaming, one polygon per label.
+ *
+ *  This class streams the input image through the
+ *  PersistentLabelImageVectorizationFilter, and writes the features in the
+ *  layer once the whole image has been processed.
+ *
+ *  \code
+ *  typedef otb::StreamingLabelImageVectorizationFilter<LabelImageType> VectorizationFilterType;
+ *  VectorizationFilterType::Pointer vectorization = VectorizationFilterType::New();
+ *  vectorization->SetInput(labelImage);
+ *  vectorization->SetInputMask(labelImage);
+ *  vectorization->SetOGRLayer(layer);
+ *  vectorization->SetFieldName("label");
+ *  vectorization->Update();
+ *  \endcode
+ *
+ * \sa PersistentLabelImageVectorizationFilter
+ * \sa PersistentFilterStreamingDecorator
+ *
+ * \ingroup OTBConversion
+ */
+template <class TInputImage>
+class ITK_EXPORT StreamingLabelImageVectorizationFilter : public PersistentFilterStreamingDecorator<PersistentLabelImageVectorizationFilter<TInputImage>>
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingLabelImageVectorizationFilter                                                   Self;
+  typedef PersistentFilterStreamingDecorator<PersistentLabelImageVectorizationFilter<TInputImage>> Superclass;
+  typedef itk::SmartPointer<Self>                                                                  Pointer;
+  typedef itk::SmartPointer<const Self>                                                            ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(StreamingLabelImageVectorizationFilter, PersistentFilterStreamingDecorator);
+
+  typedef TInputImage                                                 InputImageType;
+  typedef typename Superclass::FilterType                             VectorizationFilterType;
+  typedef typename VectorizationFilterType::OGRLayerType              OGRLayerType;
+  typedef typename VectorizationFilterType::FeatureFieldsFunctionType FeatureFieldsFunctionType;
+
+  using Superclass::SetInput;
+  void SetInput(const InputImageType* input)
+  {
+    this->GetFilter()->SetInput(input);
+  }
+  const InputImageType* GetInput()
+  {
+    return this->GetFilter()->GetInput();
+  }
+
+  void SetInputMask(const InputImageType* mask)
+  {
+    this->GetFilter()->SetInputMask(mask);
+  }
+  const InputImageType* GetInputMask()
+  {
+    return this->GetFilter()->GetInputMask();
+  }
+
+  void SetOGRLayer(const OGRLayerType& ogrLayer)
+  {
+    this->GetFilter()->SetOGRLayer(ogrLayer);
+  }
+
+  void SetFieldName(const std::string& fieldName)
+  {
+    this->GetFilter()->SetFieldName(fieldName);
+  }
+
+  void SetTransactionSize(unsigned long transactionSize)
+  {
+    this->GetFilter()->SetTransactionSize(transactionSize);
+  }
+
+  void SetFeatureFieldsFunction(const FeatureFieldsFunctionType& function)
+  {
+    this->GetFilter()->SetFeatureFieldsFunction(function);
+  }
+
+  unsigned long GetNumberOfFeatures() const
+  {
+    return this->GetFilter()->GetNumberOfFeatures();
+  }
+
+protected:
+  /** Constructor */
+  StreamingLabelImageVectorizationFilter()
+  {
+  }
+  /** Destructor */
+  ~StreamingLabelImageVectorizationFilter() override
+  {
+  }
+
+private:
+  StreamingLabelImageVectorizationFilter(const Self&) = delete;
+  void operator=(const Self&) = delete;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingLabelImageVectorizationFilter.hxx"
+#endif
+
+#endif
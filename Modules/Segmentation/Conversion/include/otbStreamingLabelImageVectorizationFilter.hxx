@@ -0,0 +1,712 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingLabelImageVectorizationFilter_hxx
+#define otbStreamingLabelImageVectorizationFilter_hxx
+
+#include "otbStreamingLabelImageVectorizationFilter.h"
+#include "otbMacro.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkProgressReporter.h"
+#include "ogr_geometry.h"
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
+namespace otb
+{
+
+namespace LabelImageVectorization
+{
+// Moves along the directions 0 (+x), 1 (+y), 2 (-x) and 3 (-y)
+const int DirectionX[4] = {1, 0, -1, 0};
+const int DirectionY[4] = {0, 1, 0, -1};
+
+// Offsets from the start vertex of an edge to the pixel on its right (the
+// pixel whose boundary it is) and to the pixel on its left
+const int RightPixelX[4] = {0, -1, -1, 0};
+const int RightPixelY[4] = {0, 0, -1, -1};
+const int LeftPixelX[4]  = {0, 0, -1, -1};
+const int LeftPixelY[4]  = {-1, 0, 0, -1};
+
+/** Labels of a thread region, with one more row above and one more column
+ *  on the left, and edges ownership. A vertical edge belongs to the thread
+ *  region containing the pixel on its right side (or on its left side on the
+ *  right border of the image), and a horizontal edge to the one containing
+ *  the pixel below it (or above it on the bottom border). */
+template <class TLabel, class TIndexValue>
+struct TileBuffer
+{
+  // Thread region
+  TIndexValue x0, y0, x1, y1;
+  // Largest possible region
+  TIndexValue X0, Y0, X1, Y1;
+
+  std::vector<TLabel>        Labels;
+  std::vector<unsigned char> Valid;
+  // One bit per direction for each vertex of the tile
+  std::vector<unsigned char> Visited;
+
+  unsigned int BufferWidth() const
+  {
+    return x1 - x0 + 2;
+  }
+
+  unsigned int PixelOffset(TIndexValue x, TIndexValue y) const
+  {
+    return (y - y0 + 1) * BufferWidth() + (x - x0 + 1);
+  }
+
+  unsigned int VertexOffset(TIndexValue x, TIndexValue y) const
+  {
+    return (y - y0) * (x1 - x0 + 1) + (x - x0);
+  }
+
+  bool IsOwnedEdge(TIndexValue x, TIndexValue y, unsigned int direction) const
+  {
+    if (direction % 2 == 0)
+    {
+      const TIndexValue sx = direction == 0 ? x : x - 1;
+      return sx >= x0 && sx < x1 && ((y >= y0 && y < y1) || (y == Y1 && y1 == Y1));
+    }
+    const TIndexValue sy = direction == 1 ? y : y - 1;
+    return sy >= y0 && sy < y1 && ((x >= x0 && x < x1) || (x == X1 && x1 == X1));
+  }
+
+  /** A vertex is internal if all its edges belong to the tile */
+  bool IsInternalVertex(TIndexValue x, TIndexValue y) const
+  {
+    return (x == X0 || IsOwnedEdge(x, y, 2)) && (x == X1 || IsOwnedEdge(x, y, 0)) && (y == Y0 || IsOwnedEdge(x, y, 3)) && (y == Y1 || IsOwnedEdge(x, y, 1));
+  }
+
+  /** Check if there is a boundary edge from a vertex in a direction, and
+   *  return its label */
+  bool GetEdge(TIndexValue x, TIndexValue y, unsigned int direction, TLabel& label) const
+  {
+    const unsigned int right = PixelOffset(x + RightPixelX[direction], y + RightPixelY[direction]);
+    if (!Valid[right])
+    {
+      return false;
+    }
+    const unsigned int left = PixelOffset(x + LeftPixelX[direction], y + LeftPixelY[direction]);
+    if (Valid[left] && Labels[left] == Labels[right])
+    {
+      return false;
+    }
+    label = Labels[right];
+    return true;
+  }
+
+  bool IsVisited(TIndexValue x, TIndexValue y, unsigned int direction) const
+  {
+    return (Visited[VertexOffset(x, y)] >> direction) & 1;
+  }
+
+  void SetVisited(TIndexValue x, TIndexValue y, unsigned int direction)
+  {
+    Visited[VertexOffset(x, y)] |= (1 << direction);
+  }
+};
+} // end namespace LabelImageVectorization
+
+template <class TInputImage>
+PersistentLabelImageVectorizationFilter<TInputImage>::PersistentLabelImageVectorizationFilter()
+  : m_FieldName("DN"), m_TransactionSize(100000), m_NumberOfFeatures(0), m_OGRLayer(nullptr, false)
+{
+  this->SetNumberOfRequiredInputs(1);
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::SetInputMask(const InputImageType* mask)
+{
+  this->itk::ProcessObject::SetNthInput(1, const_cast<InputImageType*>(mask));
+}
+
+template <class TInputImage>
+const typename PersistentLabelImageVectorizationFilter<TInputImage>::InputImageType* PersistentLabelImageVectorizationFilter<TInputImage>::GetInputMask()
+{
+  if (this->GetNumberOfInputs() < 2)
+  {
+    return nullptr;
+  }
+  return static_cast<const InputImageType*>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::SetOGRLayer(const OGRLayerType& ogrLayer)
+{
+  m_OGRLayer = ogrLayer;
+  this->Modified();
+}
+
+template <class TInputImage>
+const typename PersistentLabelImageVectorizationFilter<TInputImage>::OGRLayerType& PersistentLabelImageVectorizationFilter<TInputImage>::GetOGRLayer(void) const
+{
+  return m_OGRLayer;
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::SetFeatureFieldsFunction(const FeatureFieldsFunctionType& function)
+{
+  m_FeatureFieldsFunction = function;
+  this->Modified();
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+  if (this->GetInput())
+  {
+    this->GetOutput()->CopyInformation(this->GetInput());
+    this->GetOutput()->SetLargestPossibleRegion(this->GetInput()->GetLargestPossibleRegion());
+
+    if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+    {
+      this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+    }
+  }
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  RegionType requestedRegion = this->GetOutput()->GetRequestedRegion();
+  IndexType  index           = requestedRegion.GetIndex();
+  SizeType   size            = requestedRegion.GetSize();
+  index[0] -= 1;
+  index[1] -= 1;
+  size[0] += 1;
+  size[1] += 1;
+  requestedRegion.SetIndex(index);
+  requestedRegion.SetSize(size);
+
+  for (unsigned int i = 0; i < this->GetNumberOfInputs(); ++i)
+  {
+    InputImageType* input = const_cast<InputImageType*>(static_cast<const InputImageType*>(this->itk::ProcessObject::GetInput(i)));
+    if (input)
+    {
+      RegionType inputRequestedRegion = requestedRegion;
+      inputRequestedRegion.Crop(input->GetLargestPossibleRegion());
+      input->SetRequestedRegion(inputRequestedRegion);
+    }
+  }
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::AllocateOutputs()
+{
+  // The output image of this filter is not intended to be used
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::Reset()
+{
+  m_ThreadChains.Reset(this->GetNumberOfThreads(), ChainListType());
+  m_NumberOfFeatures = 0;
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  typedef LabelImageVectorization::TileBuffer<InputPixelType, IndexValueType> TileType;
+  using LabelImageVectorization::DirectionX;
+  using LabelImageVectorization::DirectionY;
+
+  const InputImageType* input = this->GetInput();
+  const InputImageType* mask  = this->GetInputMask();
+
+  if (outputRegionForThread.GetNumberOfPixels() == 0)
+  {
+    return;
+  }
+
+  itk::ProgressReporter progress(this, threadId, 2 * outputRegionForThread.GetSize(1));
+
+  const RegionType largestRegion = input->GetLargestPossibleRegion();
+
+  TileType tile;
+  tile.x0 = outputRegionForThread.GetIndex(0);
+  tile.y0 = outputRegionForThread.GetIndex(1);
+  tile.x1 = tile.x0 + static_cast<IndexValueType>(outputRegionForThread.GetSize(0));
+  tile.y1 = tile.y0 + static_cast<IndexValueType>(outputRegionForThread.GetSize(1));
+  tile.X0 = largestRegion.GetIndex(0);
+  tile.Y0 = largestRegion.GetIndex(1);
+  tile.X1 = tile.X0 + static_cast<IndexValueType>(largestRegion.GetSize(0));
+  tile.Y1 = tile.Y0 + static_cast<IndexValueType>(largestRegion.GetSize(1));
+
+  // Copy the labels, pixels outside of the image or masked being invalid.
+  // The last row and column of the buffer (below and on the right of the
+  // thread region) are never read, except on the image borders.
+  const unsigned int bufferWidth = tile.BufferWidth();
+  tile.Labels.assign(bufferWidth * (tile.y1 - tile.y0 + 2), InputPixelType());
+  tile.Valid.assign(tile.Labels.size(), 0);
+  tile.Visited.assign((tile.x1 - tile.x0 + 1) * (tile.y1 - tile.y0 + 1), 0);
+
+  RegionType bufferRegion = outputRegionForThread;
+  IndexType  bufferIndex  = bufferRegion.GetIndex();
+  SizeType   bufferSize   = bufferRegion.GetSize();
+  bufferIndex[0] -= 1;
+  bufferIndex[1] -= 1;
+  bufferSize[0] += 1;
+  bufferSize[1] += 1;
+  bufferRegion.SetIndex(bufferIndex);
+  bufferRegion.SetSize(bufferSize);
+  bufferRegion.Crop(largestRegion);
+
+  itk::ImageRegionConstIterator<InputImageType> it(input, bufferRegion);
+  itk::ImageRegionConstIterator<InputImageType> maskIt;
+  if (mask)
+  {
+    maskIt = itk::ImageRegionConstIterator<InputImageType>(mask, bufferRegion);
+    maskIt.GoToBegin();
+  }
+  it.GoToBegin();
+  for (IndexValueType y = bufferRegion.GetIndex(1); y < bufferRegion.GetIndex(1) + static_cast<IndexValueType>(bufferRegion.GetSize(1)); ++y)
+  {
+    unsigned int offset = tile.PixelOffset(bufferRegion.GetIndex(0), y);
+    for (unsigned long i = 0; i < bufferRegion.GetSize(0); ++i, ++offset)
+    {
+      tile.Labels[offset] = it.Get();
+      tile.Valid[offset]  = !mask || maskIt.Get() != 0;
+      ++it;
+      if (mask)
+      {
+        ++maskIt;
+      }
+    }
+    progress.CompletedPixel();
+  }
+
+  ChainListType& chains = m_ThreadChains[threadId];
+
+  // Follow the boundary from an edge, until a vertex which is not internal
+  // to the tile (open chain) or back to the first edge (closed chain)
+  auto trace = [&tile, &chains](IndexValueType x, IndexValueType y, unsigned int direction, InputPixelType label) {
+    ChainType chain;
+    chain.Label          = label;
+    chain.Closed         = false;
+    chain.StartDirection = direction;
+    chain.Vertices.push_back(VertexType{x, y});
+
+    const IndexValueType startX = x, startY = y;
+    while (true)
+    {
+      tile.SetVisited(x, y, direction);
+      x += DirectionX[direction];
+      y += DirectionY[direction];
+
+      if (!tile.IsInternalVertex(x, y))
+      {
+        chain.Vertices.push_back(VertexType{x, y});
+        chain.EndDirection = direction;
+        break;
+      }
+
+      // Take the rightmost turn with the same label: two pixels of the
+      // same label touching by a corner are not connected
+      unsigned int   nextDirection = 4;
+      InputPixelType edgeLabel;
+      for (unsigned int turn : {1u, 0u, 3u})
+      {
+        const unsigned int candidate = (direction + turn) % 4;
+        if (tile.GetEdge(x, y, candidate, edgeLabel) && edgeLabel == label)
+        {
+          nextDirection = candidate;
+          break;
+        }
+      }
+      if (nextDirection == 4)
+      {
+        itkGenericExceptionMacro(<< "Broken boundary at vertex (" << x << ", " << y << ")");
+      }
+
+      if (x == startX && y == startY && nextDirection == chain.StartDirection)
+      {
+        chain.Closed       = true;
+        chain.EndDirection = direction;
+        break;
+      }
+      if (nextDirection != direction)
+      {
+        chain.Vertices.push_back(VertexType{x, y});
+      }
+      direction = nextDirection;
+    }
+    chains.push_back(std::move(chain));
+  };
+
+  InputPixelType label;
+
+  // Open chains start from a vertex on the tile border
+  for (IndexValueType y = tile.y0; y <= tile.y1; ++y)
+  {
+    for (IndexValueType x = tile.x0; x <= tile.x1; ++x)
+    {
+      if (tile.IsInternalVertex(x, y))
+      {
+        continue;
+      }
+      for (unsigned int direction = 0; direction < 4; ++direction)
+      {
+        if (tile.IsOwnedEdge(x, y, direction) && !tile.IsVisited(x, y, direction) && tile.GetEdge(x, y, direction, label))
+        {
+          trace(x, y, direction, label);
+        }
+      }
+    }
+  }
+
+  // Remaining edges form closed rings inside the tile
+  for (IndexValueType y = tile.y0; y <= tile.y1; ++y)
+  {
+    for (IndexValueType x = tile.x0; x <= tile.x1; ++x)
+    {
+      for (unsigned int direction = 0; direction < 4; ++direction)
+      {
+        if (tile.IsOwnedEdge(x, y, direction) && !tile.IsVisited(x, y, direction) && tile.GetEdge(x, y, direction, label))
+        {
+          trace(x, y, direction, label);
+        }
+      }
+    }
+    progress.CompletedPixel();
+  }
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::AssembleRings(ChainListType& chains, std::vector<RingType>& rings,
+                                                                        std::vector<InputPixelType>& ringLabels) const
+{
+  const RegionType     largestRegion = this->GetInput()->GetLargestPossibleRegion();
+  const IndexValueType X0            = largestRegion.GetIndex(0);
+  const IndexValueType Y0            = largestRegion.GetIndex(1);
+
+  // There is at most one edge from a vertex in a given direction: index
+  // the open chains by their start vertex and direction
+  auto key = [X0, Y0](const VertexType& v, unsigned int direction) {
+    return (static_cast<unsigned long long>(v.x - X0) << 34) | (static_cast<unsigned long long>(v.y - Y0) << 2) | direction;
+  };
+  std::unordered_map<unsigned long long, unsigned int> chainStarts;
+  for (unsigned int i = 0; i < chains.size(); ++i)
+  {
+    if (!chains[i].Closed)
+    {
+      chainStarts[key(chains[i].Vertices.front(), chains[i].StartDirection)] = i;
+    }
+  }
+
+  // Link each open chain to the next one, with the same turn rule as
+  // inside the tiles
+  const unsigned int        noChain = static_cast<unsigned int>(-1);
+  std::vector<unsigned int> next(chains.size(), noChain);
+  for (unsigned int i = 0; i < chains.size(); ++i)
+  {
+    const ChainType& chain = chains[i];
+    if (chain.Closed)
+    {
+      continue;
+    }
+    for (unsigned int turn : {1u, 0u, 3u})
+    {
+      auto found = chainStarts.find(key(chain.Vertices.back(), (chain.EndDirection + turn) % 4));
+      if (found != chainStarts.end() && chains[found->second].Label == chain.Label)
+      {
+        next[i] = found->second;
+        chainStarts.erase(found);
+        break;
+      }
+    }
+    if (next[i] == noChain)
+    {
+      itkExceptionMacro(<< "Broken boundary at vertex (" << chain.Vertices.back().x << ", " << chain.Vertices.back().y << ")");
+    }
+  }
+
+  std::vector<bool> used(chains.size(), false);
+  for (unsigned int i = 0; i < chains.size(); ++i)
+  {
+    if (used[i])
+    {
+      continue;
+    }
+    RingType ring;
+    if (chains[i].Closed)
+    {
+      ring.swap(chains[i].Vertices);
+      used[i] = true;
+    }
+    else
+    {
+      for (unsigned int c = i; !used[c]; c = next[c])
+      {
+        used[c] = true;
+        // The first vertex of a chain is the last one of the previous chain
+        ring.insert(ring.end(), chains[c].Vertices.begin() + (ring.empty() ? 0 : 1), chains[c].Vertices.end());
+        std::vector<VertexType>().swap(chains[c].Vertices);
+      }
+      // The ring ends on its first vertex
+      ring.pop_back();
+    }
+    RemoveCollinearVertices(ring);
+    rings.push_back(std::move(ring));
+    ringLabels.push_back(chains[i].Label);
+  }
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::RemoveCollinearVertices(RingType& ring)
+{
+  if (ring.size() < 3)
+  {
+    return;
+  }
+  RingType           simplified;
+  const unsigned int n = ring.size();
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    const VertexType& previous = ring[(i + n - 1) % n];
+    const VertexType& current  = ring[i];
+    const VertexType& following = ring[(i + 1) % n];
+    // All edges are horizontal or vertical
+    if (!(previous.x == current.x && current.x == following.x) && !(previous.y == current.y && current.y == following.y))
+    {
+      simplified.push_back(current);
+    }
+  }
+  ring.swap(simplified);
+}
+
+template <class TInputImage>
+double PersistentLabelImageVectorizationFilter<TInputImage>::SignedArea(const RingType& ring)
+{
+  double             area = 0.;
+  const unsigned int n    = ring.size();
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    const VertexType& a = ring[i];
+    const VertexType& b = ring[(i + 1) % n];
+    area += static_cast<double>(a.x) * b.y - static_cast<double>(b.x) * a.y;
+  }
+  return area;
+}
+
+template <class TInputImage>
+bool PersistentLabelImageVectorizationFilter<TInputImage>::IsInside(double x, double y, const RingType& ring)
+{
+  bool               inside = false;
+  const unsigned int n      = ring.size();
+  for (unsigned int i = 0, j = n - 1; i < n; j = i++)
+  {
+    if ((ring[i].y > y) != (ring[j].y > y) && x < (ring[j].x - ring[i].x) * (y - ring[i].y) / static_cast<double>(ring[j].y - ring[i].y) + ring[i].x)
+    {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+template <class TInputImage>
+OGRGeometry* PersistentLabelImageVectorizationFilter<TInputImage>::CreateGeometry(const std::vector<const RingType*>& outers,
+                                                                                 const std::vector<const RingType*>& holes, bool forceMultiPolygon) const
+{
+  const InputImageType* input   = this->GetInput();
+  const auto            origin  = input->GetOrigin();
+  const auto            spacing = input->GetSignedSpacing();
+
+  // Vertex (x, y) is the top left corner of pixel (x, y)
+  auto createRing = [&origin, &spacing](const RingType& ring) {
+    OGRLinearRing* ogrRing = new OGRLinearRing;
+    ogrRing->setNumPoints(ring.size() + 1);
+    for (unsigned int i = 0; i <= ring.size(); ++i)
+    {
+      const VertexType& v = ring[i % ring.size()];
+      ogrRing->setPoint(i, origin[0] + (v.x - 0.5) * spacing[0], origin[1] + (v.y - 0.5) * spacing[1]);
+    }
+    return ogrRing;
+  };
+
+  // Find the outer ring of each hole: the innermost one containing the
+  // center of a pixel along the hole (on the right of its first edge)
+  std::vector<std::vector<const RingType*>> outerHoles(outers.size());
+  for (const RingType* hole : holes)
+  {
+    unsigned int outerIndex = 0;
+    if (outers.size() > 1)
+    {
+      const VertexType& a  = (*hole)[0];
+      const VertexType& b  = (*hole)[1];
+      const int         dx = (b.x > a.x) - (b.x < a.x);
+      const int         dy = (b.y > a.y) - (b.y < a.y);
+      const double      px = a.x + 0.5 * dx - 0.5 * dy;
+      const double      py = a.y + 0.5 * dy + 0.5 * dx;
+
+      double smallestArea = -1.;
+      for (unsigned int o = 0; o < outers.size(); ++o)
+      {
+        if (IsInside(px, py, *outers[o]))
+        {
+          const double area = SignedArea(*outers[o]);
+          if (smallestArea < 0 || area < smallestArea)
+          {
+            smallestArea = area;
+            outerIndex   = o;
+          }
+        }
+      }
+    }
+    outerHoles[outerIndex].push_back(hole);
+  }
+
+  std::vector<OGRPolygon*> polygons;
+  for (unsigned int o = 0; o < outers.size(); ++o)
+  {
+    OGRPolygon* polygon = new OGRPolygon;
+    polygon->addRingDirectly(createRing(*outers[o]));
+    for (const RingType* hole : outerHoles[o])
+    {
+      polygon->addRingDirectly(createRing(*hole));
+    }
+    polygons.push_back(polygon);
+  }
+
+  if (polygons.size() == 1 && !forceMultiPolygon)
+  {
+    return polygons.front();
+  }
+  OGRMultiPolygon* multiPolygon = new OGRMultiPolygon;
+  for (OGRPolygon* polygon : polygons)
+  {
+    multiPolygon->addGeometryDirectly(polygon);
+  }
+  return multiPolygon;
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::Synthetize()
+{
+  if (!m_OGRLayer)
+  {
+    itkExceptionMacro(<< "No OGR layer set to write the polygons.");
+  }
+
+  // Gather the chains of all the threads
+  ChainListType chains;
+  for (itk::ThreadIdType threadId = 0; threadId < m_ThreadChains.Size(); ++threadId)
+  {
+    ChainListType& threadChains = m_ThreadChains[threadId];
+    std::move(threadChains.begin(), threadChains.end(), std::back_inserter(chains));
+    ChainListType().swap(threadChains);
+  }
+
+  std::vector<RingType>       rings;
+  std::vector<InputPixelType> ringLabels;
+  AssembleRings(chains, rings, ringLabels);
+  ChainListType().swap(chains);
+
+  // Process the rings label by label
+  std::vector<unsigned int> order(rings.size());
+  for (unsigned int i = 0; i < order.size(); ++i)
+  {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&ringLabels](unsigned int a, unsigned int b) { return ringLabels[a] < ringLabels[b]; });
+
+  if (m_OGRLayer.GetLayerDefn().GetFieldIndex(m_FieldName.c_str()) < 0)
+  {
+    OGRFieldDefn field(m_FieldName.c_str(), sizeof(InputPixelType) > 4 ? OFTInteger64 : OFTInteger);
+    m_OGRLayer.CreateField(field, true);
+  }
+  const bool forceMultiPolygon = wkbFlatten(m_OGRLayer.GetGeomType()) == wkbMultiPolygon;
+
+  OGRErr err = m_OGRLayer.ogr().StartTransaction();
+  if (err != OGRERR_NONE)
+  {
+    itkExceptionMacro(<< "Unable to start transaction for OGR layer " << m_OGRLayer.ogr().GetName() << ".");
+  }
+
+  m_NumberOfFeatures = 0;
+  std::vector<const RingType*> outers, holes;
+  for (unsigned int begin = 0; begin < order.size();)
+  {
+    const InputPixelType label = ringLabels[order[begin]];
+    unsigned int         end   = begin;
+    outers.clear();
+    holes.clear();
+    for (; end < order.size() && ringLabels[order[end]] == label; ++end)
+    {
+      const RingType& ring = rings[order[end]];
+      if (SignedArea(ring) > 0)
+      {
+        outers.push_back(&ring);
+      }
+      else
+      {
+        holes.push_back(&ring);
+      }
+    }
+    begin = end;
+
+    OGRFeatureType feature(m_OGRLayer.GetLayerDefn());
+    feature.ogr().SetField(m_FieldName.c_str(), static_cast<GIntBig>(label));
+    feature.SetGeometryDirectly(ogr::UniqueGeometryPtr(CreateGeometry(outers, holes, forceMultiPolygon)));
+    if (m_FeatureFieldsFunction)
+    {
+      m_FeatureFieldsFunction(feature, label);
+    }
+    m_OGRLayer.CreateFeature(feature);
+
+    if (++m_NumberOfFeatures % m_TransactionSize == 0)
+    {
+      err = m_OGRLayer.ogr().CommitTransaction();
+      if (err == OGRERR_NONE)
+      {
+        err = m_OGRLayer.ogr().StartTransaction();
+      }
+      if (err != OGRERR_NONE)
+      {
+        itkExceptionMacro(<< "Unable to commit transaction for OGR layer " << m_OGRLayer.ogr().GetName() << ".");
+      }
+    }
+  }
+
+  err = m_OGRLayer.ogr().CommitTransaction();
+  if (err != OGRERR_NONE)
+  {
+    itkExceptionMacro(<< "Unable to commit transaction for OGR layer " << m_OGRLayer.ogr().GetName() << ".");
+  }
+
+  otbMsgDevMacro(<< "Vectorization: " << m_NumberOfFeatures << " features written");
+}
+
+template <class TInputImage>
+void PersistentLabelImageVectorizationFilter<TInputImage>::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "FieldName: " << m_FieldName << std::endl;
+  os << indent << "TransactionSize: " << m_TransactionSize << std::endl;
+  os << indent << "NumberOfFeatures: " << m_NumberOfFeatures << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -32,4 +32,5 @@ void RegisterTests()
   REGISTER_TEST(otbLabelImageRegionPruningFilter);
   REGISTER_TEST(otbLabelImageRegionMergingFilter);
   REGISTER_TEST(otbLabelMapToVectorDataFilter);
+  REGISTER_TEST(otbStreamingLabelImageVectorizationFilter);
 }
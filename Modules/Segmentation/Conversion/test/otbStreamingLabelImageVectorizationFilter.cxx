@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2005-2020 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbStreamingLabelImageVectorizationFilter.h"
+#include "otbOGRDataSourceToLabelImageFilter.h"
+#include "otbOGRDataSourceWrapper.h"
+#include "otbOGRGeometryWrapper.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include <map>
+#include <set>
+
+int otbStreamingLabelImageVectorizationFilter(int itkNotUsed(argc), char* argv[])
+{
+  typedef unsigned int PixelType;
+  typedef otb::Image<PixelType, 2> ImageType;
+  typedef otb::ImageFileReader<ImageType> ReaderType;
+
+  typedef otb::StreamingLabelImageVectorizationFilter<ImageType> VectorizationFilterType;
+  typedef otb::OGRDataSourceToLabelImageFilter<ImageType>        RasterizationFilterType;
+
+  const unsigned int nbDivisions = atoi(argv[2]);
+
+  // Read the label image
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  reader->UpdateOutputInformation();
+
+  // Vectorize it by streaming, in a memory layer: once with the requested
+  // number of divisions, and once in a single piece for reference
+  otb::ogr::DataSource::Pointer ogrDS = otb::ogr::DataSource::New();
+  otb::ogr::Layer               layer = ogrDS->CreateLayer("layer", nullptr, wkbPolygon);
+
+  VectorizationFilterType::Pointer vectorization = VectorizationFilterType::New();
+  vectorization->SetInput(reader->GetOutput());
+  vectorization->SetOGRLayer(layer);
+  vectorization->GetStreamer()->SetNumberOfDivisionsTiledStreaming(nbDivisions);
+  vectorization->Update();
+
+  otb::ogr::DataSource::Pointer refOGRDS = otb::ogr::DataSource::New();
+  otb::ogr::Layer               refLayer = refOGRDS->CreateLayer("reference", nullptr, wkbPolygon);
+
+  VectorizationFilterType::Pointer refVectorization = VectorizationFilterType::New();
+  refVectorization->SetInput(reader->GetOutput());
+  refVectorization->SetOGRLayer(refLayer);
+  refVectorization->GetStreamer()->SetNumberOfDivisionsTiledStreaming(1);
+  refVectorization->Update();
+
+  if (vectorization->GetNumberOfFeatures() != static_cast<unsigned long>(layer.GetFeatureCount(true)))
+  {
+    std::cerr << "Wrong number of features: " << layer.GetFeatureCount(true) << " in the layer, " << vectorization->GetNumberOfFeatures() << " written"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Rasterize the polygons
+  RasterizationFilterType::Pointer rasterization = RasterizationFilterType::New();
+  rasterization->AddOGRDataSource(ogrDS);
+  rasterization->SetOutputParametersFromImage(reader->GetOutput());
+  rasterization->SetBurnAttribute("DN");
+  rasterization->Update();
+
+  // Compare the input label image and the output of the rasterization
+  // filter, they must be exactly similar
+  reader->GetOutput()->SetRequestedRegionToLargestPossibleRegion();
+  reader->Update();
+
+  itk::ImageRegionConstIteratorWithIndex<ImageType> itRef(reader->GetOutput(), reader->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIteratorWithIndex<ImageType> itTest(rasterization->GetOutput(), rasterization->GetOutput()->GetLargestPossibleRegion());
+
+  std::set<PixelType> labels;
+  for (itRef.GoToBegin(), itTest.GoToBegin(); !itRef.IsAtEnd() && !itTest.IsAtEnd(); ++itRef, ++itTest)
+  {
+    if (itRef.Get() != itTest.Get())
+    {
+      std::cerr << "Pixel at position " << itRef.GetIndex() << " differs : in=" << itRef.Get() << " while out=" << itTest.Get() << std::endl;
+      return EXIT_FAILURE;
+    }
+    labels.insert(itRef.Get());
+  }
+
+  // There is one feature per label, whatever the streaming
+  std::map<PixelType, otb::ogr::Feature> refFeatures;
+  for (otb::ogr::Layer::const_iterator it = refLayer.cbegin(); it != refLayer.cend(); ++it)
+  {
+    refFeatures.insert(std::make_pair(static_cast<PixelType>(it->ogr().GetFieldAsInteger64("DN")), *it));
+  }
+  if (refFeatures.size() != labels.size() || static_cast<size_t>(refLayer.GetFeatureCount(true)) != labels.size())
+  {
+    std::cerr << "Wrong number of features without streaming: " << refLayer.GetFeatureCount(true) << " features, " << refFeatures.size()
+              << " distinct labels in the layer, " << labels.size() << " in the image" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (static_cast<size_t>(layer.GetFeatureCount(true)) != labels.size())
+  {
+    std::cerr << "Wrong number of features with " << nbDivisions << " divisions: " << layer.GetFeatureCount(true) << " features, " << labels.size()
+              << " labels in the image" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The polygons do not depend on the streaming (up to the order of the
+  // vertices, hence the topological comparison)
+  for (otb::ogr::Layer::const_iterator it = layer.cbegin(); it != layer.cend(); ++it)
+  {
+    const PixelType label = static_cast<PixelType>(it->ogr().GetFieldAsInteger64("DN"));
+    std::map<PixelType, otb::ogr::Feature>::const_iterator ref = refFeatures.find(label);
+    if (ref == refFeatures.end())
+    {
+      std::cerr << "Label " << label << " is not in the layer vectorized without streaming" << std::endl;
+      return EXIT_FAILURE;
+    }
+    otb::ogr::UniqueGeometryPtr diff = otb::ogr::SymDifference(*it->GetGeometry(), *ref->second.GetGeometry());
+    if (!diff || !diff->IsEmpty())
+    {
+      std::cerr << "The polygon of label " << label << " differs from the one vectorized without streaming" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -67,6 +67,7 @@ template <class T> void ListSampleRangeToSharkVector(const T * listSample, std::
     }
   
   output.clear();
+  output.reserve(size);
       
   // Sample index
   unsigned int sampleIdx = start;
@@ -111,6 +112,7 @@ template <class T> void ListSampleRangeToSharkVector(const T * listSample, std::
     }
 
   output.clear();
+  output.reserve(size);
   
   // Sample index
   unsigned int sampleIdx = start;
@@ -501,7 +501,8 @@ bool OutputImageParameter::IsMultiWritingEnabled()
     {
     otb::ExtendedFilenameToWriterOptions::Pointer filenameHelper = otb::ExtendedFilenameToWriterOptions::New();
     filenameHelper->SetExtendedFileName(this->GetFileName());
-    return filenameHelper->GetMultiWrite();
+    // Asynchronous writing is only supported by the single image writer
+    return filenameHelper->GetMultiWrite() && !filenameHelper->GetStreamingAsync();
     }
   return false;
 }